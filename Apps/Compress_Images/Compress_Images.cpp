@@ -273,6 +273,8 @@ void convert(
         }
         return false;
     };
+    // "resize" and "fragment" stream ".mtil" sources tile by tile, the
+    // luma and chrominance conversions load the whole image.
     if (cm.resize.has_value()) {
         auto resized_path = dest_dir / rel_path;
         if (cm.resize->file_extension.has_value()) {
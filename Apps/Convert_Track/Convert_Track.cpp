@@ -0,0 +1,114 @@
+#include <Mlib/Io/Arg_Parser.hpp>
+#include <Mlib/Os/Os.hpp>
+#include <Mlib/Physics/Misc/Track_Element_Binary_File.hpp>
+#include <Mlib/Physics/Misc/Track_Reader_Gpx.hpp>
+#include <Mlib/Physics/Misc/Track_Writer_Binary.hpp>
+#include <Mlib/Strings/String_View_To_Number.hpp>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace Mlib;
+
+// Rows in the format of "TrackElement::to_vector".
+static std::vector<std::vector<double>> load_rows(const std::string& filename) {
+    std::vector<std::vector<double>> result;
+    if (filename.ends_with(".mtrk")) {
+        TrackElementBinaryFile file{ filename };
+        result.reserve(file.nframes());
+        for (size_t i = 0; i < file.nframes(); ++i) {
+            result.push_back(file.row(i));
+        }
+    } else if (filename.ends_with(".gpx")) {
+        for (const auto& p : read_gpx_track(filename)) {
+            result.push_back({ NAN, p(0), p(1), p(2), 0., 0., 0. });
+        }
+    } else {
+        auto istr = create_ifstream(filename);
+        if (istr->fail()) {
+            throw std::runtime_error("Could not open track file \"" + filename + '"');
+        }
+        std::string line;
+        while (std::getline(*istr, line)) {
+            std::istringstream lstr{ line };
+            std::vector<double> row;
+            std::string token;
+            while (lstr >> token) {
+                row.push_back(safe_stod(token));
+            }
+            if (row.empty()) {
+                continue;
+            }
+            if (!result.empty() && (row.size() != result.front().size())) {
+                throw std::runtime_error("Inconsistent row length in file \"" + filename + '"');
+            }
+            result.push_back(std::move(row));
+        }
+        if (!istr->eof()) {
+            throw std::runtime_error("Could not read track file \"" + filename + '"');
+        }
+    }
+    if (result.empty()) {
+        throw std::runtime_error("Track file \"" + filename + "\" is empty");
+    }
+    if ((result.front().size() - 1) % 6 != 0) {
+        throw std::runtime_error("Unexpected row length in file \"" + filename + '"');
+    }
+    return result;
+}
+
+int main(int argc, char** argv) {
+    const ArgParser parser(
+        "Usage: convert_track <source> <destination> [--position_resolution <r>] [--rotation_resolution <r>] [--block_size <n>]\n"
+        "Converts between the text (\".m\"), GPX (\".gpx\", source only) and binary (\".mtrk\") track formats.\n"
+        "The position resolution is given in file units, i.e. in degrees for geographic tracks.",
+        {},
+        {"--position_resolution", "--rotation_resolution", "--block_size"});
+    try {
+        const auto args = parser.parsed(argc, argv);
+        args.assert_num_unnamed(2);
+        auto source = U8::str(args.unnamed_value(0));
+        auto destination = U8::str(args.unnamed_value(1));
+        auto rows = load_rows(source);
+        size_t ntransformations = (rows.front().size() - 1) / 6;
+        if (destination.ends_with(".mtrk")) {
+            auto position_resolution = safe_stod(args.named_svalue("--position_resolution", "1e-3"));
+            TrackWriterBinary writer{
+                destination,
+                ntransformations,
+                TrackBinaryQuantization{
+                    .position_resolution = { position_resolution, position_resolution, position_resolution },
+                    .rotation_resolution = safe_stod(args.named_svalue("--rotation_resolution", "1e-5"))
+                },
+                safe_stoz(args.named_svalue("--block_size", std::to_string(TRACK_BINARY_DEFAULT_BLOCK_SIZE)))};
+            for (const auto& row : rows) {
+                writer.write(row);
+            }
+            writer.flush();
+        } else {
+            auto ostr = create_ofstream(destination);
+            if (ostr->fail()) {
+                throw std::runtime_error("Could not open track file for write \"" + destination + '"');
+            }
+            *ostr << std::setprecision(18) << std::scientific;
+            for (const auto& row : rows) {
+                for (size_t i = 0; i < row.size(); ++i) {
+                    *ostr << (i == 0 ? "" : " ") << row[i];
+                }
+                *ostr << '\n';
+            }
+            ostr->flush();
+            if (ostr->fail()) {
+                throw std::runtime_error("Could not write to file " + destination);
+            }
+        }
+    } catch (const std::runtime_error& e) {
+        lerr() << e.what();
+        return 1;
+    }
+    return 0;
+}
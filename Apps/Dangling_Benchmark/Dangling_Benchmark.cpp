@@ -0,0 +1,75 @@
+#include <Mlib/Io/Arg_Parser.hpp>
+#include <Mlib/Memory/Dangling_Generation_Tracker.hpp>
+#include <Mlib/Memory/Dangling_Location_Tracker.hpp>
+#include <Mlib/Misc/Source_Location.hpp>
+#include <Mlib/Strings/String_View_To_Number.hpp>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <list>
+#include <thread>
+#include <vector>
+
+using namespace Mlib;
+
+// Every thread repeatedly copies a reference to an object and destroys
+// the copy, which is what copying and destroying a
+// "DanglingBaseClassPtr" does.
+// If "shared" is true, all threads reference the same object.
+// Returns millions of copy/destroy pairs per second.
+template <class TTracker>
+double copy_destroy_throughput(size_t nthreads, size_t niterations, bool shared) {
+    std::list<TTracker> trackers;
+    std::list<typename TTracker::Reference> roots;
+    for (size_t t = 0; t < (shared ? 1 : nthreads); ++t) {
+        trackers.emplace_back();
+        trackers.back().add(roots.emplace_back(), CURRENT_SOURCE_LOCATION);
+    }
+    auto start = std::chrono::steady_clock::now();
+    {
+        std::vector<std::jthread> threads;
+        threads.reserve(nthreads);
+        auto tracker = trackers.begin();
+        auto root = roots.begin();
+        for (size_t t = 0; t < nthreads; ++t) {
+            threads.emplace_back([&tracker=*tracker, &root=*root, niterations](){
+                for (size_t i = 0; i < niterations; ++i) {
+                    typename TTracker::Reference r;
+                    tracker.copy(r, root);
+                    tracker.check(r);
+                    tracker.remove(r);
+                }
+            });
+            if (!shared) {
+                ++tracker;
+                ++root;
+            }
+        }
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    auto root = roots.begin();
+    for (auto& tracker : trackers) {
+        tracker.remove(*root++);
+    }
+    return (double)(nthreads * niterations) / elapsed * 1e-6;
+}
+
+int main(int argc, char **argv) {
+    const ArgParser parser(
+        "Usage: dangling_benchmark [--nthreads <nthreads>] [--niterations <niterations>]",
+        {},
+        {"--nthreads", "--niterations"});
+    const auto args = parser.parsed(argc, argv);
+    args.assert_num_unnamed(0);
+    size_t nthreads = safe_stoz(args.named_svalue("--nthreads", "8"));
+    size_t niterations = safe_stoz(args.named_svalue("--niterations", "1000000"));
+    std::cout << "Copy/destroy throughput with " << nthreads << " threads [M/s]" << std::endl;
+    std::cout << "object      locations  generations" << std::endl;
+    for (bool shared : { true, false }) {
+        std::cout <<
+            std::setw(10) << (shared ? "shared" : "per-thread") << ' ' <<
+            std::setw(10) << copy_destroy_throughput<DanglingLocationTracker>(nthreads, niterations, shared) << ' ' <<
+            std::setw(12) << copy_destroy_throughput<DanglingGenerationTracker>(nthreads, niterations, shared) << std::endl;
+    }
+    return 0;
+}
@@ -1,8 +1,11 @@
 #include <Mlib/Geography/Heightmaps/Cities_Skylines.hpp>
 #include <Mlib/Geography/Heightmaps/Terrarium.hpp>
-#include <Mlib/Images/Bilinear_Interpolation.hpp>
 #include <Mlib/Images/Draw_Bmp.hpp>
 #include <Mlib/Images/Pgm_Image.hpp>
+#include <Mlib/Images/Tiles/Process_Tiles.hpp>
+#include <Mlib/Images/Tiles/Tile_Cache.hpp>
+#include <Mlib/Images/Tiles/Tiled_Image_File.hpp>
+#include <Mlib/Images/Tiles/Tiled_Operations.hpp>
 #include <Mlib/Io/Arg_Parser.hpp>
 #include <Mlib/Misc/Pragma_Clang.hpp>
 #include <Mlib/Physics/Units.hpp>
@@ -62,32 +65,10 @@ StbInfo<uint8_t> download_tile(
     }
 }
 
-class CroppedTerrariumHeightmap {
-public:
-    CroppedTerrariumHeightmap(
-        const Array<float>& map,
-        float min_y_id,
-        float max_y_id,
-        float min_x_id,
-        float max_x_id)
-    : map_(map),
-      min_y_id_{min_y_id},
-      max_y_id_{max_y_id},
-      min_x_id_{min_x_id},
-      max_x_id_{max_x_id}
-    {}
-    bool operator () (float y, float x, float& intensity) const {
-        float rf = min_y_id_ * (1 - y) + max_y_id_ * y;
-        float cf = min_x_id_ * (1 - x) + max_x_id_ * x;
-        return bilinear_grayscale_interpolation(rf, cf, map_, intensity);
-    }
-private:
-    Array<float> map_;
-    float min_y_id_;
-    float max_y_id_;
-    float min_x_id_;
-    float max_x_id_;
-};
+// Tiles are read lazily while resampling, s.t. the memory usage
+// does not depend on the number of downloaded tiles.
+static const size_t STITCHED_TILE_CACHE_NBYTES = 256 * 1024 * 1024;
+static const size_t RESAMPLED_TILE_SIZE = 256;
 
 /**
  * From: https://en.wikipedia.org/wiki/Mercator_projection#Derivation_of_the_Mercator_projection
@@ -112,6 +93,7 @@ int main(int argc, char** argv) {
         " [--out_pgm <filename>]"
         " [--api_key <api_key>]"
         " [--tmp_png <filename>]"
+        " [--stitched_mtil <filename>]"
         " [--stitched_png <filename>]"
         " [--stitched_normalized_png <filename>]"
         " [--resampled_normalized_png <filename>]";
@@ -128,6 +110,7 @@ int main(int argc, char** argv) {
          "--max_lon",
          "--api_key",
          "--tmp_filename",
+         "--stitched_mtil",
          "--stitched_png",
          "--stitched_normalized_png",
          "--resampled_normalized_png",
@@ -185,8 +168,14 @@ int main(int argc, char** argv) {
         if (tiles_max_x >= ntiles_global_x) {
             throw std::runtime_error("max_x out of range");
         }
-        Array<float> stitched{ArrayShape{ntiles_y * tile_pixels, ntiles_x * tile_pixels}};
-        std::vector<unsigned char> stitched_rgb(stitched.nelements() * 3);
+        Utf8Path stitched_mtil = args.named_value("--stitched_mtil", "download_heightmap_stitched.mtil");
+        auto stitched_shape = ArrayShape{ntiles_y * tile_pixels, ntiles_x * tile_pixels};
+        // The RGB image is only kept in memory if it is requested for debugging.
+        std::vector<unsigned char> stitched_rgb;
+        if (args.has_named_value("--stitched_png")) {
+            stitched_rgb.resize(stitched_shape.nelements() * 3);
+        }
+        TiledImageFileWriter stitched_writer{ stitched_mtil, 1, stitched_shape(0), stitched_shape(1), tile_pixels };
         for (size_t a = 0; a < ntiles_y; ++a) {
             for (size_t o = 0; o < ntiles_x; ++o) {
                 size_t y = tiles_min_y + a;
@@ -201,20 +190,32 @@ int main(int argc, char** argv) {
                 if (image.nrChannels != 3 && image.nrChannels != 4) {
                     throw std::runtime_error("Only 3 or 4 channels are supported");
                 }
+                if ((integral_cast<size_t>(image.width) != tile_pixels) ||
+                    (integral_cast<size_t>(image.height) != tile_pixels))
+                {
+                    throw std::runtime_error("Unexpected tile size");
+                }
+                Array<float> heights{ArrayShape{1, tile_pixels, tile_pixels}};
                 for (size_t da = 0; da < tile_pixels; ++da) {
                     for (size_t dl = 0; dl < tile_pixels; ++dl) {
                         unsigned char* rgb = &image[(da * (size_t)image.width  + dl) * (size_t)image.nrChannels];
                         size_t ga = da + a * tile_pixels;
                         size_t go = dl + o * tile_pixels;
                         // https://www.mapzen.com/blog/elevation/
-                        stitched(ga, go) = terrarium_to_meters_pix<float>(rgb);
-                        for (size_t c = 0; c < 3; ++c) {
-                            stitched_rgb[(ga * stitched.shape(1) + go) * 3 + c] = rgb[c];
+                        heights(0, da, dl) = terrarium_to_meters_pix<float>(rgb);
+                        if (!stitched_rgb.empty()) {
+                            for (size_t c = 0; c < 3; ++c) {
+                                stitched_rgb[(ga * stitched_shape(1) + go) * 3 + c] = rgb[c];
+                            }
                         }
                     }
                 }
+                stitched_writer.write_tile(a, o, heights);
             }
         }
+        stitched_writer.flush();
+        TileCache stitched_cache{ STITCHED_TILE_CACHE_NBYTES };
+        TiledImageFileReader stitched{ stitched_mtil, stitched_cache };
         double min_y_actual = (double)tiles_min_y * tile_len_y + min_y_global;
         double max_y_actual = ((double)tiles_max_y + 1 - 1. / (double)tile_pixels) * tile_len_y + min_y_global;
         double min_lon_actual = (double)tiles_min_x * tile_len_x - 180.;
@@ -224,42 +225,32 @@ int main(int argc, char** argv) {
         // double min_lon_actual = (tile_len_x * (2 * min_x - 1) - 360) / 2;
         // double max_lon_actual = (tile_len_x * (2 * max_x - 1) - 360) / 2;
 
-        float min_y_id = float((requested_min_y - min_y_actual) / (max_y_actual - min_y_actual) * double(stitched.shape(0) - 1));
-        float max_y_id = float((requested_max_y - min_y_actual) / (max_y_actual - min_y_actual) * double(stitched.shape(0) - 1));
-        float min_x_id = float((min_lon - min_lon_actual) / (max_lon_actual - min_lon_actual) * double(stitched.shape(1) - 1));
-        float max_x_id = float((max_lon - min_lon_actual) / (max_lon_actual - min_lon_actual) * double(stitched.shape(1) - 1));
+        float min_y_id = float((requested_min_y - min_y_actual) / (max_y_actual - min_y_actual) * double(stitched.height() - 1));
+        float max_y_id = float((requested_max_y - min_y_actual) / (max_y_actual - min_y_actual) * double(stitched.height() - 1));
+        float min_x_id = float((min_lon - min_lon_actual) / (max_lon_actual - min_lon_actual) * double(stitched.width() - 1));
+        float max_x_id = float((max_lon - min_lon_actual) / (max_lon_actual - min_lon_actual) * double(stitched.width() - 1));
 
-        CroppedTerrariumHeightmap cth{
+        ResampledTiledImage resampled_tiles{
             stitched,
-            min_y_id,
-            max_y_id,
-            min_x_id,
-            max_x_id};
-        Array<float> resampled{ArrayShape{result_height, result_width}};
-        for (size_t r = 0; r < resampled.shape(0); ++r) {
-            for (size_t c = 0; c < resampled.shape(1); ++c) {
-                float intensity;
-                if (cth(
-                    float(r) / float(resampled.shape(0) - 1),
-                    float(c) / float(resampled.shape(1) - 1),
-                    intensity))
-                {
-                    resampled(r, c) = intensity;
-                } else {
-                    resampled(r, c) = NAN;
-                }
-            }
-        }
+            result_height,
+            result_width,
+            FixedArray<double, 2>{ min_y_id, min_x_id },
+            FixedArray<double, 2>{
+                (max_y_id - min_y_id) / double(result_height - 1),
+                (max_x_id - min_x_id) / double(result_width - 1) },
+            FilterExtension::NWE,
+            0.f };
+        Array<float> resampled = evaluate_tiled_image(resampled_tiles, RESAMPLED_TILE_SIZE)[0];
         if (args.has_named_value("--stitched_png")) {
-            if (any(stitched.shape() > INT_MAX)) {
+            if (any(stitched_shape > INT_MAX)) {
                 throw std::runtime_error("Stitched image too large");
             }
-            if (!stbi_write_png(args.named_svalue("--stitched_png").c_str(), (int)stitched.shape(1), (int)stitched.shape(0), 3, stitched_rgb.data(), 0)) {
+            if (!stbi_write_png(args.named_svalue("--stitched_png").c_str(), (int)stitched_shape(1), (int)stitched_shape(0), 3, stitched_rgb.data(), 0)) {
                 throw std::runtime_error("Could not write \"" + args.named_svalue("--stitched_png") + '"');
             }
         }
         if (args.has_named_value("--stitched_normalized_png")) {
-            draw_nan_masked_grayscale(stitched, 0, 0).save_to_file(args.named_value("--stitched_normalized_png"));
+            draw_nan_masked_grayscale(evaluate_tiled_image(stitched, RESAMPLED_TILE_SIZE)[0], 0, 0).save_to_file(args.named_value("--stitched_normalized_png"));
         }
         if (args.has_named_value("--resampled_normalized_png")) {
             draw_nan_masked_grayscale(resampled, 0, 0).save_to_file(args.named_value("--resampled_normalized_png"));
@@ -0,0 +1,102 @@
+#include <Mlib/Geometry/Primitives/Bounding_Sphere.hpp>
+#include <Mlib/Io/Arg_Parser.hpp>
+#include <Mlib/Math/Fixed_Math.hpp>
+#include <Mlib/Physics/Dynamic_Lights/Light_Clusters.hpp>
+#include <Mlib/Physics/Units.hpp>
+#include <Mlib/Stats/Random_Number_Generators.hpp>
+#include <Mlib/Strings/String_View_To_Number.hpp>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace Mlib;
+
+using Clock = std::chrono::steady_clock;
+
+static double elapsed_ms(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+int main(int argc, char **argv) {
+    const ArgParser parser(
+        "Usage: light_cluster_benchmark [--n <nlights>] [--nframes <nframes>] [--npoints <npoints>] [--seed <seed>]\n"
+        "Builds the light clusters of randomly placed lights in every frame, and\n"
+        "compares the lookup of the lights at random points with brute force.",
+        {},
+        {"--n", "--nframes", "--npoints", "--seed"});
+    try {
+        const auto args = parser.parsed(argc, argv);
+        args.assert_num_unnamed(0);
+        auto n = safe_stoz(args.named_svalue("--n", "4096"));
+        auto nframes = safe_stoz(args.named_svalue("--nframes", "100"));
+        auto npoints = safe_stoz(args.named_svalue("--npoints", "10000"));
+        auto seed = safe_stou(args.named_svalue("--seed", "1"));
+
+        // Lights spread over a city, close to the ground, similar to
+        // headlights, muzzle flashes and explosions.
+        ScenePos extent = 1000 * meters;
+        UniformRandomNumberGenerator<ScenePos> xz{ seed, -0.5 * extent, 0.5 * extent };
+        UniformRandomNumberGenerator<ScenePos> y{ seed + 1, 0., 10 * meters };
+        UniformRandomNumberGenerator<ScenePos> radius{ seed + 2, 5 * meters, 30 * meters };
+        UniformRandomNumberGenerator<ScenePos> dx{ seed + 3, -0.5 * meters, 0.5 * meters };
+        std::vector<BoundingSphere<ScenePos, 3>> lights;
+        lights.reserve(n);
+        for (size_t i = 0; i < n; ++i) {
+            lights.emplace_back(FixedArray<ScenePos, 3>{ xz(), y(), xz() }, radius());
+        }
+        std::vector<FixedArray<ScenePos, 3>> points;
+        points.reserve(npoints);
+        for (size_t i = 0; i < npoints; ++i) {
+            points.emplace_back(xz(), y(), xz());
+        }
+
+        LightClusters clusters;
+        double build_ms = 0;
+        for (size_t f = 0; f < nframes; ++f) {
+            // Move the lights a bit, as in the game loop.
+            for (auto& l : lights) {
+                l.center(0) += dx();
+                l.center(2) += dx();
+            }
+            auto start = Clock::now();
+            clusters.build(lights);
+            build_ms += elapsed_ms(start);
+        }
+
+        size_t nclustered = 0;
+        auto clustered_start = Clock::now();
+        for (const auto& p : points) {
+            for (auto i : clusters.lights_at(p)) {
+                nclustered += (sum(squared(p - lights[i].center)) <= squared(lights[i].radius));
+            }
+        }
+        auto clustered_ms = elapsed_ms(clustered_start);
+
+        size_t nbrute = 0;
+        auto brute_start = Clock::now();
+        for (const auto& p : points) {
+            for (const auto& l : lights) {
+                nbrute += (sum(squared(p - l.center)) <= squared(l.radius));
+            }
+        }
+        auto brute_ms = elapsed_ms(brute_start);
+
+        std::cout << "Lights:             " << n << '\n';
+        std::cout << "Cells:              " << clusters.shape() << '\n';
+        std::cout << "Indices:            " << clusters.light_indices().size() << '\n';
+        std::cout << "Build:              " << build_ms / (double)nframes << " ms/frame\n";
+        std::cout << "Clustered lookup:   " << clustered_ms << " ms\n";
+        std::cout << "Brute-force lookup: " << brute_ms << " ms\n";
+        std::cout << "Mismatches:         " << (nclustered != nbrute) << std::endl;
+        if (nclustered != nbrute) {
+            return 1;
+        }
+    } catch (const std::runtime_error& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
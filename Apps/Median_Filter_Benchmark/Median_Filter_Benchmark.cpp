@@ -0,0 +1,45 @@
+#include <Mlib/Images/Filters/Median_Filter.hpp>
+#include <Mlib/Io/Arg_Parser.hpp>
+#include <Mlib/Stats/Random_Arrays.hpp>
+#include <Mlib/Strings/String_View_To_Number.hpp>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+
+using namespace Mlib;
+
+template <class TData>
+double median_filter_seconds(const Array<TData>& image, size_t window_size, TData boundary_value) {
+    auto start = std::chrono::steady_clock::now();
+    auto result = median_filter_2d(image, window_size, 1, boundary_value);
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char **argv) {
+    const ArgParser parser(
+        "Usage: median_filter_benchmark [--width <width>] [--height <height>]",
+        {},
+        {"--width", "--height"});
+    const auto args = parser.parsed(argc, argv);
+    args.assert_num_unnamed(0);
+    size_t width = safe_stoz(args.named_svalue("--width", "1024"));
+    size_t height = safe_stoz(args.named_svalue("--height", "1024"));
+    ArrayShape shape{ height, width };
+    auto im32 = uniform_random_array<float>(shape, 1);
+    auto im8 = (im32 * 255.f).casted<uint8_t>();
+    auto im16 = (im32 * 65535.f).casted<uint16_t>();
+    // Float images with few distinct values use the histogram filter.
+    auto im32q = im8.casted<float>();
+    std::cout << "window  float [s]  float, 256 values [s]  uint8 [s]  uint16 [s]" << std::endl;
+    for (size_t window : { 3, 5, 11, 21, 51, 101 }) {
+        size_t window_size = window / 2;
+        std::cout <<
+            std::setw(6) << window << ' ' <<
+            std::setw(10) << median_filter_seconds(im32, window_size, float{ NAN }) << ' ' <<
+            std::setw(22) << median_filter_seconds(im32q, window_size, float{ NAN }) << ' ' <<
+            std::setw(10) << median_filter_seconds<uint8_t>(im8, window_size, 0) << ' ' <<
+            std::setw(11) << median_filter_seconds<uint16_t>(im16, window_size, 0) << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,141 @@
+#include <Mlib/Io/Arg_Parser.hpp>
+#include <Mlib/Memory/Object_Pool.hpp>
+#include <Mlib/Misc/Object.hpp>
+#include <Mlib/Physics/Collision/Resolve/Constraints.hpp>
+#include <Mlib/Scene_Graph/Elements/Scene_Node.hpp>
+#include <Mlib/Strings/String_View_To_Number.hpp>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+using namespace Mlib;
+
+using Clock = std::chrono::steady_clock;
+
+// Stand-in with the size of the object it is named after.
+template <size_t tsize>
+struct Payload: public Object {
+    std::array<std::byte, tsize - sizeof(Object)> data;
+};
+
+enum class Backing {
+    SLAB,
+    HEAP
+};
+
+struct Timings {
+    // Nanoseconds per object.
+    double create;
+    double remove;
+    double traverse;
+};
+
+static double ns_per_object(Clock::time_point start, size_t n) {
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / (double)n;
+}
+
+// Creates "n" objects, replaces a random half of them to fragment the
+// free lists, reads all of them in creation order, and finally removes
+// them in random order.
+// The traversal time is a proxy for the cache misses caused by the
+// memory layout.
+template <class T>
+Timings run(Backing backing, size_t n, size_t ntraversals, unsigned int seed) {
+    ObjectPool pool{ InObjectPoolDestructor::ASSERT_NO_LEAKS };
+    auto create = [&]() -> T& {
+        switch (backing) {
+        case Backing::SLAB:
+            return pool.create<T>(CURRENT_SOURCE_LOCATION);
+        case Backing::HEAP:
+            return pool.add(std::make_unique<T>(), CURRENT_SOURCE_LOCATION);
+        }
+        throw std::runtime_error("Unknown backing");
+    };
+    std::vector<T*> objects(n);
+    Timings result;
+    auto create_start = Clock::now();
+    for (auto& o : objects) {
+        o = &create();
+        o->data[0] = std::byte{ 1 };
+    }
+    result.create = ns_per_object(create_start, n);
+
+    std::mt19937 rng{ seed };
+    std::vector<size_t> order(n);
+    for (size_t i = 0; i < n; ++i) {
+        order[i] = i;
+    }
+    std::shuffle(order.begin(), order.end(), rng);
+    for (size_t i = 0; i < n / 2; ++i) {
+        pool.remove(objects[order[i]]);
+    }
+    for (size_t i = 0; i < n / 2; ++i) {
+        objects[order[i]] = &create();
+        objects[order[i]]->data[0] = std::byte{ 1 };
+    }
+
+    size_t sum = 0;
+    auto traverse_start = Clock::now();
+    for (size_t t = 0; t < ntraversals; ++t) {
+        for (const auto* o : objects) {
+            sum += (size_t)o->data[0] + (size_t)o->data[sizeof(o->data) - 1];
+        }
+    }
+    result.traverse = ns_per_object(traverse_start, n * ntraversals);
+    if (sum == SIZE_MAX) {
+        std::cout << "Unexpected sum" << std::endl;
+    }
+
+    std::shuffle(order.begin(), order.end(), rng);
+    auto remove_start = Clock::now();
+    for (auto i : order) {
+        pool.remove(objects[i]);
+    }
+    result.remove = ns_per_object(remove_start, n);
+    return result;
+}
+
+template <class T>
+void print_timings(const char* name, size_t n, size_t ntraversals, unsigned int seed) {
+    for (auto backing : { Backing::HEAP, Backing::SLAB }) {
+        auto t = run<T>(backing, n, ntraversals, seed);
+        std::cout <<
+            std::setw(14) << name << ' ' <<
+            std::setw(6) << sizeof(T) << ' ' <<
+            std::setw(5) << (backing == Backing::SLAB ? "slab" : "heap") << ' ' <<
+            std::setw(10) << t.create << ' ' <<
+            std::setw(10) << t.remove << ' ' <<
+            std::setw(10) << t.traverse << std::endl;
+    }
+}
+
+int main(int argc, char **argv) {
+    const ArgParser parser(
+        "Usage: object_pool_benchmark [--n <nobjects>] [--ntraversals <ntraversals>] [--seed <seed>]\n"
+        "Compares objects allocated from slabs (\"ObjectPool::create\") with objects\n"
+        "allocated one by one on the heap (\"ObjectPool::add\"), for objects with the\n"
+        "size of scene nodes and of contact infos.",
+        {},
+        {"--n", "--ntraversals", "--seed"});
+    try {
+        const auto args = parser.parsed(argc, argv);
+        args.assert_num_unnamed(0);
+        auto n = safe_stoz(args.named_svalue("--n", "200000"));
+        auto ntraversals = safe_stoz(args.named_svalue("--ntraversals", "10"));
+        auto seed = safe_stou(args.named_svalue("--seed", "1"));
+        std::cout << "Nanoseconds per object" << std::endl;
+        std::cout << "object           size  pool     create     remove   traverse" << std::endl;
+        print_timings<Payload<sizeof(SceneNode)>>("scene node", n, ntraversals, seed);
+        print_timings<Payload<sizeof(NormalContactInfo2)>>("contact info", n, ntraversals, seed);
+    } catch (const std::runtime_error& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
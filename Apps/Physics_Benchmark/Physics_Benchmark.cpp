@@ -0,0 +1,739 @@
+#include <Mlib/Geometry/Coordinates/Gl_Look_At.hpp>
+#include <Mlib/Geometry/Graph/Point_And_Flags.hpp>
+#include <Mlib/Geometry/Graph/Points_And_Adjacency_Impl.hpp>
+#include <Mlib/Geometry/Material.hpp>
+#include <Mlib/Geometry/Mesh/Colored_Vertex_Array.hpp>
+#include <Mlib/Geometry/Mesh/Triangle_List.hpp>
+#include <Mlib/Geometry/Mesh/Typed_Mesh.hpp>
+#include <Mlib/Geometry/Modifier_Backlog.hpp>
+#include <Mlib/Geometry/Morphology.hpp>
+#include <Mlib/Geometry/Physics_Material.hpp>
+#include <Mlib/Geometry/Primitives/Intersectors/Swept_Sphere_Aabb.hpp>
+#include <Mlib/Hashing/Fnv1a.hpp>
+#include <Mlib/Io/Arg_Parser.hpp>
+#include <Mlib/Math/Fixed_Math.hpp>
+#include <Mlib/Math/Fixed_Scaled_Unit_Vector.hpp>
+#include <Mlib/Math/Interp.hpp>
+#include <Mlib/Math/Transformation/Transformation_Matrix.hpp>
+#include <Mlib/Memory/Object_Pool.hpp>
+#include <Mlib/Physics/Actuators/Rigid_Body_Engine.hpp>
+#include <Mlib/Physics/Actuators/Tire.hpp>
+#include <Mlib/Physics/Ai/Kinematic_Traffic.hpp>
+#include <Mlib/Physics/Bullets/Projectile_Pool.hpp>
+#include <Mlib/Physics/Collision/Collidable_Mode.hpp>
+#include <Mlib/Physics/Collision/Pacejkas_Magic_Formula.hpp>
+#include <Mlib/Physics/Containers/Collision_Group.hpp>
+#include <Mlib/Physics/Containers/Collision_Query.hpp>
+#include <Mlib/Physics/Interfaces/IControllable.hpp>
+#include <Mlib/Physics/Misc/Gravity_Efp.hpp>
+#include <Mlib/Physics/Physics_Engine/Collision_Statistics.hpp>
+#include <Mlib/Physics/Physics_Engine/Physics_Engine.hpp>
+#include <Mlib/Physics/Physics_Engine/Physics_Phase.hpp>
+#include <Mlib/Physics/Rigid_Body/Rigid_Body_Vehicle.hpp>
+#include <Mlib/Physics/Rigid_Body/Rigid_Primitives.hpp>
+#include <Mlib/Physics/Smoke_Generation/Surface_Contact_Db.hpp>
+#include <Mlib/Physics/Units.hpp>
+#include <Mlib/Physics/Vehicle_Controllers/Car_Controllers/Car_Controller.hpp>
+#include <Mlib/Scene_Config/Physics_Engine_Config.hpp>
+#include <Mlib/Scene_Graph/Instances/Static_World.hpp>
+#include <Mlib/Scene_Graph/Interfaces/Way_Points.hpp>
+#include <Mlib/Scene_Graph/Way_Point_Location.hpp>
+#include <Mlib/Strings/String_View_To_Number.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <list>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace Mlib;
+
+using Clock = std::chrono::steady_clock;
+using RigidBodyPtr = std::unique_ptr<RigidBodyVehicle, DeleteFromPool<RigidBodyVehicle>>;
+
+// Four unpowered tires below the corners of the body.
+struct WheelConfig {
+    float radius;
+    // Inset of the wheel centers from the sides and ends of the body.
+    float inset_x;
+    float inset_z;
+    // Height of the wheel centers above the underside of the body.
+    float height;
+};
+
+struct BodyConfig {
+    FixedArray<float, 3> size;
+    float mass;
+    PhysicsMaterial physics_material;
+    std::optional<WheelConfig> wheels = std::nullopt;
+};
+
+static const VariableAndHash<std::string> ENGINE_NAME{ "engine" };
+
+// Closed box, counterclockwise when seen from outside.
+static std::shared_ptr<ColoredVertexArray<float>> box_hitbox(
+    const std::string& name,
+    const FixedArray<float, 3>& size,
+    PhysicsMaterial physics_material,
+    const FixedArray<float, 3>& center = fixed_zeros<float, 3>())
+{
+    TriangleList<float> tl{
+        name,
+        Material{},
+        Morphology{ .physics_material = physics_material },
+        ModifierBacklog{} };
+    auto corner = [&size, &center](size_t i) {
+        return FixedArray<float, 3>{
+            (float)(i & 1) - 0.5f,
+            (float)((i >> 1) & 1) - 0.5f,
+            (float)((i >> 2) & 1) - 0.5f} * size + center;
+    };
+    static const size_t faces[6][4] = {
+        {0, 4, 6, 2},
+        {1, 3, 7, 5},
+        {0, 1, 5, 4},
+        {2, 6, 7, 3},
+        {0, 2, 3, 1},
+        {4, 5, 7, 6}};
+    for (const auto& f : faces) {
+        tl.draw_rectangle_wo_normals(corner(f[0]), corner(f[1]), corner(f[2]), corner(f[3]));
+    }
+    return tl.triangle_array();
+}
+
+// Square grid of "n x n" cells with the given edge length, centered
+// at the origin, with the y-axis pointing upwards.
+template <class THeight>
+static std::shared_ptr<ColoredVertexArray<float>> terrain_hitbox(
+    size_t n,
+    float cell_size,
+    const THeight& height)
+{
+    TriangleList<float> tl{
+        "terrain",
+        Material{},
+        Morphology{ .physics_material = PhysicsMaterial::ATTR_COLLIDE | PhysicsMaterial::ATTR_CONCAVE },
+        ModifierBacklog{} };
+    float o = -0.5f * cell_size * (float)n;
+    auto vertex = [&](size_t r, size_t c) {
+        float x = o + cell_size * (float)c;
+        float z = o + cell_size * (float)r;
+        return FixedArray<float, 3>{ x, height(x, z), z };
+    };
+    for (size_t r = 0; r < n; ++r) {
+        for (size_t c = 0; c < n; ++c) {
+            tl.draw_rectangle_wo_normals(
+                vertex(r, c),
+                vertex(r + 1, c),
+                vertex(r + 1, c + 1),
+                vertex(r, c + 1));
+        }
+    }
+    return tl.triangle_array();
+}
+
+// Box with rounded edges, like the hitboxes that "add_swept_sphere_aabb"
+// creates. Unlike the edges of a triangle mesh, it provides the contact
+// normals that are required when hitting concave triangles.
+static TypedMesh<std::shared_ptr<IIntersectable>> swept_sphere_hitbox(
+    const FixedArray<float, 3>& min,
+    const FixedArray<float, 3>& max,
+    float radius,
+    PhysicsMaterial physics_material)
+{
+    return {
+        physics_material,
+        std::make_shared<SweptSphereAabb>(
+            min.casted<CompressedScenePos>(),
+            max.casted<CompressedScenePos>(),
+            (CompressedScenePos)radius) };
+}
+
+static TypedMesh<std::shared_ptr<IIntersectable>> body_hitbox(const BodyConfig& b) {
+    auto radius = 0.1f * std::min({ b.size(0), b.size(1), b.size(2) });
+    return swept_sphere_hitbox(-0.5f * b.size, 0.5f * b.size, radius, b.physics_material);
+}
+
+static FixedArray<float, 3> wheel_center(const BodyConfig& b, const WheelConfig& w, size_t tire_id) {
+    return {
+        (tire_id % 2 == 0 ? -1.f : 1.f) * (0.5f * b.size(0) - w.inset_x),
+        -0.5f * b.size(1) + w.height,
+        (tire_id < 2 ? -1.f : 1.f) * (0.5f * b.size(2) - w.inset_z) };
+}
+
+// One vertical line per tire, from the wheel center down to the
+// maximum penetration depth below the wheel, in the order of the tire ids.
+static std::shared_ptr<ColoredVertexArray<float>> tire_lines_hitbox(
+    const BodyConfig& b,
+    const WheelConfig& w,
+    float wheel_penetration_depth)
+{
+    UUVector<FixedArray<ColoredVertex<float>, 2>> lines;
+    for (size_t tire_id = 0; tire_id < 4; ++tire_id) {
+        auto center = wheel_center(b, w, tire_id);
+        lines.emplace_back(
+            ColoredVertex<float>{ center },
+            ColoredVertex<float>{ center - FixedArray<float, 3>{ 0.f, w.radius + wheel_penetration_depth, 0.f } });
+    }
+    return std::make_shared<ColoredVertexArray<float>>(
+        "tire_lines",
+        Material{},
+        Morphology{ .physics_material = PhysicsMaterial::ATTR_COLLIDE | PhysicsMaterial::OBJ_TIRE_LINE },
+        ModifierBacklog{},
+        UUVector<FixedArray<ColoredVertex<float>, 4>>{},
+        UUVector<FixedArray<ColoredVertex<float>, 3>>{},
+        std::move(lines),
+        UUVector<FixedArray<std::vector<BoneWeight>, 3>>{},
+        UUVector<FixedArray<float, 3>>{},
+        UUVector<FixedArray<uint8_t, 3>>{},
+        std::vector<UUVector<FixedArray<float, 3, 2>>>{},
+        std::vector<UUVector<FixedArray<float, 3>>>{},
+        UUVector<FixedArray<float, 3>>{},
+        UUVector<FixedArray<float, 4>>{});
+}
+
+// Vertical rectangle across the z-axis. A grind line along the z-axis
+// pierces it, and its plane normal is parallel to the grind line, as
+// "handle_line_triangle_intersection" requires.
+static std::shared_ptr<ColoredVertexArray<float>> grind_contact_hitbox(
+    float width,
+    float y0,
+    float y1)
+{
+    TriangleList<float> tl{
+        "grind_contact",
+        Material{},
+        Morphology{ .physics_material = PhysicsMaterial::ATTR_COLLIDE | PhysicsMaterial::OBJ_GRIND_CONTACT },
+        ModifierBacklog{} };
+    tl.draw_rectangle_wo_normals(
+        { -0.5f * width, y0, 0.f },
+        { 0.5f * width, y0, 0.f },
+        { 0.5f * width, y1, 0.f },
+        { -0.5f * width, y1, 0.f });
+    return tl.triangle_array();
+}
+
+// Square grid of "n x n" waypoints with two-way streets between neighbors.
+static std::shared_ptr<const WayPointsAndBvh> grid_waypoints(size_t n, float spacing) {
+    PointsAndAdjacencyResource wp{ (uint32_t)(n * n) };
+    auto index = [n](size_t r, size_t c) {
+        return (uint32_t)(r * n + c);
+    };
+    float o = -0.5f * spacing * (float)(n - 1);
+    for (size_t r = 0; r < n; ++r) {
+        for (size_t c = 0; c < n; ++c) {
+            wp.points[index(r, c)] = {
+                FixedArray<CompressedScenePos, 3>{
+                    (CompressedScenePos)(o + spacing * (float)c),
+                    (CompressedScenePos)0.f,
+                    (CompressedScenePos)(o + spacing * (float)r) },
+                WayPointLocation::STREET };
+        }
+    }
+    auto connect = [&](uint32_t a, uint32_t b) {
+        wp.adjacency(a, b) = (CompressedScenePos)spacing;
+        wp.adjacency(b, a) = (CompressedScenePos)spacing;
+    };
+    for (size_t r = 0; r < n; ++r) {
+        for (size_t c = 0; c < n; ++c) {
+            if (c + 1 < n) {
+                connect(index(r, c), index(r, c + 1));
+            }
+            if (r + 1 < n) {
+                connect(index(r, c), index(r + 1, c));
+            }
+        }
+    }
+    wp.update_adjacency_diagonal();
+    return std::make_shared<WayPointsAndBvh>(std::move(wp));
+}
+
+class PhysicsBenchmark: public IControllable {
+public:
+    explicit PhysicsBenchmark(const PhysicsEngineConfig& cfg)
+        : engine_{ cfg, std::nullopt }
+        , gravity_efp_{ engine_ }
+    {
+        engine_.add_external_force_provider(gravity_efp_);
+        engine_.add_controllable(*this);
+        engine_.set_surface_contact_db(surface_contact_db_);
+        engine_.set_collision_statistics(&statistics_);
+    }
+    ~PhysicsBenchmark() {
+        engine_.remove_controllable(*this);
+    }
+    // Requests grinding after "reset_forces" has cleared the request,
+    // like the key bindings of a player do.
+    virtual void notify_reset(const PhysicsEngineConfig& cfg, const PhysicsPhase& phase) override {
+        for (auto* rb : grinders_) {
+            rb->grind_state_.wants_to_grind_ = true;
+        }
+    }
+    const CollisionStatistics& statistics() const {
+        return statistics_;
+    }
+    // Fires lightweight projectiles over the terrain, "rate" rounds per
+    // simulated second, horizontally in z-direction.
+    void add_projectiles(float rate, float extent) {
+        projectile_rate_ = rate;
+        projectile_extent_ = extent;
+        projectile_properties_ = projectiles_.add_properties(ProjectileProperties{
+            .max_lifetime = 2.f * seconds,
+            .drag_coefficient = 1e-3f / meters });
+    }
+    void add_terrain(const std::shared_ptr<ColoredVertexArray<float>>& cva) {
+        auto rb = rigid_cuboid("terrain", "terrain", INFINITY, fixed_ones<float, 3>());
+        add(std::move(rb), { cva }, {}, fixed_zeros<ScenePos, 3>(), CollidableMode::COLLIDE);
+    }
+    // Static rail along the z-axis, standing on the ground at "position".
+    // Its upper edges are grind lines.
+    void add_rail(const FixedArray<float, 3>& size, const FixedArray<ScenePos, 3>& position) {
+        auto name = "rail" + std::to_string(bodies_.size());
+        auto rb = rigid_cuboid(name, name, INFINITY, size);
+        auto hitbox = box_hitbox(
+            name,
+            size,
+            PhysicsMaterial::ATTR_COLLIDE | PhysicsMaterial::ATTR_CONVEX | PhysicsMaterial::OBJ_CHASSIS,
+            { 0.f, 0.5f * size(1), 0.f });
+        add(
+            std::move(rb),
+            { hitbox, hitbox->generate_grind_lines(45.f * degrees, 60.f * degrees) },
+            {},
+            position,
+            CollidableMode::COLLIDE);
+    }
+    void add_body(
+        const BodyConfig& b,
+        const FixedArray<ScenePos, 3>& position,
+        const FixedArray<float, 3>& v = fixed_zeros<float, 3>(),
+        std::list<std::shared_ptr<ColoredVertexArray<float>>> hitboxes = {})
+    {
+        auto name = "body" + std::to_string(bodies_.size());
+        auto rb = rigid_cuboid(name, name, b.mass, b.size, fixed_zeros<float, 3>(), v);
+        if (b.wheels.has_value()) {
+            add_wheels(*rb, b, *b.wheels);
+            hitboxes.push_back(tire_lines_hitbox(b, *b.wheels, engine_.config().wheel_penetration_depth));
+        }
+        add(
+            std::move(rb),
+            hitboxes,
+            { body_hitbox(b) },
+            position,
+            CollidableMode::COLLIDE | CollidableMode::MOVE);
+    }
+    // Body with a grind contact below the middle of its underside, which
+    // requests grinding on the rail that pierces the contact.
+    void add_grinder(
+        const BodyConfig& b,
+        const FixedArray<ScenePos, 3>& position,
+        const FixedArray<float, 3>& v)
+    {
+        auto y = -0.5f * b.size(1);
+        add_body(b, position, v, { grind_contact_hitbox(0.6f * meters, y - 0.3f * meters, y) });
+        auto& rb = *bodies_.back();
+        rb.grind_state_.grind_point_ = FixedArray<float, 3>{ 0.f, y, 0.f };
+        grinders_.push_back(&rb);
+    }
+    // Bodies driven along the waypoints without collision detection, like
+    // the distant bystanders (see "SimulationLod"). One body per edge,
+    // and more on the same edges if there are more bodies than edges.
+    void add_kinematic_traffic(
+        const BodyConfig& b,
+        size_t n,
+        std::shared_ptr<const WayPointsAndBvh> waypoints)
+    {
+        traffic_ = std::make_unique<KinematicTraffic>(std::move(waypoints));
+        const auto& wp = traffic_->waypoints()->way_points;
+        std::vector<std::pair<uint32_t, uint32_t>> edges;
+        for (uint32_t c = 0; c < wp.adjacency.columns().size(); ++c) {
+            for (const auto& [r, _] : wp.adjacency.column(c)) {
+                if (r != c) {
+                    edges.emplace_back(c, r);
+                }
+            }
+        }
+        if (edges.empty()) {
+            throw std::runtime_error("Waypoints have no edges");
+        }
+        for (size_t i = 0; i < n; ++i) {
+            const auto& [from, to] = edges[i % edges.size()];
+            auto p0 = funpack(wp.points[from].position);
+            auto d = funpack(wp.points[to].position) - p0;
+            auto u = d / std::sqrt(sum(squared(d)));
+            auto s = (2. + 10. * (ScenePos)(i / edges.size())) * meters;
+            auto id = traffic_->try_add(p0 + u * s, u.casted<float>(), 0.f, 1. * meters);
+            if (!id.has_value()) {
+                throw std::runtime_error("Could not add kinematic body");
+            }
+            add_body(b, traffic_->state(*id).position);
+            bodies_.back()->set_kinematic(true);
+            kinematic_.emplace_back(bodies_.back().get(), *id);
+        }
+    }
+    void run(size_t nsteps) {
+        StaticWorld world{
+            .geographic_mapping = &geographic_mapping_,
+            .inverse_geographic_mapping = &geographic_mapping_,
+            .gravity = &gravity_,
+            .wind = nullptr,
+            .time = Clock::time_point{}
+        };
+        const auto& cfg = engine_.config();
+        for (size_t step = 0; step < nsteps; ++step) {
+            if (traffic_ != nullptr) {
+                timed(kinematic_time_, [&](){ advance_kinematic_traffic(cfg.dt); });
+            }
+            for (const auto& g : engine_.rigid_bodies_.collision_groups()) {
+                auto idt = std::chrono::duration_cast<Clock::duration>(
+                    std::chrono::duration<float>(cfg.dt_substeps_(g.nsubsteps) / seconds));
+                for (size_t i = 0; i < g.nsubsteps; ++i) {
+                    world.time += idt;
+                    auto phase = PhysicsPhase{
+                        .burn_in = false,
+                        .substep = i,
+                        .group = g
+                    };
+                    timed(compute_transformed_time_, [&](){ engine_.compute_transformed_objects(&phase); });
+                    timed(collide_time_, [&](){ engine_.collide(world, nullptr, phase, nullptr); });
+                    timed(move_time_, [&](){ engine_.move_rigid_bodies(world, nullptr, phase); });
+                }
+            }
+            timed(compute_transformed_time_, [&](){ engine_.compute_transformed_objects(nullptr); });
+            if (projectile_rate_ != 0.f) {
+                timed(projectile_time_, [&](){ advance_projectiles(cfg.dt); });
+            }
+        }
+    }
+    // Hash of the exact bit patterns of the body states, s.t. two runs
+    // with the same inputs can be compared for determinism.
+    uint64_t checksum() const {
+        Fnv1a h;
+        for (const auto& rb : bodies_) {
+            h.update_value(rb->rbp_.abs_position());
+            h.update_value(rb->rbp_.rotation_);
+            h.update_value(rb->rbp_.v_com_);
+            h.update_value(rb->rbp_.w_);
+        }
+        return h.digest();
+    }
+    void print_report(std::ostream& ostr, size_t nsteps) const {
+        auto ms = [nsteps](Clock::duration d) {
+            return std::chrono::duration<double, std::milli>(d).count() / (double)nsteps;
+        };
+        ostr << std::fixed << std::setprecision(4);
+        ostr << "Bodies:                  " << bodies_.size() << '\n';
+        if (traffic_ != nullptr) {
+            ostr << "  kinematic:             " << kinematic_.size() << '\n';
+        }
+        ostr << "Steps:                   " << nsteps << '\n';
+        ostr << "Time per step [ms]:      " << ms(compute_transformed_time_ + collide_time_ + move_time_ + kinematic_time_ + projectile_time_) << '\n';
+        if (traffic_ != nullptr) {
+            ostr << "  kinematic:             " << ms(kinematic_time_) << '\n';
+        }
+        ostr << "  compute transformed:   " << ms(compute_transformed_time_) << '\n';
+        ostr << "  collide:               " << ms(collide_time_) << '\n';
+        ostr << "    movables:            " << ms(statistics_.movables_time) << '\n';
+        ostr << "    terrain:             " << ms(statistics_.terrain_time) << '\n';
+        ostr << "    contact generation:  " << ms(statistics_.contact_generation_time) << '\n';
+        ostr << "    solve:               " << ms(statistics_.solve_time) << '\n';
+        ostr << "  move:                  " << ms(move_time_) << '\n';
+        if (projectile_rate_ != 0.f) {
+            ostr << "  projectiles:           " << ms(projectile_time_) << '\n';
+        }
+        ostr << "Contacts\n";
+        ostr << "  collide calls:         " << statistics_.ncollide_calls << '\n';
+        ostr << "  contact infos:         " << statistics_.ncontact_infos << '\n';
+        ostr << "  raycast intersections: " << statistics_.nraycast_intersections << '\n';
+        ostr << "  concave intersections: " << statistics_.nconcave_t0_intersections << '\n';
+        ostr << "  grind infos:           " << statistics_.ngrind_infos << '\n';
+        ostr << "  warm-started:          " << statistics_.nwarm_started_contacts << '\n';
+        ostr << "  convergence rate:      " << statistics_.contact_convergence_rate() << '\n';
+        if (projectile_rate_ != 0.f) {
+            ostr << "Projectiles\n";
+            ostr << "  fired:                 " << nfired_ << '\n';
+            ostr << "  hits:                  " << nhits_ << '\n';
+            ostr << "  active:                " << projectiles_.size() << '\n';
+        }
+        double mean_height = 0.;
+        double mean_speed = 0.;
+        for (const auto& rb : bodies_) {
+            mean_height += rb->rbp_.abs_position()(1) / meters;
+            mean_speed += std::sqrt(sum(squared(rb->rbp_.v_com_))) / (meters / seconds);
+        }
+        if (!bodies_.empty()) {
+            mean_height /= (double)bodies_.size();
+            mean_speed /= (double)bodies_.size();
+        }
+        ostr << "Mean height [m]:         " << mean_height << '\n';
+        ostr << "Mean speed [m/s]:        " << mean_speed << '\n';
+        ostr << "Checksum:                " << std::hex << checksum() << std::dec << std::endl;
+    }
+private:
+    void add_wheels(RigidBodyVehicle& rb, const BodyConfig& b, const WheelConfig& w) {
+        const auto& cfg = engine_.config();
+        // Springs that compress by 2cm under the weight of the body,
+        // and dampers that stop 1m/s with the same force.
+        auto weight = 0.25f * b.mass * 9.8f * meters / squared(seconds);
+        rb.engines_.add(
+            ENGINE_NAME,
+            std::nullopt,   // power
+            nullptr);       // listeners
+        rb.tires_.resize(4, std::nullopt);
+        for (size_t tire_id = 0; tire_id < 4; ++tire_id) {
+            auto mount_0 = wheel_center(b, w, tire_id);
+            rb.tires_.add(
+                tire_id,
+                ENGINE_NAME,
+                std::nullopt,   // delta_engine
+                nullptr,        // wheel_rb
+                5e3f * N,
+                5e2f * N * meters,
+                weight / (2.f * cm),
+                weight / (1.f * meters / seconds),
+                1.f,
+                Interp<float>{ { 0.f, 1.f }, { 1.f, 1.f }, OutOfRangeBehavior::CLAMP },
+                CombinedPacejkasMagicFormula<float>{
+                    .f = FixedArray<PacejkasMagicFormulaArgmax<float>, 2>{
+                        PacejkasMagicFormulaArgmax<float>{PacejkasMagicFormula<float>{.B = 41.f * 0.044f * cfg.longitudinal_friction_steepness}},
+                        PacejkasMagicFormulaArgmax<float>{PacejkasMagicFormula<float>{.B = 41.f * 0.044f * cfg.lateral_friction_steepness}}
+                    }
+                },
+                mount_0,
+                mount_0 + FixedArray<float, 3>{ 0.f, 1.f * meters, 0.f },
+                w.radius);
+        }
+        rb.vehicle_controller_ = std::make_unique<CarController>(
+            DanglingBaseClassRef<RigidBodyVehicle>{ rb, CURRENT_SOURCE_LOCATION },
+            ENGINE_NAME,    // front_engine
+            ENGINE_NAME,    // rear_engine
+            std::vector<size_t>{ 0, 1 },
+            45.f * degrees,
+            Interp<float>{ { 0.f, 100.f * kph }, { 45.f * degrees, 5.f * degrees }, OutOfRangeBehavior::CLAMP },
+            engine_);
+    }
+    void add(
+        RigidBodyPtr rb,
+        const std::list<std::shared_ptr<ColoredVertexArray<float>>>& hitboxes,
+        const std::list<TypedMesh<std::shared_ptr<IIntersectable>>>& intersectables,
+        const FixedArray<ScenePos, 3>& position,
+        CollidableMode collidable_mode)
+    {
+        rb->set_absolute_model_matrix(
+            TransformationMatrix<float, ScenePos, 3>{ fixed_identity_array<float, 3>(), position },
+            CURRENT_SOURCE_LOCATION);
+        engine_.rigid_bodies_.add_rigid_body(*rb, hitboxes, {}, intersectables, collidable_mode);
+        bodies_.push_back(std::move(rb));
+    }
+    void advance_kinematic_traffic(float dt) {
+        traffic_->advance_time(dt);
+        for (auto& [rb, id] : kinematic_) {
+            auto state = traffic_->state(id);
+            auto R = gl_lookat_relative(state.direction).value_or(rb->rbp_.rotation_);
+            state.position(1) += 1.f * meters;
+            rb->rbp_.set_pose(R, state.position, 1.f, CURRENT_SOURCE_LOCATION);
+            rb->rbp_.set_v_com(state.direction * state.speed, dt, 1.f, CURRENT_SOURCE_LOCATION);
+        }
+    }
+    void advance_projectiles(float dt) {
+        projectile_budget_ += projectile_rate_ * dt / seconds;
+        for (; projectile_budget_ >= 1.f; projectile_budget_ -= 1.f) {
+            // Low-discrepancy sequence, s.t. runs are reproducible.
+            auto u = std::fmod(0.5f + 0.618034f * (float)nfired_, 1.f);
+            auto w = std::fmod(0.5f + 0.754878f * (float)nfired_, 1.f);
+            projectiles_.fire(
+                { (u - 0.5f) * projectile_extent_, 1.f * meters, -0.5f * projectile_extent_ * w },
+                { 0.f, 0.f, 400.f * meters / seconds },
+                projectile_properties_,
+                nullptr,    // owner
+                0);         // tag
+            ++nfired_;
+        }
+        projectiles_.advance_time(
+            dt,
+            gravity_.vector,
+            fixed_zeros<float, 3>(),
+            CollisionQuery{ engine_ },
+            [this](const ProjectileHit&){ ++nhits_; });
+    }
+    template <class TOperation>
+    static void timed(Clock::duration& total, const TOperation& op) {
+        auto start = Clock::now();
+        op();
+        total += Clock::now() - start;
+    }
+    TransformationMatrix<double, double, 3> geographic_mapping_ = TransformationMatrix<double, double, 3>::identity();
+    FixedScaledUnitVector<float, 3> gravity_{ FixedArray<float, 3>{ 0.f, -9.8f * meters / squared(seconds), 0.f } };
+    SurfaceContactDb surface_contact_db_;
+    CollisionStatistics statistics_;
+    PhysicsEngine engine_;
+    GravityEfp gravity_efp_;
+    // Destroyed before the engine, which removes the bodies from it.
+    std::list<RigidBodyPtr> bodies_;
+    Clock::duration compute_transformed_time_ = Clock::duration::zero();
+    Clock::duration collide_time_ = Clock::duration::zero();
+    Clock::duration move_time_ = Clock::duration::zero();
+    ProjectilePool projectiles_;
+    uint32_t projectile_properties_ = 0;
+    float projectile_rate_ = 0.f;
+    float projectile_extent_ = 0.f;
+    float projectile_budget_ = 0.f;
+    size_t nfired_ = 0;
+    size_t nhits_ = 0;
+    Clock::duration projectile_time_ = Clock::duration::zero();
+    std::unique_ptr<KinematicTraffic> traffic_;
+    std::vector<std::pair<RigidBodyVehicle*, uint32_t>> kinematic_;
+    std::vector<RigidBodyVehicle*> grinders_;
+    Clock::duration kinematic_time_ = Clock::duration::zero();
+};
+
+// Bodies on a square grid with the given spacing, "height" above the ground.
+static void add_grid(
+    PhysicsBenchmark& benchmark,
+    const BodyConfig& b,
+    size_t n,
+    float spacing,
+    float height,
+    const FixedArray<float, 3>& v = fixed_zeros<float, 3>())
+{
+    auto nside = (size_t)std::ceil(std::sqrt((double)n));
+    float o = -0.5f * spacing * (float)(nside - 1);
+    for (size_t i = 0; i < n; ++i) {
+        FixedArray<ScenePos, 3> p{
+            o + spacing * (float)(i % nside),
+            height,
+            o + spacing * (float)(i / nside) };
+        benchmark.add_body(b, p, v);
+    }
+}
+
+int main(int argc, char **argv) {
+    const ArgParser parser(
+        "Usage: physics_benchmark [--scenario {flat,bumpy,ridges,pileup,bullets,grinding,projectiles,traffic}] [--n <nbodies>] [--rounds <rounds_per_second>] [--kinematic <fraction>] [--nsteps <nsteps>] [--nsubsteps <nsubsteps>] [--ncontact_iterations <n>] [--contact_warm_start]\n"
+        "Runs the physics engine without graphics and prints the time per phase,\n"
+        "the contact counts, the mean height and speed of the bodies, and a\n"
+        "checksum of the final body states.\n"
+        "The cars roll on four unpowered tires.\n"
+        "The grinding scenario places rows of cars above parallel rails, requests\n"
+        "grinding, and fails if no grind infos are created.\n"
+        "The traffic scenario drives the given fraction of the cars kinematically\n"
+        "along a street grid, and all other cars dynamically. Without \"--kinematic\",\n"
+        "it runs once for each of the fractions 0, 0.5, 0.9 and 1.",
+        {"--contact_warm_start"},
+        {"--scenario", "--n", "--rounds", "--kinematic", "--nsteps", "--nsubsteps", "--ncontact_iterations"});
+    try {
+        const auto args = parser.parsed(argc, argv);
+        args.assert_num_unnamed(0);
+        auto scenario = args.named_svalue("--scenario", "flat");
+        auto n = safe_stoz(args.named_svalue("--n", (scenario == "traffic") ? "2000" : "100"));
+        auto nsteps = safe_stoz(args.named_svalue("--nsteps", "600"));
+        PhysicsEngineConfig cfg;
+        cfg.nsubsteps = safe_stoz(args.named_svalue("--nsubsteps", std::to_string(cfg.nsubsteps)));
+        cfg.ncontact_iterations = safe_stoz(args.named_svalue("--ncontact_iterations", std::to_string(cfg.ncontact_iterations)));
+        cfg.contact_warm_start = args.has_named("--contact_warm_start");
+        BodyConfig car{
+            .size = { 2.f * meters, 1.5f * meters, 4.5f * meters },
+            .mass = 1500.f * kg,
+            .physics_material = PhysicsMaterial::ATTR_COLLIDE | PhysicsMaterial::ATTR_CONVEX | PhysicsMaterial::OBJ_CHASSIS,
+            .wheels = WheelConfig{
+                .radius = 0.35f * meters,
+                .inset_x = 0.2f * meters,
+                .inset_z = 0.9f * meters,
+                .height = 0.1f * meters } };
+        size_t nterrain = 64;
+        float cell_size = 4.f * meters;
+        if (scenario == "traffic") {
+            auto waypoints = grid_waypoints(30, 50.f * meters);
+            auto fractions = args.has_named_value("--kinematic")
+                ? std::vector<float>{ safe_stof(args.named_svalue("--kinematic")) }
+                : std::vector<float>{ 0.f, 0.5f, 0.9f, 1.f };
+            for (auto fraction : fractions) {
+                auto nkinematic = (size_t)std::round(std::clamp(fraction, 0.f, 1.f) * (float)n);
+                PhysicsBenchmark benchmark{ cfg };
+                benchmark.add_terrain(terrain_hitbox(2 * nterrain, cell_size, [](float, float){ return 0.f; }));
+                add_grid(benchmark, car, n - nkinematic, 8.f * meters, 1.f * meters, { 0.f, 0.f, 50.f * kph });
+                benchmark.add_kinematic_traffic(car, nkinematic, waypoints);
+                benchmark.run(nsteps);
+                std::cout << "Kinematic fraction:      " << fraction << '\n';
+                benchmark.print_report(std::cout, nsteps);
+            }
+            return 0;
+        }
+        PhysicsBenchmark benchmark{ cfg };
+        if (scenario == "flat") {
+            benchmark.add_terrain(terrain_hitbox(nterrain, cell_size, [](float, float){ return 0.f; }));
+            add_grid(benchmark, car, n, 8.f * meters, 1.f * meters);
+        } else if (scenario == "bumpy") {
+            benchmark.add_terrain(terrain_hitbox(nterrain, cell_size, [](float x, float z){
+                return 0.5f * meters * std::sin(x / (7.f * meters)) * std::cos(z / (5.f * meters));
+            }));
+            add_grid(benchmark, car, n, 8.f * meters, 2.f * meters);
+        } else if (scenario == "ridges") {
+            benchmark.add_terrain(terrain_hitbox(nterrain, cell_size, [cell_size](float x, float){
+                return ((int)std::round(x / cell_size) % 2 == 0) ? 0.f : 1.f * meters;
+            }));
+            add_grid(benchmark, car, n, 8.f * meters, 2.5f * meters, { 0.f, 0.f, 10.f * meters / seconds });
+        } else if (scenario == "pileup") {
+            benchmark.add_terrain(terrain_hitbox(nterrain, cell_size, [](float, float){ return 0.f; }));
+            BodyConfig box{
+                .size = { 1.f * meters, 1.f * meters, 1.f * meters },
+                .mass = 100.f * kg,
+                .physics_material = car.physics_material };
+            for (size_t i = 0; i < n; ++i) {
+                // Alternate the offset s.t. the pile does not stay perfectly symmetric.
+                float dx = (i % 2 == 0) ? 0.f : 0.1f * meters;
+                benchmark.add_body(box, { dx, (0.5f + 1.05f * (float)i) * meters, 0.f });
+            }
+        } else if (scenario == "bullets") {
+            benchmark.add_terrain(terrain_hitbox(nterrain, cell_size, [](float, float){ return 0.f; }));
+            add_grid(benchmark, car, n / 2, 8.f * meters, 1.f * meters);
+            BodyConfig bullet{
+                .size = { 0.1f * meters, 0.1f * meters, 0.3f * meters },
+                .mass = 0.1f * kg,
+                .physics_material = car.physics_material };
+            add_grid(benchmark, bullet, n - n / 2, 8.f * meters, 3.f * meters, { 0.f, -50.f * meters / seconds, 200.f * meters / seconds });
+        } else if (scenario == "grinding") {
+            benchmark.add_terrain(terrain_hitbox(nterrain, cell_size, [](float, float){ return 0.f; }));
+            // Low enough to pass between the wheels and below the underside
+            // of the cars, through their grind contacts.
+            FixedArray<float, 3> rail_size{ 0.1f * meters, 0.15f * meters, 0.75f * cell_size * (float)nterrain };
+            // One row of cars behind each other on each rail, s.t. all
+            // rails fit on the terrain.
+            auto nside = (size_t)std::ceil(std::sqrt((double)n));
+            float spacing = 8.f * meters;
+            float o = -0.5f * spacing * (float)(nside - 1);
+            for (size_t i = 0; i < nside; ++i) {
+                benchmark.add_rail(rail_size, { o + spacing * (float)i, 0.f, 0.f });
+            }
+            for (size_t i = 0; i < n; ++i) {
+                benchmark.add_grinder(
+                    car,
+                    { o + spacing * (float)(i % nside), 1.f * meters, -0.45f * rail_size(2) + spacing * (float)(i / nside) },
+                    { 0.f, 0.f, 10.f * meters / seconds });
+            }
+        } else if (scenario == "projectiles") {
+            benchmark.add_terrain(terrain_hitbox(nterrain, cell_size, [](float x, float z){
+                return 0.5f * meters * std::sin(x / (7.f * meters)) * std::cos(z / (5.f * meters));
+            }));
+            add_grid(benchmark, car, n, 8.f * meters, 2.f * meters);
+            benchmark.add_projectiles(
+                safe_stof(args.named_svalue("--rounds", "50000")),
+                cell_size * (float)nterrain);
+        } else {
+            throw std::runtime_error("Unknown scenario: \"" + scenario + '"');
+        }
+        benchmark.run(nsteps);
+        benchmark.print_report(std::cout, nsteps);
+        if ((scenario == "grinding") && (benchmark.statistics().ngrind_infos == 0)) {
+            throw std::runtime_error("The grinding scenario created no grind infos");
+        }
+    } catch (const std::runtime_error& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,168 @@
+#include <Mlib/Geometry/Material.hpp>
+#include <Mlib/Geometry/Mesh/Colored_Vertex_Array.hpp>
+#include <Mlib/Geometry/Mesh/Triangle_List.hpp>
+#include <Mlib/Geometry/Modifier_Backlog.hpp>
+#include <Mlib/Geometry/Morphology.hpp>
+#include <Mlib/Geometry/Physics_Material.hpp>
+#include <Mlib/Io/Arg_Parser.hpp>
+#include <Mlib/Math/Fixed_Math.hpp>
+#include <Mlib/Math/Transformation/Transformation_Matrix.hpp>
+#include <Mlib/Memory/Object_Pool.hpp>
+#include <Mlib/Physics/Collision/Collidable_Mode.hpp>
+#include <Mlib/Physics/Containers/Collision_Query.hpp>
+#include <Mlib/Physics/Containers/Ray_Query_Batch.hpp>
+#include <Mlib/Physics/Physics_Engine/Physics_Engine.hpp>
+#include <Mlib/Physics/Rigid_Body/Rigid_Body_Vehicle.hpp>
+#include <Mlib/Physics/Rigid_Body/Rigid_Primitives.hpp>
+#include <Mlib/Physics/Units.hpp>
+#include <Mlib/Scene_Config/Physics_Engine_Config.hpp>
+#include <Mlib/Stats/Random_Number_Generators.hpp>
+#include <Mlib/Strings/String_View_To_Number.hpp>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace Mlib;
+
+using Clock = std::chrono::steady_clock;
+using RigidBodyPtr = std::unique_ptr<RigidBodyVehicle, DeleteFromPool<RigidBodyVehicle>>;
+
+static const PhysicsMaterial CITY_MATERIAL =
+    PhysicsMaterial::ATTR_COLLIDE | PhysicsMaterial::ATTR_CONCAVE;
+
+// Flat ground of "n x n" blocks, each with a building of random
+// height, s.t. the rays are occluded at all distances.
+static std::shared_ptr<ColoredVertexArray<float>> city_hitbox(
+    size_t n,
+    float block_size,
+    float street_width,
+    unsigned int seed)
+{
+    TriangleList<float> tl{
+        "city",
+        Material{},
+        Morphology{ .physics_material = CITY_MATERIAL },
+        ModifierBacklog{} };
+    UniformRandomNumberGenerator<float> height{ seed, 5.f * meters, 60.f * meters };
+    float o = -0.5f * block_size * (float)n;
+    tl.draw_rectangle_wo_normals(
+        { o, 0.f, o },
+        { o, 0.f, -o },
+        { -o, 0.f, -o },
+        { -o, 0.f, o });
+    for (size_t r = 0; r < n; ++r) {
+        for (size_t c = 0; c < n; ++c) {
+            float x0 = o + block_size * (float)c + 0.5f * street_width;
+            float z0 = o + block_size * (float)r + 0.5f * street_width;
+            float x1 = x0 + block_size - street_width;
+            float z1 = z0 + block_size - street_width;
+            float h = height();
+            tl.draw_rectangle_wo_normals({ x0, 0.f, z0 }, { x0, 0.f, z1 }, { x0, h, z1 }, { x0, h, z0 });
+            tl.draw_rectangle_wo_normals({ x1, 0.f, z1 }, { x1, 0.f, z0 }, { x1, h, z0 }, { x1, h, z1 });
+            tl.draw_rectangle_wo_normals({ x0, 0.f, z0 }, { x0, h, z0 }, { x1, h, z0 }, { x1, 0.f, z0 });
+            tl.draw_rectangle_wo_normals({ x1, 0.f, z1 }, { x1, h, z1 }, { x0, h, z1 }, { x0, 0.f, z1 });
+            tl.draw_rectangle_wo_normals({ x0, h, z0 }, { x0, h, z1 }, { x1, h, z1 }, { x1, h, z0 });
+        }
+    }
+    return tl.triangle_array();
+}
+
+static double elapsed_ms(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+int main(int argc, char **argv) {
+    const ArgParser parser(
+        "Usage: ray_query_benchmark [--n <nrays>] [--blocks <nblocks>] [--seed <seed>]\n"
+        "Casts random visibility rays through a procedural city, once one by one\n"
+        "with \"CollisionQuery::can_see\" and once with \"RayQueryBatch\", and prints\n"
+        "the timings and the number of mismatching results.",
+        {},
+        {"--n", "--blocks", "--seed"});
+    try {
+        const auto args = parser.parsed(argc, argv);
+        args.assert_num_unnamed(0);
+        auto n = safe_stoz(args.named_svalue("--n", "100000"));
+        auto nblocks = safe_stoz(args.named_svalue("--blocks", "32"));
+        auto seed = safe_stou(args.named_svalue("--seed", "1"));
+        float block_size = 40.f * meters;
+        float extent = block_size * (float)nblocks;
+
+        PhysicsEngineConfig cfg;
+        PhysicsEngine engine{ cfg, std::nullopt };
+        RigidBodyPtr city = rigid_cuboid("city", "city", INFINITY, fixed_ones<float, 3>());
+        city->set_absolute_model_matrix(
+            TransformationMatrix<float, ScenePos, 3>::identity(),
+            CURRENT_SOURCE_LOCATION);
+        engine.rigid_bodies_.add_rigid_body(
+            *city,
+            { city_hitbox(nblocks, block_size, 12.f * meters, seed) },
+            {},
+            {},
+            CollidableMode::COLLIDE);
+
+        // Eye-level rays along the streets and over the roofs, similar
+        // to the AI visibility checks.
+        UniformRandomNumberGenerator<ScenePos> xz{ seed + 1, -0.5 * extent, 0.5 * extent };
+        UniformRandomNumberGenerator<ScenePos> y{ seed + 2, 1. * meters, 40. * meters };
+        std::vector<RayQuery> queries;
+        queries.reserve(n);
+        while (queries.size() < n) {
+            RayQuery q{
+                .start = { xz(), y(), xz() },
+                .stop = { xz(), y(), xz() },
+                .collidable_mask = CITY_MATERIAL };
+            if (sum(squared(q.stop - q.start)) < 1.) {
+                continue;
+            }
+            queries.push_back(q);
+        }
+
+        CollisionQuery collision_query{ engine };
+        std::vector<bool> scalar(n);
+        auto scalar_start = Clock::now();
+        for (size_t i = 0; i < n; ++i) {
+            const auto& q = queries[i];
+            scalar[i] = collision_query.can_see(
+                q.start,
+                q.stop,
+                nullptr,
+                nullptr,
+                false,
+                q.collidable_mask);
+        }
+        auto scalar_ms = elapsed_ms(scalar_start);
+
+        RayQueryBatch batch{ engine };
+        for (const auto& q : queries) {
+            batch.add(q);
+        }
+        auto batch_start = Clock::now();
+        batch.run(RayQueryMode::ANY_HIT);
+        auto batch_ms = elapsed_ms(batch_start);
+
+        size_t nvisible = 0;
+        size_t nmismatches = 0;
+        for (size_t i = 0; i < n; ++i) {
+            nvisible += scalar[i];
+            nmismatches += (scalar[i] != batch.can_see(i));
+        }
+        std::cout << "Rays:       " << n << '\n';
+        std::cout << "Visible:    " << nvisible << '\n';
+        std::cout << "Scalar:     " << scalar_ms << " ms\n";
+        std::cout << "Batch:      " << batch_ms << " ms\n";
+        std::cout << "Speedup:    " << scalar_ms / batch_ms << '\n';
+        std::cout << "Mismatches: " << nmismatches << std::endl;
+        if (nmismatches != 0) {
+            return 1;
+        }
+    } catch (const std::runtime_error& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
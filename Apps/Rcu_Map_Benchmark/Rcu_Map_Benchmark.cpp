@@ -0,0 +1,84 @@
+#include <Mlib/Io/Arg_Parser.hpp>
+#include <Mlib/Map/Rcu_String_With_Hash_Unordered_Map.hpp>
+#include <Mlib/Map/Threadsafe_String_With_Hash_Unordered_Map.hpp>
+#include <Mlib/Strings/String_View_To_Number.hpp>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Mlib;
+
+// Models a resource registry that is filled at load time and read per
+// frame by the render and physics threads.
+// Returns the number of lookups per microsecond, summed over all threads.
+template <template <class> class TMap>
+double lookup_throughput(
+    const std::vector<VariableAndHash<std::string>>& keys,
+    size_t nthreads,
+    size_t nlookups)
+{
+    TMap<size_t> resources{ "Resource" };
+    for (size_t i = 0; i < keys.size(); ++i) {
+        resources.add(keys[i], i);
+    }
+    std::atomic_size_t nready = 0;
+    std::atomic_bool start = false;
+    std::atomic_size_t checksum = 0;
+    std::chrono::steady_clock::time_point start_time;
+    {
+        std::vector<std::jthread> threads;
+        threads.reserve(nthreads);
+        for (size_t t = 0; t < nthreads; ++t) {
+            threads.emplace_back([&, t](){
+                ++nready;
+                while (!start);
+                size_t sum = 0;
+                for (size_t i = 0; i < nlookups; ++i) {
+                    sum += resources.get(keys[((i + t) * 7919) % keys.size()]);
+                }
+                checksum += sum;
+            });
+        }
+        while (nready != nthreads);
+        start_time = std::chrono::steady_clock::now();
+        start = true;
+    }
+    auto dt = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start_time).count();
+    if (checksum == SIZE_MAX) {
+        std::cout << checksum;
+    }
+    return (double)(nthreads * nlookups) / dt;
+}
+
+int main(int argc, char **argv) {
+    const ArgParser parser(
+        "Usage: rcu_map_benchmark [--nresources <nresources>] [--nlookups <nlookups>] [--max_nthreads <max_nthreads>]",
+        {},
+        {"--nresources", "--nlookups", "--max_nthreads"});
+    const auto args = parser.parsed(argc, argv);
+    args.assert_num_unnamed(0);
+    size_t nresources = safe_stoz(args.named_svalue("--nresources", "10000"));
+    size_t nlookups = safe_stoz(args.named_svalue("--nlookups", "1000000"));
+    size_t max_nthreads = safe_stoz(args.named_svalue(
+        "--max_nthreads",
+        std::to_string(std::max(1u, std::thread::hardware_concurrency()))));
+    std::vector<VariableAndHash<std::string>> keys;
+    keys.reserve(nresources);
+    for (size_t i = 0; i < nresources; ++i) {
+        keys.emplace_back("resource_" + std::to_string(i));
+    }
+    std::cout << nresources << " resources, " << nlookups << " lookups per thread" << std::endl;
+    std::cout << "threads  shared mutex [1/us]  rcu [1/us]" << std::endl;
+    for (size_t nthreads = 1; nthreads <= max_nthreads; nthreads *= 2) {
+        auto m = lookup_throughput<ThreadsafeStringWithHashUnorderedMap>(keys, nthreads, nlookups);
+        auto r = lookup_throughput<RcuStringWithHashUnorderedMap>(keys, nthreads, nlookups);
+        std::cout << std::setw(7) << nthreads << ' ' <<
+            std::setw(20) << m << ' ' <<
+            std::setw(11) << r << std::endl;
+    }
+    return 0;
+}
@@ -9,6 +9,7 @@
 #include <Mlib/OpenGL/Resource_Managers/Particle_Resources.hpp>
 #include <Mlib/OpenGL/Resource_Managers/Trail_Resources.hpp>
 #include <Mlib/Os/Env.hpp>
+#include <Mlib/Os/Log/Async_Log.hpp>
 #include <Mlib/Os/Preload.hpp>
 #include <Mlib/Os/Threads/Containers/Thread_Safe_String.hpp>
 #include <Mlib/Os/Threads/J_Thread.hpp>
@@ -434,6 +435,7 @@ int main(int argc, char** argv) {
         "    [--print_remote_data]\n"
         "    [--print_remote_metadata]\n"
         "    [--thread_limit <n>]\n"
+        "    [--sync_log]\n"
         "    [--verbose]";
     const ArgParser parser(
         help,
@@ -486,6 +488,7 @@ int main(int argc, char** argv) {
          "--print_remote_data",
          "--print_remote_metadata",
          "--print_remote_stats",
+         "--sync_log",
          "--verbose"},
         {"--app_reldir",
          "--record_track_basename",
@@ -582,6 +585,10 @@ int main(int argc, char** argv) {
             set_app_reldir(args.named_value("--app_reldir"));
             create_directories(get_appdata_directory());
         }
+        std::optional<AsyncLoggingGuard> async_logging_guard;
+        if (!args.has_named("--sync_log")) {
+            async_logging_guard.emplace();
+        }
 
         args.assert_num_unnamed(2);
         if (args.has_named_value("--thread_limit")) {
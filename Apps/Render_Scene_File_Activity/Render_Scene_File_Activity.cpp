@@ -50,6 +50,7 @@
 #include <Mlib/OpenGL/Viewport_Guard.hpp>
 #include <Mlib/OpenGL/Window.hpp>
 #include <Mlib/Os/Env.hpp>
+#include <Mlib/Os/Log/Async_Log.hpp>
 #include <Mlib/Os/Preload.hpp>
 #include <Mlib/Os/Threads/Containers/Thread_Safe_String.hpp>
 #include <Mlib/Os/Threads/J_Thread.hpp>
@@ -331,6 +332,7 @@ void android_main(android_app* app)
 #ifdef __ANDROID__
     AndroidAppGuard android_app_guard{*app};
 #endif
+    AsyncLoggingGuard async_logging_guard;
     // This throws exceptions internally, which is not supported
     // on Android.
     // register_pretty_terminate();
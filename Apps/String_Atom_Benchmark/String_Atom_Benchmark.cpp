@@ -0,0 +1,112 @@
+#include <Mlib/Io/Arg_Parser.hpp>
+#include <Mlib/Map/String_Atom_Unordered_Map.hpp>
+#include <Mlib/Map/String_With_Hash_Unordered_Map.hpp>
+#include <Mlib/Strings/String_View_To_Number.hpp>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace Mlib;
+
+struct Timings {
+    double insert;
+    double lookup;
+    double copy;
+};
+
+template <class TTimePoint>
+static double milliseconds_since(const TTimePoint& start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Models the children of a scene node, keyed by the node names.
+// "names" are converted to keys outside of the timed sections,
+// as a caller holding the key would do.
+template <class TKey, template <class> class TMap>
+Timings node_map_timings(const std::vector<std::string>& names, size_t nlookups) {
+    std::vector<TKey> keys;
+    keys.reserve(names.size());
+    for (const auto& name : names) {
+        keys.emplace_back(name);
+    }
+    Timings result;
+    TMap<size_t> nodes{ "Node" };
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < keys.size(); ++i) {
+            nodes.add(keys[i], i);
+        }
+        result.insert = milliseconds_since(start);
+    }
+    {
+        auto start = std::chrono::steady_clock::now();
+        size_t sum = 0;
+        for (size_t i = 0; i < nlookups; ++i) {
+            sum += nodes.get(keys[(i * 7919) % keys.size()]);
+        }
+        result.lookup = milliseconds_since(start);
+        if (sum == SIZE_MAX) {
+            std::cout << sum;
+        }
+    }
+    {
+        auto start = std::chrono::steady_clock::now();
+        auto copied = nodes.keys();
+        result.copy = milliseconds_since(start);
+    }
+    return result;
+}
+
+// Models the callers that still hold "VariableAndHash" keys and
+// look up the atom first, e.g. "Players::get_player".
+static double try_find_timing(const std::vector<std::string>& names, size_t nlookups) {
+    std::vector<VariableAndHash<std::string>> keys;
+    keys.reserve(names.size());
+    for (const auto& name : names) {
+        keys.emplace_back(name);
+        StringAtom{ keys.back() };
+    }
+    auto start = std::chrono::steady_clock::now();
+    size_t sum = 0;
+    for (size_t i = 0; i < nlookups; ++i) {
+        sum += StringAtom::try_find(keys[(i * 7919) % keys.size()])->id();
+    }
+    auto result = milliseconds_since(start);
+    if (sum == SIZE_MAX) {
+        std::cout << sum;
+    }
+    return result;
+}
+
+int main(int argc, char **argv) {
+    const ArgParser parser(
+        "Usage: string_atom_benchmark [--nnodes <nnodes>] [--nlookups <nlookups>]",
+        {},
+        {"--nnodes", "--nlookups"});
+    const auto args = parser.parsed(argc, argv);
+    args.assert_num_unnamed(0);
+    size_t nnodes = safe_stoz(args.named_svalue("--nnodes", "100000"));
+    size_t nlookups = safe_stoz(args.named_svalue("--nlookups", "1000000"));
+    std::vector<std::string> names;
+    names.reserve(nnodes);
+    for (size_t i = 0; i < nnodes; ++i) {
+        names.push_back("scene_node_" + std::to_string(i) + "_renderable");
+    }
+    auto s = node_map_timings<VariableAndHash<std::string>, StringWithHashUnorderedMap>(names, nlookups);
+    auto a = node_map_timings<StringAtom, StringAtomUnorderedMap>(names, nlookups);
+    auto f = try_find_timing(names, nlookups);
+    std::cout << nnodes << " nodes, " << nlookups << " lookups" << std::endl;
+    std::cout << "key          insert [ms]  lookup [ms]  copy keys [ms]" << std::endl;
+    std::cout << std::setw(10) << "string" << ' ' <<
+        std::setw(13) << s.insert << ' ' <<
+        std::setw(12) << s.lookup << ' ' <<
+        std::setw(15) << s.copy << std::endl;
+    std::cout << std::setw(10) << "atom" << ' ' <<
+        std::setw(13) << a.insert << ' ' <<
+        std::setw(12) << a.lookup << ' ' <<
+        std::setw(15) << a.copy << std::endl;
+    std::cout << "string to atom [ms]: " << f << std::endl;
+    return 0;
+}
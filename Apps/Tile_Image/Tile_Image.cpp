@@ -82,6 +82,8 @@ int main(int argc, char** argv) {
                 };
             }
         }();
+        // The synthesized image is assembled in memory, so its size is
+        // bounded by RAM, unlike the ".mtil" pipeline in "Mlib/Images/Tiles".
         Array<float> down;
         if (args.has_named("--coeffs")) {
             CoefficientImageCache coeffs;
@@ -0,0 +1,91 @@
+#include <Mlib/Compression/Compressed_File.hpp>
+#include <Mlib/Geometry/Material/Billboard_Atlas_Instance.hpp>
+#include <Mlib/Geometry/Mesh/Animated_Colored_Vertex_Arrays.hpp>
+#include <Mlib/Geometry/Mesh/Load/Load_Mesh_Config.hpp>
+#include <Mlib/Geometry/Mesh/Load/Load_Mhx2.hpp>
+#include <Mlib/Geometry/Mesh/Load/Load_Obj.hpp>
+#include <Mlib/Geometry/Mesh/Load/Mesh_Cache.hpp>
+#include <Mlib/Io/Arg_Parser.hpp>
+#include <Mlib/Json/Json_Object_File.hpp>
+#include <Mlib/Macro_Executor/Json_Macro_Arguments.hpp>
+#include <Mlib/Os/Os.hpp>
+#include <Mlib/Scene/Json/Load_Mesh_Config_Json.hpp>
+#include <Mlib/Scene_Config/Scene_Precision.hpp>
+#include <Mlib/Strings/Utf8_Path.hpp>
+
+using namespace Mlib;
+
+template <class TPos>
+static void warm_file(
+    const Utf8Path& cache_directory,
+    const Utf8Path& filename,
+    const LoadMeshConfig<TPos>& cfg,
+    MeshCacheMode mode)
+{
+    CompressedFile compressed_file{ filename };
+    if (compressed_file.has_any_extension(".obj")) {
+        linfo() << "Processing file " << filename;
+        load_mesh_cached(cache_directory, obj_dependencies(filename), "obj", cfg, [&](){
+            auto acvas = std::make_shared<AnimatedColoredVertexArrays>();
+            acvas->template cvas<TPos>() = load_obj<TPos>(filename, cfg);
+            return acvas;
+        }, mode);
+    } else if (compressed_file.has_any_extension(".mhx2")) {
+        if constexpr (std::is_same_v<TPos, float>) {
+            linfo() << "Processing file " << filename;
+            load_mesh_cached(cache_directory, { filename }, "mhx2", cfg, [&](){
+                return load_mhx2(filename, cfg);
+            }, mode);
+        }
+    }
+}
+
+template <class TPos>
+static void warm(const ParsedArgs& args) {
+    JsonObjectFile config;
+    config.load_from_file(args.named_value("--config"));
+    auto cfg = load_mesh_config_from_json<TPos>(JsonMacroArguments{ config.json() });
+    auto cache_directory = args.has_named_value("--cache_dir")
+        ? Utf8Path{ args.named_value("--cache_dir") }
+        : mesh_cache_directory().value();
+    auto mode = args.has_named("--overwrite")
+        ? MeshCacheMode::OVERWRITE
+        : MeshCacheMode::READ_WRITE;
+    for (const auto& dir_string : args.unnamed_values()) {
+        for (const auto& entry : list_dir_recursive(Utf8Path{ dir_string })) {
+            if (!entry.is_regular_file()) {
+                continue;
+            }
+            warm_file<TPos>(cache_directory, Utf8Path::from_path(entry.path()), cfg, mode);
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    const ArgParser parser(
+        "Usage: warm_mesh_cache <asset_directory> [asset_directory2 ...] "
+        "--config <load_mesh_config.json> "
+        "[--cache_dir <directory>] "
+        "[--double_precision] "
+        "[--overwrite]\n"
+        "The cache directory defaults to the environment variable MESH_CACHE_DIR.\n"
+        "The loader configuration must equal the \"config\" argument of the \"obj_resource\" using the assets.",
+        {"--double_precision", "--overwrite"},
+        {"--config", "--cache_dir"});
+    try {
+        const auto args = parser.parsed(argc, argv);
+        args.assert_num_unnamed_atleast(1);
+        if (!args.has_named_value("--cache_dir") && !mesh_cache_directory().has_value()) {
+            throw std::runtime_error("Neither --cache_dir nor MESH_CACHE_DIR is set");
+        }
+        if (args.has_named("--double_precision")) {
+            warm<CompressedScenePos>(args);
+        } else {
+            warm<float>(args);
+        }
+    } catch (const std::exception& e) {
+        lerr() << e.what();
+        return 1;
+    }
+    return 0;
+}
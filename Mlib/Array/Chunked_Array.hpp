@@ -1,6 +1,7 @@
 #pragma once
 #include <Mlib/Os/Os.hpp>
 #include <optional>
+#include <utility>
 #include <vector>
 
 namespace Mlib {
@@ -76,6 +77,16 @@ public:
             : container_.back();
         return last.emplace_back(std::forward<Args>(args)...);
     }
+    void extend(ChunkedArray&& other) {
+        if (empty() && (chunk_size_ == other.chunk_size_)) {
+            container_ = std::move(other.container_);
+        } else {
+            for (auto& v : other) {
+                emplace_back(std::move(v));
+            }
+        }
+        other.container_.clear();
+    }
     auto begin() {
         return UnNestedIterator{ container_.begin(), container_.end(), 0 };
     }
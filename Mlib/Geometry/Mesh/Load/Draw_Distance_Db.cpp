@@ -20,6 +20,7 @@ void DrawDistanceDb::add_ide(const std::string& filename) {
     if (f->fail()) {
         throw std::runtime_error("Could not open \"" + filename + "\" for reading");
     }
+    source_files_.push_back(filename);
     std::string line;
     std::string section;
     while (rgetline(*f, line)) {
@@ -4,6 +4,7 @@
 #include <Mlib/Map/Map.hpp>
 #include <cstddef>
 #include <string>
+#include <vector>
 
 namespace Mlib {
 
@@ -22,8 +23,13 @@ public:
     ~DrawDistanceDb();
     void add_ide(const std::string& filename);
     const IdeItem& get_item(const std::string& resource_name) const;
+    // The IDE files added so far, s.t. caches can depend on them.
+    inline const std::vector<std::string>& source_files() const {
+        return source_files_;
+    }
 private:
     Map<std::string, IdeItem> ide_items_;
+    std::vector<std::string> source_files_;
 };
 
 }
\ No newline at end of file
@@ -870,6 +870,31 @@ std::list<std::shared_ptr<ColoredVertexArray<TPos>>> Mlib::load_kn5_array(
     return result;
 }
 
+std::vector<Utf8Path> Mlib::kn5_dependencies(const Utf8Path& filename) {
+    std::vector<Utf8Path> result{ filename };
+    for (const auto& f : {
+        filename.parent_path() / "settings.json",
+        filename.parent_path() / "extension" / "ext_config.ini" })
+    {
+        if (path_exists(f)) {
+            result.push_back(f);
+        }
+    }
+    if (filename.ends_with(".ini")) {
+        IniParser ini{filename};
+        for (const auto& [name, section] : ini.sections()) {
+            if (name.starts_with("MODEL_")) {
+                auto it = section.find("FILE");
+                if (it == section.end()) {
+                    throw std::runtime_error("Could not find FILE variable in section of INI file: \"" + filename.string() + '"');
+                }
+                result.push_back(filename.parent_path() / it->second);
+            }
+        }
+    }
+    return result;
+}
+
 template std::list<std::shared_ptr<ColoredVertexArray<float>>> Mlib::load_kn5_array<float>(
     const Utf8Path& file_or_directory,
     const LoadMeshConfig<float>&,
@@ -3,6 +3,7 @@
 #include <list>
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace Mlib {
 
@@ -22,4 +23,8 @@ std::list<std::shared_ptr<ColoredVertexArray<TPos>>> load_kn5_array(
     #endif
     IRaceLogic* race_logic);
 
+// Files read by "load_kn5_array", i.e. the KN5 or INI file, the KN5
+// files of the INI file, and the optional configuration files.
+std::vector<Utf8Path> kn5_dependencies(const Utf8Path& filename);
+
 }
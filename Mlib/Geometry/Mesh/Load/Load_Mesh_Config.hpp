@@ -10,6 +10,7 @@
 #include <Mlib/Geometry/Rectangle_Triangulation_Mode.hpp>
 #include <Mlib/Geometry/Triangle_Tangent_Error_Behavior.hpp>
 #include <Mlib/Misc/FPath.hpp>
+#include <Mlib/Os/Io/Safe_Archiver.hpp>
 #include <cstdint>
 #include <optional>
 #include <vector>
@@ -64,6 +65,49 @@ struct LoadMeshConfig {
     RectangleTriangulationMode rectangle_triangulation_mode = RectangleTriangulationMode::DELAUNAY;
     DelaunayErrorBehavior delaunay_error_behavior = DelaunayErrorBehavior::THROW;
     bool werror;
+    // Used to key the binary mesh cache, see "Mesh_Cache.hpp".
+    template <class Archive>
+    void serialize(Archive& archiver) {
+        SafeArchiver archive{archiver};
+        archive(position);
+        archive(rotation);
+        archive(scale);
+        archive(center_distances);
+        archive(max_triangle_distance);
+        archive(triangle_cluster_width);
+        archive(blend_mode);
+        archive(alpha_distances);
+        archive(cull_faces_default);
+        archive(cull_faces_alpha);
+        archive(occluded_pass);
+        archive(occluder_pass);
+        archive(anisotropic_filtering_level);
+        archive(mipmap_mode);
+        archive(magnifying_interpolation_mode);
+        archive(aggregate_mode);
+        archive(transformation_mode);
+        archive(billboard_atlas_instances);
+        archive(reflection_map);
+        archive(shading);
+        archive(emissive_factor);
+        archive(ambient_factor);
+        archive(diffuse_factor);
+        archive(specular_factor);
+        archive(desaturate);
+        archive(desaturation_exponent);
+        archive(histogram);
+        archive(lighten);
+        archive(textures);
+        archive(period_world);
+        archive(triangle_tangent_error_behavior);
+        archive(apply_static_lighting);
+        archive(laplace_ao_strength);
+        archive(dynamically_lighted);
+        archive(physics_material);
+        archive(rectangle_triangulation_mode);
+        archive(delaunay_error_behavior);
+        archive(werror);
+    }
 };
 
 }
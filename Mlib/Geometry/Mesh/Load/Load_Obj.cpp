@@ -15,33 +15,322 @@
 #include <Mlib/Math/Fixed_Rodrigues.hpp>
 #include <Mlib/Os/Os.hpp>
 #include <Mlib/Os/Weakly_Canonical_Preserve_Symlinks.hpp>
-#include <Mlib/Regex/Regex_Select.hpp>
-#include <Mlib/Regex/Template_Regex.hpp>
 #include <Mlib/Strings/String_View_To_Scene_Pos.hpp>
 #include <Mlib/Strings/Utf8_Path.hpp>
 #include <Mlib/Testing/Assert.hpp>
+#include <algorithm>
+#include <cctype>
+#include <exception>
+#include <sstream>
+#include <string_view>
+#include <thread>
 #include <vector>
 
 using namespace Mlib;
-using namespace Mlib::TemplateRegex;
 template <class TPos>
 struct ColoredVertexX {
     FixedArray<TPos, 3> position;
     FixedArray<float, 3> color;
 };
 
-bool contains_tag(const std::string& name, const std::string& tag) {
-    static std::map<std::string, Mlib::re::cregex> regexes;
-    if (!regexes.contains(tag)) {
-        regexes.insert({tag, Mlib::compile_regex("\\b" + tag + "(?:\\b|_)")});
+static bool is_word_char(char c) {
+    return std::isalnum((unsigned char)c) || (c == '_');
+}
+
+// Equivalent to searching the regex "\\b" + tag + "(?:\\b|_)".
+static bool contains_tag(std::string_view name, std::string_view tag) {
+    for (size_t pos = name.find(tag); pos != std::string_view::npos; pos = name.find(tag, pos + 1)) {
+        auto end = pos + tag.length();
+        if ((pos != 0) && is_word_char(name[pos - 1])) {
+            continue;
+        }
+        if ((end == name.length()) || !is_word_char(name[end]) || (name[end] == '_')) {
+            return true;
+        }
+    }
+    return false;
+}
+
+enum class ObjCommand: uint8_t {
+    VERTEX,
+    UV,
+    NORMAL,
+    LINE,
+    FACE3,
+    FACE4,
+    COMMENT,
+    OBJECT,
+    MTLLIB,
+    USEMTL,
+    SMOOTH_SHADING,
+    UNKNOWN,
+    ERROR
+};
+
+struct ObjRecord {
+    ObjCommand command;
+    // Line without the trailing "\r".
+    std::string_view line;
+    // Argument of "o", "g", "mtllib" and "usemtl".
+    std::string_view argument;
+};
+
+struct ObjFace {
+    FixedArray<size_t, 4> vertex_ids = uninitialized;
+    FixedArray<size_t, 4> uv_ids = uninitialized;
+    FixedArray<size_t, 4> normal_ids = uninitialized;
+};
+
+// Result of tokenizing a line-aligned part of the file.
+// Only the number conversion happens here, the geometry is created
+// sequentially afterwards, because it depends on the material state.
+template <class TPos>
+struct ObjChunk {
+    std::vector<ObjRecord> records;
+    std::vector<ColoredVertexX<TPos>> vertices;
+    UUVector<FixedArray<float, 2>> uvs;
+    UUVector<FixedArray<float, 3>> normals;
+    std::vector<ObjFace> faces;
+    std::vector<std::string> errors;
+    std::exception_ptr exception;
+};
+
+class ObjLineTokenizer {
+public:
+    explicit ObjLineTokenizer(std::string_view line)
+        : line_{ line }
+        , pos_{ 0 }
+    {}
+    // Returns an empty view if the line has no more tokens.
+    std::string_view next() {
+        skip_spaces();
+        auto begin = pos_;
+        while ((pos_ < line_.length()) && !std::isspace((unsigned char)line_[pos_])) {
+            ++pos_;
+        }
+        return line_.substr(begin, pos_ - begin);
+    }
+    template <size_t tmax_ntokens>
+    size_t tokens(std::array<std::string_view, tmax_ntokens>& result) {
+        for (size_t i = 0; i < tmax_ntokens; ++i) {
+            result[i] = next();
+            if (result[i].empty()) {
+                return i;
+            }
+        }
+        return next().empty() ? tmax_ntokens : SIZE_MAX;
+    }
+    bool space_follows() const {
+        return (pos_ < line_.length()) && std::isspace((unsigned char)line_[pos_]);
+    }
+    std::string_view rest() {
+        skip_spaces();
+        return line_.substr(pos_);
+    }
+private:
+    void skip_spaces() {
+        while ((pos_ < line_.length()) && std::isspace((unsigned char)line_[pos_])) {
+            ++pos_;
+        }
+    }
+    std::string_view line_;
+    size_t pos_;
+};
+
+static bool is_digits(std::string_view s) {
+    return !s.empty() && std::all_of(s.begin(), s.end(), [](char c){ return (c >= '0') && (c <= '9'); });
+}
+
+// Parses "v", "v/vt", "v/vt/vn", "v//vn" and "v/".
+static bool parse_face_vertex(
+    std::string_view token,
+    size_t& vertex_id,
+    size_t& uv_id,
+    size_t& normal_id)
+{
+    auto s0 = token.find('/');
+    auto v = token.substr(0, s0);
+    if (!is_digits(v)) {
+        return false;
+    }
+    vertex_id = safe_stoz(v);
+    uv_id = SIZE_MAX;
+    normal_id = SIZE_MAX;
+    if (s0 == std::string_view::npos) {
+        return true;
     }
-    return Mlib::re::regex_search(name, regexes.at(tag));
+    auto s1 = token.find('/', s0 + 1);
+    auto vt = token.substr(s0 + 1, (s1 == std::string_view::npos) ? std::string_view::npos : s1 - s0 - 1);
+    if (!vt.empty()) {
+        if (!is_digits(vt)) {
+            return false;
+        }
+        uv_id = safe_stoz(vt);
+    }
+    if (s1 == std::string_view::npos) {
+        return true;
+    }
+    auto vn = token.substr(s1 + 1);
+    if (!is_digits(vn)) {
+        return false;
+    }
+    normal_id = safe_stoz(vn);
+    return true;
+}
+
+template <class TPos>
+static ObjCommand parse_obj_line(
+    std::string_view line,
+    ObjRecord& record,
+    ObjChunk<TPos>& chunk)
+{
+    if (line[0] == '#') {
+        return ObjCommand::COMMENT;
+    }
+    ObjLineTokenizer tokenizer{ line };
+    auto command = tokenizer.next();
+    if (command.empty() || (command.data() != line.data()) || !tokenizer.space_follows()) {
+        return ObjCommand::UNKNOWN;
+    }
+    if (command == "v") {
+        std::array<std::string_view, 7> t;
+        auto n = tokenizer.tokens(t);
+        if ((n != 3) && (n != 7)) {
+            return ObjCommand::UNKNOWN;
+        }
+        if ((n == 7) && (safe_stof(t[6]) != 1)) {
+            throw std::runtime_error("vertex a != 1");
+        }
+        chunk.vertices.push_back({
+            .position = {
+                safe_sto<TPos>(t[0]),
+                safe_sto<TPos>(t[1]),
+                safe_sto<TPos>(t[2])},
+            .color = {
+                (n == 7) ? safe_stof(t[3]) : 1.f,
+                (n == 7) ? safe_stof(t[4]) : 1.f,
+                (n == 7) ? safe_stof(t[5]) : 1.f}});
+        return ObjCommand::VERTEX;
+    }
+    if (command == "vt") {
+        std::array<std::string_view, 3> t;
+        auto n = tokenizer.tokens(t);
+        if ((n != 2) && (n != 3)) {
+            return ObjCommand::UNKNOWN;
+        }
+        chunk.uvs.emplace_back(safe_stof(t[0]), safe_stof(t[1]));
+        return ObjCommand::UV;
+    }
+    if (command == "vn") {
+        std::array<std::string_view, 3> t;
+        if (tokenizer.tokens(t) != 3) {
+            return ObjCommand::UNKNOWN;
+        }
+        chunk.normals.emplace_back(safe_stof(t[0]), safe_stof(t[1]), safe_stof(t[2]));
+        return ObjCommand::NORMAL;
+    }
+    if (command == "f") {
+        std::array<std::string_view, 4> t;
+        auto n = tokenizer.tokens(t);
+        if ((n != 3) && (n != 4)) {
+            return ObjCommand::UNKNOWN;
+        }
+        ObjFace face;
+        for (size_t i = 0; i < n; ++i) {
+            if (!parse_face_vertex(t[i], face.vertex_ids(i), face.uv_ids(i), face.normal_ids(i))) {
+                return ObjCommand::UNKNOWN;
+            }
+        }
+        chunk.faces.push_back(face);
+        return (n == 3) ? ObjCommand::FACE3 : ObjCommand::FACE4;
+    }
+    if (command == "l") {
+        std::array<std::string_view, 2> t;
+        if ((tokenizer.tokens(t) != 2) || !is_digits(t[0]) || !is_digits(t[1])) {
+            return ObjCommand::UNKNOWN;
+        }
+        return ObjCommand::LINE;
+    }
+    if ((command == "o") || (command == "g")) {
+        record.argument = tokenizer.rest();
+        return ObjCommand::OBJECT;
+    }
+    if (command == "s") {
+        return ObjCommand::SMOOTH_SHADING;
+    }
+    if ((command == "mtllib") || (command == "usemtl")) {
+        record.argument = tokenizer.rest();
+        if (record.argument.empty()) {
+            return ObjCommand::UNKNOWN;
+        }
+        return (command == "mtllib") ? ObjCommand::MTLLIB : ObjCommand::USEMTL;
+    }
+    return ObjCommand::UNKNOWN;
+}
+
+template <class TPos>
+static void parse_obj_chunk(std::string_view data, ObjChunk<TPos>& chunk) {
+    try {
+        while (!data.empty()) {
+            auto eol = data.find('\n');
+            auto line = data.substr(0, eol);
+            data.remove_prefix((eol == std::string_view::npos) ? data.length() : eol + 1);
+            if (!line.empty() && (line.back() == '\r')) {
+                line.remove_suffix(1);
+            }
+            if (line.empty()) {
+                continue;
+            }
+            ObjRecord record{ .line = line };
+            try {
+                record.command = parse_obj_line(line, record, chunk);
+            } catch (const std::runtime_error& e) {
+                record.command = ObjCommand::ERROR;
+                chunk.errors.push_back(e.what());
+            }
+            chunk.records.push_back(record);
+        }
+    } catch (...) {
+        chunk.exception = std::current_exception();
+    }
+}
+
+// Splits the file into line-aligned chunks that are tokenized in parallel.
+template <class TPos>
+static std::vector<ObjChunk<TPos>> parse_obj_chunks(std::string_view data, size_t min_chunk_size) {
+    if (min_chunk_size == 0) {
+        throw std::runtime_error("Minimum OBJ chunk size is zero");
+    }
+    size_t nchunks = std::clamp<size_t>(
+        data.length() / min_chunk_size,
+        1,
+        4 * std::max(1u, std::thread::hardware_concurrency()));
+    std::vector<size_t> boundaries(nchunks + 1);
+    boundaries[0] = 0;
+    for (size_t i = 1; i < nchunks; ++i) {
+        auto b = std::max(boundaries[i - 1], i * data.length() / nchunks);
+        auto eol = data.find('\n', b);
+        boundaries[i] = (eol == std::string_view::npos) ? data.length() : eol + 1;
+    }
+    boundaries[nchunks] = data.length();
+    std::vector<ObjChunk<TPos>> chunks(nchunks);
+    #pragma omp parallel for
+    for (int i = 0; i < (int)nchunks; ++i) {
+        parse_obj_chunk(data.substr(boundaries[i], boundaries[i + 1] - boundaries[i]), chunks[i]);
+    }
+    for (const auto& c : chunks) {
+        if (c.exception != nullptr) {
+            std::rethrow_exception(c.exception);
+        }
+    }
+    return chunks;
 }
 
 template <class TPos>
 std::list<std::shared_ptr<ColoredVertexArray<TPos>>> Mlib::load_obj(
     const std::string& filename,
-    const LoadMeshConfig<TPos>& cfg)
+    const LoadMeshConfig<TPos>& cfg,
+    size_t min_chunk_size)
 {
     using Triangle = FixedArray<TPos, 3, 3>;
 
@@ -78,83 +367,21 @@ std::list<std::shared_ptr<ColoredVertexArray<TPos>>> Mlib::load_obj(
     StaticFaceLighting sfl;
 
     auto compressed_file = CompressedFile{filename};
-    auto ifs_p = compressed_file.decompressed_ifstream();
-    auto& ifs = *ifs_p;
-    if (ifs.fail()) {
-        throw std::runtime_error("Could not open OBJ file \"" + filename + '"');
+    std::string data;
+    {
+        auto ifs_p = compressed_file.decompressed_ifstream();
+        auto& ifs = *ifs_p;
+        if (ifs.fail()) {
+            throw std::runtime_error("Could not open OBJ file \"" + filename + '"');
+        }
+        std::ostringstream ostr;
+        ostr << ifs.rdbuf();
+        if (ifs.fail() && !ifs.eof()) {
+            throw std::runtime_error("Error reading from file " + filename);
+        }
+        data = std::move(ostr).str();
     }
-
-    static const auto sl = chr('/');
-    static const auto ss = star(space);
-    static const auto sp = plus(space);
-    static const auto Sp = group(plus(no_space));
-    static const auto ds = group(star(digit));
-    static const auto dp = group(plus(digit));
-    static const auto Dots = group(star(adot));
-    static const auto Dotp = group(plus(adot));
-    // static const DECLARE_REGEX(vertex_reg, "^v +(\\S+) (\\S+) (\\S+)(?: (\\S+) (\\S+) (\\S+) (\\S+))?$");
-    // static const DECLARE_REGEX(vertex_normal_reg, "^vn +(\\S+) (\\S+) (\\S+)$");
-    // static const DECLARE_REGEX(line_reg, "^l +"
-    //                           "(\\d+) "
-    //                           "(\\d+) *$");
-    // static const DECLARE_REGEX(face3_reg, "^f +"
-    //                           "(\\d+)(?:/(\\d*)(?:/(\\d+))?)? "
-    //                           "(\\d+)(?:/(\\d*)(?:/(\\d+))?)? "
-    //                           "(\\d+)(?:/(\\d*)(?:/(\\d+))?)? *$");
-    // static const DECLARE_REGEX(face4_reg, "^f +"
-    //                           "(\\d+)(?:/(\\d*)(?:/(\\d+))?)? "
-    //                           "(\\d+)(?:/(\\d*)(?:/(\\d+))?)? "
-    //                           "(\\d+)(?:/(\\d*)(?:/(\\d+))?)? "
-    //                           "(\\d+)(?:/(\\d*)(?:/(\\d+))?)? *$");
-    // static const DECLARE_REGEX(vertex_uv_texture_reg, "^vt +(\\S+) (\\S+)$");
-    // static const DECLARE_REGEX(vertex_uvw_texture_reg, "^vt +(\\S+) (\\S+) (\\S+)$");
-    // static const DECLARE_REGEX(comment_reg, "^#.*$");
-    // static const DECLARE_REGEX(mtllib_reg, "^mtllib (.+)$");
-    // static const DECLARE_REGEX(usemtl_reg, "^usemtl (.+)$");
-    // static const DECLARE_REGEX(object_reg, "^o (.*)$");
-    // static const DECLARE_REGEX(group_reg, "^g (.*)$");
-    // static const DECLARE_REGEX(smooth_shading_reg, "^s .*$");
-    static const auto vertex_reg = seq(
-        chr('v'), sp,
-        Sp, sp,
-        Sp, sp,
-        Sp, opt(seq(sp, Sp, sp, Sp, sp, Sp, sp, Sp)),
-        eof);
-    static const auto vertex_normal_reg = seq(
-        str("vn"), sp,
-        Sp, sp,
-        Sp, sp,
-        Sp, eof);
-    static const auto line_reg = seq(
-        chr('l'), sp,
-        dp, sp,
-        dp, ss, eof);
-    static const auto face3_reg = seq(
-        chr('f'), sp,
-        dp, opt(seq(sl, ds, opt(seq(sl, dp)))), sp,
-        dp, opt(seq(sl, ds, opt(seq(sl, dp)))), sp,
-        dp, opt(seq(sl, ds, opt(seq(sl, dp)))), ss, eof);
-    static const auto face4_reg = seq(
-        chr('f'), sp,
-        dp, opt(seq(sl, ds, opt(seq(sl, dp)))), sp,
-        dp, opt(seq(sl, ds, opt(seq(sl, dp)))), sp,
-        dp, opt(seq(sl, ds, opt(seq(sl, dp)))), sp,
-        dp, opt(seq(sl, ds, opt(seq(sl, dp)))), ss, eof);
-    static const auto vertex_uv_texture_reg = seq(
-        str("vt"), sp,
-        Sp, sp,
-        Sp, eof);
-    static const auto vertex_uvw_texture_reg = seq(
-        str("vt"), sp,
-        Sp, sp,
-        Sp, sp,
-        Sp, eof);
-    static const auto comment_reg = chr('#');
-    static const auto mtllib_reg = seq(str("mtllib"), sp, Dotp);
-    static const auto usemtl_reg = seq(str("usemtl"), sp, Dotp);
-    static const auto object_reg = seq(chr('o'), sp, Dots);
-    static const auto group_reg = seq(chr('g'), sp, Dots);
-    static const auto smooth_shading_reg = seq(chr('s'), sp);
+    auto chunks = parse_obj_chunks<TPos>(data, min_chunk_size);
 
     ObjMaterial current_mtl;
     bool cfg_has_alpha_texture = false;
@@ -166,274 +393,250 @@ std::list<std::shared_ptr<ColoredVertexArray<TPos>>> Mlib::load_obj(
     }
     bool has_alpha_texture = cfg_has_alpha_texture;
 
-    std::string line;
-    while(std::getline(ifs, line)) {
-        try {
-            if (line.length() > 0 && line[line.length() - 1] == '\r') {
-                line = line.substr(0, line.length() - 1);
-            }
-            if (line.length() == 0) {
-                continue;
-            }
-            if (SMatch<8> match; regex_match(line, match, vertex_reg)) {
-                float a = match[7].matched() ? safe_stof(match[7].str()) : 1;
-                if (a != 1) {
-                    throw std::runtime_error("vertex a != 1");
-                }
-                obj_vertices.push_back({
-                    .position = {
-                        safe_sto<TPos>(match[1].str()),
-                        safe_sto<TPos>(match[2].str()),
-                        safe_sto<TPos>(match[3].str())},
-                    .color = {
-                        match[4].matched() ? safe_stof(match[4].str()) : 1.f,
-                        match[5].matched() ? safe_stof(match[5].str()) : 1.f,
-                        match[6].matched() ? safe_stof(match[6].str()) : 1.f}});
-            } else if (SMatch<3> match; regex_match(line, match, vertex_uv_texture_reg)) {
-                FixedArray<float, 2> n{
-                    safe_stof(match[1].str()),
-                    safe_stof(match[2].str())};
-                obj_uvs.emplace_back(n);
-            } else if (SMatch<4> match; regex_match(line, match, vertex_uvw_texture_reg)) {
-                FixedArray<float, 2> n{
-                    safe_stof(match[1].str()),
-                    safe_stof(match[2].str())};
-                // assert_true(safe_stof(match[3].str()) == 0);
-                obj_uvs.emplace_back(n);
-            } else if (SMatch<4> match; regex_match(line, match, vertex_normal_reg)) {
-                FixedArray<float, 3> n{
-                    safe_stof(match[1].str()),
-                    safe_stof(match[2].str()),
-                    safe_stof(match[3].str())};
-                obj_normals.emplace_back(n);
-            } else if (SMatch<3> match; regex_match(line, match, line_reg)) {
-                // FixedArray<size_t, 3> vertex_ids{
-                //     safe_stoz(match[1].str()),
-                //     safe_stoz(match[2].str())};
-                // do nothing
-            } else if (SMatch<10> match; regex_match(line, match, face3_reg)) {
-                FixedArray<size_t, 3> vertex_ids{
-                    safe_stoz(match[1].str()),
-                    safe_stoz(match[4].str()),
-                    safe_stoz(match[7].str())};
-                FixedArray<size_t, 3> uv_ids{
-                    (match[2].str() != "") ? safe_stoz(match[2].str()) : SIZE_MAX,
-                    (match[5].str() != "") ? safe_stoz(match[5].str()) : SIZE_MAX,
-                    (match[8].str() != "") ? safe_stoz(match[8].str()) : SIZE_MAX };
-                assert_true(all(vertex_ids > size_t(0)));
-                assert_true(all(uv_ids > size_t(0)));
-                FixedArray<float, 3> n0 = uninitialized;
-                FixedArray<float, 3> n1 = uninitialized;
-                FixedArray<float, 3> n2 = uninitialized;
-                if (match[3].str().empty() && match[6].str().empty() && match[9].str().empty()) {
-                    auto n = triangle_normal(funpack(Triangle{
-                        obj_vertices.at(vertex_ids(0) - 1).position,
-                        obj_vertices.at(vertex_ids(1) - 1).position,
-                        obj_vertices.at(vertex_ids(2) - 1).position}),
-                        NormalVectorErrorBehavior::WARN).template casted<float>();
-                    n0 = n;
-                    n1 = n;
-                    n2 = n;
-                } else {
-                    FixedArray<size_t, 3> normal_ids{
-                        safe_stoz(match[3].str()),
-                        safe_stoz(match[6].str()),
-                        safe_stoz(match[9].str())};
-                    assert_true(all(normal_ids > size_t(0)));
-                    n0 = obj_normals.at(normal_ids(0) - 1);
-                    n1 = obj_normals.at(normal_ids(1) - 1);
-                    n2 = obj_normals.at(normal_ids(2) - 1);
-                }
-                const ColoredVertexX<TPos>& v0 = obj_vertices.at(vertex_ids(0) - 1);
-                const ColoredVertexX<TPos>& v1 = obj_vertices.at(vertex_ids(1) - 1);
-                const ColoredVertexX<TPos>& v2 = obj_vertices.at(vertex_ids(2) - 1);
-                tl.draw_triangle_with_normals(
-                    v0.position,
-                    v1.position,
-                    v2.position,
-                    n0,
-                    n1,
-                    n2,
-                    Colors::from_rgb(has_alpha_texture || !cfg.apply_static_lighting ? v0.color : sfl.get_color(current_mtl.diffuse, n0)),
-                    Colors::from_rgb(has_alpha_texture || !cfg.apply_static_lighting ? v1.color : sfl.get_color(current_mtl.diffuse, n1)),
-                    Colors::from_rgb(has_alpha_texture || !cfg.apply_static_lighting ? v2.color : sfl.get_color(current_mtl.diffuse, n2)),
-                    (uv_ids(0) != SIZE_MAX) ? obj_uvs.at(uv_ids(0) - 1) : FixedArray<float, 2>{0.f, 0.f},
-                    (uv_ids(1) != SIZE_MAX) ? obj_uvs.at(uv_ids(1) - 1) : FixedArray<float, 2>{1.f, 0.f},
-                    (uv_ids(2) != SIZE_MAX) ? obj_uvs.at(uv_ids(2) - 1) : FixedArray<float, 2>{0.f, 1.f},
-                    std::nullopt,
-                    {},
-                    {},
-                    {},
-                    cfg.triangle_tangent_error_behavior);
-            } else if (SMatch<13> match; regex_match(line, match, face4_reg)) {
-                FixedArray<size_t, 4> vertex_ids{
-                    safe_stoz(match[1].str()),
-                    safe_stoz(match[4].str()),
-                    safe_stoz(match[7].str()),
-                    safe_stoz(match[10].str())};
-                FixedArray<size_t, 4> uv_ids{
-                    (match[2].str() != "") ? safe_stoz(match[2].str()) : SIZE_MAX,
-                    (match[5].str() != "") ? safe_stoz(match[5].str()) : SIZE_MAX,
-                    (match[8].str() != "") ? safe_stoz(match[8].str()) : SIZE_MAX,
-                    (match[11].str() != "") ? safe_stoz(match[11].str()) : SIZE_MAX };
-                assert_true(all(vertex_ids > size_t(0)));
-                assert_true(all(uv_ids > size_t(0)));
-                FixedArray<float, 3> n0 = uninitialized;
-                FixedArray<float, 3> n1 = uninitialized;
-                FixedArray<float, 3> n2 = uninitialized;
-                FixedArray<float, 3> n3 = uninitialized;
-                if (match[3].str().empty() && match[6].str().empty() && match[9].str().empty()) {
-                    auto n = triangle_normal(funpack(Triangle{
-                        obj_vertices.at(vertex_ids(0) - 1).position,
-                        obj_vertices.at(vertex_ids(1) - 1).position,
-                        obj_vertices.at(vertex_ids(2) - 1).position}),
-                        NormalVectorErrorBehavior::WARN).template casted<float>();
-                    n0 = n;
-                    n1 = n;
-                    n2 = n;
-                    n3 = n;
-                } else {
-                    FixedArray<size_t, 4> normal_ids{
-                        safe_stoz(match[3].str()),
-                        safe_stoz(match[6].str()),
-                        safe_stoz(match[9].str()),
-                        safe_stoz(match[12].str())};
-                    assert_true(all(normal_ids > size_t(0)));
-                    n0 = obj_normals.at(normal_ids(0) - 1);
-                    n1 = obj_normals.at(normal_ids(1) - 1);
-                    n2 = obj_normals.at(normal_ids(2) - 1);
-                    n3 = obj_normals.at(normal_ids(3) - 1);
-                }
-                const ColoredVertexX<TPos>& v0 = obj_vertices.at(vertex_ids(0) - 1);
-                const ColoredVertexX<TPos>& v1 = obj_vertices.at(vertex_ids(1) - 1);
-                const ColoredVertexX<TPos>& v2 = obj_vertices.at(vertex_ids(2) - 1);
-                const ColoredVertexX<TPos>& v3 = obj_vertices.at(vertex_ids(3) - 1);
-                tl.draw_rectangle_with_normals(
-                    v0.position,
-                    v1.position,
-                    v2.position,
-                    v3.position,
-                    n0,
-                    n1,
-                    n2,
-                    n3,
-                    Colors::from_rgb(has_alpha_texture || !cfg.apply_static_lighting ? v0.color : sfl.get_color(current_mtl.diffuse, n0)),
-                    Colors::from_rgb(has_alpha_texture || !cfg.apply_static_lighting ? v1.color : sfl.get_color(current_mtl.diffuse, n1)),
-                    Colors::from_rgb(has_alpha_texture || !cfg.apply_static_lighting ? v2.color : sfl.get_color(current_mtl.diffuse, n2)),
-                    Colors::from_rgb(has_alpha_texture || !cfg.apply_static_lighting ? v3.color : sfl.get_color(current_mtl.diffuse, n3)),
-                    (uv_ids(0) != SIZE_MAX) ? obj_uvs.at(uv_ids(0) - 1) : FixedArray<float, 2>{0.f, 0.f},
-                    (uv_ids(1) != SIZE_MAX) ? obj_uvs.at(uv_ids(1) - 1) : FixedArray<float, 2>{1.f, 0.f},
-                    (uv_ids(2) != SIZE_MAX) ? obj_uvs.at(uv_ids(2) - 1) : FixedArray<float, 2>{1.f, 1.f},
-                    (uv_ids(3) != SIZE_MAX) ? obj_uvs.at(uv_ids(3) - 1) : FixedArray<float, 2>{0.f, 1.f},
-                    std::nullopt,
-                    {},
-                    {},
-                    {},
-                    {},
-                    cfg.triangle_tangent_error_behavior,
-                    cfg.rectangle_triangulation_mode,
-                    cfg.delaunay_error_behavior);
-            } else if (SMatch<1> match; regex_match(line, match, comment_reg)) {
-                // do nothing
-            } else if (SMatch<2> match; regex_match(line, match, object_reg) ||
-                                        regex_match(line, match, group_reg))
-            {
-                if (!tl.triangles.empty()) {
-                    result.push_back(tl.triangle_array());
-                    tl.triangles.clear();
-                }
-                tl.meta.name = { prefix, std::string{ match[1].str() } };
-            } else if (SMatch<2> match; regex_match(line, match, mtllib_reg)) {
-                mtllib_path = compressed_file.sibling(match[1].str()).path();
-                mtllib = load_mtllib(mtllib_path, cfg.werror);
-            } else if (SMatch<2> match; regex_match(line, match, usemtl_reg)) {
-                auto material_name = std::string{ match[1].str() };
-                current_mtl = mtllib.at(material_name);
-                TextureDescriptor td;
-                auto gen_texture_path = [&mtllib_path](const Utf8Path& child){
-                    if (child.empty()) {
-                        return FPath{};
+    for (const auto& chunk : chunks) {
+        auto vertex = chunk.vertices.begin();
+        auto uv = chunk.uvs.begin();
+        auto normal = chunk.normals.begin();
+        auto face_it = chunk.faces.begin();
+        auto error = chunk.errors.begin();
+        for (const auto& record : chunk.records) {
+            try {
+                switch (record.command) {
+                case ObjCommand::VERTEX:
+                    obj_vertices.push_back(*vertex++);
+                    continue;
+                case ObjCommand::UV:
+                    obj_uvs.push_back(*uv++);
+                    continue;
+                case ObjCommand::NORMAL:
+                    obj_normals.push_back(*normal++);
+                    continue;
+                case ObjCommand::LINE:
+                case ObjCommand::COMMENT:
+                case ObjCommand::SMOOTH_SHADING:
+                    continue;
+                case ObjCommand::FACE3:
+                {
+                    const ObjFace& face = *face_it++;
+                    FixedArray<size_t, 3> vertex_ids{
+                        face.vertex_ids(0),
+                        face.vertex_ids(1),
+                        face.vertex_ids(2)};
+                    FixedArray<size_t, 3> uv_ids{
+                        face.uv_ids(0),
+                        face.uv_ids(1),
+                        face.uv_ids(2)};
+                    assert_true(all(vertex_ids > size_t(0)));
+                    assert_true(all(uv_ids > size_t(0)));
+                    FixedArray<float, 3> n0 = uninitialized;
+                    FixedArray<float, 3> n1 = uninitialized;
+                    FixedArray<float, 3> n2 = uninitialized;
+                    if ((face.normal_ids(0) == SIZE_MAX) && (face.normal_ids(1) == SIZE_MAX) && (face.normal_ids(2) == SIZE_MAX)) {
+                        auto n = triangle_normal(funpack(Triangle{
+                            obj_vertices.at(vertex_ids(0) - 1).position,
+                            obj_vertices.at(vertex_ids(1) - 1).position,
+                            obj_vertices.at(vertex_ids(2) - 1).position}),
+                            NormalVectorErrorBehavior::WARN).template casted<float>();
+                        n0 = n;
+                        n1 = n;
+                        n2 = n;
+                    } else {
+                        FixedArray<size_t, 3> normal_ids{
+                            face.normal_ids(0),
+                            face.normal_ids(1),
+                            face.normal_ids(2)};
+                        assert_true(all(normal_ids > size_t(0)));
+                        assert_true(all(normal_ids != SIZE_MAX));
+                        n0 = obj_normals.at(normal_ids(0) - 1);
+                        n1 = obj_normals.at(normal_ids(1) - 1);
+                        n2 = obj_normals.at(normal_ids(2) - 1);
                     }
-                    auto p = mtllib_path.parent_path();
-                    return FPath::from_local_path(p.empty() ? child : weakly_canonical_preserve_symlinks(p / child));
-                };
-                if (!current_mtl.diffuse_texture.empty()) {
-                    td.color = ColormapWithModifiers{
-                        .filename = gen_texture_path(current_mtl.diffuse_texture),
-                        .chrominance = gen_texture_path(current_mtl.diffuse_chrominance_texture),
-                        .desaturate = cfg.desaturate,
-                        .desaturation_exponent = cfg.desaturation_exponent,
-                        .histogram = cfg.histogram,
-                        .lighten = make_orderable(cfg.lighten),
-                        .mipmap_mode = cfg.mipmap_mode,
-                        .magnifying_interpolation_mode = cfg.magnifying_interpolation_mode,
-                        .anisotropic_filtering_level = cfg.anisotropic_filtering_level }.compute_hash();
-                }
-                if (!current_mtl.specular_texture.empty()) {
-                    td.specular = ColormapWithModifiers{
-                        .filename = gen_texture_path(current_mtl.specular_texture),
-                        .color_mode = ColorMode::RGB,
-                        .mipmap_mode = cfg.mipmap_mode,
-                        .magnifying_interpolation_mode = cfg.magnifying_interpolation_mode,
-                        .anisotropic_filtering_level = cfg.anisotropic_filtering_level}.compute_hash();
-                }
-                if (!current_mtl.bump_texture.empty()) {
-                    td.normal = ColormapWithModifiers{
-                        .filename = gen_texture_path(current_mtl.bump_texture),
-                        .color_mode = ColorMode::RGB,
-                        .mipmap_mode = cfg.mipmap_mode,
-                        .magnifying_interpolation_mode = cfg.magnifying_interpolation_mode,
-                        .anisotropic_filtering_level = cfg.anisotropic_filtering_level}.compute_hash();
-                }
-                if (!td.color.filename.empty() || !td.specular.filename.empty() || !td.normal.filename.empty()) {
-                    tl.meta.material.textures_color = { {.texture_descriptor = td } };
-                    has_alpha_texture = current_mtl.has_alpha_texture;
-                } else {
-                    tl.meta.material.textures_color = cfg.textures;
-                    has_alpha_texture = cfg_has_alpha_texture;
+                    const ColoredVertexX<TPos>& v0 = obj_vertices.at(vertex_ids(0) - 1);
+                    const ColoredVertexX<TPos>& v1 = obj_vertices.at(vertex_ids(1) - 1);
+                    const ColoredVertexX<TPos>& v2 = obj_vertices.at(vertex_ids(2) - 1);
+                    tl.draw_triangle_with_normals(
+                        v0.position,
+                        v1.position,
+                        v2.position,
+                        n0,
+                        n1,
+                        n2,
+                        Colors::from_rgb(has_alpha_texture || !cfg.apply_static_lighting ? v0.color : sfl.get_color(current_mtl.diffuse, n0)),
+                        Colors::from_rgb(has_alpha_texture || !cfg.apply_static_lighting ? v1.color : sfl.get_color(current_mtl.diffuse, n1)),
+                        Colors::from_rgb(has_alpha_texture || !cfg.apply_static_lighting ? v2.color : sfl.get_color(current_mtl.diffuse, n2)),
+                        (uv_ids(0) != SIZE_MAX) ? obj_uvs.at(uv_ids(0) - 1) : FixedArray<float, 2>{0.f, 0.f},
+                        (uv_ids(1) != SIZE_MAX) ? obj_uvs.at(uv_ids(1) - 1) : FixedArray<float, 2>{1.f, 0.f},
+                        (uv_ids(2) != SIZE_MAX) ? obj_uvs.at(uv_ids(2) - 1) : FixedArray<float, 2>{0.f, 1.f},
+                        std::nullopt,
+                        {},
+                        {},
+                        {},
+                        cfg.triangle_tangent_error_behavior);
+                    continue;
                 }
-                if (has_alpha_texture || (current_mtl.alpha != 1.f)) {
-                    tl.meta.material.blend_mode = cfg.blend_mode;
-                    tl.meta.material.cull_faces = cfg.cull_faces_alpha;
-                } else {
-                    tl.meta.material.blend_mode = BlendMode::OFF;
-                    tl.meta.material.cull_faces = cfg.cull_faces_default && !contains_tag(material_name, "NoCullFaces");
-                }
-                if (contains_tag(material_name, "OccludedTypeColor")) {
-                    tl.meta.material.occluded_pass = ExternalRenderPassType::LIGHTMAP_BLACK_NODE;
-                } else {
-                    tl.meta.material.occluded_pass = cfg.occluded_pass;
+                case ObjCommand::FACE4:
+                {
+                    const ObjFace& face = *face_it++;
+                    const FixedArray<size_t, 4>& vertex_ids = face.vertex_ids;
+                    const FixedArray<size_t, 4>& uv_ids = face.uv_ids;
+                    assert_true(all(vertex_ids > size_t(0)));
+                    assert_true(all(uv_ids > size_t(0)));
+                    FixedArray<float, 3> n0 = uninitialized;
+                    FixedArray<float, 3> n1 = uninitialized;
+                    FixedArray<float, 3> n2 = uninitialized;
+                    FixedArray<float, 3> n3 = uninitialized;
+                    if ((face.normal_ids(0) == SIZE_MAX) && (face.normal_ids(1) == SIZE_MAX) && (face.normal_ids(2) == SIZE_MAX)) {
+                        auto n = triangle_normal(funpack(Triangle{
+                            obj_vertices.at(vertex_ids(0) - 1).position,
+                            obj_vertices.at(vertex_ids(1) - 1).position,
+                            obj_vertices.at(vertex_ids(2) - 1).position}),
+                            NormalVectorErrorBehavior::WARN).template casted<float>();
+                        n0 = n;
+                        n1 = n;
+                        n2 = n;
+                        n3 = n;
+                    } else {
+                        const FixedArray<size_t, 4>& normal_ids = face.normal_ids;
+                        assert_true(all(normal_ids > size_t(0)));
+                        assert_true(all(normal_ids != SIZE_MAX));
+                        n0 = obj_normals.at(normal_ids(0) - 1);
+                        n1 = obj_normals.at(normal_ids(1) - 1);
+                        n2 = obj_normals.at(normal_ids(2) - 1);
+                        n3 = obj_normals.at(normal_ids(3) - 1);
+                    }
+                    const ColoredVertexX<TPos>& v0 = obj_vertices.at(vertex_ids(0) - 1);
+                    const ColoredVertexX<TPos>& v1 = obj_vertices.at(vertex_ids(1) - 1);
+                    const ColoredVertexX<TPos>& v2 = obj_vertices.at(vertex_ids(2) - 1);
+                    const ColoredVertexX<TPos>& v3 = obj_vertices.at(vertex_ids(3) - 1);
+                    tl.draw_rectangle_with_normals(
+                        v0.position,
+                        v1.position,
+                        v2.position,
+                        v3.position,
+                        n0,
+                        n1,
+                        n2,
+                        n3,
+                        Colors::from_rgb(has_alpha_texture || !cfg.apply_static_lighting ? v0.color : sfl.get_color(current_mtl.diffuse, n0)),
+                        Colors::from_rgb(has_alpha_texture || !cfg.apply_static_lighting ? v1.color : sfl.get_color(current_mtl.diffuse, n1)),
+                        Colors::from_rgb(has_alpha_texture || !cfg.apply_static_lighting ? v2.color : sfl.get_color(current_mtl.diffuse, n2)),
+                        Colors::from_rgb(has_alpha_texture || !cfg.apply_static_lighting ? v3.color : sfl.get_color(current_mtl.diffuse, n3)),
+                        (uv_ids(0) != SIZE_MAX) ? obj_uvs.at(uv_ids(0) - 1) : FixedArray<float, 2>{0.f, 0.f},
+                        (uv_ids(1) != SIZE_MAX) ? obj_uvs.at(uv_ids(1) - 1) : FixedArray<float, 2>{1.f, 0.f},
+                        (uv_ids(2) != SIZE_MAX) ? obj_uvs.at(uv_ids(2) - 1) : FixedArray<float, 2>{1.f, 1.f},
+                        (uv_ids(3) != SIZE_MAX) ? obj_uvs.at(uv_ids(3) - 1) : FixedArray<float, 2>{0.f, 1.f},
+                        std::nullopt,
+                        {},
+                        {},
+                        {},
+                        {},
+                        cfg.triangle_tangent_error_behavior,
+                        cfg.rectangle_triangulation_mode,
+                        cfg.delaunay_error_behavior);
+                    continue;
                 }
-                if (contains_tag(material_name, "OccluderTypeWhite")) {
-                    tl.meta.material.occluder_pass = ExternalRenderPassType::NONE;
-                } else {
-                    tl.meta.material.occluder_pass = cfg.occluder_pass;
+                case ObjCommand::OBJECT:
+                    if (!tl.triangles.empty()) {
+                        result.push_back(tl.triangle_array());
+                        tl.triangles.clear();
+                    }
+                    tl.meta.name = { prefix, std::string{ record.argument } };
+                    continue;
+                case ObjCommand::MTLLIB:
+                    mtllib_path = compressed_file.sibling(std::string{ record.argument }).path();
+                    mtllib = load_mtllib(mtllib_path, cfg.werror);
+                    continue;
+                case ObjCommand::USEMTL:
+                {
+                    auto material_name = std::string{ record.argument };
+                    current_mtl = mtllib.at(material_name);
+                    TextureDescriptor td;
+                    auto gen_texture_path = [&mtllib_path](const Utf8Path& child){
+                        if (child.empty()) {
+                            return FPath{};
+                        }
+                        auto p = mtllib_path.parent_path();
+                        return FPath::from_local_path(p.empty() ? child : weakly_canonical_preserve_symlinks(p / child));
+                    };
+                    if (!current_mtl.diffuse_texture.empty()) {
+                        td.color = ColormapWithModifiers{
+                            .filename = gen_texture_path(current_mtl.diffuse_texture),
+                            .chrominance = gen_texture_path(current_mtl.diffuse_chrominance_texture),
+                            .desaturate = cfg.desaturate,
+                            .desaturation_exponent = cfg.desaturation_exponent,
+                            .histogram = cfg.histogram,
+                            .lighten = make_orderable(cfg.lighten),
+                            .mipmap_mode = cfg.mipmap_mode,
+                            .magnifying_interpolation_mode = cfg.magnifying_interpolation_mode,
+                            .anisotropic_filtering_level = cfg.anisotropic_filtering_level }.compute_hash();
+                    }
+                    if (!current_mtl.specular_texture.empty()) {
+                        td.specular = ColormapWithModifiers{
+                            .filename = gen_texture_path(current_mtl.specular_texture),
+                            .color_mode = ColorMode::RGB,
+                            .mipmap_mode = cfg.mipmap_mode,
+                            .magnifying_interpolation_mode = cfg.magnifying_interpolation_mode,
+                            .anisotropic_filtering_level = cfg.anisotropic_filtering_level}.compute_hash();
+                    }
+                    if (!current_mtl.bump_texture.empty()) {
+                        td.normal = ColormapWithModifiers{
+                            .filename = gen_texture_path(current_mtl.bump_texture),
+                            .color_mode = ColorMode::RGB,
+                            .mipmap_mode = cfg.mipmap_mode,
+                            .magnifying_interpolation_mode = cfg.magnifying_interpolation_mode,
+                            .anisotropic_filtering_level = cfg.anisotropic_filtering_level}.compute_hash();
+                    }
+                    if (!td.color.filename.empty() || !td.specular.filename.empty() || !td.normal.filename.empty()) {
+                        tl.meta.material.textures_color = { {.texture_descriptor = td } };
+                        has_alpha_texture = current_mtl.has_alpha_texture;
+                    } else {
+                        tl.meta.material.textures_color = cfg.textures;
+                        has_alpha_texture = cfg_has_alpha_texture;
+                    }
+                    if (has_alpha_texture || (current_mtl.alpha != 1.f)) {
+                        tl.meta.material.blend_mode = cfg.blend_mode;
+                        tl.meta.material.cull_faces = cfg.cull_faces_alpha;
+                    } else {
+                        tl.meta.material.blend_mode = BlendMode::OFF;
+                        tl.meta.material.cull_faces = cfg.cull_faces_default && !contains_tag(material_name, "NoCullFaces");
+                    }
+                    if (contains_tag(material_name, "OccludedTypeColor")) {
+                        tl.meta.material.occluded_pass = ExternalRenderPassType::LIGHTMAP_BLACK_NODE;
+                    } else {
+                        tl.meta.material.occluded_pass = cfg.occluded_pass;
+                    }
+                    if (contains_tag(material_name, "OccluderTypeWhite")) {
+                        tl.meta.material.occluder_pass = ExternalRenderPassType::NONE;
+                    } else {
+                        tl.meta.material.occluder_pass = cfg.occluder_pass;
+                    }
+                    tl.meta.material.shading.emissive = current_mtl.emissive;
+                    tl.meta.material.shading.ambient = current_mtl.ambient;
+                    tl.meta.material.shading.diffuse = current_mtl.diffuse;
+                    tl.meta.material.shading.specular = current_mtl.specular;
+                    tl.meta.material.shading.specular_exponent = current_mtl.specular_exponent;
+                    tl.meta.material.alpha = current_mtl.alpha;
+                    tl.meta.material.compute_color_mode();
+                    continue;
                 }
-                tl.meta.material.shading.emissive = current_mtl.emissive;
-                tl.meta.material.shading.ambient = current_mtl.ambient;
-                tl.meta.material.shading.diffuse = current_mtl.diffuse;
-                tl.meta.material.shading.specular = current_mtl.specular;
-                tl.meta.material.shading.specular_exponent = current_mtl.specular_exponent;
-                tl.meta.material.alpha = current_mtl.alpha;
-                tl.meta.material.compute_color_mode();
-            } else if (SMatch<1> match; regex_match(line, match, smooth_shading_reg)) {
-                // do nothing
-            } else {
-                if (cfg.werror) {
-                    throw std::runtime_error("Could not parse line");
-                } else {
-                    lerr() << "WARNING: Could not parse line: " + line;
+                case ObjCommand::UNKNOWN:
+                    if (cfg.werror) {
+                        throw std::runtime_error("Could not parse line");
+                    } else {
+                        lerr() << "WARNING: Could not parse line: " + std::string{ record.line };
+                    }
+                    continue;
+                case ObjCommand::ERROR:
+                    throw std::runtime_error(*error++);
                 }
+                throw std::runtime_error("Unknown OBJ command");
+            } catch (const std::runtime_error& e) {
+                throw std::runtime_error("Error in line: \"" + std::string{ record.line } + "\", " + e.what());
+            } catch (const std::out_of_range& e) {
+                throw std::runtime_error("Error in line: \"" + std::string{ record.line } + "\", " + e.what());
             }
-        } catch (const std::runtime_error& e) {
-            throw std::runtime_error("Error in line: \"" + line + "\", " + e.what());
-        } catch (const std::out_of_range& e) {
-            throw std::runtime_error("Error in line: \"" + line + "\", " + e.what());
         }
     }
-    if (!ifs.eof() && ifs.fail()) {
-        throw std::runtime_error("Error reading from file " + filename);
-    }
     result.push_back(tl.triangle_array());
     VertexTransformation<TPos> vtrafo{
         cfg.position,
@@ -465,7 +668,34 @@ std::list<std::shared_ptr<ColoredVertexArray<TPos>>> Mlib::load_obj(
     return result;
 }
 
+std::vector<Utf8Path> Mlib::obj_dependencies(const std::string& filename) {
+    auto compressed_file = CompressedFile{filename};
+    auto ifs_p = compressed_file.decompressed_ifstream();
+    auto& ifs = *ifs_p;
+    if (ifs.fail()) {
+        throw std::runtime_error("Could not open OBJ file \"" + filename + '"');
+    }
+    std::vector<Utf8Path> result{ compressed_file.path() };
+    std::string line;
+    while (std::getline(ifs, line)) {
+        std::istringstream sstr{ line };
+        std::string command;
+        if (!(sstr >> command) || (command != "mtllib")) {
+            continue;
+        }
+        // "mtllib" may list several files, separated by whitespace.
+        std::string mtllib;
+        while (sstr >> mtllib) {
+            result.push_back(compressed_file.sibling(mtllib).path());
+        }
+    }
+    if (!ifs.eof() && ifs.fail()) {
+        throw std::runtime_error("Error reading from file " + filename);
+    }
+    return result;
+}
+
 template std::list<std::shared_ptr<ColoredVertexArray<float>>> Mlib::load_obj<float>(
-    const std::string& filename, const LoadMeshConfig<float>& cfg);
+    const std::string& filename, const LoadMeshConfig<float>& cfg, size_t min_chunk_size);
 template std::list<std::shared_ptr<ColoredVertexArray<CompressedScenePos>>> Mlib::load_obj<CompressedScenePos>(
-    const std::string& filename, const LoadMeshConfig<CompressedScenePos>& cfg);
+    const std::string& filename, const LoadMeshConfig<CompressedScenePos>& cfg, size_t min_chunk_size);
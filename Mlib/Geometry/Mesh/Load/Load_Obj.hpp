@@ -1,18 +1,30 @@
 #pragma once
+#include <cstddef>
 #include <list>
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace Mlib {
 
+class Utf8Path;
+
 template <class TPos>
 class ColoredVertexArray;
 template <class TPos>
 struct LoadMeshConfig;
 
+// The file is split into line-aligned chunks of at least this size,
+// which are tokenized in parallel.
+static const size_t OBJ_MIN_CHUNK_SIZE = 1 << 20;
+
 template <class TPos>
 std::list<std::shared_ptr<ColoredVertexArray<TPos>>> load_obj(
     const std::string& filename,
-    const LoadMeshConfig<TPos>& cfg);
+    const LoadMeshConfig<TPos>& cfg,
+    size_t min_chunk_size = OBJ_MIN_CHUNK_SIZE);
+
+// The OBJ file and the material libraries it references.
+std::vector<Utf8Path> obj_dependencies(const std::string& filename);
 
 }
@@ -0,0 +1,721 @@
+#include "Mesh_Cache.hpp"
+#include <Mlib/Geometry/Colored_Vertex.hpp>
+#include <Mlib/Geometry/Instance/Rendering_Dynamics.hpp>
+#include <Mlib/Geometry/Material/Colormap_With_Modifiers.hpp>
+#include <Mlib/Geometry/Mesh/Animated_Colored_Vertex_Arrays.hpp>
+#include <Mlib/Geometry/Mesh/Bone.hpp>
+#include <Mlib/Geometry/Mesh/Colored_Vertex_Array.hpp>
+#include <Mlib/Geometry/Mesh/Load/Load_Mesh_Config.hpp>
+#include <Mlib/Geometry/Mesh/Load/Load_Pssg_Arrays.hpp>
+#include <Mlib/Hashing/Fnv1a.hpp>
+#include <Mlib/Images/Flip_Mode.hpp>
+#include <Mlib/Math/Transformation/Transformation_Matrix.hpp>
+#include <Mlib/Memory/Integral_Cast.hpp>
+#include <Mlib/Os/Env.hpp>
+#include <Mlib/Os/Io/Serialize/Serialization_Context_Read.hpp>
+#include <Mlib/Os/Io/Serialize/Serialization_Context_Write.hpp>
+#include <Mlib/Os/Io/Serialize/Serialize.hpp>
+#include <Mlib/Os/Os.hpp>
+#include <filesystem>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+
+using namespace Mlib;
+
+static const uint32_t MESH_CACHE_MAGIC = 0x434d4c4d; // "MLMC"
+// Increment when the layout of the cache or of any serialized class changes.
+static const uint32_t MESH_CACHE_VERSION = 2;
+
+struct MeshSideEffects::Texture {
+    ColormapWithModifiers name;
+    std::vector<std::byte> data;
+    FlipMode flip_mode;
+    TextureAlreadyExistsBehavior already_exists_behavior;
+};
+
+struct MeshSideEffects::StartPose {
+    TransformationMatrix<float, ScenePos, 3> pose;
+    FixedArray<float, 3> velocity;
+    FixedArray<float, 3> angular_velocity;
+    uint32_t rank;
+};
+
+std::optional<Utf8Path> Mlib::mesh_cache_directory() {
+    auto dir = try_getenv("MESH_CACHE_DIR");
+    if (!dir.has_value() || dir->empty()) {
+        return std::nullopt;
+    }
+    return Utf8Path{ *dir };
+}
+
+// The cache is only valid on this machine, so a source file is
+// identified by its absolute path, its size and its modification
+// time, which avoids reading it.
+static void update_file_stamp(Fnv1a& hasher, const Utf8Path& filename) {
+    auto absolute = filename.absolute().string();
+    hasher.update_value(absolute.size());
+    hasher.update(absolute);
+    const std::filesystem::path& path = filename;
+    hasher.update_value((uint64_t)std::filesystem::file_size(path));
+    hasher.update_value((int64_t)std::filesystem::last_write_time(path).time_since_epoch().count());
+}
+
+template <class TPos>
+static uint64_t mesh_cache_key(
+    const std::vector<Utf8Path>& source_filenames,
+    std::string_view loader_name,
+    const LoadMeshConfig<TPos>& cfg)
+{
+    Fnv1a hasher;
+    hasher.update_value(MESH_CACHE_VERSION);
+    hasher.update_value(sizeof(TPos));
+    hasher.update(loader_name);
+    for (const auto& f : source_filenames) {
+        update_file_stamp(hasher, f);
+    }
+    for (const auto* dependency : { &cfg.histogram, &cfg.reflection_map }) {
+        if ((dependency->type() == PathType::LOCAL_PATH) && path_exists(dependency->local_path())) {
+            update_file_stamp(hasher, dependency->local_path());
+        }
+    }
+    std::ostringstream ostr;
+    {
+        SerializationContextWrite ctx;
+        ctx.allow_local_paths = true;
+        BinaryBitwiseWordsWriter writer{ ostr, &ctx };
+        WritingArchive oarchive{ writer, "mesh config" };
+        oarchive(const_cast<LoadMeshConfig<TPos>&>(cfg));
+    }
+    hasher.update(ostr.view());
+    return hasher.digest();
+}
+
+// Plain vertex data is written as one raw block, without per-element
+// serialization. "FixedPointNumber" is not trivially copyable, but is
+// plain data nonetheless.
+template <class T>
+concept BulkCopyable = std::is_standard_layout_v<T> && std::is_trivially_destructible_v<T>;
+
+template <class TVec>
+static void write_bulk(
+    std::ostream& ostr,
+    BinaryBitwiseWordsWriter& writer,
+    const TVec& vec,
+    std::string_view message)
+{
+    static_assert(BulkCopyable<typename TVec::value_type>);
+    writer.write_binary(integral_cast<uint32_t>(vec.size()), message);
+    writer.flush_partial(message);
+    ostr.write(
+        reinterpret_cast<const char*>(vec.data()),
+        integral_cast<std::streamsize>(sizeof(typename TVec::value_type) * vec.size()));
+}
+
+template <class TVec>
+static void read_bulk(
+    BinaryBitwiseWordsReader& reader,
+    TVec& vec,
+    std::string_view message)
+{
+    static_assert(BulkCopyable<typename TVec::value_type>);
+    vec.resize(reader.read_binary<uint32_t>(message));
+    reader.read_vector(vec, message);
+}
+
+template <class TPos>
+static void write_cva(
+    std::ostream& ostr,
+    BinaryBitwiseWordsWriter& writer,
+    const ColoredVertexArray<TPos>& cva)
+{
+    WritingArchive archive{ writer, "mesh cache" };
+    archive(cva.meta);
+    write_bulk(ostr, writer, cva.quads, "quads");
+    write_bulk(ostr, writer, cva.triangles, "triangles");
+    write_bulk(ostr, writer, cva.lines, "lines");
+    archive(cva.triangle_bone_weights);
+    write_bulk(ostr, writer, cva.continuous_triangle_texture_layers, "continuous layers");
+    write_bulk(ostr, writer, cva.discrete_triangle_texture_layers, "discrete layers");
+    writer.write_binary(integral_cast<uint32_t>(cva.uv1.size()), "#uv1");
+    for (const auto& uv : cva.uv1) {
+        write_bulk(ostr, writer, uv, "uv1");
+    }
+    writer.write_binary(integral_cast<uint32_t>(cva.cweight.size()), "#cweight");
+    for (const auto& cw : cva.cweight) {
+        write_bulk(ostr, writer, cw, "cweight");
+    }
+    write_bulk(ostr, writer, cva.alpha, "alpha");
+    write_bulk(ostr, writer, cva.interiormap_uvmaps, "interiormap uvmaps");
+}
+
+template <class TPos>
+static std::shared_ptr<ColoredVertexArray<TPos>> read_cva(BinaryBitwiseWordsReader& reader) {
+    ReadingArchive archive{ reader, "mesh cache" };
+    MeshMeta meta;
+    UUVector<FixedArray<ColoredVertex<TPos>, 4>> quads;
+    UUVector<FixedArray<ColoredVertex<TPos>, 3>> triangles;
+    UUVector<FixedArray<ColoredVertex<TPos>, 2>> lines;
+    UUVector<FixedArray<std::vector<BoneWeight>, 3>> triangle_bone_weights;
+    UUVector<FixedArray<float, 3>> continuous_triangle_texture_layers;
+    UUVector<FixedArray<uint8_t, 3>> discrete_triangle_texture_layers;
+    std::vector<UUVector<FixedArray<float, 3, 2>>> uv1;
+    std::vector<UUVector<FixedArray<float, 3>>> cweight;
+    UUVector<FixedArray<float, 3>> alpha;
+    UUVector<FixedArray<float, 4>> interiormap_uvmaps;
+
+    archive(meta);
+    read_bulk(reader, quads, "quads");
+    read_bulk(reader, triangles, "triangles");
+    read_bulk(reader, lines, "lines");
+    archive(triangle_bone_weights);
+    read_bulk(reader, continuous_triangle_texture_layers, "continuous layers");
+    read_bulk(reader, discrete_triangle_texture_layers, "discrete layers");
+    uv1.resize(reader.read_binary<uint32_t>("#uv1"));
+    for (auto& uv : uv1) {
+        read_bulk(reader, uv, "uv1");
+    }
+    cweight.resize(reader.read_binary<uint32_t>("#cweight"));
+    for (auto& cw : cweight) {
+        read_bulk(reader, cw, "cweight");
+    }
+    read_bulk(reader, alpha, "alpha");
+    read_bulk(reader, interiormap_uvmaps, "interiormap uvmaps");
+    return std::make_shared<ColoredVertexArray<TPos>>(
+        std::move(meta.name),
+        std::move(meta.material),
+        std::move(meta.morphology),
+        std::move(meta.modifier_backlog),
+        std::move(quads),
+        std::move(triangles),
+        std::move(lines),
+        std::move(triangle_bone_weights),
+        std::move(continuous_triangle_texture_layers),
+        std::move(discrete_triangle_texture_layers),
+        std::move(uv1),
+        std::move(cweight),
+        std::move(alpha),
+        std::move(interiormap_uvmaps));
+}
+
+template <class TPos>
+static void write_cvas(
+    std::ostream& ostr,
+    BinaryBitwiseWordsWriter& writer,
+    const std::list<std::shared_ptr<ColoredVertexArray<TPos>>>& cvas)
+{
+    writer.write_binary(integral_cast<uint32_t>(cvas.size()), "#arrays");
+    for (const auto& cva : cvas) {
+        write_cva(ostr, writer, *cva);
+    }
+}
+
+template <class TPos>
+static std::list<std::shared_ptr<ColoredVertexArray<TPos>>> read_cvas(
+    BinaryBitwiseWordsReader& reader)
+{
+    std::list<std::shared_ptr<ColoredVertexArray<TPos>>> result;
+    auto ncvas = reader.read_binary<uint32_t>("#arrays");
+    for (uint32_t i = 0; i < ncvas; ++i) {
+        result.push_back(read_cva<TPos>(reader));
+    }
+    return result;
+}
+
+MeshSideEffects::MeshSideEffects() = default;
+
+MeshSideEffects::~MeshSideEffects() = default;
+
+void MeshSideEffects::add_texture(
+    const ColormapWithModifiers& name,
+    std::vector<std::byte>&& data,
+    FlipMode flip_mode,
+    TextureAlreadyExistsBehavior already_exists_behavior)
+{
+    textures_.emplace_back(name, std::move(data), flip_mode, already_exists_behavior);
+}
+
+void MeshSideEffects::set_start_pose(
+    const TransformationMatrix<float, ScenePos, 3>& pose,
+    const FixedArray<float, 3>& velocity,
+    const FixedArray<float, 3>& angular_velocity,
+    uint32_t rank)
+{
+    start_poses_.emplace_back(pose, velocity, angular_velocity, rank);
+}
+
+void MeshSideEffects::set_checkpoints(
+    const std::vector<TransformationMatrix<float, ScenePos, 3>>& checkpoints)
+{
+    checkpoints_.push_back(checkpoints);
+}
+
+void MeshSideEffects::set_circularity(bool is_circular) {
+    circularities_.push_back(is_circular);
+}
+
+void MeshSideEffects::replay(IDdsResources* dds_resources, IRaceLogic* race_logic) {
+    if (dds_resources != nullptr) {
+        for (auto& t : textures_) {
+            dds_resources->add_texture(t.name, std::move(t.data), t.flip_mode, t.already_exists_behavior);
+        }
+    }
+    if (race_logic != nullptr) {
+        for (const auto& p : start_poses_) {
+            race_logic->set_start_pose(p.pose, p.velocity, p.angular_velocity, p.rank);
+        }
+        for (const auto& c : checkpoints_) {
+            race_logic->set_checkpoints(c);
+        }
+        for (bool c : circularities_) {
+            race_logic->set_circularity(c);
+        }
+    }
+}
+
+void MeshSideEffects::write(std::ostream& ostr, BinaryBitwiseWordsWriter& writer) const {
+    WritingArchive archive{ writer, "mesh side effects" };
+    writer.write_binary(integral_cast<uint32_t>(textures_.size()), "#textures");
+    for (const auto& t : textures_) {
+        archive(t.name);
+        archive(t.flip_mode);
+        archive(t.already_exists_behavior);
+        write_bulk(ostr, writer, t.data, "texture data");
+    }
+    writer.write_binary(integral_cast<uint32_t>(start_poses_.size()), "#start poses");
+    for (const auto& p : start_poses_) {
+        archive(p.pose);
+        archive(p.velocity);
+        archive(p.angular_velocity);
+        archive(p.rank);
+    }
+    writer.write_binary(integral_cast<uint32_t>(checkpoints_.size()), "#checkpoint lists");
+    for (const auto& c : checkpoints_) {
+        writer.write_binary(integral_cast<uint32_t>(c.size()), "#checkpoints");
+        for (const auto& t : c) {
+            archive(t);
+        }
+    }
+    writer.write_binary(integral_cast<uint32_t>(circularities_.size()), "#circularities");
+    for (bool c : circularities_) {
+        archive(c);
+    }
+}
+
+void MeshSideEffects::read(BinaryBitwiseWordsReader& reader) {
+    ReadingArchive archive{ reader, "mesh side effects" };
+    textures_.resize(reader.read_binary<uint32_t>("#textures"));
+    for (auto& t : textures_) {
+        archive(t.name);
+        archive(t.flip_mode);
+        archive(t.already_exists_behavior);
+        read_bulk(reader, t.data, "texture data");
+    }
+    auto nstart_poses = reader.read_binary<uint32_t>("#start poses");
+    start_poses_.clear();
+    start_poses_.reserve(nstart_poses);
+    for (uint32_t i = 0; i < nstart_poses; ++i) {
+        auto& p = start_poses_.emplace_back(
+            TransformationMatrix<float, ScenePos, 3>{ uninitialized },
+            FixedArray<float, 3>{ uninitialized },
+            FixedArray<float, 3>{ uninitialized },
+            0);
+        archive(p.pose);
+        archive(p.velocity);
+        archive(p.angular_velocity);
+        archive(p.rank);
+    }
+    checkpoints_.resize(reader.read_binary<uint32_t>("#checkpoint lists"));
+    for (auto& c : checkpoints_) {
+        c.resize(reader.read_binary<uint32_t>("#checkpoints"), uninitialized);
+        for (auto& t : c) {
+            archive(t);
+        }
+    }
+    circularities_.resize(reader.read_binary<uint32_t>("#circularities"));
+    for (auto&& c : circularities_) {
+        bool v;
+        archive(v);
+        c = v;
+    }
+}
+
+static void write_payload(
+    std::ostream& ostr,
+    BinaryBitwiseWordsWriter& writer,
+    const std::shared_ptr<AnimatedColoredVertexArrays>& acvas)
+{
+    WritingArchive archive{ writer, "mesh cache" };
+    archive(acvas->skeleton);
+    archive(acvas->bone_indices.elements());
+    write_cvas(ostr, writer, acvas->scvas);
+    write_cvas(ostr, writer, acvas->dcvas);
+}
+
+static void read_payload(
+    BinaryBitwiseWordsReader& reader,
+    std::shared_ptr<AnimatedColoredVertexArrays>& acvas)
+{
+    ReadingArchive archive{ reader, "mesh cache" };
+    acvas = std::make_shared<AnimatedColoredVertexArrays>();
+    archive(acvas->skeleton);
+    archive(acvas->bone_indices.elements());
+    acvas->scvas = read_cvas<float>(reader);
+    acvas->dcvas = read_cvas<CompressedScenePos>(reader);
+}
+
+template <class TResourcePos, class TInstancePos>
+static void write_payload(
+    std::ostream& ostr,
+    BinaryBitwiseWordsWriter& writer,
+    const PssgArrays<TResourcePos, TInstancePos>& arrays)
+{
+    WritingArchive archive{ writer, "pssg cache" };
+    writer.write_binary(integral_cast<uint32_t>(std::distance(arrays.resources.begin(), arrays.resources.end())), "#resources");
+    for (const auto& [name, cva] : arrays.resources) {
+        archive(name);
+        write_cva(ostr, writer, *cva);
+    }
+    writer.write_binary(integral_cast<uint32_t>(arrays.instances.size()), "#instances");
+    for (const auto& i : arrays.instances) {
+        archive(i.resource_name);
+        archive(i.trafo);
+        archive(i.scale);
+        archive(i.rendering_dynamics);
+    }
+}
+
+template <class TResourcePos, class TInstancePos>
+static void read_payload(
+    BinaryBitwiseWordsReader& reader,
+    PssgArrays<TResourcePos, TInstancePos>& arrays)
+{
+    ReadingArchive archive{ reader, "pssg cache" };
+    auto nresources = reader.read_binary<uint32_t>("#resources");
+    for (uint32_t i = 0; i < nresources; ++i) {
+        VariableAndHash<std::string> name;
+        archive(name);
+        arrays.resources.add(std::move(name), read_cva<TResourcePos>(reader));
+    }
+    auto ninstances = reader.read_binary<uint32_t>("#instances");
+    for (uint32_t i = 0; i < ninstances; ++i) {
+        auto& ins = arrays.instances.emplace_back(
+            VariableAndHash<std::string>{},
+            TransformationMatrix<float, TInstancePos, 3>::identity(),
+            1.f,
+            RenderingDynamics::STATIC);
+        archive(ins.resource_name);
+        archive(ins.trafo);
+        archive(ins.scale);
+        archive(ins.rendering_dynamics);
+    }
+}
+
+template <class TResult>
+static std::optional<TResult> read_entry(
+    const Utf8Path& filename,
+    uint64_t key,
+    MeshSideEffects& side_effects)
+{
+    auto ifstr = create_ifstream(filename, std::ios::binary);
+    if (ifstr->fail()) {
+        return std::nullopt;
+    }
+    SerializationContextRead ctx;
+    ctx.allow_local_paths = true;
+    BinaryBitwiseWordsReader reader{ *ifstr, &ctx, IoVerbosity::SILENT };
+    if ((reader.read_binary<uint32_t>("magic") != MESH_CACHE_MAGIC) ||
+        (reader.read_binary<uint32_t>("version") != MESH_CACHE_VERSION) ||
+        (reader.read_binary<uint64_t, true>("key") != key))
+    {
+        return std::nullopt;
+    }
+    side_effects.read(reader);
+    TResult result;
+    read_payload(reader, result);
+    return result;
+}
+
+template <class TResult>
+static void write_entry(
+    const Utf8Path& filename,
+    uint64_t key,
+    const MeshSideEffects& side_effects,
+    const TResult& result)
+{
+    // Write to a temporary file first, so that concurrent loaders
+    // never observe a partially written entry.
+    std::stringstream tmp_suffix;
+    tmp_suffix << ".tmp" << std::this_thread::get_id();
+    auto tmp_filename = filename.string() + tmp_suffix.str();
+    {
+        auto ofstr = create_ofstream(tmp_filename, std::ios::binary);
+        if (ofstr->fail()) {
+            throw std::runtime_error("Could not open mesh cache file \"" + tmp_filename + "\" for write");
+        }
+        SerializationContextWrite ctx;
+        ctx.allow_local_paths = true;
+        BinaryBitwiseWordsWriter writer{ *ofstr, &ctx };
+        writer.write_binary(MESH_CACHE_MAGIC, "magic");
+        writer.write_binary(MESH_CACHE_VERSION, "version");
+        writer.write_binary<uint64_t, true>(key, "key");
+        side_effects.write(*ofstr, writer);
+        write_payload(*ofstr, writer, result);
+        writer.flush_partial("mesh cache");
+        ofstr->flush();
+        if (ofstr->fail()) {
+            throw std::runtime_error("Could not write mesh cache file \"" + tmp_filename + '"');
+        }
+    }
+    try {
+        if (path_exists(filename)) {
+            remove_path(filename);
+        }
+        rename_path(tmp_filename, filename);
+    } catch (const std::runtime_error&) {
+        // Another thread or process won the race, its entry is equivalent.
+        remove_path(tmp_filename);
+    }
+}
+
+template <class TPos, class TResult>
+static TResult load_cached(
+    const Utf8Path& cache_directory,
+    const std::vector<Utf8Path>& source_filenames,
+    std::string_view loader_name,
+    const LoadMeshConfig<TPos>& cfg,
+    const std::function<TResult(MeshSideEffects&)>& load,
+    IDdsResources* dds_resources,
+    IRaceLogic* race_logic,
+    MeshCacheMode mode)
+{
+    if (source_filenames.empty()) {
+        throw std::runtime_error("Mesh cache requires at least one source file");
+    }
+    auto key = mesh_cache_key(source_filenames, loader_name, cfg);
+    std::stringstream entry_name;
+    entry_name <<
+        source_filenames.front().filename().string() << '_' <<
+        std::hex << std::setw(16) << std::setfill('0') << key << ".mesh";
+    auto entry_filename = cache_directory / entry_name.str();
+    if (mode == MeshCacheMode::READ_WRITE) {
+        try {
+            MeshSideEffects side_effects;
+            if (auto result = read_entry<TResult>(entry_filename, key, side_effects); result.has_value()) {
+                side_effects.replay(dds_resources, race_logic);
+                return std::move(*result);
+            }
+        } catch (const std::runtime_error& e) {
+            lwarn() << "Ignoring corrupt mesh cache entry \"" << entry_filename << "\": " << e.what();
+        }
+    }
+    MeshSideEffects side_effects;
+    auto result = load(side_effects);
+    create_directories(cache_directory);
+    write_entry(entry_filename, key, side_effects, result);
+    side_effects.replay(dds_resources, race_logic);
+    return result;
+}
+
+template <class TPos>
+std::shared_ptr<AnimatedColoredVertexArrays> Mlib::load_mesh_cached(
+    const Utf8Path& cache_directory,
+    const std::vector<Utf8Path>& source_filenames,
+    std::string_view loader_name,
+    const LoadMeshConfig<TPos>& cfg,
+    const std::function<std::shared_ptr<AnimatedColoredVertexArrays>()>& load,
+    MeshCacheMode mode)
+{
+    return load_cached<TPos, std::shared_ptr<AnimatedColoredVertexArrays>>(
+        cache_directory,
+        source_filenames,
+        loader_name,
+        cfg,
+        [&load](MeshSideEffects&){ return load(); },
+        nullptr,
+        nullptr,
+        mode);
+}
+
+template <class TPos>
+std::shared_ptr<AnimatedColoredVertexArrays> Mlib::load_mesh_cached(
+    const Utf8Path& cache_directory,
+    const std::vector<Utf8Path>& source_filenames,
+    std::string_view loader_name,
+    const LoadMeshConfig<TPos>& cfg,
+    const std::function<std::shared_ptr<AnimatedColoredVertexArrays>(MeshSideEffects&)>& load,
+    IDdsResources* dds_resources,
+    IRaceLogic* race_logic,
+    MeshCacheMode mode)
+{
+    return load_cached(
+        cache_directory,
+        source_filenames,
+        loader_name,
+        cfg,
+        load,
+        dds_resources,
+        race_logic,
+        mode);
+}
+
+template <class TResourcePos, class TInstancePos>
+PssgArrays<TResourcePos, TInstancePos> Mlib::load_pssg_arrays_cached(
+    const Utf8Path& cache_directory,
+    const std::vector<Utf8Path>& source_filenames,
+    std::string_view loader_name,
+    const LoadMeshConfig<TResourcePos>& cfg,
+    const std::function<PssgArrays<TResourcePos, TInstancePos>(MeshSideEffects&)>& load,
+    IDdsResources* dds_resources,
+    MeshCacheMode mode)
+{
+    return load_cached(
+        cache_directory,
+        source_filenames,
+        loader_name,
+        cfg,
+        load,
+        dds_resources,
+        nullptr,
+        mode);
+}
+
+template <class TPos>
+std::shared_ptr<AnimatedColoredVertexArrays> Mlib::load_mesh_cached(
+    const std::vector<Utf8Path>& source_filenames,
+    std::string_view loader_name,
+    const LoadMeshConfig<TPos>& cfg,
+    const std::function<std::shared_ptr<AnimatedColoredVertexArrays>()>& load)
+{
+    auto dir = mesh_cache_directory();
+    if (!dir.has_value()) {
+        return load();
+    }
+    return load_mesh_cached(*dir, source_filenames, loader_name, cfg, load);
+}
+
+template <class TPos>
+std::shared_ptr<AnimatedColoredVertexArrays> Mlib::load_mesh_cached(
+    const std::vector<Utf8Path>& source_filenames,
+    std::string_view loader_name,
+    const LoadMeshConfig<TPos>& cfg,
+    const std::function<std::shared_ptr<AnimatedColoredVertexArrays>(MeshSideEffects&)>& load,
+    IDdsResources* dds_resources,
+    IRaceLogic* race_logic)
+{
+    auto dir = mesh_cache_directory();
+    if (!dir.has_value()) {
+        MeshSideEffects side_effects;
+        auto result = load(side_effects);
+        side_effects.replay(dds_resources, race_logic);
+        return result;
+    }
+    return load_mesh_cached(*dir, source_filenames, loader_name, cfg, load, dds_resources, race_logic);
+}
+
+template <class TResourcePos, class TInstancePos>
+PssgArrays<TResourcePos, TInstancePos> Mlib::load_pssg_arrays_cached(
+    const std::vector<Utf8Path>& source_filenames,
+    std::string_view loader_name,
+    const LoadMeshConfig<TResourcePos>& cfg,
+    const std::function<PssgArrays<TResourcePos, TInstancePos>(MeshSideEffects&)>& load,
+    IDdsResources* dds_resources)
+{
+    auto dir = mesh_cache_directory();
+    if (!dir.has_value()) {
+        MeshSideEffects side_effects;
+        auto result = load(side_effects);
+        side_effects.replay(dds_resources, nullptr);
+        return result;
+    }
+    return load_pssg_arrays_cached(*dir, source_filenames, loader_name, cfg, load, dds_resources);
+}
+
+namespace Mlib {
+
+template std::shared_ptr<AnimatedColoredVertexArrays> load_mesh_cached<float>(
+    const Utf8Path& cache_directory,
+    const std::vector<Utf8Path>& source_filenames,
+    std::string_view loader_name,
+    const LoadMeshConfig<float>& cfg,
+    const std::function<std::shared_ptr<AnimatedColoredVertexArrays>()>& load,
+    MeshCacheMode mode);
+template std::shared_ptr<AnimatedColoredVertexArrays> load_mesh_cached<float>(
+    const Utf8Path& cache_directory,
+    const std::vector<Utf8Path>& source_filenames,
+    std::string_view loader_name,
+    const LoadMeshConfig<float>& cfg,
+    const std::function<std::shared_ptr<AnimatedColoredVertexArrays>(MeshSideEffects&)>& load,
+    IDdsResources* dds_resources,
+    IRaceLogic* race_logic,
+    MeshCacheMode mode);
+template std::shared_ptr<AnimatedColoredVertexArrays> load_mesh_cached<float>(
+    const std::vector<Utf8Path>& source_filenames,
+    std::string_view loader_name,
+    const LoadMeshConfig<float>& cfg,
+    const std::function<std::shared_ptr<AnimatedColoredVertexArrays>()>& load);
+template std::shared_ptr<AnimatedColoredVertexArrays> load_mesh_cached<float>(
+    const std::vector<Utf8Path>& source_filenames,
+    std::string_view loader_name,
+    const LoadMeshConfig<float>& cfg,
+    const std::function<std::shared_ptr<AnimatedColoredVertexArrays>(MeshSideEffects&)>& load,
+    IDdsResources* dds_resources,
+    IRaceLogic* race_logic);
+template PssgArrays<float, ScenePos> load_pssg_arrays_cached<float, ScenePos>(
+    const Utf8Path& cache_directory,
+    const std::vector<Utf8Path>& source_filenames,
+    std::string_view loader_name,
+    const LoadMeshConfig<float>& cfg,
+    const std::function<PssgArrays<float, ScenePos>(MeshSideEffects&)>& load,
+    IDdsResources* dds_resources,
+    MeshCacheMode mode);
+template PssgArrays<float, ScenePos> load_pssg_arrays_cached<float, ScenePos>(
+    const std::vector<Utf8Path>& source_filenames,
+    std::string_view loader_name,
+    const LoadMeshConfig<float>& cfg,
+    const std::function<PssgArrays<float, ScenePos>(MeshSideEffects&)>& load,
+    IDdsResources* dds_resources);
+template std::shared_ptr<AnimatedColoredVertexArrays> load_mesh_cached<CompressedScenePos>(
+    const Utf8Path& cache_directory,
+    const std::vector<Utf8Path>& source_filenames,
+    std::string_view loader_name,
+    const LoadMeshConfig<CompressedScenePos>& cfg,
+    const std::function<std::shared_ptr<AnimatedColoredVertexArrays>()>& load,
+    MeshCacheMode mode);
+template std::shared_ptr<AnimatedColoredVertexArrays> load_mesh_cached<CompressedScenePos>(
+    const Utf8Path& cache_directory,
+    const std::vector<Utf8Path>& source_filenames,
+    std::string_view loader_name,
+    const LoadMeshConfig<CompressedScenePos>& cfg,
+    const std::function<std::shared_ptr<AnimatedColoredVertexArrays>(MeshSideEffects&)>& load,
+    IDdsResources* dds_resources,
+    IRaceLogic* race_logic,
+    MeshCacheMode mode);
+template std::shared_ptr<AnimatedColoredVertexArrays> load_mesh_cached<CompressedScenePos>(
+    const std::vector<Utf8Path>& source_filenames,
+    std::string_view loader_name,
+    const LoadMeshConfig<CompressedScenePos>& cfg,
+    const std::function<std::shared_ptr<AnimatedColoredVertexArrays>()>& load);
+template std::shared_ptr<AnimatedColoredVertexArrays> load_mesh_cached<CompressedScenePos>(
+    const std::vector<Utf8Path>& source_filenames,
+    std::string_view loader_name,
+    const LoadMeshConfig<CompressedScenePos>& cfg,
+    const std::function<std::shared_ptr<AnimatedColoredVertexArrays>(MeshSideEffects&)>& load,
+    IDdsResources* dds_resources,
+    IRaceLogic* race_logic);
+template PssgArrays<CompressedScenePos, ScenePos> load_pssg_arrays_cached<CompressedScenePos, ScenePos>(
+    const Utf8Path& cache_directory,
+    const std::vector<Utf8Path>& source_filenames,
+    std::string_view loader_name,
+    const LoadMeshConfig<CompressedScenePos>& cfg,
+    const std::function<PssgArrays<CompressedScenePos, ScenePos>(MeshSideEffects&)>& load,
+    IDdsResources* dds_resources,
+    MeshCacheMode mode);
+template PssgArrays<CompressedScenePos, ScenePos> load_pssg_arrays_cached<CompressedScenePos, ScenePos>(
+    const std::vector<Utf8Path>& source_filenames,
+    std::string_view loader_name,
+    const LoadMeshConfig<CompressedScenePos>& cfg,
+    const std::function<PssgArrays<CompressedScenePos, ScenePos>(MeshSideEffects&)>& load,
+    IDdsResources* dds_resources);
+
+}
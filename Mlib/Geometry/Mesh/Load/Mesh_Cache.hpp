@@ -0,0 +1,131 @@
+#pragma once
+#include <Mlib/Geometry/Interfaces/IDds_Resources.hpp>
+#include <Mlib/Geometry/Interfaces/IRace_Logic.hpp>
+#include <Mlib/Strings/Utf8_Path.hpp>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace Mlib {
+
+struct AnimatedColoredVertexArrays;
+template <class TPos>
+struct LoadMeshConfig;
+template <class TResourcePos, class TInstancePos>
+struct PssgArrays;
+class BinaryBitwiseWordsReader;
+class BinaryBitwiseWordsWriter;
+
+enum class MeshCacheMode {
+    READ_WRITE,
+    OVERWRITE
+};
+
+// Records the textures and the race logic a loader sets up besides its
+// vertex arrays. The records are stored in the cache entry and are
+// replayed on a cache hit, s.t. the loader need not run.
+class MeshSideEffects: public IDdsResources, public IRaceLogic {
+    MeshSideEffects(const MeshSideEffects&) = delete;
+    MeshSideEffects& operator = (const MeshSideEffects&) = delete;
+public:
+    MeshSideEffects();
+    ~MeshSideEffects();
+    virtual void add_texture(
+        const ColormapWithModifiers& name,
+        std::vector<std::byte>&& data,
+        FlipMode flip_mode,
+        TextureAlreadyExistsBehavior already_exists_behavior) override;
+    virtual void set_start_pose(
+        const TransformationMatrix<float, ScenePos, 3>& pose,
+        const FixedArray<float, 3>& velocity,
+        const FixedArray<float, 3>& angular_velocity,
+        uint32_t rank) override;
+    virtual void set_checkpoints(
+        const std::vector<TransformationMatrix<float, ScenePos, 3>>& checkpoints) override;
+    virtual void set_circularity(bool is_circular) override;
+    // Forwards the recorded calls and moves the texture data out.
+    // Either target may be null.
+    void replay(IDdsResources* dds_resources, IRaceLogic* race_logic);
+    void write(std::ostream& ostr, BinaryBitwiseWordsWriter& writer) const;
+    void read(BinaryBitwiseWordsReader& reader);
+private:
+    struct Texture;
+    struct StartPose;
+    std::vector<Texture> textures_;
+    std::vector<StartPose> start_poses_;
+    std::vector<std::vector<TransformationMatrix<float, ScenePos, 3>>> checkpoints_;
+    std::vector<bool> circularities_;
+};
+
+// Directory of the binary mesh cache, taken from the environment
+// variable "MESH_CACHE_DIR". The cache is disabled if it is not set.
+std::optional<Utf8Path> mesh_cache_directory();
+
+// Returns the fully post-processed output of "load" from the cache.
+// Entries are keyed by the path, size and modification time of all
+// "source_filenames" and of the files referenced by "cfg", the
+// loader name and the serialized loader configuration, and are
+// generated by calling "load" if they are missing or outdated.
+template <class TPos>
+std::shared_ptr<AnimatedColoredVertexArrays> load_mesh_cached(
+    const Utf8Path& cache_directory,
+    const std::vector<Utf8Path>& source_filenames,
+    std::string_view loader_name,
+    const LoadMeshConfig<TPos>& cfg,
+    const std::function<std::shared_ptr<AnimatedColoredVertexArrays>()>& load,
+    MeshCacheMode mode = MeshCacheMode::READ_WRITE);
+
+// Same as above, for loaders with side effects.
+// "load" must send its side effects to the given recorder, which
+// replays them to "dds_resources" and "race_logic".
+template <class TPos>
+std::shared_ptr<AnimatedColoredVertexArrays> load_mesh_cached(
+    const Utf8Path& cache_directory,
+    const std::vector<Utf8Path>& source_filenames,
+    std::string_view loader_name,
+    const LoadMeshConfig<TPos>& cfg,
+    const std::function<std::shared_ptr<AnimatedColoredVertexArrays>(MeshSideEffects&)>& load,
+    IDdsResources* dds_resources,
+    IRaceLogic* race_logic,
+    MeshCacheMode mode = MeshCacheMode::READ_WRITE);
+
+// Same as above, for the named resources and instances of a PSSG file.
+template <class TResourcePos, class TInstancePos>
+PssgArrays<TResourcePos, TInstancePos> load_pssg_arrays_cached(
+    const Utf8Path& cache_directory,
+    const std::vector<Utf8Path>& source_filenames,
+    std::string_view loader_name,
+    const LoadMeshConfig<TResourcePos>& cfg,
+    const std::function<PssgArrays<TResourcePos, TInstancePos>(MeshSideEffects&)>& load,
+    IDdsResources* dds_resources,
+    MeshCacheMode mode = MeshCacheMode::READ_WRITE);
+
+// Same as the functions above, using "mesh_cache_directory()".
+// Call "load" directly if the cache is disabled.
+template <class TPos>
+std::shared_ptr<AnimatedColoredVertexArrays> load_mesh_cached(
+    const std::vector<Utf8Path>& source_filenames,
+    std::string_view loader_name,
+    const LoadMeshConfig<TPos>& cfg,
+    const std::function<std::shared_ptr<AnimatedColoredVertexArrays>()>& load);
+
+template <class TPos>
+std::shared_ptr<AnimatedColoredVertexArrays> load_mesh_cached(
+    const std::vector<Utf8Path>& source_filenames,
+    std::string_view loader_name,
+    const LoadMeshConfig<TPos>& cfg,
+    const std::function<std::shared_ptr<AnimatedColoredVertexArrays>(MeshSideEffects&)>& load,
+    IDdsResources* dds_resources,
+    IRaceLogic* race_logic);
+
+template <class TResourcePos, class TInstancePos>
+PssgArrays<TResourcePos, TInstancePos> load_pssg_arrays_cached(
+    const std::vector<Utf8Path>& source_filenames,
+    std::string_view loader_name,
+    const LoadMeshConfig<TResourcePos>& cfg,
+    const std::function<PssgArrays<TResourcePos, TInstancePos>(MeshSideEffects&)>& load,
+    IDdsResources* dds_resources);
+
+}
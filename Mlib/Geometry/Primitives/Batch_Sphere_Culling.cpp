@@ -0,0 +1,96 @@
+#include "Batch_Sphere_Culling.hpp"
+#include <Mlib/Geometry/Primitives/Frustum3.hpp>
+#include <Mlib/Math/Fixed_Math.hpp>
+#include <algorithm>
+#include <stdexcept>
+
+using namespace Mlib;
+
+// Number of spheres whose visibility flags are computed
+// in one branch-free pass before the survivors are compacted.
+static const size_t BLOCK_SIZE = 64;
+
+template <class TData>
+BatchSphereCulling<TData>::BatchSphereCulling(const FixedArray<TData, 4, 4>& mvp)
+    : clip_{ uninitialized }
+    , plane_x_{ uninitialized }
+    , plane_y_{ uninitialized }
+    , plane_z_{ uninitialized }
+    , plane_d_{ uninitialized }
+    , orthographic_{ (mvp(3, 0) == 0 && mvp(3, 1) == 0 && mvp(3, 2) == 0 && mvp(3, 3) == 1) }
+{
+    for (size_t r = 0; r < 3; ++r) {
+        for (size_t c = 0; c < 4; ++c) {
+            clip_(r, c) = mvp(r, c);
+        }
+    }
+    auto frustum = Frustum3<TData>::from_projection_matrix(mvp);
+    frustum.normalize();
+    for (size_t i = 0; i < 6; ++i) {
+        const auto& plane = frustum.planes(i);
+        plane_x_(i) = plane.normal(0);
+        plane_y_(i) = plane.normal(1);
+        plane_z_(i) = plane.normal(2);
+        plane_d_(i) = plane.intercept;
+    }
+}
+
+template <class TData>
+void BatchSphereCulling<TData>::cull(
+    const SphereArrays<TData>& spheres,
+    TData min_center_distance2,
+    TData max_center_distance2,
+    std::vector<uint32_t>& survivors) const
+{
+    size_t n = spheres.size();
+    if ((spheres.y.size() != n) || (spheres.z.size() != n) || (spheres.radius.size() != n)) {
+        throw std::runtime_error("BatchSphereCulling: inconsistent array sizes");
+    }
+    if (n > UINT32_MAX) {
+        throw std::runtime_error("BatchSphereCulling: too many spheres");
+    }
+    const TData* x = spheres.x.data();
+    const TData* y = spheres.y.data();
+    const TData* z = spheres.z.data();
+    const TData* radius = spheres.radius.data();
+    size_t nsurvivors = survivors.size();
+    survivors.resize(nsurvivors + n);
+    uint8_t visible[BLOCK_SIZE];
+    for (size_t b = 0; b < n; b += BLOCK_SIZE) {
+        size_t e = std::min(n, b + BLOCK_SIZE);
+        // The loops below are free of branches and function calls,
+        // s.t. the compiler can vectorize them.
+        for (size_t i = b; i < e; ++i) {
+            bool v = true;
+            for (size_t p = 0; p < 6; ++p) {
+                TData dist = plane_x_(p) * x[i] + plane_y_(p) * y[i] + plane_z_(p) * z[i] + plane_d_(p);
+                v &= (dist >= -radius[i]);
+            }
+            visible[i - b] = v;
+        }
+        if (!orthographic_) {
+            for (size_t i = b; i < e; ++i) {
+                TData cx = clip_(0, 0) * x[i] + clip_(0, 1) * y[i] + clip_(0, 2) * z[i] + clip_(0, 3);
+                TData cy = clip_(1, 0) * x[i] + clip_(1, 1) * y[i] + clip_(1, 2) * z[i] + clip_(1, 3);
+                TData cz = clip_(2, 0) * x[i] + clip_(2, 1) * y[i] + clip_(2, 2) * z[i] + clip_(2, 3);
+                TData dist2 = cx * cx + cy * cy + cz * cz;
+                visible[i - b] &= (dist2 >= min_center_distance2) & (dist2 < max_center_distance2);
+            }
+        }
+        for (size_t i = b; i < e; ++i) {
+            survivors[nsurvivors] = (uint32_t)i;
+            nsurvivors += visible[i - b];
+        }
+    }
+    survivors.resize(nsurvivors);
+}
+
+template <class TData>
+bool BatchSphereCulling<TData>::orthographic() const {
+    return orthographic_;
+}
+
+namespace Mlib {
+    template class BatchSphereCulling<float>;
+    template class BatchSphereCulling<double>;
+}
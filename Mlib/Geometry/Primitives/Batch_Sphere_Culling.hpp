@@ -0,0 +1,69 @@
+#pragma once
+#include <Mlib/Array/Fixed_Array.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Mlib {
+
+// Bounding spheres in structure-of-arrays layout, s.t. the
+// culling loops process several spheres per SIMD register.
+template <class TData>
+struct SphereArrays {
+    std::vector<TData> x;
+    std::vector<TData> y;
+    std::vector<TData> z;
+    std::vector<TData> radius;
+    inline void clear() {
+        x.clear();
+        y.clear();
+        z.clear();
+        radius.clear();
+    }
+    inline void reserve(size_t n) {
+        x.reserve(n);
+        y.reserve(n);
+        z.reserve(n);
+        radius.reserve(n);
+    }
+    inline void push_back(const FixedArray<TData, 3>& center, TData r) {
+        x.push_back(center(0));
+        y.push_back(center(1));
+        z.push_back(center(2));
+        radius.push_back(r);
+    }
+    inline size_t size() const {
+        return x.size();
+    }
+    inline bool empty() const {
+        return x.empty();
+    }
+};
+
+// Culls batches of bounding spheres against the view frustum and the
+// center distance, using the same distance metric as "VisibilityCheck".
+// The spheres are given in the coordinate system that "mvp" maps to clip space.
+template <class TData>
+class BatchSphereCulling {
+public:
+    explicit BatchSphereCulling(const FixedArray<TData, 4, 4>& mvp);
+    // Appends the indices of the spheres that intersect the frustum and
+    // satisfy "min_center_distance2 <= distance2 < max_center_distance2"
+    // to "survivors". The distance test is skipped for orthographic
+    // projections, like in "VisibilityCheck".
+    void cull(
+        const SphereArrays<TData>& spheres,
+        TData min_center_distance2,
+        TData max_center_distance2,
+        std::vector<uint32_t>& survivors) const;
+    bool orthographic() const;
+private:
+    FixedArray<TData, 3, 4> clip_;
+    FixedArray<TData, 6> plane_x_;
+    FixedArray<TData, 6> plane_y_;
+    FixedArray<TData, 6> plane_z_;
+    FixedArray<TData, 6> plane_d_;
+    bool orthographic_;
+};
+
+}
@@ -0,0 +1,483 @@
+#include "Heightfield.hpp"
+#include <Mlib/Math/Fixed_Math.hpp>
+#include <limits>
+#include <stdexcept>
+
+using namespace Mlib;
+
+// Visits the cells along "uv0 + t * duv", t in [t0, t1], in the order of
+// increasing "t" (Amanatides-Woo). The cell indices are not clamped.
+template <class TVisitor>
+static bool visit_cells_along_ray(
+    const FixedArray<ScenePos, 2>& uv0,
+    const FixedArray<ScenePos, 2>& duv,
+    ScenePos t0,
+    ScenePos t1,
+    const TVisitor& visitor)
+{
+    FixedArray<ptrdiff_t, 2> cell = uninitialized;
+    FixedArray<ptrdiff_t, 2> step = uninitialized;
+    FixedArray<ScenePos, 2> t_next = uninitialized;
+    FixedArray<ScenePos, 2> t_delta = uninitialized;
+    for (size_t i = 0; i < 2; ++i) {
+        cell(i) = (ptrdiff_t)std::floor(uv0(i) + t0 * duv(i));
+        if (duv(i) > 0) {
+            step(i) = 1;
+            t_next(i) = ((ScenePos)(cell(i) + 1) - uv0(i)) / duv(i);
+            t_delta(i) = 1 / duv(i);
+        } else if (duv(i) < 0) {
+            step(i) = -1;
+            t_next(i) = ((ScenePos)cell(i) - uv0(i)) / duv(i);
+            t_delta(i) = -1 / duv(i);
+        } else {
+            step(i) = 0;
+            t_next(i) = INFINITY;
+            t_delta(i) = INFINITY;
+        }
+    }
+    ScenePos t = t0;
+    while (true) {
+        ScenePos te = std::min({ t_next(0), t_next(1), t1 });
+        if (!visitor(cell(1), cell(0), t, std::max(t, te))) {
+            return false;
+        }
+        if (te >= t1) {
+            return true;
+        }
+        size_t i = (t_next(0) < t_next(1)) ? 0 : 1;
+        cell(i) += step(i);
+        t_next(i) += t_delta(i);
+        t = std::max(t, te);
+    }
+}
+
+// Restricts [t0, t1] s.t. "uv0 + t * duv" lies inside [lo, hi].
+static bool clip_ray(
+    const FixedArray<ScenePos, 2>& uv0,
+    const FixedArray<ScenePos, 2>& duv,
+    const FixedArray<ScenePos, 2>& lo,
+    const FixedArray<ScenePos, 2>& hi,
+    ScenePos& t0,
+    ScenePos& t1)
+{
+    for (size_t i = 0; i < 2; ++i) {
+        if (duv(i) == 0) {
+            if ((uv0(i) < lo(i)) || (uv0(i) > hi(i))) {
+                return false;
+            }
+            continue;
+        }
+        ScenePos ta = (lo(i) - uv0(i)) / duv(i);
+        ScenePos tb = (hi(i) - uv0(i)) / duv(i);
+        if (ta > tb) {
+            std::swap(ta, tb);
+        }
+        t0 = std::max(t0, ta);
+        t1 = std::min(t1, tb);
+    }
+    return t0 <= t1;
+}
+
+// Updates "best_t" if the sphere moving along "dir" touches the
+// triangle earlier. Contacts existing at t = 0 are ignored.
+static void sweep_sphere_triangle(
+    const FixedArray<ScenePos, 3>& center,
+    ScenePos radius,
+    const FixedArray<ScenePos, 3>& dir,
+    const FixedArray<ScenePos, 3, 3>& tri,
+    ScenePos& best_t,
+    FixedArray<ScenePos, 3>& best_position,
+    FixedArray<ScenePos, 3>& best_normal)
+{
+    auto n = cross(tri[1] - tri[0], tri[2] - tri[0]);
+    auto n_len = std::sqrt(sum(squared(n)));
+    if (n_len == 0) {
+        return;
+    }
+    n /= n_len;
+    // Face
+    {
+        auto dist0 = dot0d(center - tri[0], n);
+        auto nd = dot0d(dir, n);
+        if ((dist0 >= radius) && (nd < 0)) {
+            auto t = (dist0 - radius) / -nd;
+            if (t >= best_t) {
+                return;
+            }
+            auto q = center + t * dir - radius * n;
+            bool inside = true;
+            for (size_t i = 0; i < 3; ++i) {
+                const auto& a = tri[i];
+                const auto& b = tri[(i + 1) % 3];
+                if (dot0d(cross(b - a, q - a), n) < 0) {
+                    inside = false;
+                    break;
+                }
+            }
+            if (inside) {
+                best_t = t;
+                best_position = q;
+                best_normal = n;
+                return;
+            }
+        }
+    }
+    auto dd = dot0d(dir, dir);
+    // Edges (cylinders)
+    for (size_t i = 0; i < 3; ++i) {
+        const auto& a = tri[i];
+        auto e = tri[(i + 1) % 3] - a;
+        auto m = center - a;
+        auto ee = dot0d(e, e);
+        auto me = dot0d(m, e);
+        auto de = dot0d(dir, e);
+        auto A = ee * dd - squared(de);
+        auto B = ee * dot0d(m, dir) - me * de;
+        auto C = ee * (dot0d(m, m) - squared(radius)) - squared(me);
+        if ((A <= 0) || (C < 0)) {
+            continue;
+        }
+        auto disc = squared(B) - A * C;
+        if (disc < 0) {
+            continue;
+        }
+        auto t = (-B - std::sqrt(disc)) / A;
+        if ((t < 0) || (t >= best_t)) {
+            continue;
+        }
+        auto s = (me + t * de) / ee;
+        if ((s < 0) || (s > 1)) {
+            continue;
+        }
+        best_t = t;
+        best_position = a + s * e;
+        best_normal = (center + t * dir - best_position) / radius;
+    }
+    // Vertices
+    for (const auto& v : tri.row_iterable()) {
+        auto m = center - v;
+        auto b = dot0d(m, dir);
+        auto c = dot0d(m, m) - squared(radius);
+        if (c < 0) {
+            continue;
+        }
+        auto disc = squared(b) - dd * c;
+        if (disc < 0) {
+            continue;
+        }
+        auto t = (-b - std::sqrt(disc)) / dd;
+        if ((t < 0) || (t >= best_t)) {
+            continue;
+        }
+        best_t = t;
+        best_position = v;
+        best_normal = (center + t * dir - v) / radius;
+    }
+}
+
+Heightfield::Heightfield(
+    Array<float> heights,
+    const FixedArray<ScenePos, 2>& origin,
+    const FixedArray<ScenePos, 2>& cell_size)
+    : heights_(std::move(heights))
+    , origin_{ origin }
+    , cell_size_{ cell_size }
+    , aabb_{ uninitialized }
+{
+    if (heights_.ndim() != 2) {
+        throw std::runtime_error("Heightfield requires a 2D array");
+    }
+    if ((nrows() < 2) || (ncols() < 2)) {
+        throw std::runtime_error("Heightfield requires at least 2x2 heights");
+    }
+    if (!(cell_size(0) > 0) || !(cell_size(1) > 0)) {
+        throw std::runtime_error("Heightfield cell size must be positive");
+    }
+    cell_zrange_ = Array<float>(ArrayShape{ nrows() - 1, ncols() - 1, 2 });
+    float zmin = INFINITY;
+    float zmax = -INFINITY;
+    for (size_t r = 0; r < nrows() - 1; ++r) {
+        for (size_t c = 0; c < ncols() - 1; ++c) {
+            float h00 = heights_(r, c);
+            float h10 = heights_(r, c + 1);
+            float h01 = heights_(r + 1, c);
+            float h11 = heights_(r + 1, c + 1);
+            if (std::isnan(h00) || std::isnan(h10) || std::isnan(h01) || std::isnan(h11)) {
+                cell_zrange_(r, c, 0) = NAN;
+                cell_zrange_(r, c, 1) = NAN;
+                continue;
+            }
+            cell_zrange_(r, c, 0) = std::min({ h00, h10, h01, h11 });
+            cell_zrange_(r, c, 1) = std::max({ h00, h10, h01, h11 });
+            zmin = std::min(zmin, cell_zrange_(r, c, 0));
+            zmax = std::max(zmax, cell_zrange_(r, c, 1));
+        }
+    }
+    if (zmin > zmax) {
+        throw std::runtime_error("Heightfield has no valid cells");
+    }
+    aabb_ = AxisAlignedBoundingBox<ScenePos, 3>::from_min_max(
+        { origin(0), origin(1), (ScenePos)zmin },
+        {
+            origin(0) + (ScenePos)(ncols() - 1) * cell_size(0),
+            origin(1) + (ScenePos)(nrows() - 1) * cell_size(1),
+            (ScenePos)zmax
+        });
+}
+
+Heightfield::~Heightfield() = default;
+
+bool Heightfield::cell(
+    const FixedArray<ScenePos, 2>& pos,
+    size_t& r,
+    size_t& c,
+    FixedArray<ScenePos, 2>& frac) const
+{
+    auto u = (pos(0) - origin_(0)) / cell_size_(0);
+    auto v = (pos(1) - origin_(1)) / cell_size_(1);
+    if (!(u >= 0) || !(v >= 0) ||
+        !(u <= (ScenePos)(ncols() - 1)) ||
+        !(v <= (ScenePos)(nrows() - 1)))
+    {
+        return false;
+    }
+    c = std::min((size_t)u, ncols() - 2);
+    r = std::min((size_t)v, nrows() - 2);
+    frac = { u - (ScenePos)c, v - (ScenePos)r };
+    return true;
+}
+
+bool Heightfield::cell_range(size_t axis, ScenePos lo, ScenePos hi, size_t& i0, size_t& i1) const {
+    auto ncells = heights_.shape(1 - axis) - 1;
+    auto u_lo = (lo - origin_(axis)) / cell_size_(axis);
+    auto u_hi = (hi - origin_(axis)) / cell_size_(axis);
+    if (!(u_hi >= 0) || !(u_lo <= (ScenePos)ncells)) {
+        return false;
+    }
+    i0 = std::min((size_t)std::max<ScenePos>(u_lo, 0), ncells - 1);
+    i1 = std::min((size_t)std::min<ScenePos>(u_hi, (ScenePos)ncells), ncells - 1);
+    return true;
+}
+
+ScenePos Heightfield::surface(
+    size_t r,
+    size_t c,
+    const FixedArray<ScenePos, 2>& frac,
+    FixedArray<ScenePos, 2>& gradient) const
+{
+    ScenePos h00 = heights_(r, c);
+    ScenePos h10 = heights_(r, c + 1);
+    ScenePos h01 = heights_(r + 1, c);
+    ScenePos h11 = heights_(r + 1, c + 1);
+    if (frac(0) >= frac(1)) {
+        gradient = { h10 - h00, h11 - h10 };
+    } else {
+        gradient = { h11 - h01, h01 - h00 };
+    }
+    return h00 + gradient(0) * frac(0) + gradient(1) * frac(1);
+}
+
+FixedArray<SceneDir, 3> Heightfield::surface_normal(const FixedArray<ScenePos, 2>& gradient) const {
+    FixedArray<ScenePos, 3> n{
+        -gradient(0) / cell_size_(0),
+        -gradient(1) / cell_size_(1),
+        1. };
+    return (n / std::sqrt(sum(squared(n)))).casted<SceneDir>();
+}
+
+bool Heightfield::height(const FixedArray<ScenePos, 2>& pos, ScenePos& z) const {
+    size_t r;
+    size_t c;
+    FixedArray<ScenePos, 2> frac = uninitialized;
+    if (!cell(pos, r, c, frac) || std::isnan(cell_zrange_(r, c, 0))) {
+        return false;
+    }
+    FixedArray<ScenePos, 2> gradient = uninitialized;
+    z = surface(r, c, frac, gradient);
+    return true;
+}
+
+bool Heightfield::normal(const FixedArray<ScenePos, 2>& pos, FixedArray<SceneDir, 3>& n) const {
+    size_t r;
+    size_t c;
+    FixedArray<ScenePos, 2> frac = uninitialized;
+    if (!cell(pos, r, c, frac) || std::isnan(cell_zrange_(r, c, 0))) {
+        return false;
+    }
+    FixedArray<ScenePos, 2> gradient = uninitialized;
+    surface(r, c, frac, gradient);
+    n = surface_normal(gradient);
+    return true;
+}
+
+bool Heightfield::covers(const FixedArray<ScenePos, 3>& pos, ScenePos tolerance) const {
+    ScenePos z;
+    if (!height({ pos(0), pos(1) }, z)) {
+        return false;
+    }
+    return std::abs(pos(2) - z) <= tolerance;
+}
+
+bool Heightfield::intersect_ray(
+    const FixedArray<ScenePos, 3>& start,
+    const FixedArray<SceneDir, 3>& direction,
+    ScenePos max_distance,
+    HeightfieldHit& hit) const
+{
+    if (!all(isfinite(start)) || !all(isfinite(direction))) {
+        return false;
+    }
+    auto dir = direction.casted<ScenePos>();
+    FixedArray<ScenePos, 2> uv0{
+        (start(0) - origin_(0)) / cell_size_(0),
+        (start(1) - origin_(1)) / cell_size_(1) };
+    FixedArray<ScenePos, 2> duv{
+        dir(0) / cell_size_(0),
+        dir(1) / cell_size_(1) };
+    ScenePos t0 = 0;
+    ScenePos t1 = max_distance;
+    if (!clip_ray(
+        uv0,
+        duv,
+        { 0., 0. },
+        { (ScenePos)(ncols() - 1), (ScenePos)(nrows() - 1) },
+        t0,
+        t1))
+    {
+        return false;
+    }
+    auto rmax = (ptrdiff_t)nrows() - 2;
+    auto cmax = (ptrdiff_t)ncols() - 2;
+    bool found = false;
+    visit_cells_along_ray(uv0, duv, t0, t1, [&](ptrdiff_t ri, ptrdiff_t ci, ScenePos ta, ScenePos tb){
+        auto r = (size_t)std::clamp<ptrdiff_t>(ri, 0, rmax);
+        auto c = (size_t)std::clamp<ptrdiff_t>(ci, 0, cmax);
+        float zmin = cell_zrange_(r, c, 0);
+        float zmax = cell_zrange_(r, c, 1);
+        if (std::isnan(zmin)) {
+            return true;
+        }
+        auto za = start(2) + ta * dir(2);
+        auto zb = start(2) + tb * dir(2);
+        if ((std::min(za, zb) > zmax) || (std::max(za, zb) < zmin)) {
+            return true;
+        }
+        FixedArray<ScenePos, 2> cell_origin{ (ScenePos)c, (ScenePos)r };
+        auto frac = [&](ScenePos t){
+            return uv0 + t * duv - cell_origin;
+        };
+        auto f = [&](ScenePos t){
+            FixedArray<ScenePos, 2> gradient = uninitialized;
+            return start(2) + t * dir(2) - surface(r, c, frac(t), gradient);
+        };
+        // The surface is linear on both sides of the diagonal.
+        ScenePos ts[3] = { ta, tb, tb };
+        size_t nts = 2;
+        if (auto den = duv(0) - duv(1); den != 0) {
+            auto d0 = frac(0)(0) - frac(0)(1);
+            auto td = -d0 / den;
+            if ((td > ta) && (td < tb)) {
+                ts[1] = td;
+                nts = 3;
+            }
+        }
+        for (size_t i = 0; i + 1 < nts; ++i) {
+            auto fa = f(ts[i]);
+            auto fb = f(ts[i + 1]);
+            if ((fa == 0) || (fb == 0) || ((fa > 0) != (fb > 0))) {
+                auto t = (fa == fb) ? ts[i] : ts[i] + (ts[i + 1] - ts[i]) * fa / (fa - fb);
+                FixedArray<ScenePos, 2> gradient = uninitialized;
+                surface(r, c, frac((ts[i] + ts[i + 1]) / 2), gradient);
+                hit.distance = t;
+                hit.position = start + t * dir;
+                hit.normal = surface_normal(gradient);
+                found = true;
+                return false;
+            }
+        }
+        return true;
+    });
+    return found;
+}
+
+bool Heightfield::sweep_sphere(
+    const FixedArray<ScenePos, 3>& center,
+    ScenePos radius,
+    const FixedArray<SceneDir, 3>& direction,
+    ScenePos max_distance,
+    HeightfieldHit& hit) const
+{
+    if (!all(isfinite(center)) || !all(isfinite(direction)) || !(radius > 0)) {
+        return false;
+    }
+    auto dir = direction.casted<ScenePos>();
+    FixedArray<ScenePos, 2> uv0{
+        (center(0) - origin_(0)) / cell_size_(0),
+        (center(1) - origin_(1)) / cell_size_(1) };
+    FixedArray<ScenePos, 2> duv{
+        dir(0) / cell_size_(0),
+        dir(1) / cell_size_(1) };
+    FixedArray<ScenePos, 2> ruv{
+        radius / cell_size_(0),
+        radius / cell_size_(1) };
+    ScenePos t0 = 0;
+    ScenePos t1 = max_distance;
+    if (!clip_ray(
+        uv0,
+        duv,
+        -ruv,
+        FixedArray<ScenePos, 2>{ (ScenePos)(ncols() - 1), (ScenePos)(nrows() - 1) } + ruv,
+        t0,
+        t1))
+    {
+        return false;
+    }
+    // A triangle touched at time "t" lies within this many cells of the
+    // cell containing the center at time "t".
+    auto kc = (ptrdiff_t)std::ceil(ruv(0));
+    auto kr = (ptrdiff_t)std::ceil(ruv(1));
+    auto rmax = (ptrdiff_t)nrows() - 2;
+    auto cmax = (ptrdiff_t)ncols() - 2;
+    ScenePos best_t = t1;
+    FixedArray<ScenePos, 3> best_position = uninitialized;
+    FixedArray<ScenePos, 3> best_normal = uninitialized;
+    bool found = false;
+    visit_cells_along_ray(uv0, duv, t0, t1, [&](ptrdiff_t ri, ptrdiff_t ci, ScenePos ta, ScenePos tb){
+        if (ta > best_t) {
+            return false;
+        }
+        auto za = center(2) + ta * dir(2);
+        auto zb = center(2) + tb * dir(2);
+        auto zlo = std::min(za, zb) - radius;
+        auto zhi = std::max(za, zb) + radius;
+        for (auto r = std::max<ptrdiff_t>(ri - kr, 0); r <= std::min(ri + kr, rmax); ++r) {
+            for (auto c = std::max<ptrdiff_t>(ci - kc, 0); c <= std::min(ci + kc, cmax); ++c) {
+                float zmin = cell_zrange_((size_t)r, (size_t)c, 0);
+                float zmax = cell_zrange_((size_t)r, (size_t)c, 1);
+                if (std::isnan(zmin) || (zlo > zmax) || (zhi < zmin)) {
+                    continue;
+                }
+                auto p00 = vertex((size_t)r, (size_t)c);
+                auto p10 = vertex((size_t)r, (size_t)c + 1);
+                auto p01 = vertex((size_t)r + 1, (size_t)c);
+                auto p11 = vertex((size_t)r + 1, (size_t)c + 1);
+                for (const auto& tri : {
+                    FixedArray<ScenePos, 3, 3>{ p00, p10, p11 },
+                    FixedArray<ScenePos, 3, 3>{ p00, p11, p01 } })
+                {
+                    auto old_t = best_t;
+                    sweep_sphere_triangle(center, radius, dir, tri, best_t, best_position, best_normal);
+                    found = found || (best_t != old_t);
+                }
+            }
+        }
+        return true;
+    });
+    if (!found) {
+        return false;
+    }
+    hit.distance = best_t;
+    hit.position = best_position;
+    hit.normal = best_normal.casted<SceneDir>();
+    return true;
+}
@@ -0,0 +1,137 @@
+#pragma once
+#include <Mlib/Array/Array.hpp>
+#include <Mlib/Array/Fixed_Array.hpp>
+#include <Mlib/Geometry/Primitives/Axis_Aligned_Bounding_Box.hpp>
+#include <Mlib/Scene_Config/Scene_Precision.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+namespace Mlib {
+
+struct HeightfieldHit {
+    ScenePos distance;
+    FixedArray<ScenePos, 3> position;
+    FixedArray<SceneDir, 3> normal;
+};
+
+// Regular grid of heights in a local frame with "z" pointing up.
+// The height "heights(r, c)" is located at
+// "origin + (c * cell_size(0), r * cell_size(1))".
+// Every cell is split along its (0, 0)-(1, 1) diagonal into two
+// triangles that are counter-clockwise when seen from above.
+// Cells with a NaN corner are holes.
+class Heightfield {
+public:
+    Heightfield(
+        Array<float> heights,
+        const FixedArray<ScenePos, 2>& origin,
+        const FixedArray<ScenePos, 2>& cell_size);
+    ~Heightfield();
+    inline size_t nrows() const {
+        return heights_.shape(0);
+    }
+    inline size_t ncols() const {
+        return heights_.shape(1);
+    }
+    inline const Array<float>& heights() const {
+        return heights_;
+    }
+    inline const FixedArray<ScenePos, 2>& origin() const {
+        return origin_;
+    }
+    inline const FixedArray<ScenePos, 2>& cell_size() const {
+        return cell_size_;
+    }
+    inline const AxisAlignedBoundingBox<ScenePos, 3>& aabb() const {
+        return aabb_;
+    }
+    // O(1) lookup of the cell containing "pos", and the position
+    // inside the cell in [0, 1]^2.
+    bool cell(
+        const FixedArray<ScenePos, 2>& pos,
+        size_t& r,
+        size_t& c,
+        FixedArray<ScenePos, 2>& frac) const;
+    bool height(const FixedArray<ScenePos, 2>& pos, ScenePos& z) const;
+    bool normal(const FixedArray<ScenePos, 2>& pos, FixedArray<SceneDir, 3>& n) const;
+    // True if the surface is within "tolerance" of "pos" in z-direction.
+    bool covers(const FixedArray<ScenePos, 3>& pos, ScenePos tolerance) const;
+    // First crossing of the ray with the surface, from either side.
+    // "direction" must be normalized.
+    bool intersect_ray(
+        const FixedArray<ScenePos, 3>& start,
+        const FixedArray<SceneDir, 3>& direction,
+        ScenePos max_distance,
+        HeightfieldHit& hit) const;
+    // First contact of a sphere moving along "direction" (normalized).
+    // Contacts that already exist at the start are ignored.
+    // "hit.position" is the contact point on the surface.
+    bool sweep_sphere(
+        const FixedArray<ScenePos, 3>& center,
+        ScenePos radius,
+        const FixedArray<SceneDir, 3>& direction,
+        ScenePos max_distance,
+        HeightfieldHit& hit) const;
+    // Calls "visitor(const FixedArray<ScenePos, 3, 3>& corners)" for every
+    // triangle of the cells overlapping "aabb".
+    // Stops and returns false if the visitor returns false.
+    template <class TVisitor>
+    bool visit_triangles(
+        const AxisAlignedBoundingBox<ScenePos, 3>& aabb,
+        const TVisitor& visitor) const
+    {
+        if (!aabb.intersects(aabb_)) {
+            return true;
+        }
+        size_t c0, c1, r0, r1;
+        if (!cell_range(0, aabb.min(0), aabb.max(0), c0, c1) ||
+            !cell_range(1, aabb.min(1), aabb.max(1), r0, r1))
+        {
+            return true;
+        }
+        for (size_t r = r0; r <= r1; ++r) {
+            for (size_t c = c0; c <= c1; ++c) {
+                float zmin = cell_zrange_(r, c, 0);
+                float zmax = cell_zrange_(r, c, 1);
+                if (std::isnan(zmin) || (zmin > aabb.max(2)) || (zmax < aabb.min(2))) {
+                    continue;
+                }
+                auto p00 = vertex(r, c);
+                auto p10 = vertex(r, c + 1);
+                auto p01 = vertex(r + 1, c);
+                auto p11 = vertex(r + 1, c + 1);
+                if (!visitor(FixedArray<ScenePos, 3, 3>{ p00, p10, p11 })) {
+                    return false;
+                }
+                if (!visitor(FixedArray<ScenePos, 3, 3>{ p00, p11, p01 })) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+private:
+    inline FixedArray<ScenePos, 3> vertex(size_t r, size_t c) const {
+        return {
+            origin_(0) + (ScenePos)c * cell_size_(0),
+            origin_(1) + (ScenePos)r * cell_size_(1),
+            (ScenePos)heights_(r, c)};
+    }
+    bool cell_range(size_t axis, ScenePos lo, ScenePos hi, size_t& i0, size_t& i1) const;
+    // Height of the cell's surface at "frac", and its gradient
+    // with respect to "frac".
+    ScenePos surface(
+        size_t r,
+        size_t c,
+        const FixedArray<ScenePos, 2>& frac,
+        FixedArray<ScenePos, 2>& gradient) const;
+    FixedArray<SceneDir, 3> surface_normal(const FixedArray<ScenePos, 2>& gradient) const;
+    Array<float> heights_;
+    Array<float> cell_zrange_;
+    FixedArray<ScenePos, 2> origin_;
+    FixedArray<ScenePos, 2> cell_size_;
+    AxisAlignedBoundingBox<ScenePos, 3> aabb_;
+};
+
+}
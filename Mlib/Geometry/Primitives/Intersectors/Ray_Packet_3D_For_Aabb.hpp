@@ -0,0 +1,123 @@
+#pragma once
+#include <Mlib/Geometry/Primitives/Axis_Aligned_Bounding_Box.hpp>
+#include <Mlib/Geometry/Primitives/Ray_Segment_3D.hpp>
+#include <Mlib/Scene_Config/Scene_Precision.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+
+namespace Mlib {
+
+// Up to "tsize" ray segments that are tested against a box at once.
+// The lanes are stored as one array per coordinate, s.t. the slab test
+// in "mask" vectorizes.
+// The BVH visitors only receive the payload, so "intersects" stores
+// the lanes that hit the last box, which the visitor of a leaf can
+// query with "last_mask".
+template <class TPos, size_t tsize>
+class RayPacket3DForAabb {
+    static_assert(tsize <= 32);
+public:
+    static const size_t size = tsize;
+    RayPacket3DForAabb()
+        : nlanes_{ 0 }
+        , active_{ 0 }
+        , last_mask_{ 0 }
+    {
+        for (size_t i = 0; i < tsize; ++i) {
+            for (size_t d = 0; d < 3; ++d) {
+                start_[d][i] = 0;
+                inv_direction_[d][i] = 0;
+            }
+            // Unused lanes never hit.
+            length_[i] = -1;
+        }
+    }
+    size_t add(const RaySegment3D<TPos, TPos>& ray) {
+        if (nlanes_ == tsize) {
+            throw std::runtime_error("Ray packet is full");
+        }
+        auto i = nlanes_++;
+        for (size_t d = 0; d < 3; ++d) {
+            start_[d][i] = ray.start(d);
+            // Zero marks rays parallel to the slab, which avoids "0 * inf".
+            inv_direction_[d][i] = (ray.direction(d) == 0)
+                ? 0
+                : 1 / ray.direction(d);
+        }
+        length_[i] = ray.length;
+        active_ |= (uint32_t)1 << i;
+        return i;
+    }
+    // Bit "i" is set if lane "i" intersects the box.
+    uint32_t mask(const AxisAlignedBoundingBox<TPos, 3>& aabb) const {
+        uint32_t result = 0;
+        for (size_t i = 0; i < tsize; ++i) {
+            TPos t0 = 0;
+            TPos t1 = length_[i];
+            for (size_t d = 0; d < 3; ++d) {
+                TPos a;
+                TPos b;
+                if (inv_direction_[d][i] == 0) {
+                    // Parallel rays either never or always overlap the slab.
+                    bool inside =
+                        (start_[d][i] >= aabb.min(d)) &&
+                        (start_[d][i] <= aabb.max(d));
+                    a = inside ? -BIG : BIG;
+                    b = BIG;
+                } else {
+                    a = (aabb.min(d) - start_[d][i]) * inv_direction_[d][i];
+                    b = (aabb.max(d) - start_[d][i]) * inv_direction_[d][i];
+                }
+                t0 = std::max(t0, std::min(a, b));
+                t1 = std::min(t1, std::max(a, b));
+            }
+            result |= (uint32_t)(t0 <= t1) << i;
+        }
+        return result;
+    }
+    bool intersects(const AxisAlignedBoundingBox<TPos, 3>& aabb) const {
+        last_mask_ = mask(aabb) & active_;
+        return last_mask_ != 0;
+    }
+    inline uint32_t last_mask() const {
+        return last_mask_;
+    }
+    inline uint32_t active() const {
+        return active_;
+    }
+    inline void deactivate(size_t i) {
+        active_ &= ~((uint32_t)1 << i);
+    }
+    inline size_t nlanes() const {
+        return nlanes_;
+    }
+private:
+    static constexpr TPos BIG = std::numeric_limits<TPos>::max();
+    TPos start_[3][tsize];
+    TPos inv_direction_[3][tsize];
+    TPos length_[tsize];
+    size_t nlanes_;
+    uint32_t active_;
+    mutable uint32_t last_mask_;
+};
+
+template <class TPos, size_t tsize>
+inline bool intersects(
+    const RayPacket3DForAabb<TPos, tsize>& a,
+    const AxisAlignedBoundingBox<TPos, 3>& b)
+{
+    return a.intersects(b);
+}
+
+template <size_t tsize>
+inline bool intersects(
+    const RayPacket3DForAabb<ScenePos, tsize>& a,
+    const AxisAlignedBoundingBox<CompressedScenePos, 3>& b)
+{
+    return a.intersects(b.casted<ScenePos>());
+}
+
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <type_traits>
+
+namespace Mlib {
+
+// 64-bit FNV-1a, stable across platforms and runs (unlike std::hash),
+// hence suitable for keys that are persisted to disk.
+class Fnv1a {
+public:
+    static const uint64_t offset_basis = 0xcbf29ce484222325ULL;
+    static const uint64_t prime = 0x100000001b3ULL;
+    explicit Fnv1a(uint64_t seed = offset_basis)
+        : hash_{ seed }
+    {}
+    inline Fnv1a& update(std::span<const std::byte> data) {
+        for (std::byte b : data) {
+            hash_ ^= (uint64_t)b;
+            hash_ *= prime;
+        }
+        return *this;
+    }
+    inline Fnv1a& update(std::string_view data) {
+        return update(std::as_bytes(std::span{ data.data(), data.size() }));
+    }
+    template <class T>
+        requires std::is_trivially_copyable_v<T>
+    inline Fnv1a& update_value(const T& v) {
+        return update(std::as_bytes(std::span{ &v, 1 }));
+    }
+    inline uint64_t digest() const {
+        return hash_;
+    }
+private:
+    uint64_t hash_;
+};
+
+inline uint64_t fnv1a(std::span<const std::byte> data) {
+    return Fnv1a{}.update(data).digest();
+}
+
+inline uint64_t fnv1a(std::string_view data) {
+    return Fnv1a{}.update(data).digest();
+}
+
+}
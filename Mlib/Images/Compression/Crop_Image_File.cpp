@@ -1,27 +1,87 @@
 #include "Crop_Image_File.hpp"
 #include <Mlib/Array/Fixed_Array.hpp>
+#include <Mlib/Images/StbImage1.hpp>
+#include <Mlib/Images/StbImage2.hpp>
+#include <Mlib/Images/StbImage3.hpp>
+#include <Mlib/Images/StbImage4.hpp>
+#include <Mlib/Images/Tiles/Process_Tiles.hpp>
+#include <Mlib/Images/Tiles/Tile_Cache.hpp>
+#include <Mlib/Images/Tiles/Tiled_Image_File.hpp>
+#include <Mlib/Images/Tiles/Tiled_Operations.hpp>
 #include <stb/stb_image_write.h>
 #include <stb_cpp/stb_array.hpp>
 #include <stb_cpp/stb_image_load.hpp>
 
 using namespace Mlib;
 
-static void crop_image(
-    const StbInfo<uint8_t>& source,
-    const Utf8Path& destination,
+static const size_t CROP_TILE_SIZE = 256;
+static const size_t CROP_TILE_CACHE_NBYTES = 256 * 1024 * 1024;
+
+static void check_crop_bounds(
+    size_t height,
+    size_t width,
     const FixedArray<size_t, 2>& begin,
-    const FixedArray<size_t, 2>& end,
-    int jpg_quality)
+    const FixedArray<size_t, 2>& end)
 {
     if (any(begin > end)) {
         throw std::runtime_error("begin > end");
     }
-    if (end(0) > integral_cast<size_t>(source.height)) {
+    if (end(0) > height) {
         throw std::runtime_error("End height too large");
     }
-    if (end(1) > integral_cast<size_t>(source.width)) {
+    if (end(1) > width) {
         throw std::runtime_error("End width too large");
     }
+}
+
+// Crops a tiled image file (".mtil"). Only the tiles that intersect
+// the cropped region are read.
+static void crop_tiled_image(
+    const Utf8Path& source,
+    const Utf8Path& destination,
+    const FixedArray<size_t, 2>& begin,
+    const FixedArray<size_t, 2>& end,
+    int jpg_quality)
+{
+    TileCache cache{ CROP_TILE_CACHE_NBYTES };
+    TiledImageFileReader reader{ source, cache };
+    check_crop_bounds(reader.height(), reader.width(), begin, end);
+    CroppedTiledImage cropped{ reader, { begin(0), begin(1), end(0) - begin(0), end(1) - begin(1) } };
+    if (destination.extension() == ".mtil") {
+        save_tiled_image_file(cropped, destination, CROP_TILE_SIZE);
+        return;
+    }
+    auto result = evaluate_tiled_image(cropped, CROP_TILE_SIZE);
+    switch (result.shape(0)) {
+    case 1:
+        StbImage1::from_float_grayscale(result[0]).save_to_file(destination, jpg_quality);
+        break;
+    case 2:
+        StbImage2::from_float_ia(result).save_to_file(destination, jpg_quality);
+        break;
+    case 3:
+        StbImage3::from_float_rgb(result).save_to_file(destination, jpg_quality);
+        break;
+    case 4:
+        StbImage4::from_float_rgba(result).save_to_file(destination, jpg_quality);
+        break;
+    default:
+        throw std::runtime_error("Unsupported number of channels: \"" + source.string() + '"');
+    }
+}
+
+static void crop_image(
+    const StbInfo<uint8_t>& source,
+    const Utf8Path& destination,
+    const FixedArray<size_t, 2>& begin,
+    const FixedArray<size_t, 2>& end,
+    int jpg_quality)
+{
+    check_crop_bounds(
+        integral_cast<size_t>(source.height),
+        integral_cast<size_t>(source.width),
+        begin,
+        end);
     auto a = stb_image_2_array(source);
     auto b = a.cropped(
         ArrayShape{0, begin(0), begin(1)},
@@ -51,6 +111,10 @@ void Mlib::crop_image_file(
     const FixedArray<size_t, 2>& end,
     int jpg_quality)
 {
+    if (source.extension() == ".mtil") {
+        crop_tiled_image(source, destination, begin, end, jpg_quality);
+        return;
+    }
     auto f = stb_load8(source, FlipMode::NONE);
     crop_image(f, destination, begin, end, jpg_quality);
 }
@@ -61,11 +125,21 @@ void Mlib::crop_image_file(
     const FixedArray<size_t, 2>& size,
     int jpg_quality)
 {
+    auto left = size / 2u;
+    if (source.extension() == ".mtil") {
+        FixedArray<size_t, 2> center = uninitialized;
+        {
+            TileCache cache{ 0 };
+            TiledImageFileReader reader{ source, cache };
+            center = { reader.height() / 2, reader.width() / 2 };
+        }
+        crop_tiled_image(source, destination, center - left, center + (size - left), jpg_quality);
+        return;
+    }
     auto f = stb_load8(source, FlipMode::NONE);
     auto center = FixedArray<size_t, 2>{
         integral_cast<size_t>(f.height / 2),
         integral_cast<size_t>(f.width / 2)};
-    auto left = size / 2u;
     auto begin = center - left;
     auto end = center + (size - left);
     crop_image(f, destination, begin, end, jpg_quality);
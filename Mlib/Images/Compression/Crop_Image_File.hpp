@@ -7,6 +7,8 @@ namespace Mlib {
 template <typename TData, size_t... tshape>
 class FixedArray;
 
+// Only the tiles that intersect the crop are read from ".mtil" sources.
+// Other sources are decoded by stb in one piece.
 void crop_image_file(
     const Utf8Path& source,
     const Utf8Path& destination,
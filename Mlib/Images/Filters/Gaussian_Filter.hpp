@@ -7,21 +7,44 @@
 
 namespace Mlib {
 
+enum class GaussianFilterMethod {
+    // Exact convolution with the truncated kernel.
+    FIR,
+    // Recursive approximation with O(1) operations per pixel,
+    // independent of "sigma". For sigma >= 5, the result deviates
+    // from the exact Gaussian by less than 4e-3 of the value range,
+    // and the deviation grows for smaller sigma. "truncate" is
+    // ignored, and periodic extension and polynomial contrast are not
+    // supported.
+    RECURSIVE
+};
+
 template <class TData, class TSigma>
-Array<TData> gaussian_filter_1d_NWE(
+void gaussian_filter_1d_NWE(
     const Array<TData>& image,
+    Array<TData>& result,
     const TSigma& sigma,
     size_t axis,
     const TData& boundary_value,
     const TSigma& truncate = 4,
     FilterExtension fc = FilterExtension::NWE,
-    size_t poly_degree = 0)
+    size_t poly_degree = 0,
+    GaussianFilterMethod method = GaussianFilterMethod::FIR)
 {
     if (sigma == 0) {
-        return image.copy();
+        separable_filter_prepare_result(image, result);
+        std::copy(image.flat_begin(), image.flat_end(), result.flat_begin());
+        return;
     }
-    auto coeffs = gaussian_kernel(sigma, truncate);
     poly_degree = (poly_degree / 2) * 2;
+    if (method == GaussianFilterMethod::RECURSIVE) {
+        if (poly_degree != 0) {
+            throw std::runtime_error("Recursive Gaussian filter does not support polynomial contrast");
+        }
+        recursive_gaussian_filter_1d_NWE(image, result, sigma, boundary_value, axis, fc);
+        return;
+    }
+    auto coeffs = gaussian_kernel(sigma, truncate);
     if (poly_degree != 0) {
         Array<TSigma> contrast = zeros<TSigma>(ArrayShape{ 1 + poly_degree });
         contrast(0) = 1;
@@ -29,7 +52,26 @@ Array<TData> gaussian_filter_1d_NWE(
         A[0] = linspace<TSigma>(-1, 1, coeffs.length());
         coeffs = polynomial_contrast(A, coeffs, contrast, poly_degree);
     }
-    return lowpass_filter_1d_NWE(image, coeffs, boundary_value, axis, fc);
+    separable_filter_1d_NWE(image, result, coeffs, boundary_value, axis, fc);
+}
+
+template <class TData, class TSigma>
+Array<TData> gaussian_filter_1d_NWE(
+    const Array<TData>& image,
+    const TSigma& sigma,
+    size_t axis,
+    const TData& boundary_value,
+    const TSigma& truncate = 4,
+    FilterExtension fc = FilterExtension::NWE,
+    size_t poly_degree = 0,
+    GaussianFilterMethod method = GaussianFilterMethod::FIR)
+{
+    if (sigma == 0) {
+        return image.copy();
+    }
+    Array<TData> result;
+    gaussian_filter_1d_NWE(image, result, sigma, axis, boundary_value, truncate, fc, poly_degree, method);
+    return result;
 }
 
 template <class TData, class TSigma>
@@ -39,16 +81,20 @@ Array<TData> gaussian_filter_NWE(
     const TData& boundary_value,
     const TSigma& truncate = 4,
     FilterExtension fc = FilterExtension::NWE,
-    size_t poly_degree = 0)
+    size_t poly_degree = 0,
+    GaussianFilterMethod method = GaussianFilterMethod::FIR)
 {
     if (image.ndim() == 0) {
         return image.copy();
     }
-    Array<TData> result;
+    if (sigma == 0) {
+        return image.copy();
+    }
+    Array<TData> buffers[2];
     for (size_t axis = 0; axis < image.ndim(); ++axis) {
-        result.move() = gaussian_filter_1d_NWE(axis == 0 ? image : result, sigma, axis, boundary_value, truncate, fc, poly_degree);
+        gaussian_filter_1d_NWE(axis == 0 ? image : buffers[(axis + 1) % 2], buffers[axis % 2], sigma, axis, boundary_value, truncate, fc, poly_degree, method);
     }
-    return result;
+    return std::move(buffers[(image.ndim() - 1) % 2]);
 }
 
 template <class TData>
@@ -58,16 +104,21 @@ Array<TData> multichannel_gaussian_filter_NWE(
     const TData& boundary_value,
     const TData& truncate = 4,
     FilterExtension fc = FilterExtension::NWE,
-    size_t poly_degree = 0)
+    size_t poly_degree = 0,
+    GaussianFilterMethod method = GaussianFilterMethod::FIR)
 {
     if (image.ndim() == 0) {
         throw std::runtime_error("Image dimension must be > 0");
     }
-    Array<TData> result{ image.shape() };
-    for (size_t h = 0; h < image.shape(0); ++h) {
-        result[h] = std::move(gaussian_filter_NWE(image[h], sigma, boundary_value, truncate, fc, poly_degree));
+    if ((image.ndim() == 1) || (sigma == 0)) {
+        return image.copy();
     }
-    return result;
+    // The channels are filtered together, axis by axis.
+    Array<TData> buffers[2];
+    for (size_t axis = 1; axis < image.ndim(); ++axis) {
+        gaussian_filter_1d_NWE(axis == 1 ? image : buffers[axis % 2], buffers[(axis + 1) % 2], sigma, axis, boundary_value, truncate, fc, poly_degree, method);
+    }
+    return std::move(buffers[image.ndim() % 2]);
 }
 
 }
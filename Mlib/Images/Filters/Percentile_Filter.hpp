@@ -0,0 +1,377 @@
+#pragma once
+#include <Mlib/Array/Array.hpp>
+#include <Mlib/Memory/Integral_Cast.hpp>
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <set>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace Mlib {
+
+// Number of output columns processed together by the histogram filter,
+// which bounds the memory of the column histograms for 16-bit data.
+static const size_t HISTOGRAM_PERCENTILE_FILTER_STRIP_WIDTH = 64;
+
+// Zero-based index of the "percentile" in a sorted list with "nvalues"
+// elements. "0.5" yields "nvalues / 2", like the original median filter.
+inline size_t percentile_rank(size_t nvalues, double percentile) {
+    if (nvalues == 0) {
+        throw std::runtime_error("Percentile of empty list");
+    }
+    return std::min(nvalues - 1, (size_t)(percentile * (double)nvalues));
+}
+
+// Sliding-window order statistic. The smallest elements are kept in
+// "lo", the others in "hi", and elements are moved between the two sets
+// when querying a rank, s.t. sliding the window and querying a rank that
+// only changes slightly is O(log n) per inserted or erased element.
+template <class TData>
+class SlidingOrderStatistic {
+public:
+    void clear() {
+        lo_.clear();
+        hi_.clear();
+    }
+    void insert(const TData& v) {
+        if (!lo_.empty() && (v <= *lo_.rbegin())) {
+            lo_.insert(v);
+        } else {
+            hi_.insert(v);
+        }
+    }
+    void erase(const TData& v) {
+        // All elements in "lo" are <= all elements in "hi",
+        // so "v" is in "lo" iff "v <= max(lo)".
+        if (!lo_.empty() && (v <= *lo_.rbegin())) {
+            lo_.erase(lo_.find(v));
+        } else {
+            hi_.erase(hi_.find(v));
+        }
+    }
+    size_t size() const {
+        return lo_.size() + hi_.size();
+    }
+    const TData& operator [] (size_t rank) {
+        if (rank >= size()) {
+            throw std::runtime_error("Order statistic rank out of bounds");
+        }
+        while (lo_.size() > rank + 1) {
+            auto it = std::prev(lo_.end());
+            hi_.insert(hi_.begin(), *it);
+            lo_.erase(it);
+        }
+        while (lo_.size() < rank + 1) {
+            auto it = hi_.begin();
+            lo_.insert(lo_.end(), *it);
+            hi_.erase(it);
+        }
+        return *lo_.rbegin();
+    }
+private:
+    std::multiset<TData> lo_;
+    std::multiset<TData> hi_;
+};
+
+// Percentile filter for floating point data. NaN values are ignored,
+// and windows with less than "minelements" valid values yield
+// "boundary_value". Each row slides an order statistic over the image,
+// which is O(window_size * log(window_size)) per pixel. Only used for
+// images with too many distinct values for the histogram filter.
+template <class TData>
+void sliding_percentile_filter_2d(
+    const Array<TData>& im,
+    Array<TData>& result,
+    size_t window_size,
+    double percentile,
+    size_t minelements,
+    const TData& boundary_value)
+{
+    size_t w = window_size;
+    size_t ncols = im.shape(1);
+    #pragma omp parallel
+    {
+        SlidingOrderStatistic<TData> window;
+        auto update_column = [&](size_t r, size_t c, bool insert) {
+            for (size_t rr = r - w; rr <= r + w; ++rr) {
+                const TData& v = im(rr, c);
+                if (std::isnan(v)) {
+                    continue;
+                }
+                if (insert) {
+                    window.insert(v);
+                } else {
+                    window.erase(v);
+                }
+            }
+        };
+        #pragma omp for
+        for (int ri = (int)w; ri < (int)(im.shape(0) - w); ++ri) {
+            auto r = (size_t)ri;
+            window.clear();
+            for (size_t c = 0; c < 2 * w; ++c) {
+                update_column(r, c, true);
+            }
+            for (size_t c = w; c < ncols - w; ++c) {
+                update_column(r, c + w, true);
+                if (c > w) {
+                    update_column(r, c - w - 1, false);
+                }
+                if ((window.size() >= minelements) && (window.size() != 0)) {
+                    result(r, c) = window[percentile_rank(window.size(), percentile)];
+                } else {
+                    result(r, c) = boundary_value;
+                }
+            }
+        }
+    }
+}
+
+// Percentile filter for integer data in "[0, nvalues)", after Perreault
+// and Hebert, "Median Filtering in Constant Time" (2007). Every column
+// keeps a histogram of its window rows, and the kernel histogram is
+// updated by adding and subtracting one column histogram per pixel. The
+// histograms have two levels, sized to "nvalues", and the fine level of
+// the kernel histogram is only updated for the coarse bin that contains
+// the requested rank.
+// If "ignore_last" is set, the value "nvalues - 1" marks invalid pixels.
+// They are excluded from the rank, and windows with less than
+// "minelements" valid values yield "boundary_value".
+// "value(i)" converts a histogram bin to the result type.
+template <class TIndex, class TResult, class TValue>
+void histogram_percentile_filter_2d(
+    const Array<TIndex>& im,
+    Array<TResult>& result,
+    size_t window_size,
+    double percentile,
+    size_t nvalues,
+    bool ignore_last,
+    size_t minelements,
+    const TResult& boundary_value,
+    const TValue& value)
+{
+    static_assert(std::is_same_v<TIndex, uint8_t> || std::is_same_v<TIndex, uint16_t>);
+    if ((nvalues == 0) || (nvalues > (size_t(1) << (8 * sizeof(TIndex))))) {
+        throw std::runtime_error("Histogram percentile filter value count out of range");
+    }
+    size_t nbits = std::bit_width(nvalues - 1);
+    size_t shift = (nbits + 1) / 2;
+    size_t nfine = size_t(1) << shift;
+    size_t ncoarse = size_t(1) << (nbits - shift);
+    static const size_t INVALID = SIZE_MAX;
+    size_t w = window_size;
+    size_t nrows = im.shape(0);
+    size_t ncols = im.shape(1);
+    if (2 * w + 1 > std::numeric_limits<uint16_t>::max()) {
+        throw std::runtime_error("Window too large for histogram percentile filter");
+    }
+    size_t nwindow = (2 * w + 1) * (2 * w + 1);
+    size_t nout = ncols - 2 * w;
+    size_t nstrips = (nout + HISTOGRAM_PERCENTILE_FILTER_STRIP_WIDTH - 1) / HISTOGRAM_PERCENTILE_FILTER_STRIP_WIDTH;
+    #pragma omp parallel
+    {
+        size_t max_strip_cols = HISTOGRAM_PERCENTILE_FILTER_STRIP_WIDTH + 2 * w;
+        std::vector<uint16_t> col_coarse(max_strip_cols * ncoarse);
+        std::vector<uint16_t> col_fine(max_strip_cols * ncoarse * nfine);
+        std::vector<uint16_t> col_invalid(max_strip_cols);
+        std::vector<uint32_t> k_coarse(ncoarse);
+        std::vector<uint32_t> k_fine(ncoarse * nfine);
+        std::vector<size_t> k_fine_center(ncoarse);
+        #pragma omp for
+        for (int s = 0; s < integral_cast<int>(nstrips); ++s) {
+            // Image column of the leftmost window column in the strip.
+            size_t c0 = (size_t)s * HISTOGRAM_PERCENTILE_FILTER_STRIP_WIDTH;
+            size_t nstrip = std::min(HISTOGRAM_PERCENTILE_FILTER_STRIP_WIDTH, nout - (size_t)s * HISTOGRAM_PERCENTILE_FILTER_STRIP_WIDTH);
+            size_t nstrip_cols = nstrip + 2 * w;
+            std::fill(col_coarse.begin(), col_coarse.end(), uint16_t(0));
+            std::fill(col_fine.begin(), col_fine.end(), uint16_t(0));
+            std::fill(col_invalid.begin(), col_invalid.end(), uint16_t(0));
+            auto update_column = [&](size_t r, size_t x, int delta) {
+                size_t v = im(r, c0 + x);
+                if (v >= nvalues) {
+                    throw std::runtime_error("Histogram percentile filter value out of range");
+                }
+                col_coarse[x * ncoarse + (v >> shift)] += (uint16_t)delta;
+                col_fine[x * ncoarse * nfine + v] += (uint16_t)delta;
+                if (ignore_last && (v == nvalues - 1)) {
+                    col_invalid[x] += (uint16_t)delta;
+                }
+            };
+            for (size_t r = 0; r < 2 * w; ++r) {
+                for (size_t x = 0; x < nstrip_cols; ++x) {
+                    update_column(r, x, 1);
+                }
+            }
+            for (size_t r = w; r < nrows - w; ++r) {
+                for (size_t x = 0; x < nstrip_cols; ++x) {
+                    update_column(r + w, x, 1);
+                    if (r > w) {
+                        update_column(r - w - 1, x, -1);
+                    }
+                }
+                std::fill(k_coarse.begin(), k_coarse.end(), 0);
+                std::fill(k_fine_center.begin(), k_fine_center.end(), INVALID);
+                size_t k_invalid = 0;
+                for (size_t x = 0; x < 2 * w + 1; ++x) {
+                    for (size_t b = 0; b < ncoarse; ++b) {
+                        k_coarse[b] += col_coarse[x * ncoarse + b];
+                    }
+                    k_invalid += col_invalid[x];
+                }
+                // "x" is the window center, relative to "c0".
+                for (size_t x = w; x < nstrip + w; ++x) {
+                    if (x > w) {
+                        const uint16_t* add = col_coarse.data() + (x + w) * ncoarse;
+                        const uint16_t* sub = col_coarse.data() + (x - w - 1) * ncoarse;
+                        for (size_t b = 0; b < ncoarse; ++b) {
+                            k_coarse[b] += add[b];
+                            k_coarse[b] -= sub[b];
+                        }
+                        k_invalid += col_invalid[x + w];
+                        k_invalid -= col_invalid[x - w - 1];
+                    }
+                    size_t nvalid = nwindow - k_invalid;
+                    if ((nvalid == 0) || (nvalid < minelements)) {
+                        result(r, c0 + x) = boundary_value;
+                        continue;
+                    }
+                    // The invalid value is the largest one, so it is
+                    // never reached when searching a valid rank.
+                    size_t rank = percentile_rank(nvalid, percentile);
+                    size_t b = 0;
+                    size_t cum = 0;
+                    while (cum + k_coarse[b] <= rank) {
+                        cum += k_coarse[b++];
+                    }
+                    uint32_t* kf = k_fine.data() + b * nfine;
+                    size_t& center = k_fine_center[b];
+                    if ((center == INVALID) || (x - center > 2 * w)) {
+                        std::fill(kf, kf + nfine, 0);
+                        for (size_t xx = x - w; xx <= x + w; ++xx) {
+                            const uint16_t* add = col_fine.data() + (xx * ncoarse + b) * nfine;
+                            for (size_t f = 0; f < nfine; ++f) {
+                                kf[f] += add[f];
+                            }
+                        }
+                    } else {
+                        for (size_t xx = center + 1; xx <= x; ++xx) {
+                            const uint16_t* add = col_fine.data() + ((xx + w) * ncoarse + b) * nfine;
+                            const uint16_t* sub = col_fine.data() + ((xx - w - 1) * ncoarse + b) * nfine;
+                            for (size_t f = 0; f < nfine; ++f) {
+                                kf[f] += add[f];
+                                kf[f] -= sub[f];
+                            }
+                        }
+                    }
+                    center = x;
+                    size_t f = 0;
+                    while (cum + kf[f] <= rank) {
+                        cum += kf[f++];
+                    }
+                    result(r, c0 + x) = value((b << shift) | f);
+                }
+            }
+        }
+    }
+}
+
+// Percentile filter for floating point data with at most 65535
+// distinct values. The image is replaced by the indices of its values
+// in the sorted list of distinct values, which is exact, and NaN by
+// the largest index. The indices are filtered by the histogram filter.
+// Returns false, leaving "result" untouched, if there are too many
+// distinct values.
+template <class TData>
+bool ranked_percentile_filter_2d(
+    const Array<TData>& im,
+    Array<TData>& result,
+    size_t window_size,
+    double percentile,
+    size_t minelements,
+    const TData& boundary_value)
+{
+    std::vector<TData> values;
+    values.reserve(im.nelements());
+    for (const TData& v : im.flat_iterable()) {
+        if (!std::isnan(v)) {
+            values.push_back(v);
+        }
+    }
+    std::sort(values.begin(), values.end());
+    values.erase(std::unique(values.begin(), values.end()), values.end());
+    if (values.size() >= std::numeric_limits<uint16_t>::max()) {
+        return false;
+    }
+    Array<uint16_t> indices{ im.shape() };
+    {
+        const TData* s = im.flat_begin();
+        uint16_t* d = indices.flat_begin();
+        for (size_t i = 0; i < im.nelements(); ++i) {
+            d[i] = std::isnan(s[i])
+                ? (uint16_t)values.size()
+                : (uint16_t)(std::lower_bound(values.begin(), values.end(), s[i]) - values.begin());
+        }
+    }
+    histogram_percentile_filter_2d(
+        indices,
+        result,
+        window_size,
+        percentile,
+        values.size() + 1,
+        true,
+        minelements,
+        boundary_value,
+        [&values](size_t i) { return values[i]; });
+    return true;
+}
+
+// Percentile of the "(2 * window_size + 1)^2" neighborhood of each pixel.
+// The border, where the window does not fit into the image, is set to
+// "boundary_value". 8- and 16-bit data use the constant-time histogram
+// filter, as does floating point data with at most 65535 distinct values.
+// Floating point data with more distinct values falls back to the
+// sliding order statistic, which is O(window_size * log(window_size))
+// per pixel.
+template <class TData>
+Array<TData> percentile_filter_2d(
+    const Array<TData>& im,
+    size_t window_size,
+    double percentile,
+    size_t minelements = 1,
+    TData boundary_value = NAN)
+{
+    assert(im.ndim() == 2);
+    assert(minelements > 0);
+    if ((percentile < 0.) || (percentile > 1.)) {
+        throw std::runtime_error("Percentile not in [0, 1]");
+    }
+    Array<TData> result = full(im.shape(), boundary_value);
+    if (any(im.shape() < 2 * window_size + 1)) {
+        return result;
+    }
+    if constexpr (std::is_integral_v<TData>) {
+        size_t nvalues = (size_t)*std::max_element(im.flat_begin(), im.flat_end()) + 1;
+        histogram_percentile_filter_2d(
+            im,
+            result,
+            window_size,
+            percentile,
+            nvalues,
+            false,
+            minelements,
+            boundary_value,
+            [](size_t i) { return (TData)i; });
+    } else {
+        if (!ranked_percentile_filter_2d(im, result, window_size, percentile, minelements, boundary_value)) {
+            sliding_percentile_filter_2d(im, result, window_size, percentile, minelements, boundary_value);
+        }
+    }
+    return result;
+}
+
+}
@@ -0,0 +1,301 @@
+#pragma once
+#include <Mlib/Array/Array.hpp>
+#include <Mlib/Images/Filters/Lowpass_Filter_Extension.hpp>
+#include <Mlib/Math/Math.hpp>
+#include <Mlib/Memory/Integral_Cast.hpp>
+#include <cmath>
+#include <complex>
+#include <type_traits>
+#include <vector>
+
+namespace Mlib {
+
+// Number of columns that are filtered together when filtering
+// along a non-contiguous axis. Every row of a tile is a contiguous
+// run of samples, s.t. the loads are contiguous and the tap loop
+// vectorizes. The tile spans the whole axis, so it is only
+// cache-resident for short axes.
+static const size_t SEPARABLE_FILTER_TILE_WIDTH = 64;
+
+// View of an array as "[outer, n, inner]", where "n" is the
+// length of the filtered axis and "inner" is contiguous.
+struct SeparableFilterLayout {
+    SeparableFilterLayout(const ArrayShape& shape, size_t axis)
+        : outer{ 1 }
+        , n{ shape(axis) }
+        , inner{ 1 }
+    {
+        for (size_t i = 0; i < axis; ++i) {
+            outer *= shape(i);
+        }
+        for (size_t i = axis + 1; i < shape.ndim(); ++i) {
+            inner *= shape(i);
+        }
+    }
+    size_t outer;
+    size_t n;
+    size_t inner;
+};
+
+// Padded source line, where out-of-range samples are either wrapped
+// around ("PERIODIC"), or set to NaN, s.t. they are ignored the same
+// way as NaN samples in the image. Converts to the accumulator type.
+template <class TAcc, class TData>
+void separable_filter_load_padded(
+    const TData* src,
+    size_t n,
+    size_t stride,
+    size_t width,
+    size_t pad,
+    FilterExtension fc,
+    TAcc* dst)
+{
+    for (size_t i = 0; i < n + 2 * pad; ++i) {
+        TAcc* d = dst + i * width;
+        ptrdiff_t j = (ptrdiff_t)i - (ptrdiff_t)pad;
+        if (any(fc & FilterExtension::PERIODIC)) {
+            j = ((j % (ptrdiff_t)n) + (ptrdiff_t)n) % (ptrdiff_t)n;
+        } else if ((j < 0) || (j >= (ptrdiff_t)n)) {
+            for (size_t c = 0; c < width; ++c) {
+                d[c] = (TAcc)NAN;
+            }
+            continue;
+        }
+        const TData* s = src + (size_t)j * stride;
+        for (size_t c = 0; c < width; ++c) {
+            d[c] = (TAcc)s[c];
+        }
+    }
+}
+
+// Reuses the memory of "result" if it already has the correct shape,
+// s.t. the passes over multiple axes can alternate between two arrays.
+template <class TData>
+void separable_filter_prepare_result(const Array<TData>& image, Array<TData>& result) {
+    if (!result.initialized() ||
+        (result.ndim() != image.ndim()) ||
+        !all(result.shape() == image.shape()))
+    {
+        result.do_resize(image.shape());
+    }
+}
+
+template <class TData, class TAcc>
+TData separable_filter_result(TAcc v, TAcc sc, const TData& boundary_value, FilterExtension fc) {
+    if (sc == 0) {
+        return boundary_value;
+    }
+    if (any(fc & FilterExtension::NWE)) {
+        v /= sc;
+    }
+    if constexpr (std::is_integral_v<TData>) {
+        return (TData)std::round(v);
+    } else {
+        return (TData)v;
+    }
+}
+
+// Convolution along one axis with NaN-weight normalization ("NWE").
+// Instead of iterating over the taps per pixel, every tap is applied to
+// a whole padded line (contiguous axis) or to a tile of
+// "SEPARABLE_FILTER_TILE_WIDTH" columns (other axes), which removes
+// the border checks from the inner loops and lets them vectorize.
+template <class TData, class TCoeffs>
+void separable_filter_1d_NWE(
+    const Array<TData>& image,
+    Array<TData>& result,
+    const Array<TCoeffs>& coeffs,
+    const TData& boundary_value,
+    size_t axis,
+    FilterExtension fc = FilterExtension::NWE)
+{
+    using TAcc = decltype(TCoeffs() * TData());
+    static_assert(std::is_floating_point_v<TAcc>);
+    assert(coeffs.ndim() == 1);
+    if (axis >= image.ndim()) {
+        throw std::runtime_error("Filter axis out of bounds");
+    }
+    separable_filter_prepare_result(image, result);
+    SeparableFilterLayout l{ image.shape(), axis };
+    if (l.n == 0) {
+        return;
+    }
+    size_t ntaps = coeffs.length();
+    size_t pad = ntaps / 2;
+    const TData* src = image.flat_begin();
+    TData* dst = result.flat_begin();
+    size_t width = std::min(l.inner, SEPARABLE_FILTER_TILE_WIDTH);
+    size_t ntiles = (l.inner + width - 1) / width;
+    #pragma omp parallel if (image.nelements() > 10'000)
+    {
+        std::vector<TAcc> line((l.n + 2 * pad) * width);
+        std::vector<TAcc> v(l.n * width);
+        std::vector<TAcc> sc(l.n * width);
+        #pragma omp for
+        for (int t = 0; t < integral_cast<int>(l.outer * ntiles); ++t) {
+            size_t o = (size_t)t / ntiles;
+            size_t c0 = ((size_t)t % ntiles) * width;
+            size_t w = std::min(width, l.inner - c0);
+            const TData* s = src + o * l.n * l.inner + c0;
+            TData* d = dst + o * l.n * l.inner + c0;
+            separable_filter_load_padded(s, l.n, l.inner, w, pad, fc, line.data());
+            std::fill(v.begin(), v.begin() + (ptrdiff_t)(l.n * w), TAcc(0));
+            std::fill(sc.begin(), sc.begin() + (ptrdiff_t)(l.n * w), TAcc(0));
+            for (size_t k = 0; k < ntaps; ++k) {
+                auto ck = (TAcc)coeffs(k);
+                const TAcc* x = line.data() + k * w;
+                TAcc* vv = v.data();
+                TAcc* ss = sc.data();
+                for (size_t i = 0; i < l.n * w; ++i) {
+                    bool ok = !std::isnan(x[i]);
+                    vv[i] += ok ? ck * x[i] : TAcc(0);
+                    ss[i] += ok ? ck : TAcc(0);
+                }
+            }
+            for (size_t i = 0; i < l.n; ++i) {
+                for (size_t c = 0; c < w; ++c) {
+                    d[i * l.inner + c] = separable_filter_result(v[i * w + c], sc[i * w + c], boundary_value, fc);
+                }
+            }
+        }
+    }
+}
+
+// Coefficients of the third-order recursive approximation of a
+// Gaussian by Young, van Vliet and van Ginkel, see "Recursive Gabor
+// filtering", IEEE Trans. Signal Processing 50 (2002). The poles for
+// sigma = 2 are scaled s.t. the variance of the forward and the
+// backward pass together equals sigma^2.
+template <class TAcc>
+struct RecursiveGaussianCoefficients {
+    explicit RecursiveGaussianCoefficients(TAcc sigma) {
+        using C = std::complex<double>;
+        const C d1{ 1.41650, 1.00829 };
+        const double d3 = 1.86543;
+        auto scaled = [&](double q) {
+            return std::make_pair(std::polar(std::pow(std::abs(d1), 1 / q), std::arg(d1) / q), std::pow(d3, 1 / q));
+        };
+        auto variance = [&](double q) {
+            auto [e1, e3] = scaled(q);
+            return 2 * (2 * (e1 / ((e1 - 1.) * (e1 - 1.))).real() + e3 / ((e3 - 1) * (e3 - 1)));
+        };
+        // The variance is monotonic in "q", so a bisection converges.
+        double q0 = 0;
+        double q1 = 2 * (double)sigma + 1;
+        for (size_t i = 0; i < 64; ++i) {
+            double q = (q0 + q1) / 2;
+            (variance(q) < squared((double)sigma) ? q0 : q1) = q;
+        }
+        auto [e1, e3] = scaled((q0 + q1) / 2);
+        auto p1 = 1. / e1;
+        auto p3 = 1. / e3;
+        b1 = (TAcc)(2 * p1.real() + p3);
+        b2 = (TAcc)(-(std::norm(p1) + 2 * p1.real() * p3));
+        b3 = (TAcc)(std::norm(p1) * p3);
+        B = TAcc(1) - (b1 + b2 + b3);
+    }
+    TAcc B;
+    TAcc b1;
+    TAcc b2;
+    TAcc b3;
+};
+
+// Gaussian filter along one axis with O(1) operations per pixel,
+// independent of "sigma". The image and its NaN-mask are filtered
+// with zero padding, and normalized afterwards ("NWE"). The
+// recursion runs over tiles of columns simultaneously, like
+// "separable_filter_1d_NWE". Periodic extension is not supported.
+template <class TData, class TSigma>
+void recursive_gaussian_filter_1d_NWE(
+    const Array<TData>& image,
+    Array<TData>& result,
+    const TSigma& sigma,
+    const TData& boundary_value,
+    size_t axis,
+    FilterExtension fc = FilterExtension::NWE)
+{
+    using TAcc = decltype(TSigma() * TData());
+    static_assert(std::is_floating_point_v<TAcc>);
+    if (any(fc & FilterExtension::PERIODIC)) {
+        throw std::runtime_error("Recursive Gaussian filter does not support periodic extension");
+    }
+    if (sigma < TSigma(0.5)) {
+        throw std::runtime_error("Recursive Gaussian filter requires sigma >= 0.5");
+    }
+    if (axis >= image.ndim()) {
+        throw std::runtime_error("Filter axis out of bounds");
+    }
+    separable_filter_prepare_result(image, result);
+    SeparableFilterLayout l{ image.shape(), axis };
+    if (l.n == 0) {
+        return;
+    }
+    RecursiveGaussianCoefficients<TAcc> r{ (TAcc)sigma };
+    // Three samples of zero padding at the beginning hold the initial
+    // conditions of the forward pass. At the end, the forward pass
+    // continues over the zero padding until its response has decayed,
+    // s.t. the backward pass can start from zero.
+    static const size_t pad = 3;
+    size_t tail = pad + (size_t)std::ceil(3 * sigma);
+    size_t nbuf = pad + l.n + tail;
+    const TData* src = image.flat_begin();
+    TData* dst = result.flat_begin();
+    size_t width = std::min(l.inner, SEPARABLE_FILTER_TILE_WIDTH);
+    size_t ntiles = (l.inner + width - 1) / width;
+    #pragma omp parallel if (image.nelements() > 10'000)
+    {
+        std::vector<TAcc> v(nbuf * width);
+        std::vector<TAcc> m(nbuf * width);
+        #pragma omp for
+        for (int t = 0; t < integral_cast<int>(l.outer * ntiles); ++t) {
+            size_t o = (size_t)t / ntiles;
+            size_t c0 = ((size_t)t % ntiles) * width;
+            size_t w = std::min(width, l.inner - c0);
+            const TData* s = src + o * l.n * l.inner + c0;
+            TData* d = dst + o * l.n * l.inner + c0;
+            std::fill(v.data(), v.data() + pad * w, TAcc(0));
+            std::fill(m.data(), m.data() + pad * w, TAcc(0));
+            std::fill(v.data() + (l.n + pad) * w, v.data() + nbuf * w, TAcc(0));
+            std::fill(m.data() + (l.n + pad) * w, m.data() + nbuf * w, TAcc(0));
+            for (size_t i = 0; i < l.n; ++i) {
+                TAcc* vi = v.data() + (i + pad) * w;
+                TAcc* mi = m.data() + (i + pad) * w;
+                for (size_t c = 0; c < w; ++c) {
+                    auto x = (TAcc)s[i * l.inner + c];
+                    bool ok = !std::isnan(x);
+                    vi[c] = ok ? x : TAcc(0);
+                    mi[c] = ok ? TAcc(1) : TAcc(0);
+                }
+            }
+            auto recurse = [&](TAcc* y, size_t i, ptrdiff_t step) {
+                TAcc* yi = y + i * w;
+                const TAcc* y1 = yi - step * (ptrdiff_t)w;
+                const TAcc* y2 = yi - 2 * step * (ptrdiff_t)w;
+                const TAcc* y3 = yi - 3 * step * (ptrdiff_t)w;
+                for (size_t c = 0; c < w; ++c) {
+                    yi[c] = r.B * yi[c] + r.b1 * y1[c] + r.b2 * y2[c] + r.b3 * y3[c];
+                }
+            };
+            for (size_t i = pad; i < nbuf - pad; ++i) {
+                recurse(v.data(), i, 1);
+                recurse(m.data(), i, 1);
+            }
+            for (size_t i = nbuf - pad; i-- > pad; ) {
+                recurse(v.data(), i, -1);
+                recurse(m.data(), i, -1);
+            }
+            for (size_t i = 0; i < l.n; ++i) {
+                const TAcc* vi = v.data() + (i + pad) * w;
+                const TAcc* mi = m.data() + (i + pad) * w;
+                for (size_t c = 0; c < w; ++c) {
+                    // The filtered mask of an isolated sample is far from
+                    // zero, so tiny values only occur far from valid data.
+                    TAcc sc = (mi[c] < TAcc(1e-6)) ? TAcc(0) : mi[c];
+                    d[i * l.inner + c] = separable_filter_result(vi[c], sc, boundary_value, fc);
+                }
+            }
+        }
+    }
+}
+
+}
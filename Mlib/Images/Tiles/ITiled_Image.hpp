@@ -0,0 +1,22 @@
+#pragma once
+#include <Mlib/Images/Tiles/Pixel_Region.hpp>
+#include <cstddef>
+
+namespace Mlib {
+
+template <class TData>
+class Array;
+
+// Image with shape "[channels, height, width]" that is evaluated lazily.
+// Consumers pull regions, s.t. the full image is never held in memory.
+// "read" must be thread-safe, and the region must lie inside the image.
+class ITiledImage {
+public:
+    virtual ~ITiledImage() = default;
+    virtual size_t nchannels() const = 0;
+    virtual size_t height() const = 0;
+    virtual size_t width() const = 0;
+    virtual Array<float> read(const PixelRegion& region) const = 0;
+};
+
+}
@@ -0,0 +1,13 @@
+#pragma once
+#include <cstddef>
+
+namespace Mlib {
+
+struct PixelRegion {
+    size_t row;
+    size_t col;
+    size_t nrows;
+    size_t ncols;
+};
+
+}
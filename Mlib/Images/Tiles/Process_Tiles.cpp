@@ -0,0 +1,69 @@
+#include "Process_Tiles.hpp"
+#include <Mlib/Array/Array.hpp>
+#include <Mlib/Images/Tiles/ITiled_Image.hpp>
+#include <Mlib/Images/Tiles/Tiled_Image_File.hpp>
+#include <Mlib/Memory/Integral_Cast.hpp>
+#include <exception>
+#include <stdexcept>
+#include <vector>
+
+using namespace Mlib;
+
+void Mlib::process_tiles(
+    const ITiledImage& image,
+    size_t tile_size,
+    const std::function<void(size_t tile_row, size_t tile_col, const PixelRegion& region, const Array<float>& tile)>& op)
+{
+    if (tile_size == 0) {
+        throw std::runtime_error("Tile size is zero");
+    }
+    size_t ntiles_y = (image.height() + tile_size - 1) / tile_size;
+    size_t ntiles_x = (image.width() + tile_size - 1) / tile_size;
+    std::vector<std::exception_ptr> exceptions(ntiles_y * ntiles_x);
+    #pragma omp parallel for schedule(dynamic)
+    for (int i = 0; i < integral_cast<int>(ntiles_y * ntiles_x); ++i) {
+        size_t tr = (size_t)i / ntiles_x;
+        size_t tc = (size_t)i % ntiles_x;
+        try {
+            PixelRegion region{
+                .row = tr * tile_size,
+                .col = tc * tile_size,
+                .nrows = std::min(tile_size, image.height() - tr * tile_size),
+                .ncols = std::min(tile_size, image.width() - tc * tile_size) };
+            op(tr, tc, region, image.read(region));
+        } catch (...) {
+            exceptions[(size_t)i] = std::current_exception();
+        }
+    }
+    for (const auto& e : exceptions) {
+        if (e != nullptr) {
+            std::rethrow_exception(e);
+        }
+    }
+}
+
+void Mlib::save_tiled_image_file(
+    const ITiledImage& image,
+    const Utf8Path& filename,
+    size_t tile_size)
+{
+    TiledImageFileWriter writer{ filename, image.nchannels(), image.height(), image.width(), tile_size };
+    process_tiles(image, tile_size, [&](size_t tile_row, size_t tile_col, const PixelRegion&, const Array<float>& tile){
+        writer.write_tile(tile_row, tile_col, tile);
+    });
+    writer.flush();
+}
+
+Array<float> Mlib::evaluate_tiled_image(const ITiledImage& image, size_t tile_size) {
+    Array<float> result{ ArrayShape{ image.nchannels(), image.height(), image.width() } };
+    process_tiles(image, tile_size, [&](size_t, size_t, const PixelRegion& region, const Array<float>& tile){
+        for (size_t h = 0; h < tile.shape(0); ++h) {
+            for (size_t r = 0; r < region.nrows; ++r) {
+                for (size_t c = 0; c < region.ncols; ++c) {
+                    result(h, region.row + r, region.col + c) = tile(h, r, c);
+                }
+            }
+        }
+    });
+    return result;
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include <Mlib/Images/Tiles/Pixel_Region.hpp>
+#include <Mlib/Strings/Utf8_Path.hpp>
+#include <cstddef>
+#include <functional>
+
+namespace Mlib {
+
+template <class TData>
+class Array;
+class ITiledImage;
+
+// Pulls the image tile by tile, in parallel, and passes every tile to
+// "op". Only the tiles currently processed by the threads are in
+// memory, and "op" must be thread-safe.
+void process_tiles(
+    const ITiledImage& image,
+    size_t tile_size,
+    const std::function<void(size_t tile_row, size_t tile_col, const PixelRegion& region, const Array<float>& tile)>& op);
+
+// Writes the image to a tiled image file (".mtil").
+void save_tiled_image_file(
+    const ITiledImage& image,
+    const Utf8Path& filename,
+    size_t tile_size);
+
+// Evaluates the whole image into memory.
+Array<float> evaluate_tiled_image(const ITiledImage& image, size_t tile_size);
+
+}
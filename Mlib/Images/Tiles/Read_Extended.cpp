@@ -0,0 +1,72 @@
+#include "Read_Extended.hpp"
+#include <Mlib/Array/Array.hpp>
+#include <Mlib/Images/Filters/Lowpass_Filter_Extension.hpp>
+#include <Mlib/Images/Tiles/ITiled_Image.hpp>
+#include <vector>
+
+using namespace Mlib;
+
+namespace {
+
+// Contiguous run of pixels along one axis.
+struct Segment {
+    size_t dst;
+    size_t src;
+    size_t length;
+};
+
+}
+
+static std::vector<Segment> axis_segments(ptrdiff_t begin, size_t length, size_t n, bool periodic) {
+    std::vector<Segment> result;
+    size_t i = 0;
+    while (i < length) {
+        ptrdiff_t j = begin + (ptrdiff_t)i;
+        if (periodic) {
+            auto src = (size_t)(((j % (ptrdiff_t)n) + (ptrdiff_t)n) % (ptrdiff_t)n);
+            size_t len = std::min(length - i, n - src);
+            result.push_back({ i, src, len });
+            i += len;
+        } else if (j < 0) {
+            i += (size_t)(-j);
+        } else if ((size_t)j >= n) {
+            break;
+        } else {
+            size_t len = std::min(length - i, n - (size_t)j);
+            result.push_back({ i, (size_t)j, len });
+            i += len;
+        }
+    }
+    return result;
+}
+
+Array<float> Mlib::read_extended(
+    const ITiledImage& image,
+    ptrdiff_t row,
+    ptrdiff_t col,
+    size_t nrows,
+    size_t ncols,
+    FilterExtension fc)
+{
+    if ((row >= 0) && (col >= 0) &&
+        ((size_t)row + nrows <= image.height()) &&
+        ((size_t)col + ncols <= image.width()))
+    {
+        return image.read({ (size_t)row, (size_t)col, nrows, ncols });
+    }
+    bool periodic = any(fc & FilterExtension::PERIODIC);
+    Array<float> result = full(ArrayShape{ image.nchannels(), nrows, ncols }, NAN);
+    for (const auto& r : axis_segments(row, nrows, image.height(), periodic)) {
+        for (const auto& c : axis_segments(col, ncols, image.width(), periodic)) {
+            auto block = image.read({ r.src, c.src, r.length, c.length });
+            for (size_t h = 0; h < image.nchannels(); ++h) {
+                for (size_t y = 0; y < r.length; ++y) {
+                    for (size_t x = 0; x < c.length; ++x) {
+                        result(h, r.dst + y, c.dst + x) = block(h, y, x);
+                    }
+                }
+            }
+        }
+    }
+    return result;
+}
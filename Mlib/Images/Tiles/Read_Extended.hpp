@@ -0,0 +1,21 @@
+#pragma once
+#include <cstddef>
+
+namespace Mlib {
+
+template <class TData>
+class Array;
+class ITiledImage;
+enum class FilterExtension;
+
+// Reads a region that may exceed the image. Pixels outside of the image
+// are wrapped around if "fc" contains "PERIODIC", and NaN otherwise.
+Array<float> read_extended(
+    const ITiledImage& image,
+    ptrdiff_t row,
+    ptrdiff_t col,
+    size_t nrows,
+    size_t ncols,
+    FilterExtension fc);
+
+}
@@ -0,0 +1,69 @@
+#include "Tile_Cache.hpp"
+#include <Mlib/Array/Array.hpp>
+#include <mutex>
+
+using namespace Mlib;
+
+TileCache::TileCache(size_t max_bytes)
+    : max_bytes_{ max_bytes }
+    , nbytes_{ 0 }
+    , next_owner_{ 0 }
+{}
+
+TileCache::~TileCache() = default;
+
+uint64_t TileCache::new_owner() {
+    std::scoped_lock lock{ mutex_ };
+    return next_owner_++;
+}
+
+void TileCache::forget(uint64_t owner) {
+    std::scoped_lock lock{ mutex_ };
+    auto it = entries_.lower_bound(Key{ owner, 0, 0 });
+    while ((it != entries_.end()) && (std::get<0>(it->first) == owner)) {
+        nbytes_ -= it->second.tile->nbytes();
+        lru_.erase(it->second.lru);
+        it = entries_.erase(it);
+    }
+}
+
+std::shared_ptr<const Array<float>> TileCache::get(
+    uint64_t owner,
+    size_t tile_row,
+    size_t tile_col,
+    const std::function<Array<float>()>& load)
+{
+    Key key{ owner, tile_row, tile_col };
+    {
+        std::scoped_lock lock{ mutex_ };
+        auto it = entries_.find(key);
+        if (it != entries_.end()) {
+            lru_.splice(lru_.begin(), lru_, it->second.lru);
+            return it->second.tile;
+        }
+    }
+    auto tile = std::make_shared<const Array<float>>(load());
+    std::scoped_lock lock{ mutex_ };
+    auto it = entries_.find(key);
+    if (it != entries_.end()) {
+        // Another thread loaded the same tile in the meantime.
+        return it->second.tile;
+    }
+    lru_.push_front(key);
+    entries_.try_emplace(key, Entry{ tile, lru_.begin() });
+    nbytes_ += tile->nbytes();
+    // The tile that was just inserted is never evicted, because
+    // its caller is about to use it.
+    while ((nbytes_ > max_bytes_) && (lru_.size() > 1)) {
+        auto e = entries_.find(lru_.back());
+        nbytes_ -= e->second.tile->nbytes();
+        entries_.erase(e);
+        lru_.pop_back();
+    }
+    return tile;
+}
+
+size_t TileCache::nbytes() const {
+    std::scoped_lock lock{ mutex_ };
+    return nbytes_;
+}
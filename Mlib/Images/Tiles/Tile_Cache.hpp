@@ -0,0 +1,51 @@
+#pragma once
+#include <Mlib/Os/Threads/Fast_Mutex.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <tuple>
+
+namespace Mlib {
+
+template <class TData>
+class Array;
+
+// Least-recently-used cache of decoded tiles, shared by all tiled
+// images of a pipeline, that keeps the total size of the tiles below
+// "max_bytes". Tiles are loaded outside of the lock, s.t. several
+// threads can decode different tiles at the same time.
+class TileCache {
+    TileCache(const TileCache&) = delete;
+    TileCache& operator = (const TileCache&) = delete;
+public:
+    explicit TileCache(size_t max_bytes);
+    ~TileCache();
+    // Identifies the tiles of one image. Ids are never reused, s.t. a
+    // new image cannot receive the tiles of a destroyed one.
+    uint64_t new_owner();
+    // Removes the tiles of an image, called when the image is destroyed.
+    void forget(uint64_t owner);
+    std::shared_ptr<const Array<float>> get(
+        uint64_t owner,
+        size_t tile_row,
+        size_t tile_col,
+        const std::function<Array<float>()>& load);
+    size_t nbytes() const;
+private:
+    using Key = std::tuple<uint64_t, size_t, size_t>;
+    struct Entry {
+        std::shared_ptr<const Array<float>> tile;
+        std::list<Key>::iterator lru;
+    };
+    size_t max_bytes_;
+    size_t nbytes_;
+    uint64_t next_owner_;
+    std::map<Key, Entry> entries_;
+    std::list<Key> lru_;
+    mutable FastMutex mutex_;
+};
+
+}
@@ -0,0 +1,204 @@
+#include "Tiled_Image_File.hpp"
+#include <Mlib/Array/Array.hpp>
+#include <Mlib/Images/Tiles/Tile_Cache.hpp>
+#include <Mlib/Memory/Integral_Cast.hpp>
+#include <Mlib/Os/Io/Binary.hpp>
+#include <Mlib/Os/Os.hpp>
+#include <mutex>
+#include <stdexcept>
+
+using namespace Mlib;
+
+static const uint32_t TILED_IMAGE_MAGIC = 0x4c49544d; // "MTIL"
+static const uint32_t TILED_IMAGE_VERSION = 1;
+static const size_t TILED_IMAGE_HEADER_NBYTES = 4 * sizeof(uint32_t) + 2 * sizeof(uint64_t);
+
+size_t TiledImageFileHeader::ntiles_y() const {
+    return (height + tile_size - 1) / tile_size;
+}
+
+size_t TiledImageFileHeader::ntiles_x() const {
+    return (width + tile_size - 1) / tile_size;
+}
+
+size_t TiledImageFileHeader::tile_nbytes() const {
+    return nchannels * tile_size * tile_size * sizeof(float);
+}
+
+size_t TiledImageFileHeader::tile_offset(size_t tile_row, size_t tile_col) const {
+    if ((tile_row >= ntiles_y()) || (tile_col >= ntiles_x())) {
+        throw std::runtime_error("Tile index out of bounds");
+    }
+    return TILED_IMAGE_HEADER_NBYTES + (tile_row * ntiles_x() + tile_col) * tile_nbytes();
+}
+
+TiledImageFileWriter::TiledImageFileWriter(
+    const Utf8Path& filename,
+    size_t nchannels,
+    size_t height,
+    size_t width,
+    size_t tile_size)
+    : filename_{ filename }
+    , header_{
+        .nchannels = nchannels,
+        .height = height,
+        .width = width,
+        .tile_size = tile_size }
+    , ostr_{ create_ofstream(filename, std::ios::binary) }
+{
+    if ((nchannels == 0) || (tile_size == 0)) {
+        throw std::runtime_error("Tiled image requires at least one channel and a tile size > 0");
+    }
+    if (ostr_->fail()) {
+        throw std::runtime_error("Could not open \"" + filename.string() + "\" for write");
+    }
+    write_binary(*ostr_, TILED_IMAGE_MAGIC, "tiled image magic");
+    write_binary(*ostr_, TILED_IMAGE_VERSION, "tiled image version");
+    write_binary(*ostr_, integral_cast<uint32_t>(nchannels), "tiled image channels");
+    write_binary(*ostr_, integral_cast<uint32_t>(tile_size), "tiled image tile size");
+    write_binary<uint64_t, true>(*ostr_, height, "tiled image height");
+    write_binary<uint64_t, true>(*ostr_, width, "tiled image width");
+}
+
+TiledImageFileWriter::~TiledImageFileWriter() = default;
+
+const TiledImageFileHeader& TiledImageFileWriter::header() const {
+    return header_;
+}
+
+void TiledImageFileWriter::write_tile(size_t tile_row, size_t tile_col, const Array<float>& tile) {
+    auto offset = header_.tile_offset(tile_row, tile_col);
+    size_t r0 = tile_row * header_.tile_size;
+    size_t c0 = tile_col * header_.tile_size;
+    size_t nrows = std::min(header_.tile_size, header_.height - r0);
+    size_t ncols = std::min(header_.tile_size, header_.width - c0);
+    if ((tile.ndim() != 3) ||
+        (tile.shape(0) != header_.nchannels) ||
+        (tile.shape(1) != nrows) ||
+        (tile.shape(2) != ncols))
+    {
+        throw std::runtime_error("Tile shape mismatch in \"" + filename_.string() + '"');
+    }
+    Array<float> padded = tile;
+    if ((nrows != header_.tile_size) || (ncols != header_.tile_size)) {
+        padded.move() = full(ArrayShape{ header_.nchannels, header_.tile_size, header_.tile_size }, NAN);
+        for (size_t h = 0; h < header_.nchannels; ++h) {
+            for (size_t r = 0; r < nrows; ++r) {
+                for (size_t c = 0; c < ncols; ++c) {
+                    padded(h, r, c) = tile(h, r, c);
+                }
+            }
+        }
+    }
+    std::scoped_lock lock{ mutex_ };
+    ostr_->seekp(integral_cast<std::streamoff>(offset));
+    ostr_->write((const char*)padded.flat_begin(), integral_cast<std::streamsize>(padded.nbytes()));
+    if (ostr_->fail()) {
+        throw std::runtime_error("Could not write tile to \"" + filename_.string() + '"');
+    }
+}
+
+void TiledImageFileWriter::flush() {
+    std::scoped_lock lock{ mutex_ };
+    ostr_->flush();
+    if (ostr_->fail()) {
+        throw std::runtime_error("Could not flush \"" + filename_.string() + '"');
+    }
+}
+
+TiledImageFileReader::TiledImageFileReader(const Utf8Path& filename, TileCache& cache)
+    : filename_{ filename }
+    , istr_{ create_ifstream(filename, std::ios::binary) }
+    , cache_{ cache }
+    , cache_owner_{ cache.new_owner() }
+{
+    if (istr_->fail()) {
+        throw std::runtime_error("Could not open \"" + filename.string() + "\" for read");
+    }
+    if (read_binary<uint32_t>(*istr_, "tiled image magic", IoVerbosity::SILENT) != TILED_IMAGE_MAGIC) {
+        throw std::runtime_error("\"" + filename.string() + "\" is not a tiled image");
+    }
+    if (read_binary<uint32_t>(*istr_, "tiled image version", IoVerbosity::SILENT) != TILED_IMAGE_VERSION) {
+        throw std::runtime_error("Unsupported tiled image version in \"" + filename.string() + '"');
+    }
+    header_.nchannels = read_binary<uint32_t>(*istr_, "tiled image channels", IoVerbosity::SILENT);
+    header_.tile_size = read_binary<uint32_t>(*istr_, "tiled image tile size", IoVerbosity::SILENT);
+    header_.height = read_binary<uint64_t, true>(*istr_, "tiled image height", IoVerbosity::SILENT);
+    header_.width = read_binary<uint64_t, true>(*istr_, "tiled image width", IoVerbosity::SILENT);
+    if ((header_.nchannels == 0) || (header_.tile_size == 0)) {
+        throw std::runtime_error("Corrupt tiled image header in \"" + filename.string() + '"');
+    }
+}
+
+TiledImageFileReader::~TiledImageFileReader() {
+    cache_.forget(cache_owner_);
+}
+
+const TiledImageFileHeader& TiledImageFileReader::header() const {
+    return header_;
+}
+
+size_t TiledImageFileReader::nchannels() const {
+    return header_.nchannels;
+}
+
+size_t TiledImageFileReader::height() const {
+    return header_.height;
+}
+
+size_t TiledImageFileReader::width() const {
+    return header_.width;
+}
+
+Array<float> TiledImageFileReader::load_tile(size_t tile_row, size_t tile_col) const {
+    size_t ts = header_.tile_size;
+    Array<float> tile{ ArrayShape{ header_.nchannels, ts, ts } };
+    auto offset = header_.tile_offset(tile_row, tile_col);
+    {
+        // The stream is shared, so only the seek and the read are locked.
+        std::scoped_lock lock{ mutex_ };
+        istr_->seekg(integral_cast<std::streamoff>(offset));
+        istr_->read((char*)tile.flat_begin(), integral_cast<std::streamsize>(tile.nbytes()));
+        if (istr_->fail()) {
+            throw std::runtime_error("Could not read tile from \"" + filename_.string() + '"');
+        }
+    }
+    // Tiles at the right and bottom border are cropped to the image,
+    // s.t. the cache does not hold their padding.
+    size_t nrows = std::min(ts, header_.height - tile_row * ts);
+    size_t ncols = std::min(ts, header_.width - tile_col * ts);
+    if ((nrows != ts) || (ncols != ts)) {
+        return tile.cropped(ArrayShape{ 0, 0, 0 }, ArrayShape{ header_.nchannels, nrows, ncols }).copy();
+    }
+    return tile;
+}
+
+Array<float> TiledImageFileReader::read(const PixelRegion& region) const {
+    if ((region.row + region.nrows > header_.height) ||
+        (region.col + region.ncols > header_.width))
+    {
+        throw std::runtime_error("Region out of bounds in \"" + filename_.string() + '"');
+    }
+    Array<float> result{ ArrayShape{ header_.nchannels, region.nrows, region.ncols } };
+    if ((region.nrows == 0) || (region.ncols == 0)) {
+        return result;
+    }
+    size_t ts = header_.tile_size;
+    for (size_t tr = region.row / ts; tr <= (region.row + region.nrows - 1) / ts; ++tr) {
+        for (size_t tc = region.col / ts; tc <= (region.col + region.ncols - 1) / ts; ++tc) {
+            auto tile = cache_.get(cache_owner_, tr, tc, [&](){ return load_tile(tr, tc); });
+            size_t r0 = std::max(region.row, tr * ts);
+            size_t r1 = std::min(region.row + region.nrows, (tr + 1) * ts);
+            size_t c0 = std::max(region.col, tc * ts);
+            size_t c1 = std::min(region.col + region.ncols, (tc + 1) * ts);
+            for (size_t h = 0; h < header_.nchannels; ++h) {
+                for (size_t r = r0; r < r1; ++r) {
+                    for (size_t c = c0; c < c1; ++c) {
+                        result(h, r - region.row, c - region.col) = (*tile)(h, r - tr * ts, c - tc * ts);
+                    }
+                }
+            }
+        }
+    }
+    return result;
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <Mlib/Images/Tiles/ITiled_Image.hpp>
+#include <Mlib/Os/Threads/Fast_Mutex.hpp>
+#include <Mlib/Strings/Utf8_Path.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+
+namespace Mlib {
+
+class TileCache;
+
+// Layout of a tiled image file (".mtil"). The tiles are stored in
+// row-major order as "float[channels][tile_size][tile_size]", where the
+// tiles at the right and bottom border are padded with NaN. This allows
+// random access to the tiles without reading the whole file.
+struct TiledImageFileHeader {
+    size_t nchannels;
+    size_t height;
+    size_t width;
+    size_t tile_size;
+    size_t ntiles_y() const;
+    size_t ntiles_x() const;
+    size_t tile_nbytes() const;
+    size_t tile_offset(size_t tile_row, size_t tile_col) const;
+};
+
+class TiledImageFileWriter {
+    TiledImageFileWriter(const TiledImageFileWriter&) = delete;
+    TiledImageFileWriter& operator = (const TiledImageFileWriter&) = delete;
+public:
+    TiledImageFileWriter(
+        const Utf8Path& filename,
+        size_t nchannels,
+        size_t height,
+        size_t width,
+        size_t tile_size);
+    ~TiledImageFileWriter();
+    const TiledImageFileHeader& header() const;
+    // Thread-safe. "tile" has the shape of the tile inside the image.
+    void write_tile(size_t tile_row, size_t tile_col, const Array<float>& tile);
+    void flush();
+private:
+    Utf8Path filename_;
+    TiledImageFileHeader header_;
+    std::unique_ptr<std::ostream> ostr_;
+    FastMutex mutex_;
+};
+
+class TiledImageFileReader: public ITiledImage {
+    TiledImageFileReader(const TiledImageFileReader&) = delete;
+    TiledImageFileReader& operator = (const TiledImageFileReader&) = delete;
+public:
+    TiledImageFileReader(const Utf8Path& filename, TileCache& cache);
+    virtual ~TiledImageFileReader() override;
+    const TiledImageFileHeader& header() const;
+    virtual size_t nchannels() const override;
+    virtual size_t height() const override;
+    virtual size_t width() const override;
+    virtual Array<float> read(const PixelRegion& region) const override;
+private:
+    Array<float> load_tile(size_t tile_row, size_t tile_col) const;
+    Utf8Path filename_;
+    TiledImageFileHeader header_;
+    std::unique_ptr<std::istream> istr_;
+    TileCache& cache_;
+    uint64_t cache_owner_;
+    mutable FastMutex mutex_;
+};
+
+}
@@ -0,0 +1,336 @@
+#include "Tiled_Operations.hpp"
+#include <Mlib/Images/Filters/Gaussian_Filter.hpp>
+#include <Mlib/Images/Tiles/Read_Extended.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+using namespace Mlib;
+
+static void check_region(const ITiledImage& image, const PixelRegion& region) {
+    if ((region.row + region.nrows > image.height()) ||
+        (region.col + region.ncols > image.width()))
+    {
+        throw std::runtime_error("Tiled image region out of bounds");
+    }
+}
+
+template <class TData>
+ArrayTiledImage<TData>::ArrayTiledImage(const Array<TData>& array, float scale)
+    : array_(array)
+    , scale_{ scale }
+{
+    if (array.ndim() != 3) {
+        throw std::runtime_error("Tiled image array does not have 3 dimensions");
+    }
+}
+
+template <class TData>
+size_t ArrayTiledImage<TData>::nchannels() const {
+    return array_.shape(0);
+}
+
+template <class TData>
+size_t ArrayTiledImage<TData>::height() const {
+    return array_.shape(1);
+}
+
+template <class TData>
+size_t ArrayTiledImage<TData>::width() const {
+    return array_.shape(2);
+}
+
+template <class TData>
+Array<float> ArrayTiledImage<TData>::read(const PixelRegion& region) const {
+    check_region(*this, region);
+    Array<float> result{ ArrayShape{ array_.shape(0), region.nrows, region.ncols } };
+    for (size_t h = 0; h < array_.shape(0); ++h) {
+        for (size_t r = 0; r < region.nrows; ++r) {
+            for (size_t c = 0; c < region.ncols; ++c) {
+                result(h, r, c) = (float)array_(h, region.row + r, region.col + c) * scale_;
+            }
+        }
+    }
+    return result;
+}
+
+CroppedTiledImage::CroppedTiledImage(const ITiledImage& source, const PixelRegion& region)
+    : source_{ source }
+    , region_{ region }
+{
+    check_region(source, region);
+}
+
+size_t CroppedTiledImage::nchannels() const {
+    return source_.nchannels();
+}
+
+size_t CroppedTiledImage::height() const {
+    return region_.nrows;
+}
+
+size_t CroppedTiledImage::width() const {
+    return region_.ncols;
+}
+
+Array<float> CroppedTiledImage::read(const PixelRegion& region) const {
+    check_region(*this, region);
+    return source_.read({
+        region_.row + region.row,
+        region_.col + region.col,
+        region.nrows,
+        region.ncols });
+}
+
+MappedTiledImage::MappedTiledImage(const ITiledImage& source, size_t nchannels, Operation op)
+    : source_{ source }
+    , nchannels_{ nchannels }
+    , op_{ std::move(op) }
+{}
+
+size_t MappedTiledImage::nchannels() const {
+    return nchannels_;
+}
+
+size_t MappedTiledImage::height() const {
+    return source_.height();
+}
+
+size_t MappedTiledImage::width() const {
+    return source_.width();
+}
+
+Array<float> MappedTiledImage::read(const PixelRegion& region) const {
+    auto result = op_(source_.read(region));
+    if ((result.ndim() != 3) ||
+        (result.shape(0) != nchannels_) ||
+        (result.shape(1) != region.nrows) ||
+        (result.shape(2) != region.ncols))
+    {
+        throw std::runtime_error("Colour operation returned unexpected shape");
+    }
+    return result;
+}
+
+GaussianFilteredTiledImage::GaussianFilteredTiledImage(
+    const ITiledImage& source,
+    const FixedArray<float, 2>& sigma,
+    FilterExtension fc,
+    float truncate)
+    : source_{ source }
+    , sigma_{ sigma }
+    , fc_{ fc }
+    , truncate_{ truncate }
+{}
+
+size_t GaussianFilteredTiledImage::nchannels() const {
+    return source_.nchannels();
+}
+
+size_t GaussianFilteredTiledImage::height() const {
+    return source_.height();
+}
+
+size_t GaussianFilteredTiledImage::width() const {
+    return source_.width();
+}
+
+Array<float> GaussianFilteredTiledImage::read(const PixelRegion& region) const {
+    check_region(*this, region);
+    auto my = (size_t)std::ceil(truncate_ * sigma_(0));
+    auto mx = (size_t)std::ceil(truncate_ * sigma_(1));
+    auto block = read_extended(
+        source_,
+        (ptrdiff_t)region.row - (ptrdiff_t)my,
+        (ptrdiff_t)region.col - (ptrdiff_t)mx,
+        region.nrows + 2 * my,
+        region.ncols + 2 * mx,
+        fc_);
+    Array<float> buffers[2];
+    gaussian_filter_1d_NWE(block, buffers[0], sigma_(0), 1, float{ NAN }, truncate_, fc_);
+    gaussian_filter_1d_NWE(buffers[0], buffers[1], sigma_(1), 2, float{ NAN }, truncate_, fc_);
+    return buffers[1].cropped(
+        ArrayShape{ 0, my, mx },
+        ArrayShape{ block.shape(0), my + region.nrows, mx + region.ncols }).copy();
+}
+
+ResampledTiledImage::ResampledTiledImage(
+    const ITiledImage& source,
+    size_t height,
+    size_t width,
+    const FixedArray<double, 2>& offset,
+    const FixedArray<double, 2>& step,
+    FilterExtension fc,
+    float sigma)
+    : source_{ source }
+    , height_{ height }
+    , width_{ width }
+    , offset_{ offset }
+    , step_{ step }
+    , fc_{ fc }
+    , sigma_{ sigma }
+{
+    if (any(step < 0.)) {
+        throw std::runtime_error("Resampling step must be non-negative");
+    }
+    if ((sigma != 0.f) && !(sigma >= 0.5f)) {
+        throw std::runtime_error("Resampling sigma must be 0 or at least 0.5");
+    }
+}
+
+size_t ResampledTiledImage::nchannels() const {
+    return source_.nchannels();
+}
+
+size_t ResampledTiledImage::height() const {
+    return height_;
+}
+
+size_t ResampledTiledImage::width() const {
+    return width_;
+}
+
+namespace {
+
+// Source pixels of one output coordinate, relative to the source block.
+struct SampleIndex {
+    size_t i0;
+    size_t i1;
+    float alpha;
+    bool valid;
+};
+
+}
+
+static std::vector<SampleIndex> sample_indices(
+    double offset,
+    double step,
+    size_t begin,
+    size_t length,
+    size_t n,
+    bool periodic,
+    ptrdiff_t& block_begin,
+    size_t& block_length)
+{
+    auto nf = (double)n;
+    std::vector<double> x(length);
+    double xmin = INFINITY;
+    double xmax = -INFINITY;
+    for (size_t i = 0; i < length; ++i) {
+        x[i] = offset + step * (double)(begin + i);
+        if (!periodic) {
+            x[i] = ((x[i] < -0.5) || (x[i] > nf - 0.5))
+                ? NAN
+                : std::clamp(x[i], 0., nf - 1.);
+        }
+        if (!std::isnan(x[i])) {
+            xmin = std::min(xmin, x[i]);
+            xmax = std::max(xmax, x[i]);
+        }
+    }
+    std::vector<SampleIndex> result(length);
+    if (xmin > xmax) {
+        block_begin = 0;
+        block_length = 0;
+        for (auto& r : result) {
+            r.valid = false;
+        }
+        return result;
+    }
+    block_begin = (ptrdiff_t)std::floor(xmin);
+    block_length = (size_t)((ptrdiff_t)std::floor(xmax) + 2 - block_begin);
+    for (size_t i = 0; i < length; ++i) {
+        if (std::isnan(x[i])) {
+            result[i].valid = false;
+            continue;
+        }
+        auto f = std::floor(x[i]);
+        auto j = (size_t)((ptrdiff_t)f - block_begin);
+        result[i].alpha = (float)(x[i] - f);
+        result[i].i0 = j;
+        // The last source pixel has no right neighbor.
+        result[i].i1 = (result[i].alpha == 0.f) ? j : j + 1;
+        result[i].valid = true;
+    }
+    return result;
+}
+
+Array<float> ResampledTiledImage::read(const PixelRegion& region) const {
+    check_region(*this, region);
+    bool periodic = any(fc_ & FilterExtension::PERIODIC);
+    ptrdiff_t r0;
+    ptrdiff_t c0;
+    size_t nr;
+    size_t nc;
+    auto ri = sample_indices(offset_(0), step_(0), region.row, region.nrows, source_.height(), periodic, r0, nr);
+    auto ci = sample_indices(offset_(1), step_(1), region.col, region.ncols, source_.width(), periodic, c0, nc);
+    Array<float> result = full(ArrayShape{ source_.nchannels(), region.nrows, region.ncols }, NAN);
+    if ((nr == 0) || (nc == 0)) {
+        return result;
+    }
+    FixedArray<float, 2> sigma{
+        step_(0) > 1. ? sigma_ * (float)step_(0) : 0.f,
+        step_(1) > 1. ? sigma_ * (float)step_(1) : 0.f };
+    Array<float> block;
+    if (all(sigma == 0.f)) {
+        block.move() = read_extended(source_, r0, c0, nr, nc, fc_);
+    } else {
+        GaussianFilteredTiledImage filtered{ source_, sigma, fc_ };
+        block.move() = read_extended(filtered, r0, c0, nr, nc, fc_);
+    }
+    for (size_t h = 0; h < block.shape(0); ++h) {
+        for (size_t r = 0; r < region.nrows; ++r) {
+            if (!ri[r].valid) {
+                continue;
+            }
+            for (size_t c = 0; c < region.ncols; ++c) {
+                if (!ci[c].valid) {
+                    continue;
+                }
+                float a = ri[r].alpha;
+                float b = ci[c].alpha;
+                float v00 = block(h, ri[r].i0, ci[c].i0);
+                float v01 = block(h, ri[r].i0, ci[c].i1);
+                float v10 = block(h, ri[r].i1, ci[c].i0);
+                float v11 = block(h, ri[r].i1, ci[c].i1);
+                result(h, r, c) =
+                    (1 - a) * ((1 - b) * v00 + b * v01) +
+                    a * ((1 - b) * v10 + b * v11);
+            }
+        }
+    }
+    return result;
+}
+
+ResampledTiledImage Mlib::resized_tiled_image(
+    const ITiledImage& source,
+    size_t height,
+    size_t width,
+    FilterExtension fc,
+    float sigma)
+{
+    if ((height == 0) || (width == 0)) {
+        throw std::runtime_error("Resized tiled image must not be empty");
+    }
+    FixedArray<double, 2> step{
+        (double)source.height() / (double)height,
+        (double)source.width() / (double)width };
+    return ResampledTiledImage{
+        source,
+        height,
+        width,
+        0.5 * step - 0.5,
+        step,
+        fc,
+        sigma };
+}
+
+namespace Mlib {
+
+template class ArrayTiledImage<float>;
+template class ArrayTiledImage<uint8_t>;
+template class ArrayTiledImage<uint16_t>;
+
+}
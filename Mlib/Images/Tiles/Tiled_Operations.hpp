@@ -0,0 +1,115 @@
+#pragma once
+#include <Mlib/Array/Array.hpp>
+#include <Mlib/Array/Fixed_Array.hpp>
+#include <Mlib/Images/Filters/Lowpass_Filter_Extension.hpp>
+#include <Mlib/Images/Tiles/ITiled_Image.hpp>
+#include <cstddef>
+#include <functional>
+
+namespace Mlib {
+
+// Wraps an in-memory array with shape "[channels, height, width]",
+// converting the pixels to float and multiplying them with "scale".
+template <class TData>
+class ArrayTiledImage: public ITiledImage {
+public:
+    explicit ArrayTiledImage(const Array<TData>& array, float scale = 1.f);
+    virtual size_t nchannels() const override;
+    virtual size_t height() const override;
+    virtual size_t width() const override;
+    virtual Array<float> read(const PixelRegion& region) const override;
+private:
+    Array<TData> array_;
+    float scale_;
+};
+
+class CroppedTiledImage: public ITiledImage {
+public:
+    CroppedTiledImage(const ITiledImage& source, const PixelRegion& region);
+    virtual size_t nchannels() const override;
+    virtual size_t height() const override;
+    virtual size_t width() const override;
+    virtual Array<float> read(const PixelRegion& region) const override;
+private:
+    const ITiledImage& source_;
+    PixelRegion region_;
+};
+
+// Per-pixel colour operation. "op" receives and returns blocks with shape
+// "[channels, nrows, ncols]", and may change the number of channels.
+class MappedTiledImage: public ITiledImage {
+public:
+    using Operation = std::function<Array<float>(const Array<float>&)>;
+    MappedTiledImage(const ITiledImage& source, size_t nchannels, Operation op);
+    virtual size_t nchannels() const override;
+    virtual size_t height() const override;
+    virtual size_t width() const override;
+    virtual Array<float> read(const PixelRegion& region) const override;
+private:
+    const ITiledImage& source_;
+    size_t nchannels_;
+    Operation op_;
+};
+
+// Gaussian filter with NaN-weight normalization, like
+// "multichannel_gaussian_filter_NWE", but with one sigma per axis.
+// Every region is read with a margin of "truncate * sigma" pixels.
+class GaussianFilteredTiledImage: public ITiledImage {
+public:
+    GaussianFilteredTiledImage(
+        const ITiledImage& source,
+        const FixedArray<float, 2>& sigma,
+        FilterExtension fc = FilterExtension::NWE,
+        float truncate = 4.f);
+    virtual size_t nchannels() const override;
+    virtual size_t height() const override;
+    virtual size_t width() const override;
+    virtual Array<float> read(const PixelRegion& region) const override;
+private:
+    const ITiledImage& source_;
+    FixedArray<float, 2> sigma_;
+    FilterExtension fc_;
+    float truncate_;
+};
+
+// Bilinear resampling, where the pixel "(r, c)" of the result is taken
+// from the source coordinates "offset + (r, c) * step". Coordinates more
+// than half a pixel outside of the source yield NaN, unless "fc" contains
+// "PERIODIC". Axes with "step > 1" are smoothed with "sigma * step"
+// before sampling. Bilinear sampling does not average over the step, so
+// "sigma" must be at least 0.5 to suppress aliasing. "0" disables the
+// prefilter, e.g. for interpolating without downsampling.
+class ResampledTiledImage: public ITiledImage {
+public:
+    ResampledTiledImage(
+        const ITiledImage& source,
+        size_t height,
+        size_t width,
+        const FixedArray<double, 2>& offset,
+        const FixedArray<double, 2>& step,
+        FilterExtension fc = FilterExtension::NWE,
+        float sigma = 0.5f);
+    virtual size_t nchannels() const override;
+    virtual size_t height() const override;
+    virtual size_t width() const override;
+    virtual Array<float> read(const PixelRegion& region) const override;
+private:
+    const ITiledImage& source_;
+    size_t height_;
+    size_t width_;
+    FixedArray<double, 2> offset_;
+    FixedArray<double, 2> step_;
+    FilterExtension fc_;
+    float sigma_;
+};
+
+// Resampling of the whole source to "height x width" pixels,
+// aligning the pixel centers like "stbir_resize_float_linear".
+ResampledTiledImage resized_tiled_image(
+    const ITiledImage& source,
+    size_t height,
+    size_t width,
+    FilterExtension fc = FilterExtension::NWE,
+    float sigma = 0.5f);
+
+}
@@ -29,19 +29,15 @@ Array<float> Mlib::resized_multichannel(
     if (any(xtarget_shape == 0)) {
         return zeros<float>(ArrayShape{1}.concatenated(xtarget_shape));
     }
-     Array<float> smoothed;
+    // All channels are smoothed together, axis by axis.
+    Array<float> smoothed = source;
     if (sigma != 0.f) {
-        smoothed = source.copy();
-        for (size_t h = 0; h < source.shape(0); ++h) {
-            for (size_t d = 0; d < xtarget_shape.ndim(); ++d) {
-                float fac = integral_to_float<float>(source.shape(1u + d)) / integral_to_float<float>(xtarget_shape(d));
-                if (fac > 1) {
-                    smoothed[h] = gaussian_filter_1d_NWE(smoothed[h], sigma * fac, d, NAN, 2.f, fc);
-                }
+        for (size_t d = 0; d < xtarget_shape.ndim(); ++d) {
+            float fac = integral_to_float<float>(source.shape(1u + d)) / integral_to_float<float>(xtarget_shape(d));
+            if (fac > 1) {
+                smoothed.move() = gaussian_filter_1d_NWE(smoothed, sigma * fac, 1u + d, float{ NAN }, 2.f, fc);
             }
         }
-    } else {
-        smoothed = source;
     }
     auto stb_smoothed = StbInfo<float>{
         integral_cast<int>(source.shape(2)),
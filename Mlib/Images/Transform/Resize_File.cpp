@@ -1,4 +1,5 @@
 #include "Resize_File.hpp"
+#include <Mlib/Images/Get_Target_Shape.hpp>
 #include <Mlib/Images/Normalize.hpp>
 #include <Mlib/Images/Pgm_Image.hpp>
 #include <Mlib/Images/StbImage1.hpp>
@@ -6,10 +7,19 @@
 #include <Mlib/Images/StbImage2.hpp>
 #include <Mlib/Images/StbImage3.hpp>
 #include <Mlib/Images/StbImage4.hpp>
+#include <Mlib/Images/Tiles/Process_Tiles.hpp>
+#include <Mlib/Images/Tiles/Tile_Cache.hpp>
+#include <Mlib/Images/Tiles/Tiled_Image_File.hpp>
+#include <Mlib/Images/Tiles/Tiled_Operations.hpp>
 #include <Mlib/Images/Transform/Resize.hpp>
 #include <stb_cpp/stb_array.hpp>
 #include <stb_cpp/stb_image_load.hpp>
 
+using namespace Mlib;
+
+static const size_t RESIZE_TILE_SIZE = 256;
+static const size_t RESIZE_TILE_CACHE_NBYTES = 256 * 1024 * 1024;
+
 void Mlib::resize_file(
     const Utf8Path& source,
     const Utf8Path& dest,
@@ -18,31 +28,76 @@ void Mlib::resize_file(
     TargetShapeMode target_shape_mode,
     int jpg_quality)
 {
+    if (source.extension() == ".mtil") {
+        // Tiled sources are resized lazily, tile by tile, s.t. they
+        // never have to fit into memory.
+        TileCache cache{ RESIZE_TILE_CACHE_NBYTES };
+        TiledImageFileReader reader{ source, cache };
+        auto resized = resized_tiled_image(
+            reader,
+            get_target_shape(reader.height(), target_size(1), target_shape_mode),
+            get_target_shape(reader.width(), target_size(0), target_shape_mode),
+            filter_extension);
+        if (dest.extension() == ".mtil") {
+            save_tiled_image_file(resized, dest, RESIZE_TILE_SIZE);
+            return;
+        }
+        auto result = evaluate_tiled_image(resized, RESIZE_TILE_SIZE);
+        clip(result, 0.f, 1.f);
+        switch (result.shape(0)) {
+        case 1:
+            StbImage1::from_float_grayscale(result[0]).save_to_file(dest, jpg_quality);
+            break;
+        case 2:
+            StbImage2::from_float_ia(result).save_to_file(dest, jpg_quality);
+            break;
+        case 3:
+            StbImage3::from_float_rgb(result).save_to_file(dest, jpg_quality);
+            break;
+        case 4:
+            StbImage4::from_float_rgba(result).save_to_file(dest, jpg_quality);
+            break;
+        default:
+            throw std::runtime_error("Unsupported number of channels: \"" + source.string() + '"');
+        }
+        return;
+    }
+    // Other sources are decoded in one piece anyway,
+    // so they are resized in memory by stb.
     auto atarget_shape = ArrayShape{target_size(1), target_size(0)};
+    auto resized = [&](const Array<float>& array){
+        if (array.shape(0) == 1) {
+            auto result = resized_singlechannel(array[0], atarget_shape, target_shape_mode, filter_extension);
+            return result.reshaped(ArrayShape{1}.concatenated(result.shape()));
+        } else {
+            return resized_multichannel(array, atarget_shape, target_shape_mode, filter_extension);
+        }
+    };
+    auto save_tiled = [&](const Array<float>& resized){
+        save_tiled_image_file(ArrayTiledImage<float>{ resized }, dest, RESIZE_TILE_SIZE);
+    };
     auto save_8 = [&](const Array<uint8_t>& array){
         if (array.ndim() != 3) {
             throw std::runtime_error("Unexpected array dimensionality");
         }
-        auto resized = [&](){
-            if (array.shape(0) == 1) {
-                return resized_singlechannel(array[0].casted<float>() / 255.f, atarget_shape, target_shape_mode, filter_extension);
-            } else {
-                return resized_multichannel(array.casted<float>() / 255.f, atarget_shape, target_shape_mode, filter_extension);
-            }
-        }();
-        clip(resized, 0.f, 1.f);
+        auto result = resized(array.casted<float>() / 255.f);
+        if (dest.extension() == ".mtil") {
+            save_tiled(result);
+            return;
+        }
+        clip(result, 0.f, 1.f);
         switch (array.shape(0)) {
         case 1:
-            StbImage1::from_float_grayscale(resized).save_to_file(dest, jpg_quality);
+            StbImage1::from_float_grayscale(result[0]).save_to_file(dest, jpg_quality);
             break;
         case 2:
-            StbImage2::from_float_ia(resized).save_to_file(dest, jpg_quality);
+            StbImage2::from_float_ia(result).save_to_file(dest, jpg_quality);
             break;
         case 3:
-            StbImage3::from_float_rgb(resized).save_to_file(dest, jpg_quality);
+            StbImage3::from_float_rgb(result).save_to_file(dest, jpg_quality);
             break;
         case 4:
-            StbImage4::from_float_rgba(resized).save_to_file(dest, jpg_quality);
+            StbImage4::from_float_rgba(result).save_to_file(dest, jpg_quality);
             break;
         default:
             throw std::runtime_error("Unsupported number of channels: \"" + source.string() + '"');
@@ -52,17 +107,15 @@ void Mlib::resize_file(
         if (array.ndim() != 3) {
             throw std::runtime_error("Unexpected array dimensionality");
         }
-        auto resized = [&](){
-            if (array.shape(0) == 1) {
-                return resized_singlechannel(array[0].casted<float>() / 65535.f, atarget_shape, target_shape_mode, filter_extension);
-            } else {
-                return resized_multichannel(array.casted<float>() / 65535.f, atarget_shape, target_shape_mode, filter_extension);
-            }
-        }();
-        clip(resized, 0.f, 1.f);
+        auto result = resized(array.casted<float>() / 65535.f);
+        if (dest.extension() == ".mtil") {
+            save_tiled(result);
+            return;
+        }
+        clip(result, 0.f, 1.f);
         switch (array.shape(0)) {
         case 1:
-            StbImage1_16::from_float_grayscale(resized).save_to_file(dest);
+            StbImage1_16::from_float_grayscale(result[0]).save_to_file(dest);
             break;
         default:
             throw std::runtime_error("Unsupported number of channels: \"" + source.string() + '"');
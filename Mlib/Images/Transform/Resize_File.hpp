@@ -9,6 +9,9 @@ class FixedArray;
 enum class FilterExtension;
 enum class TargetShapeMode;
 
+// Sources with the extension ".mtil" are resampled tile by tile within
+// the budget of a "TileCache". Other sources are decoded by stb in one
+// piece. The destination may be a ".mtil" file in either case.
 void resize_file(
     const Utf8Path& source,
     const Utf8Path& dest,
@@ -0,0 +1,11 @@
+#pragma once
+#include <Mlib/Hashing/Variable_And_Hash.hpp>
+#include <Mlib/Map/Rcu_Unordered_Map.hpp>
+#include <string>
+
+namespace Mlib {
+
+template <class TValue>
+using RcuStringWithHashUnorderedMap = RcuUnorderedMap<VariableAndHash<std::string>, TValue>;
+
+}
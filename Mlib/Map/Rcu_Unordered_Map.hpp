@@ -0,0 +1,296 @@
+#pragma once
+#include <Mlib/Os/Threads/Epoch_Reclamation.hpp>
+#include <Mlib/Os/Threads/Fast_Mutex.hpp>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Mlib {
+
+// Read-copy-update map for data that is written at load time and
+// read every frame from many threads.
+// Readers look up the published table without taking a lock.
+// Writers are serialized. An insertion publishes the new node with a
+// single atomic store. Growing, erasing and clearing build a new table,
+// publish it, and delete the old table and the removed nodes once no
+// reader can see them anymore (see "EpochDomain").
+// The values are stored in the nodes, s.t. references returned by
+// "get" and "try_get" stay valid until the element is erased or
+// reassigned.
+template <class TKey, class TValue, class THash = std::hash<TKey>>
+class RcuUnorderedMap {
+    RcuUnorderedMap(const RcuUnorderedMap&) = delete;
+    RcuUnorderedMap& operator = (const RcuUnorderedMap&) = delete;
+    struct Node {
+        template <class... Args>
+        Node(size_t hash, const TKey& key, Args&&... args)
+            : hash{ hash }
+            , key{ key }
+            , value(std::forward<Args>(args)...)
+        {}
+        size_t hash;
+        TKey key;
+        TValue value;
+    };
+    // Open addressing with linear probing. Slots are never cleared,
+    // nodes are only removed by publishing a new table.
+    struct Table {
+        explicit Table(size_t capacity)
+            : mask{ capacity - 1 }
+            , slots{ new std::atomic<Node*>[capacity] }
+        {
+            for (size_t i = 0; i < capacity; ++i) {
+                slots[i].store(nullptr, std::memory_order_relaxed);
+            }
+        }
+        inline size_t capacity() const {
+            return mask + 1;
+        }
+        // Returns the node of the key, or null. Readers must use this
+        // function instead of loading the slot returned by "find" again,
+        // because a concurrent insertion can fill an empty slot with a
+        // different key.
+        Node* lookup(size_t hash, const TKey& key) const {
+            for (size_t i = hash & mask;; i = (i + 1) & mask) {
+                auto* n = slots[i].load(std::memory_order_acquire);
+                if ((n == nullptr) || ((n->hash == hash) && (n->key == key))) {
+                    return n;
+                }
+            }
+        }
+        // Returns the slot of the key, or the empty slot to insert it into.
+        // Only used by writers.
+        std::atomic<Node*>& find(size_t hash, const TKey& key) const {
+            for (size_t i = hash & mask;; i = (i + 1) & mask) {
+                auto& s = slots[i];
+                auto* n = s.load(std::memory_order_acquire);
+                if ((n == nullptr) || ((n->hash == hash) && (n->key == key))) {
+                    return s;
+                }
+            }
+        }
+        size_t mask;
+        std::unique_ptr<std::atomic<Node*>[]> slots;
+    };
+    struct Retired {
+        uint64_t epoch;
+        std::unique_ptr<Table> table;
+        std::vector<Node*> nodes;
+    };
+public:
+    using key_type = TKey;
+    using mapped_type = TValue;
+
+    RcuUnorderedMap(
+        std::string value_name,
+        std::function<std::string(const key_type& e)> key_to_string)
+        : table_{ new Table{ 16 } }
+        , size_{ 0 }
+        , value_name_{ std::move(value_name) }
+        , key_to_string_{ std::move(key_to_string) }
+    {}
+
+    explicit RcuUnorderedMap(std::string value_name)
+        requires requires (const key_type& k) { std::string{ *k }; }
+        : RcuUnorderedMap{ std::move(value_name), [](const key_type& k){ return std::string{ *k }; } }
+    {}
+
+    // No reader may access the map during destruction.
+    ~RcuUnorderedMap() {
+        std::unique_ptr<Table> t{ table_.load(std::memory_order_relaxed) };
+        for (auto* n : nodes(*t)) {
+            delete n;
+        }
+        for (const auto& r : retired_) {
+            for (auto* n : r.nodes) {
+                delete n;
+            }
+        }
+    }
+
+    template <class... Args>
+    mapped_type& add(const key_type& key, Args &&...args) {
+        auto res = try_emplace(key, std::forward<Args>(args)...);
+        if (!res.second) {
+            throw std::runtime_error(value_name_ + " with name \"" + key_to_string_(key) + "\" already exists");
+        }
+        return *res.first;
+    }
+
+    // Returns the element and whether it was inserted.
+    template <class... Args>
+    std::pair<mapped_type*, bool> try_emplace(const key_type& key, Args &&...args) {
+        std::scoped_lock lock{ write_mutex_ };
+        auto hash = THash{}(key);
+        if (auto* n = table_.load(std::memory_order_relaxed)->find(hash, key).load(std::memory_order_relaxed);
+            n != nullptr)
+        {
+            return { &n->value, false };
+        }
+        auto* n = new Node{ hash, key, std::forward<Args>(args)... };
+        insert_unsafe(n);
+        return { &n->value, true };
+    }
+
+    void insert_or_assign(const key_type& key, const mapped_type& value) {
+        std::scoped_lock lock{ write_mutex_ };
+        auto hash = THash{}(key);
+        auto& s = table_.load(std::memory_order_relaxed)->find(hash, key);
+        auto* old = s.load(std::memory_order_relaxed);
+        if (old == nullptr) {
+            insert_unsafe(new Node{ hash, key, value });
+            return;
+        }
+        s.store(new Node{ hash, key, value }, std::memory_order_release);
+        retire(nullptr, { old });
+    }
+
+    size_t erase(const key_type& key) {
+        std::scoped_lock lock{ write_mutex_ };
+        auto* t = table_.load(std::memory_order_relaxed);
+        auto* old = t->find(THash{}(key), key).load(std::memory_order_relaxed);
+        if (old == nullptr) {
+            return 0;
+        }
+        rebuild(t->capacity(), old);
+        size_.fetch_sub(1, std::memory_order_relaxed);
+        retire(nullptr, { old });
+        return 1;
+    }
+
+    void clear() {
+        std::scoped_lock lock{ write_mutex_ };
+        auto* old = table_.exchange(new Table{ 16 }, std::memory_order_seq_cst);
+        size_.store(0, std::memory_order_relaxed);
+        auto n = nodes(*old);
+        retire(std::unique_ptr<Table>{ old }, std::move(n));
+    }
+
+    // Deletes the tables and nodes that are no longer visible to any
+    // reader. Also called by every write that removes memory.
+    void reclaim() {
+        std::scoped_lock lock{ write_mutex_ };
+        reclaim_unsafe();
+    }
+
+    bool contains(const key_type& key) const {
+        return try_get(key) != nullptr;
+    }
+
+    const mapped_type* try_get(const key_type& key) const {
+        EpochGuard guard;
+        auto* t = table_.load(std::memory_order_seq_cst);
+        auto* n = t->lookup(THash{}(key), key);
+        if (n == nullptr) {
+            return nullptr;
+        }
+        return &n->value;
+    }
+
+    mapped_type* try_get(const key_type& key) {
+        const auto& cthis = *this;
+        return const_cast<mapped_type*>(cthis.try_get(key));
+    }
+
+    const mapped_type& get(const key_type& key) const {
+        auto* res = try_get(key);
+        if (res == nullptr) {
+            throw std::runtime_error(value_name_ + " with name \"" + key_to_string_(key) + "\" does not exist");
+        }
+        return *res;
+    }
+
+    mapped_type& get(const key_type& key) {
+        const auto& cthis = *this;
+        return const_cast<mapped_type&>(cthis.get(key));
+    }
+
+    size_t size() const {
+        return size_.load(std::memory_order_relaxed);
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    // Keys of the published table, in unspecified order.
+    std::vector<key_type> keys() const {
+        EpochGuard guard;
+        std::vector<key_type> result;
+        for (const auto* n : nodes(*table_.load(std::memory_order_seq_cst))) {
+            result.push_back(n->key);
+        }
+        return result;
+    }
+
+private:
+    static std::vector<Node*> nodes(const Table& t) {
+        std::vector<Node*> result;
+        for (size_t i = 0; i < t.capacity(); ++i) {
+            if (auto* n = t.slots[i].load(std::memory_order_acquire); n != nullptr) {
+                result.push_back(n);
+            }
+        }
+        return result;
+    }
+
+    void insert_unsafe(Node* n) {
+        auto* t = table_.load(std::memory_order_relaxed);
+        // Keep the load factor below 1/2.
+        if (2 * (size() + 1) > t->capacity()) {
+            t = rebuild(2 * t->capacity(), nullptr);
+        }
+        t->find(n->hash, n->key).store(n, std::memory_order_release);
+        size_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Publishes a copy of the table without "excluded".
+    Table* rebuild(size_t capacity, const Node* excluded) {
+        auto t = std::make_unique<Table>(capacity);
+        auto* old = table_.load(std::memory_order_relaxed);
+        for (auto* n : nodes(*old)) {
+            if (n != excluded) {
+                t->find(n->hash, n->key).store(n, std::memory_order_relaxed);
+            }
+        }
+        auto* result = t.get();
+        table_.store(t.release(), std::memory_order_seq_cst);
+        retire(std::unique_ptr<Table>{ old }, {});
+        return result;
+    }
+
+    void retire(std::unique_ptr<Table> table, std::vector<Node*> nodes) {
+        retired_.push_back(Retired{
+            .epoch = EpochDomain::instance().retire(),
+            .table = std::move(table),
+            .nodes = std::move(nodes)});
+        reclaim_unsafe();
+    }
+
+    void reclaim_unsafe() {
+        std::erase_if(retired_, [](const Retired& r){
+            if (!EpochDomain::instance().is_safe_to_reclaim(r.epoch)) {
+                return false;
+            }
+            for (auto* n : r.nodes) {
+                delete n;
+            }
+            return true;
+        });
+    }
+
+    std::atomic<Table*> table_;
+    std::atomic_size_t size_;
+    FastMutex write_mutex_;
+    std::vector<Retired> retired_;
+    std::string value_name_;
+    std::function<std::string(const key_type& e)> key_to_string_;
+};
+
+}
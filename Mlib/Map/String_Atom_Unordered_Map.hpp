@@ -0,0 +1,11 @@
+#pragma once
+#include <Mlib/Map/String_With_Hash_Generic_Map.hpp>
+#include <Mlib/Misc/String_Atom.hpp>
+#include <unordered_map>
+
+namespace Mlib {
+
+template <class TValue>
+using StringAtomUnorderedMap = StringWithHashGenericMap<std::unordered_map<StringAtom, TValue>>;
+
+}
@@ -1,53 +1,28 @@
 #include "Dangling_Base_Class.hpp"
-#include <mutex>
 
 using namespace Mlib;
 
 DanglingBaseClass::DanglingBaseClass() = default;
 
 DanglingBaseClass::~DanglingBaseClass() {
+#if MLIB_DANGLING_SOURCE_LOCATIONS
     assert_no_references();
+#endif
+    // Otherwise, the tracker invalidates the remaining references,
+    // which abort when they are dereferenced.
 }
 
 void DanglingBaseClass::print_references() const {
-    lerr() << "Remaining locations: " << locs_.size();
-    for (const auto& [p, l] : locs_) {
-        lerr() << l;
-    }
+    tracker_.print_references();
 }
 
 void DanglingBaseClass::assert_no_references() const {
-    std::shared_lock lock{loc_mutex_};
-    if (!locs_.empty()) {
+    if (tracker_.nreferences() != 0) {
         print_references();
         verbose_abort("Dangling pointers or references remaining");
     }
 }
 
 size_t DanglingBaseClass::nreferences() const {
-    std::shared_lock lock{loc_mutex_};
-    return locs_.size();
-}
-
-void DanglingBaseClass::add_source_location(const void* ptr, SourceLocation loc) {
-    std::scoped_lock lock{loc_mutex_};
-    if (!locs_.try_emplace(ptr, loc).second) {
-        verbose_abort("Could not insert source location");
-    }
-}
-
-void DanglingBaseClass::remove_source_location(const void* ptr) {
-    std::scoped_lock lock{loc_mutex_};
-    if (locs_.erase(ptr) != 1) {
-        verbose_abort("Could not erase source location");
-    }
-}
-
-const SourceLocation& DanglingBaseClass::loc(const void* ptr) const {
-    std::shared_lock lock{loc_mutex_};
-    auto it = locs_.find(ptr);
-    if (it == locs_.end()) {
-        verbose_abort("DanglingBaseClass::loc: Could not find location");
-    }
-    return it->second;
+    return tracker_.nreferences();
 }
@@ -1,5 +1,7 @@
 #pragma once
 #include <Mlib/Hashing/Std_Hash.hpp>
+#include <Mlib/Memory/Dangling_Generation_Tracker.hpp>
+#include <Mlib/Memory/Dangling_Location_Tracker.hpp>
 #include <Mlib/Misc/Object.hpp>
 #include <Mlib/Misc/Source_Location.hpp>
 #include <Mlib/Os/Os.hpp>
@@ -9,8 +11,24 @@
 #include <type_traits>
 #include <unordered_map>
 
+// Debug builds record the source location of every pointer and
+// reference, release builds only store generation handles.
+#ifndef MLIB_DANGLING_SOURCE_LOCATIONS
+#ifdef NDEBUG
+#define MLIB_DANGLING_SOURCE_LOCATIONS 0
+#else
+#define MLIB_DANGLING_SOURCE_LOCATIONS 1
+#endif
+#endif
+
 namespace Mlib {
 
+#if MLIB_DANGLING_SOURCE_LOCATIONS
+using DanglingTracker = DanglingLocationTracker;
+#else
+using DanglingTracker = DanglingGenerationTracker;
+#endif
+
 template <class T>
 class DanglingBaseClassPtr;
 template <class T>
@@ -32,12 +50,7 @@ public:
     // template <class T>
     // DanglingBaseClassRef<T> ref(SourceLocation loc) const { return DanglingBaseClassRef<T>(*const_cast<DanglingBaseClass*>(this), loc); }
 private:
-    void add_source_location(const void* ptr, SourceLocation loc);
-    void remove_source_location(const void* ptr);
-    const SourceLocation& loc(const void* ptr) const;
-
-    std::unordered_map<const void*, SourceLocation> locs_;
-    mutable SafeAtomicSharedMutex loc_mutex_;
+    DanglingTracker tracker_;
 };
 
 struct CopyDanglingClassPtr {};
@@ -99,7 +112,7 @@ public:
     {}
     DanglingBaseClassPtr& operator = (std::nullptr_t) {
         if (v_ != nullptr) {
-            b_->remove_source_location(this);
+            b_->tracker_.remove(r_);
             v_ = nullptr;
         }
         return *this;
@@ -114,18 +127,23 @@ public:
         if (v_ == nullptr) {
             verbose_abort("DanglingBaseClassPtr: Nullptr dereference");
         }
-        return DanglingBaseClassRef<T>(*b_, *v_, b_->loc(this));
+        b_->tracker_.check(r_);
+        return DanglingBaseClassRef<T>(*b_, *v_, b_->tracker_.loc(r_));
     }
     DanglingBaseClassRef<T> operator * () const {
         if (v_ == nullptr) {
             verbose_abort("DanglingBaseClassPtr: Nullptr dereference");
         }
-        return DanglingBaseClassRef<T>(*b_, *v_, b_->loc(this));
+        b_->tracker_.check(r_);
+        return DanglingBaseClassRef<T>(*b_, *v_, b_->tracker_.loc(r_));
     }
     T* operator -> () const {
-        return v_;
+        return get();
     }
     T* get() const {
+        if (v_ != nullptr) {
+            b_->tracker_.check(r_);
+        }
         return v_;
     }
     T* release() {
@@ -159,21 +177,21 @@ public:
         b_->print_references();
     }
     SourceLocation loc() const {
-        return b_->loc(this);
+        return b_->tracker_.loc(r_);
     }
 private:
     DanglingBaseClassPtr(DanglingBaseClass& b, T& v, SourceLocation loc)
         : b_{ &b }
         , v_{ &v }
     {
-        b_->add_source_location(this, loc);
+        b_->tracker_.add(r_, loc);
     }
     DanglingBaseClassPtr(DanglingBaseClass* b, T* v, SourceLocation loc)
         : b_{ b }
         , v_{ v }
     {
         if (v_ != nullptr) {
-            b_->add_source_location(this, loc);
+            b_->tracker_.add(r_, loc);
         }
     }
     template <typename TDerived>
@@ -183,8 +201,7 @@ private:
         , v_{ other.v_ }
     {
         if (v_ != nullptr) {
-            b_->add_source_location(this, b_->loc(&other));
-            b_->remove_source_location(&other);
+            b_->tracker_.move(r_, other.r_);
             other.v_ = nullptr;
         }
     }
@@ -195,7 +212,7 @@ private:
         , v_{ other.v_ }
     {
         if (v_ != nullptr) {
-            b_->add_source_location(this, b_->loc(&other));
+            b_->tracker_.copy(r_, other.r_);
         }
     }
     template <typename TDerived>
@@ -205,17 +222,18 @@ private:
             return *this;
         }
         if (v_ != nullptr) {
-            b_->remove_source_location(this);
+            b_->tracker_.remove(r_);
         }
         b_ = other.b_;
         v_ = other.v_;
         if (v_ != nullptr) {
-            b_->add_source_location(this, b_->loc(&other));
+            b_->tracker_.copy(r_, other.r_);
         }
         return *this;
     }
     DanglingBaseClass* b_;
     T* v_;
+    [[no_unique_address]] DanglingTracker::Reference r_;
 };
 
 template <class T>
@@ -227,20 +245,20 @@ class DanglingBaseClassRef {
     DanglingBaseClassRef& operator = (const DanglingBaseClassRef&) = delete;
 public:
     DanglingBaseClassRef(DanglingBaseClassRef&& other)
-        : DanglingBaseClassRef{ other.b_, other.v_, other.b_.loc(&other) }
+        : DanglingBaseClassRef{ other, CopyDanglingClassPtr() }
     {}
     DanglingBaseClassRef(const DanglingBaseClassRef& other)
-        : DanglingBaseClassRef{ other.b_, other.v_, other.b_.loc(&other) }
+        : DanglingBaseClassRef{ other, CopyDanglingClassPtr() }
     {}
     template <typename TDerived>
         requires std::is_convertible_v<TDerived&, T&>
     DanglingBaseClassRef(DanglingBaseClassRef<TDerived>&& other)
-        : DanglingBaseClassRef{ other.b_, other.v_, other.b_.loc(&other) }
+        : DanglingBaseClassRef{ other, CopyDanglingClassPtr() }
     {}
     template <typename TDerived>
         requires std::is_convertible_v<TDerived&, T&>
     DanglingBaseClassRef(const DanglingBaseClassRef<TDerived>& other)
-        : DanglingBaseClassRef{ other.b_, other.v_, other.b_.loc(&other) }
+        : DanglingBaseClassRef{ other, CopyDanglingClassPtr() }
     {}
     template <class TDerived>
         requires std::is_convertible_v<TDerived&, T&>
@@ -248,35 +266,45 @@ public:
         : DanglingBaseClassRef{ const_cast<std::remove_const_t<TDerived>&>(b), b, loc }
     {}
     ~DanglingBaseClassRef() {
-        b_.remove_source_location(this);
+        b_.tracker_.remove(r_);
     }
     DanglingBaseClassRef set_loc(SourceLocation loc) const {
         return DanglingBaseClassRef{ b_, v_, loc };
     }
     DanglingBaseClassPtr<T> ptr() const {
-        return DanglingBaseClassPtr<T>{ b_, v_, b_.loc(this) };
+        return DanglingBaseClassPtr<T>{ b_, v_, b_.tracker_.loc(r_) };
     }
     T* operator -> () const {
-        return &v_;
+        return &get();
     }
     T& get() const {
+        b_.tracker_.check(r_);
         return v_;
     }
     void print_base_references() const {
         b_.print_references();
     }
     SourceLocation loc() const {
-        return b_.loc(this);
+        return b_.tracker_.loc(r_);
     }
 private:
     explicit DanglingBaseClassRef(DanglingBaseClass& b, T& v, SourceLocation loc)
         : b_{ b }
         , v_{ v }
     {
-        b_.add_source_location(this, loc);
+        b_.tracker_.add(r_, loc);
+    }
+    template <typename TDerived>
+        requires std::is_convertible_v<TDerived&, T&>
+    DanglingBaseClassRef(const DanglingBaseClassRef<TDerived>& other, CopyDanglingClassPtr)
+        : b_{ other.b_ }
+        , v_{ other.v_ }
+    {
+        b_.tracker_.copy(r_, other.r_);
     }
     DanglingBaseClass& b_;
     T& v_;
+    [[no_unique_address]] DanglingTracker::Reference r_;
 };
 
 }
@@ -0,0 +1,90 @@
+#include "Dangling_Generation_Tracker.hpp"
+#include <Mlib/Os/Os.hpp>
+
+using namespace Mlib;
+
+DanglingSlotTable::DanglingSlotTable()
+    : size_{ 0 }
+    , free_{ 0 }
+{
+    for (auto& c : chunks_) {
+        c.store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+DanglingSlotTable::~DanglingSlotTable() = default;
+
+DanglingSlotTable& DanglingSlotTable::instance() {
+    static auto* table = new DanglingSlotTable;
+    return *table;
+}
+
+void DanglingSlotTable::allocate_chunk(uint32_t i) {
+    auto& c = chunks_[i / CHUNK_SIZE];
+    if (c.load(std::memory_order_acquire) != nullptr) {
+        return;
+    }
+    auto* chunk = new Slot[CHUNK_SIZE];
+    for (uint32_t j = 0; j < CHUNK_SIZE; ++j) {
+        chunk[j].state.store(0, std::memory_order_relaxed);
+        chunk[j].next.store(0, std::memory_order_relaxed);
+    }
+    Slot* expected = nullptr;
+    if (!c.compare_exchange_strong(expected, chunk, std::memory_order_acq_rel)) {
+        delete[] chunk;
+    }
+}
+
+uint32_t DanglingSlotTable::acquire() {
+    auto head = free_.load(std::memory_order_acquire);
+    while ((uint32_t)head != 0) {
+        uint32_t i = (uint32_t)head - 1;
+        uint64_t new_head = ((head >> 32) + 1) << 32 | slot(i).next.load(std::memory_order_relaxed);
+        if (free_.compare_exchange_weak(head, new_head, std::memory_order_acq_rel, std::memory_order_acquire)) {
+            return i;
+        }
+    }
+    auto i = size_.fetch_add(1, std::memory_order_relaxed);
+    if (i >= CHUNK_SIZE * NCHUNKS) {
+        verbose_abort("DanglingSlotTable: Too many objects");
+    }
+    allocate_chunk(i);
+    return i;
+}
+
+void DanglingSlotTable::release(uint32_t i) {
+    auto& s = state(i);
+    auto old = s.load(std::memory_order_relaxed);
+    while (!s.compare_exchange_weak(old, ((old >> 32) + 1) << 32, std::memory_order_acq_rel, std::memory_order_relaxed));
+    auto head = free_.load(std::memory_order_relaxed);
+    while (true) {
+        slot(i).next.store((uint32_t)head, std::memory_order_relaxed);
+        uint64_t new_head = ((head >> 32) + 1) << 32 | (i + 1);
+        if (free_.compare_exchange_weak(head, new_head, std::memory_order_release, std::memory_order_relaxed)) {
+            break;
+        }
+    }
+}
+
+DanglingGenerationTracker::DanglingGenerationTracker()
+    : slot_{ DanglingSlotTable::instance().acquire() }
+    , generation_{ DanglingSlotTable::instance().generation(slot_) }
+{}
+
+DanglingGenerationTracker::~DanglingGenerationTracker() {
+    DanglingSlotTable::instance().release(slot_);
+}
+
+const SourceLocation& DanglingGenerationTracker::loc(const Reference& r) {
+    static const SourceLocation unknown = CURRENT_SOURCE_LOCATION;
+    return unknown;
+}
+
+void DanglingGenerationTracker::print_references() const {
+    lerr() << "Remaining references: " << nreferences() <<
+        " (source locations are only recorded in debug builds)";
+}
+
+void DanglingGenerationTracker::abort_dangling() {
+    verbose_abort("Dereferencing a dangling pointer or reference (source locations are only recorded in debug builds)");
+}
@@ -0,0 +1,120 @@
+#pragma once
+#include <Mlib/Misc/Source_Location.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace Mlib {
+
+// Global table of slots. An object owns a slot while it is alive.
+// Every slot stores the object's generation in the upper and the
+// number of references in the lower 32 bits of one atomic word.
+// The generation is incremented when the slot is released, which
+// invalidates all handles to the object, and turns the removal of
+// the remaining handles into no-ops.
+// Free slots form a lock-free stack, and the table is never destroyed,
+// s.t. objects with static storage duration can release their slots
+// during shutdown.
+class DanglingSlotTable {
+    DanglingSlotTable(const DanglingSlotTable&) = delete;
+    DanglingSlotTable& operator = (const DanglingSlotTable&) = delete;
+public:
+    static constexpr uint32_t CHUNK_SIZE = 1 << 12;
+    static constexpr uint32_t NCHUNKS = 1 << 12;
+    static DanglingSlotTable& instance();
+    uint32_t acquire();
+    void release(uint32_t slot);
+    inline uint32_t generation(uint32_t slot) const {
+        return (uint32_t)(state(slot).load(std::memory_order_acquire) >> 32);
+    }
+    inline uint32_t nreferences(uint32_t slot) const {
+        return (uint32_t)state(slot).load(std::memory_order_acquire);
+    }
+    // Returns false if the slot has a different generation.
+    inline bool add_reference(uint32_t slot, uint32_t generation) {
+        auto old = state(slot).fetch_add(1, std::memory_order_relaxed);
+        return (uint32_t)(old >> 32) == generation;
+    }
+    // Does nothing if the slot has a different generation.
+    inline void remove_reference(uint32_t slot, uint32_t generation) {
+        auto& s = state(slot);
+        auto old = s.load(std::memory_order_relaxed);
+        while ((uint32_t)(old >> 32) == generation) {
+            if (s.compare_exchange_weak(old, old - 1, std::memory_order_release, std::memory_order_relaxed)) {
+                return;
+            }
+        }
+    }
+private:
+    struct Slot {
+        std::atomic<uint64_t> state;
+        // Successor in the free list, plus one.
+        std::atomic<uint32_t> next;
+    };
+    DanglingSlotTable();
+    ~DanglingSlotTable();
+    inline Slot& slot(uint32_t i) const {
+        return chunks_[i / CHUNK_SIZE].load(std::memory_order_acquire)[i % CHUNK_SIZE];
+    }
+    inline std::atomic<uint64_t>& state(uint32_t i) const {
+        return slot(i).state;
+    }
+    void allocate_chunk(uint32_t i);
+    std::atomic<Slot*> chunks_[NCHUNKS];
+    std::atomic<uint32_t> size_;
+    // ABA tag in the upper, first free slot plus one in the lower 32 bits.
+    std::atomic<uint64_t> free_;
+};
+
+// Stores the object's (slot, generation) in every pointer and
+// reference, and counts them in the slot table.
+// Copying a reference copies the handle and increments an atomic
+// counter, dereferencing compares the handle's generation with the
+// slot table. Source locations are only recorded by the
+// "DanglingLocationTracker".
+class DanglingGenerationTracker {
+    DanglingGenerationTracker(const DanglingGenerationTracker&) = delete;
+    DanglingGenerationTracker& operator = (const DanglingGenerationTracker&) = delete;
+public:
+    struct Reference {
+        uint32_t slot = 0;
+        uint32_t generation = 0;
+    };
+    DanglingGenerationTracker();
+    ~DanglingGenerationTracker();
+    inline void add(Reference& r, SourceLocation loc) {
+        r.slot = slot_;
+        r.generation = generation_;
+        DanglingSlotTable::instance().add_reference(r.slot, r.generation);
+    }
+    // The tracker might have been destroyed, so the following
+    // functions only access the slot table.
+    static inline void copy(Reference& dst, const Reference& src) {
+        dst = src;
+        if (!DanglingSlotTable::instance().add_reference(dst.slot, dst.generation)) {
+            abort_dangling();
+        }
+    }
+    static inline void move(Reference& dst, Reference& src) {
+        dst = src;
+    }
+    static inline void remove(Reference& r) {
+        DanglingSlotTable::instance().remove_reference(r.slot, r.generation);
+    }
+    static inline void check(const Reference& r) {
+        if (DanglingSlotTable::instance().generation(r.slot) != r.generation) {
+            abort_dangling();
+        }
+    }
+    static const SourceLocation& loc(const Reference& r);
+    inline size_t nreferences() const {
+        return DanglingSlotTable::instance().nreferences(slot_);
+    }
+    void print_references() const;
+private:
+    [[noreturn]] static void abort_dangling();
+    uint32_t slot_;
+    uint32_t generation_;
+};
+
+}
@@ -0,0 +1,69 @@
+#include "Dangling_Location_Tracker.hpp"
+#include <Mlib/Os/Os.hpp>
+#include <mutex>
+#include <shared_mutex>
+
+using namespace Mlib;
+
+DanglingLocationTracker::DanglingLocationTracker() = default;
+
+DanglingLocationTracker::~DanglingLocationTracker() = default;
+
+void DanglingLocationTracker::add(Reference& r, SourceLocation loc) {
+    std::scoped_lock lock{loc_mutex_};
+    if (!locs_.try_emplace(&r, loc).second) {
+        verbose_abort("Could not insert source location");
+    }
+}
+
+void DanglingLocationTracker::copy(Reference& dst, const Reference& src) {
+    std::scoped_lock lock{loc_mutex_};
+    auto it = locs_.find(&src);
+    if (it == locs_.end()) {
+        verbose_abort("DanglingLocationTracker::copy: Could not find location");
+    }
+    if (!locs_.try_emplace(&dst, it->second).second) {
+        verbose_abort("Could not insert source location");
+    }
+}
+
+void DanglingLocationTracker::move(Reference& dst, Reference& src) {
+    std::scoped_lock lock{loc_mutex_};
+    auto node = locs_.extract(&src);
+    if (node.empty()) {
+        verbose_abort("DanglingLocationTracker::move: Could not find location");
+    }
+    node.key() = &dst;
+    if (!locs_.insert(std::move(node)).inserted) {
+        verbose_abort("Could not insert source location");
+    }
+}
+
+void DanglingLocationTracker::remove(Reference& r) {
+    std::scoped_lock lock{loc_mutex_};
+    if (locs_.erase(&r) != 1) {
+        verbose_abort("Could not erase source location");
+    }
+}
+
+const SourceLocation& DanglingLocationTracker::loc(const Reference& r) const {
+    std::shared_lock lock{loc_mutex_};
+    auto it = locs_.find(&r);
+    if (it == locs_.end()) {
+        verbose_abort("DanglingLocationTracker::loc: Could not find location");
+    }
+    return it->second;
+}
+
+size_t DanglingLocationTracker::nreferences() const {
+    std::shared_lock lock{loc_mutex_};
+    return locs_.size();
+}
+
+void DanglingLocationTracker::print_references() const {
+    std::shared_lock lock{loc_mutex_};
+    lerr() << "Remaining locations: " << locs_.size();
+    for (const auto& [p, l] : locs_) {
+        lerr() << l;
+    }
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <Mlib/Misc/Source_Location.hpp>
+#include <Mlib/Os/Threads/Safe_Atomic_Shared_Mutex.hpp>
+#include <cstddef>
+#include <unordered_map>
+
+namespace Mlib {
+
+// Records the source location of every pointer and reference to an
+// object, s.t. remaining references can be printed.
+// Every registration allocates and takes a lock.
+class DanglingLocationTracker {
+    DanglingLocationTracker(const DanglingLocationTracker&) = delete;
+    DanglingLocationTracker& operator = (const DanglingLocationTracker&) = delete;
+public:
+    // Stored in every pointer and reference. Its address is the key.
+    struct Reference {};
+    DanglingLocationTracker();
+    ~DanglingLocationTracker();
+    void add(Reference& r, SourceLocation loc);
+    void copy(Reference& dst, const Reference& src);
+    void move(Reference& dst, Reference& src);
+    void remove(Reference& r);
+    inline void check(const Reference& r) const {}
+    const SourceLocation& loc(const Reference& r) const;
+    size_t nreferences() const;
+    void print_references() const;
+private:
+    std::unordered_map<const void*, SourceLocation> locs_;
+    mutable SafeAtomicSharedMutex loc_mutex_;
+};
+
+}
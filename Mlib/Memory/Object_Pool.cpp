@@ -1,6 +1,7 @@
 #include "Object_Pool.hpp"
-#include <Mlib/Memory/Recursive_Deletion.hpp>
 #include <Mlib/Os/Os.hpp>
+#include <Mlib/Os/Threads/Unlock_Guard.hpp>
+#include <algorithm>
 #include <exception>
 #include <stdexcept>
 
@@ -29,12 +30,12 @@ ObjectPool::~ObjectPool() {
     }
 }
 
-void ObjectPool::add(std::function<void()> deallocate, Object& o, SourceLocation loc) {
+void ObjectPool::add(DeallocateObject deallocate, void* memory, Object& o, SourceLocation loc) {
     std::scoped_lock lock{ mutex_ };
     if (clearing_) {
         verbose_abort("ObjectPool::add called during clearing");
     }
-    if (!ptrs_.emplace(std::move(deallocate), &o, loc).second) {
+    if (!ptrs_.try_emplace(&o, deallocate, memory, &o, loc).second) {
         throw std::runtime_error("Unique pointer already exists");
     }
 }
@@ -55,7 +56,7 @@ bool ObjectPool::contains(Object* o) const {
 
 bool ObjectPool::contains(Object& o) const {
     std::unique_lock lock{ mutex_ };
-    return ptrs_.contains({ nullptr, &o, CURRENT_SOURCE_LOCATION });
+    return ptrs_.contains(&o);
 }
 
 void ObjectPool::remove(Object& o) {
@@ -63,12 +64,12 @@ void ObjectPool::remove(Object& o) {
     if (deleting_ptrs_.contains(&o)) {
         return;
     }
-    auto n = ptrs_.extract({ nullptr, &o, CURRENT_SOURCE_LOCATION });
+    auto n = ptrs_.extract(&o);
     if (n.empty()) {
         verbose_abort("ObjectPool: Could not remove object");
     }
     lock.unlock();
-    delete_(n.value());
+    delete_(n.mapped());
 }
 
 void ObjectPool::remove(Object* o) {
@@ -78,19 +79,20 @@ void ObjectPool::remove(Object* o) {
     remove(*o);
 }
 
-void ObjectPool::extract(Object* o) {
+DeallocateObject ObjectPool::extract(Object* o) {
     if (o == nullptr) {
         verbose_abort("ObjectPool: Attempt to extract nullptr");
     }
-    extract(*o);
+    return extract(*o);
 }
 
-void ObjectPool::extract(Object& o) {
+DeallocateObject ObjectPool::extract(Object& o) {
     std::unique_lock lock{ mutex_ };
-    auto n = ptrs_.extract({ nullptr, &o, CURRENT_SOURCE_LOCATION });
+    auto n = ptrs_.extract(&o);
     if (n.empty()) {
         verbose_abort("ObjectPool: Could not extract object");
     }
+    return n.mapped().deallocate;
 }
 
 void ObjectPool::delete_(const ObjectAndSourceLocation& o) {
@@ -113,7 +115,7 @@ void ObjectPool::delete_(const ObjectAndSourceLocation& o) {
             verbose_abort("Could not erase from deleting_ptrs");
         }
     }
-    o.deallocate();
+    o.deallocate(o.memory);
     if (eptr != nullptr) {
         std::rethrow_exception(eptr);
     }
@@ -125,13 +127,28 @@ void ObjectPool::clear() {
         verbose_abort("ObjectPool already clearing");
     }
     clearing_ = true;
-    clear_set_recursively_with_lock(ptrs_, lock, [this](auto& o) { delete_(o); });
+    // Address order visits the objects slab by slab.
+    clearing_order_.clear();
+    for (const auto& [o, _] : ptrs_) {
+        clearing_order_.push_back(o);
+    }
+    std::sort(clearing_order_.begin(), clearing_order_.end());
+    for (auto* o : clearing_order_) {
+        // Skip objects that were removed by the destructor of another object.
+        auto n = ptrs_.extract(o);
+        if (n.empty()) {
+            continue;
+        }
+        UnlockGuard ulock{ lock };
+        delete_(n.mapped());
+    }
+    clearing_order_.clear();
     clearing_ = false;
 }
 
 void ObjectPool::assert_no_leaks() const {
     if (!ptrs_.empty()) {
-        for (const auto& p : ptrs_) {
+        for (const auto& [_, p] : ptrs_) {
             lerr() << p.loc;
         }
         verbose_abort("Memory leaks detected in ObjctPool");
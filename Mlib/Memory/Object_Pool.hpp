@@ -1,16 +1,17 @@
 #pragma once
 #include <Mlib/Memory/Dangling_Base_Class.hpp>
+#include <Mlib/Memory/Slab_Allocator.hpp>
 #include <Mlib/Misc/Object.hpp>
 #include <Mlib/Misc/Source_Location.hpp>
 #include <Mlib/Os/Os.hpp>
 #include <Mlib/Os/Threads/Fast_Mutex.hpp>
-#include <compare>
 #include <functional>
 #include <memory>
 #include <mutex>
-#include <set>
 #include <type_traits>
+#include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #ifdef _MSC_VER
 #ifdef MlibMemory_EXPORTS
@@ -25,14 +26,26 @@
 namespace Mlib {
 
 class ObjectPool;
-    
+
+// Releases the memory of an object after its destructor was called.
+// There is one function per class instead of a closure per object.
+using DeallocateObject = void(*)(void* memory);
+
+template <class T>
+void deallocate_from_slab(void* memory) {
+    slab_deallocate(static_cast<T*>(memory));
+}
+
+template <class T>
+void deallocate_from_heap(void* memory) {
+    std::allocator<T>().deallocate(static_cast<T*>(memory), 1);
+}
+
 struct ObjectAndSourceLocation {
-    std::function<void()> deallocate;
+    DeallocateObject deallocate;
+    void* memory;
     Object* object;
     SourceLocation loc;
-    inline std::strong_ordering operator <=> (const ObjectAndSourceLocation& other) const {
-        return object <=> other.object;
-    }
 };
 
 enum class InObjectPoolDestructor {
@@ -40,6 +53,20 @@ enum class InObjectPoolDestructor {
     ASSERT_NO_LEAKS
 };
 
+// Deleter of objects that were extracted from an object pool.
+template <class T>
+class DeleteExtracted {
+public:
+    DeleteExtracted() noexcept;
+    explicit DeleteExtracted(DeallocateObject deallocate) noexcept;
+    void operator () (T* v);
+    inline DeallocateObject deallocate() const {
+        return deallocate_;
+    }
+private:
+    DeallocateObject deallocate_;
+};
+
 template <class T>
 class DeleteFromPool {
 public:
@@ -58,6 +85,8 @@ class ObjectPool: public virtual DanglingBaseClass {
 public:
     template <class T>
     using UniquePtr = std::unique_ptr<T, DeleteFromPool<T>>;
+    template <class T>
+    using ExtractedPtr = std::unique_ptr<T, DeleteExtracted<T>>;
 
     ObjectPool(InObjectPoolDestructor what_to_do_in_dtor);
     ~ObjectPool();
@@ -65,14 +94,14 @@ public:
     template<class T, class... Args>
         requires std::is_convertible_v<T&, Object&>
     T& create(SourceLocation loc, Args&&... args) {
-        T* o = std::allocator<T>().allocate(1);
+        T* o = slab_allocate<T>();
         try {
             new (o) T(std::forward<Args>(args)...);
         } catch (...) {
-            std::allocator<T>().deallocate(o, 1);
+            slab_deallocate(o);
             throw;
         }
-        add([o](){ std::allocator<T>().deallocate(o, 1); }, *o, loc);
+        add(&deallocate_from_slab<T>, o, *o, loc);
         return *o;
     }
     template<class T>
@@ -82,7 +111,18 @@ public:
             verbose_abort("Attempt to add nullptr to object pool");
         }
         auto o = u.release();
-        add([o]() { std::allocator<T>().deallocate(o, 1); }, *o, loc);
+        add(&deallocate_from_heap<T>, o, *o, loc);
+        return *o;
+    }
+    template<class T>
+        requires std::is_convertible_v<T&, Object&>
+    T& add(ExtractedPtr<T>&& u, SourceLocation loc) {
+        if (u == nullptr) {
+            verbose_abort("Attempt to add nullptr to object pool");
+        }
+        auto deallocate = u.get_deleter().deallocate();
+        auto o = u.release();
+        add(deallocate, o, *o, loc);
         return *o;
     }
     template<class T, class... Args>
@@ -99,32 +139,60 @@ public:
     }
     template<class T>
         requires std::is_convertible_v<T&, Object&>
-    std::unique_ptr<T> extract(UniquePtr<T>&& u) {
+    ExtractedPtr<T> extract(UniquePtr<T>&& u) {
         if (u == nullptr) {
             verbose_abort("Attempt to extract a nullptr from the object pool");
         }
-        extract(*u);
-        return std::unique_ptr<T>{u.release()};
+        auto deallocate = extract(*u);
+        return { u.release(), DeleteExtracted<T>{ deallocate } };
     }
 
     bool contains(Object* o) const;
     bool contains(Object& o) const;
     void remove(Object* o);
     void remove(Object& o);
-    void extract(Object* o);
-    void extract(Object& o);
+    // Returns the function that releases the memory of the object.
+    DeallocateObject extract(Object* o);
+    DeallocateObject extract(Object& o);
+    // Destroys the objects in address order, i.e. slab by slab.
     void clear();
     void assert_no_leaks() const;
 private:
-    void add(std::function<void()> deallocate, Object& o, SourceLocation loc);
+    void add(DeallocateObject deallocate, void* memory, Object& o, SourceLocation loc);
     void delete_(const ObjectAndSourceLocation& o);
     mutable FastMutex mutex_;
     InObjectPoolDestructor what_to_do_in_dtor_;
-    std::set<ObjectAndSourceLocation> ptrs_;
-    std::unordered_set<Object*> deleting_ptrs_;
+    std::unordered_map<
+        Object*,
+        ObjectAndSourceLocation,
+        std::hash<Object*>,
+        std::equal_to<Object*>,
+        SlabStlAllocator<std::pair<Object* const, ObjectAndSourceLocation>>> ptrs_;
+    std::unordered_set<
+        Object*,
+        std::hash<Object*>,
+        std::equal_to<Object*>,
+        SlabStlAllocator<Object*>> deleting_ptrs_;
+    std::vector<Object*> clearing_order_;
     bool clearing_;
 };
 
+template <class T>
+DeleteExtracted<T>::DeleteExtracted() noexcept
+    : deallocate_{ nullptr }
+{}
+
+template <class T>
+DeleteExtracted<T>::DeleteExtracted(DeallocateObject deallocate) noexcept
+    : deallocate_{ deallocate }
+{}
+
+template <class T>
+void DeleteExtracted<T>::operator () (T* v) {
+    v->~T();
+    deallocate_(v);
+}
+
 template <class T>
 DeleteFromPool<T>::DeleteFromPool() noexcept
     : p_{ nullptr }
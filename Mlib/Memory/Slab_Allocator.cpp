@@ -0,0 +1,198 @@
+#include "Slab_Allocator.hpp"
+#include <Mlib/Os/Threads/Fast_Mutex.hpp>
+#include <Mlib/Os/Threads/Thread_Local.hpp>
+#include <algorithm>
+#include <array>
+#include <mutex>
+#include <vector>
+
+using namespace Mlib;
+
+namespace Mlib {
+
+// Free blocks store the pointer to the next free block in their own memory.
+struct SlabFreeBlock {
+    SlabFreeBlock* next;
+};
+
+struct SlabSizeClass {
+    mutable FastMutex mutex;
+    SlabFreeBlock* free = nullptr;
+    std::vector<std::unique_ptr<std::byte[]>> slabs;
+};
+
+}
+
+namespace {
+
+// Number of blocks moved between a thread cache and the shared free list at once.
+const size_t BATCH_SIZE = 32;
+const size_t MIN_SLAB_SIZE = 64 * 1024;
+
+struct SlabThreadCache {
+    struct Bin {
+        SlabFreeBlock* free = nullptr;
+        size_t n = 0;
+    };
+    std::array<Bin, SlabAllocator::NSIZE_CLASSES> bins;
+    // Only the thread-local instance returns its blocks, not the initial value it was copied from.
+    bool owner = false;
+    ~SlabThreadCache();
+    void flush() {
+        for (size_t c = 0; c < bins.size(); ++c) {
+            auto& bin = bins[c];
+            if (bin.free != nullptr) {
+                SlabAllocator::instance().deallocate_list(bin.free, c);
+                bin.free = nullptr;
+                bin.n = 0;
+            }
+        }
+    }
+};
+
+// Blocks freed while the thread exits bypass the destroyed cache.
+#ifndef WITHOUT_THREAD_LOCAL
+bool& thread_cache_destroyed() {
+    thread_local bool destroyed = false;
+    return destroyed;
+}
+
+SlabThreadCache& thread_cache() {
+    thread_local SlabThreadCache cache;
+    return cache;
+}
+#else
+// "ThreadLocal" deletes its key when it is destroyed, so both objects are leaked,
+// s.t. static destructors in other translation units (e.g. the one of
+// "global_object_pool") can still deallocate after this translation unit is gone.
+bool& thread_cache_destroyed() {
+    static auto* destroyed = new ThreadLocal<bool>{ false };
+    return destroyed->get();
+}
+
+SlabThreadCache& thread_cache() {
+    static auto* cache = new ThreadLocal<SlabThreadCache>{ SlabThreadCache{} };
+    return cache->get();
+}
+#endif
+
+SlabThreadCache::~SlabThreadCache() {
+    if (owner) {
+        thread_cache_destroyed() = true;
+        flush();
+    }
+}
+
+SlabThreadCache* get_thread_cache() {
+    if (thread_cache_destroyed()) {
+        return nullptr;
+    }
+    SlabThreadCache& cache = thread_cache();
+    cache.owner = true;
+    return &cache;
+}
+
+// Moves up to "n" blocks from the front of "from" to the front of "to".
+size_t move_blocks(SlabFreeBlock*& from, SlabFreeBlock*& to, size_t n) {
+    size_t i = 0;
+    while ((i < n) && (from != nullptr)) {
+        auto* b = from;
+        from = b->next;
+        b->next = to;
+        to = b;
+        ++i;
+    }
+    return i;
+}
+
+void add_slab(SlabSizeClass& cls, size_t block_size) {
+    auto slab_size = std::max(MIN_SLAB_SIZE, BATCH_SIZE * block_size) / block_size * block_size;
+    auto& slab = cls.slabs.emplace_back(new std::byte[slab_size]);
+    // Push in reverse, s.t. the blocks are handed out in address order.
+    for (size_t o = slab_size; o != 0; o -= block_size) {
+        auto* b = reinterpret_cast<SlabFreeBlock*>(slab.get() + o - block_size);
+        b->next = cls.free;
+        cls.free = b;
+    }
+}
+
+}
+
+SlabAllocator::SlabAllocator()
+    : classes_{ new SlabSizeClass[NSIZE_CLASSES] }
+{}
+
+SlabAllocator::~SlabAllocator() = default;
+
+SlabAllocator& SlabAllocator::instance() {
+    static auto* allocator = new SlabAllocator;
+    return *allocator;
+}
+
+void* SlabAllocator::allocate(size_t size_class) {
+    auto& cls = classes_[size_class];
+    auto* cache = get_thread_cache();
+    if (cache == nullptr) {
+        std::scoped_lock lock{ cls.mutex };
+        if (cls.free == nullptr) {
+            add_slab(cls, block_size(size_class));
+        }
+        auto* b = cls.free;
+        cls.free = b->next;
+        return b;
+    }
+    auto& bin = cache->bins[size_class];
+    if (bin.free == nullptr) {
+        // The blocks are reversed twice, s.t. they keep their order.
+        SlabFreeBlock* batch = nullptr;
+        {
+            std::scoped_lock lock{ cls.mutex };
+            if (cls.free == nullptr) {
+                add_slab(cls, block_size(size_class));
+            }
+            move_blocks(cls.free, batch, BATCH_SIZE);
+        }
+        bin.n += move_blocks(batch, bin.free, BATCH_SIZE);
+    }
+    auto* b = bin.free;
+    bin.free = b->next;
+    --bin.n;
+    return b;
+}
+
+void SlabAllocator::deallocate(void* p, size_t size_class) {
+    auto& cls = classes_[size_class];
+    auto* b = static_cast<SlabFreeBlock*>(p);
+    auto* cache = get_thread_cache();
+    if (cache == nullptr) {
+        std::scoped_lock lock{ cls.mutex };
+        b->next = cls.free;
+        cls.free = b;
+        return;
+    }
+    auto& bin = cache->bins[size_class];
+    b->next = bin.free;
+    bin.free = b;
+    if (++bin.n > 2 * BATCH_SIZE) {
+        std::scoped_lock lock{ cls.mutex };
+        bin.n -= move_blocks(bin.free, cls.free, BATCH_SIZE);
+    }
+}
+
+void SlabAllocator::deallocate_list(SlabFreeBlock* blocks, size_t size_class) {
+    auto& cls = classes_[size_class];
+    std::scoped_lock lock{ cls.mutex };
+    move_blocks(blocks, cls.free, SIZE_MAX);
+}
+
+void SlabAllocator::flush_thread_cache() {
+    if (auto* cache = get_thread_cache(); cache != nullptr) {
+        cache->flush();
+    }
+}
+
+size_t SlabAllocator::nslabs(size_t size_class) const {
+    const auto& cls = classes_[size_class];
+    std::scoped_lock lock{ cls.mutex };
+    return cls.slabs.size();
+}
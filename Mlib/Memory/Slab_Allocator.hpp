@@ -0,0 +1,138 @@
+#pragma once
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+
+namespace Mlib {
+
+struct SlabSizeClass;
+struct SlabFreeBlock;
+
+// Process-wide size-class allocator for small objects.
+// Each size class carves fixed-size blocks out of large slabs and keeps
+// the unused blocks in an intrusive free list, s.t. an allocation does
+// not call "malloc", and objects allocated together are close in memory.
+// Every thread caches a few free blocks per size class, so that most
+// allocations do not take the lock of the size class.
+// Slabs are never returned to the system, and the allocator is never
+// destroyed, s.t. objects with static storage duration can use it.
+class SlabAllocator {
+    SlabAllocator(const SlabAllocator&) = delete;
+    SlabAllocator& operator = (const SlabAllocator&) = delete;
+public:
+    static constexpr size_t ALIGNMENT = alignof(std::max_align_t);
+    // 16-byte steps up to 128 bytes, then eight size classes per power of two, up to 16 KiB.
+    static constexpr size_t NSIZE_CLASSES = 64;
+    static constexpr size_t block_size(size_t size_class) {
+        if (size_class < 8) {
+            return 16 * (size_class + 1);
+        }
+        auto octave = (size_class - 8) / 8;
+        auto step = (size_class - 8) % 8 + 1;
+        return (128 << octave) + step * (16 << octave);
+    }
+    // Returns "NSIZE_CLASSES" if the size is too large for a slab.
+    static constexpr size_t size_class(size_t nbytes) {
+        if (nbytes <= 128) {
+            return (std::max<size_t>(nbytes, 1) + 15) / 16 - 1;
+        }
+        if (nbytes > block_size(NSIZE_CLASSES - 1)) {
+            return NSIZE_CLASSES;
+        }
+        auto octave = (size_t)std::bit_width(nbytes - 1) - 8;
+        auto step = (nbytes - (128 << octave) + (16 << octave) - 1) / (16 << octave);
+        return 8 + 8 * octave + step - 1;
+    }
+
+    static SlabAllocator& instance();
+    void* allocate(size_t size_class);
+    void deallocate(void* p, size_t size_class);
+    // Returns a linked list of free blocks to the shared free list of the size class.
+    void deallocate_list(SlabFreeBlock* blocks, size_t size_class);
+    // Returns the free blocks of the calling thread to the shared free lists.
+    void flush_thread_cache();
+    // Number of slabs allocated so far, for tests and benchmarks.
+    size_t nslabs(size_t size_class) const;
+private:
+    SlabAllocator();
+    ~SlabAllocator();
+    std::unique_ptr<SlabSizeClass[]> classes_;
+};
+
+template <class T>
+constexpr bool is_slab_allocatable_v =
+    (alignof(T) <= SlabAllocator::ALIGNMENT) &&
+    (SlabAllocator::size_class(sizeof(T)) != SlabAllocator::NSIZE_CLASSES);
+
+// Allocates uninitialized memory for one "T".
+// Objects that are too large or over-aligned fall back to "std::allocator".
+template <class T>
+T* slab_allocate() {
+    if constexpr (is_slab_allocatable_v<T>) {
+        static constexpr auto c = SlabAllocator::size_class(sizeof(T));
+        return static_cast<T*>(SlabAllocator::instance().allocate(c));
+    } else {
+        return std::allocator<T>().allocate(1);
+    }
+}
+
+// Releases memory obtained from "slab_allocate<T>", without calling the destructor.
+template <class T>
+void slab_deallocate(T* p) {
+    if constexpr (is_slab_allocatable_v<T>) {
+        static constexpr auto c = SlabAllocator::size_class(sizeof(T));
+        SlabAllocator::instance().deallocate(p, c);
+    } else {
+        std::allocator<T>().deallocate(p, 1);
+    }
+}
+
+// Allocator for the nodes of node-based standard containers.
+// Arrays (e.g. hash buckets) that are larger than the largest size class
+// fall back to "std::allocator".
+template <class T>
+class SlabStlAllocator {
+public:
+    using value_type = T;
+    SlabStlAllocator() noexcept = default;
+    template <class U>
+    SlabStlAllocator(const SlabStlAllocator<U>&) noexcept {}
+    T* allocate(size_t n) {
+        if (n == 1) {
+            return slab_allocate<T>();
+        }
+        auto c = array_size_class(n);
+        if (c == SlabAllocator::NSIZE_CLASSES) {
+            return std::allocator<T>().allocate(n);
+        }
+        return static_cast<T*>(SlabAllocator::instance().allocate(c));
+    }
+    void deallocate(T* p, size_t n) noexcept {
+        if (n == 1) {
+            slab_deallocate(p);
+            return;
+        }
+        auto c = array_size_class(n);
+        if (c == SlabAllocator::NSIZE_CLASSES) {
+            std::allocator<T>().deallocate(p, n);
+        } else {
+            SlabAllocator::instance().deallocate(p, c);
+        }
+    }
+    template <class U>
+    bool operator == (const SlabStlAllocator<U>&) const noexcept {
+        return true;
+    }
+private:
+    static size_t array_size_class(size_t n) {
+        if ((alignof(T) > SlabAllocator::ALIGNMENT) || (n > SIZE_MAX / sizeof(T))) {
+            return SlabAllocator::NSIZE_CLASSES;
+        }
+        return SlabAllocator::size_class(n * sizeof(T));
+    }
+};
+
+}
@@ -42,6 +42,9 @@ public:
             case PathType::VARIABLE:
                 return;
             case PathType::LOCAL_PATH:
+                if (archiver.allows_local_paths()) {
+                    return;
+                }
                 throw std::runtime_error("Attempt to serialize a file path: \"" + string() + '"');
             }
             throw std::runtime_error("Unknown path type: \"" + *path_or_variable_ + '"');
@@ -0,0 +1,141 @@
+#include "String_Atom.hpp"
+#include <Mlib/Hashing/Hash.hpp>
+#include <Mlib/Os/Os.hpp>
+#include <mutex>
+#include <ostream>
+
+using namespace Mlib;
+
+static const uint32_t EMPTY_SLOT = UINT32_MAX;
+static const uint32_t INITIAL_INDEX_CAPACITY = 1 << 10;
+
+StringAtomTable::Index::Index(uint32_t capacity)
+    : mask{ capacity - 1 }
+    , slots{ new std::atomic<uint32_t>[capacity] }
+{
+    for (uint32_t i = 0; i < capacity; ++i) {
+        slots[i].store(EMPTY_SLOT, std::memory_order_relaxed);
+    }
+}
+
+StringAtomTable::Index::~Index() = default;
+
+StringAtomTable::StringAtomTable()
+    : size_{ 0 }
+{
+    for (auto& c : chunks_) {
+        c.store(nullptr, std::memory_order_relaxed);
+    }
+    indices_.push_back(std::make_unique<Index>(INITIAL_INDEX_CAPACITY));
+    index_.store(indices_.back().get(), std::memory_order_release);
+    intern("", hash_combine(std::string()));
+}
+
+StringAtomTable::~StringAtomTable() = default;
+
+StringAtomTable& StringAtomTable::instance() {
+    static auto* table = new StringAtomTable;
+    return *table;
+}
+
+uint32_t StringAtomTable::intern(std::string_view s, size_t hash) {
+    if (auto id = try_find(s, hash); id.has_value()) {
+        return *id;
+    }
+    std::scoped_lock lock{ mutex_ };
+    // Another thread may have interned "s" in the meantime.
+    if (auto id = try_find(s, hash); id.has_value()) {
+        return *id;
+    }
+    auto id = size_.load(std::memory_order_relaxed);
+    if (id == CHUNK_SIZE * NCHUNKS) {
+        verbose_abort("StringAtomTable: Too many strings");
+    }
+    auto* chunk = chunks_[id / CHUNK_SIZE].load(std::memory_order_relaxed);
+    if (chunk == nullptr) {
+        chunk = new StringAtomEntry[CHUNK_SIZE];
+        chunks_[id / CHUNK_SIZE].store(chunk, std::memory_order_release);
+    }
+    auto& e = chunk[id % CHUNK_SIZE];
+    e.string = s;
+    e.hash = hash;
+    auto* index = index_.load(std::memory_order_relaxed);
+    // Keep the load factor below 1/2.
+    if (2 * (id + 1) > index->mask + 1) {
+        indices_.push_back(std::make_unique<Index>(2 * (index->mask + 1)));
+        index = indices_.back().get();
+        for (uint32_t i = 0; i < id; ++i) {
+            insert_unsafe(*index, i);
+        }
+        index_.store(index, std::memory_order_release);
+    }
+    insert_unsafe(*index, id);
+    size_.store(id + 1, std::memory_order_release);
+    return id;
+}
+
+void StringAtomTable::insert_unsafe(Index& index, uint32_t id) {
+    for (auto i = (uint32_t)entry(id).hash & index.mask;; i = (i + 1) & index.mask) {
+        if (index.slots[i].load(std::memory_order_relaxed) == EMPTY_SLOT) {
+            index.slots[i].store(id, std::memory_order_release);
+            return;
+        }
+    }
+}
+
+std::optional<uint32_t> StringAtomTable::try_find(std::string_view s, size_t hash) const {
+    const auto& index = *index_.load(std::memory_order_acquire);
+    for (auto i = (uint32_t)hash & index.mask;; i = (i + 1) & index.mask) {
+        auto id = index.slots[i].load(std::memory_order_acquire);
+        if (id == EMPTY_SLOT) {
+            return std::nullopt;
+        }
+        const auto& e = entry(id);
+        if ((e.hash == hash) && (e.string == s)) {
+            return id;
+        }
+    }
+}
+
+size_t StringAtomTable::size() const {
+    return size_.load(std::memory_order_acquire);
+}
+
+StringAtom::StringAtom(std::string_view s)
+    : id_{ StringAtomTable::instance().intern(s, hash_combine(s)) }
+{}
+
+StringAtom::StringAtom(const VariableAndHash<std::string>& s)
+    : id_{ StringAtomTable::instance().intern(*s, s.hash()) }
+{}
+
+std::optional<StringAtom> StringAtom::try_find(std::string_view s) {
+    auto id = StringAtomTable::instance().try_find(s, hash_combine(s));
+    if (!id.has_value()) {
+        return std::nullopt;
+    }
+    return StringAtom{ *id };
+}
+
+std::optional<StringAtom> StringAtom::try_find(const VariableAndHash<std::string>& s) {
+    auto id = StringAtomTable::instance().try_find(*s, s.hash());
+    if (!id.has_value()) {
+        return std::nullopt;
+    }
+    return StringAtom{ *id };
+}
+
+VariableAndHash<std::string> StringAtom::variable_and_hash() const {
+    return VariableAndHash<std::string>{ **this };
+}
+
+std::strong_ordering StringAtom::operator <=> (const StringAtom& other) const {
+    if (id_ == other.id_) {
+        return std::strong_ordering::equal;
+    }
+    return **this <=> *other;
+}
+
+std::ostream& Mlib::operator << (std::ostream& ostr, const StringAtom& atom) {
+    return ostr << *atom;
+}
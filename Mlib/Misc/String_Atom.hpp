@@ -0,0 +1,130 @@
+#pragma once
+#include <Mlib/Hashing/Variable_And_Hash.hpp>
+#include <Mlib/Os/Io/Safe_Archiver.hpp>
+#include <Mlib/Os/Threads/Fast_Mutex.hpp>
+#include <atomic>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Mlib {
+
+struct StringAtomEntry {
+    std::string string;
+    size_t hash;
+};
+
+// Global table mapping strings to stable 32-bit atoms.
+// Entries are never removed and never move, and the table is never
+// destroyed, s.t. atoms with static storage duration remain valid
+// during shutdown.
+// Lookups are lock-free, only interning a new string takes a lock.
+class StringAtomTable {
+    StringAtomTable(const StringAtomTable&) = delete;
+    StringAtomTable& operator = (const StringAtomTable&) = delete;
+    // Open addressing with linear probing over the atom ids.
+    struct Index {
+        explicit Index(uint32_t capacity);
+        ~Index();
+        uint32_t mask;
+        std::unique_ptr<std::atomic<uint32_t>[]> slots;
+    };
+public:
+    static constexpr uint32_t CHUNK_SIZE = 1 << 12;
+    static constexpr uint32_t NCHUNKS = 1 << 12;
+    static StringAtomTable& instance();
+    uint32_t intern(std::string_view s, size_t hash);
+    // Lock-free, "hash" must be "hash_combine(s)".
+    std::optional<uint32_t> try_find(std::string_view s, size_t hash) const;
+    // Lock-free.
+    inline const StringAtomEntry& entry(uint32_t id) const {
+        return chunks_[id / CHUNK_SIZE].load(std::memory_order_acquire)[id % CHUNK_SIZE];
+    }
+    size_t size() const;
+private:
+    StringAtomTable();
+    ~StringAtomTable();
+    void insert_unsafe(Index& index, uint32_t id);
+    std::atomic<StringAtomEntry*> chunks_[NCHUNKS];
+    std::atomic<uint32_t> size_;
+    std::atomic<Index*> index_;
+    // Outgrown indices are kept alive, because readers may still probe
+    // them. This at most doubles the memory of the index.
+    std::vector<std::unique_ptr<Index>> indices_;
+    FastMutex mutex_;
+};
+
+// Interned string.
+// Copying, comparing and hashing are integer operations, the string
+// is only accessed for printing and serialization.
+class StringAtom {
+public:
+    // The empty string.
+    inline StringAtom()
+        : id_{ 0 }
+    {}
+    explicit StringAtom(std::string_view s);
+    explicit StringAtom(const VariableAndHash<std::string>& s);
+    // Does not grow the table if "s" has not been interned yet.
+    static std::optional<StringAtom> try_find(std::string_view s);
+    // Same as above, reusing the precomputed hash.
+    static std::optional<StringAtom> try_find(const VariableAndHash<std::string>& s);
+    inline const std::string& operator * () const {
+        return entry().string;
+    }
+    inline const std::string* operator -> () const {
+        return &entry().string;
+    }
+    inline uint32_t id() const {
+        return id_;
+    }
+    // Identical to "VariableAndHash<std::string>::hash()".
+    // "std::hash<StringAtom>" uses the atom instead.
+    inline size_t hash() const {
+        return entry().hash;
+    }
+    VariableAndHash<std::string> variable_and_hash() const;
+    inline bool operator == (const StringAtom& other) const {
+        return id_ == other.id_;
+    }
+    // Compares the strings, s.t. the order does not depend on the
+    // interning order.
+    std::strong_ordering operator <=> (const StringAtom& other) const;
+    template <class Archive>
+    void serialize(Archive& archiver) {
+        SafeArchiver archive{archiver};
+        if constexpr (Archive::is_saving::value) {
+            archive(entry().string);
+        } else {
+            std::string s;
+            archive(s);
+            *this = StringAtom{ s };
+        }
+    }
+private:
+    inline const StringAtomEntry& entry() const {
+        return StringAtomTable::instance().entry(id_);
+    }
+    inline explicit StringAtom(uint32_t id)
+        : id_{ id }
+    {}
+    uint32_t id_;
+};
+
+std::ostream& operator << (std::ostream& ostr, const StringAtom& atom);
+
+}
+
+template <>
+struct std::hash<Mlib::StringAtom>
+{
+    inline std::size_t operator() (const Mlib::StringAtom& k) const {
+        return k.id();
+    }
+};
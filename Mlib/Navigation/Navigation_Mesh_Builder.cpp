@@ -1,38 +1,62 @@
 #include "Navigation_Mesh_Builder.hpp"
+#include <Mlib/Os/Env.hpp>
 #include <chrono>
 #include <iostream>
 #include <stdexcept>
 
 using namespace Mlib;
 
+std::optional<Utf8Path> Mlib::navigation_mesh_cache_directory() {
+    auto dir = try_getenv("NAVMESH_CACHE_DIR");
+    if (!dir.has_value() || dir->empty()) {
+        return std::nullopt;
+    }
+    return Utf8Path{ *dir };
+}
+
 NavigationMeshBuilder::NavigationMeshBuilder(
     const Utf8Path& filename,
     const NavigationMeshConfig& cfg)
-    : ssm{ctx_, geom_}
 {
     if (!geom_.load(&ctx_, filename)) {
         throw std::runtime_error("Could not load obj file");
     }
-    ssm.m_cellSize = cfg.cell_size;
-    ssm.m_agentRadius = cfg.agent_radius;
-    if (!ssm.build()) {
-        throw std::runtime_error("Build failed");
-    }
+    build(cfg);
 }
 
 NavigationMeshBuilder::NavigationMeshBuilder(
     const IndexedFaceSet<float, float, size_t>& indexed_face_set,
     const NavigationMeshConfig& cfg)
-: ssm{ctx_, geom_}
 {
     if (!geom_.load(&ctx_, indexed_face_set)) {
         throw std::runtime_error("Could not import indexed face set");
     }
-    ssm.m_cellSize = cfg.cell_size;
-    ssm.m_agentRadius = cfg.agent_radius;
-    if (!ssm.build()) {
-        throw std::runtime_error("Build failed");
-    }
+    build(cfg);
 }
 
 NavigationMeshBuilder::~NavigationMeshBuilder() = default;
+
+void NavigationMeshBuilder::build(const NavigationMeshConfig& cfg) {
+    if (cfg.tile_size == 0.f) {
+        ssm_ = std::make_unique<Sample_SoloMesh>(ctx_, geom_);
+        ssm_->m_cellSize = cfg.cell_size;
+        ssm_->m_agentRadius = cfg.agent_radius;
+        if (!ssm_->build()) {
+            throw std::runtime_error("Build failed");
+        }
+    } else {
+        stm_ = std::make_unique<Sample_TileMesh>(ctx_, geom_);
+        stm_->m_cellSize = cfg.cell_size;
+        stm_->m_agentRadius = cfg.agent_radius;
+        stm_->m_tileSize = cfg.tile_size;
+        stm_->m_nthreads = cfg.nthreads;
+        stm_->m_cacheDirectory = cfg.cache_directory;
+        if (!stm_->build()) {
+            throw std::runtime_error("Build failed");
+        }
+    }
+}
+
+const NavigationMeshQuery& NavigationMeshBuilder::query() const {
+    return (stm_ != nullptr) ? stm_->query() : ssm_->query();
+}
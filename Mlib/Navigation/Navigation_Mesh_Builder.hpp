@@ -1,8 +1,11 @@
 #pragma once
 #include <Mlib/Navigation/InputGeom.hpp>
 #include <Mlib/Navigation/Sample_SoloMesh.hpp>
+#include <Mlib/Navigation/Sample_TileMesh.hpp>
 #include <Mlib/Navigation/StderrContext.hpp>
 #include <Mlib/Strings/Utf8_Path.hpp>
+#include <memory>
+#include <optional>
 #include <string>
 
 namespace Mlib {
@@ -13,8 +16,18 @@ class IndexedFaceSet;
 struct NavigationMeshConfig {
     float cell_size;
     float agent_radius;
+    // Tile edge length in cells, zero for a single mesh without tiles.
+    float tile_size = 0.f;
+    // Number of build threads of the tiled mesh, zero for one thread per core.
+    int nthreads = 0;
+    // Disk cache of the tiled mesh, no caching if not set.
+    std::optional<Utf8Path> cache_directory;
 };
 
+// Directory of the navmesh tile cache, taken from the environment
+// variable "NAVMESH_CACHE_DIR". The cache is disabled if it is not set.
+std::optional<Utf8Path> navigation_mesh_cache_directory();
+
 class NavigationMeshBuilder {
 public:
     explicit NavigationMeshBuilder(
@@ -24,11 +37,17 @@ public:
         const IndexedFaceSet<float, float, size_t>& indexed_face_set,
         const NavigationMeshConfig& cfg);
     ~NavigationMeshBuilder();
+    const NavigationMeshQuery& query() const;
+    // Null if the mesh has no tiles.
+    inline Sample_TileMesh* tiled() {
+        return stm_.get();
+    }
 private:
+    void build(const NavigationMeshConfig& cfg);
     StderrContext ctx_;
     InputGeom geom_;
-public:
-    Sample_SoloMesh ssm;
+    std::unique_ptr<Sample_SoloMesh> ssm_;
+    std::unique_ptr<Sample_TileMesh> stm_;
 };
 
 }
@@ -0,0 +1,370 @@
+//
+// Copyright (c) 2009-2010 Mikko Mononen memon@inside.org
+//
+// This software is provided 'as-is', without any express or implied
+// warranty.  In no event will the authors be held liable for any damages
+// arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+//
+
+#include "Navigation_Mesh_Query.hpp"
+#include <Mlib/Navigation/Sample_Poly_Flags.hpp>
+#include <Mlib/Misc/Pragma_Clang.hpp>
+PRAGMA_CLANG_DIAGNOSTIC_PUSH
+PRAGMA_CLANG_DIAGNOSTIC_IGNORED(-Wsign-conversion)
+#include <DetourCommon.h>
+#include <DetourNavMesh.h>
+#include <DetourNavMeshQuery.h>
+#include <Recast.h>
+PRAGMA_CLANG_DIAGNOSTIC_POP
+#include <cmath>
+#include <cstring>
+
+using namespace Mlib;
+
+static const int MAX_POLYS = 256;
+static const int MAX_SMOOTH = 2048;
+static const float SLOP = 0.01f;
+
+NavigationMeshQuery::NavigationMeshQuery()
+    : m_navQuery{ dtAllocNavMeshQuery() }
+    , m_polyPickExtent{ uninitialized }
+{
+    m_filter.setIncludeFlags(SAMPLE_POLYFLAGS_ALL ^ SAMPLE_POLYFLAGS_DISABLED);
+    m_filter.setExcludeFlags(0);
+}
+
+NavigationMeshQuery::~NavigationMeshQuery()
+{
+    dtFreeNavMeshQuery(m_navQuery);
+}
+
+bool NavigationMeshQuery::init(const dtNavMesh& nav_mesh, const FixedArray<float, 3>& poly_pick_extent)
+{
+    m_polyPickExtent = poly_pick_extent;
+    return !dtStatusFailed(m_navQuery->init(&nav_mesh, 2048));
+}
+
+static inline bool inRange(const float* v1, const float* v2, const float r, const float h)
+{
+    const float dx = v2[0] - v1[0];
+    const float dy = v2[1] - v1[1];
+    const float dz = v2[2] - v1[2];
+    return (dx*dx + dz*dz) < r*r && fabsf(dy) < h;
+}
+
+static bool getSteerTarget(dtNavMeshQuery* navQuery, const float* startPos, const float* endPos,
+                           const float minTargetDist,
+                           const dtPolyRef* path, const int pathSize,
+                           float* steerPos, unsigned char& steerPosFlag, dtPolyRef& steerPosRef,
+                           float* outPoints = 0, int* outPointCount = 0)                             
+{
+    // Find steer target.
+    static const int MAX_STEER_POINTS = 3;
+    float steerPath[MAX_STEER_POINTS*3];
+    unsigned char steerPathFlags[MAX_STEER_POINTS];
+    dtPolyRef steerPathPolys[MAX_STEER_POINTS];
+    int nsteerPath = 0;
+    navQuery->findStraightPath(startPos, endPos, path, pathSize,
+                               steerPath, steerPathFlags, steerPathPolys, &nsteerPath, MAX_STEER_POINTS);
+    if (!nsteerPath)
+        return false;
+        
+    if (outPoints && outPointCount)
+    {
+        *outPointCount = nsteerPath;
+        for (int i = 0; i < nsteerPath; ++i)
+            dtVcopy(&outPoints[i*3], &steerPath[i*3]);
+    }
+
+    
+    // Find vertex far enough to steer to.
+    int ns = 0;
+    while (ns < nsteerPath)
+    {
+        // Stop at Off-Mesh link or when point is further than slop away.
+        if ((steerPathFlags[ns] & DT_STRAIGHTPATH_OFFMESH_CONNECTION) ||
+            !inRange(&steerPath[ns*3], startPos, minTargetDist, 1000.0f))
+            break;
+        ns++;
+    }
+    // Failed to find good point to steer to.
+    if (ns >= nsteerPath)
+        return false;
+    
+    dtVcopy(steerPos, &steerPath[ns*3]);
+    steerPos[1] = startPos[1];
+    steerPosFlag = steerPathFlags[ns];
+    steerPosRef = steerPathPolys[ns];
+    
+    return true;
+}
+
+static int fixupCorridor(dtPolyRef* path, const int npath, const int maxPath,
+                         const dtPolyRef* visited, const int nvisited)
+{
+    int furthestPath = -1;
+    int furthestVisited = -1;
+    
+    // Find furthest common polygon.
+    for (int i = npath-1; i >= 0; --i)
+    {
+        bool found = false;
+        for (int j = nvisited-1; j >= 0; --j)
+        {
+            if (path[i] == visited[j])
+            {
+                furthestPath = i;
+                furthestVisited = j;
+                found = true;
+            }
+        }
+        if (found)
+            break;
+    }
+
+    // If no intersection found just return current path. 
+    if (furthestPath == -1 || furthestVisited == -1)
+        return npath;
+    
+    // Concatenate paths.    
+
+    // Adjust beginning of the buffer to include the visited.
+    const int req = nvisited - furthestVisited;
+    const int orig = rcMin(furthestPath+1, npath);
+    int size = rcMax(0, npath-orig);
+    if (req+size > maxPath)
+        size = maxPath-req;
+    if (size)
+        memmove(path+req, path+orig, (size_t)size*sizeof(dtPolyRef));
+    
+    // Store visited
+    for (int i = 0; i < req; ++i)
+        path[i] = visited[(nvisited-1)-i];                
+    
+    return req+size;
+}
+
+// This function checks if the path has a small U-turn, that is,
+// a polygon further in the path is adjacent to the first polygon
+// in the path. If that happens, a shortcut is taken.
+// This can happen if the target (T) location is at tile boundary,
+// and we're (S) approaching it parallel to the tile edge.
+// The choice at the vertex can be arbitrary, 
+//  +---+---+
+//  |:::|:::|
+//  +-S-+-T-+
+//  |:::|   | <-- the step can end up in here, resulting U-turn path.
+//  +---+---+
+static int fixupShortcuts(dtPolyRef* path, int npath, dtNavMeshQuery* navQuery)
+{
+    if (npath < 3)
+        return npath;
+
+    // Get connected polygons
+    static const int maxNeis = 16;
+    dtPolyRef neis[maxNeis];
+    int nneis = 0;
+
+    const dtMeshTile* tile = 0;
+    const dtPoly* poly = 0;
+    if (dtStatusFailed(navQuery->getAttachedNavMesh()->getTileAndPolyByRef(path[0], &tile, &poly)))
+        return npath;
+    
+    for (unsigned int k = poly->firstLink; k != DT_NULL_LINK; k = tile->links[k].next)
+    {
+        const dtLink* link = &tile->links[k];
+        if (link->ref != 0)
+        {
+            if (nneis < maxNeis)
+                neis[nneis++] = link->ref;
+        }
+    }
+
+    // If any of the neighbour polygons is within the next few polygons
+    // in the path, short cut to that polygon directly.
+    static const int maxLookAhead = 6;
+    int cut = 0;
+    for (int i = dtMin(maxLookAhead, npath) - 1; i > 1 && cut == 0; i--) {
+        for (int j = 0; j < nneis; j++)
+        {
+            if (path[i] == neis[j]) {
+                cut = i;
+                break;
+            }
+        }
+    }
+    if (cut > 1)
+    {
+        int offset = cut-1;
+        npath -= offset;
+        for (int i = 1; i < npath; i++)
+            path[i] = path[i+offset];
+    }
+
+    return npath;
+}
+
+std::list<FixedArray<float, 3>> NavigationMeshQuery::shortest_path(
+    const LocalizedNavmeshNode& start,
+    const LocalizedNavmeshNode& end,
+    float step_size) const
+{
+    if (!m_navQuery->getAttachedNavMesh())
+        return {};
+
+    int raw_npolys;
+    dtPolyRef raw_polys[MAX_POLYS];
+
+    if (!dtStatusSucceed(m_navQuery->findPath(start.polyRef, end.polyRef, start.position.flat_begin(), end.position.flat_begin(), &m_filter, raw_polys, &raw_npolys, MAX_POLYS))) {
+        return {};
+    }
+
+    if (raw_npolys == 0) {
+        return {};
+    }
+    // Iterate over the path to find smooth path on the detail mesh surface.
+    dtPolyRef polys[MAX_POLYS];
+    memcpy(polys, raw_polys, sizeof(dtPolyRef) * (size_t)raw_npolys); 
+    int npolys = raw_npolys;
+
+    float iterPos[3], targetPos[3];
+    dtVcopy(iterPos, start.position.flat_begin());
+    dtVcopy(targetPos, end.position.flat_begin());
+
+    std::list<FixedArray<float, 3>> smoothPath;
+
+    smoothPath.push_back(FixedArray<float, 3>::from_buffer(iterPos, 3));
+
+    // Move towards target a small advancement at a time until target reached or
+    // when ran out of memory to store the path.
+    while (npolys && smoothPath.size() < MAX_SMOOTH)
+    {
+        // Find location to steer towards.
+        float steerPos[3];
+        unsigned char steerPosFlag;
+        dtPolyRef steerPosRef;
+
+        if (!getSteerTarget(m_navQuery, iterPos, targetPos, SLOP,
+                            polys, npolys, steerPos, steerPosFlag, steerPosRef))
+            break;
+
+        bool endOfPath = (steerPosFlag & DT_STRAIGHTPATH_END) ? true : false;
+        bool offMeshConnection = (steerPosFlag & DT_STRAIGHTPATH_OFFMESH_CONNECTION) ? true : false;
+
+        // Find movement delta.
+        float delta[3], len;
+        dtVsub(delta, steerPos, iterPos);
+        len = dtMathSqrtf(dtVdot(delta, delta));
+        // If the steer target is end of path or off-mesh link, do not move past the location.
+        if ((endOfPath || offMeshConnection) && len < step_size)
+            len = 1;
+        else
+            len = step_size / len;
+        float moveTgt[3];
+        dtVmad(moveTgt, iterPos, delta, len);
+
+        // Move
+        float result[3];
+        dtPolyRef visited[16];
+        int nvisited = 0;
+        if (!dtStatusSucceed(m_navQuery->moveAlongSurface(polys[0], iterPos, moveTgt, &m_filter,
+                                                          result, visited, &nvisited, 16)))
+        {
+            return {};
+        }
+
+        npolys = fixupCorridor(polys, npolys, MAX_POLYS, visited, nvisited);
+        npolys = fixupShortcuts(polys, npolys, m_navQuery);
+
+        float h = 0;
+        m_navQuery->getPolyHeight(polys[0], result, &h);
+        result[1] = h;
+        dtVcopy(iterPos, result);
+
+        // Handle end of path and off-mesh links when close enough.
+        if (endOfPath && inRange(iterPos, steerPos, SLOP, 1.0f))
+        {
+            // Reached end of path.
+            dtVcopy(iterPos, targetPos);
+            if (smoothPath.size() < MAX_SMOOTH)
+            {
+                smoothPath.push_back(FixedArray<float, 3>::from_buffer(iterPos, 3));
+            }
+            break;
+        }
+        else if (offMeshConnection && inRange(iterPos, steerPos, SLOP, 1.0f))
+        {
+            // Reached off-mesh connection.
+            float startPos[3], endPos[3];
+
+            // Advance the path up to and over the off-mesh connection.
+            dtPolyRef prevRef = 0, polyRef = polys[0];
+            int npos = 0;
+            while (npos < npolys && polyRef != steerPosRef)
+            {
+                prevRef = polyRef;
+                polyRef = polys[npos];
+                npos++;
+            }
+            for (int i = npos; i < npolys; ++i)
+                polys[i-npos] = polys[i];
+            npolys -= npos;
+
+            // Handle the connection.
+            dtStatus status = m_navQuery->getAttachedNavMesh()->getOffMeshConnectionPolyEndPoints(prevRef, polyRef, startPos, endPos);
+            if (dtStatusSucceed(status))
+            {
+                if (smoothPath.size() < MAX_SMOOTH)
+                {
+                    smoothPath.push_back(FixedArray<float, 3>::from_buffer(startPos, 3));
+                    // Hack to make the dotted path not visible during off-mesh connection.
+                    // if (nsmoothPath & 1)
+                    // {
+                    //     dtVcopy(&smoothPath[nsmoothPath*3], startPos);
+                    //     nsmoothPath++;
+                    // }
+                }
+                // Move position at the other side of the off-mesh link.
+                dtVcopy(iterPos, endPos);
+                float eh = 0.0f;
+                m_navQuery->getPolyHeight(polys[0], iterPos, &eh);
+                iterPos[1] = eh;
+            }
+        }
+
+        // Store results.
+        if (smoothPath.size() < MAX_SMOOTH)
+        {
+            smoothPath.push_back(FixedArray<float, 3>::from_buffer(iterPos, 3));
+        }
+    }
+    return smoothPath;
+}
+
+std::optional<LocalizedNavmeshNode> NavigationMeshQuery::closest_point_on_navmesh(const FixedArray<float, 3>& point) const
+{
+    LocalizedNavmeshNode result{ .position = uninitialized };
+    if (!dtStatusSucceed(m_navQuery->findNearestPoly(
+        point.flat_begin(),
+        m_polyPickExtent.flat_begin(),
+        &m_filter,
+        &result.polyRef,
+        nullptr)))
+    {
+        return std::nullopt;
+    }
+    if (!dtStatusSucceed(m_navQuery->closestPointOnPoly(result.polyRef, point.flat_begin(), result.position.flat_begin(), nullptr))) {
+        return std::nullopt;
+    }
+    return result;
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <Mlib/Array/Fixed_Array.hpp>
+#include <Mlib/Misc/Pragma_Clang.hpp>
+PRAGMA_CLANG_DIAGNOSTIC_PUSH
+PRAGMA_CLANG_DIAGNOSTIC_IGNORED(-Wsign-conversion)
+#include <DetourNavMesh.h>
+#include <DetourNavMeshQuery.h>
+PRAGMA_CLANG_DIAGNOSTIC_POP
+#include <list>
+#include <optional>
+
+namespace Mlib {
+
+struct LocalizedNavmeshNode {
+    FixedArray<float, 3> position;
+    dtPolyRef polyRef;
+};
+
+// Path queries on a Detour navmesh, independent of whether it was
+// built as a single mesh or from tiles.
+class NavigationMeshQuery
+{
+private:
+    dtNavMeshQuery* m_navQuery;
+    dtQueryFilter m_filter;
+    FixedArray<float, 3> m_polyPickExtent;
+
+public:
+    NavigationMeshQuery();
+    ~NavigationMeshQuery();
+
+    bool init(const dtNavMesh& nav_mesh, const FixedArray<float, 3>& poly_pick_extent);
+    std::optional<LocalizedNavmeshNode> closest_point_on_navmesh(const FixedArray<float, 3>& point) const;
+    std::list<FixedArray<float, 3>> shortest_path(
+        const LocalizedNavmeshNode& start,
+        const LocalizedNavmeshNode& end,
+        float step_size) const;
+
+private:
+    NavigationMeshQuery(const NavigationMeshQuery&) = delete;
+    NavigationMeshQuery& operator=(const NavigationMeshQuery&) = delete;
+};
+
+}
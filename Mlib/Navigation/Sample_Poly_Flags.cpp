@@ -0,0 +1,32 @@
+#include "Sample_Poly_Flags.hpp"
+#include <Mlib/Misc/Pragma_Clang.hpp>
+PRAGMA_CLANG_DIAGNOSTIC_PUSH
+PRAGMA_CLANG_DIAGNOSTIC_IGNORED(-Wsign-conversion)
+#include <Recast.h>
+PRAGMA_CLANG_DIAGNOSTIC_POP
+
+using namespace Mlib;
+
+void Mlib::set_sample_poly_flags(rcPolyMesh& pmesh)
+{
+    for (int i = 0; i < pmesh.npolys; ++i)
+    {
+        if (pmesh.areas[i] == RC_WALKABLE_AREA)
+            pmesh.areas[i] = SAMPLE_POLYAREA_GROUND;
+
+        if (pmesh.areas[i] == SAMPLE_POLYAREA_GROUND ||
+            pmesh.areas[i] == SAMPLE_POLYAREA_GRASS ||
+            pmesh.areas[i] == SAMPLE_POLYAREA_ROAD)
+        {
+            pmesh.flags[i] = SAMPLE_POLYFLAGS_WALK;
+        }
+        else if (pmesh.areas[i] == SAMPLE_POLYAREA_WATER)
+        {
+            pmesh.flags[i] = SAMPLE_POLYFLAGS_SWIM;
+        }
+        else if (pmesh.areas[i] == SAMPLE_POLYAREA_DOOR)
+        {
+            pmesh.flags[i] = SAMPLE_POLYFLAGS_WALK | SAMPLE_POLYFLAGS_DOOR;
+        }
+    }
+}
@@ -1,25 +1,17 @@
 #pragma once
 #include <Mlib/Array/Fixed_Array.hpp>
 #include <Mlib/Misc/Pragma_Clang.hpp>
-#include <list>
+#include <Mlib/Navigation/Navigation_Mesh_Query.hpp>
 PRAGMA_CLANG_DIAGNOSTIC_PUSH
 PRAGMA_CLANG_DIAGNOSTIC_IGNORED(-Wsign-conversion)
 #include <DetourNavMesh.h>
-#include <DetourNavMeshQuery.h>
 #include <Recast.h>
 PRAGMA_CLANG_DIAGNOSTIC_POP
-#include <list>
-#include <optional>
 
 class InputGeom;
 
 namespace Mlib {
 
-struct LocalizedNavmeshNode {
-    FixedArray<float, 3> position;
-    dtPolyRef polyRef;
-};
-
 class Sample_SoloMesh
 {
 private:
@@ -35,13 +27,11 @@ private:
 
     const InputGeom* m_geom;
     dtNavMesh* m_navMesh;
-    dtNavMeshQuery* m_navQuery;
+    NavigationMeshQuery m_query;
     rcContext* m_ctx;
 
     rcConfig m_cfg;
 
-    dtQueryFilter m_filter;
-
     void cleanup();
 
 public:
@@ -72,11 +62,9 @@ public:
     
     void resetCommonSettings();
     bool build();
-    std::optional<LocalizedNavmeshNode> closest_point_on_navmesh(const FixedArray<float, 3>& point) const;
-    std::list<FixedArray<float, 3>> shortest_path(
-        const LocalizedNavmeshNode& start,
-        const LocalizedNavmeshNode& end,
-        float step_size) const;
+    inline const NavigationMeshQuery& query() const {
+        return m_query;
+    }
 
 private:
     // Explicitly disabled copy constructor and copy assignment operator.
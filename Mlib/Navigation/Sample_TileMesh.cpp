@@ -0,0 +1,712 @@
+#include "Sample_TileMesh.hpp"
+#include <Mlib/Hashing/Fnv1a.hpp>
+#include <Mlib/Misc/Floating_Point_Exceptions.hpp>
+#include <Mlib/Navigation/InputGeom.hpp>
+#include <Mlib/Navigation/Sample_Poly_Flags.hpp>
+#include <Mlib/Navigation/StderrContext.hpp>
+#include <Mlib/Os/Io/Binary.hpp>
+#include <Mlib/Os/Os.hpp>
+#include <Mlib/Misc/Pragma_Clang.hpp>
+PRAGMA_CLANG_DIAGNOSTIC_PUSH
+PRAGMA_CLANG_DIAGNOSTIC_IGNORED(-Wsign-conversion)
+#include <DetourCommon.h>
+#include <DetourNavMesh.h>
+#include <DetourNavMeshBuilder.h>
+#include <Recast.h>
+PRAGMA_CLANG_DIAGNOSTIC_POP
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <exception>
+#include <iomanip>
+#include <span>
+#include <sstream>
+#include <thread>
+
+using namespace Mlib;
+
+static const uint32_t NAVMESH_TILE_CACHE_MAGIC = 0x544e4c4d; // "MLNT"
+// Increment when the tile layout or the build pipeline changes.
+static const uint32_t NAVMESH_TILE_CACHE_VERSION = 1;
+
+namespace {
+
+// Intermediate results of a single tile, freed as soon as possible.
+struct TileIntermediates {
+    rcHeightfield* solid = nullptr;
+    rcCompactHeightfield* chf = nullptr;
+    rcContourSet* cset = nullptr;
+    rcPolyMesh* pmesh = nullptr;
+    rcPolyMeshDetail* dmesh = nullptr;
+    ~TileIntermediates() {
+        rcFreeHeightField(solid);
+        rcFreeCompactHeightfield(chf);
+        rcFreeContourSet(cset);
+        rcFreePolyMesh(pmesh);
+        rcFreePolyMeshDetail(dmesh);
+    }
+};
+
+struct TileResult {
+    unsigned char* data = nullptr;
+    int dataSize = 0;
+    bool cached = false;
+};
+
+}
+
+static std::string tile_entry_name(uint64_t key) {
+    std::stringstream sstr;
+    sstr << std::hex << std::setw(16) << std::setfill('0') << key << ".navtile";
+    return sstr.str();
+}
+
+// Returns false if the entry is missing or outdated.
+// Empty tiles are stored with a size of zero.
+static bool read_tile(
+    const Utf8Path& filename,
+    uint64_t key,
+    unsigned char*& data,
+    int& dataSize)
+{
+    auto ifstr = create_ifstream(filename, std::ios::binary);
+    if (ifstr->fail()) {
+        return false;
+    }
+    if ((read_binary<uint32_t>(*ifstr, "magic", IoVerbosity::SILENT) != NAVMESH_TILE_CACHE_MAGIC) ||
+        (read_binary<uint32_t>(*ifstr, "version", IoVerbosity::SILENT) != NAVMESH_TILE_CACHE_VERSION) ||
+        (read_binary<uint64_t, true>(*ifstr, "key", IoVerbosity::SILENT) != key))
+    {
+        return false;
+    }
+    auto size = read_binary<int32_t>(*ifstr, "size", IoVerbosity::SILENT);
+    if (size < 0) {
+        throw std::runtime_error("Negative navmesh tile size");
+    }
+    if (size == 0) {
+        data = nullptr;
+        dataSize = 0;
+        return true;
+    }
+    auto* d = (unsigned char*)dtAlloc((size_t)size, DT_ALLOC_PERM);
+    if (d == nullptr) {
+        throw std::runtime_error("Could not allocate navmesh tile");
+    }
+    try {
+        read_vector(*ifstr, std::span{ d, (size_t)size }, "tile", IoVerbosity::SILENT);
+    } catch (...) {
+        dtFree(d);
+        throw;
+    }
+    data = d;
+    dataSize = size;
+    return true;
+}
+
+static void write_tile(
+    const Utf8Path& filename,
+    uint64_t key,
+    const unsigned char* data,
+    int dataSize)
+{
+    // Write to a temporary file first, so that concurrent builds
+    // never observe a partially written entry.
+    std::stringstream tmp_suffix;
+    tmp_suffix << ".tmp" << std::this_thread::get_id();
+    auto tmp_filename = filename.string() + tmp_suffix.str();
+    {
+        auto ofstr = create_ofstream(tmp_filename, std::ios::binary);
+        if (ofstr->fail()) {
+            throw std::runtime_error("Could not open navmesh tile cache file \"" + tmp_filename + "\" for write");
+        }
+        write_binary(*ofstr, NAVMESH_TILE_CACHE_MAGIC, "magic");
+        write_binary(*ofstr, NAVMESH_TILE_CACHE_VERSION, "version");
+        write_binary<uint64_t, true>(*ofstr, key, "key");
+        write_binary(*ofstr, (int32_t)dataSize, "size");
+        ofstr->write((const char*)data, dataSize);
+        ofstr->flush();
+        if (ofstr->fail()) {
+            throw std::runtime_error("Could not write navmesh tile cache file \"" + tmp_filename + '"');
+        }
+    }
+    try {
+        if (path_exists(filename)) {
+            remove_path(filename);
+        }
+        rename_path(tmp_filename, filename);
+    } catch (const std::runtime_error&) {
+        // Another thread or process won the race, its entry is equivalent.
+        remove_path(tmp_filename);
+    }
+}
+
+Sample_TileMesh::Sample_TileMesh(
+    rcContext& ctx,
+    const InputGeom& geom)
+    : m_totalBuildTimeMs(0)
+    , m_ncacheHits(0)
+    , m_geom{ &geom }
+    , m_navMesh{ nullptr }
+    , m_ctx{ &ctx }
+    , m_tileWidth(0)
+    , m_tileHeight(0)
+    , m_polyPickExtent{ uninitialized }
+{
+    resetCommonSettings();
+}
+
+Sample_TileMesh::~Sample_TileMesh()
+{
+    cleanup();
+}
+
+void Sample_TileMesh::cleanup()
+{
+    dtFreeNavMesh(m_navMesh);
+    m_navMesh = nullptr;
+}
+
+void Sample_TileMesh::resetCommonSettings() {
+    m_filterLowHangingObstacles = true;
+    m_filterLedgeSpans = true;
+    m_filterWalkableLowHeightSpans = true;
+
+    m_cellSize = 0.3f;
+    m_cellHeight = 0.2f;
+    m_agentHeight = 2.0f;
+    m_agentRadius = 0.6f;
+    m_agentMaxClimb = 0.9f;
+    m_agentMaxSlope = 45.0f;
+    m_regionMinSize = 8;
+    m_regionMergeSize = 20;
+    m_edgeMaxLen = 12.0f;
+    m_edgeMaxError = 1.3f;
+    m_vertsPerPoly = 6.0f;
+    m_detailSampleDist = 6.0f;
+    m_detailSampleMaxError = 1.0f;
+    m_partitionType = SAMPLE_PARTITION_WATERSHED;
+    m_polyPickExtent = { 6.f, 8.f, 6.f };
+    m_tileSize = 64;
+    m_nthreads = 0;
+    m_cacheDirectory.reset();
+}
+
+bool Sample_TileMesh::build()
+{
+    if (!m_geom || !m_geom->getMesh() || !m_geom->getChunkyMesh())
+    {
+        m_ctx->log(RC_LOG_ERROR, "buildTiledNavigation: Input mesh is not specified.");
+        return false;
+    }
+
+    cleanup();
+
+    const float* bmin = m_geom->getNavMeshBoundsMin();
+    const float* bmax = m_geom->getNavMeshBoundsMax();
+
+    // Settings shared by all tiles. The tile bounds are set by "tile_config".
+    memset(&m_cfg, 0, sizeof(m_cfg));
+    m_cfg.cs = m_cellSize;
+    m_cfg.ch = m_cellHeight;
+    m_cfg.walkableSlopeAngle = m_agentMaxSlope;
+    m_cfg.walkableHeight = (int)ceilf(m_agentHeight / m_cfg.ch);
+    m_cfg.walkableClimb = (int)floorf(m_agentMaxClimb / m_cfg.ch);
+    m_cfg.walkableRadius = (int)ceilf(m_agentRadius / m_cfg.cs);
+    m_cfg.maxEdgeLen = (int)(m_edgeMaxLen / m_cellSize);
+    m_cfg.maxSimplificationError = m_edgeMaxError;
+    m_cfg.minRegionArea = (int)rcSqr(m_regionMinSize);        // Note: area = size*size
+    m_cfg.mergeRegionArea = (int)rcSqr(m_regionMergeSize);    // Note: area = size*size
+    m_cfg.maxVertsPerPoly = (int)m_vertsPerPoly;
+    m_cfg.tileSize = (int)m_tileSize;
+    m_cfg.borderSize = m_cfg.walkableRadius + 3; // Reserve enough padding.
+    m_cfg.width = m_cfg.tileSize + m_cfg.borderSize * 2;
+    m_cfg.height = m_cfg.tileSize + m_cfg.borderSize * 2;
+    m_cfg.detailSampleDist = m_detailSampleDist < 0.9f ? 0 : m_cellSize * m_detailSampleDist;
+    m_cfg.detailSampleMaxError = m_cellHeight * m_detailSampleMaxError;
+    rcVcopy(m_cfg.bmin, bmin);
+    rcVcopy(m_cfg.bmax, bmax);
+
+    if ((m_cfg.tileSize <= 0) || (m_cfg.maxVertsPerPoly > DT_VERTS_PER_POLYGON))
+    {
+        m_ctx->log(RC_LOG_ERROR, "buildTiledNavigation: Invalid tile size or polygon size.");
+        return false;
+    }
+
+    int gw = 0;
+    int gh = 0;
+    rcCalcGridSize(bmin, bmax, m_cfg.cs, &gw, &gh);
+    m_tileWidth = (gw + m_cfg.tileSize - 1) / m_cfg.tileSize;
+    m_tileHeight = (gh + m_cfg.tileSize - 1) / m_cfg.tileSize;
+
+    // Detour poly refs have 22 bits for the tile and polygon indices.
+    int tileBits = rcMin((int)dtIlog2(dtNextPow2((unsigned int)(m_tileWidth * m_tileHeight))), 14);
+    int polyBits = 22 - tileBits;
+    if (m_tileWidth * m_tileHeight > (1 << tileBits))
+    {
+        m_ctx->log(RC_LOG_ERROR, "buildTiledNavigation: Too many tiles (%d x %d).", m_tileWidth, m_tileHeight);
+        return false;
+    }
+
+    dtNavMeshParams params;
+    memset(&params, 0, sizeof(params));
+    rcVcopy(params.orig, bmin);
+    params.tileWidth = (float)m_cfg.tileSize * m_cfg.cs;
+    params.tileHeight = (float)m_cfg.tileSize * m_cfg.cs;
+    params.maxTiles = 1 << tileBits;
+    params.maxPolys = 1 << polyBits;
+
+    m_navMesh = dtAllocNavMesh();
+    if (!m_navMesh)
+    {
+        m_ctx->log(RC_LOG_ERROR, "buildTiledNavigation: Could not allocate navmesh.");
+        return false;
+    }
+    if (dtStatusFailed(m_navMesh->init(&params)))
+    {
+        m_ctx->log(RC_LOG_ERROR, "buildTiledNavigation: Could not init navmesh.");
+        return false;
+    }
+    if (!m_query.init(*m_navMesh, m_polyPickExtent))
+    {
+        m_ctx->log(RC_LOG_ERROR, "buildTiledNavigation: Could not init Detour navmesh query");
+        return false;
+    }
+
+    std::vector<NavigationTile> tiles;
+    tiles.reserve((size_t)(m_tileWidth * m_tileHeight));
+    for (int y = 0; y < m_tileHeight; ++y)
+    {
+        for (int x = 0; x < m_tileWidth; ++x)
+        {
+            tiles.push_back({ x, y });
+        }
+    }
+
+    m_ctx->log(RC_LOG_PROGRESS, "Building tiled navigation:");
+    m_ctx->log(RC_LOG_PROGRESS, " - %d x %d tiles of %d x %d cells", m_tileWidth, m_tileHeight, m_cfg.tileSize, m_cfg.tileSize);
+
+    bool success = build_tiles(tiles);
+
+    m_ctx->log(RC_LOG_PROGRESS, ">> %d tiles loaded from cache, %.1f ms", (int)m_ncacheHits, m_totalBuildTimeMs);
+
+    return success;
+}
+
+bool Sample_TileMesh::rebuild_tiles(
+    const InputGeom& geom,
+    const FixedArray<float, 3>& bmin,
+    const FixedArray<float, 3>& bmax)
+{
+    if (!m_navMesh)
+    {
+        m_ctx->log(RC_LOG_ERROR, "rebuildTiles: Navmesh has not been built.");
+        return false;
+    }
+    if (!geom.getMesh() || !geom.getChunkyMesh())
+    {
+        m_ctx->log(RC_LOG_ERROR, "rebuildTiles: Input mesh is not specified.");
+        return false;
+    }
+    m_geom = &geom;
+
+    // Changes affect the neighboring tiles within the border.
+    const float tcs = (float)m_cfg.tileSize * m_cfg.cs;
+    const float border = (float)m_cfg.borderSize * m_cfg.cs;
+    auto tile_index = [&](float v, int d, int n) {
+        return std::clamp((int)std::floor((v - m_cfg.bmin[d]) / tcs), 0, n - 1);
+    };
+    const int tx0 = tile_index(bmin(0) - border, 0, m_tileWidth);
+    const int tx1 = tile_index(bmax(0) + border, 0, m_tileWidth);
+    const int ty0 = tile_index(bmin(2) - border, 2, m_tileHeight);
+    const int ty1 = tile_index(bmax(2) + border, 2, m_tileHeight);
+
+    std::vector<NavigationTile> tiles;
+    for (int y = ty0; y <= ty1; ++y)
+    {
+        for (int x = tx0; x <= tx1; ++x)
+        {
+            tiles.push_back({ x, y });
+        }
+    }
+    return build_tiles(tiles);
+}
+
+rcConfig Sample_TileMesh::tile_config(const NavigationTile& tile) const
+{
+    rcConfig cfg = m_cfg;
+    const float tcs = (float)m_cfg.tileSize * m_cfg.cs;
+    cfg.bmin[0] = m_cfg.bmin[0] + (float)tile.x * tcs;
+    cfg.bmin[2] = m_cfg.bmin[2] + (float)tile.y * tcs;
+    cfg.bmax[0] = m_cfg.bmin[0] + (float)(tile.x + 1) * tcs;
+    cfg.bmax[2] = m_cfg.bmin[2] + (float)(tile.y + 1) * tcs;
+    // Expand the heightfield bounds by the border size, s.t. the
+    // tiles connect seamlessly.
+    cfg.bmin[0] -= (float)cfg.borderSize * cfg.cs;
+    cfg.bmin[2] -= (float)cfg.borderSize * cfg.cs;
+    cfg.bmax[0] += (float)cfg.borderSize * cfg.cs;
+    cfg.bmax[2] += (float)cfg.borderSize * cfg.cs;
+    return cfg;
+}
+
+// Indices of the chunks overlapping the tile, including its border.
+static std::vector<int> overlapping_chunks(const rcChunkyTriMesh& chunkyMesh, const rcConfig& cfg)
+{
+    float tbmin[2] = { cfg.bmin[0], cfg.bmin[2] };
+    float tbmax[2] = { cfg.bmax[0], cfg.bmax[2] };
+    std::vector<int> cid((size_t)chunkyMesh.nnodes);
+    cid.resize((size_t)rcGetChunksOverlappingRect(&chunkyMesh, tbmin, tbmax, cid.data(), (int)cid.size()));
+    return cid;
+}
+
+// Hash of the build settings and of all input triangles overlapping
+// the tile. The triangle hashes are sorted, s.t. the key does not depend
+// on the order of the triangles in the input mesh.
+uint64_t Sample_TileMesh::tile_key(const rcConfig& cfg) const
+{
+    const float* verts = m_geom->getMesh()->getVerts();
+    const rcChunkyTriMesh* chunkyMesh = m_geom->getChunkyMesh();
+
+    // Only the triangles of the overlapping chunks are visited. The
+    // chunks are larger than the tile, so the triangles are filtered
+    // by their bounds, too.
+    std::vector<uint64_t> triangle_hashes;
+    for (int c : overlapping_chunks(*chunkyMesh, cfg))
+    {
+        const rcChunkyTriMeshNode& node = chunkyMesh->nodes[c];
+        const int* ctris = &chunkyMesh->tris[node.i * 3];
+        for (int i = 0; i < node.n; ++i)
+        {
+            const float* v[3] = {
+                &verts[ctris[i * 3 + 0] * 3],
+                &verts[ctris[i * 3 + 1] * 3],
+                &verts[ctris[i * 3 + 2] * 3] };
+            if ((std::max({ v[0][0], v[1][0], v[2][0] }) < cfg.bmin[0]) ||
+                (std::min({ v[0][0], v[1][0], v[2][0] }) > cfg.bmax[0]) ||
+                (std::max({ v[0][2], v[1][2], v[2][2] }) < cfg.bmin[2]) ||
+                (std::min({ v[0][2], v[1][2], v[2][2] }) > cfg.bmax[2]))
+            {
+                continue;
+            }
+            Fnv1a hasher;
+            for (const float* p : v) {
+                hasher.update(std::as_bytes(std::span{ p, 3 }));
+            }
+            triangle_hashes.push_back(hasher.digest());
+        }
+    }
+    std::sort(triangle_hashes.begin(), triangle_hashes.end());
+
+    Fnv1a hasher;
+    hasher.update_value(NAVMESH_TILE_CACHE_VERSION);
+    hasher.update_value(cfg);
+    hasher.update_value(m_agentHeight);
+    hasher.update_value(m_agentRadius);
+    hasher.update_value(m_agentMaxClimb);
+    hasher.update_value(m_partitionType);
+    hasher.update_value(m_filterLowHangingObstacles);
+    hasher.update_value(m_filterLedgeSpans);
+    hasher.update_value(m_filterWalkableLowHeightSpans);
+    hasher.update(std::as_bytes(std::span{ triangle_hashes }));
+    hasher.update(std::as_bytes(std::span{
+        m_geom->getConvexVolumes(),
+        (size_t)m_geom->getConvexVolumeCount() }));
+    const auto noff = (size_t)m_geom->getOffMeshConnectionCount();
+    hasher.update(std::as_bytes(std::span{ m_geom->getOffMeshConnectionVerts(), noff * 6 }));
+    hasher.update(std::as_bytes(std::span{ m_geom->getOffMeshConnectionRads(), noff }));
+    hasher.update(std::as_bytes(std::span{ m_geom->getOffMeshConnectionDirs(), noff }));
+    hasher.update(std::as_bytes(std::span{ m_geom->getOffMeshConnectionAreas(), noff }));
+    hasher.update(std::as_bytes(std::span{ m_geom->getOffMeshConnectionFlags(), noff }));
+    hasher.update(std::as_bytes(std::span{ m_geom->getOffMeshConnectionId(), noff }));
+    return hasher.digest();
+}
+
+// Returns null for empty tiles and throws on errors.
+unsigned char* Sample_TileMesh::build_tile_mesh(
+    rcContext& ctx,
+    const rcConfig& cfg,
+    const NavigationTile& tile,
+    int& dataSize) const
+{
+    dataSize = 0;
+
+    const float* verts = m_geom->getMesh()->getVerts();
+    const int nverts = m_geom->getMesh()->getVertCount();
+    const rcChunkyTriMesh* chunkyMesh = m_geom->getChunkyMesh();
+
+    TileIntermediates t;
+
+    //
+    // Rasterize the triangles overlapping the tile, including its border.
+    //
+
+    t.solid = rcAllocHeightfield();
+    if (!t.solid)
+    {
+        throw std::runtime_error("buildNavigation: Out of memory 'solid'");
+    }
+    if (!rcCreateHeightfield(&ctx, *t.solid, cfg.width, cfg.height, cfg.bmin, cfg.bmax, cfg.cs, cfg.ch))
+    {
+        throw std::runtime_error("buildNavigation: Could not create solid heightfield");
+    }
+
+    const auto cid = overlapping_chunks(*chunkyMesh, cfg);
+    if (cid.empty())
+    {
+        return nullptr;
+    }
+
+    std::vector<unsigned char> triareas((size_t)chunkyMesh->maxTrisPerChunk);
+    for (int c : cid)
+    {
+        const rcChunkyTriMeshNode& node = chunkyMesh->nodes[c];
+        const int* ctris = &chunkyMesh->tris[node.i * 3];
+        const int nctris = node.n;
+        std::fill(triareas.begin(), triareas.begin() + nctris, (unsigned char)0);
+        rcMarkWalkableTriangles(&ctx, cfg.walkableSlopeAngle, verts, nverts, ctris, nctris, triareas.data());
+        if (!rcRasterizeTriangles(&ctx, verts, nverts, ctris, triareas.data(), nctris, *t.solid, cfg.walkableClimb))
+        {
+            throw std::runtime_error("buildNavigation: Could not rasterize triangles");
+        }
+    }
+
+    //
+    // Filter walkable surfaces and partition them, like "Sample_SoloMesh".
+    //
+
+    if (m_filterLowHangingObstacles)
+        rcFilterLowHangingWalkableObstacles(&ctx, cfg.walkableClimb, *t.solid);
+    if (m_filterLedgeSpans)
+        rcFilterLedgeSpans(&ctx, cfg.walkableHeight, cfg.walkableClimb, *t.solid);
+    if (m_filterWalkableLowHeightSpans)
+        rcFilterWalkableLowHeightSpans(&ctx, cfg.walkableHeight, *t.solid);
+
+    t.chf = rcAllocCompactHeightfield();
+    if (!t.chf)
+    {
+        throw std::runtime_error("buildNavigation: Out of memory 'chf'");
+    }
+    if (!rcBuildCompactHeightfield(&ctx, cfg.walkableHeight, cfg.walkableClimb, *t.solid, *t.chf))
+    {
+        throw std::runtime_error("buildNavigation: Could not build compact data");
+    }
+    rcFreeHeightField(t.solid);
+    t.solid = nullptr;
+
+    if (!rcErodeWalkableArea(&ctx, cfg.walkableRadius, *t.chf))
+    {
+        throw std::runtime_error("buildNavigation: Could not erode");
+    }
+
+    const ConvexVolume* vols = m_geom->getConvexVolumes();
+    for (int i = 0; i < m_geom->getConvexVolumeCount(); ++i)
+        rcMarkConvexPolyArea(&ctx, vols[i].verts, vols[i].nverts, vols[i].hmin, vols[i].hmax, (unsigned char)vols[i].area, *t.chf);
+
+    if (m_partitionType == SAMPLE_PARTITION_WATERSHED)
+    {
+        if (!rcBuildDistanceField(&ctx, *t.chf))
+        {
+            throw std::runtime_error("buildNavigation: Could not build distance field");
+        }
+        if (!rcBuildRegions(&ctx, *t.chf, cfg.borderSize, cfg.minRegionArea, cfg.mergeRegionArea))
+        {
+            throw std::runtime_error("buildNavigation: Could not build watershed regions");
+        }
+    }
+    else if (m_partitionType == SAMPLE_PARTITION_MONOTONE)
+    {
+        if (!rcBuildRegionsMonotone(&ctx, *t.chf, cfg.borderSize, cfg.minRegionArea, cfg.mergeRegionArea))
+        {
+            throw std::runtime_error("buildNavigation: Could not build monotone regions");
+        }
+    }
+    else // SAMPLE_PARTITION_LAYERS
+    {
+        if (!rcBuildLayerRegions(&ctx, *t.chf, cfg.borderSize, cfg.minRegionArea))
+        {
+            throw std::runtime_error("buildNavigation: Could not build layer regions");
+        }
+    }
+
+    t.cset = rcAllocContourSet();
+    if (!t.cset)
+    {
+        throw std::runtime_error("buildNavigation: Out of memory 'cset'");
+    }
+    if (!rcBuildContours(&ctx, *t.chf, cfg.maxSimplificationError, cfg.maxEdgeLen, *t.cset))
+    {
+        throw std::runtime_error("buildNavigation: Could not create contours");
+    }
+    if (t.cset->nconts == 0)
+    {
+        return nullptr;
+    }
+
+    t.pmesh = rcAllocPolyMesh();
+    if (!t.pmesh)
+    {
+        throw std::runtime_error("buildNavigation: Out of memory 'pmesh'");
+    }
+    if (!rcBuildPolyMesh(&ctx, *t.cset, cfg.maxVertsPerPoly, *t.pmesh))
+    {
+        throw std::runtime_error("buildNavigation: Could not triangulate contours");
+    }
+
+    t.dmesh = rcAllocPolyMeshDetail();
+    if (!t.dmesh)
+    {
+        throw std::runtime_error("buildNavigation: Out of memory 'pmdtl'");
+    }
+    {
+        TemporarilyIgnoreFloatingPointExeptions ignore_except;
+        if (!rcBuildPolyMeshDetail(&ctx, *t.pmesh, *t.chf, cfg.detailSampleDist, cfg.detailSampleMaxError, *t.dmesh))
+        {
+            throw std::runtime_error("buildNavigation: Could not build detail mesh");
+        }
+    }
+
+    //
+    // Create Detour data from the Recast poly mesh.
+    //
+
+    if (t.pmesh->nverts >= 0xffff)
+    {
+        // The vertex indices are ushorts, and cannot point to more than 0xffff vertices.
+        throw std::runtime_error("buildNavigation: Too many vertices per tile, reduce the tile size");
+    }
+    if (t.pmesh->npolys == 0)
+    {
+        return nullptr;
+    }
+
+    set_sample_poly_flags(*t.pmesh);
+
+    dtNavMeshCreateParams params;
+    memset(&params, 0, sizeof(params));
+    params.verts = t.pmesh->verts;
+    params.vertCount = t.pmesh->nverts;
+    params.polys = t.pmesh->polys;
+    params.polyAreas = t.pmesh->areas;
+    params.polyFlags = t.pmesh->flags;
+    params.polyCount = t.pmesh->npolys;
+    params.nvp = t.pmesh->nvp;
+    params.detailMeshes = t.dmesh->meshes;
+    params.detailVerts = t.dmesh->verts;
+    params.detailVertsCount = t.dmesh->nverts;
+    params.detailTris = t.dmesh->tris;
+    params.detailTriCount = t.dmesh->ntris;
+    params.offMeshConVerts = m_geom->getOffMeshConnectionVerts();
+    params.offMeshConRad = m_geom->getOffMeshConnectionRads();
+    params.offMeshConDir = m_geom->getOffMeshConnectionDirs();
+    params.offMeshConAreas = m_geom->getOffMeshConnectionAreas();
+    params.offMeshConFlags = m_geom->getOffMeshConnectionFlags();
+    params.offMeshConUserID = m_geom->getOffMeshConnectionId();
+    params.offMeshConCount = m_geom->getOffMeshConnectionCount();
+    params.walkableHeight = m_agentHeight;
+    params.walkableRadius = m_agentRadius;
+    params.walkableClimb = m_agentMaxClimb;
+    params.tileX = tile.x;
+    params.tileY = tile.y;
+    params.tileLayer = 0;
+    rcVcopy(params.bmin, t.pmesh->bmin);
+    rcVcopy(params.bmax, t.pmesh->bmax);
+    params.cs = cfg.cs;
+    params.ch = cfg.ch;
+    params.buildBvTree = true;
+
+    unsigned char* navData = nullptr;
+    if (!dtCreateNavMeshData(&params, &navData, &dataSize))
+    {
+        throw std::runtime_error("Could not build Detour navmesh tile");
+    }
+    return navData;
+}
+
+bool Sample_TileMesh::build_tiles(const std::vector<NavigationTile>& tiles)
+{
+    m_ctx->resetTimers();
+    m_ctx->startTimer(RC_TIMER_TOTAL);
+
+    if (m_cacheDirectory.has_value())
+    {
+        create_directories(*m_cacheDirectory);
+    }
+
+    // The tiles are built in parallel, and added to the navmesh on
+    // the calling thread, because "dtNavMesh" is not thread-safe.
+    std::vector<TileResult> results(tiles.size());
+    std::vector<std::exception_ptr> exceptions(tiles.size());
+    int nthreads = (m_nthreads > 0)
+        ? m_nthreads
+        : (int)std::max(1u, std::thread::hardware_concurrency());
+    #pragma omp parallel for schedule(dynamic) num_threads(nthreads)
+    for (int i = 0; i < (int)tiles.size(); ++i) {
+        try {
+            const auto& tile = tiles[(size_t)i];
+            auto& r = results[(size_t)i];
+            auto cfg = tile_config(tile);
+            std::optional<Utf8Path> entry;
+            uint64_t key = 0;
+            if (m_cacheDirectory.has_value()) {
+                key = tile_key(cfg);
+                entry = *m_cacheDirectory / tile_entry_name(key);
+                try {
+                    if (read_tile(*entry, key, r.data, r.dataSize)) {
+                        r.cached = true;
+                        continue;
+                    }
+                } catch (const std::runtime_error& e) {
+                    lwarn() << "Ignoring corrupt navmesh tile cache entry \"" << *entry << "\": " << e.what();
+                }
+            }
+            StderrContext ctx;
+            r.data = build_tile_mesh(ctx, cfg, tile, r.dataSize);
+            if (entry.has_value()) {
+                write_tile(*entry, key, r.data, r.dataSize);
+            }
+        } catch (...) {
+            exceptions[(size_t)i] = std::current_exception();
+        }
+    }
+
+    bool success = true;
+    m_ncacheHits = 0;
+    for (size_t i = 0; i < tiles.size(); ++i)
+    {
+        const auto& tile = tiles[i];
+        auto& r = results[i];
+        if (exceptions[i] != nullptr)
+        {
+            try {
+                std::rethrow_exception(exceptions[i]);
+            } catch (const std::exception& e) {
+                m_ctx->log(RC_LOG_ERROR, "Could not build navmesh tile (%d, %d): %s", tile.x, tile.y, e.what());
+            } catch (...) {
+                m_ctx->log(RC_LOG_ERROR, "Could not build navmesh tile (%d, %d): Unknown exception", tile.x, tile.y);
+            }
+            dtFree(r.data);
+            success = false;
+            continue;
+        }
+        m_ncacheHits += r.cached;
+        // Remove the previous tile, if any.
+        if (dtTileRef ref = m_navMesh->getTileRefAt(tile.x, tile.y, 0); ref != 0)
+        {
+            m_navMesh->removeTile(ref, nullptr, nullptr);
+        }
+        if (r.data == nullptr)
+        {
+            continue;
+        }
+        if (dtStatusFailed(m_navMesh->addTile(r.data, r.dataSize, DT_TILE_FREE_DATA, 0, nullptr)))
+        {
+            dtFree(r.data);
+            m_ctx->log(RC_LOG_ERROR, "Could not add navmesh tile (%d, %d)", tile.x, tile.y);
+            success = false;
+        }
+    }
+
+    m_ctx->stopTimer(RC_TIMER_TOTAL);
+    m_totalBuildTimeMs = (float)m_ctx->getAccumulatedTime(RC_TIMER_TOTAL) / 1000.0f;
+
+    return success;
+}
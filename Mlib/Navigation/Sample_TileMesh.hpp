@@ -0,0 +1,116 @@
+#pragma once
+#include <Mlib/Array/Fixed_Array.hpp>
+#include <Mlib/Misc/Pragma_Clang.hpp>
+#include <Mlib/Navigation/Navigation_Mesh_Query.hpp>
+#include <Mlib/Strings/Utf8_Path.hpp>
+PRAGMA_CLANG_DIAGNOSTIC_PUSH
+PRAGMA_CLANG_DIAGNOSTIC_IGNORED(-Wsign-conversion)
+#include <DetourNavMesh.h>
+#include <Recast.h>
+PRAGMA_CLANG_DIAGNOSTIC_POP
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+class InputGeom;
+
+namespace Mlib {
+
+struct NavigationTile {
+    int x;
+    int y;
+};
+
+// Tiled counterpart of "Sample_SoloMesh".
+// The tiles are rasterized and built in parallel, each one only from the
+// triangles overlapping it, s.t. the memory of the intermediate results
+// is bounded by the tile size.
+// Finished tiles are stored in an optional disk cache, keyed by a hash of
+// their input triangles and of the build settings.
+class Sample_TileMesh
+{
+private:
+    float m_totalBuildTimeMs;
+    size_t m_ncacheHits;
+
+    const InputGeom* m_geom;
+    dtNavMesh* m_navMesh;
+    NavigationMeshQuery m_query;
+    rcContext* m_ctx;
+
+    rcConfig m_cfg;
+    int m_tileWidth;
+    int m_tileHeight;
+
+    void cleanup();
+    rcConfig tile_config(const NavigationTile& tile) const;
+    uint64_t tile_key(const rcConfig& cfg) const;
+    unsigned char* build_tile_mesh(rcContext& ctx, const rcConfig& cfg, const NavigationTile& tile, int& dataSize) const;
+    bool build_tiles(const std::vector<NavigationTile>& tiles);
+
+public:
+    bool m_filterLowHangingObstacles;
+    bool m_filterLedgeSpans;
+    bool m_filterWalkableLowHeightSpans;
+
+    float m_cellSize;
+    float m_cellHeight;
+    float m_agentHeight;
+    float m_agentRadius;
+    float m_agentMaxClimb;
+    float m_agentMaxSlope;
+    float m_regionMinSize;
+    float m_regionMergeSize;
+    float m_edgeMaxLen;
+    float m_edgeMaxError;
+    float m_vertsPerPoly;
+    float m_detailSampleDist;
+    float m_detailSampleMaxError;
+    int m_partitionType;
+    FixedArray<float, 3> m_polyPickExtent;
+    // Tile edge length in cells.
+    float m_tileSize;
+    // Number of build threads, zero for one thread per core.
+    int m_nthreads;
+    // Directory of the tile cache, no caching if not set.
+    std::optional<Utf8Path> m_cacheDirectory;
+
+    Sample_TileMesh(
+        rcContext& ctx,
+        const InputGeom& geom);
+    ~Sample_TileMesh();
+
+    void resetCommonSettings();
+    bool build();
+    // Rebuilds the tiles overlapping the given box, e.g. after objects
+    // inside of it were destroyed. The grid is not changed, s.t. "geom"
+    // must not extend beyond the bounds of the initial geometry.
+    bool rebuild_tiles(
+        const InputGeom& geom,
+        const FixedArray<float, 3>& bmin,
+        const FixedArray<float, 3>& bmax);
+    inline int ntiles_x() const {
+        return m_tileWidth;
+    }
+    inline int ntiles_y() const {
+        return m_tileHeight;
+    }
+    // Number of tiles loaded from the cache by the last build.
+    inline size_t ncache_hits() const {
+        return m_ncacheHits;
+    }
+    inline float total_build_time_ms() const {
+        return m_totalBuildTimeMs;
+    }
+    inline const NavigationMeshQuery& query() const {
+        return m_query;
+    }
+
+private:
+    // Explicitly disabled copy constructor and copy assignment operator.
+    Sample_TileMesh(const Sample_TileMesh&) = delete;
+    Sample_TileMesh& operator=(const Sample_TileMesh&) = delete;
+};
+
+}
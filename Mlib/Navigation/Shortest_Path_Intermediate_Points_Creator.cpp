@@ -3,17 +3,17 @@
 #include <Mlib/Geometry/Exceptions/Point_Exception.hpp>
 #include <Mlib/Math/Fixed_Math.hpp>
 #include <Mlib/Math/Orderable_Fixed_Array.hpp>
-#include <Mlib/Navigation/Sample_SoloMesh.hpp>
+#include <Mlib/Navigation/Navigation_Mesh_Query.hpp>
 #include <Mlib/Stats/Min_Max.hpp>
 #include <stdexcept>
 
 using namespace Mlib;
 
 ShortestPathIntermediatePointsCreator::ShortestPathIntermediatePointsCreator(
-    const Sample_SoloMesh& ssm,
+    const NavigationMeshQuery& navmesh,
     const std::map<OrderableFixedArray<CompressedScenePos, 3>, dtPolyRef>& poly_refs,
     float step_size)
-    : ssm_{ ssm }
+    : navmesh_{ navmesh }
     , poly_refs_{ poly_refs }
     , step_size_{ step_size }
 {}
@@ -31,7 +31,7 @@ UUVector<FixedArray<CompressedScenePos, 3>> ShortestPathIntermediatePointsCreato
         throw PointException{ p1, "Could not find poly for end" };
     }
     try {
-        auto sresult = ssm_.shortest_path(
+        auto sresult = navmesh_.shortest_path(
             LocalizedNavmeshNode{
                 .position = p0.casted<float>(),
                 .polyRef = lp0_it->second},
@@ -13,12 +13,12 @@ class FixedArray;
 template <class TData, size_t... tshape>
 class OrderableFixedArray;
 
-class Sample_SoloMesh;
+class NavigationMeshQuery;
 
 class ShortestPathIntermediatePointsCreator {
 public:
     explicit ShortestPathIntermediatePointsCreator(
-        const Sample_SoloMesh& ssm,
+        const NavigationMeshQuery& navmesh,
         const std::map<OrderableFixedArray<CompressedScenePos, 3>, dtPolyRef>& poly_refs,
         float step_size);
 
@@ -26,7 +26,7 @@ public:
         const FixedArray<CompressedScenePos, 3>& p0,
         const FixedArray<CompressedScenePos, 3>& p1) const;
 private:
-    const Sample_SoloMesh& ssm_;
+    const NavigationMeshQuery& navmesh_;
     const std::map<OrderableFixedArray<CompressedScenePos, 3>, dtPolyRef>& poly_refs_;
     float step_size_;
 };
@@ -10,6 +10,9 @@ namespace Mlib {
 class RenderingResources;
 class RenderableColoredVertexArray;
 class ColoredVertexArrayResource;
+class AggregateCellGrid;
+struct AggregateCell;
+struct AggregateCells;
 
 class AggregateArrayRenderer: public IAggregateRenderer {
     AggregateArrayRenderer(const AggregateArrayRenderer& other) = delete;
@@ -25,6 +28,12 @@ public:
         const std::list<std::shared_ptr<ColoredVertexArray<float>>>& aggregate_queue,
         const ExternalRenderPass& external_render_pass,
         TaskLocation task_location) override;
+    virtual void update_aggregates(
+        const FixedArray<ScenePos, 3>& offset,
+        const std::list<std::pair<TransformationMatrix<float, ScenePos, 3>, std::shared_ptr<ColoredVertexArray<CompressedScenePos>>>>& aggregate_queue,
+        const SceneGraphConfig& scene_graph_config,
+        const ExternalRenderPass& external_render_pass,
+        TaskLocation task_location) override;
     virtual void render_aggregates(
         const FixedArray<ScenePos, 4, 4>& vp,
         const TransformationMatrix<float, ScenePos, 3>& iv,
@@ -38,13 +47,22 @@ public:
     virtual FixedArray<ScenePos, 3> offset() const override;
 
 private:
+    AggregateCell create_cell(
+        const FixedArray<ScenePos, 3>& offset,
+        const std::list<std::shared_ptr<ColoredVertexArray<float>>>& arrays) const;
+    void set_next_cells(
+        const FixedArray<ScenePos, 3>& offset,
+        std::unique_ptr<AggregateCells>&& cells);
     RenderingResources& rendering_resources_;
-    mutable std::unique_ptr<RenderableColoredVertexArray> rcvai_;
-    mutable std::unique_ptr<RenderableColoredVertexArray> next_rcvai_;
+    // Only used by "update_aggregates".
+    std::unique_ptr<AggregateCellGrid> grid_;
+    mutable std::unique_ptr<AggregateCells> cells_;
+    mutable std::unique_ptr<AggregateCells> next_cells_;
     mutable FixedArray<ScenePos, 3> offset_;
     FixedArray<ScenePos, 3> next_offset_;
     mutable FastMutex mutex_;
     bool is_initialized_;
+    bool grid_outdated_;
 };
 
 }
@@ -0,0 +1,208 @@
+#include "Aggregate_Cell_Grid.hpp"
+#include <Mlib/Geometry/Mesh/Colored_Vertex_Array.hpp>
+#include <Mlib/Geometry/Welzl.hpp>
+#include <Mlib/Math/Transformation/Transformation_Matrix.hpp>
+#include <Mlib/OpenGL/Batch_Renderers/Aggregate_Triangles.hpp>
+#include <Mlib/OpenGL/Batch_Renderers/Optional_Material_Hider.hpp>
+#include <Mlib/OpenGL/Batch_Renderers/Optional_Mesh_Hider.hpp>
+#include <Mlib/Scene_Graph/Render_Pass.hpp>
+#include <Mlib/Scene_Graph/Render_Passes.hpp>
+#include <algorithm>
+#include <stdexcept>
+
+using namespace Mlib;
+
+namespace {
+
+struct CellEntry {
+    const IAggregateTriangles* triangles;
+    const Material* material;
+    uint64_t source_id;
+    // "INFINITY" if all triangles are visible.
+    float max_distance;
+};
+
+AggregateCellIndex cell_index(const FixedArray<ScenePos, 3>& position, ScenePos cell_size) {
+    AggregateCellIndex result{ uninitialized };
+    for (size_t i = 0; i < 3; ++i) {
+        result(i) = (int32_t)std::floor(position(i) / cell_size);
+    }
+    return result;
+}
+
+}
+
+AggregateCellGrid::AggregateCellGrid(ScenePos cell_size)
+    : cell_size_{ cell_size }
+    , next_source_id_{ 0 }
+{
+    if (!(cell_size > 0) || std::isinf(cell_size)) {
+        throw std::runtime_error("Aggregate cell size must be positive and finite");
+    }
+}
+
+AggregateCellGrid::~AggregateCellGrid() = default;
+
+AggregateGridUpdate AggregateCellGrid::update(
+    const FixedArray<ScenePos, 3>& camera_position,
+    const Queue& aggregate_queue,
+    const ExternalRenderPass& external_render_pass)
+{
+    OptionalMaterialHider mhd;
+    OptionalMeshHider nhd;
+    auto rng = welzl_rng();
+    for (auto& [_, source] : sources_) {
+        source.used = false;
+    }
+    for (const auto& [m, cva] : aggregate_queue) {
+        if (cva->triangles.empty()) {
+            throw std::runtime_error("Aggregate triangle list is empty: \"" + cva->meta.name.full_name() + '"');
+        }
+        if (nhd.is_hidden(cva->meta.name.full_name())) {
+            continue;
+        }
+        auto mat = cva->meta.material;
+        if (mhd.is_hidden(mat)) {
+            continue;
+        }
+        mat.aggregate_mode = AggregateMode::NONE;
+        auto key = SourceKey{ cva.get(), make_orderable(m.R), make_orderable(m.t) };
+        if (auto it = sources_.find(key); it != sources_.end()) {
+            it->second.used = true;
+            continue;
+        }
+        // The array is transformed relative to the origin of the cell
+        // that contains its origin, which keeps the float coordinates
+        // small, and is then split into the cells.
+        auto anchor = cell_index(m.t, cell_size_).casted<ScenePos>() * cell_size_;
+        auto transformed = cva->transformed<float>(
+            TransformationMatrix<float, ScenePos, 3>{ m.R, m.t - anchor },
+            "_transformed_tm");
+        auto triangles = construct_aggregate_triangles(*transformed, rng, false);
+        Source source{
+            .id = next_source_id_++,
+            .cva = cva,
+            .material = mat,
+            .max_triangle_distance = cva->meta.morphology.max_triangle_distance,
+            .cells = {},
+            .used = true};
+        triangles->split_into_cells(anchor, cell_size_, [&](const AggregateCellIndex& index) -> IAggregateTriangles& {
+            auto it = source.cells.find(index);
+            if (it == source.cells.end()) {
+                it = source.cells.try_emplace(index, SourceCell{
+                    .triangles = triangles->create_empty(),
+                    .aabb = AxisAlignedBoundingBox<float, 3>::empty(),
+                    .max_triangle_radius = 0.f}).first;
+            }
+            return *it->second.triangles;
+        });
+        for (auto& [_, c] : source.cells) {
+            c.triangles->extend_bounds(c.aabb, c.max_triangle_radius);
+        }
+        sources_.try_emplace(key, std::move(source));
+    }
+    std::erase_if(sources_, [](const auto& e){ return !e.second.used; });
+
+    bool is_global = any(external_render_pass.pass & ExternalRenderPassType::IS_GLOBAL_MASK);
+    AggregateGridUpdate result{
+        .changed = {},
+        .removed = {},
+        .sorted = AggregateGridCell{ .offset = camera_position, .arrays = {} }};
+    std::map<AggregateCellIndex, std::vector<CellEntry>> entries;
+    std::map<Material, std::unique_ptr<IAggregateTriangles>> sorted_lists;
+    for (const auto& [_, source] : sources_) {
+        for (const auto& [index, c] : source.cells) {
+            auto camera = (camera_position - index.casted<ScenePos>() * cell_size_).casted<float>();
+            auto max_distance = source.max_triangle_distance;
+            if (is_global) {
+                max_distance = INFINITY;
+            }
+            if (max_distance != INFINITY) {
+                // Every vertex is within the distance, so every
+                // triangle is visible.
+                float farthest2 = 0.f;
+                for (size_t i = 0; i < 3; ++i) {
+                    farthest2 += squared(std::max(std::abs(camera(i) - c.aabb.min(i)), std::abs(camera(i) - c.aabb.max(i))));
+                }
+                if (farthest2 <= squared(max_distance)) {
+                    max_distance = INFINITY;
+                } else if (sum(squared(c.aabb.closest_point(camera) - camera)) > squared(max_distance + c.max_triangle_radius)) {
+                    continue;
+                }
+            }
+            if (any(source.material.blend_mode & BlendMode::ANY_CONTINUOUS)) {
+                auto& l = sorted_lists[source.material];
+                if (l == nullptr) {
+                    l = c.triangles->create_empty();
+                }
+                l->append_visible(*c.triangles, camera, max_distance, true);
+                continue;
+            }
+            entries[index].push_back({
+                .triangles = c.triangles.get(),
+                .material = &source.material,
+                .source_id = source.id,
+                .max_distance = max_distance});
+        }
+    }
+    for (auto& [mat, list] : sorted_lists) {
+        if (!list->empty()) {
+            list->sort();
+            result.sorted.arrays.push_back(build_aggregate_array(mat, *list));
+        }
+    }
+    std::map<AggregateCellIndex, CellContents> cells;
+    for (auto& [index, es] : entries) {
+        std::sort(es.begin(), es.end(), [](const CellEntry& a, const CellEntry& b){ return a.source_id < b.source_id; });
+        auto& contents = cells[index];
+        contents.reserve(es.size());
+        bool is_partial = false;
+        for (const auto& e : es) {
+            contents.emplace_back(e.source_id, (e.max_distance == INFINITY) ? Coverage::COMPLETE : Coverage::PARTIAL);
+            is_partial |= (e.max_distance != INFINITY);
+        }
+        // Partially covered cells depend on the camera position.
+        if (auto it = cells_.find(index); (it != cells_.end()) && (it->second == contents) && !is_partial) {
+            continue;
+        }
+        auto cell_origin = index.casted<ScenePos>() * cell_size_;
+        auto camera = (camera_position - cell_origin).casted<float>();
+        std::map<Material, std::unique_ptr<IAggregateTriangles>> mat_lists;
+        for (const auto& e : es) {
+            auto& l = mat_lists[*e.material];
+            if (l == nullptr) {
+                l = e.triangles->create_empty();
+            }
+            l->append_visible(*e.triangles, camera, e.max_distance, false);
+        }
+        AggregateGridCell cell{ .offset = cell_origin, .arrays = {} };
+        for (auto& [mat, list] : mat_lists) {
+            if (!list->empty()) {
+                cell.arrays.push_back(build_aggregate_array(mat, *list));
+            }
+        }
+        if (cell.arrays.empty()) {
+            if (cells_.contains(index)) {
+                result.removed.push_back(index);
+            }
+        } else {
+            result.changed.try_emplace(index, std::move(cell));
+        }
+    }
+    for (const auto& [index, _] : cells_) {
+        if (!cells.contains(index)) {
+            result.removed.push_back(index);
+        }
+    }
+    cells_ = std::move(cells);
+    return result;
+}
+
+void AggregateCellGrid::clear() {
+    sources_.clear();
+    cells_.clear();
+}
+
+ScenePos AggregateCellGrid::cell_size() const {
+    return cell_size_;
+}
@@ -0,0 +1,94 @@
+#pragma once
+#include <Mlib/Array/Fixed_Array.hpp>
+#include <Mlib/Geometry/Material.hpp>
+#include <Mlib/Geometry/Primitives/Axis_Aligned_Bounding_Box.hpp>
+#include <Mlib/Math/Orderable_Fixed_Array.hpp>
+#include <Mlib/OpenGL/Batch_Renderers/Aggregate_Cell_Index.hpp>
+#include <Mlib/Scene_Config/Scene_Precision.hpp>
+#include <compare>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace Mlib {
+
+template <class TPos>
+class ColoredVertexArray;
+template <class TDir, class TPos, size_t n>
+class TransformationMatrix;
+struct ExternalRenderPass;
+class IAggregateTriangles;
+
+struct AggregateGridCell {
+    // Origin of the vertex positions in "arrays".
+    FixedArray<ScenePos, 3> offset;
+    std::list<std::shared_ptr<ColoredVertexArray<float>>> arrays;
+};
+
+struct AggregateGridUpdate {
+    // Cells whose contents changed, including new cells.
+    std::map<AggregateCellIndex, AggregateGridCell> changed;
+    // Cells that no longer contain any triangles.
+    std::vector<AggregateCellIndex> removed;
+    // Triangles with continuously blended materials, sorted back to front
+    // and relative to the camera. They are rebuilt on every update.
+    AggregateGridCell sorted;
+};
+
+// Static aggregates, grouped into cubic cells in world coordinates.
+// Each source array is split into the cells once, and is identified by
+// its address and its model matrix afterwards. An update therefore only
+// rebuilds the cells whose set of source arrays changed, and the cells
+// on the boundary of the "max_triangle_distance" of a source array.
+class AggregateCellGrid {
+    AggregateCellGrid(const AggregateCellGrid&) = delete;
+    AggregateCellGrid& operator = (const AggregateCellGrid&) = delete;
+public:
+    using Queue = std::list<std::pair<TransformationMatrix<float, ScenePos, 3>, std::shared_ptr<ColoredVertexArray<CompressedScenePos>>>>;
+    explicit AggregateCellGrid(ScenePos cell_size);
+    ~AggregateCellGrid();
+    AggregateGridUpdate update(
+        const FixedArray<ScenePos, 3>& camera_position,
+        const Queue& aggregate_queue,
+        const ExternalRenderPass& external_render_pass);
+    // Forgets all cells, s.t. the next update returns every cell as changed.
+    void clear();
+    ScenePos cell_size() const;
+private:
+    struct SourceKey {
+        const ColoredVertexArray<CompressedScenePos>* cva;
+        OrderableFixedArray<float, 3, 3> rotation;
+        OrderableFixedArray<ScenePos, 3> translation;
+        std::strong_ordering operator <=> (const SourceKey&) const = default;
+    };
+    // Triangles of one source array within one cell,
+    // relative to the cell origin.
+    struct SourceCell {
+        std::unique_ptr<IAggregateTriangles> triangles;
+        AxisAlignedBoundingBox<float, 3> aabb;
+        float max_triangle_radius;
+    };
+    struct Source {
+        uint64_t id;
+        // Keeps the address in the key from being reused.
+        std::shared_ptr<ColoredVertexArray<CompressedScenePos>> cva;
+        Material material;
+        float max_triangle_distance;
+        std::map<AggregateCellIndex, SourceCell> cells;
+        bool used;
+    };
+    enum class Coverage {
+        COMPLETE,
+        PARTIAL
+    };
+    // Sources of a cell, sorted by source id.
+    using CellContents = std::vector<std::pair<uint64_t, Coverage>>;
+    ScenePos cell_size_;
+    uint64_t next_source_id_;
+    std::map<SourceKey, Source> sources_;
+    std::map<AggregateCellIndex, CellContents> cells_;
+};
+
+}
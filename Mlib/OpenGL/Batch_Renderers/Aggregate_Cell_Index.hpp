@@ -0,0 +1,9 @@
+#pragma once
+#include <Mlib/Math/Orderable_Fixed_Array.hpp>
+#include <cstdint>
+
+namespace Mlib {
+
+using AggregateCellIndex = OrderableFixedArray<int32_t, 3>;
+
+}
@@ -0,0 +1,393 @@
+#pragma once
+#include <Mlib/Array/Fixed_Array.hpp>
+#include <Mlib/Geometry/Colored_Vertex.hpp>
+#include <Mlib/Geometry/Material.hpp>
+#include <Mlib/Geometry/Mesh/Colored_Vertex_Array.hpp>
+#include <Mlib/Geometry/Physics_Material.hpp>
+#include <Mlib/Geometry/Primitives/Axis_Aligned_Bounding_Box.hpp>
+#include <Mlib/Geometry/Primitives/Bounding_Sphere.hpp>
+#include <Mlib/Math/Fixed_Math.hpp>
+#include <Mlib/OpenGL/Batch_Renderers/Aggregate_Cell_Index.hpp>
+#include <Mlib/OpenGL/Batch_Renderers/Special_Renderable_Names.hpp>
+#include <Mlib/OpenGL/Yield.hpp>
+#include <Mlib/Scene_Config/Scene_Precision.hpp>
+#include <Mlib/Testing/Assert.hpp>
+#include <cmath>
+#include <functional>
+#include <list>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <thread>
+
+namespace Mlib {
+
+enum class TextureLayerType {
+    NONE,
+    CONTINUOUS,
+    DISCRETE,
+    INTERIORMAP,
+    ALPHA
+};
+
+template <TextureLayerType ttexture_layer_type>
+struct AggregateTriangle;
+
+template <>
+struct AggregateTriangle<TextureLayerType::NONE> {
+    FixedArray<ColoredVertex<float>, 3> triangle;
+    float distance_to_origin2;
+};
+
+template <>
+struct AggregateTriangle<TextureLayerType::CONTINUOUS> {
+    FixedArray<ColoredVertex<float>, 3> triangle;
+    FixedArray<float, 3> continuous_layer;
+    float distance_to_origin2;
+};
+
+template <>
+struct AggregateTriangle<TextureLayerType::DISCRETE> {
+    FixedArray<ColoredVertex<float>, 3> triangle;
+    FixedArray<uint8_t, 3> discrete_layer;
+    float distance_to_origin2;
+};
+
+template <>
+struct AggregateTriangle<TextureLayerType::ALPHA> {
+    FixedArray<ColoredVertex<float>, 3> triangle;
+    FixedArray<float, 3> alpha;
+    float distance_to_origin2;
+};
+
+template <>
+struct AggregateTriangle<TextureLayerType::INTERIORMAP> {
+    FixedArray<ColoredVertex<float>, 3> triangle;
+    FixedArray<float, 4> interiormap_uvmap;
+    float distance_to_origin2;
+};
+
+class IAggregateTriangles {
+public:
+    virtual ~IAggregateTriangles() = default;
+    virtual void append(
+        const ColoredVertexArray<float>& a,
+        std::minstd_rand& rng,
+        bool cull_distant_triangles) = 0;
+    virtual void build(
+        UUVector<FixedArray<ColoredVertex<float>, 3>>& triangles,
+        UUVector<FixedArray<float, 3>>& continuous_triangle_texture_layers,
+        UUVector<FixedArray<uint8_t, 3>>& discrete_triangle_texture_layers,
+        UUVector<FixedArray<float, 3>>& alpha,
+        UUVector<FixedArray<float, 4>>& interiormap_uvmaps) = 0;
+    virtual void sort() = 0;
+    virtual bool empty() const = 0;
+    virtual std::unique_ptr<IAggregateTriangles> create_empty() const = 0;
+    // Moves the triangles into the cells that contain their centers,
+    // making the vertex positions relative to the cell origins.
+    virtual void split_into_cells(
+        const FixedArray<ScenePos, 3>& offset,
+        ScenePos cell_size,
+        const std::function<IAggregateTriangles&(const AggregateCellIndex&)>& cell) = 0;
+    // Extends "aabb" by the vertices, and "max_triangle_radius"
+    // by the radii of the triangle bounding spheres.
+    virtual void extend_bounds(
+        AxisAlignedBoundingBox<float, 3>& aabb,
+        float& max_triangle_radius) const = 0;
+    // Appends the triangles of "other", which must have the same type,
+    // that are closer to "camera_position" than "max_distance".
+    // If "relative_to_camera" is true, the appended vertex positions
+    // are made relative to "camera_position".
+    virtual void append_visible(
+        const IAggregateTriangles& other,
+        const FixedArray<float, 3>& camera_position,
+        float max_distance,
+        bool relative_to_camera) = 0;
+};
+
+template <TextureLayerType ttexture_layer_type>
+struct AggregateTriangles: public IAggregateTriangles {
+public:
+    virtual void append(
+        const ColoredVertexArray<float>& a,
+        std::minstd_rand& rng,
+        bool cull_distant_triangles) override
+    {
+        if (a.triangles.empty()) {
+            throw std::runtime_error("Detected empty triangles in array \"" + a.meta.name.full_name() + '"');
+        }
+        if constexpr (ttexture_layer_type == TextureLayerType::NONE) {
+            if (!a.continuous_triangle_texture_layers.empty()) {
+                throw std::runtime_error("Unexpected continuous texture layers in array \"" + a.meta.name.full_name() + '"');
+            }
+            if (!a.discrete_triangle_texture_layers.empty()) {
+                throw std::runtime_error("Unexpected discrete texture layers in array \"" + a.meta.name.full_name() + '"');
+            }
+            if (!a.alpha.empty()) {
+                throw std::runtime_error("Unexpected alpha in array \"" + a.meta.name.full_name() + '"');
+            }
+            if (!a.interiormap_uvmaps.empty()) {
+                throw std::runtime_error("Unexpected interiormap uscale in array \"" + a.meta.name.full_name() + '"');
+            }
+        }
+        if constexpr (ttexture_layer_type == TextureLayerType::CONTINUOUS) {
+            if (a.continuous_triangle_texture_layers.size() != a.triangles.size()) {
+                throw std::runtime_error("Conflicting number of continuous texture layers in array \"" + a.meta.name.full_name() + '"');
+            }
+            if (!a.discrete_triangle_texture_layers.empty()) {
+                throw std::runtime_error("Unexpected discrete texture layers in array \"" + a.meta.name.full_name() + '"');
+            }
+            if (!a.alpha.empty()) {
+                throw std::runtime_error("Unexpected alpha in array \"" + a.meta.name.full_name() + '"');
+            }
+            if (!a.interiormap_uvmaps.empty()) {
+                throw std::runtime_error("Unexpected interiormap uscale in array \"" + a.meta.name.full_name() + '"');
+            }
+        }
+        if constexpr (ttexture_layer_type == TextureLayerType::DISCRETE) {
+            if (!a.continuous_triangle_texture_layers.empty()) {
+                throw std::runtime_error("Unexpected continuous texture layers in array \"" + a.meta.name.full_name() + '"');
+            }
+            if (a.discrete_triangle_texture_layers.size() != a.triangles.size()) {
+                throw std::runtime_error("Conflicting number of texture layers in array \"" + a.meta.name.full_name() + '"');
+            }
+            if (!a.alpha.empty()) {
+                throw std::runtime_error("Unexpected alpha in array \"" + a.meta.name.full_name() + '"');
+            }
+            if (!a.interiormap_uvmaps.empty()) {
+                throw std::runtime_error("Unexpected interiormap uscale in array \"" + a.meta.name.full_name() + '"');
+            }
+        }
+        if constexpr (ttexture_layer_type == TextureLayerType::INTERIORMAP) {
+            if (!a.continuous_triangle_texture_layers.empty()) {
+                throw std::runtime_error("Unexpected continuous texture layers in array \"" + a.meta.name.full_name() + '"');
+            }
+            if (!a.discrete_triangle_texture_layers.empty()) {
+                throw std::runtime_error("Unexpected discrete texture layers in array \"" + a.meta.name.full_name() + '"');
+            }
+            if (!a.alpha.empty()) {
+                throw std::runtime_error("Unexpected alpha in array \"" + a.meta.name.full_name() + '"');
+            }
+            if (a.interiormap_uvmaps.size() != a.triangles.size()) {
+                throw std::runtime_error("Conflicting number of interiormap uscale in array \"" + a.meta.name.full_name() + '"');
+            }
+        }
+        if constexpr (ttexture_layer_type == TextureLayerType::ALPHA) {
+            if (!a.continuous_triangle_texture_layers.empty()) {
+                throw std::runtime_error("Unexpected continuous texture layers in array \"" + a.meta.name.full_name() + '"');
+            }
+            if (!a.discrete_triangle_texture_layers.empty()) {
+                throw std::runtime_error("Unexpected discrete texture layers in array \"" + a.meta.name.full_name() + '"');
+            }
+            if (a.alpha.size() != a.triangles.size()) {
+                throw std::runtime_error("Conflicting number of alphas in array \"" + a.meta.name.full_name() + '"');
+            }
+            if (!a.interiormap_uvmaps.empty()) {
+                throw std::runtime_error("Unexpected interiormap uscale in array \"" + a.meta.name.full_name() + '"');
+            }
+        }
+        auto camera_sphere = BoundingSphere<float, 3>{ fixed_zeros<float, 3>(), a.meta.morphology.max_triangle_distance };
+        for (size_t i = 0; i < a.triangles.size(); ++i) {
+            if (i % THREAD_YIELD_INTERVAL == 0) {
+                std::this_thread::yield();
+            }
+            const auto& c = a.triangles[i];
+            // auto triangle_sphere = welzl_from_fixed(FixedArray<FixedArray<float, 3>, 3>{ c(0).position, c(1).position, c(2).position }, rng);
+            auto triangle_sphere = BoundingSphere<float, 3>{ FixedArray<float, 3, 3>{ c(0).position, c(1).position, c(2).position } };
+            if (cull_distant_triangles &&
+                (a.meta.morphology.max_triangle_distance != INFINITY) &&
+                !camera_sphere.intersects(triangle_sphere))
+            {
+                continue;
+            }
+            auto distance_to_origin2 = sum(squared(triangle_sphere.center));
+            if constexpr (ttexture_layer_type == TextureLayerType::NONE) {
+                atriangles_.push_back({ c, distance_to_origin2 });
+            }
+            if constexpr (ttexture_layer_type == TextureLayerType::CONTINUOUS) {
+                atriangles_.push_back({ c, a.continuous_triangle_texture_layers[i], distance_to_origin2 });
+            }
+            if constexpr (ttexture_layer_type == TextureLayerType::DISCRETE) {
+                atriangles_.push_back({ c, a.discrete_triangle_texture_layers[i], distance_to_origin2 });
+            }
+            if constexpr (ttexture_layer_type == TextureLayerType::ALPHA) {
+                atriangles_.push_back({ c, a.alpha[i], distance_to_origin2 });
+            }
+            if constexpr (ttexture_layer_type == TextureLayerType::INTERIORMAP) {
+                atriangles_.push_back({ c, a.interiormap_uvmaps[i], distance_to_origin2 });
+            }
+        }
+    }
+    virtual void build(
+        UUVector<FixedArray<ColoredVertex<float>, 3>>& triangles,
+        UUVector<FixedArray<float, 3>>& continuous_triangle_texture_layers,
+        UUVector<FixedArray<uint8_t, 3>>& discrete_triangle_texture_layers,
+        UUVector<FixedArray<float, 3>>& alpha,
+        UUVector<FixedArray<float, 4>>& interiormap_uvmaps) override
+    {
+        assert_true(triangles.empty());
+        assert_true(continuous_triangle_texture_layers.empty());
+        assert_true(discrete_triangle_texture_layers.empty());
+        assert_true(alpha.empty());
+        assert_true(interiormap_uvmaps.empty());
+        triangles.reserve(atriangles_.size());
+        if constexpr (ttexture_layer_type == TextureLayerType::CONTINUOUS) {
+            continuous_triangle_texture_layers.reserve(atriangles_.size());
+        }
+        if constexpr (ttexture_layer_type == TextureLayerType::DISCRETE) {
+            discrete_triangle_texture_layers.reserve(atriangles_.size());
+        }
+        if constexpr (ttexture_layer_type == TextureLayerType::ALPHA) {
+            alpha.reserve(atriangles_.size());
+        }
+        if constexpr (ttexture_layer_type == TextureLayerType::INTERIORMAP) {
+            interiormap_uvmaps.reserve(atriangles_.size());
+        }
+        for (const auto& a : atriangles_) {
+            triangles.emplace_back(a.triangle);
+            if constexpr (ttexture_layer_type == TextureLayerType::CONTINUOUS) {
+                continuous_triangle_texture_layers.emplace_back(a.continuous_layer);
+            }
+            if constexpr (ttexture_layer_type == TextureLayerType::DISCRETE) {
+                discrete_triangle_texture_layers.emplace_back(a.discrete_layer);
+            }
+            if constexpr (ttexture_layer_type == TextureLayerType::ALPHA) {
+                alpha.emplace_back(a.alpha);
+            }
+            if constexpr (ttexture_layer_type == TextureLayerType::INTERIORMAP) {
+                interiormap_uvmaps.emplace_back(a.interiormap_uvmap);
+            }
+        }
+    }
+    virtual void sort() override {
+        atriangles_.sort([](
+            const AggregateTriangle<ttexture_layer_type>& a,
+            const AggregateTriangle<ttexture_layer_type>& b)
+            {
+                return a.distance_to_origin2 > b.distance_to_origin2;
+            });
+    }
+    virtual bool empty() const override {
+        return atriangles_.empty();
+    }
+    virtual std::unique_ptr<IAggregateTriangles> create_empty() const override {
+        return std::make_unique<AggregateTriangles>();
+    }
+    virtual void split_into_cells(
+        const FixedArray<ScenePos, 3>& offset,
+        ScenePos cell_size,
+        const std::function<IAggregateTriangles&(const AggregateCellIndex&)>& cell) override
+    {
+        while (!atriangles_.empty()) {
+            auto& a = atriangles_.front();
+            auto center = offset + ((a.triangle(0).position + a.triangle(1).position + a.triangle(2).position) / 3.f).template casted<ScenePos>();
+            AggregateCellIndex index{ uninitialized };
+            for (size_t i = 0; i < 3; ++i) {
+                index(i) = (int32_t)std::floor(center(i) / cell_size);
+            }
+            auto cell_offset = index.template casted<ScenePos>() * cell_size;
+            for (auto& v : a.triangle.flat_iterable()) {
+                v.position = (offset + v.position.template casted<ScenePos>() - cell_offset).template casted<float>();
+            }
+            auto& dst = dynamic_cast<AggregateTriangles&>(cell(index));
+            dst.atriangles_.splice(dst.atriangles_.end(), atriangles_, atriangles_.begin());
+        }
+    }
+    virtual void extend_bounds(
+        AxisAlignedBoundingBox<float, 3>& aabb,
+        float& max_triangle_radius) const override
+    {
+        for (const auto& a : atriangles_) {
+            auto triangle_sphere = BoundingSphere<float, 3>{ FixedArray<float, 3, 3>{
+                a.triangle(0).position, a.triangle(1).position, a.triangle(2).position } };
+            for (const auto& v : a.triangle.flat_iterable()) {
+                aabb.extend(v.position);
+            }
+            max_triangle_radius = std::max(max_triangle_radius, triangle_sphere.radius);
+        }
+    }
+    virtual void append_visible(
+        const IAggregateTriangles& other,
+        const FixedArray<float, 3>& camera_position,
+        float max_distance,
+        bool relative_to_camera) override
+    {
+        auto camera_sphere = BoundingSphere<float, 3>{ camera_position, max_distance };
+        const auto* o = dynamic_cast<const AggregateTriangles*>(&other);
+        if (o == nullptr) {
+            throw std::runtime_error("Conflicting texture layer types in aggregate triangles");
+        }
+        for (const auto& a : o->atriangles_) {
+            auto triangle_sphere = BoundingSphere<float, 3>{ FixedArray<float, 3, 3>{
+                a.triangle(0).position, a.triangle(1).position, a.triangle(2).position } };
+            if ((max_distance != INFINITY) && !camera_sphere.intersects(triangle_sphere)) {
+                continue;
+            }
+            auto& d = atriangles_.emplace_back(a);
+            if (relative_to_camera) {
+                for (auto& v : d.triangle.flat_iterable()) {
+                    v.position -= camera_position;
+                }
+                d.distance_to_origin2 = sum(squared(triangle_sphere.center - camera_position));
+            }
+        }
+    }
+private:
+    std::list<AggregateTriangle<ttexture_layer_type>> atriangles_;
+};
+
+inline std::unique_ptr<IAggregateTriangles> construct_aggregate_triangles(
+    const ColoredVertexArray<float>& a,
+    std::minstd_rand& rng,
+    bool cull_distant_triangles)
+{
+    std::unique_ptr<IAggregateTriangles> result;
+    if (!a.continuous_triangle_texture_layers.empty() &&
+        !a.discrete_triangle_texture_layers.empty())
+    {
+        throw std::runtime_error("Detected continuous and discrete texture layers");
+    }
+    if (!a.continuous_triangle_texture_layers.empty()) {
+        result = std::make_unique<AggregateTriangles<TextureLayerType::CONTINUOUS>>();
+    } else if (!a.discrete_triangle_texture_layers.empty()) {
+        result = std::make_unique<AggregateTriangles<TextureLayerType::DISCRETE>>();
+    } else if (!a.alpha.empty()) {
+        result = std::make_unique<AggregateTriangles<TextureLayerType::ALPHA>>();
+    } else if (!a.interiormap_uvmaps.empty()) {
+        result = std::make_unique<AggregateTriangles<TextureLayerType::INTERIORMAP>>();
+    } else {
+        result = std::make_unique<AggregateTriangles<TextureLayerType::NONE>>();
+    }
+    result->append(a, rng, cull_distant_triangles);
+    return result;
+}
+
+// Merges the triangles into a single array.
+inline std::shared_ptr<ColoredVertexArray<float>> build_aggregate_array(
+    const Material& material,
+    IAggregateTriangles& list)
+{
+    UUVector<FixedArray<ColoredVertex<float>, 3>> triangles;
+    UUVector<FixedArray<float, 3>> continuous_texture_layers;
+    UUVector<FixedArray<uint8_t, 3>> discrete_texture_layers;
+    UUVector<FixedArray<float, 3>> alphas;
+    UUVector<FixedArray<float, 4>> interiormap_uvmaps;
+    list.build(triangles, continuous_texture_layers, discrete_texture_layers, alphas, interiormap_uvmaps);
+    return std::make_shared<ColoredVertexArray<float>>(
+        *AAR_NAME,
+        material,
+        Morphology{ .physics_material = PhysicsMaterial::ATTR_VISIBLE },
+        ModifierBacklog{},
+        UUVector<FixedArray<ColoredVertex<float>, 4>>(),
+        std::move(triangles),
+        UUVector<FixedArray<ColoredVertex<float>, 2>>(),
+        UUVector<FixedArray<std::vector<BoneWeight>, 3>>(),
+        std::move(continuous_texture_layers),
+        std::move(discrete_texture_layers),
+        std::vector<UUVector<FixedArray<float, 3, 2>>>(),
+        std::vector<UUVector<FixedArray<float, 3>>>(),
+        std::move(alphas),
+        std::move(interiormap_uvmaps));
+}
+
+}
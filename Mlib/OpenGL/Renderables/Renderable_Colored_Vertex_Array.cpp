@@ -537,16 +537,14 @@ void RenderableColoredVertexArray::append_sorted_aggregates_to_queue(
 
 void RenderableColoredVertexArray::append_large_aggregates_to_queue(
     const TransformationMatrix<SceneDir, ScenePos, 3>& m,
-    const FixedArray<ScenePos, 3>& offset,
     const SceneGraphConfig& scene_graph_config,
-    std::list<std::shared_ptr<ColoredVertexArray<float>>>& aggregate_queue) const
+    std::list<std::pair<TransformationMatrix<SceneDir, ScenePos, 3>, std::shared_ptr<ColoredVertexArray<CompressedScenePos>>>>& aggregate_queue) const
 {
     #ifdef WITHOUT_GRAPHICS
     throw std::runtime_error("RenderableColoredVertexArray::append_large_aggregates_to_queue called without graphics support");
     #else
     for (const auto& cva : aggregate_once_) {
-        TransformationMatrix<SceneDir, ScenePos, 3> mo{m.R, m.t - offset};
-        aggregate_queue.push_back(cva->transformed<float>(mo, "_transformed_tm"));
+        aggregate_queue.emplace_back(m, cva);
     }
     #endif
 }
@@ -61,9 +61,8 @@ public:
         std::list<std::pair<float, std::shared_ptr<ColoredVertexArray<float>>>>& aggregate_queue) const override;
     virtual void append_large_aggregates_to_queue(
         const TransformationMatrix<SceneDir, ScenePos, 3>& m,
-        const FixedArray<ScenePos, 3>& offset,
         const SceneGraphConfig& scene_graph_config,
-        std::list<std::shared_ptr<ColoredVertexArray<float>>>& aggregate_queue) const override;
+        std::list<std::pair<TransformationMatrix<SceneDir, ScenePos, 3>, std::shared_ptr<ColoredVertexArray<CompressedScenePos>>>>& aggregate_queue) const override;
     virtual void append_sorted_instances_to_queue(
         const FixedArray<ScenePos, 4, 4>& mvp,
         const TransformationMatrix<SceneDir, ScenePos, 3>& m,
@@ -650,11 +650,11 @@ void RenderingResources::print(std::ostream& ostr, size_t indentation) const {
     std::string indent = std::string(indentation, ' ');
     ostr << indent << "Name: " << name_ << '\n';
     ostr << indent << "Texture descriptors\n";
-    for (const auto& [n, _] : texture_descriptors_) {
+    for (const auto& n : texture_descriptors_.keys()) {
         ostr << indent << "  " << *n << '\n';
     }
     ostr << indent << "Blend map textures\n";
-    for (const auto& [n, _] : blend_map_textures_) {
+    for (const auto& n : blend_map_textures_.keys()) {
         ostr << indent << "  " << *n << '\n';
     }
     ostr << indent << "Textures\n";
@@ -662,7 +662,7 @@ void RenderingResources::print(std::ostream& ostr, size_t indentation) const {
         ostr << indent << "  " << n << '\n';
     }
     ostr << indent << "Aliases\n";
-    for (const auto& [n, _] : aliases_) {
+    for (const auto& n : aliases_.keys()) {
         ostr << indent << "  " << *n << '\n';
     }
     ostr << indent << "vps\n";
@@ -697,9 +697,7 @@ RenderingResources::RenderingResources(
     , texture_targets_{
         "Texture types",
         [](const ColormapWithModifiers& e) { return e.filename.string(); } }
-    , texture_descriptors_{
-        "Texture descriptor",
-        [](const VariableAndHash<std::string>& e) { return *e; } }
+    , texture_descriptors_{ "Texture descriptor" }
     , textures_{ "Texture", [](const ColormapWithModifiers& e) { return e.filename.string(); } }
     , texture_sizes_{ "Texture size" }
     , manual_atlas_tile_descriptors_{ "Manual atlas tile descriptor" }
@@ -7,6 +7,7 @@
 #include <Mlib/Geometry/Texture/Uv_Tile.hpp>
 #include <Mlib/Hashing/Variable_And_Hash.hpp>
 #include <Mlib/Images/Transform/Coefficient_Image_Cache.hpp>
+#include <Mlib/Map/Rcu_String_With_Hash_Unordered_Map.hpp>
 #include <Mlib/Map/Threadsafe_Map.hpp>
 #include <Mlib/Map/Threadsafe_String_With_Hash_Unordered_Map.hpp>
 #include <Mlib/Map/Threadsafe_Unordered_Map.hpp>
@@ -301,23 +302,23 @@ private:
     mutable ThreadsafeUnorderedMap<ColormapWithModifiers, FlippedTextureData> preloaded_raw_texture_data_;
     mutable ThreadsafeUnorderedMap<ColormapWithModifiers, FlippedTextureData> preloaded_texture_dds_data_;
     mutable VerboseUnorderedMap<ColormapWithModifiers, TextureTarget> texture_targets_;
-    mutable ThreadsafeUnorderedMap<VariableAndHash<std::string>, TextureDescriptor> texture_descriptors_;
+    mutable RcuStringWithHashUnorderedMap<TextureDescriptor> texture_descriptors_;
     mutable VerboseUnorderedMap<ColormapWithModifiers, TextureHandleAndOwner> textures_;
     mutable ThreadsafeStringWithHashUnorderedMap<TextureSize> texture_sizes_;
-    mutable ThreadsafeStringWithHashUnorderedMap<ManualTextureAtlasDescriptor> manual_atlas_tile_descriptors_;
+    mutable RcuStringWithHashUnorderedMap<ManualTextureAtlasDescriptor> manual_atlas_tile_descriptors_;
     mutable ThreadsafeUnorderedMap<ColormapWithModifiers, AutoTextureAtlasDescriptor> auto_atlas_tile_descriptors_;
-    mutable ThreadsafeStringWithHashUnorderedMap<CubemapDescriptor> cubemap_descriptors_;
-    mutable ThreadsafeStringWithHashUnorderedMap<ColormapWithModifiers> colormap_variable_descriptors_;
-    mutable ThreadsafeStringWithHashUnorderedMap<ColormapWithModifiers> colormap_file_descriptors_;
+    mutable RcuStringWithHashUnorderedMap<CubemapDescriptor> cubemap_descriptors_;
+    mutable RcuStringWithHashUnorderedMap<ColormapWithModifiers> colormap_variable_descriptors_;
+    mutable RcuStringWithHashUnorderedMap<ColormapWithModifiers> colormap_file_descriptors_;
     mutable ThreadsafeStringWithHashUnorderedMap<std::unordered_map<char32_t, uint32_t>> charsets_;
     mutable VerboseUnorderedMap<FontNameAndHeight, LoadedFont> font_textures_;
     ThreadsafeUnorderedMap<FPath, TextureWarnFlags> suppressed_warnings_;
-    ThreadsafeStringWithHashUnorderedMap<FPath> aliases_;
+    RcuStringWithHashUnorderedMap<FPath> aliases_;
     ThreadsafeStringWithHashUnorderedMap<FixedArray<ScenePos, 4, 4>> vps_;
     ThreadsafeStringWithHashUnorderedMap<float> offsets_;
     ThreadsafeStringWithHashUnorderedMap<float> discreteness_;
     ThreadsafeStringWithHashUnorderedMap<float> scales_;
-    ThreadsafeStringWithHashUnorderedMap<BlendMapTexture> blend_map_textures_;
+    RcuStringWithHashUnorderedMap<BlendMapTexture> blend_map_textures_;
     mutable VerboseMap<RenderProgramIdentifier, std::unique_ptr<ColoredRenderProgram>> render_programs_;
     mutable SafeAtomicSharedMutex render_programs_mutex_;
     std::string name_;
@@ -3,6 +3,8 @@
 #include <Mlib/Memory/Deallocation_Token.hpp>
 #include <Mlib/OpenGL/Any_Gl.hpp>
 #include <Mlib/Initialization/Default_Uninitialized_Vector.hpp>
+#include <cstdint>
+#include <vector>
 
 namespace Mlib {
 
@@ -17,8 +19,13 @@ public:
     ~DynamicBase();
     void append(const tvalue_type& v);
     void remove(size_t index);
+    // Keeps the instances at the ascending indices "survivors",
+    // preserving their order.
+    void compact(const std::vector<uint32_t>& survivors);
     void clear();
     tvalue_type& operator [] (size_t index);
+    const tvalue_type& operator [] (size_t index) const;
+    tvalue_type* data();
     void update();
     void bind() const;
     size_t size() const;    // for debugging purposes only
@@ -67,6 +67,17 @@ void DynamicBase<tvalue_type>::remove(size_t index) {
     }
 }
 
+template <class tvalue_type>
+void DynamicBase<tvalue_type>::compact(const std::vector<uint32_t>& survivors) {
+    if (survivors.size() > num_instances_) {
+        throw std::runtime_error("Too many survivors");
+    }
+    for (size_t i = 0; i < survivors.size(); ++i) {
+        instances_[i] = instances_[survivors[i]];
+    }
+    num_instances_ = survivors.size();
+}
+
 template <class tvalue_type>
 void DynamicBase<tvalue_type>::clear() {
     num_instances_ = 0;
@@ -80,6 +91,16 @@ tvalue_type& DynamicBase<tvalue_type>::operator [] (size_t index) {
     return instances_[index];
 }
 
+template <class tvalue_type>
+const tvalue_type& DynamicBase<tvalue_type>::operator [] (size_t index) const {
+    return const_cast<DynamicBase<tvalue_type>&>(*this)[index];
+}
+
+template <class tvalue_type>
+tvalue_type* DynamicBase<tvalue_type>::data() {
+    return instances_.data();
+}
+
 template <class tvalue_type>
 void DynamicBase<tvalue_type>::update() {
     if (num_instances_ == 0) {
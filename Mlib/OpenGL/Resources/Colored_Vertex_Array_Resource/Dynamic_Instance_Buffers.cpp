@@ -8,12 +8,31 @@
 #include <Mlib/Physics/Units.hpp>
 #include <Mlib/Scene_Graph/Instances/Transformation_And_Billboard_Id.hpp>
 #include <Mlib/Scene_Graph/Render/Batch_Renderers/Task_Location.hpp>
+#include <cfloat>
+#include <cmath>
 #include <mutex>
 #include <stdexcept>
 #include <unordered_map>
 
 using namespace Mlib;
 
+InternalParticleProperties::InternalParticleProperties(size_t max_num_instances)
+    : time(max_num_instances)
+    , velocity_x(max_num_instances)
+    , velocity_y(max_num_instances)
+    , velocity_z(max_num_instances)
+    , air_resistance_halflife(max_num_instances)
+{}
+
+InternalParticleProperties::~InternalParticleProperties() = default;
+
+template <class T>
+static void compact(std::vector<T>& v, const std::vector<uint32_t>& survivors) {
+    for (size_t i = 0; i < survivors.size(); ++i) {
+        v[i] = v[survivors[i]];
+    }
+}
+
 DynamicInstanceBuffers::DynamicInstanceBuffers(
     TransformationMode transformation_mode,
     size_t max_num_instances,
@@ -39,6 +58,8 @@ DynamicInstanceBuffers::DynamicInstanceBuffers(
     if (num_billboard_atlas_components > 0) {
         animation_times_.resize(max_num_instances);
         billboard_sequences_.resize(max_num_instances);
+        dt_.resize(max_num_instances);
+        survivors_.reserve(max_num_instances);
     }
     if (max_num_instances > std::numeric_limits<GLsizei>::max()) {
         throw std::runtime_error("Maximum number of instances too large");
@@ -85,7 +106,11 @@ void DynamicInstanceBuffers::append(
     if (transformation_mode_ == TransformationMode::ALL) {
         rotation_quaternion_.append(m);
     }
-    particle_properties_[tmp_num_instances_] = { time, velocity, air_resistance_halflife};
+    particle_properties_.time[tmp_num_instances_] = time;
+    particle_properties_.velocity_x[tmp_num_instances_] = velocity(0);
+    particle_properties_.velocity_y[tmp_num_instances_] = velocity(1);
+    particle_properties_.velocity_z[tmp_num_instances_] = velocity(2);
+    particle_properties_.air_resistance_halflife[tmp_num_instances_] = air_resistance_halflife;
     if (num_billboard_atlas_components_ != 0) {
         billboard_ids_.append(m);
         if (has_per_instance_continuous_texture_layer_) {
@@ -108,79 +133,117 @@ void DynamicInstanceBuffers::move_renderables(std::chrono::steady_clock::time_po
     if (clear_on_update_ == ClearOnUpdate::YES) {
         return;
     }
-    for (size_t i = 0; i < tmp_length();) {
-        auto& ai = animation_times_[i];
-        auto& bi = billboard_sequences_[i];
-        auto& props = particle_properties_[i];
-        float dt = std::chrono::duration<float>(time - props.time).count() * seconds;
-        if (dt <= 0) {
-            ++i;
-            continue;
-        }
-        props.time = time;
-        auto advance_position = [&](FixedArray<float, 3>& position) {
-            position += props.velocity * dt;
-            if (props.air_resistance_halflife != INFINITY) {
-                auto alpha = std::pow(0.5f, dt / props.air_resistance_halflife);
-                props.velocity = lerp(props.velocity, wind_vector_, 1.f - alpha);
-            }
-        };
-        if (transformation_mode_ == TransformationMode::POSITION_YANGLE) {
-            advance_position(position_yangles_[i].row_range<0, 3>());
-        } else if ((transformation_mode_ == TransformationMode::POSITION) ||
-                   (transformation_mode_ == TransformationMode::POSITION_FLAT) ||
-                   (transformation_mode_ == TransformationMode::POSITION_LOOKAT) ||
-                   (transformation_mode_ == TransformationMode::ALL))
-        {
-            advance_position(position_[i]);
-        } else {
-            throw std::runtime_error("Unknown transformation mode: " +  std::to_string((int)transformation_mode_));
+    switch (transformation_mode_) {
+    case TransformationMode::POSITION_YANGLE:
+        move_renderables<TransformationMode::POSITION_YANGLE>(time);
+        return;
+    case TransformationMode::POSITION:
+    case TransformationMode::POSITION_FLAT:
+    case TransformationMode::POSITION_LOOKAT:
+        move_renderables<TransformationMode::POSITION>(time);
+        return;
+    case TransformationMode::ALL:
+        move_renderables<TransformationMode::ALL>(time);
+        return;
+    }
+    throw std::runtime_error("Unknown transformation mode: " +  std::to_string((int)transformation_mode_));
+}
+
+template <TransformationMode ttransformation_mode>
+void DynamicInstanceBuffers::move_renderables(std::chrono::steady_clock::time_point time) {
+    size_t n = tmp_num_instances_;
+    float* dt = dt_.data();
+    float* vx = particle_properties_.velocity_x.data();
+    float* vy = particle_properties_.velocity_y.data();
+    float* vz = particle_properties_.velocity_z.data();
+    const float* halflife = particle_properties_.air_resistance_halflife.data();
+    auto* t = particle_properties_.time.data();
+    // Particles appended after "time" are not moved.
+    for (size_t i = 0; i < n; ++i) {
+        float dti = std::chrono::duration<float>(time - t[i]).count() * seconds;
+        dt[i] = std::max(dti, 0.f);
+        t[i] = (dti > 0.f) ? time : t[i];
+    }
+    // Integration, branch-free for all particles. An infinite
+    // half-life yields "beta = 0", i.e. no air resistance.
+    // Clamping the half-life avoids "0 / 0" for particles with
+    // "dt = 0" and a half-life of zero, which otherwise yield NaN.
+    auto integrate = [&]<class TPosition>(TPosition* positions) {
+        float wx = wind_vector_(0);
+        float wy = wind_vector_(1);
+        float wz = wind_vector_(2);
+        for (size_t i = 0; i < n; ++i) {
+            auto& p = positions[i];
+            p(0) += vx[i] * dt[i];
+            p(1) += vy[i] * dt[i];
+            p(2) += vz[i] * dt[i];
+            float beta = 1.f - std::exp2(-dt[i] / std::max(halflife[i], FLT_MIN));
+            vx[i] += (wx - vx[i]) * beta;
+            vy[i] += (wy - vy[i]) * beta;
+            vz[i] += (wz - vz[i]) * beta;
         }
-        if (bi->duration == INFINITY) {
-            ++i;
+    };
+    if constexpr (ttransformation_mode == TransformationMode::POSITION_YANGLE) {
+        integrate(position_yangles_.data());
+    } else {
+        integrate(position_.data());
+    }
+    // Animation frames. Expired particles are compacted
+    // in a single stable pass afterwards.
+    float* animation_times = animation_times_.data();
+    BillboardId* billboard_ids = billboard_ids_.data();
+    float* texture_layers = has_per_instance_continuous_texture_layer_
+        ? texture_layers_->data()
+        : nullptr;
+    survivors_.resize(n);
+    uint32_t* survivors = survivors_.data();
+    size_t nsurvivors = 0;
+    for (size_t i = 0; i < n; ++i) {
+        const auto& bi = *billboard_sequences_[i];
+        float& ai = animation_times[i];
+        ai += dt[i];
+        bool alive = (ai < bi.duration);
+        survivors[nsurvivors] = (uint32_t)i;
+        nsurvivors += alive;
+        if (!alive || (bi.duration == INFINITY) || (dt[i] == 0.f)) {
             continue;
         }
-        ai += dt;
-        if (ai < bi->duration) {
-            auto frame_index = (size_t)frame_index_from_animation_state(
-                ai,
-                bi->duration,
-                bi->billboard_ids.size());
-            if (frame_index >= bi->billboard_ids.size()) {
-                throw std::runtime_error("Frame index too large");
-            }
-            billboard_ids_[i] = bi->billboard_ids[frame_index];
-            if (has_per_instance_continuous_texture_layer_) {
-                (*texture_layers_)[i] = ai / bi->duration * bi->final_texture_w;
-            }
-            ++i;
-        } else {
-            if (transformation_mode_ == TransformationMode::POSITION_YANGLE) {
-                position_yangles_.remove(i);
-            } else if ((transformation_mode_ == TransformationMode::POSITION) ||
-                       (transformation_mode_ == TransformationMode::POSITION_FLAT) ||
-                       (transformation_mode_ == TransformationMode::POSITION_LOOKAT) ||
-                       (transformation_mode_ == TransformationMode::ALL))
-            {
-                position_.remove(i);
-            } else {
-                throw std::runtime_error("Unknown transformation mode: " +  std::to_string((int)transformation_mode_));
-            }
-            if (transformation_mode_ == TransformationMode::ALL) {
-                rotation_quaternion_.remove(i);
-            }
-            billboard_ids_.remove(i);
-            if (has_per_instance_continuous_texture_layer_) {
-                texture_layers_->remove(i);
-            }
-            --tmp_num_instances_;
-            if (tmp_num_instances_ != 0) {
-                ai = animation_times_[tmp_num_instances_];
-                bi = billboard_sequences_[tmp_num_instances_];
-                props = particle_properties_[tmp_num_instances_];
-            }
+        auto frame_index = (size_t)frame_index_from_animation_state(
+            ai,
+            bi.duration,
+            integral_cast<uint32_t>(bi.billboard_ids.size()));
+        if (frame_index >= bi.billboard_ids.size()) {
+            throw std::runtime_error("Frame index too large");
+        }
+        billboard_ids[i] = bi.billboard_ids[frame_index];
+        if (texture_layers != nullptr) {
+            texture_layers[i] = ai / bi.duration * bi.final_texture_w;
         }
     }
+    survivors_.resize(nsurvivors);
+    if (nsurvivors == n) {
+        return;
+    }
+    if constexpr (ttransformation_mode == TransformationMode::POSITION_YANGLE) {
+        position_yangles_.compact(survivors_);
+    } else {
+        position_.compact(survivors_);
+    }
+    if constexpr (ttransformation_mode == TransformationMode::ALL) {
+        rotation_quaternion_.compact(survivors_);
+    }
+    billboard_ids_.compact(survivors_);
+    if (has_per_instance_continuous_texture_layer_) {
+        texture_layers_->compact(survivors_);
+    }
+    compact(animation_times_, survivors_);
+    compact(billboard_sequences_, survivors_);
+    compact(particle_properties_.time, survivors_);
+    compact(particle_properties_.velocity_x, survivors_);
+    compact(particle_properties_.velocity_y, survivors_);
+    compact(particle_properties_.velocity_z, survivors_);
+    compact(particle_properties_.air_resistance_halflife, survivors_);
+    tmp_num_instances_ = nsurvivors;
 }
 
 size_t DynamicInstanceBuffers::capacity() const {
@@ -195,6 +258,17 @@ bool DynamicInstanceBuffers::tmp_empty() const {
     return tmp_num_instances_ == 0;
 }
 
+FixedArray<float, 3> DynamicInstanceBuffers::tmp_position(size_t index) const {
+    if (transformation_mode_ == TransformationMode::POSITION_YANGLE) {
+        return position_yangles_[index].row_range<0, 3>();
+    }
+    return position_[index];
+}
+
+BillboardId DynamicInstanceBuffers::tmp_billboard_id(size_t index) const {
+    return billboard_ids_[index];
+}
+
 void DynamicInstanceBuffers::update(const SortedVertexArrayInstances& host_instances) {
     throw std::runtime_error("DynamicInstanceBuffers cannot update array instances");
 }
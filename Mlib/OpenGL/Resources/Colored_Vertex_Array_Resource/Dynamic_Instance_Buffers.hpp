@@ -23,10 +23,16 @@ enum class TransformationMode;
 enum class ClearOnUpdate;
 struct StaticWorld;
 
+// Particle state in structure-of-arrays layout, s.t.
+// "move_renderables" processes several particles per SIMD register.
 struct InternalParticleProperties {
-    std::chrono::steady_clock::time_point time;
-    FixedArray<float, 3> velocity = uninitialized;
-    float air_resistance_halflife;
+    explicit InternalParticleProperties(size_t max_num_instances);
+    ~InternalParticleProperties();
+    std::vector<std::chrono::steady_clock::time_point> time;
+    std::vector<float> velocity_x;
+    std::vector<float> velocity_y;
+    std::vector<float> velocity_z;
+    std::vector<float> air_resistance_halflife;
 };
 
 class DynamicInstanceBuffers: public IGpuInstanceBuffers {
@@ -53,6 +59,12 @@ public:
     size_t capacity() const;
     size_t tmp_length() const;
     bool tmp_empty() const;
+    // Advances the particles without uploading them to the GPU.
+    // "update" calls this, it is public for testing purposes.
+    void move_renderables(std::chrono::steady_clock::time_point time);
+    // For testing purposes.
+    FixedArray<float, 3> tmp_position(size_t index) const;
+    BillboardId tmp_billboard_id(size_t index) const;
 
     // IGpuInstanceBuffers
     void update(
@@ -70,13 +82,14 @@ public:
     virtual bool has_continuous_texture_layer() const override;
     virtual void print_stats(std::ostream& ostr) const override;
 private:
+    template <TransformationMode ttransformation_mode>
     void move_renderables(std::chrono::steady_clock::time_point time);
 
     DynamicPositionYAngles position_yangles_;
     DynamicPosition position_;
     DynamicRotationQuaternion rotation_quaternion_;
     DynamicBillboardIds billboard_ids_;
-    std::vector<InternalParticleProperties> particle_properties_;
+    InternalParticleProperties particle_properties_;
     std::optional<DynamicInstanceContinuousTextureLayer> texture_layers_;
     size_t max_num_instances_;
     BillboardId num_billboard_atlas_components_;
@@ -86,6 +99,8 @@ private:
     TransformationMode transformation_mode_;
     std::vector<float> animation_times_;
     std::vector<const BillboardSequence*> billboard_sequences_;
+    std::vector<float> dt_;
+    std::vector<uint32_t> survivors_;
     ClearOnUpdate clear_on_update_;
     FixedArray<float, 3> wind_vector_;
     std::chrono::steady_clock::time_point latest_update_time_;
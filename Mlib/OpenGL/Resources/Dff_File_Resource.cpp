@@ -1,28 +1,40 @@
 #include "Dff_File_Resource.hpp"
 #include <Mlib/Geometry/Mesh/Animated_Colored_Vertex_Arrays.hpp>
+#include <Mlib/Geometry/Mesh/Load/Draw_Distance_Db.hpp>
 #include <Mlib/Geometry/Mesh/Load/Load_Dff_Array.hpp>
+#include <Mlib/Geometry/Mesh/Load/Mesh_Cache.hpp>
 #include <Mlib/OpenGL/Resources/Heterogeneous_Resource.hpp>
 #include <Mlib/Scene_Config/Scene_Precision.hpp>
 
 using namespace Mlib;
 
+static std::vector<Utf8Path> dff_dependencies(
+    const Utf8Path& container,
+    const DrawDistanceDb& dddb)
+{
+    std::vector<Utf8Path> result{ container };
+    result.insert(result.end(), dddb.source_files().begin(), dddb.source_files().end());
+    return result;
+}
+
 template <class TPos>
 std::shared_ptr<ISceneNodeResource> Mlib::load_renderable_dff(
     std::istream& istr,
+    const Utf8Path& container,
     const std::string& name,
     const LoadMeshConfig<TPos>& cfg,
     const SceneNodeResources& scene_node_resources,
     const DrawDistanceDb& dddb)
 {
+    auto load = [&](){
+        auto acvas = std::make_shared<AnimatedColoredVertexArrays>();
+        auto trafo = FrameTransformation::ZERO_POSITION | FrameTransformation::IDENTITY_ROTATION;
+        acvas->template cvas<TPos>() = load_dff(istr, name, cfg, dddb, trafo).renderables;
+        return acvas;
+    };
     auto hr = std::make_shared<HeterogeneousResource>(scene_node_resources);
-    auto trafo = FrameTransformation::ZERO_POSITION | FrameTransformation::IDENTITY_ROTATION;
-    if constexpr (std::is_same_v<TPos, float>) {
-        hr->acvas->scvas = load_dff(istr, name, cfg, dddb, trafo).renderables;
-    } else if constexpr (std::is_same_v<TPos, CompressedScenePos>) {
-        hr->acvas->dcvas = load_dff(istr, name, cfg, dddb, trafo).renderables;
-    } else {
-        throw std::runtime_error("Unknown mesh precision");
-    }
+    // An archive contains many models, so the entry name is part of the loader name.
+    hr->acvas = load_mesh_cached(dff_dependencies(container, dddb), "dff:" + name, cfg, load);
     return hr;
 }
 
@@ -33,15 +45,14 @@ std::shared_ptr<ISceneNodeResource> Mlib::load_renderable_dff(
     const SceneNodeResources& scene_node_resources,
     const DrawDistanceDb& dddb)
 {
+    auto load = [&](){
+        auto acvas = std::make_shared<AnimatedColoredVertexArrays>();
+        auto trafo = FrameTransformation::ZERO_POSITION | FrameTransformation::IDENTITY_ROTATION;
+        acvas->template cvas<TPos>() = load_dff(filename, cfg, dddb, trafo).renderables;
+        return acvas;
+    };
     auto hr = std::make_shared<HeterogeneousResource>(scene_node_resources);
-    auto trafo = FrameTransformation::ZERO_POSITION | FrameTransformation::IDENTITY_ROTATION;
-    if constexpr (std::is_same_v<TPos, float>) {
-        hr->acvas->scvas = load_dff(filename, cfg, dddb, trafo).renderables;
-    } else if constexpr (std::is_same_v<TPos, CompressedScenePos>) {
-        hr->acvas->dcvas = load_dff(filename, cfg, dddb, trafo).renderables;
-    } else {
-        throw std::runtime_error("Unknown mesh precision");
-    }
+    hr->acvas = load_mesh_cached(dff_dependencies(filename, dddb), "dff", cfg, load);
     return hr;
 }
 
@@ -49,6 +60,7 @@ namespace Mlib {
 
 template std::shared_ptr<ISceneNodeResource> load_renderable_dff<float>(
     std::istream& istr,
+    const Utf8Path& container,
     const std::string& name,
     const LoadMeshConfig<float>& cfg,
     const SceneNodeResources& scene_node_resources,
@@ -56,6 +68,7 @@ template std::shared_ptr<ISceneNodeResource> load_renderable_dff<float>(
 
 template std::shared_ptr<ISceneNodeResource> load_renderable_dff<CompressedScenePos>(
     std::istream& istr,
+    const Utf8Path& container,
     const std::string& name,
     const LoadMeshConfig<CompressedScenePos>& cfg,
     const SceneNodeResources& scene_node_resources,
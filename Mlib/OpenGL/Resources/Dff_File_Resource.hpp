@@ -12,9 +12,11 @@ class ISceneNodeResource;
 class SceneNodeResources;
 class DrawDistanceDb;
 
+// "container" is the file "istr" was opened from, e.g. an IMG archive.
 template <class TPos>
 std::shared_ptr<ISceneNodeResource> load_renderable_dff(
     std::istream& istr,
+    const Utf8Path& container,
     const std::string& name,
     const LoadMeshConfig<TPos>& cfg,
     const SceneNodeResources& scene_node_resources,
@@ -1,6 +1,7 @@
 #include "Kn5_File_Resource.hpp"
 #include <Mlib/Geometry/Mesh/Animated_Colored_Vertex_Arrays.hpp>
 #include <Mlib/Geometry/Mesh/Load/Load_Kn5_Array.hpp>
+#include <Mlib/Geometry/Mesh/Load/Mesh_Cache.hpp>
 #include <Mlib/OpenGL/Resources/Heterogeneous_Resource.hpp>
 #include <Mlib/Scene_Config/Scene_Precision.hpp>
 #include <Mlib/Scene_Graph/Resources/Scene_Node_Resources.hpp>
@@ -17,13 +18,29 @@ std::shared_ptr<ISceneNodeResource> Mlib::load_renderable_kn5(
     #endif
     IRaceLogic* race_logic)
 {
+    // The textures and the race logic are always recorded, s.t. the
+    // cache entry does not depend on which targets the caller passes.
+    auto load = [&](MeshSideEffects& side_effects){
+        auto acvas = std::make_shared<AnimatedColoredVertexArrays>();
+        acvas->template cvas<TPos>() = load_kn5_array<TPos>(
+            file_or_directory,
+            cfg,
+            #ifndef WITHOUT_GRAPHICS
+            &side_effects,
+            #endif
+            &side_effects);
+        return acvas;
+    };
+    #ifdef WITHOUT_GRAPHICS
+    IDdsResources* dds_resources = nullptr;
+    #endif
     auto hr = std::make_shared<HeterogeneousResource>(scene_node_resources);
-    hr->acvas->template cvas<TPos>() = load_kn5_array<TPos>(
-        file_or_directory,
+    hr->acvas = load_mesh_cached(
+        kn5_dependencies(file_or_directory),
+        "kn5",
         cfg,
-        #ifndef WITHOUT_GRAPHICS
+        load,
         dds_resources,
-        #endif
         race_logic);
     return hr;
 }
@@ -2,6 +2,7 @@
 #include <Mlib/Geometry/Mesh/Animated_Colored_Vertex_Arrays.hpp>
 #include <Mlib/Geometry/Mesh/Bone.hpp>
 #include <Mlib/Geometry/Mesh/Load/Load_Mhx2.hpp>
+#include <Mlib/Geometry/Mesh/Load/Mesh_Cache.hpp>
 #include <Mlib/OpenGL/Resources/Colored_Vertex_Array_Resource.hpp>
 #include <stdexcept>
 
@@ -12,7 +13,9 @@ Mhx2FileResource::Mhx2FileResource(
     const LoadMeshConfig<float>& cfg)
     : ISceneNodeResource{"Mhx2FileResource"}
 {
-    acvas_ = load_mhx2(filename, cfg);
+    acvas_ = load_mesh_cached<float>({ filename }, "mhx2", cfg, [&](){
+        return load_mhx2(filename, cfg);
+    });
     rva_ = std::make_shared<ColoredVertexArrayResource>(acvas_);
 #ifdef DEBUG
     acvas_->check_consistency();
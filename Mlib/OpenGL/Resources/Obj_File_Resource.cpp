@@ -1,6 +1,7 @@
 #include "Obj_File_Resource.hpp"
 #include <Mlib/Geometry/Mesh/Animated_Colored_Vertex_Arrays.hpp>
 #include <Mlib/Geometry/Mesh/Load/Load_Obj.hpp>
+#include <Mlib/Geometry/Mesh/Load/Mesh_Cache.hpp>
 #include <Mlib/OpenGL/Resources/Heterogeneous_Resource.hpp>
 
 using namespace Mlib;
@@ -11,13 +12,16 @@ std::shared_ptr<ISceneNodeResource> Mlib::load_renderable_obj(
     const LoadMeshConfig<TPos>& cfg,
     const SceneNodeResources& scene_node_resources)
 {
+    auto load = [&](){
+        auto acvas = std::make_shared<AnimatedColoredVertexArrays>();
+        acvas->template cvas<TPos>() = load_obj<TPos>(filename, cfg);
+        return acvas;
+    };
     auto hr = std::make_shared<HeterogeneousResource>(scene_node_resources);
-    if constexpr (std::is_same_v<TPos, float>) {
-        hr->acvas->scvas = load_obj<float>(filename, cfg);
-    } else if constexpr (std::is_same_v<TPos, CompressedScenePos>) {
-        hr->acvas->dcvas = load_obj<CompressedScenePos>(filename, cfg);
+    if (mesh_cache_directory().has_value()) {
+        hr->acvas = load_mesh_cached(obj_dependencies(filename), "obj", cfg, load);
     } else {
-        throw std::runtime_error("Unknown mesh precision");
+        hr->acvas = load();
     }
     return hr;
 }
@@ -0,0 +1,108 @@
+#include "Mapped_File.hpp"
+#include <Mlib/Os/Os.hpp>
+#include <stdexcept>
+
+#if defined(__ANDROID__) || defined(__EMSCRIPTEN__)
+#define MAPPED_FILE_READ_ALL
+#elif defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace Mlib;
+
+#if defined(MAPPED_FILE_READ_ALL)
+
+MappedFile::MappedFile(const Utf8Path& filename)
+    : buffer_{ read_file_bytes(filename) }
+{
+    data_ = buffer_.data();
+    size_ = buffer_.size();
+}
+
+MappedFile::~MappedFile() = default;
+
+#elif defined(_WIN32)
+
+MappedFile::MappedFile(const Utf8Path& filename)
+    : data_{ nullptr }
+    , size_{ 0 }
+    , file_{ INVALID_HANDLE_VALUE }
+    , mapping_{ nullptr }
+{
+    const std::filesystem::path& path = filename;
+    file_ = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file_ == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("Could not open file \"" + filename.string() + '"');
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file_, &size)) {
+        CloseHandle(file_);
+        throw std::runtime_error("Could not determine size of file \"" + filename.string() + '"');
+    }
+    size_ = (size_t)size.QuadPart;
+    if (size_ == 0) {
+        return;
+    }
+    mapping_ = CreateFileMappingW(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping_ == nullptr) {
+        CloseHandle(file_);
+        throw std::runtime_error("Could not map file \"" + filename.string() + '"');
+    }
+    data_ = (const std::byte*)MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0);
+    if (data_ == nullptr) {
+        CloseHandle(mapping_);
+        CloseHandle(file_);
+        throw std::runtime_error("Could not map view of file \"" + filename.string() + '"');
+    }
+}
+
+MappedFile::~MappedFile() {
+    if (data_ != nullptr) {
+        UnmapViewOfFile(data_);
+    }
+    if (mapping_ != nullptr) {
+        CloseHandle(mapping_);
+    }
+    CloseHandle(file_);
+}
+
+#else
+
+MappedFile::MappedFile(const Utf8Path& filename)
+    : data_{ nullptr }
+    , size_{ 0 }
+{
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd == -1) {
+        throw std::runtime_error("Could not open file \"" + filename.string() + '"');
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        throw std::runtime_error("Could not determine size of file \"" + filename.string() + '"');
+    }
+    size_ = (size_t)st.st_size;
+    if (size_ != 0) {
+        void* data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            close(fd);
+            throw std::runtime_error("Could not map file \"" + filename.string() + '"');
+        }
+        data_ = (const std::byte*)data;
+    }
+    // The mapping remains valid after closing the file descriptor.
+    close(fd);
+}
+
+MappedFile::~MappedFile() {
+    if (data_ != nullptr) {
+        munmap(const_cast<std::byte*>(data_), size_);
+    }
+}
+
+#endif
@@ -0,0 +1,34 @@
+#pragma once
+#include <Mlib/Strings/Utf8_Path.hpp>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace Mlib {
+
+// Read-only view of a whole file. The file is memory-mapped where the
+// OS supports it, s.t. only the pages that are accessed are loaded.
+// Otherwise (e.g. for Android assets), the file is read into memory.
+class MappedFile {
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator = (const MappedFile&) = delete;
+public:
+    explicit MappedFile(const Utf8Path& filename);
+    ~MappedFile();
+    inline std::span<const std::byte> data() const {
+        return { data_, size_ };
+    }
+    inline size_t size() const {
+        return size_;
+    }
+private:
+    const std::byte* data_;
+    size_t size_;
+    std::vector<std::byte> buffer_;
+#ifdef _WIN32
+    void* file_;
+    void* mapping_;
+#endif
+};
+
+}
@@ -2,9 +2,19 @@
 #include "Class_Fwd.hpp"
 #include <Mlib/Os/Io/Binary_Bitwise_Words_Reader.hpp>
 #include <Mlib/Os/Io/Binary_Bitwise_Words_Writer.hpp>
+#include <Mlib/Os/Io/Serialize/Serialization_Context_Read.hpp>
+#include <Mlib/Os/Io/Serialize/Serialization_Context_Write.hpp>
 
 namespace Mlib {
 
+bool WritingArchive::allows_local_paths() const {
+    return (writer_.ctx != nullptr) && writer_.ctx->allow_local_paths;
+}
+
+bool ReadingArchive::allows_local_paths() const {
+    return (reader_.ctx != nullptr) && reader_.ctx->allow_local_paths;
+}
+
 template <HasSerializeNoSharedPtr T>
 void save(
     BinaryBitwiseWordsWriter& writer,
@@ -82,6 +82,7 @@ public:
     void operator () (const auto& element) {
         save(writer_, element, message_);
     }
+    inline bool allows_local_paths() const;
 private:
     BinaryBitwiseWordsWriter& writer_;
     std::string_view message_;
@@ -101,6 +102,7 @@ public:
     void operator () (auto& element) {
         load(reader_, element, message_);
     }
+    inline bool allows_local_paths() const;
 private:
     BinaryBitwiseWordsReader& reader_;
     std::string_view message_;
@@ -13,6 +13,8 @@ public:
         objects_.emplace(0, nullptr);
     }
     ~SerializationContextRead() = default;
+    // Local file paths are only meaningful on this machine, e.g. in a disk cache.
+    bool allow_local_paths = false;
     template <class T>
     inline std::optional<std::shared_ptr<T>> try_get(uint32_t index) {
         auto res = objects_.find(index);
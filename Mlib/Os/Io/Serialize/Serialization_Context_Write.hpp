@@ -12,6 +12,8 @@ public:
         objects_.emplace(nullptr, 0);
     }
     ~SerializationContextWrite() = default;
+    // Local file paths are only meaningful on this machine, e.g. in a disk cache.
+    bool allow_local_paths = false;
     inline std::pair<uint32_t, bool> add_or_get(const std::shared_ptr<Object>& obj) {
         auto res = objects_.try_emplace(obj, objects_.size());
         return {res.first->second, res.second};
@@ -0,0 +1,583 @@
+#include "Async_Log.hpp"
+#include <Mlib/Os/Threads/J_Thread.hpp>
+#include <Mlib/Os/Threads/Thread_Local.hpp>
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <condition_variable>
+#include <csignal>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <vector>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace Mlib;
+
+static const size_t MAX_LOG_RINGS = 256;
+static const uint32_t LOG_DUMP_MAGIC = 0x474f4c4d; // "MLOG"
+
+namespace {
+
+struct LogRingDumpHeader {
+    uint32_t magic;
+    uint32_t capacity;
+    uint64_t head;
+    uint64_t tail;
+};
+
+class LogRing {
+    LogRing(const LogRing&) = delete;
+    LogRing& operator = (const LogRing&) = delete;
+public:
+    explicit LogRing(size_t capacity)
+        : records_(capacity)
+        , head_{ 0 }
+        , tail_{ 0 }
+        , orphaned_{ false }
+        , ndropped_{ 0 }
+    {}
+    size_t capacity() const {
+        return records_.size();
+    }
+    // Producer side. "fill" is called for the "n" consecutive records
+    // of a message, which are published together.
+    // Returns false if the ring is full.
+    template <class TFill>
+    bool push(size_t n, const TFill& fill) {
+        auto tail = tail_.load(std::memory_order_relaxed);
+        auto head = head_.load(std::memory_order_acquire);
+        if (capacity() - (size_t)(tail - head) < n) {
+            return false;
+        }
+        for (size_t i = 0; i < n; ++i) {
+            fill(records_[(tail + i) & (capacity() - 1)], i);
+        }
+        tail_.store(tail + n, std::memory_order_release);
+        return true;
+    }
+    // Consumer side.
+    const LogRecord* front() const {
+        auto head = head_.load(std::memory_order_relaxed);
+        if (head == tail_.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        return &records_[head & (capacity() - 1)];
+    }
+    void pop() {
+        head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+    void count_dropped() {
+        ndropped_.fetch_add(1, std::memory_order_relaxed);
+    }
+    uint64_t ndropped() const {
+        return ndropped_.load(std::memory_order_relaxed);
+    }
+    void orphan() {
+        orphaned_.store(true, std::memory_order_release);
+    }
+    bool try_adopt() {
+        bool expected = true;
+        return orphaned_.compare_exchange_strong(expected, false, std::memory_order_acq_rel);
+    }
+    // Only calls async-signal-safe functions.
+    template <class TWrite>
+    void dump(const TWrite& write) const {
+        LogRingDumpHeader header{
+            .magic = LOG_DUMP_MAGIC,
+            .capacity = (uint32_t)capacity(),
+            .head = head_.load(std::memory_order_relaxed),
+            .tail = tail_.load(std::memory_order_relaxed)
+        };
+        write(&header, sizeof(header));
+        write(records_.data(), records_.size() * sizeof(LogRecord));
+    }
+private:
+    std::vector<LogRecord> records_;
+    std::atomic<uint64_t> head_;
+    std::atomic<uint64_t> tail_;
+    std::atomic<bool> orphaned_;
+    std::atomic<uint64_t> ndropped_;
+};
+
+// Marks the ring as orphaned when the thread exits, s.t. the next
+// thread that starts logging can adopt it.
+struct ThreadLogRing {
+    LogRing* ring = nullptr;
+    ~ThreadLogRing() {
+        if (ring != nullptr) {
+            ring->orphan();
+        }
+    }
+};
+
+struct DrainedMessage {
+    uint64_t sequence;
+    LogChannel channel;
+    std::string text;
+};
+
+}
+
+// The rings are never deleted, because threads that log during
+// static destruction may still reference them.
+static std::atomic<LogRing*> g_rings[MAX_LOG_RINGS];
+static std::atomic<size_t> g_nrings = 0;
+static std::mutex g_rings_mutex;
+static THREAD_LOCAL(ThreadLogRing) g_thread_ring = ThreadLogRing{};
+static THREAD_LOCAL(bool) g_is_drain_thread = false;
+
+static std::atomic<bool> g_async_enabled = false;
+static std::atomic<uint32_t> g_npushing = 0;
+static std::atomic<uint64_t> g_sequence = 1;
+static std::atomic<size_t> g_ring_capacity = 1024;
+
+static std::mutex g_drain_mutex;
+static std::condition_variable g_drain_cv;
+static std::condition_variable g_drained_cv;
+static uint64_t g_ndrain_rounds = 0;
+static uint64_t g_drain_rounds_target = 0;
+static bool g_drain_running = false;
+static std::unique_ptr<JThread> g_drain_thread;
+static std::mutex g_start_stop_mutex;
+
+static int g_crash_dump_fd = -1;
+
+static LogRing* thread_ring() {
+    ThreadLogRing& t = g_thread_ring;
+    if (t.ring != nullptr) {
+        return t.ring;
+    }
+    std::scoped_lock lock{ g_rings_mutex };
+    size_t n = g_nrings.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < n; ++i) {
+        auto* ring = g_rings[i].load(std::memory_order_relaxed);
+        if (ring->try_adopt()) {
+            t.ring = ring;
+            return ring;
+        }
+    }
+    if (n == MAX_LOG_RINGS) {
+        return nullptr;
+    }
+    t.ring = new LogRing{ g_ring_capacity.load(std::memory_order_relaxed) };
+    g_rings[n].store(t.ring, std::memory_order_release);
+    g_nrings.store(n + 1, std::memory_order_release);
+    return t.ring;
+}
+
+static int64_t microseconds_since_epoch() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+static bool push_message(
+    LogChannel channel,
+    std::string_view text,
+    const LogArgs* args)
+{
+    struct PushingGuard {
+        PushingGuard() { g_npushing.fetch_add(1); }
+        ~PushingGuard() { g_npushing.fetch_sub(1); }
+    } pushing_guard;
+    if (!g_async_enabled.load()) {
+        return false;
+    }
+    // The drain thread cannot wait for itself.
+    if (g_is_drain_thread) {
+        return false;
+    }
+    auto* ring = thread_ring();
+    if (ring == nullptr) {
+        return false;
+    }
+    size_t nrecords = std::max<size_t>(1, (text.size() + LOG_RECORD_TEXT_NBYTES - 1) / LOG_RECORD_TEXT_NBYTES);
+    if (nrecords > ring->capacity()) {
+        return false;
+    }
+    auto sequence = g_sequence.fetch_add(1, std::memory_order_relaxed);
+    auto time = microseconds_since_epoch();
+    auto fill = [&](LogRecord& r, size_t i) {
+        r.sequence = sequence;
+        r.microseconds_since_epoch = time;
+        r.channel = channel;
+        r.deferred = (args != nullptr);
+        r.continuation = (i != 0);
+        r.nargs = (i == 0) && (args != nullptr) ? args->nargs : 0;
+        r.ncontinuations = (i == 0) ? (uint16_t)(nrecords - 1) : 0;
+        auto chunk = text.substr(i * LOG_RECORD_TEXT_NBYTES, LOG_RECORD_TEXT_NBYTES);
+        r.length = (uint16_t)chunk.size();
+        std::memcpy(r.text, chunk.data(), chunk.size());
+        if (r.nargs != 0) {
+            std::copy(args->types, args->types + r.nargs, r.arg_types);
+            std::copy(args->values, args->values + r.nargs, r.args);
+        }
+    };
+    while (!ring->push(nrecords, fill)) {
+        // Other messages are dropped and counted, and are
+        // not written synchronously to keep the caller fast.
+        if (channel != LogChannel::ERROR) {
+            ring->count_dropped();
+            return true;
+        }
+        // Errors must not get lost, so wait until the drain thread
+        // made room, or write them synchronously if it was stopped.
+        flush_async_log();
+        if (!g_async_enabled.load()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static std::string format_arg(LogArgType type, uint64_t value) {
+    switch (type) {
+    case LogArgType::INT:
+        return std::to_string((int64_t)value);
+    case LogArgType::UINT:
+        return std::to_string(value);
+    case LogArgType::DOUBLE:
+        {
+            char buf[32];
+            auto res = std::to_chars(buf, buf + sizeof(buf), std::bit_cast<double>(value));
+            return std::string(buf, res.ptr);
+        }
+    case LogArgType::BOOL:
+        return value ? "true" : "false";
+    case LogArgType::CHAR:
+        return std::string(1, (char)value);
+    }
+    return "<unknown log argument type>";
+}
+
+std::string Mlib::format_log_args(
+    std::string_view format,
+    const LogArgType* types,
+    const uint64_t* values,
+    size_t nargs)
+{
+    std::string result;
+    result.reserve(format.size() + 16 * nargs);
+    size_t iarg = 0;
+    size_t last = 0;
+    size_t next;
+    while ((next = format.find("{}", last)) != std::string_view::npos) {
+        result += format.substr(last, next - last);
+        if (iarg < nargs) {
+            result += format_arg(types[iarg], values[iarg]);
+            ++iarg;
+        } else {
+            result += "{}";
+        }
+        last = next + 2;
+    }
+    result += format.substr(last);
+    return result;
+}
+
+static void drain_rings(std::vector<DrainedMessage>& messages) {
+    size_t n = g_nrings.load(std::memory_order_acquire);
+    for (size_t i = 0; i < n; ++i) {
+        auto* ring = g_rings[i].load(std::memory_order_acquire);
+        while (const auto* head = ring->front()) {
+            DrainedMessage m{
+                .sequence = head->sequence,
+                .channel = head->channel,
+                .text = std::string(head->text, head->length)};
+            bool deferred = head->deferred;
+            LogArgType types[LOG_RECORD_MAX_ARGS];
+            uint64_t values[LOG_RECORD_MAX_ARGS];
+            size_t nargs = head->nargs;
+            std::copy(head->arg_types, head->arg_types + nargs, types);
+            std::copy(head->args, head->args + nargs, values);
+            size_t ncontinuations = head->ncontinuations;
+            ring->pop();
+            for (size_t c = 0; c < ncontinuations; ++c) {
+                const auto* r = ring->front();
+                if (r == nullptr) {
+                    verbose_abort("Log message was not published atomically");
+                }
+                m.text.append(r->text, r->length);
+                ring->pop();
+            }
+            if (deferred) {
+                m.text = format_log_args(m.text, types, values, nargs);
+            }
+            messages.push_back(std::move(m));
+        }
+    }
+    std::sort(messages.begin(), messages.end(), [](const auto& a, const auto& b){
+        return a.sequence < b.sequence;
+    });
+}
+
+static uint64_t total_ndropped() {
+    uint64_t result = 0;
+    size_t n = g_nrings.load(std::memory_order_acquire);
+    for (size_t i = 0; i < n; ++i) {
+        result += g_rings[i].load(std::memory_order_acquire)->ndropped();
+    }
+    return result;
+}
+
+static void drain_once(
+    const std::function<void(LogChannel, std::string_view)>& write,
+    uint64_t& nreported_dropped)
+{
+    static std::vector<DrainedMessage> messages;
+    drain_rings(messages);
+    for (const auto& m : messages) {
+        write(m.channel, m.text);
+    }
+    messages.clear();
+    auto ndropped = total_ndropped();
+    if (ndropped != nreported_dropped) {
+        write(
+            LogChannel::WARNING,
+            "Asynchronous logger dropped " + std::to_string(ndropped - nreported_dropped) + " message(s)");
+        nreported_dropped = ndropped;
+    }
+}
+
+void Mlib::start_async_logging(const AsyncLogConfig& config) {
+    std::scoped_lock start_stop_lock{ g_start_stop_mutex };
+    if (g_drain_thread != nullptr) {
+        throw std::runtime_error("Asynchronous logging already started");
+    }
+    if ((config.ring_capacity == 0) || (config.ring_capacity > UINT16_MAX + 1)) {
+        throw std::runtime_error("Log ring capacity out of range");
+    }
+    g_ring_capacity = std::bit_ceil(config.ring_capacity);
+    auto write = config.sink
+        ? config.sink
+        : std::function<void(LogChannel, std::string_view)>{ write_log_line };
+    g_drain_thread = std::make_unique<JThread>([interval = config.drain_interval, write](const StopToken& stop_token){
+        set_thread_name("AsyncLog");
+        g_is_drain_thread = true;
+        uint64_t nreported_dropped = total_ndropped();
+        while (true) {
+            bool stop = stop_token.stop_requested();
+            drain_once(write, nreported_dropped);
+            std::unique_lock lock{ g_drain_mutex };
+            ++g_ndrain_rounds;
+            if (stop) {
+                g_drain_running = false;
+                g_drained_cv.notify_all();
+                break;
+            }
+            g_drained_cv.notify_all();
+            g_drain_cv.wait_for(lock, interval, [&](){
+                return (g_ndrain_rounds < g_drain_rounds_target) || stop_token.stop_requested();
+            });
+        }
+    });
+    {
+        std::scoped_lock lock{ g_drain_mutex };
+        g_drain_running = true;
+    }
+    g_async_enabled = true;
+}
+
+void Mlib::stop_async_logging() {
+    std::scoped_lock start_stop_lock{ g_start_stop_mutex };
+    if (g_drain_thread == nullptr) {
+        return;
+    }
+    g_async_enabled = false;
+    // Wait for pushes that have seen "g_async_enabled == true",
+    // s.t. the final drain does not miss them.
+    while (g_npushing.load() != 0) {
+        std::this_thread::yield();
+    }
+    {
+        std::scoped_lock lock{ g_drain_mutex };
+        g_drain_thread->request_stop();
+        g_drain_cv.notify_all();
+    }
+    g_drain_thread->join();
+    g_drain_thread = nullptr;
+}
+
+bool Mlib::async_logging_enabled() {
+    return g_async_enabled;
+}
+
+void Mlib::flush_async_log() {
+    if (!g_async_enabled) {
+        return;
+    }
+    std::unique_lock lock{ g_drain_mutex };
+    // The round in progress might already have passed the caller's ring.
+    auto target = g_ndrain_rounds + 2;
+    g_drain_rounds_target = std::max(g_drain_rounds_target, target);
+    g_drain_cv.notify_all();
+    g_drained_cv.wait(lock, [&](){
+        return (g_ndrain_rounds >= target) || !g_drain_running;
+    });
+}
+
+uint64_t Mlib::async_log_ndropped() {
+    return total_ndropped();
+}
+
+bool Mlib::try_async_log(LogChannel channel, std::string_view line) {
+    return push_message(channel, line, nullptr);
+}
+
+void Mlib::push_deferred_log(LogChannel channel, std::string_view format, const LogArgs& args) {
+    if (!push_message(channel, format, &args)) {
+        write_log_line(channel, format_log_args(format, args.types, args.values, args.nargs));
+    }
+}
+
+AsyncLoggingGuard::AsyncLoggingGuard(const AsyncLogConfig& config) {
+    start_async_logging(config);
+}
+
+AsyncLoggingGuard::~AsyncLoggingGuard() {
+    stop_async_logging();
+}
+
+LogRateLimiter::LogRateLimiter(double max_per_second, double burst)
+    : interval_ns_{ (int64_t)(1e9 / max_per_second) }
+    , tolerance_ns_{ (int64_t)(1e9 / max_per_second * (burst - 1.)) }
+    , theoretical_arrival_ns_{ INT64_MIN / 2 }
+    , nsuppressed_{ 0 }
+{
+    if (!(max_per_second > 0.) || !(burst >= 1.)) {
+        throw std::runtime_error("Invalid log rate limit");
+    }
+}
+
+bool LogRateLimiter::allow() {
+    int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    auto tat = theoretical_arrival_ns_.load(std::memory_order_relaxed);
+    while (true) {
+        if (tat - now > tolerance_ns_) {
+            nsuppressed_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        if (theoretical_arrival_ns_.compare_exchange_weak(
+            tat,
+            std::max(tat, now) + interval_ns_,
+            std::memory_order_relaxed))
+        {
+            return true;
+        }
+    }
+}
+
+uint64_t LogRateLimiter::take_nsuppressed() {
+    return nsuppressed_.exchange(0, std::memory_order_relaxed);
+}
+
+static void write_crash_dump(const void* data, size_t size) {
+    const auto* p = (const char*)data;
+    while (size != 0) {
+#ifdef _WIN32
+        auto n = _write(g_crash_dump_fd, p, (unsigned int)std::min<size_t>(size, INT32_MAX));
+#else
+        auto n = ::write(g_crash_dump_fd, p, size);
+#endif
+        if (n <= 0) {
+            return;
+        }
+        p += n;
+        size -= (size_t)n;
+    }
+}
+
+static void crash_signal_handler(int signum) {
+    size_t n = g_nrings.load(std::memory_order_acquire);
+    for (size_t i = 0; i < n; ++i) {
+        g_rings[i].load(std::memory_order_acquire)->dump(write_crash_dump);
+    }
+    std::signal(signum, SIG_DFL);
+    std::raise(signum);
+}
+
+void Mlib::install_log_crash_dump(const Utf8Path& filename) {
+    if (g_crash_dump_fd != -1) {
+        throw std::runtime_error("Log crash dump already installed");
+    }
+#ifdef _WIN32
+    const std::filesystem::path& path = filename;
+    g_crash_dump_fd = _wopen(path.c_str(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+    g_crash_dump_fd = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+#endif
+    if (g_crash_dump_fd == -1) {
+        throw std::runtime_error("Could not open log crash dump \"" + filename.string() + '"');
+    }
+    for (int signum : {SIGSEGV, SIGABRT, SIGFPE, SIGILL}) {
+        std::signal(signum, crash_signal_handler);
+    }
+}
+
+void Mlib::print_log_crash_dump(const Utf8Path& filename, std::ostream& ostr) {
+    auto data = read_file_bytes(filename);
+    std::vector<LogRecord> records;
+    size_t offset = 0;
+    while (offset != data.size()) {
+        LogRingDumpHeader header;
+        if (data.size() - offset < sizeof(header)) {
+            throw std::runtime_error("Log crash dump truncated");
+        }
+        std::memcpy(&header, data.data() + offset, sizeof(header));
+        offset += sizeof(header);
+        if (header.magic != LOG_DUMP_MAGIC) {
+            throw std::runtime_error("Not a log crash dump");
+        }
+        if ((data.size() - offset) / sizeof(LogRecord) < header.capacity) {
+            throw std::runtime_error("Log crash dump truncated");
+        }
+        // Records before "head" were already drained, but are still
+        // present unless they were overwritten.
+        auto first = std::max<uint64_t>(header.tail, header.capacity) - header.capacity;
+        for (uint64_t s = first; s < header.tail; ++s) {
+            LogRecord r;
+            std::memcpy(&r, data.data() + offset + (s % header.capacity) * sizeof(LogRecord), sizeof(r));
+            records.push_back(r);
+        }
+        offset += header.capacity * sizeof(LogRecord);
+    }
+    // "stable_sort" keeps the continuations behind their head record.
+    std::stable_sort(records.begin(), records.end(), [](const auto& a, const auto& b){
+        return a.sequence < b.sequence;
+    });
+    for (auto it = records.begin(); it != records.end(); ++it) {
+        if (it->continuation) {
+            // The head record was overwritten.
+            continue;
+        }
+        if ((size_t)(records.end() - it) <= it->ncontinuations) {
+            continue;
+        }
+        std::string text(it->text, std::min<size_t>(it->length, LOG_RECORD_TEXT_NBYTES));
+        for (size_t c = 1; c <= it->ncontinuations; ++c) {
+            const auto& r = it[(ptrdiff_t)c];
+            if (!r.continuation || (r.sequence != it->sequence)) {
+                text += " <truncated>";
+                break;
+            }
+            text.append(r.text, std::min<size_t>(r.length, LOG_RECORD_TEXT_NBYTES));
+        }
+        if (it->deferred) {
+            text = format_log_args(text, it->arg_types, it->args, std::min<size_t>(it->nargs, LOG_RECORD_MAX_ARGS));
+        }
+        ostr << it->microseconds_since_epoch << ' ' << (int)it->channel << ' ' << text << '\n';
+    }
+}
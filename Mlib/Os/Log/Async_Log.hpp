@@ -0,0 +1,184 @@
+#pragma once
+#include <Mlib/Os/Os.hpp>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace Mlib {
+
+// Asynchronous logger
+//
+// Every thread owns a single-producer single-consumer ring of fixed-size
+// records, s.t. logging neither allocates nor locks on the calling thread.
+// A drain thread merges the rings in the order of a global sequence
+// number, formats deferred records, and writes them using
+// "write_log_line". If a ring is full, errors wait for the drain thread,
+// and other records are dropped and counted. The drain thread reports
+// the number of dropped records.
+// "linfo()", "lwarn()", ... push their lines into the rings while the
+// asynchronous logger is running, and write synchronously otherwise.
+// They still format on the calling thread, because "LLog" is an
+// "std::ostream", whose manipulators and "operator <<" overloads for
+// arbitrary types cannot be deferred. Only the write is moved to the
+// drain thread. Hot paths use "log_deferred" instead, which formats
+// its arithmetic arguments on the drain thread.
+
+static const size_t LOG_RECORD_MAX_ARGS = 8;
+static const size_t LOG_RECORD_NBYTES = 256;
+static const size_t LOG_RECORD_HEADER_NBYTES = 8 + 8 + 8 + LOG_RECORD_MAX_ARGS * (1 + 8);
+static const size_t LOG_RECORD_TEXT_NBYTES = LOG_RECORD_NBYTES - LOG_RECORD_HEADER_NBYTES;
+
+enum class LogArgType: uint8_t {
+    INT,
+    UINT,
+    DOUBLE,
+    BOOL,
+    CHAR
+};
+
+struct LogArgs {
+    uint8_t nargs = 0;
+    LogArgType types[LOG_RECORD_MAX_ARGS];
+    uint64_t values[LOG_RECORD_MAX_ARGS];
+    template <class T>
+    void push_back(const T& v) {
+        if constexpr (std::is_same_v<T, bool>) {
+            push_back(LogArgType::BOOL, (uint64_t)v);
+        } else if constexpr (std::is_same_v<T, char>) {
+            push_back(LogArgType::CHAR, (uint64_t)(unsigned char)v);
+        } else if constexpr (std::is_enum_v<T>) {
+            push_back((std::underlying_type_t<T>)v);
+        } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+            push_back(LogArgType::INT, (uint64_t)(int64_t)v);
+        } else if constexpr (std::is_integral_v<T>) {
+            push_back(LogArgType::UINT, (uint64_t)v);
+        } else if constexpr (std::is_floating_point_v<T>) {
+            push_back(LogArgType::DOUBLE, std::bit_cast<uint64_t>((double)v));
+        } else {
+            static_assert(!sizeof(T), "Deferred log arguments must be arithmetic");
+        }
+    }
+private:
+    inline void push_back(LogArgType type, uint64_t value) {
+        types[nargs] = type;
+        values[nargs] = value;
+        ++nargs;
+    }
+};
+
+// A message occupies one head record, followed by "ncontinuations"
+// records that carry the remaining text. All records of a message
+// share the same sequence number.
+struct LogRecord {
+    uint64_t sequence;
+    int64_t microseconds_since_epoch;
+    LogChannel channel;
+    // Nonzero if "text" is a format string for "args".
+    uint8_t deferred;
+    uint8_t continuation;
+    uint8_t nargs;
+    uint16_t ncontinuations;
+    uint16_t length;
+    LogArgType arg_types[LOG_RECORD_MAX_ARGS];
+    uint64_t args[LOG_RECORD_MAX_ARGS];
+    char text[LOG_RECORD_TEXT_NBYTES];
+};
+
+static_assert(sizeof(LogRecord) == LOG_RECORD_NBYTES);
+static_assert(std::is_trivially_copyable_v<LogRecord>);
+
+struct AsyncLogConfig {
+    // Number of records per thread, rounded up to a power of two.
+    size_t ring_capacity = 1024;
+    std::chrono::milliseconds drain_interval{ 10 };
+    // Receives the drained lines instead of "write_log_line" if set.
+    // Called on the drain thread.
+    std::function<void(LogChannel channel, std::string_view line)> sink;
+};
+
+void start_async_logging(const AsyncLogConfig& config = {});
+// Drains all pending records and stops the drain thread.
+void stop_async_logging();
+bool async_logging_enabled();
+// Blocks until all records pushed before the call are written.
+void flush_async_log();
+uint64_t async_log_ndropped();
+
+// Pushes the line into the calling thread's ring.
+// Returns false if the asynchronous logger is not running,
+// in which case the caller writes the line itself.
+bool try_async_log(LogChannel channel, std::string_view line);
+
+void push_deferred_log(LogChannel channel, std::string_view format, const LogArgs& args);
+
+// Replaces every "{}" in "format" with the next argument.
+std::string format_log_args(
+    std::string_view format,
+    const LogArgType* types,
+    const uint64_t* values,
+    size_t nargs);
+
+// Logs "format" and "args" without formatting them on the calling
+// thread, e.g. "log_deferred(LogChannel::INFO, "Frame {} took {} ms", i, dt)".
+template <class... TArgs>
+void log_deferred(LogChannel channel, std::string_view format, const TArgs&... args) {
+    static_assert(sizeof...(TArgs) <= LOG_RECORD_MAX_ARGS);
+    if (!log_channel_enabled(channel)) {
+        return;
+    }
+    LogArgs a;
+    (a.push_back(args), ...);
+    push_deferred_log(channel, format, a);
+}
+
+class AsyncLoggingGuard {
+    AsyncLoggingGuard(const AsyncLoggingGuard&) = delete;
+    AsyncLoggingGuard& operator = (const AsyncLoggingGuard&) = delete;
+public:
+    explicit AsyncLoggingGuard(const AsyncLogConfig& config = {});
+    ~AsyncLoggingGuard();
+};
+
+// Token bucket using the "generic cell rate algorithm", s.t. a
+// call site can be shared by several threads without a mutex.
+class LogRateLimiter {
+    LogRateLimiter(const LogRateLimiter&) = delete;
+    LogRateLimiter& operator = (const LogRateLimiter&) = delete;
+public:
+    explicit LogRateLimiter(double max_per_second, double burst = 1.);
+    bool allow();
+    // Number of rejected messages since the last call.
+    uint64_t take_nsuppressed();
+private:
+    int64_t interval_ns_;
+    int64_t tolerance_ns_;
+    std::atomic<int64_t> theoretical_arrival_ns_;
+    std::atomic<uint64_t> nsuppressed_;
+};
+
+// Rate-limits a logger per call site, e.g.
+// "LOG_RATE_LIMITED(2., lwarn(), "Penetration depth " << depth);"
+#define LOG_RATE_LIMITED(max_per_second, logger, message)                            \
+    do {                                                                             \
+        static ::Mlib::LogRateLimiter log_rate_limiter_{ max_per_second };           \
+        if (log_rate_limiter_.allow()) {                                             \
+            logger << message;                                                       \
+        }                                                                            \
+    } while (false)
+
+// Writes the raw rings of all threads to "filename" on a fatal signal.
+// The file is opened immediately, s.t. the signal handler only calls
+// async-signal-safe functions.
+void install_log_crash_dump(const Utf8Path& filename);
+// Decodes a dump written by "install_log_crash_dump", including
+// already-drained records that were still present in the rings.
+void print_log_crash_dump(const Utf8Path& filename, std::ostream& ostr);
+
+}
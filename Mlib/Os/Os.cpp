@@ -1,5 +1,6 @@
 #include "Os.hpp"
 #include <Mlib/Os/Io/Binary.hpp>
+#include <Mlib/Os/Log/Async_Log.hpp>
 #include <Mlib/Os/Preload.hpp>
 #include <Mlib/Os/Weakly_Canonical_Preserve_Symlinks.hpp>
 #include <filesystem>
@@ -80,26 +81,49 @@ std::ostream& LLog::ref() const {
     return *const_cast<LLog*>(this);
 }
 
-#ifdef __ANDROID__
+bool Mlib::log_channel_enabled(LogChannel channel) {
+    switch (channel) {
+    case LogChannel::INFO:
+        return g_log_level >= LogLevel::INFO;
+    case LogChannel::WARNING:
+        return g_log_level >= LogLevel::WARNING;
+    case LogChannel::ERROR:
+        return g_log_level >= LogLevel::ERROR;
+    case LogChannel::RAW:
+    case LogChannel::OUT:
+        return true;
+    }
+    verbose_abort("Unknown log channel");
+}
 
-static Utf8Path get_path_in_files_dir(
-    const std::initializer_list<std::string>& child_path,
-    FileStorageType storage_type)
+// Hands the line to the asynchronous logger if it is running,
+// and writes it synchronously otherwise.
+static void log_line(LogChannel channel, const std::string& s) {
+    if (!try_async_log(channel, s)) {
+        write_log_line(channel, s);
+    }
+}
+
+// The mutex is only locked if duplicates are suppressed, s.t. the
+// common path does not serialize the logging threads.
+static void log_line(
+    LogChannel channel,
+    LogFlags flags,
+    const std::string& s,
+    std::mutex& mutex,
+    std::string& last_message)
 {
-    ndk_helper::StorageType st = [&](){
-        switch (storage_type) {
-        case FileStorageType::EXTERNAL:
-            return ndk_helper::StorageType::EXTERNAL;
-        case FileStorageType::CACHE:
-            return ndk_helper::StorageType::CACHE;
+    if (!log_channel_enabled(channel)) {
+        return;
+    }
+    if (any(flags & LogFlags::SUPPRESS_DUPLICATES)) {
+        std::scoped_lock lock{ mutex };
+        if (s == last_message) {
+            return;
         }
-        throw std::runtime_error("Unknown storage type");
-    }();
-    std::string res = AUi::GetFilesDir(st);
-    for (const auto& s : child_path) {
-        res += '/' + s;
+        last_message = s;
     }
-    return weakly_canonical_preserve_symlinks(res);
+    log_line(channel, s);
 }
 
 LLog Mlib::linfo(LogFlags flags) {
@@ -108,13 +132,7 @@ LLog Mlib::linfo(LogFlags flags) {
     return LLog{
         flags,
         [&, flags](const std::string& s) {
-            if (g_log_level >= LogLevel::INFO) {
-                std::scoped_lock lock{ mutex };
-                if (!any(flags & LogFlags::SUPPRESS_DUPLICATES) || (s != last_message)) {
-                    LOGI("%s", s.c_str());
-                    last_message = s;
-                }
-            }
+            log_line(LogChannel::INFO, flags, s, mutex, last_message);
         }};
 }
 
@@ -124,13 +142,7 @@ LLog Mlib::lwarn(LogFlags flags) {
     return LLog{
         flags,
         [&, flags](const std::string& s) {
-            if (g_log_level >= LogLevel::WARNING) {
-                std::scoped_lock lock{ mutex };
-                if (!any(flags & LogFlags::SUPPRESS_DUPLICATES) || (s != last_message)) {
-                    LOGW("%s", s.c_str());
-                    last_message = s;
-                }
-            }
+            log_line(LogChannel::WARNING, flags, s, mutex, last_message);
         }};
 }
 
@@ -140,13 +152,8 @@ LLog Mlib::lerr(LogFlags flags) {
     return LLog{
         flags,
         [&, flags](const std::string& s) {
-            if (g_log_level >= LogLevel::ERROR) {
-                std::scoped_lock lock{ mutex };
-                if (!any(flags & LogFlags::SUPPRESS_DUPLICATES) || (s != last_message)) {
-                    LOGE("%s", s.c_str());
-                    last_message = s;
-                }
-            }}};
+            log_line(LogChannel::ERROR, flags, s, mutex, last_message);
+        }};
 }
 
 LLog Mlib::lraw(LogFlags flags) {
@@ -156,7 +163,7 @@ LLog Mlib::lraw(LogFlags flags) {
     return LLog{
         flags,
         [](const std::string& s) {
-            LOGI("%s", s.c_str());
+            log_line(LogChannel::RAW, s);
         }};
 }
 
@@ -167,10 +174,50 @@ LLog Mlib::lout(LogFlags flags) {
     return LLog{
         flags,
         [](const std::string& s) {
-            LOGI("%s", s.c_str());
+            log_line(LogChannel::OUT, s);
         }};
 }
 
+#ifdef __ANDROID__
+
+static Utf8Path get_path_in_files_dir(
+    const std::initializer_list<std::string>& child_path,
+    FileStorageType storage_type)
+{
+    ndk_helper::StorageType st = [&](){
+        switch (storage_type) {
+        case FileStorageType::EXTERNAL:
+            return ndk_helper::StorageType::EXTERNAL;
+        case FileStorageType::CACHE:
+            return ndk_helper::StorageType::CACHE;
+        }
+        throw std::runtime_error("Unknown storage type");
+    }();
+    std::string res = AUi::GetFilesDir(st);
+    for (const auto& s : child_path) {
+        res += '/' + s;
+    }
+    return weakly_canonical_preserve_symlinks(res);
+}
+
+void Mlib::write_log_line(LogChannel channel, std::string_view line) {
+    auto n = (int)line.size();
+    switch (channel) {
+    case LogChannel::INFO:
+    case LogChannel::RAW:
+    case LogChannel::OUT:
+        LOGI("%.*s", n, line.data());
+        return;
+    case LogChannel::WARNING:
+        LOGW("%.*s", n, line.data());
+        return;
+    case LogChannel::ERROR:
+        LOGE("%.*s", n, line.data());
+        return;
+    }
+    verbose_abort("Unknown log channel");
+}
+
 std::unique_ptr<std::istream> Mlib::create_ifstream(
     const Utf8Path& filename,
     std::ios_base::openmode mode)
@@ -253,69 +300,27 @@ void Mlib::set_thread_name(const std::string& name) {
 
 #else
 
-LLog Mlib::linfo(LogFlags flags) {
+void Mlib::write_log_line(LogChannel channel, std::string_view line) {
     static std::mutex mutex;
-    static std::string last_message;
-    return LLog{
-        flags,
-        [&, flags](const std::string& s) {
-        if (g_log_level >= LogLevel::INFO) {
-            std::scoped_lock lock{ mutex };
-            if (!any(flags & LogFlags::SUPPRESS_DUPLICATES) || (s != last_message)) {
-                std::cerr << "Info: " << s << std::endl;
-                last_message = s;
-            }
-        }}};
-}
-
-LLog Mlib::lwarn(LogFlags flags) {
-    static std::mutex mutex;
-    static std::string last_message;
-    return LLog{
-        flags,
-        [&, flags](const std::string& s) {
-            std::scoped_lock lock{ mutex };
-            if (!any(flags & LogFlags::SUPPRESS_DUPLICATES) || (s != last_message)) {
-                std::cerr << "Warning: " << s << std::endl;
-                last_message = s;
-            }
-        }};
-}
-
-LLog Mlib::lerr(LogFlags flags) {
-    static std::mutex mutex;
-    static std::string last_message;
-    return LLog{
-        flags,
-        [&, flags](const std::string& s) {
-            std::scoped_lock lock{ mutex };
-            if (!any(flags & LogFlags::SUPPRESS_DUPLICATES) || (s != last_message)) {
-                std::cerr << "Error: " << s << std::endl;
-                last_message = s;
-            }
-        }};
-}
-
-LLog Mlib::lraw(LogFlags flags) {
-    if (any(flags & LogFlags::SUPPRESS_DUPLICATES)) {
-        throw std::runtime_error("Raw logger cannot suppress duplicates");
+    std::scoped_lock lock{ mutex };
+    switch (channel) {
+    case LogChannel::INFO:
+        std::cerr << "Info: " << line << std::endl;
+        return;
+    case LogChannel::WARNING:
+        std::cerr << "Warning: " << line << std::endl;
+        return;
+    case LogChannel::ERROR:
+        std::cerr << "Error: " << line << std::endl;
+        return;
+    case LogChannel::RAW:
+        std::cerr << line << std::endl;
+        return;
+    case LogChannel::OUT:
+        std::cout << line << std::endl;
+        return;
     }
-    return LLog{
-        flags,
-        [](const std::string& s) {
-            std::cerr << s << std::endl;
-        }};
-}
-
-LLog Mlib::lout(LogFlags flags) {
-    if (any(flags & LogFlags::SUPPRESS_DUPLICATES)) {
-        throw std::runtime_error("Out logger cannot suppress duplicates");
-    }
-    return LLog{
-        flags,
-        [](const std::string& s) {
-            std::cout << s << std::endl;
-        }};
+    verbose_abort("Unknown log channel");
 }
 
 std::unique_ptr<std::istream> Mlib::create_ifstream(
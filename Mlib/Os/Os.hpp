@@ -5,6 +5,7 @@
 #include <istream>
 #include <memory>
 #include <sstream>
+#include <string_view>
 #include <vector>
 
 #ifdef __ANDROID__
@@ -50,10 +51,24 @@ inline LogFlags& operator |= (LogFlags& a, LogFlags b) {
     return a;
 }
 
+enum class LogChannel: uint8_t {
+    INFO,
+    WARNING,
+    ERROR,
+    RAW,
+    OUT
+};
+
 LogLevel log_level_from_string(const std::string& s);
 
 void set_log_level(LogLevel log_level);
 
+bool log_channel_enabled(LogChannel channel);
+
+// Writes a single line to the platform's log, bypassing
+// the asynchronous logger (see "Async_Log.hpp").
+void write_log_line(LogChannel channel, std::string_view line);
+
 class LogBuf: public std::stringbuf {
     LogBuf(const LogBuf&) = delete;
     LogBuf& operator = (const LogBuf&) = delete;
@@ -64,6 +79,8 @@ private:
     const std::function<void(const std::string&)>& write_;
 };
 
+// Formats on the calling thread, even if the asynchronous logger
+// is running (see "log_deferred" in "Async_Log.hpp").
 class LLog: public std::ostream {
     LLog(const LLog&) = delete;
     LLog& operator = (const LLog&) = delete;
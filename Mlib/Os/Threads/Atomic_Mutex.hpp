@@ -1,5 +1,6 @@
 #pragma once
 #include <Mlib/Os/Env.hpp>
+#include <Mlib/Os/Threads/Spin_Backoff.hpp>
 #include <Mlib/Time/Sleep.hpp>
 #include <atomic>
 #include <cstdint>
@@ -9,6 +10,9 @@
 
 namespace Mlib {
 
+// Spins with exponential backoff and then parks the thread
+// on the atomic (futex on Linux).
+// Setting the environment variable "SPINLOCK=1" disables parking.
 class AtomicMutex {
     AtomicMutex(const AtomicMutex&) = delete;
     AtomicMutex& operator = (const AtomicMutex&) = delete;
@@ -16,7 +20,10 @@ public:
     inline AtomicMutex() = default;
     inline ~AtomicMutex() = default;
     inline void lock() {
-        static const uint32_t spinlock = [](){
+        if (must_lock()) {
+            return;
+        }
+        static const bool spinlock = [](){
             auto v = try_getenv("SPINLOCK");
             if (!v.has_value() || (*v == "0")) {
                 return false;
@@ -26,31 +33,44 @@ public:
             }
             throw std::runtime_error("Could not parse SPINLOCK variable");
         }();
-        if (spinlock) {
-            while (!try_lock());
-        } else {
-            // Spinlock for 25ms on a 4GHz processor
-            for (uint32_t i = 0; i < 100'000'000; ++i) {
-                if (try_lock()) {
-                    return;
-                }
+        SpinBackoff backoff;
+        while (true) {
+            if ((state_.load(std::memory_order_relaxed) == UNLOCKED) && must_lock()) {
+                return;
             }
-            while (!try_lock()) {
-                Mlib::sleep_for(std::chrono::milliseconds(100));
+            if (spinlock) {
+                cpu_relax();
+            } else if (!backoff.spin()) {
+                break;
             }
         }
+        // The state stays "PARKED" until the last waiter has acquired
+        // the mutex, which costs at most one unnecessary "notify_one".
+        while (state_.exchange(PARKED, std::memory_order_acquire) != UNLOCKED) {
+            state_.wait(PARKED, std::memory_order_relaxed);
+        }
     }
     inline bool try_lock() {
         return must_lock();
     }
     inline bool must_lock() {
-        return !flag_.test_and_set(std::memory_order_acquire);
+        uint32_t expected = UNLOCKED;
+        return state_.compare_exchange_strong(
+            expected,
+            LOCKED,
+            std::memory_order_acquire,
+            std::memory_order_relaxed);
     }
     inline void unlock() {
-        flag_.clear(std::memory_order_release);
+        if (state_.exchange(UNLOCKED, std::memory_order_release) == PARKED) {
+            state_.notify_one();
+        }
     }
 private:
-    std::atomic_flag flag_ = ATOMIC_FLAG_INIT;
+    static constexpr uint32_t UNLOCKED = 0;
+    static constexpr uint32_t LOCKED = 1;
+    static constexpr uint32_t PARKED = 2;
+    std::atomic<uint32_t> state_ = UNLOCKED;
 };
 
 }
@@ -0,0 +1,99 @@
+#include "Epoch_Reclamation.hpp"
+#include <Mlib/Os/Threads/Thread_Local.hpp>
+
+using namespace Mlib;
+
+namespace Mlib {
+
+// One slot per thread, padded to a cache line, s.t. readers on
+// different threads do not write to the same line.
+// Slots are reused after their thread exits, and never deleted.
+struct alignas(64) EpochSlot {
+    // Zero if the thread is not inside of a critical section.
+    std::atomic<uint64_t> epoch = 0;
+    std::atomic<bool> in_use = true;
+    EpochSlot* next = nullptr;
+};
+
+}
+
+namespace {
+
+struct EpochParticipant {
+    EpochSlot* slot = nullptr;
+    uint32_t depth = 0;
+    ~EpochParticipant() {
+        if (slot != nullptr) {
+            slot->epoch.store(0, std::memory_order_release);
+            slot->in_use.store(false, std::memory_order_release);
+        }
+    }
+};
+
+THREAD_LOCAL(EpochParticipant) participant{ EpochParticipant{} };
+
+}
+
+EpochDomain::EpochDomain()
+    : epoch_{ 1 }
+    , slots_{ nullptr }
+{}
+
+EpochDomain::~EpochDomain() = default;
+
+EpochDomain& EpochDomain::instance() {
+    static auto* domain = new EpochDomain;
+    return *domain;
+}
+
+EpochSlot& EpochDomain::acquire_slot() {
+    for (auto* s = slots_.load(std::memory_order_acquire); s != nullptr; s = s->next) {
+        bool expected = false;
+        if (!s->in_use.load(std::memory_order_relaxed) &&
+            s->in_use.compare_exchange_strong(expected, true, std::memory_order_acquire))
+        {
+            return *s;
+        }
+    }
+    auto* s = new EpochSlot;
+    s->next = slots_.load(std::memory_order_relaxed);
+    while (!slots_.compare_exchange_weak(s->next, s, std::memory_order_release, std::memory_order_relaxed));
+    return *s;
+}
+
+void EpochDomain::enter() {
+    EpochParticipant& p = participant;
+    if (p.depth++ != 0) {
+        return;
+    }
+    if (p.slot == nullptr) {
+        p.slot = &acquire_slot();
+    }
+    // A stale epoch only delays reclamation.
+    // The exchange is sequentially consistent, s.t. it is ordered before
+    // the reader's subsequent loads of published pointers, which must be
+    // sequentially consistent, too (Dekker-style, paired with the loads
+    // in "is_safe_to_reclaim").
+    p.slot->epoch.exchange(epoch_.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+}
+
+void EpochDomain::leave() {
+    EpochParticipant& p = participant;
+    if (--p.depth == 0) {
+        p.slot->epoch.store(0, std::memory_order_release);
+    }
+}
+
+uint64_t EpochDomain::retire() {
+    return epoch_.fetch_add(1, std::memory_order_seq_cst);
+}
+
+bool EpochDomain::is_safe_to_reclaim(uint64_t retire_epoch) const {
+    for (auto* s = slots_.load(std::memory_order_acquire); s != nullptr; s = s->next) {
+        auto e = s->epoch.load(std::memory_order_seq_cst);
+        if ((e != 0) && (e <= retire_epoch)) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+namespace Mlib {
+
+struct EpochSlot;
+
+// Epoch-based reclamation for read-copy-update containers.
+// Readers pin the current epoch with an "EpochGuard" before loading a
+// shared pointer. A writer unpublishing an object calls "retire" and
+// may delete the object once "is_safe_to_reclaim" returns true for the
+// returned epoch, i.e. once every reader that could still see the
+// object has left its critical section.
+// The domain is never destroyed, s.t. containers with static storage
+// duration can use it.
+class EpochDomain {
+    EpochDomain(const EpochDomain&) = delete;
+    EpochDomain& operator = (const EpochDomain&) = delete;
+public:
+    static EpochDomain& instance();
+    // Must be called after the object was unpublished.
+    uint64_t retire();
+    bool is_safe_to_reclaim(uint64_t retire_epoch) const;
+    void enter();
+    void leave();
+private:
+    EpochDomain();
+    ~EpochDomain();
+    EpochSlot& acquire_slot();
+    std::atomic<uint64_t> epoch_;
+    std::atomic<EpochSlot*> slots_;
+};
+
+// Pins the current epoch for the lifetime of the guard.
+// Guards can be nested.
+class EpochGuard {
+    EpochGuard(const EpochGuard&) = delete;
+    EpochGuard& operator = (const EpochGuard&) = delete;
+public:
+    inline EpochGuard() {
+        EpochDomain::instance().enter();
+    }
+    inline ~EpochGuard() {
+        EpochDomain::instance().leave();
+    }
+};
+
+}
@@ -0,0 +1,79 @@
+#include "Mutex_Contention.hpp"
+#include <Mlib/Os/Env.hpp>
+#include <iomanip>
+#include <mutex>
+#include <ostream>
+
+using namespace Mlib;
+
+void MutexContentionStatistics::reset() {
+    nacquisitions = 0;
+    ncontended = 0;
+    nparked = 0;
+    total_wait_time = 0;
+    max_wait_time = 0;
+    max_hold_time = 0;
+}
+
+static std::atomic_bool& mutex_profiling_flag() {
+    static std::atomic_bool result = getenv_default_bool("MUTEX_PROFILING", false);
+    return result;
+}
+
+bool Mlib::mutex_profiling_enabled() {
+    return mutex_profiling_flag().load(std::memory_order_relaxed);
+}
+
+void Mlib::enable_mutex_profiling() {
+    mutex_profiling_flag() = true;
+}
+
+MutexContentionRegistry::MutexContentionRegistry() = default;
+
+MutexContentionRegistry::~MutexContentionRegistry() = default;
+
+MutexContentionRegistry& MutexContentionRegistry::instance() {
+    static auto* registry = new MutexContentionRegistry;
+    return *registry;
+}
+
+MutexContentionStatistics* MutexContentionRegistry::statistics(std::string_view name) {
+    if (!mutex_profiling_enabled()) {
+        return nullptr;
+    }
+    std::scoped_lock lock{ mutex_ };
+    auto it = statistics_.find(name);
+    if (it == statistics_.end()) {
+        it = statistics_.try_emplace(std::string{ name }, std::make_unique<MutexContentionStatistics>()).first;
+    }
+    return it->second.get();
+}
+
+void MutexContentionRegistry::print(std::ostream& ostr) const {
+    std::scoped_lock lock{ mutex_ };
+    ostr <<
+        std::left << std::setw(40) << "mutex" << std::right <<
+        std::setw(14) << "acquisitions" <<
+        std::setw(12) << "contended" <<
+        std::setw(10) << "parked" <<
+        std::setw(14) << "wait [ms]" <<
+        std::setw(14) << "max wait [us]" <<
+        std::setw(14) << "max hold [us]" << '\n';
+    for (const auto& [name, s] : statistics_) {
+        ostr <<
+            std::left << std::setw(40) << name << std::right <<
+            std::setw(14) << s->nacquisitions.load() <<
+            std::setw(12) << s->ncontended.load() <<
+            std::setw(10) << s->nparked.load() <<
+            std::setw(14) << (double)s->total_wait_time.load() * 1e-6 <<
+            std::setw(14) << (double)s->max_wait_time.load() * 1e-3 <<
+            std::setw(14) << (double)s->max_hold_time.load() * 1e-3 << '\n';
+    }
+}
+
+void MutexContentionRegistry::reset() {
+    std::scoped_lock lock{ mutex_ };
+    for (auto& [_, s] : statistics_) {
+        s->reset();
+    }
+}
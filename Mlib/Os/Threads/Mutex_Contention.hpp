@@ -0,0 +1,75 @@
+#pragma once
+#include <Mlib/Os/Threads/Fast_Mutex.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace Mlib {
+
+// Contention counters of a mutex, or of all mutexes registered
+// under the same name.
+// Durations are in nanoseconds.
+struct MutexContentionStatistics {
+    std::atomic<uint64_t> nacquisitions = 0;
+    std::atomic<uint64_t> ncontended = 0;
+    std::atomic<uint64_t> nparked = 0;
+    std::atomic<uint64_t> total_wait_time = 0;
+    std::atomic<uint64_t> max_wait_time = 0;
+    std::atomic<uint64_t> max_hold_time = 0;
+    static inline uint64_t now() {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+    inline void notify_acquired() {
+        nacquisitions.fetch_add(1, std::memory_order_relaxed);
+    }
+    inline void notify_waited(uint64_t start) {
+        auto dt = now() - start;
+        ncontended.fetch_add(1, std::memory_order_relaxed);
+        total_wait_time.fetch_add(dt, std::memory_order_relaxed);
+        update_max(max_wait_time, dt);
+    }
+    inline void notify_parked() {
+        nparked.fetch_add(1, std::memory_order_relaxed);
+    }
+    inline void notify_released(uint64_t lock_time) {
+        update_max(max_hold_time, now() - lock_time);
+    }
+    void reset();
+private:
+    static inline void update_max(std::atomic<uint64_t>& m, uint64_t v) {
+        auto old = m.load(std::memory_order_relaxed);
+        while ((v > old) && !m.compare_exchange_weak(old, v, std::memory_order_relaxed));
+    }
+};
+
+// Enabled by setting the environment variable "MUTEX_PROFILING=1",
+// or by calling "enable_mutex_profiling" before the mutexes are profiled.
+bool mutex_profiling_enabled();
+void enable_mutex_profiling();
+
+// Global registry of named contention counters.
+// The registry is never destroyed, s.t. mutexes with static storage
+// duration can be profiled.
+class MutexContentionRegistry {
+    MutexContentionRegistry(const MutexContentionRegistry&) = delete;
+    MutexContentionRegistry& operator = (const MutexContentionRegistry&) = delete;
+public:
+    static MutexContentionRegistry& instance();
+    // Returns nullptr if profiling is disabled.
+    MutexContentionStatistics* statistics(std::string_view name);
+    void print(std::ostream& ostr) const;
+    void reset();
+private:
+    MutexContentionRegistry();
+    ~MutexContentionRegistry();
+    std::map<std::string, std::unique_ptr<MutexContentionStatistics>, std::less<>> statistics_;
+    mutable FastMutex mutex_;
+};
+
+}
@@ -1,6 +1,7 @@
 #pragma once
 #include <Mlib/Os/Threads/Safe_Atomic_Shared_Mutex.hpp>
 #include <shared_mutex>
+#include <string_view>
 #include <thread>
 
 namespace Mlib {
@@ -13,6 +14,9 @@ public:
         , count_{ 0 }
     {}
     ~GenericRecursiveSharedMutex() = default;
+    void profile(std::string_view name) {
+        mutex_.profile(name);
+    }
     void lock() {
         if (!is_owner()) {
             mutex_.lock();
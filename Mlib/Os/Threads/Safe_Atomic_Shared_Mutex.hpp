@@ -1,32 +1,62 @@
 #pragma once
 #include <Mlib/Os/Threads/Fast_Mutex.hpp>
+#include <Mlib/Os/Threads/Mutex_Contention.hpp>
+#include <Mlib/Os/Threads/Spin_Backoff.hpp>
+#include <atomic>
 #include <chrono>
 #include <cstdint>
 #include <mutex>
+#include <string_view>
+#include <thread>
 
 namespace Mlib {
 
+// Reader-writer lock on a single 32-bit word.
+// Waiters spin with exponential backoff and then park on the word.
+// A waiting writer makes new readers spin until their backoff is
+// exhausted, which prevents writer starvation without deadlocking
+// readers that already hold a shared lock.
 class SafeAtomicSharedMutex {
     SafeAtomicSharedMutex(const SafeAtomicSharedMutex&) = delete;
     SafeAtomicSharedMutex& operator = (const SafeAtomicSharedMutex&) = delete;
 public:
     inline SafeAtomicSharedMutex()
-        : locked_{ false }
-        , nlocked_shared_{ 0 }
+        : state_{ 0 }
+        , statistics_{ nullptr }
+        , lock_time_{ 0 }
     {}
     inline ~SafeAtomicSharedMutex() = default;
+    // Records contention counters in the "MutexContentionRegistry".
+    // No-op if profiling is disabled. Takes a "string_view", s.t.
+    // profiling the mutexes of short-lived objects allocates nothing
+    // while profiling is disabled.
+    inline void profile(std::string_view name) {
+        statistics_ = MutexContentionRegistry::instance().statistics(name);
+    }
     inline void lock() {
-        while (!try_lock());
+        if (must_lock()) {
+            return;
+        }
+        auto start = (statistics_ == nullptr) ? 0 : MutexContentionStatistics::now();
+        lock_slow();
+        if (statistics_ != nullptr) {
+            statistics_->notify_waited(start);
+            notify_locked();
+        }
     }
     template <class Rep, class Period>
     bool try_lock_for(const std::chrono::duration<Rep, Period>& timeout_duration)
     {
         auto start = std::chrono::steady_clock::now();
+        SpinBackoff backoff;
         while (!try_lock()) {
             auto now = std::chrono::steady_clock::now();
             if (now - start >= timeout_duration) {
                 return false;
             }
+            if (!backoff.spin()) {
+                std::this_thread::yield();
+            }
         }
         return true;
     }
@@ -34,40 +64,152 @@ public:
         return must_lock();
     }
     inline bool must_lock() {
-        if (!mutex_.must_lock()) {
-            return false;
-        }
-        if (locked_ || (nlocked_shared_ != 0)) {
-            mutex_.unlock();
-            return false;
+        auto s = state_.load(std::memory_order_relaxed);
+        while ((s & (LOCKED | READERS)) == 0) {
+            // Clears "WRITER_WAITING", other waiting writers set it again.
+            if (state_.compare_exchange_weak(
+                s,
+                LOCKED | (s & PARKED),
+                std::memory_order_acquire,
+                std::memory_order_relaxed))
+            {
+                if (statistics_ != nullptr) {
+                    notify_locked();
+                }
+                return true;
+            }
         }
-        locked_ = true;
-        mutex_.unlock();
-        return true;
+        return false;
     }
     inline void unlock() {
-        std::scoped_lock lock{ mutex_ };
-        locked_ = false;
+        if (statistics_ != nullptr) {
+            statistics_->notify_released(lock_time_);
+        }
+        if (state_.fetch_and(~(LOCKED | PARKED), std::memory_order_release) & PARKED) {
+            state_.notify_all();
+        }
     }
-    void lock_shared() {
-        while (!try_lock_shared());
+    inline void lock_shared() {
+        auto s = state_.load(std::memory_order_relaxed);
+        if (((s & (LOCKED | WRITER_WAITING)) == 0) &&
+            state_.compare_exchange_strong(
+                s,
+                s + 1,
+                std::memory_order_acquire,
+                std::memory_order_relaxed))
+        {
+            if (statistics_ != nullptr) {
+                statistics_->notify_acquired();
+            }
+            return;
+        }
+        auto start = (statistics_ == nullptr) ? 0 : MutexContentionStatistics::now();
+        lock_shared_slow();
+        if (statistics_ != nullptr) {
+            statistics_->notify_waited(start);
+            statistics_->notify_acquired();
+        }
     }
-    bool try_lock_shared() {
-        std::scoped_lock lock{ mutex_ };
-        if (locked_) {
-            return false;
+    // Ignores waiting writers, s.t. it never fails for a thread
+    // that already holds a shared lock.
+    inline bool try_lock_shared() {
+        auto s = state_.load(std::memory_order_relaxed);
+        while ((s & LOCKED) == 0) {
+            if (state_.compare_exchange_weak(
+                s,
+                s + 1,
+                std::memory_order_acquire,
+                std::memory_order_relaxed))
+            {
+                if (statistics_ != nullptr) {
+                    statistics_->notify_acquired();
+                }
+                return true;
+            }
         }
-        ++nlocked_shared_;
-        return true;
+        return false;
     }
-    void unlock_shared() {
-        std::scoped_lock lock{ mutex_ };
-        --nlocked_shared_;
+    inline void unlock_shared() {
+        auto s = state_.fetch_sub(1, std::memory_order_release) - 1;
+        if (((s & READERS) == 0) && (s & PARKED)) {
+            // Only writers park while readers hold the lock.
+            state_.fetch_and(~PARKED, std::memory_order_relaxed);
+            state_.notify_all();
+        }
     }
 private:
-    bool locked_;
-    uint32_t nlocked_shared_;
-    FastMutex mutex_;
+    static constexpr uint32_t LOCKED = 1u << 31;
+    static constexpr uint32_t WRITER_WAITING = 1u << 30;
+    static constexpr uint32_t PARKED = 1u << 29;
+    static constexpr uint32_t READERS = PARKED - 1;
+    inline void notify_locked() {
+        statistics_->notify_acquired();
+        lock_time_ = MutexContentionStatistics::now();
+    }
+    void lock_slow() {
+        SpinBackoff backoff;
+        while (true) {
+            auto s = state_.load(std::memory_order_relaxed);
+            if ((s & (LOCKED | READERS)) == 0) {
+                if (state_.compare_exchange_weak(
+                    s,
+                    LOCKED | (s & PARKED),
+                    std::memory_order_acquire,
+                    std::memory_order_relaxed))
+                {
+                    return;
+                }
+                continue;
+            }
+            if ((s & WRITER_WAITING) == 0) {
+                state_.fetch_or(WRITER_WAITING, std::memory_order_relaxed);
+                continue;
+            }
+            if (!backoff.spin()) {
+                park(s);
+            }
+        }
+    }
+    void lock_shared_slow() {
+        SpinBackoff backoff;
+        while (true) {
+            auto s = state_.load(std::memory_order_relaxed);
+            // Yield to waiting writers only while spinning, because the
+            // calling thread might already hold a shared lock.
+            if (((s & LOCKED) == 0) &&
+                (((s & WRITER_WAITING) == 0) || backoff.exhausted()))
+            {
+                if (state_.compare_exchange_weak(
+                    s,
+                    s + 1,
+                    std::memory_order_acquire,
+                    std::memory_order_relaxed))
+                {
+                    return;
+                }
+                continue;
+            }
+            if (!backoff.spin()) {
+                park(s);
+            }
+        }
+    }
+    // Sets the "PARKED" bit and waits until the state changes.
+    void park(uint32_t s) {
+        if ((s & PARKED) == 0) {
+            if (!state_.compare_exchange_strong(s, s | PARKED, std::memory_order_relaxed)) {
+                return;
+            }
+            s |= PARKED;
+        }
+        if (statistics_ != nullptr) {
+            statistics_->notify_parked();
+        }
+        state_.wait(s, std::memory_order_relaxed);
+    }
+    std::atomic<uint32_t> state_;
+    MutexContentionStatistics* statistics_;
+    uint64_t lock_time_;
 };
 
 }
@@ -0,0 +1,56 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace Mlib {
+
+// Hint to the CPU that the calling thread is busy-waiting.
+inline void cpu_relax() {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    _mm_pause();
+#elif defined(_MSC_VER) && defined(_M_ARM64)
+    __yield();
+#elif defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    asm volatile("yield");
+#endif
+}
+
+// Exponential backoff for spin loops.
+// Round "i" executes 2^i pause instructions, with at most "max_pauses"
+// per round. "spin" returns false once "max_rounds" rounds
+// (2 * max_pauses - 1 pauses, i.e. up to tens of microseconds) have been
+// executed, after which the caller should park.
+class SpinBackoff {
+public:
+    static constexpr uint32_t max_rounds = 11;
+    static constexpr uint32_t max_pauses = 1 << 10;
+    inline SpinBackoff()
+        : npauses_{ 1 }
+        , nrounds_{ 0 }
+    {}
+    inline bool spin() {
+        if (nrounds_ == max_rounds) {
+            return false;
+        }
+        for (uint32_t i = 0; i < npauses_; ++i) {
+            cpu_relax();
+        }
+        npauses_ = std::min(2 * npauses_, max_pauses);
+        ++nrounds_;
+        return true;
+    }
+    inline bool exhausted() const {
+        return nrounds_ == max_rounds;
+    }
+private:
+    uint32_t npauses_;
+    uint32_t nrounds_;
+};
+
+}
@@ -1646,7 +1646,7 @@ OsmMapResource::OsmMapResource(
                     nodes,
                     *ground_bvh,
                     nullptr,        // to_meters
-                    nullptr,        // sample_solo_mesh
+                    nullptr,        // navmesh
                     config.scale,
                     config.waypoint_merge_radius,
                     config.waypoint_error_radius,
@@ -1661,7 +1661,7 @@ OsmMapResource::OsmMapResource(
                     nodes,
                     *ground_bvh,
                     nullptr,        // to_meters
-                    nullptr,        // sample_solo_mesh
+                    nullptr,        // navmesh
                     config.scale,
                     config.waypoint_merge_radius,
                     config.waypoint_error_radius,
@@ -1680,7 +1680,7 @@ OsmMapResource::OsmMapResource(
                         nodes,
                         *ground_bvh,
                         nullptr,        // to_meters
-                        nullptr,        // sample_solo_mesh
+                        nullptr,        // navmesh
                         config.scale,
                         config.waypoint_merge_radius,
                         config.waypoint_error_radius,
@@ -1693,7 +1693,7 @@ OsmMapResource::OsmMapResource(
                         nodes,
                         *ground_bvh,
                         nullptr,        // to_meters
-                        nullptr,        // sample_solo_mesh
+                        nullptr,        // navmesh
                         config.scale,
                         config.waypoint_merge_radius,
                         config.waypoint_error_radius,
@@ -1704,7 +1704,7 @@ OsmMapResource::OsmMapResource(
                         nodes,
                         *ground_bvh,
                         nullptr,        // to_meters
-                        nullptr);       // sample_solo_mesh
+                        nullptr);       // navmesh
                 } else {
                     auto filter = ColoredVertexArrayFilter{
                         .included_tags = PhysicsMaterial::ATTR_COLLIDE,
@@ -1737,7 +1737,9 @@ OsmMapResource::OsmMapResource(
                         indexed_face_set,
                         NavigationMeshConfig{
                             .cell_size = 1.f,
-                            .agent_radius = config.agent_radius}};
+                            .agent_radius = config.agent_radius,
+                            .tile_size = config.navmesh_tile_size,
+                            .cache_directory = navigation_mesh_cache_directory()}};
                     auto scaled_rotation = rotation.casted<double>() / scale_;
                     auto itm = inv(scaled_rotation);
                     if (!itm.has_value()) {
@@ -1752,7 +1754,7 @@ OsmMapResource::OsmMapResource(
                         nodes,
                         *ground_bvh,
                         &to_meters,
-                        &nmb.ssm,
+                        &nmb.query(),
                         config.scale,
                         config.waypoint_merge_radius,
                         config.waypoint_error_radius,
@@ -1765,7 +1767,7 @@ OsmMapResource::OsmMapResource(
                         nodes,
                         *ground_bvh,
                         &to_meters,
-                        &nmb.ssm,
+                        &nmb.query(),
                         config.scale,
                         config.waypoint_merge_radius,
                         config.waypoint_error_radius,
@@ -1777,7 +1779,7 @@ OsmMapResource::OsmMapResource(
                         nodes,
                         *ground_bvh,
                         &to_meters,
-                        &nmb.ssm);
+                        &nmb.query());
                 }
             }
         } catch (const PointException<CompressedScenePos, 2>& e) {
@@ -2,7 +2,7 @@
 #include <Mlib/Geometry/Exceptions/Point_Exception.hpp>
 #include <Mlib/Math/Fixed_Rodrigues.hpp>
 #include <Mlib/Math/Transformation/Bijection.hpp>
-#include <Mlib/Navigation/Sample_SoloMesh.hpp>
+#include <Mlib/Navigation/Navigation_Mesh_Query.hpp>
 #include <Mlib/Osm_Loader/Osm_Map_Resource/Building.hpp>
 #include <Mlib/Osm_Loader/Osm_Map_Resource/Ground_Bvh.hpp>
 #include <Mlib/Osm_Loader/Osm_Map_Resource/Osm_Map_Resource_Helpers.hpp>
@@ -18,9 +18,9 @@ void Mlib::calculate_terrain_spawn_points(
     const std::map<std::string, Node>& nodes,
     const GroundBvh& ground_bvh,
     const Bijection<FixedArray<double, 3, 3>>* to_meters,
-    const Sample_SoloMesh* ssm)
+    const NavigationMeshQuery* navmesh)
 {
-    if (!ssm != !to_meters) {
+    if (!navmesh != !to_meters) {
         throw std::runtime_error("Inconsistent to-meters mapping and navmesh parameters");
     }
     for (const Building& bu : spawn_lines) {
@@ -45,9 +45,9 @@ void Mlib::calculate_terrain_spawn_points(
                     throw PointException{ p, "Spawn line out of bounds" };
                 }
                 auto p3 = FixedArray<CompressedScenePos, 3>{p(0), p(1), height};
-                if (ssm != nullptr) {
+                if (navmesh != nullptr) {
                     auto pm = dot1d(to_meters->model, funpack(p3));
-                    auto pc = ssm->closest_point_on_navmesh(pm.casted<float>());
+                    auto pc = navmesh->closest_point_on_navmesh(pm.casted<float>());
                     if (!pc.has_value()) {
                         throw PointException{ p, "Could not find closest spawn point on navmesh" };
                     }
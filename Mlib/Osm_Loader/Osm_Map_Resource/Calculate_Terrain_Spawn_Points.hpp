@@ -10,7 +10,7 @@ struct SpawnPoint;
 struct Building;
 struct Node;
 class GroundBvh;
-class Sample_SoloMesh;
+class NavigationMeshQuery;
 template <typename TData, size_t... tshape>
 class FixedArray;
 template <class T>
@@ -22,6 +22,6 @@ void calculate_terrain_spawn_points(
     const std::map<std::string, Node>& nodes,
     const GroundBvh& ground_bvh,
     const Bijection<FixedArray<double, 3, 3>>* to_meters,
-    const Sample_SoloMesh* ssm);
+    const NavigationMeshQuery* navmesh);
 
 }
@@ -8,7 +8,7 @@
 #include <Mlib/Math/Fixed_Cholesky.hpp>
 #include <Mlib/Math/Orderable_Fixed_Array.hpp>
 #include <Mlib/Math/Transformation/Bijection.hpp>
-#include <Mlib/Navigation/Sample_SoloMesh.hpp>
+#include <Mlib/Navigation/Navigation_Mesh_Query.hpp>
 #include <Mlib/Navigation/Shortest_Path_Intermediate_Points_Creator.hpp>
 #include <Mlib/Osm_Loader/Osm_Map_Resource/Ground_Bvh.hpp>
 #include <Mlib/Osm_Loader/Osm_Map_Resource/Osm_Map_Resource_Helpers.hpp>
@@ -28,7 +28,7 @@ void Mlib::calculate_waypoint_adjacency(
     const std::map<std::string, Node>& nodes,
     const GroundBvh& ground_bvh,
     const Bijection<FixedArray<double, 3, 3>>* to_meters,
-    const Sample_SoloMesh* ssm,
+    const NavigationMeshQuery* navmesh,
     double scale,
     double merge_radius,
     double error_radius,
@@ -170,14 +170,14 @@ void Mlib::calculate_waypoint_adjacency(
         }
         return res;
     };
-    if (!ssm != !to_meters) {
+    if (!navmesh != !to_meters) {
         throw std::runtime_error("Inconsistent to-meters mapping an navmesh parameters");
     }
     auto idef = interpolate_default<WayPoint>;
     InterpolatedIntermediatePointsCreator<WayPoint, decltype(idef)> default_iipc{
         waypoint_distance,
         idef };
-    if (ssm != nullptr) {
+    if (navmesh != nullptr) {
         std::map<OrderableFixedArray<CompressedScenePos, 3>, dtPolyRef> poly_refs;
         for (auto&& [i, p] : enumerate(way_points.points)) {
             auto pm = dot1d(to_meters->model, funpack(p.position));
@@ -185,7 +185,7 @@ void Mlib::calculate_waypoint_adjacency(
                 p.position = pm.casted<CompressedScenePos>();
                 continue;
             }
-            auto lp = ssm->closest_point_on_navmesh(pm.casted<float>());
+            auto lp = navmesh->closest_point_on_navmesh(pm.casted<float>());
             if (!lp.has_value()) {
                 throw PointException<CompressedScenePos, 3>{ p.position, "Could not find closest point on navmesh" };
             }
@@ -196,7 +196,7 @@ void Mlib::calculate_waypoint_adjacency(
             p.position = lp->position.casted<CompressedScenePos>();
         }
         way_points.update_adjacency();
-        ShortestPathIntermediatePointsCreator spipc{ *ssm, poly_refs, (float)waypoint_distance };
+        ShortestPathIntermediatePointsCreator spipc{ *navmesh, poly_refs, (float)waypoint_distance };
         try {
             way_points.subdivide(
                 [&](size_t r, size_t c, const CompressedScenePos& distance) -> std::vector<WayPoint> {
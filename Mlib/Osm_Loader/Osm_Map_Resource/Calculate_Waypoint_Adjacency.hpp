@@ -18,7 +18,7 @@ struct TerrainWayPoints;
 struct Node;
 class GroundBvh;
 struct StreetWayPoint;
-class Sample_SoloMesh;
+class NavigationMeshQuery;
 enum class WayPointsClass;
 template <class T>
 struct Bijection;
@@ -31,7 +31,7 @@ void calculate_waypoint_adjacency(
     const std::map<std::string, Node>& nodes,
     const GroundBvh& ground_bvh,
     const Bijection<FixedArray<double, 3, 3>>* to_meters,
-    const Sample_SoloMesh* ssm,
+    const NavigationMeshQuery* navmesh,
     double scale,
     double merge_radius,
     double error_radius,
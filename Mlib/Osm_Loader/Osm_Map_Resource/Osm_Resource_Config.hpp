@@ -257,6 +257,10 @@ struct OsmResourceConfig {
     VariableAndHash<std::string> navmesh_resource;
     bool refine_explicit_waypoints = true;
     float agent_radius = 0.6f;
+    // Edge length of the navmesh tiles in cells, zero for a single mesh.
+    // Tiles are opt-in until the tiled pipeline is validated against
+    // the single mesh.
+    float navmesh_tile_size = 0.f;
 };
 
 }
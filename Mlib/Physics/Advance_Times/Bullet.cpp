@@ -2,11 +2,10 @@
 #include <Mlib/Audio/Audio_Entity_State.hpp>
 #include <Mlib/Geometry/Coordinates/Gl_Look_At.hpp>
 #include <Mlib/Math/Fixed_Rodrigues.hpp>
+#include <Mlib/Physics/Bullets/Bullet_Impact.hpp>
 #include <Mlib/Physics/Bullets/Bullet_Properties.hpp>
 #include <Mlib/Physics/Containers/Advance_Times.hpp>
 #include <Mlib/Physics/Dynamic_Lights/Dynamic_Lights.hpp>
-#include <Mlib/Physics/Interfaces/Damage_Source.hpp>
-#include <Mlib/Physics/Interfaces/IDamageable.hpp>
 #include <Mlib/Physics/Interfaces/IPlayer.hpp>
 #include <Mlib/Physics/Interfaces/ITeam.hpp>
 #include <Mlib/Physics/Rigid_Body/Rigid_Body_Vehicle.hpp>
@@ -138,7 +137,12 @@ void Bullet::notify_collided(
     }
     lifetime_ = INFINITY;
     collision_type = CollisionType::GO_THROUGH;
-    cause_damage(intersection_point, rigid_body);
+    apply_bullet_damage(
+        rigid_bodies_,
+        props_,
+        intersection_point,
+        rigid_body,
+        [this](RigidBodyVehicle& rb){ notify_kill(rb); });
     if (!props_.dynamic_light_configuration_after_impact.empty()) {
         auto func = [&b = rigid_body.rbp_]() { return b.abs_position(); };
         light_after_impact_ = dynamic_lights_.instantiate(props_.dynamic_light_configuration_after_impact, func, world.time, CURRENT_SOURCE_LOCATION);
@@ -146,27 +150,13 @@ void Bullet::notify_collided(
     if (light_before_impact_ != nullptr) {
         light_before_impact_ = nullptr;
     }
-    for (const auto& e : props_.explosions) {
-        if (e.materials.has_value() &&
-            !e.materials->contains(physics_material & PhysicsMaterial::SURFACE_BASE_MASK))
-        {
-            continue;
-        }
-        smoke_generator_.generate_root(
-            e.resource_name,
-            VariableAndHash<std::string>{"explosion" + smoke_generator_.generate_suffix()},
-            intersection_point,
-            fixed_zeros<float, 3>(),
-            fixed_zeros<float, 3>(),
-            INFINITY,
-            0.f,
-            e.animation_time,
-            e.particle_container,
-            world);
-        if (generate_bullet_explosion_audio_ && !e.audio_resource_name->empty()) {
-            generate_bullet_explosion_audio_({intersection_point, fixed_zeros<float, 3>()}, e.audio_resource_name);
-        }
-    }
+    generate_bullet_explosions(
+        smoke_generator_,
+        generate_bullet_explosion_audio_,
+        props_,
+        intersection_point,
+        physics_material,
+        world);
     if (trace_extender_ != nullptr) {
         trace_extender_->append_location(
             TransformationMatrix<float, ScenePos, 3>{rigid_body_vehicle_->rbp_.rotation_, intersection_point},
@@ -182,43 +172,3 @@ void Bullet::notify_kill(RigidBodyVehicle& rigid_body_vehicle) {
         team_->notify_kill(rigid_body_vehicle);
     }
 }
-
-void Bullet::cause_damage(RigidBodyVehicle& rigid_body, float amount) {
-    if (rigid_body.damageable_ == nullptr) {
-        return;
-    }
-    if (rigid_body.damageable_->health() <= 0.f) {
-        return;
-    }
-    rigid_body.damageable_->damage(amount, DamageSource::BULLET);
-    if (rigid_body.damageable_->health() <= 0.f) {
-        notify_kill(const_cast<RigidBodyVehicle&>(rigid_body));
-        for (const auto& [p, _] : rigid_body.passengers_) {
-            cause_damage(*p.get(), INFINITY);
-        }
-    }
-}
-
-void Bullet::cause_damage(
-    const FixedArray<ScenePos, 3>& intersection_point,
-    RigidBodyVehicle& rigid_body)
-{
-    if (props_.damage_radius == 0) {
-        cause_damage(rigid_body, props_.damage);
-    } else {
-        for (const auto& rbm : rigid_bodies_.objects()) {
-            const RigidBodyVehicle& rb = rbm.rigid_body.get();
-            if ((rb.damageable_ == nullptr) ||
-                (rb.damageable_->health() <= 0.f) ||
-                rb.is_deactivated())
-            {
-                continue;
-            }
-            ScenePos dist2 = sum(squared(rb.rbp_.abs_position() - intersection_point));
-            if (dist2 > squared(props_.damage_radius)) {
-                continue;
-            }
-            cause_damage(const_cast<RigidBodyVehicle&>(rb), props_.damage);
-        }
-    }
-}
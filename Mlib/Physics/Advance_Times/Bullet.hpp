@@ -69,12 +69,6 @@ public:
         CollisionType& collision_type,
         bool& abort) override;
 private:
-    void cause_damage(
-        const FixedArray<ScenePos, 3>& intersection_point,
-        RigidBodyVehicle& rigid_body);
-    void cause_damage(
-        RigidBodyVehicle& rigid_body,
-        float amount);
     void notify_kill(RigidBodyVehicle& rigid_body_vehicle);
     Scene& scene_;
     std::function<void(const AudioSourceState<ScenePos>&, const VariableAndHash<std::string>&)> generate_bullet_explosion_audio_;
@@ -155,7 +155,13 @@ void CheckPoints::advance_time_only(float dt, const SceneTime& time) {
         auto old_progress = track_reader_.has_value()
             ? track_reader_.progress()
             : NAN;
-        if (!track_reader_.read(progress_)) {
+        std::vector<TrackHeightSample> history;
+        if (!track_reader_.read(progress_, [&history](const TrackElementExtended& e){
+            history.emplace_back(
+                e.progress(TrackElementInterpolationKey::METERS_TO_START),
+                e.transformation().position(1));
+        }))
+        {
             break;
         }
         progress_ += distance_ / meters;
@@ -164,7 +170,7 @@ void CheckPoints::advance_time_only(float dt, const SceneTime& time) {
         }
         checkpoints_ahead_.push_back(CheckPointPose{
             .track_element = track_reader_.track_element(),
-            .history = std::move(track_reader_.history()),
+            .history = std::move(history),
             .progress = track_reader_.progress(),
             .lap_index = track_reader_.lap_id()});
         if (i01_ == beacon_nodes_.size()) {
@@ -226,10 +232,10 @@ void CheckPoints::advance_time_only(float dt, const SceneTime& time) {
         const auto& new_element = checkpoints_ahead_.front().track_element;
         const auto& new_location = new_element.transformation();
         if (sum(squared((*moving_nodes_.begin())->position() - new_location.position)) < squared(radius_)) {
-            history_.splice(history_.end(), history);
+            history_.insert(history_.end(), history.begin(), history.end());
             auto new_meters_to_start = new_element.progress(TrackElementInterpolationKey::METERS_TO_START);
-            history_.remove_if([&](const TrackElementExtended& p){
-                return new_meters_to_start - p.progress(TrackElementInterpolationKey::METERS_TO_START) > respawn_config_.vehicle_length;
+            history_.remove_if([&](const TrackHeightSample& p){
+                return new_meters_to_start - p.meters_to_start > respawn_config_.vehicle_length;
             });
             straight_checkpoints_.remove_if([&](const TrafoAndMetersToStart& p){
                 return new_meters_to_start - p.meters_to_start > respawn_config_.max_respawn_distance;
@@ -248,9 +254,7 @@ void CheckPoints::advance_time_only(float dt, const SceneTime& time) {
                         } else if (progress - straight_progress_ > respawn_config_.vehicle_length) {
                             auto& lsc = straight_checkpoints_.emplace_back(new_location.to_matrix(), new_meters_to_start);
                             for (const auto& e : history_) {
-                                lsc.trafo.t(1) = std::max(
-                                    lsc.trafo.t(1),
-                                    e.element.transformation().position(1));
+                                lsc.trafo.t(1) = std::max(lsc.trafo.t(1), e.y);
                             }
                         }
                     }
@@ -10,7 +10,9 @@
 #include <Mlib/Physics/Misc/Track_Reader.hpp>
 #include <Mlib/Scene_Graph/Remote_User_Filter.hpp>
 #include <fstream>
+#include <list>
 #include <mutex>
+#include <vector>
 
 namespace Mlib {
 
@@ -26,9 +28,15 @@ enum class RaceState;
 class RenderingResources;
 class SceneTime;
 
+// Height of a track element that was passed on the way to a checkpoint.
+struct TrackHeightSample {
+    double meters_to_start;
+    ScenePos y;
+};
+
 struct CheckPointPose {
     TrackElementExtended track_element;
-    std::list<TrackElementExtended> history;
+    std::vector<TrackHeightSample> history;
     double progress;
     size_t lap_index;
     BeaconNode* beacon_node;
@@ -114,7 +122,7 @@ private:
     std::optional<FixedArray<ScenePos, 3>> last_direction_;
     std::optional<FixedArray<ScenePos, 3>> last_reached_checkpoint_;
     std::list<TrafoAndMetersToStart> straight_checkpoints_;
-    std::list<TrackElementExtended> history_;
+    std::list<TrackHeightSample> history_;
     bool enable_height_changed_mode_;
     FixedArray<float, 3> selection_emissive_;
     FixedArray<float, 3> deselection_emissive_;
@@ -0,0 +1,150 @@
+#include "Lightweight_Bullets.hpp"
+#include <Mlib/Math/Fixed_Scaled_Unit_Vector.hpp>
+#include <Mlib/Os/Os.hpp>
+#include <Mlib/Physics/Bullets/Bullet_Properties.hpp>
+#include <Mlib/Physics/Interfaces/IPlayer.hpp>
+#include <Mlib/Physics/Interfaces/ITeam.hpp>
+#include <Mlib/Physics/Rigid_Body/Rigid_Body_Vehicle.hpp>
+#include <Mlib/Scene_Graph/Instances/Static_World.hpp>
+#include <stdexcept>
+
+using namespace Mlib;
+
+LightweightBulletShooter::LightweightBulletShooter(
+    const DanglingBaseClassPtr<IPlayer>& gunner,
+    const DanglingBaseClassPtr<ITeam>& team)
+    : gunner{ gunner }
+    , team{ team }
+    , nprojectiles{ 0 }
+    , gunner_on_destroy{ (gunner != nullptr) ? &gunner->on_destroy_player() : nullptr, CURRENT_SOURCE_LOCATION }
+    , team_on_destroy{ (team != nullptr) ? &team->on_destroy_team() : nullptr, CURRENT_SOURCE_LOCATION }
+{}
+
+LightweightBulletShooter::~LightweightBulletShooter() = default;
+
+LightweightBullets::LightweightBullets(
+    const CollisionQuery& collision_query,
+    RigidBodies& rigid_bodies,
+    SmokeParticleGenerator& smoke_generator,
+    GenerateBulletExplosionAudio generate_bullet_explosion_audio)
+    : collision_query_{ collision_query }
+    , rigid_bodies_{ rigid_bodies }
+    , smoke_generator_{ smoke_generator }
+    , generate_bullet_explosion_audio_{ std::move(generate_bullet_explosion_audio) }
+    , next_shooter_id_{ 0 }
+{}
+
+LightweightBullets::~LightweightBullets() {
+    on_destroy.clear();
+}
+
+void LightweightBullets::fire(
+    const BulletProperties& props,
+    const FixedArray<ScenePos, 3>& position,
+    const FixedArray<float, 3>& velocity,
+    const RigidBodyVehicle* owner,
+    const DanglingBaseClassPtr<IPlayer>& gunner,
+    const DanglingBaseClassPtr<ITeam>& team)
+{
+    auto p = properties_id(props);
+    auto s = shooter_id(gunner, team);
+    pool_.fire(position, velocity, p, owner, s);
+    ++shooters_.at(s).nprojectiles;
+}
+
+void LightweightBullets::advance_time(float dt, const StaticWorld& world) {
+    pool_.advance_time(
+        dt,
+        (world.gravity == nullptr) ? fixed_zeros<float, 3>() : world.gravity->vector,
+        (world.wind == nullptr) ? fixed_zeros<float, 3>() : world.wind->vector,
+        collision_query_,
+        [&](const ProjectileHit& hit){ notify_hit(hit, world); },
+        [this](uint32_t shooter){ notify_removed(shooter); });
+}
+
+uint32_t LightweightBullets::properties_id(const BulletProperties& props) {
+    // The properties are identified by name, not by address, s.t.
+    // copies share one entry in the pool.
+    if (props.name->empty()) {
+        throw std::runtime_error("Lightweight bullet properties have no name");
+    }
+    auto it = properties_ids_.find(props.name);
+    if (it != properties_ids_.end()) {
+        return it->second;
+    }
+    auto id = pool_.add_properties(ProjectileProperties{
+        .max_lifetime = props.max_lifetime,
+        .drag_coefficient = props.drag_coefficient});
+    properties_.push_back(&props);
+    properties_ids_.try_emplace(props.name, id);
+    return id;
+}
+
+uint32_t LightweightBullets::shooter_id(
+    const DanglingBaseClassPtr<IPlayer>& gunner,
+    const DanglingBaseClassPtr<ITeam>& team)
+{
+    auto key = std::make_pair(gunner.get(), team.get());
+    auto it = shooter_ids_.find(key);
+    if (it != shooter_ids_.end()) {
+        return it->second;
+    }
+    auto id = next_shooter_id_++;
+    auto& s = shooters_.try_emplace(id, gunner, team).first->second;
+    shooter_ids_.try_emplace(key, id);
+    // Forget the key on destruction, s.t. a new object at the same
+    // address gets a new shooter.
+    if (!s.gunner_on_destroy.is_null()) {
+        s.gunner_on_destroy.add([this, &s, key](){
+            s.gunner = nullptr;
+            shooter_ids_.erase(key);
+        }, CURRENT_SOURCE_LOCATION);
+    }
+    if (!s.team_on_destroy.is_null()) {
+        s.team_on_destroy.add([this, &s, key](){
+            s.team = nullptr;
+            shooter_ids_.erase(key);
+        }, CURRENT_SOURCE_LOCATION);
+    }
+    return id;
+}
+
+void LightweightBullets::notify_hit(const ProjectileHit& hit, const StaticWorld& world) {
+    const auto& props = *properties_.at(hit.properties);
+    const auto& shooter = shooters_.at(hit.tag);
+    apply_bullet_damage(
+        rigid_bodies_,
+        props,
+        hit.position,
+        hit.rigid_body,
+        [&shooter](RigidBodyVehicle& rb){
+            if (shooter.gunner != nullptr) {
+                shooter.gunner->notify_kill(rb);
+            } else if (shooter.team != nullptr) {
+                shooter.team->notify_kill(rb);
+            }
+        });
+    generate_bullet_explosions(
+        smoke_generator_,
+        generate_bullet_explosion_audio_,
+        props,
+        hit.position,
+        hit.physics_material,
+        world);
+}
+
+void LightweightBullets::notify_removed(uint32_t shooter) {
+    auto it = shooters_.find(shooter);
+    if (it == shooters_.end()) {
+        verbose_abort("LightweightBullets: Unknown shooter");
+    }
+    if (--it->second.nprojectiles != 0) {
+        return;
+    }
+    auto key = std::make_pair(it->second.gunner.get(), it->second.team.get());
+    auto kit = shooter_ids_.find(key);
+    if ((kit != shooter_ids_.end()) && (kit->second == shooter)) {
+        shooter_ids_.erase(kit);
+    }
+    shooters_.erase(it);
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include <Mlib/Hashing/Variable_And_Hash.hpp>
+#include <Mlib/Memory/Dangling_Base_Class.hpp>
+#include <Mlib/Memory/Destruction_Functions.hpp>
+#include <Mlib/Physics/Bullets/Bullet_Impact.hpp>
+#include <Mlib/Physics/Bullets/Projectile_Pool.hpp>
+#include <Mlib/Physics/Containers/Collision_Query.hpp>
+#include <Mlib/Physics/Interfaces/IAdvance_Time.hpp>
+#include <Mlib/Scene_Config/Scene_Precision.hpp>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Mlib {
+
+class RigidBodies;
+class RigidBodyVehicle;
+class SmokeParticleGenerator;
+class IPlayer;
+class ITeam;
+struct BulletProperties;
+struct ProjectileHit;
+
+struct LightweightBulletShooter {
+    LightweightBulletShooter(
+        const DanglingBaseClassPtr<IPlayer>& gunner,
+        const DanglingBaseClassPtr<ITeam>& team);
+    ~LightweightBulletShooter();
+    DanglingBaseClassPtr<IPlayer> gunner;
+    DanglingBaseClassPtr<ITeam> team;
+    size_t nprojectiles;
+    DestructionFunctionsRemovalTokens gunner_on_destroy;
+    DestructionFunctionsRemovalTokens team_on_destroy;
+};
+
+// Bullets without scene node, rigid body or renderable, stored in a
+// "ProjectilePool". Used for bullets with the "lightweight" flag,
+// e.g. machine gun rounds. Hits cause the same damage and explosions
+// as "Bullet".
+class LightweightBullets final: public IAdvanceTime, public virtual DanglingBaseClass {
+    LightweightBullets(const LightweightBullets&) = delete;
+    LightweightBullets& operator = (const LightweightBullets&) = delete;
+public:
+    LightweightBullets(
+        const CollisionQuery& collision_query,
+        RigidBodies& rigid_bodies,
+        SmokeParticleGenerator& smoke_generator,
+        GenerateBulletExplosionAudio generate_bullet_explosion_audio);
+    ~LightweightBullets();
+    void fire(
+        const BulletProperties& props,
+        const FixedArray<ScenePos, 3>& position,
+        const FixedArray<float, 3>& velocity,
+        const RigidBodyVehicle* owner,
+        const DanglingBaseClassPtr<IPlayer>& gunner,
+        const DanglingBaseClassPtr<ITeam>& team);
+    virtual void advance_time(float dt, const StaticWorld& world) override;
+    inline size_t size() const {
+        return pool_.size();
+    }
+private:
+    uint32_t properties_id(const BulletProperties& props);
+    uint32_t shooter_id(
+        const DanglingBaseClassPtr<IPlayer>& gunner,
+        const DanglingBaseClassPtr<ITeam>& team);
+    void notify_hit(const ProjectileHit& hit, const StaticWorld& world);
+    void notify_removed(uint32_t shooter);
+    CollisionQuery collision_query_;
+    RigidBodies& rigid_bodies_;
+    SmokeParticleGenerator& smoke_generator_;
+    GenerateBulletExplosionAudio generate_bullet_explosion_audio_;
+    ProjectilePool pool_;
+    std::unordered_map<VariableAndHash<std::string>, uint32_t> properties_ids_;
+    std::vector<const BulletProperties*> properties_;
+    std::map<std::pair<const IPlayer*, const ITeam*>, uint32_t> shooter_ids_;
+    std::unordered_map<uint32_t, LightweightBulletShooter> shooters_;
+    uint32_t next_shooter_id_;
+};
+
+}
@@ -0,0 +1,206 @@
+#include "Kinematic_Traffic.hpp"
+#include <Mlib/Geometry/Graph/Points_And_Adjacency.hpp>
+#include <Mlib/Geometry/Primitives/Bvh.hpp>
+#include <Mlib/Iterator/Enumerate.hpp>
+#include <Mlib/Math/Fixed_Math.hpp>
+#include <Mlib/Scene_Graph/Interfaces/Way_Points.hpp>
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
+using namespace Mlib;
+
+KinematicTraffic::KinematicTraffic(
+    std::shared_ptr<const WayPointsAndBvh> waypoints,
+    const KinematicTrafficConfig& cfg)
+    : waypoints_{ std::move(waypoints) }
+    , cfg_{ cfg }
+    , max_edge_length_{ 0 }
+    , rng_{ 0 }
+{
+    if (waypoints_ == nullptr) {
+        throw std::runtime_error("KinematicTraffic: waypoints are null");
+    }
+    for (const auto& [c, column] : enumerate(waypoints_->way_points.adjacency.columns())) {
+        for (const auto& [r, _] : column) {
+            max_edge_length_ = std::max(max_edge_length_, (ScenePos)edge_length((uint32_t)c, r));
+        }
+    }
+}
+
+KinematicTraffic::~KinematicTraffic() = default;
+
+FixedArray<ScenePos, 3> KinematicTraffic::point(uint32_t i) const {
+    return funpack(waypoints_->way_points.points[i].position);
+}
+
+float KinematicTraffic::edge_length(uint32_t from, uint32_t to) const {
+    return (float)std::sqrt(sum(squared(point(to) - point(from))));
+}
+
+const KinematicTraffic::Vehicle& KinematicTraffic::vehicle(uint32_t id) const {
+    if ((id >= indices_.size()) || (indices_[id] == UINT32_MAX)) {
+        throw std::runtime_error("Unknown kinematic vehicle: " + std::to_string(id));
+    }
+    return vehicles_[indices_[id]];
+}
+
+std::optional<uint32_t> KinematicTraffic::try_add(
+    const FixedArray<ScenePos, 3>& position,
+    const FixedArray<float, 3>& direction,
+    float speed,
+    ScenePos max_distance)
+{
+    const auto& wp = waypoints_->way_points;
+    auto dir = direction.casted<ScenePos>();
+    std::optional<Vehicle> best;
+    ScenePos best_dist2 = squared(max_distance);
+    // The start point of the closest edge can be up to one edge length
+    // further away than the edge itself.
+    waypoints_->bvh.visit(
+        AxisAlignedBoundingBox<CompressedScenePos, 3>::from_center_and_radius(
+            position.casted<CompressedScenePos>(),
+            (CompressedScenePos)(max_distance + max_edge_length_)),
+        [&](size_t i)
+    {
+        auto pi = point((uint32_t)i);
+        for (const auto& [j, _] : wp.adjacency.column((uint32_t)i)) {
+            if (j == i) {
+                continue;
+            }
+            auto d = point(j) - pi;
+            auto len = std::sqrt(sum(squared(d)));
+            if (len < 1e-6) {
+                continue;
+            }
+            auto u = d / len;
+            // Do not snap onto the opposite lane or onto crossing streets.
+            if (dot0d(u, dir) < std::cos(45. * degrees)) {
+                continue;
+            }
+            auto s = std::clamp(dot0d(position - pi, u), 0., len);
+            auto dist2 = sum(squared(pi + u * s - position));
+            if (dist2 < best_dist2) {
+                best_dist2 = dist2;
+                best = Vehicle{
+                    .id = UINT32_MAX,
+                    .from = (uint32_t)i,
+                    .to = j,
+                    .s = (float)s,
+                    .length = (float)len,
+                    .speed = std::clamp(speed, 0.f, cfg_.max_speed)};
+            }
+        }
+        return true;
+    });
+    if (!best.has_value()) {
+        return std::nullopt;
+    }
+    if (free_ids_.empty()) {
+        best->id = (uint32_t)indices_.size();
+        indices_.push_back(UINT32_MAX);
+    } else {
+        best->id = free_ids_.back();
+        free_ids_.pop_back();
+    }
+    indices_[best->id] = (uint32_t)vehicles_.size();
+    vehicles_.push_back(*best);
+    return best->id;
+}
+
+KinematicVehicleState KinematicTraffic::remove(uint32_t id) {
+    auto result = state(id);
+    auto i = indices_[id];
+    vehicles_[i] = vehicles_.back();
+    indices_[vehicles_[i].id] = i;
+    vehicles_.pop_back();
+    indices_[id] = UINT32_MAX;
+    free_ids_.push_back(id);
+    return result;
+}
+
+KinematicVehicleState KinematicTraffic::state(uint32_t id) const {
+    const auto& v = vehicle(id);
+    auto p0 = point(v.from);
+    auto d = point(v.to) - p0;
+    FixedArray<float, 3> direction = (d / (ScenePos)std::max(v.length, 1e-6f)).casted<float>();
+    return KinematicVehicleState{
+        .position = p0 + direction.casted<ScenePos>() * (ScenePos)v.s,
+        .direction = direction,
+        .speed = v.speed,
+        .target_waypoint_id = v.to};
+}
+
+uint32_t KinematicTraffic::successor(uint32_t from, uint32_t to) {
+    const auto& column = waypoints_->way_points.adjacency.column(to);
+    uint32_t candidates[8];
+    size_t ncandidates = 0;
+    for (const auto& [r, _] : column) {
+        if ((r == to) || (r == from)) {
+            continue;
+        }
+        if (ncandidates == std::size(candidates)) {
+            break;
+        }
+        candidates[ncandidates++] = r;
+    }
+    if (ncandidates == 0) {
+        // Dead end, turn around if possible.
+        return column.contains(from) ? from : to;
+    }
+    return candidates[rng_() % ncandidates];
+}
+
+void KinematicTraffic::advance_time(float dt) {
+    // Sort the vehicles by edge and by their position on the edge,
+    // s.t. the vehicle in front is the next one in "order_".
+    // The order of the previous step is almost sorted, because only the
+    // vehicles that reached a new edge change their position in it.
+    auto less = [this](uint32_t a, uint32_t b){
+        const auto& va = vehicles_[a];
+        const auto& vb = vehicles_[b];
+        if (va.from != vb.from) {
+            return va.from < vb.from;
+        }
+        if (va.to != vb.to) {
+            return va.to < vb.to;
+        }
+        return va.s < vb.s;
+    };
+    if (order_.size() != vehicles_.size()) {
+        order_.resize(vehicles_.size());
+        std::iota(order_.begin(), order_.end(), 0);
+        std::sort(order_.begin(), order_.end(), less);
+    } else if (!std::is_sorted(order_.begin(), order_.end(), less)) {
+        std::stable_sort(order_.begin(), order_.end(), less);
+    }
+    for (size_t k = 0; k < order_.size(); ++k) {
+        auto& v = vehicles_[order_[k]];
+        auto speed = std::min(v.speed + cfg_.acceleration * dt, cfg_.max_speed);
+        if (k + 1 < order_.size()) {
+            const auto& leader = vehicles_[order_[k + 1]];
+            if ((leader.from == v.from) && (leader.to == v.to)) {
+                auto gap = leader.s - v.s - cfg_.min_gap;
+                speed = std::min(speed, std::max(0.f, gap) / cfg_.headway);
+            }
+        }
+        v.speed = speed;
+    }
+    for (auto& v : vehicles_) {
+        v.s += v.speed * dt;
+        // Bounded, in case of zero-length edges.
+        for (size_t i = 0; (i < 8) && (v.s >= v.length); ++i) {
+            auto next = successor(v.from, v.to);
+            if (next == v.to) {
+                v.s = v.length;
+                v.speed = 0.f;
+                break;
+            }
+            v.s -= v.length;
+            v.from = v.to;
+            v.to = next;
+            v.length = edge_length(v.from, v.to);
+        }
+        v.s = std::min(v.s, v.length);
+    }
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include <Mlib/Array/Fixed_Array.hpp>
+#include <Mlib/Physics/Units.hpp>
+#include <Mlib/Scene_Config/Scene_Precision.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <random>
+#include <vector>
+
+namespace Mlib {
+
+struct WayPointsAndBvh;
+
+struct KinematicTrafficConfig {
+    float max_speed = 50 * kph;
+    float acceleration = 2 * meters / (seconds * seconds);
+    // Distance between the origins of two consecutive vehicles at standstill.
+    float min_gap = 8 * meters;
+    // Time gap kept to the vehicle in front.
+    float headway = 1.5f * seconds;
+};
+
+struct KinematicVehicleState {
+    FixedArray<ScenePos, 3> position;
+    FixedArray<float, 3> direction;
+    float speed;
+    size_t target_waypoint_id;
+};
+
+// Cheap path follower for vehicles far away from any VIP.
+// The vehicles move along the edges of a waypoint graph without contacts.
+// They only keep a distance to the vehicle in front on the same edge, and
+// choose a random successor edge at each waypoint.
+class KinematicTraffic {
+    KinematicTraffic(const KinematicTraffic&) = delete;
+    KinematicTraffic& operator = (const KinematicTraffic&) = delete;
+public:
+    explicit KinematicTraffic(
+        std::shared_ptr<const WayPointsAndBvh> waypoints,
+        const KinematicTrafficConfig& cfg = KinematicTrafficConfig{});
+    ~KinematicTraffic();
+    // Snaps the vehicle to the closest edge roughly aligned with "direction",
+    // if it is less than "max_distance" away.
+    // Returns the ID of the vehicle, or "std::nullopt" if no edge was found.
+    std::optional<uint32_t> try_add(
+        const FixedArray<ScenePos, 3>& position,
+        const FixedArray<float, 3>& direction,
+        float speed,
+        ScenePos max_distance);
+    KinematicVehicleState remove(uint32_t id);
+    KinematicVehicleState state(uint32_t id) const;
+    void advance_time(float dt);
+    inline size_t size() const {
+        return vehicles_.size();
+    }
+    inline const std::shared_ptr<const WayPointsAndBvh>& waypoints() const {
+        return waypoints_;
+    }
+private:
+    struct Vehicle {
+        uint32_t id;
+        uint32_t from;
+        uint32_t to;
+        float s;
+        float length;
+        float speed;
+    };
+    const Vehicle& vehicle(uint32_t id) const;
+    FixedArray<ScenePos, 3> point(uint32_t i) const;
+    float edge_length(uint32_t from, uint32_t to) const;
+    // Returns the next waypoint, avoiding U-turns where possible.
+    uint32_t successor(uint32_t from, uint32_t to);
+    std::shared_ptr<const WayPointsAndBvh> waypoints_;
+    KinematicTrafficConfig cfg_;
+    std::vector<Vehicle> vehicles_;
+    // Vehicle index for each ID, "UINT32_MAX" for unused IDs.
+    std::vector<uint32_t> indices_;
+    std::vector<uint32_t> free_ids_;
+    std::vector<uint32_t> order_;
+    ScenePos max_edge_length_;
+    std::mt19937 rng_;
+};
+
+}
@@ -5,6 +5,7 @@
 #include <Mlib/Geometry/Mesh/Animated_Colored_Vertex_Arrays.hpp>
 #include <Mlib/Memory/Object_Pool.hpp>
 #include <Mlib/Physics/Advance_Times/Bullet.hpp>
+#include <Mlib/Physics/Advance_Times/Lightweight_Bullets.hpp>
 #include <Mlib/Physics/Bullets/Bullet_Properties.hpp>
 #include <Mlib/Physics/Bullets/Bullet_Property_Db.hpp>
 #include <Mlib/Physics/Collision/Collidable_Mode.hpp>
@@ -60,10 +61,18 @@ BulletGenerator::BulletGenerator(
     , dynamic_world_{ dynamic_world }
     , generate_bullet_explosion_audio_{ std::move(generate_bullet_explosion_audio) }
     , generate_bullet_engine_audio_{ std::move(generate_bullet_engine_audio) }
+    , lightweight_bullets_{ nullptr }
 {}
 
 BulletGenerator::~BulletGenerator() = default;
 
+void BulletGenerator::set_lightweight_bullets(LightweightBullets& lightweight_bullets) {
+    if (lightweight_bullets_ != nullptr) {
+        throw std::runtime_error("Lightweight bullets already set");
+    }
+    lightweight_bullets_ = &lightweight_bullets;
+}
+
 void BulletGenerator::generate_bullet(
     const BulletProperties& bullet_properties,
     const GenerateSmartBullet& generate_smart_bullet,
@@ -74,6 +83,21 @@ void BulletGenerator::generate_bullet(
     const DanglingBaseClassPtr<IPlayer>& player,
     const DanglingBaseClassPtr<ITeam>& team) const
 {
+    // Bullets that need a rigid body are never pooled.
+    if (bullet_properties.lightweight &&
+        (lightweight_bullets_ != nullptr) &&
+        !generate_smart_bullet &&
+        bullet_properties.hitbox_resource_name->empty())
+    {
+        lightweight_bullets_->fire(
+            bullet_properties,
+            location.t,
+            velocity,
+            non_collider.get(),
+            player,
+            team);
+        return;
+    }
     StaticWorld world{
         .geographic_mapping = dynamic_world_.get_geographic_mapping(),
         .inverse_geographic_mapping = dynamic_world_.get_inverse_geographic_mapping(),
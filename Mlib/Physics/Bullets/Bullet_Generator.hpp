@@ -34,6 +34,7 @@ enum class RigidBodyVehicleFlags: uint32_t;
 template <class TPosition>
 struct AudioSourceState;
 class BulletPropertyDb;
+class LightweightBullets;
 class RenderingResources;
 struct RenderableResourceFilter;
 
@@ -66,6 +67,13 @@ public:
             const AudioSourceState<ScenePos>& state,
             const VariableAndHash<std::string>& audio_resource)> generate_bullet_engine_audio);
     ~BulletGenerator();
+    void set_lightweight_bullets(LightweightBullets& lightweight_bullets);
+    inline const std::function<void(
+        const AudioSourceState<ScenePos>& state,
+        const VariableAndHash<std::string>& audio_resource)>& generate_bullet_explosion_audio() const
+    {
+        return generate_bullet_explosion_audio_;
+    }
     void generate_bullet(
         const BulletProperties& bullet_properties,
         const GenerateSmartBullet& generate_smart_bullet,
@@ -100,6 +108,7 @@ private:
     std::function<UpdateAudioSourceState(
         const AudioSourceState<ScenePos>& state,
         const VariableAndHash<std::string>& audio_resource)> generate_bullet_engine_audio_;
+    LightweightBullets* lightweight_bullets_;
 };
 
 }
@@ -0,0 +1,90 @@
+#include "Bullet_Impact.hpp"
+#include <Mlib/Audio/Audio_Entity_State.hpp>
+#include <Mlib/Geometry/Physics_Material.hpp>
+#include <Mlib/Math/Fixed_Math.hpp>
+#include <Mlib/Physics/Bullets/Bullet_Properties.hpp>
+#include <Mlib/Physics/Containers/Rigid_Bodies.hpp>
+#include <Mlib/Physics/Interfaces/Damage_Source.hpp>
+#include <Mlib/Physics/Interfaces/IDamageable.hpp>
+#include <Mlib/Physics/Rigid_Body/Rigid_Body_Vehicle.hpp>
+#include <Mlib/Physics/Smoke_Generation/Smoke_Particle_Generator.hpp>
+
+using namespace Mlib;
+
+static void cause_damage(
+    RigidBodyVehicle& rigid_body,
+    float amount,
+    const std::function<void(RigidBodyVehicle& rigid_body)>& notify_kill)
+{
+    if (rigid_body.damageable_ == nullptr) {
+        return;
+    }
+    if (rigid_body.damageable_->health() <= 0.f) {
+        return;
+    }
+    rigid_body.damageable_->damage(amount, DamageSource::BULLET);
+    if (rigid_body.damageable_->health() <= 0.f) {
+        notify_kill(rigid_body);
+        for (const auto& [p, _] : rigid_body.passengers_) {
+            cause_damage(*p.get(), INFINITY, notify_kill);
+        }
+    }
+}
+
+void Mlib::apply_bullet_damage(
+    RigidBodies& rigid_bodies,
+    const BulletProperties& props,
+    const FixedArray<ScenePos, 3>& intersection_point,
+    RigidBodyVehicle& rigid_body,
+    const std::function<void(RigidBodyVehicle& rigid_body)>& notify_kill)
+{
+    if (props.damage_radius == 0) {
+        cause_damage(rigid_body, props.damage, notify_kill);
+    } else {
+        for (const auto& rbm : rigid_bodies.objects()) {
+            const RigidBodyVehicle& rb = rbm.rigid_body.get();
+            if ((rb.damageable_ == nullptr) ||
+                (rb.damageable_->health() <= 0.f) ||
+                rb.is_deactivated())
+            {
+                continue;
+            }
+            ScenePos dist2 = sum(squared(rb.rbp_.abs_position() - intersection_point));
+            if (dist2 > squared(props.damage_radius)) {
+                continue;
+            }
+            cause_damage(const_cast<RigidBodyVehicle&>(rb), props.damage, notify_kill);
+        }
+    }
+}
+
+void Mlib::generate_bullet_explosions(
+    SmokeParticleGenerator& smoke_generator,
+    const GenerateBulletExplosionAudio& generate_explosion_audio,
+    const BulletProperties& props,
+    const FixedArray<ScenePos, 3>& intersection_point,
+    PhysicsMaterial physics_material,
+    const StaticWorld& world)
+{
+    for (const auto& e : props.explosions) {
+        if (e.materials.has_value() &&
+            !e.materials->contains(physics_material & PhysicsMaterial::SURFACE_BASE_MASK))
+        {
+            continue;
+        }
+        smoke_generator.generate_root(
+            e.resource_name,
+            VariableAndHash<std::string>{"explosion" + smoke_generator.generate_suffix()},
+            intersection_point,
+            fixed_zeros<float, 3>(),
+            fixed_zeros<float, 3>(),
+            INFINITY,
+            0.f,
+            e.animation_time,
+            e.particle_container,
+            world);
+        if (generate_explosion_audio && !e.audio_resource_name->empty()) {
+            generate_explosion_audio({intersection_point, fixed_zeros<float, 3>()}, e.audio_resource_name);
+        }
+    }
+}
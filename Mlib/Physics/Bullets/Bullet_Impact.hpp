@@ -0,0 +1,44 @@
+#pragma once
+#include <Mlib/Hashing/Variable_And_Hash.hpp>
+#include <Mlib/Scene_Config/Scene_Precision.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace Mlib {
+
+template <typename TData, size_t... tshape>
+class FixedArray;
+template <class TPosition>
+struct AudioSourceState;
+class RigidBodies;
+class RigidBodyVehicle;
+class SmokeParticleGenerator;
+struct BulletProperties;
+struct StaticWorld;
+enum class PhysicsMaterial: uint32_t;
+
+using GenerateBulletExplosionAudio = std::function<void(
+    const AudioSourceState<ScenePos>& state,
+    const VariableAndHash<std::string>& audio_resource)>;
+
+// Damages the hit rigid body, or all rigid bodies within the damage
+// radius. "notify_kill" is called for every rigid body whose health
+// drops to zero.
+void apply_bullet_damage(
+    RigidBodies& rigid_bodies,
+    const BulletProperties& props,
+    const FixedArray<ScenePos, 3>& intersection_point,
+    RigidBodyVehicle& rigid_body,
+    const std::function<void(RigidBodyVehicle& rigid_body)>& notify_kill);
+
+void generate_bullet_explosions(
+    SmokeParticleGenerator& smoke_generator,
+    const GenerateBulletExplosionAudio& generate_explosion_audio,
+    const BulletProperties& props,
+    const FixedArray<ScenePos, 3>& intersection_point,
+    PhysicsMaterial physics_material,
+    const StaticWorld& world);
+
+}
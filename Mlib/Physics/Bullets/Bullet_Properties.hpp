@@ -24,6 +24,8 @@ struct BulletExplosion {
 };
 
 struct BulletProperties {
+    // Key in the "BulletPropertyDb", set by "BulletPropertyDb::add".
+    VariableAndHash<std::string> name;
     VariableAndHash<std::string> renderable_resource_name;
     VariableAndHash<std::string> hitbox_resource_name;
     VariableAndHash<std::string> engine_audio_resource_name;
@@ -39,6 +41,12 @@ struct BulletProperties {
     VariableAndHash<std::string> trace_storage;
     std::string dynamic_light_configuration_before_impact;
     std::string dynamic_light_configuration_after_impact;
+    // Simulate in a "ProjectilePool" instead of creating a scene node
+    // and rigid body. Only used for bullets without hitbox and smart
+    // bullet logic, renderables and trails are not drawn.
+    bool lightweight = false;
+    // Quadratic drag of lightweight bullets.
+    float drag_coefficient = 0.f;
 };
 
 }
@@ -10,7 +10,8 @@ BulletPropertyDb::BulletPropertyDb()
 BulletPropertyDb::~BulletPropertyDb() = default;
 
 void BulletPropertyDb::add(VariableAndHash<std::string> name, BulletProperties&& props) {
-    if (!properties_.try_emplace(std::move(name), std::move(props)).second) {
+    props.name = name;
+    if (!properties_.try_emplace(name, std::move(props)).second) {
         throw std::runtime_error("Bullet properties with name \"" + *name + "\" already exist");
     }
 }
@@ -0,0 +1,128 @@
+#include "Projectile_Pool.hpp"
+#include <Mlib/Geometry/Primitives/Collision_Polygon.hpp>
+#include <Mlib/Math/Fixed_Math.hpp>
+#include <Mlib/Physics/Containers/Collision_Query.hpp>
+#include <Mlib/Physics/Rigid_Body/Rigid_Body_Vehicle.hpp>
+#include <stdexcept>
+#include <variant>
+
+using namespace Mlib;
+
+ProjectilePool::ProjectilePool() = default;
+
+ProjectilePool::~ProjectilePool() = default;
+
+uint32_t ProjectilePool::add_properties(const ProjectileProperties& properties) {
+    properties_.push_back(properties);
+    return (uint32_t)(properties_.size() - 1);
+}
+
+void ProjectilePool::fire(
+    const FixedArray<ScenePos, 3>& position,
+    const FixedArray<float, 3>& velocity,
+    uint32_t properties,
+    const RigidBodyVehicle* owner,
+    uint32_t tag)
+{
+    if (properties >= properties_.size()) {
+        throw std::runtime_error("Projectile properties index out of bounds");
+    }
+    position_.push_back(position);
+    velocity_.push_back(velocity);
+    lifetime_.push_back(0.f);
+    owner_.push_back(owner);
+    properties_index_.push_back(properties);
+    tag_.push_back(tag);
+}
+
+void ProjectilePool::advance_time(
+    float dt,
+    const FixedArray<float, 3>& gravity,
+    const FixedArray<float, 3>& wind,
+    const CollisionQuery& collision_query,
+    const std::function<void(const ProjectileHit& hit)>& on_hit,
+    const std::function<void(uint32_t tag)>& on_remove)
+{
+    // Integrate all projectiles before any ray cast, s.t. the loop only
+    // touches the velocity and lifetime arrays.
+    for (size_t i = 0; i < size(); ++i) {
+        const auto& p = properties_[properties_index_[i]];
+        auto& v = velocity_[i];
+        if (p.drag_coefficient != 0.f) {
+            auto v_rel = v - wind;
+            v -= (dt * p.drag_coefficient * std::sqrt(sum(squared(v_rel)))) * v_rel;
+        }
+        v += dt * gravity;
+        lifetime_[i] += dt;
+    }
+    // Remove by swapping with the last element, which is visited next.
+    for (size_t i = 0; i < size();) {
+        const auto& p = properties_[properties_index_[i]];
+        if (lifetime_[i] > p.max_lifetime) {
+            remove(i, on_remove);
+            continue;
+        }
+        auto stop = position_[i] + (dt * velocity_[i]).casted<ScenePos>();
+        FixedArray<ScenePos, 3> intersection_point = uninitialized;
+        std::variant<const CollisionPolygonSphere<CompressedScenePos, 3>*, const CollisionPolygonSphere<CompressedScenePos, 4>*> polygon;
+        const RigidBodyVehicle* seen_object = nullptr;
+        if (!collision_query.can_see(
+            position_[i],
+            stop,
+            owner_[i],
+            nullptr,    // excluded1
+            false,      // only_terrain
+            p.collidable_mask,
+            &intersection_point,
+            &polygon,
+            &seen_object))
+        {
+            if (seen_object == nullptr) {
+                throw std::runtime_error("Projectile hit without object");
+            }
+            auto physics_material = std::visit([](const auto* polygon){
+                return (polygon == nullptr)
+                    ? PhysicsMaterial::NONE
+                    : polygon->physics_material;
+            }, polygon);
+            on_hit(ProjectileHit{
+                .position = intersection_point,
+                .velocity = velocity_[i],
+                .rigid_body = const_cast<RigidBodyVehicle&>(*seen_object),
+                .physics_material = physics_material,
+                .properties = properties_index_[i],
+                .tag = tag_[i]});
+            remove(i, on_remove);
+            continue;
+        }
+        position_[i] = stop;
+        ++i;
+    }
+}
+
+void ProjectilePool::clear() {
+    position_.clear();
+    velocity_.clear();
+    lifetime_.clear();
+    owner_.clear();
+    properties_index_.clear();
+    tag_.clear();
+}
+
+void ProjectilePool::remove(size_t i, const std::function<void(uint32_t tag)>& on_remove) {
+    if (on_remove) {
+        on_remove(tag_[i]);
+    }
+    position_[i] = position_.back();
+    velocity_[i] = velocity_.back();
+    lifetime_[i] = lifetime_.back();
+    owner_[i] = owner_.back();
+    properties_index_[i] = properties_index_.back();
+    tag_[i] = tag_.back();
+    position_.pop_back();
+    velocity_.pop_back();
+    lifetime_.pop_back();
+    owner_.pop_back();
+    properties_index_.pop_back();
+    tag_.pop_back();
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <Mlib/Array/Fixed_Array.hpp>
+#include <Mlib/Geometry/Physics_Material.hpp>
+#include <Mlib/Scene_Config/Scene_Precision.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace Mlib {
+
+class CollisionQuery;
+class RigidBodyVehicle;
+
+struct ProjectileProperties {
+    float max_lifetime;
+    // Quadratic drag, i.e. the deceleration divided by the squared
+    // speed relative to the air.
+    float drag_coefficient = 0.f;
+    PhysicsMaterial collidable_mask = PhysicsMaterial::OBJ_BULLET_COLLIDABLE_MASK;
+};
+
+struct ProjectileHit {
+    FixedArray<ScenePos, 3> position;
+    FixedArray<float, 3> velocity;
+    // The terrain is a rigid body, too.
+    RigidBodyVehicle& rigid_body;
+    // "NONE" for heightfields.
+    PhysicsMaterial physics_material;
+    uint32_t properties;
+    uint32_t tag;
+};
+
+// Projectiles without scene node or rigid body.
+// The state is stored as one array per attribute, integrated in batch
+// with gravity and drag, and collided with swept ray casts against the
+// collision BVHs.
+class ProjectilePool {
+    ProjectilePool(const ProjectilePool&) = delete;
+    ProjectilePool& operator = (const ProjectilePool&) = delete;
+public:
+    ProjectilePool();
+    ~ProjectilePool();
+    uint32_t add_properties(const ProjectileProperties& properties);
+    // The owner is excluded from the ray casts. It is only compared,
+    // never dereferenced, s.t. it may be deleted while the projectile
+    // is in flight.
+    // The tag is passed to the callbacks, e.g. to identify the gunner.
+    void fire(
+        const FixedArray<ScenePos, 3>& position,
+        const FixedArray<float, 3>& velocity,
+        uint32_t properties,
+        const RigidBodyVehicle* owner,
+        uint32_t tag);
+    // "on_hit" and "on_remove" are called before a projectile is
+    // removed. "on_remove" is called for hits and expirations.
+    void advance_time(
+        float dt,
+        const FixedArray<float, 3>& gravity,
+        const FixedArray<float, 3>& wind,
+        const CollisionQuery& collision_query,
+        const std::function<void(const ProjectileHit& hit)>& on_hit,
+        const std::function<void(uint32_t tag)>& on_remove = {});
+    inline size_t size() const {
+        return lifetime_.size();
+    }
+    void clear();
+private:
+    void remove(size_t i, const std::function<void(uint32_t tag)>& on_remove);
+    std::vector<ProjectileProperties> properties_;
+    std::vector<FixedArray<ScenePos, 3>> position_;
+    std::vector<FixedArray<float, 3>> velocity_;
+    std::vector<float> lifetime_;
+    std::vector<const RigidBodyVehicle*> owner_;
+    std::vector<uint32_t> properties_index_;
+    std::vector<uint32_t> tag_;
+};
+
+}
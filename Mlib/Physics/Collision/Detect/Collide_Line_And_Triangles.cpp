@@ -4,6 +4,7 @@
 #include <Mlib/Geometry/Mesh/Typed_Mesh.hpp>
 #include <Mlib/Geometry/Primitives/Collision_Line.hpp>
 #include <Mlib/Geometry/Primitives/Collision_Polygon.hpp>
+#include <Mlib/Misc/Pointer_To_Optional.hpp>
 #include <Mlib/Physics/Collision/Collision_Type.hpp>
 #include <Mlib/Physics/Collision/Record/Collision_History.hpp>
 #include <Mlib/Physics/Collision/Record/Handle_Line_Triangle_Intersection.hpp>
@@ -23,9 +24,15 @@ void Mlib::collide_line_and_triangles(
     if (!msh1.intersects(l0.bounding_sphere)) {
         return;
     }
-    for (const auto& i1 : msh1.get_intersectables()) {
-        if (!i1.mesh->bounding_sphere().intersects(l0.bounding_sphere)) {
-            continue;
+    auto collide = [&](
+        PhysicsMaterial physics_material1,
+        const BoundingSphere<CompressedScenePos, 3>& bounding_sphere1,
+        const CollisionPolygonSphere<CompressedScenePos, 4>* q1,
+        const CollisionPolygonSphere<CompressedScenePos, 3>* t1,
+        const IIntersectable* i1)
+    {
+        if (!bounding_sphere1.intersects(l0.bounding_sphere)) {
+            return;
         }
         handle_line_triangle_intersection(IntersectionScene{
             .o0 = o1,
@@ -34,17 +41,28 @@ void Mlib::collide_line_and_triangles(
             .mesh1 = nullptr, // msh0,
             .l1 = l0,
             .r1 = std::nullopt,
-            .q0 = std::nullopt,
-            .t0 = std::nullopt,
-            .i0 = i1.mesh.get(),
+            .q0 = pointer_to_optional(q1),
+            .t0 = pointer_to_optional(t1),
+            .i0 = i1,
             .tire_id1 = SIZE_MAX,
-            .mesh0_material = i1.physics_material,
+            .mesh0_material = physics_material1,
             .mesh1_material = l0.physics_material,
             .l1_is_normal = false,
             .surface_contact_info = history.surface_contact_db.get_contact_info(
                 l0.physics_material,
-                i1.physics_material),
+                physics_material1),
             .default_collision_type = CollisionType::GRIND,
             .history = history});
+    };
+    // Only the polygons provide the plane normal that a grinding
+    // vehicle requires (see "handle_line_triangle_intersection").
+    for (const auto& q1 : msh1.get_quads_sphere()) {
+        collide(q1.physics_material, q1.bounding_sphere, &q1, nullptr, nullptr);
+    }
+    for (const auto& t1 : msh1.get_triangles_sphere()) {
+        collide(t1.physics_material, t1.bounding_sphere, nullptr, &t1, nullptr);
+    }
+    for (const auto& i1 : msh1.get_intersectables()) {
+        collide(i1.physics_material, i1.mesh->bounding_sphere(), nullptr, nullptr, i1.mesh.get());
     }
 }
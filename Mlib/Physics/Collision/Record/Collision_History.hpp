@@ -28,16 +28,20 @@ struct CollisionRidgeSphere;
 struct StaticWorld;
 class SurfaceContactDb;
 struct PhysicsPhase;
+class ContactCache;
 
 struct CollisionHistory {
     const PhysicsEngineConfig& cfg;
     const PhysicsPhase& phase;
     const StaticWorld& world;
     const SurfaceContactDb& surface_contact_db;
-    ContactSmokeGenerator& csg;
-    ITrailRenderer& tr;
+    // "nullptr" if the engine runs headless.
+    ContactSmokeGenerator* csg;
+    ITrailRenderer* tr;
     std::list<Beacon>* beacons;
     std::list<std::unique_ptr<IContactInfo>>& contact_infos;
+    // "nullptr" if warm starting is disabled.
+    ContactCache* contact_cache;
     std::unordered_map<OrderableFixedArray<CompressedScenePos, 2, 3>, IntersectionSceneAndContact>& raycast_intersections;
     std::unordered_map<RigidBodyVehicle*, std::list<IntersectionSceneAndContact>>& concave_t0_intersections;
     std::unordered_map<RigidBodyVehicle*, GrindInfo>& grind_infos;
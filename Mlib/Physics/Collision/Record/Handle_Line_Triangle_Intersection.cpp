@@ -205,7 +205,9 @@ void Mlib::handle_line_triangle_intersection(
     for (auto& c1 : c.o1.collision_observers_) {
         c1->notify_collided(iinfo.intersection_point, c.history.world, c.o0, c.mesh0_material, CollisionRole::SECONDARY, collision_type, abort);
     }
-    c.history.csg.notify_contact(iinfo.intersection_point, fixed_zeros<float, 3>(), iinfo.normal0, c);
+    if (c.history.csg != nullptr) {
+        c.history.csg->notify_contact(iinfo.intersection_point, fixed_zeros<float, 3>(), iinfo.normal0, c);
+    }
     if (abort) {
         return;
     }
@@ -7,18 +7,53 @@
 #include <Mlib/Physics/Collision/Record/Collision_History.hpp>
 #include <Mlib/Physics/Collision/Record/Intersection_Scene.hpp>
 #include <Mlib/Physics/Collision/Resolve/Constraints.hpp>
+#include <Mlib/Physics/Collision/Resolve/Contact_Cache.hpp>
 #include <Mlib/Physics/Physics_Engine/Colliders/Jump.hpp>
 #include <Mlib/Physics/Rigid_Body/Attached_Wheel.hpp>
 #include <Mlib/Physics/Rigid_Body/Rigid_Body_Vehicle.hpp>
 #include <Mlib/Physics/Smoke_Generation/Surface_Contact_Info.hpp>
 #include <Mlib/Scene_Config/Physics_Engine_Config.hpp>
 #include <Mlib/Testing/Assert.hpp>
+#include <cmath>
 #include <stdexcept>
 
 PRAGMA_GCC_O3_BEGIN
 
 using namespace Mlib;
 
+// Tires are identified by their ID. Other contacts are identified by
+// the meshes, and the quantized contact point and normal in the frame
+// of the dynamic body, where they stay constant while resting.
+static ContactCacheKey contact_cache_key(
+    const IntersectionScene& c,
+    const FixedArray<SceneDir, 3>& normal,
+    const FixedArray<ScenePos, 3>& intersection_point)
+{
+    if (c.tire_id1 != SIZE_MAX) {
+        return { .body0 = &c.o0.rbp_, .body1 = &c.o1.rbp_, .tire_id = c.tire_id1 };
+    }
+    const auto& rbp = (c.o1.mass() != INFINITY) ? c.o1.rbp_ : c.o0.rbp_;
+    auto rt = rbp.rotation_.T();
+    auto p = dot1d(rt, (intersection_point - rbp.abs_com_).casted<float>());
+    auto n = dot1d(rt, normal.casted<float>());
+    ContactCacheKey key{ .body0 = &c.o0.rbp_, .body1 = &c.o1.rbp_, .mesh0 = c.mesh0, .mesh1 = c.mesh1 };
+    for (size_t i = 0; i < 3; ++i) {
+        key.position(i) = (int32_t)std::lround(p(i) / c.history.cfg.contact_cache_resolution);
+        key.normal(i) = (int32_t)std::lround(n(i) * 4.f);
+    }
+    return key;
+}
+
+static void bind_to_contact_cache(
+    const IntersectionScene& c,
+    const ContactCacheKey& key,
+    IContactInfo& ci)
+{
+    if (c.history.contact_cache != nullptr) {
+        c.history.contact_cache->bind(key, ci);
+    }
+}
+
 static void handle_standard_reflection(
     const IntersectionScene& c,
     const FixedArray<SceneDir, 3>& normal,
@@ -28,6 +63,8 @@ static void handle_standard_reflection(
     assert_true((c.o0.mass() != INFINITY) && (c.o1.mass() == INFINITY));
     assert_true(c.tire_id1 == SIZE_MAX);
 
+    auto key = contact_cache_key(c, normal, intersection_point);
+
     // Normal force
     auto ci = std::make_unique<NormalContactInfo1>(
         c.o0.rbp_,
@@ -42,16 +79,19 @@ static void handle_standard_reflection(
             .lambda_max = 0},
         intersection_point);
     const NormalImpulse* normal_impulse = &ci->normal_impulse();
+    bind_to_contact_cache(c, key, *ci);
     c.history.contact_infos.push_back(std::move(ci));
 
     // Tangential force
-    c.history.contact_infos.push_back(std::unique_ptr<IContactInfo>(new FrictionContactInfo1{
+    auto fci = std::make_unique<FrictionContactInfo1>(
         c.o0.rbp_,
         *normal_impulse,
         intersection_point,
         c.surface_contact_info != nullptr ? c.surface_contact_info->stiction_coefficient : c.history.cfg.stiction_coefficient,
         c.surface_contact_info != nullptr ? c.surface_contact_info->friction_coefficient : c.history.cfg.friction_coefficient,
-        c.o1.velocity_at_position(intersection_point)}));
+        c.o1.velocity_at_position(intersection_point));
+    bind_to_contact_cache(c, key, *fci);
+    c.history.contact_infos.push_back(std::move(fci));
 }
 
 static void handle_extended_reflection(
@@ -61,6 +101,8 @@ static void handle_extended_reflection(
     float overlap,
     float surface_stiction_factor)
 {
+    auto key = contact_cache_key(c, normal, intersection_point);
+
     // ################
     // # Normal force #
     // ################
@@ -93,6 +135,7 @@ static void handle_extended_reflection(
                 }
             });
         normal_impulse = &ci->normal_impulse();
+        bind_to_contact_cache(c, key, *ci);
         c.history.contact_infos.push_back(std::move(ci));
     } else {
         if (c.tire_id1 == SIZE_MAX) {
@@ -109,6 +152,7 @@ static void handle_extended_reflection(
                     .lambda_max = 0},
                 intersection_point);
             normal_impulse = &ci->normal_impulse();
+            bind_to_contact_cache(c, key, *ci);
             c.history.contact_infos.push_back(std::move(ci));
         } else {
             if (c.o1.jump_state_.wants_to_jump_oversampled_ &&
@@ -193,7 +237,7 @@ static void handle_extended_reflection(
                     FixedArray<float, 3> v_street = c.o0.velocity_at_position(contact_position);
                     FixedArray<float, 3> vc_street = c.o0.velocity_at_position(c.o1.abs_com());
                     auto& tire = c.o1.tires_.get(c.tire_id1);
-                    c.history.contact_infos.push_back(std::unique_ptr<IContactInfo>(new TireContactInfo1{
+                    auto tci = std::unique_ptr<TireContactInfo1>(new TireContactInfo1{
                         FrictionContactInfo1{
                             (tire.rb == nullptr)
                                 ? c.o1.rbp_
@@ -211,7 +255,9 @@ static void handle_extended_reflection(
                         n3,
                         -dot0d(c.o1.get_velocity_at_tire_contact(normal.casted<float>(), c.tire_id1) - v_street, n3),
                         c.history.cfg,
-                        c.history.phase}));
+                        c.history.phase});
+                    bind_to_contact_cache(c, key, *tci);
+                    c.history.contact_infos.push_back(std::move(tci));
                     // if (c.beacons != nullptr) {
                     //     c.beacons->push_back(Beacon::create(contact_position, "beacon"));
                     // }
@@ -221,23 +267,27 @@ static void handle_extended_reflection(
                 tangential_force = 0;
             }
         } else {
-            c.history.contact_infos.push_back(std::unique_ptr<IContactInfo>(new FrictionContactInfo1{
+            auto fci = std::make_unique<FrictionContactInfo1>(
                 c.o1.rbp_,
                 *normal_impulse,
                 intersection_point,
                 align ? 0.f : c.surface_contact_info != nullptr ? c.surface_contact_info->stiction_coefficient : c.history.cfg.stiction_coefficient,
                 align ? 0.f : c.surface_contact_info != nullptr ? c.surface_contact_info->friction_coefficient : c.history.cfg.friction_coefficient,
-                c.o0.velocity_at_position(intersection_point)}));
+                c.o0.velocity_at_position(intersection_point));
+            bind_to_contact_cache(c, key, *fci);
+            c.history.contact_infos.push_back(std::move(fci));
         }
     } else {
-        c.history.contact_infos.push_back(std::unique_ptr<IContactInfo>(new FrictionContactInfo2{
+        auto fci = std::make_unique<FrictionContactInfo2>(
             c.o1.rbp_,
             c.o0.rbp_,
             *normal_impulse,
             intersection_point,
             align ? 0.f : c.surface_contact_info != nullptr ? c.surface_contact_info->stiction_coefficient : c.history.cfg.stiction_coefficient,
             align ? 0.f : c.surface_contact_info != nullptr ? c.surface_contact_info->friction_coefficient : c.history.cfg.friction_coefficient,
-            fixed_zeros<float, 3>()}));
+            fixed_zeros<float, 3>());
+        bind_to_contact_cache(c, key, *fci);
+        c.history.contact_infos.push_back(std::move(fci));
     }
     // if (float lr = c.cfg.stiction_coefficient * force_n1; lr > 1e-12) {
     //     lerr() << "f " << c.tire_id1 << " " << std::sqrt(sum(squared(tangential_force))) / lr;
@@ -6,6 +6,7 @@
 #include <Mlib/Physics/Actuators/Velocity_Classification.hpp>
 #include <Mlib/Physics/Collision/Pacejkas_Magic_Formula.hpp>
 #include <Mlib/Physics/Collision/Power_To_Force.hpp>
+#include <Mlib/Physics/Collision/Resolve/Contact_Cache.hpp>
 #include <Mlib/Physics/Collision/Resolve/Handle_Tire_Triangle_Intersection.hpp>
 #include <Mlib/Physics/Collision/Resolve/Tire_Contact_Slip.hpp>
 #include <Mlib/Physics/Rigid_Body/Attached_Wheel.hpp>
@@ -24,6 +25,7 @@ GenericNormalContactInfo1<TRigidBodyPulsesArg, TRigidBodyPulsesField>::GenericNo
     : rbp_{ rbp }
     , pc_{ pc }
     , p_{ p }
+    , residual_{ 0.f }
 {}
 
 /**
@@ -41,9 +43,31 @@ void GenericNormalContactInfo1<TRigidBodyPulsesArg, TRigidBodyPulsesField>::solv
     float lambda = - mc * (-v + pc.v(dt));
     lambda = pc_.clamped_lambda(relaxation * lambda);
     rbp_.integrate_impulse({.vector = -snormal * lambda, .position = p_}, 0.f, dt, CURRENT_SOURCE_LOCATION);
+    residual_ = std::abs(lambda);
     // linfo() << v << " | " << snormal << " | " << relaxation << " | " << lambda << " o=" << pc.overlap << " s=" << pc.slop << " T=" << pc.normal_impulse.lambda_total;
 }
 
+template <class TRigidBodyPulsesArg, class TRigidBodyPulsesField>
+void GenericNormalContactInfo1<TRigidBodyPulsesArg, TRigidBodyPulsesField>::warm_start(const ContactCacheEntry& entry, float scale, float dt) {
+    if (entry.nnormal == 0) {
+        return;
+    }
+    auto snormal = pc_.constraint.normal_impulse.normal.casted<float>();
+    float lambda = pc_.clamped_lambda(scale * entry.normal_lambda / (float)entry.nnormal);
+    rbp_.integrate_impulse({.vector = -snormal * lambda, .position = p_}, 0.f, dt, CURRENT_SOURCE_LOCATION);
+}
+
+template <class TRigidBodyPulsesArg, class TRigidBodyPulsesField>
+void GenericNormalContactInfo1<TRigidBodyPulsesArg, TRigidBodyPulsesField>::store(ContactCacheEntry& entry) const {
+    entry.normal_lambda += pc_.constraint.normal_impulse.lambda_total;
+    ++entry.nnormal;
+}
+
+template <class TRigidBodyPulsesArg, class TRigidBodyPulsesField>
+float GenericNormalContactInfo1<TRigidBodyPulsesArg, TRigidBodyPulsesField>::residual() const {
+    return residual_;
+}
+
 NormalContactInfo2::NormalContactInfo2(
     RigidBodyPulses& rbp0,
     RigidBodyPulses& rbp1,
@@ -55,6 +79,7 @@ NormalContactInfo2::NormalContactInfo2(
     , pc_{ pc }
     , p_{ p }
     , notify_lambda_final_{ notify_lambda_final }
+    , residual_{ 0.f }
 {}
 
 void NormalContactInfo2::solve(float dt, float relaxation, size_t iteration, size_t niterations) {
@@ -68,6 +93,7 @@ void NormalContactInfo2::solve(float dt, float relaxation, size_t iteration, siz
     lambda = pc_.clamped_lambda(relaxation * lambda);
     rbp0_.integrate_impulse({.vector = -snormal * lambda, .position = p_}, 0.f, dt, CURRENT_SOURCE_LOCATION);
     rbp1_.integrate_impulse({.vector = snormal * lambda, .position = p_}, 0.f, dt, CURRENT_SOURCE_LOCATION);
+    residual_ = std::abs(lambda);
     // lerr() << rbp.abs_position() << " | " << rbp.v_ << " | " << pc.active(x) << " | " << pc.overlap(x) << " | " << pc.bias(x);
 }
 
@@ -75,6 +101,25 @@ void NormalContactInfo2::finalize() {
     notify_lambda_final_(pc_.constraint.normal_impulse.lambda_total);
 }
 
+void NormalContactInfo2::warm_start(const ContactCacheEntry& entry, float scale, float dt) {
+    if (entry.nnormal == 0) {
+        return;
+    }
+    auto snormal = pc_.constraint.normal_impulse.normal.casted<float>();
+    float lambda = pc_.clamped_lambda(scale * entry.normal_lambda / (float)entry.nnormal);
+    rbp0_.integrate_impulse({.vector = -snormal * lambda, .position = p_}, 0.f, dt, CURRENT_SOURCE_LOCATION);
+    rbp1_.integrate_impulse({.vector = snormal * lambda, .position = p_}, 0.f, dt, CURRENT_SOURCE_LOCATION);
+}
+
+void NormalContactInfo2::store(ContactCacheEntry& entry) const {
+    entry.normal_lambda += pc_.constraint.normal_impulse.lambda_total;
+    ++entry.nnormal;
+}
+
+float NormalContactInfo2::residual() const {
+    return residual_;
+}
+
 template <size_t tnullspace>
 GenericLineContactInfo1<tnullspace>::GenericLineContactInfo1(
     RigidBodyPulses& rbp0,
@@ -205,9 +250,11 @@ FrictionContactInfo1::FrictionContactInfo1(
     , extra_stiction_{ extra_stiction }
     , extra_friction_{ extra_friction }
     , extra_w_{ extra_w }
+    , residual_{ 0.f }
 {}
 
 void FrictionContactInfo1::solve(float dt, float relaxation, size_t iteration, size_t niterations) {
+    residual_ = 0.f;
     FixedArray<float, 3> v3 = rbp_.velocity_at_position(p_) - b_;
     auto snormal = normal_impulse_.normal.casted<float>();
     v3 -= snormal * dot0d(v3, snormal);
@@ -240,7 +287,34 @@ void FrictionContactInfo1::solve(float dt, float relaxation, size_t iteration, s
         }
         lambda = lambda_total_ - lambda_total_old;
         rbp_.integrate_impulse({.vector = -lambda, .position = p_}, extra_w_, dt, CURRENT_SOURCE_LOCATION);
+        residual_ = std::sqrt(sum(squared(lambda)));
+    }
+}
+
+void FrictionContactInfo1::warm_start(const ContactCacheEntry& entry, float scale, float dt) {
+    if (entry.nfriction == 0) {
+        return;
+    }
+    // The normal may have rotated since the impulse was stored.
+    auto snormal = normal_impulse_.normal.casted<float>();
+    FixedArray<float, 3> lambda = scale / (float)entry.nfriction * entry.friction_lambda;
+    lambda -= snormal * dot0d(lambda, snormal);
+    if (!std::isnan(friction_coefficient_)) {
+        if (float ll2 = sum(squared(lambda)); ll2 > squared(max_impulse_friction())) {
+            lambda *= max_impulse_friction() / std::sqrt(ll2);
+        }
     }
+    lambda_total_ = lambda;
+    rbp_.integrate_impulse({.vector = -lambda, .position = p_}, extra_w_, dt, CURRENT_SOURCE_LOCATION);
+}
+
+void FrictionContactInfo1::store(ContactCacheEntry& entry) const {
+    entry.friction_lambda += lambda_total_;
+    ++entry.nfriction;
+}
+
+float FrictionContactInfo1::residual() const {
+    return residual_;
 }
 
 float FrictionContactInfo1::max_impulse_stiction() const {
@@ -307,9 +381,11 @@ FrictionContactInfo2::FrictionContactInfo2(
     , p_{ p }
     , stiction_coefficient_{ stiction_coefficient }
     , friction_coefficient_{ friction_coefficient }
+    , residual_{ 0.f }
 {}
 
 void FrictionContactInfo2::solve(float dt, float relaxation, size_t iteration, size_t niterations) {
+    residual_ = 0.f;
     FixedArray<float, 3> v3 = rbp0_.velocity_at_position(p_) - rbp1_.velocity_at_position(p_) - b_;
     auto snormal = normal_impulse_.normal.casted<float>();
     v3 -= snormal * dot0d(v3, snormal);
@@ -327,7 +403,32 @@ void FrictionContactInfo2::solve(float dt, float relaxation, size_t iteration, s
         lambda = lambda_total_ - lambda_total_old;
         rbp0_.integrate_impulse({.vector = -lambda, .position = p_}, 0.f, dt, CURRENT_SOURCE_LOCATION);
         rbp1_.integrate_impulse({.vector = lambda, .position = p_}, 0.f, dt, CURRENT_SOURCE_LOCATION);
+        residual_ = std::sqrt(sum(squared(lambda)));
+    }
+}
+
+void FrictionContactInfo2::warm_start(const ContactCacheEntry& entry, float scale, float dt) {
+    if (entry.nfriction == 0) {
+        return;
+    }
+    auto snormal = normal_impulse_.normal.casted<float>();
+    FixedArray<float, 3> lambda = scale / (float)entry.nfriction * entry.friction_lambda;
+    lambda -= snormal * dot0d(lambda, snormal);
+    if (float ll2 = sum(squared(lambda)); ll2 > squared(max_impulse_friction())) {
+        lambda *= max_impulse_friction() / std::sqrt(ll2);
     }
+    lambda_total_ = lambda;
+    rbp0_.integrate_impulse({.vector = -lambda, .position = p_}, 0.f, dt, CURRENT_SOURCE_LOCATION);
+    rbp1_.integrate_impulse({.vector = lambda, .position = p_}, 0.f, dt, CURRENT_SOURCE_LOCATION);
+}
+
+void FrictionContactInfo2::store(ContactCacheEntry& entry) const {
+    entry.friction_lambda += lambda_total_;
+    ++entry.nfriction;
+}
+
+float FrictionContactInfo2::residual() const {
+    return residual_;
 }
 
 float FrictionContactInfo2::max_impulse_stiction() const {
@@ -444,6 +545,21 @@ void TireContactInfo1::solve(float dt, float relaxation, size_t iteration, size_
     }
 }
 
+void TireContactInfo1::warm_start(const ContactCacheEntry& entry, float scale, float dt) {
+    if (rb_.grind_state_.grinding_) {
+        return;
+    }
+    fci_.warm_start(entry, scale, dt);
+}
+
+void TireContactInfo1::store(ContactCacheEntry& entry) const {
+    fci_.store(entry);
+}
+
+float TireContactInfo1::residual() const {
+    return fci_.residual();
+}
+
 // void TireContactInfo1::finalize() {
 //     lerr() << "tire id " << tire_id_ << " | " << fci_ << " normal " << fci_.normal_impulse().normal;
 // }
@@ -493,13 +609,28 @@ void ShockAbsorberContactInfo2::solve(float dt, float relaxation, size_t iterati
     rbp1_.integrate_impulse({.vector = -lambda, .position = p_ }, 0.f, dt, CURRENT_SOURCE_LOCATION);
 }
 
-void Mlib::solve_contacts(std::list<std::unique_ptr<IContactInfo>>& cis, float dt) {
-    size_t niterations = 50;
+void Mlib::solve_contacts(
+    std::list<std::unique_ptr<IContactInfo>>& cis,
+    float dt,
+    size_t niterations,
+    std::vector<float>* residuals)
+{
+    if (residuals != nullptr) {
+        residuals->clear();
+        residuals->reserve(niterations);
+    }
     for (size_t i = 0; i < niterations; ++i) {
         // linfo() << "solve_contacts " << i;
         for (const auto& ci : cis) {
             ci->solve(dt, i < 1 ? 0.2f : 1.f, i, niterations);
         }
+        if (residuals != nullptr) {
+            float residual = 0.f;
+            for (const auto& ci : cis) {
+                residual += ci->residual();
+            }
+            residuals->push_back(residual);
+        }
     }
     for (const auto& ci : cis) {
         ci->finalize();
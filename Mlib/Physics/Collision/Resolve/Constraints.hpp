@@ -6,7 +6,9 @@
 #include <algorithm>
 #include <iosfwd>
 #include <list>
+#include <memory>
 #include <stdexcept>
+#include <vector>
 
 namespace Mlib {
 
@@ -15,6 +17,7 @@ class RigidBodyPulses;
 class AttachedWheel;
 struct PhysicsEngineConfig;
 struct PhysicsPhase;
+struct ContactCacheEntry;
 
 struct PointEqualityConstraint {
     FixedArray<ScenePos, 3> p0;
@@ -134,6 +137,12 @@ public:
     virtual ~IContactInfo() = default;
     virtual void solve(float dt, float relaxation, size_t iteration, size_t niterations) = 0;
     virtual void finalize() {}
+    // Applies "scale" times the impulse cached by "store" and
+    // initializes the accumulated impulse with it.
+    virtual void warm_start(const ContactCacheEntry& entry, float scale, float dt) {}
+    virtual void store(ContactCacheEntry& entry) const {}
+    // Magnitude of the impulse applied by the last call to "solve".
+    virtual float residual() const { return 0.f; }
 };
 
 template <size_t tnullspace>
@@ -204,6 +213,9 @@ public:
         const BoundedPlaneInequalityConstraint& pc,
         const FixedArray<ScenePos, 3>& p);
     virtual void solve(float dt, float relaxation, size_t iteration, size_t niterations) override;
+    virtual void warm_start(const ContactCacheEntry& entry, float scale, float dt) override;
+    virtual void store(ContactCacheEntry& entry) const override;
+    virtual float residual() const override;
     const NormalImpulse& normal_impulse() const {
         return pc_.constraint.normal_impulse;
     }
@@ -211,6 +223,7 @@ private:
     TRigidBodyPulsesField rbp_;
     BoundedPlaneInequalityConstraint pc_;
     FixedArray<ScenePos, 3> p_;
+    float residual_;
 };
 
 using NormalContactInfo1 = GenericNormalContactInfo1<RigidBodyPulses&, RigidBodyPulses&>;
@@ -226,6 +239,9 @@ public:
         const std::function<void(float)>& notify_lambda_final = [](float){});
     virtual void solve(float dt, float relaxation, size_t iteration, size_t niterations) override;
     virtual void finalize() override;
+    virtual void warm_start(const ContactCacheEntry& entry, float scale, float dt) override;
+    virtual void store(ContactCacheEntry& entry) const override;
+    virtual float residual() const override;
     const NormalImpulse& normal_impulse() const {
         return pc_.constraint.normal_impulse;
     }
@@ -235,6 +251,7 @@ private:
     BoundedPlaneInequalityConstraint pc_;
     FixedArray<ScenePos, 3> p_;
     std::function<void(float)> notify_lambda_final_;
+    float residual_;
 };
 
 class ShockAbsorberContactInfo1: public IContactInfo {
@@ -289,6 +306,9 @@ public:
         float extra_friction = 0,
         float extra_w = 0);
     virtual void solve(float dt, float relaxation, size_t iteration, size_t niterations) override;
+    virtual void warm_start(const ContactCacheEntry& entry, float scale, float dt) override;
+    virtual void store(ContactCacheEntry& entry) const override;
+    virtual float residual() const override;
     float max_impulse_stiction() const;
     float max_impulse_friction() const;
     const FixedArray<float, 3>& get_b() const;
@@ -323,6 +343,7 @@ private:
     float extra_stiction_;
     float extra_friction_;
     float extra_w_;
+    float residual_;
 };
 
 std::ostream& operator << (std::ostream& ostr, const FrictionContactInfo1& fci1);
@@ -338,6 +359,9 @@ public:
         float friction_coefficient,
         const FixedArray<float, 3>& b);
     virtual void solve(float dt, float relaxation, size_t iteration, size_t niterations) override;
+    virtual void warm_start(const ContactCacheEntry& entry, float scale, float dt) override;
+    virtual void store(ContactCacheEntry& entry) const override;
+    virtual float residual() const override;
     float max_impulse_stiction() const;
     float max_impulse_friction() const;
     void set_b(const FixedArray<float, 3>& b);
@@ -350,6 +374,7 @@ private:
     FixedArray<ScenePos, 3> p_;
     float stiction_coefficient_;
     float friction_coefficient_;
+    float residual_;
 };
 
 class TireContactInfo1: public IContactInfo {
@@ -366,6 +391,9 @@ public:
         const PhysicsEngineConfig& cfg,
         const PhysicsPhase& phase);
     virtual void solve(float dt, float relaxation, size_t iteration, size_t niterations) override;
+    virtual void warm_start(const ContactCacheEntry& entry, float scale, float dt) override;
+    virtual void store(ContactCacheEntry& entry) const override;
+    virtual float residual() const override;
 private:
     FrictionContactInfo1 fci_;
     float surface_stiction_factor_;
@@ -381,6 +409,12 @@ private:
     const PhysicsPhase& phase_;
 };
 
-void solve_contacts(std::list<std::unique_ptr<IContactInfo>>& cis, float dt);
+// If "residuals" is not null, it receives the sum of the residuals
+// of all contacts after every iteration.
+void solve_contacts(
+    std::list<std::unique_ptr<IContactInfo>>& cis,
+    float dt,
+    size_t niterations = 50,
+    std::vector<float>* residuals = nullptr);
 
 }
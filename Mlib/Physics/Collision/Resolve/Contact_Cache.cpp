@@ -0,0 +1,63 @@
+#include "Contact_Cache.hpp"
+#include <Mlib/Physics/Collision/Resolve/Constraints.hpp>
+#include <Mlib/Physics/Containers/Collision_Group.hpp>
+
+using namespace Mlib;
+
+ContactCache::ContactCache()
+    : step_{ 0 }
+{}
+
+ContactCache::~ContactCache() = default;
+
+void ContactCache::bind(const ContactCacheKey& key, IContactInfo& ci) {
+    bound_.push_back({ key, &ci });
+}
+
+size_t ContactCache::warm_start(float dt, float factor) {
+    size_t nwarm_started = 0;
+    for (const auto& [key, ci] : bound_) {
+        auto it = entries_.find(key);
+        if ((it == entries_.end()) || (it->second.dt == 0.f)) {
+            continue;
+        }
+        // The impulses scale with the substep duration.
+        ci->warm_start(it->second, factor * dt / it->second.dt, dt);
+        ++nwarm_started;
+    }
+    return nwarm_started;
+}
+
+void ContactCache::store(float dt, const CollisionGroup& group, uint64_t max_age) {
+    ++step_;
+    for (const auto& [key, ci] : bound_) {
+        auto& entry = entries_[key];
+        if (entry.last_step != step_) {
+            entry = ContactCacheEntry{ .dt = dt, .last_step = step_ };
+        }
+        ci->store(entry);
+    }
+    bound_.clear();
+    std::erase_if(entries_, [&](const auto& it){
+        const auto& [key, entry] = it;
+        return
+            (entry.last_step != step_) &&
+            ((step_ - entry.last_step > max_age) ||
+             group.rigid_bodies.contains(key.body0) ||
+             group.rigid_bodies.contains(key.body1));
+    });
+}
+
+void ContactCache::forget(const RigidBodyPulses& rbp) {
+    std::erase_if(entries_, [&](const auto& it){
+        return (it.first.body0 == &rbp) || (it.first.body1 == &rbp);
+    });
+    bound_.remove_if([&](const BoundContact& b){
+        return (b.key.body0 == &rbp) || (b.key.body1 == &rbp);
+    });
+}
+
+void ContactCache::clear() {
+    entries_.clear();
+    bound_.clear();
+}
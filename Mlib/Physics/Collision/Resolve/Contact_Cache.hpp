@@ -0,0 +1,98 @@
+#pragma once
+#include <Mlib/Array/Fixed_Array.hpp>
+#include <Mlib/Hashing/Hash.hpp>
+#include <Mlib/Math/Fixed_Math.hpp>
+#include <Mlib/Math/Orderable_Fixed_Array.hpp>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+
+namespace Mlib {
+
+class IContactInfo;
+class IIntersectableMesh;
+class RigidBodyPulses;
+struct CollisionGroup;
+
+// Identifies a contact between two bodies, either by a tire,
+// or by the meshes and the quantized contact position and normal
+// in the frame of the dynamic body.
+struct ContactCacheKey {
+    RigidBodyPulses* body0;
+    RigidBodyPulses* body1;
+    const IIntersectableMesh* mesh0 = nullptr;
+    const IIntersectableMesh* mesh1 = nullptr;
+    size_t tire_id = SIZE_MAX;
+    OrderableFixedArray<int32_t, 3> position{ 0, 0, 0 };
+    OrderableFixedArray<int32_t, 3> normal{ 0, 0, 0 };
+    std::strong_ordering operator <=> (const ContactCacheKey&) const = default;
+};
+
+}
+
+template <>
+struct std::hash<Mlib::ContactCacheKey>
+{
+    std::size_t operator() (const Mlib::ContactCacheKey& k) const {
+        return Mlib::hash_combine(
+            k.body0, k.body1, k.mesh0, k.mesh1, k.tire_id,
+            k.position(0), k.position(1), k.position(2),
+            k.normal(0), k.normal(1), k.normal(2));
+    }
+};
+
+namespace Mlib {
+
+// Accumulated impulses of one contact at the end of a substep.
+// The normal- and the friction-contact of a contact point share
+// one entry.
+struct ContactCacheEntry {
+    float normal_lambda = 0.f;
+    FixedArray<float, 3> friction_lambda = fixed_zeros<float, 3>();
+    // Number of contacts that were stored with the same key.
+    // Their impulses are summed up, and distributed evenly when
+    // warm-starting.
+    uint32_t nnormal = 0;
+    uint32_t nfriction = 0;
+    float dt = 0.f;
+    uint64_t last_step = 0;
+};
+
+// Persists the accumulated impulses of the contacts between substeps,
+// s.t. the solver can be warm-started with them.
+// Usage per substep: "bind" every contact while it is created,
+// "warm_start" before "solve_contacts", and "store" afterwards.
+class ContactCache {
+public:
+    ContactCache();
+    ~ContactCache();
+    // The contact must be alive until "store" is called.
+    // Normal contacts must be bound before their friction contacts.
+    void bind(const ContactCacheKey& key, IContactInfo& ci);
+    // Applies "factor" times the cached impulses to the bound contacts.
+    // Returns the number of warm-started contacts.
+    size_t warm_start(float dt, float factor);
+    // Stores the impulses of the bound contacts and evicts the
+    // entries of the group's bodies that were not refreshed,
+    // and all entries older than "max_age" calls.
+    void store(float dt, const CollisionGroup& group, uint64_t max_age);
+    // Removes the entries of a body that is being deleted,
+    // s.t. a new body at the same address does not inherit them.
+    void forget(const RigidBodyPulses& rbp);
+    void clear();
+    inline size_t size() const {
+        return entries_.size();
+    }
+private:
+    struct BoundContact {
+        ContactCacheKey key;
+        IContactInfo* ci;
+    };
+    std::unordered_map<ContactCacheKey, ContactCacheEntry> entries_;
+    std::list<BoundContact> bound_;
+    uint64_t step_;
+};
+
+}
@@ -3,7 +3,7 @@
 #include <Mlib/Geometry/Interfaces/Transformed_IIntersectable.hpp>
 #include <Mlib/Geometry/Mesh/IIntersectable_Mesh.hpp>
 #include <Mlib/Geometry/Physics_Material.hpp>
-#include <Mlib/Geometry/Primitives/Intersectors/Ray_Segment_3D_For_Aabb.hpp>
+#include <Mlib/Physics/Containers/Ray_Query_Batch.hpp>
 #include <Mlib/Physics/Physics_Engine/Physics_Engine.hpp>
 #include <Mlib/Physics/Rigid_Body/Rigid_Body_Vehicle.hpp>
 #include <stdexcept>
@@ -26,267 +26,160 @@ bool CollisionQuery::can_see(
     const RigidBodyVehicle** seen_object,
     const IIntersectableMesh** seen_mesh) const
 {
-    RaySegment3DForAabb<ScenePos, ScenePos> ray{ RaySegment3D<ScenePos, ScenePos>{ watcher, watched } };
-    FixedArray<CompressedScenePos, 2, 3> l{
-        ray.start.casted<CompressedScenePos>(),
-        ray.stop().casted<CompressedScenePos>() };
-    ScenePos t_min = INFINITY;
-    std::variant<const CollisionPolygonSphere<CompressedScenePos, 3>*, const CollisionPolygonSphere<CompressedScenePos, 4>*> triangle_min;
-    BoundingSphere<CompressedScenePos, 3> bs{ l };
-    if (!only_terrain) {
-        for (const auto& o0 : physics_engine_.rigid_bodies_.transformed_objects()) {
-            if (&o0.rigid_body.get() == excluded0 ||
-                &o0.rigid_body.get() == excluded1)
-            {
-                continue;
-            }
-            for (const auto& msh0 : o0.meshes) {
-                if (!any(msh0.physics_material & collidable_mask)) {
-                    continue;
-                }
-                if (!msh0.mesh->intersects(bs)) {
-                    continue;
-                }
-                auto intersect = [&](const auto& polygon0){
-                    if (!polygon0.bounding_sphere.intersects(bs)) {
-                        return true;
-                    }
-                    ScenePos t;
-                    FixedArray<ScenePos, 3> intersection_pt = uninitialized;
-                    if (ray.intersects(
-                        polygon0.polygon.template casted<ScenePos, ScenePos>(),
-                        &t,
-                        &intersection_pt))
-                    {
-                        if ((intersection_point == nullptr) &&
-                            (intersection_polygon == nullptr) &&
-                            (seen_object == nullptr) &&
-                            (seen_mesh == nullptr))
-                        {
-                            return false;
-                        }
-                        if (t < t_min) {
-                            t_min = t;
-                            if (intersection_point != nullptr) {
-                                *intersection_point = intersection_pt;
-                            }
-                            if (intersection_polygon != nullptr) {
-                                triangle_min = &polygon0;
-                            }
-                            if (seen_object != nullptr) {
-                                *seen_object = &o0.rigid_body.get();
-                            }
-                            if (seen_mesh != nullptr) {
-                                *seen_mesh = msh0.mesh.get();
-                            }
-                        }
-                    }
-                    return true;
-                };
-                for (const auto& q0 : msh0.mesh->get_quads_sphere()) {
-                    if (!intersect(q0)) {
-                        return false;
-                    }
-                }
-                for (const auto& t0 : msh0.mesh->get_triangles_sphere()) {
-                    if (!intersect(t0)) {
-                        return false;
-                    }
-                }
-            }
-        }
+    bool closest =
+        (intersection_point != nullptr) ||
+        (intersection_polygon != nullptr) ||
+        (seen_object != nullptr) ||
+        (seen_mesh != nullptr);
+    auto hit = RayQueryBatch::cast(
+        physics_engine_,
+        RayQuery{
+            .start = watcher,
+            .stop = watched,
+            .excluded0 = excluded0,
+            .excluded1 = excluded1,
+            .only_terrain = only_terrain,
+            .collidable_mask = collidable_mask },
+        closest ? RayQueryMode::CLOSEST_HIT : RayQueryMode::ANY_HIT);
+    if (!hit.hit()) {
+        return true;
     }
-    if (!physics_engine_.rigid_bodies_.convex_mesh_bvh().root_bvh.visit(
-        ray,
-        [&](const RigidBodyAndIntersectableMesh& rm0){
-            if (!any(rm0.mesh.physics_material & collidable_mask)) {
-                return true;
-            }
-            for (const auto& t0 : rm0.mesh.mesh->get_triangles_sphere()) {
-                if (!bs.intersects(t0.bounding_sphere) ||
-                    !bs.intersects(t0.polygon.plane))
-                {
-                    continue;
-                }
-                ScenePos t;
-                FixedArray<ScenePos, 3> intersection_pt = uninitialized;
-                if (ray.intersects(
-                    t0.polygon.template casted<ScenePos, ScenePos>(),
-                    &t,
-                    &intersection_pt))
-                {
-                    if ((intersection_point == nullptr) &&
-                        (intersection_polygon == nullptr) &&
-                        (seen_object == nullptr) &&
-                        (seen_mesh == nullptr))
-                    {
-                        return false;
-                    }
-                    if (t < t_min) {
-                        t_min = t;
-                        if (intersection_point != nullptr) {
-                            *intersection_point = intersection_pt;
-                        }
-                        if (intersection_polygon != nullptr) {
-                            triangle_min = &t0;
-                        }
-                        if (seen_object != nullptr) {
-                            *seen_object = &rm0.rb.get();
-                        }
-                        if (seen_mesh != nullptr) {
-                            *seen_mesh = rm0.mesh.mesh.get();
-                        }
-                    }
-                }
-            }
-            return true;
-        }))
-    {
-        return false;
+    if (intersection_point != nullptr) {
+        *intersection_point = hit.intersection_point;
     }
-    if (!physics_engine_.rigid_bodies_.triangle_bvh().root_bvh.visit(
-        ray,
-        [&](const RigidBodyAndCollisionTriangleSphere<CompressedScenePos>& t0)
-        {
-            return std::visit(
-                [&](const auto& ctp)
-                {
-                    if (!any(ctp.physics_material & collidable_mask)) {
-                        return true;
-                    }
-                    ScenePos t;
-                    FixedArray<ScenePos, 3> intersection_pt = uninitialized;
-                    if (ray.intersects(
-                        ctp.polygon.template casted<ScenePos, ScenePos>(),
-                        &t,
-                        &intersection_pt))
-                    {
-                        if ((intersection_point == nullptr) &&
-                            (intersection_polygon == nullptr) &&
-                            (seen_object == nullptr) &&
-                            (seen_mesh == nullptr))
-                        {
-                            return false;
-                        }
-                        if (t < t_min) {
-                            t_min = t;
-                            if (intersection_point != nullptr) {
-                                *intersection_point = intersection_pt;
-                            }
-                            if (intersection_polygon != nullptr) {
-                                triangle_min = &ctp;
-                            }
-                            if (seen_object != nullptr) {
-                                *seen_object = &t0.rb;
-                            }
-                            if (seen_mesh != nullptr) {
-                                *seen_mesh = nullptr;
-                                linfo() << "-" << t0.rb.name() << "-";
-                                throw std::runtime_error("gggg");
-                            }
-                        }
-                    }
-                    return true;
-                }, t0.ctp);
-        }))
-    {
-        return false;
+    if (intersection_polygon != nullptr) {
+        *intersection_polygon = hit.polygon;
     }
-    if (t_min != INFINITY) {
-        if (intersection_polygon != nullptr) {
-            *intersection_polygon = triangle_min;
-        }
-        return false;
+    if (seen_object != nullptr) {
+        *seen_object = hit.seen_object;
     }
-    return true;
+    if (seen_mesh != nullptr) {
+        *seen_mesh = hit.seen_mesh;
+    }
+    return false;
 }
 
-bool CollisionQuery::can_see(
+RayQueryBatch CollisionQuery::batch() const {
+    return RayQueryBatch{ physics_engine_ };
+}
+
+RayQuery CollisionQuery::visibility_query(
     const RigidBodyVehicle& watcher,
     const RigidBodyVehicle& watched,
     bool only_terrain,
     PhysicsMaterial collidable_mask,
-    float time_offset,
-    FixedArray<ScenePos, 3>* intersection_point,
-    std::variant<const CollisionPolygonSphere<CompressedScenePos, 3>*, const CollisionPolygonSphere<CompressedScenePos, 4>*>* intersection_polygon,
-    const RigidBodyVehicle** seen_object,
-    const IIntersectableMesh** seen_mesh) const
+    float time_offset) const
 {
     FixedArray<ScenePos, 3> d_watcher = {0.f, funpack(watcher.can_see_y_offset), 0.f};
     FixedArray<ScenePos, 3> d_watched = {0.f, funpack(watched.can_be_seen_y_offset), 0.f};
+    RayQuery result{
+        .start = uninitialized,
+        .stop = uninitialized,
+        .excluded0 = &watcher,
+        .excluded1 = &watched,
+        .only_terrain = only_terrain,
+        .collidable_mask = collidable_mask };
     if (time_offset != 0) {
         RigidBodyPulses watcher_rbp = watcher.rbp_;
         RigidBodyPulses watched_rbp = watched.rbp_;
         watcher_rbp.advance_time(time_offset);
         watched_rbp.advance_time(time_offset);
-        return can_see(
-            watcher_rbp.transform_to_world_coordinates(watcher.target_) + d_watcher,
-            watched_rbp.transform_to_world_coordinates(watched.target_) + d_watched,
-            &watcher,
-            &watched,
-            only_terrain,
-            collidable_mask,
-            intersection_point,
-            intersection_polygon,
-            seen_object,
-            seen_mesh);
+        result.start = watcher_rbp.transform_to_world_coordinates(watcher.target_) + d_watcher;
+        result.stop = watched_rbp.transform_to_world_coordinates(watched.target_) + d_watched;
     } else {
-        return can_see(
-            watcher.abs_target() + d_watcher,
-            watched.abs_target() + d_watched,
-            &watcher,
-            &watched,
-            only_terrain,
-            collidable_mask,
-            intersection_point,
-            intersection_polygon,
-            seen_object,
-            seen_mesh);
+        result.start = watcher.abs_target() + d_watcher;
+        result.stop = watched.abs_target() + d_watched;
     }
+    return result;
 }
 
-bool CollisionQuery::can_see(
+RayQuery CollisionQuery::visibility_query(
     const RigidBodyVehicle& watcher,
     const FixedArray<ScenePos, 3>& watched_position,
     const FixedArray<SceneDir, 3>& watched_velocity,
     bool only_terrain,
     PhysicsMaterial collidable_mask,
     ScenePos can_be_seen_height_offset,
-    float time_offset,
-    FixedArray<ScenePos, 3>* intersection_point,
-    std::variant<const CollisionPolygonSphere<CompressedScenePos, 3>*, const CollisionPolygonSphere<CompressedScenePos, 4>*>* intersection_polygon,
-    const RigidBodyVehicle** seen_object,
-    const IIntersectableMesh** seen_mesh) const
+    float time_offset) const
 {
     FixedArray<ScenePos, 3> d_watcher = {0.f, funpack(watcher.can_see_y_offset), 0.f };
     FixedArray<ScenePos, 3> d_watched = {0.f, can_be_seen_height_offset, 0.f };
+    RayQuery result{
+        .start = uninitialized,
+        .stop = uninitialized,
+        .excluded0 = &watcher,
+        .excluded1 = nullptr,
+        .only_terrain = only_terrain,
+        .collidable_mask = collidable_mask };
     if (time_offset != 0) {
         RigidBodyPulses rbp = watcher.rbp_;
         rbp.advance_time(time_offset);
-        return can_see(
-            rbp.transform_to_world_coordinates(watcher.target_) + d_watcher,
-            watched_position + d_watched + (watched_velocity * time_offset).casted<ScenePos>(),
-            &watcher,
-            nullptr,
-            only_terrain,
-            collidable_mask,
-            intersection_point,
-            intersection_polygon,
-            seen_object,
-            seen_mesh);
+        result.start = rbp.transform_to_world_coordinates(watcher.target_) + d_watcher;
+        result.stop = watched_position + d_watched + (watched_velocity * time_offset).casted<ScenePos>();
     } else {
-        return can_see(
-            watcher.abs_target() + d_watcher,
-            watched_position + d_watched,
-            &watcher,
-            nullptr,
-            only_terrain,
-            collidable_mask,
-            intersection_point,
-            intersection_polygon,
-            seen_object,
-            seen_mesh);
+        result.start = watcher.abs_target() + d_watcher;
+        result.stop = watched_position + d_watched;
     }
+    return result;
+}
+
+bool CollisionQuery::can_see(
+    const RigidBodyVehicle& watcher,
+    const RigidBodyVehicle& watched,
+    bool only_terrain,
+    PhysicsMaterial collidable_mask,
+    float time_offset,
+    FixedArray<ScenePos, 3>* intersection_point,
+    std::variant<const CollisionPolygonSphere<CompressedScenePos, 3>*, const CollisionPolygonSphere<CompressedScenePos, 4>*>* intersection_polygon,
+    const RigidBodyVehicle** seen_object,
+    const IIntersectableMesh** seen_mesh) const
+{
+    auto q = visibility_query(watcher, watched, only_terrain, collidable_mask, time_offset);
+    return can_see(
+        q.start,
+        q.stop,
+        q.excluded0,
+        q.excluded1,
+        q.only_terrain,
+        q.collidable_mask,
+        intersection_point,
+        intersection_polygon,
+        seen_object,
+        seen_mesh);
+}
+
+bool CollisionQuery::can_see(
+    const RigidBodyVehicle& watcher,
+    const FixedArray<ScenePos, 3>& watched_position,
+    const FixedArray<SceneDir, 3>& watched_velocity,
+    bool only_terrain,
+    PhysicsMaterial collidable_mask,
+    ScenePos can_be_seen_height_offset,
+    float time_offset,
+    FixedArray<ScenePos, 3>* intersection_point,
+    std::variant<const CollisionPolygonSphere<CompressedScenePos, 3>*, const CollisionPolygonSphere<CompressedScenePos, 4>*>* intersection_polygon,
+    const RigidBodyVehicle** seen_object,
+    const IIntersectableMesh** seen_mesh) const
+{
+    auto q = visibility_query(
+        watcher,
+        watched_position,
+        watched_velocity,
+        only_terrain,
+        collidable_mask,
+        can_be_seen_height_offset,
+        time_offset);
+    return can_see(
+        q.start,
+        q.stop,
+        q.excluded0,
+        q.excluded1,
+        q.only_terrain,
+        q.collidable_mask,
+        intersection_point,
+        intersection_polygon,
+        seen_object,
+        seen_mesh);
 }
 
 bool CollisionQuery::visit_spawn_preventers(
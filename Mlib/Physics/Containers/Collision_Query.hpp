@@ -19,6 +19,8 @@ template <class TDir, class TPos, size_t n>
 class TransformationMatrix;
 template <class TData, size_t tndim>
 class AxisAlignedBoundingBox;
+struct RayQuery;
+class RayQueryBatch;
 
 class CollisionQuery {
 public:
@@ -56,6 +58,22 @@ public:
         std::variant<const CollisionPolygonSphere<CompressedScenePos, 3>*, const CollisionPolygonSphere<CompressedScenePos, 4>*>* intersection_polygon = nullptr,
         const RigidBodyVehicle** seen_object = nullptr,
         const IIntersectableMesh** seen_mesh = nullptr) const;
+    RayQueryBatch batch() const;
+    // The rays cast by "can_see", e.g. to collect them in a "RayQueryBatch".
+    RayQuery visibility_query(
+        const RigidBodyVehicle& watcher,
+        const RigidBodyVehicle& watched,
+        bool only_terrain = false,
+        PhysicsMaterial collidable_mask = PhysicsMaterial::OBJ_BULLET_COLLIDABLE_MASK,
+        float time_offset = 0) const;
+    RayQuery visibility_query(
+        const RigidBodyVehicle& watcher,
+        const FixedArray<ScenePos, 3>& watched_position,
+        const FixedArray<SceneDir, 3>& watched_velocity = {0.f, 0.f, 0.f},
+        bool only_terrain = false,
+        PhysicsMaterial collidable_mask = PhysicsMaterial::OBJ_BULLET_COLLIDABLE_MASK,
+        ScenePos can_be_seen_height_offset = 0,
+        float time_offset = 0) const;
     bool visit_spawn_preventers(
         const TransformationMatrix<SceneDir, ScenePos, 3>& trafo1,
         const std::list<TypedMesh<std::shared_ptr<IIntersectable>>>& intersectables1,
@@ -0,0 +1,47 @@
+#pragma once
+#include <Mlib/Geometry/Mesh/Typed_Mesh.hpp>
+#include <Mlib/Geometry/Primitives/Axis_Aligned_Bounding_Box.hpp>
+#include <Mlib/Geometry/Primitives/Collision_Polygon.hpp>
+#include <Mlib/Geometry/Primitives/Heightfield.hpp>
+#include <Mlib/Geometry/Primitives/Triangle_3D.hpp>
+#include <Mlib/Math/Transformation/Transformation_Matrix.hpp>
+#include <Mlib/Memory/Dangling_Base_Class.hpp>
+#include <Mlib/Scene_Config/Scene_Precision.hpp>
+#include <memory>
+
+namespace Mlib {
+
+class RigidBodyVehicle;
+
+struct RigidBodyAndHeightfield {
+    DanglingBaseClassRef<RigidBodyVehicle> rb;
+    TypedMesh<std::shared_ptr<const Heightfield>> heightfield;
+    TransformationMatrix<SceneDir, ScenePos, 3> local_to_world;
+    TransformationMatrix<SceneDir, ScenePos, 3> world_to_local;
+    AxisAlignedBoundingBox<CompressedScenePos, 3> aabb;
+    // Calls "visitor(const CollisionPolygonSphere<CompressedScenePos, 3>&)"
+    // for the heightfield triangles overlapping "world_aabb".
+    // The triangles are generated on demand, in world coordinates, s.t.
+    // the existing triangle contact handlers can be reused.
+    template <class TVisitor>
+    bool visit(
+        const AxisAlignedBoundingBox<CompressedScenePos, 3>& world_aabb,
+        const TVisitor& visitor) const
+    {
+        if (!world_aabb.intersects(aabb)) {
+            return true;
+        }
+        auto local_aabb = world_aabb.casted<ScenePos>().transformed(world_to_local);
+        return heightfield.mesh->visit_triangles(local_aabb, [&](const FixedArray<ScenePos, 3, 3>& corners){
+            auto c = local_to_world.transform(corners).template casted<CompressedScenePos>();
+            Triangle3D<CompressedScenePos> tri{ c };
+            return visitor(CollisionPolygonSphere<CompressedScenePos, 3>{
+                .bounding_sphere = BoundingSphere<CompressedScenePos, 3>{ c },
+                .polygon = tri.polygon().template casted<SceneDir, CompressedScenePos>(),
+                .physics_material = heightfield.physics_material,
+                .corners = c});
+        });
+    }
+};
+
+}
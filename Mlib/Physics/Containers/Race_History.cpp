@@ -112,9 +112,15 @@ std::string RaceHistory::config_json_filename() const {
     return (fs::path{race_dirname()} / "config.json").string();
 }
 
-std::string RaceHistory::track_m_filename(size_t id) const {
+std::string RaceHistory::track_filename(size_t id) const {
     std::shared_lock lock{ mutex_ };
-    return (fs::path{race_dirname()} / ("track_" + std::to_string(id) + ".m")).string();
+    auto stem = fs::path{race_dirname()} / ("track_" + std::to_string(id));
+    // Tracks recorded before the binary format was introduced.
+    auto legacy = stem.string() + ".m";
+    if (path_exists(legacy)) {
+        return legacy;
+    }
+    return stem.string() + ".mtrk";
 }
 
 void RaceHistory::set_race_identifier_and_reload(const RaceIdentifier& race_identifier) {
@@ -183,7 +189,7 @@ void RaceHistory::save_and_discard() {
                 ++ntracks;
                 return false;
             } else {
-                auto fn = track_m_filename(l.id);
+                auto fn = track_filename(l.id);
                 if (l.playback_exists) {
                     remove_path(fn);
                 } else if (path_exists(fn)) {
@@ -229,7 +235,7 @@ RaceState RaceHistory::notify_lap_finished(
     }
     if (save_playback_) {
         TrackWriter track_writer{
-            track_m_filename(max_id),
+            track_filename(max_id),
             scene_node_resources_.get_geographic_mapping(WORLD) };
         for (const auto& e : track) {
             track_writer.write(e);
@@ -297,7 +303,7 @@ std::optional<LapTimeEventAndIdAndMfilename> RaceHistory::get_winner_track_filen
             }
             return LapTimeEventAndIdAndMfilename{
                 .event = l.event,
-                .m_filename = track_m_filename(l.id)
+                .m_filename = track_filename(l.id)
             };
         }
     }
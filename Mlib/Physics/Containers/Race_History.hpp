@@ -61,7 +61,7 @@ private:
     std::string race_dirname() const;
     std::string stats_json_filename() const;
     std::string config_json_filename() const;
-    std::string track_m_filename(size_t id) const;
+    std::string track_filename(size_t id) const;
     void save_and_discard();
     size_t max_tracks_;
     bool save_playback_;
@@ -0,0 +1,441 @@
+#include "Ray_Query_Batch.hpp"
+#include <Mlib/Geometry/Mesh/IIntersectable_Mesh.hpp>
+#include <Mlib/Geometry/Primitives/Bounding_Sphere.hpp>
+#include <Mlib/Geometry/Primitives/Collision_Polygon.hpp>
+#include <Mlib/Geometry/Primitives/Heightfield.hpp>
+#include <Mlib/Geometry/Primitives/Intersectors/Ray_Packet_3D_For_Aabb.hpp>
+#include <Mlib/Geometry/Primitives/Intersectors/Ray_Segment_3D_For_Aabb.hpp>
+#include <Mlib/Physics/Physics_Engine/Physics_Engine.hpp>
+#include <Mlib/Physics/Rigid_Body/Rigid_Body_Vehicle.hpp>
+#include <algorithm>
+#include <array>
+#include <exception>
+#include <numeric>
+#include <optional>
+#include <stdexcept>
+
+using namespace Mlib;
+
+template <size_t tsize>
+static void cast_packet(
+    const RigidBodies& rigid_bodies,
+    const RayQuery* const* queries,
+    RayQueryHit* const* results,
+    size_t n,
+    RayQueryMode mode)
+{
+    RayPacket3DForAabb<ScenePos, tsize> packet;
+    std::array<std::optional<RaySegment3DForAabb<ScenePos, ScenePos>>, tsize> rays;
+    std::array<std::optional<BoundingSphere<CompressedScenePos, 3>>, tsize> bs;
+    bool all_only_terrain = true;
+    for (size_t i = 0; i < n; ++i) {
+        const auto& q = *queries[i];
+        rays[i].emplace(RaySegment3D<ScenePos, ScenePos>{ q.start, q.stop });
+        FixedArray<CompressedScenePos, 2, 3> l{
+            rays[i]->start.template casted<CompressedScenePos>(),
+            rays[i]->stop().template casted<CompressedScenePos>() };
+        bs[i].emplace(l);
+        packet.add(*rays[i]);
+        *results[i] = RayQueryHit{};
+        all_only_terrain &= q.only_terrain;
+    }
+    auto is_active = [&packet](size_t i) {
+        return (packet.active() & ((uint32_t)1 << i)) != 0;
+    };
+    auto record = [&](
+        size_t i,
+        ScenePos t,
+        const FixedArray<ScenePos, 3>& intersection_point,
+        const auto* polygon,
+        const RigidBodyVehicle* seen_object,
+        const IIntersectableMesh* seen_mesh)
+    {
+        auto& r = *results[i];
+        if (mode == RayQueryMode::ANY_HIT) {
+            r.distance = t;
+            packet.deactivate(i);
+            return;
+        }
+        if (t < r.distance) {
+            r.distance = t;
+            r.intersection_point = intersection_point;
+            r.polygon = polygon;
+            r.seen_object = seen_object;
+            r.seen_mesh = seen_mesh;
+        }
+    };
+    auto intersect = [&](size_t i, const auto& polygon0, const auto& on_hit) {
+        ScenePos t;
+        FixedArray<ScenePos, 3> intersection_pt = uninitialized;
+        if (rays[i]->intersects(
+            polygon0.polygon.template casted<ScenePos, ScenePos>(),
+            &t,
+            &intersection_pt))
+        {
+            on_hit(t, intersection_pt);
+        }
+    };
+    auto visit_lanes = [&](uint32_t mask, const auto& visit) {
+        for (size_t i = 0; mask != 0; ++i, mask >>= 1) {
+            if (mask & 1) {
+                visit(i);
+            }
+        }
+    };
+    // Moving objects are not in a BVH, they are visited by each lane.
+    if (!all_only_terrain) {
+        for (size_t i = 0; i < n; ++i) {
+            const auto& q = *queries[i];
+            if (q.only_terrain) {
+                continue;
+            }
+            for (const auto& o0 : rigid_bodies.transformed_objects()) {
+                if (!is_active(i)) {
+                    break;
+                }
+                if (&o0.rigid_body.get() == q.excluded0 ||
+                    &o0.rigid_body.get() == q.excluded1)
+                {
+                    continue;
+                }
+                for (const auto& msh0 : o0.meshes) {
+                    if (!any(msh0.physics_material & q.collidable_mask)) {
+                        continue;
+                    }
+                    if (!msh0.mesh->intersects(*bs[i])) {
+                        continue;
+                    }
+                    auto intersect_polygon = [&](const auto& polygon0){
+                        if (!is_active(i) || !polygon0.bounding_sphere.intersects(*bs[i])) {
+                            return;
+                        }
+                        intersect(i, polygon0, [&](ScenePos t, const FixedArray<ScenePos, 3>& p){
+                            record(i, t, p, &polygon0, &o0.rigid_body.get(), msh0.mesh.get());
+                        });
+                    };
+                    for (const auto& q0 : msh0.mesh->get_quads_sphere()) {
+                        intersect_polygon(q0);
+                    }
+                    for (const auto& t0 : msh0.mesh->get_triangles_sphere()) {
+                        intersect_polygon(t0);
+                    }
+                }
+            }
+        }
+    }
+    if (packet.active() != 0) {
+        rigid_bodies.convex_mesh_bvh().root_bvh.visit(
+            packet,
+            [&](const RigidBodyAndIntersectableMesh& rm0){
+                visit_lanes(packet.last_mask(), [&](size_t i){
+                    if (!any(rm0.mesh.physics_material & queries[i]->collidable_mask)) {
+                        return;
+                    }
+                    for (const auto& t0 : rm0.mesh.mesh->get_triangles_sphere()) {
+                        if (!is_active(i)) {
+                            return;
+                        }
+                        if (!bs[i]->intersects(t0.bounding_sphere) ||
+                            !bs[i]->intersects(t0.polygon.plane))
+                        {
+                            continue;
+                        }
+                        intersect(i, t0, [&](ScenePos t, const FixedArray<ScenePos, 3>& p){
+                            record(i, t, p, &t0, &rm0.rb.get(), rm0.mesh.mesh.get());
+                        });
+                    }
+                });
+                return packet.active() != 0;
+            });
+    }
+    if (packet.active() != 0) {
+        rigid_bodies.triangle_bvh().root_bvh.visit(
+            packet,
+            [&](const RigidBodyAndCollisionTriangleSphere<CompressedScenePos>& t0)
+            {
+                std::visit(
+                    [&](const auto& ctp)
+                    {
+                        visit_lanes(packet.last_mask(), [&](size_t i){
+                            if (!any(ctp.physics_material & queries[i]->collidable_mask)) {
+                                return;
+                            }
+                            intersect(i, ctp, [&](ScenePos t, const FixedArray<ScenePos, 3>& p){
+                                record(i, t, p, &ctp, &t0.rb, nullptr);
+                            });
+                        });
+                    }, t0.ctp);
+                return packet.active() != 0;
+            });
+    }
+    for (const auto& h : rigid_bodies.heightfields()) {
+        for (size_t i = 0; i < n; ++i) {
+            if (!is_active(i)) {
+                continue;
+            }
+            if (!any(h.heightfield.physics_material & queries[i]->collidable_mask)) {
+                continue;
+            }
+            const auto& ray = *rays[i];
+            HeightfieldHit hit{ NAN, uninitialized, uninitialized };
+            if (h.heightfield.mesh->intersect_ray(
+                h.world_to_local.transform(ray.start),
+                h.world_to_local.rotate(ray.direction).template casted<SceneDir>(),
+                ray.length,
+                hit))
+            {
+                // Heightfield triangles are generated on demand.
+                record(
+                    i,
+                    hit.distance,
+                    h.local_to_world.transform(hit.position),
+                    (const CollisionPolygonSphere<CompressedScenePos, 3>*)nullptr,
+                    &h.rb.get(),
+                    nullptr);
+            }
+        }
+    }
+}
+
+// Casts a single ray, traversing the BVHs with the scalar ray-box test.
+// Used by "CollisionQuery::can_see", and as reference for "cast_packet".
+static RayQueryHit cast_ray(
+    const RigidBodies& rigid_bodies,
+    const RayQuery& query,
+    RayQueryMode mode)
+{
+    RaySegment3DForAabb<ScenePos, ScenePos> ray{ RaySegment3D<ScenePos, ScenePos>{ query.start, query.stop } };
+    FixedArray<CompressedScenePos, 2, 3> l{
+        ray.start.casted<CompressedScenePos>(),
+        ray.stop().casted<CompressedScenePos>() };
+    BoundingSphere<CompressedScenePos, 3> bs{ l };
+    RayQueryHit result;
+    // Returns false to stop the traversal.
+    auto record = [&](
+        ScenePos t,
+        const FixedArray<ScenePos, 3>& intersection_point,
+        const auto* polygon,
+        const RigidBodyVehicle* seen_object,
+        const IIntersectableMesh* seen_mesh)
+    {
+        if (mode == RayQueryMode::ANY_HIT) {
+            result.distance = t;
+            return false;
+        }
+        if (t < result.distance) {
+            result.distance = t;
+            result.intersection_point = intersection_point;
+            result.polygon = polygon;
+            result.seen_object = seen_object;
+            result.seen_mesh = seen_mesh;
+        }
+        return true;
+    };
+    auto intersect = [&](const auto& polygon0, const auto& on_hit) {
+        ScenePos t;
+        FixedArray<ScenePos, 3> intersection_pt = uninitialized;
+        if (ray.intersects(
+            polygon0.polygon.template casted<ScenePos, ScenePos>(),
+            &t,
+            &intersection_pt))
+        {
+            return on_hit(t, intersection_pt);
+        }
+        return true;
+    };
+    if (!query.only_terrain) {
+        for (const auto& o0 : rigid_bodies.transformed_objects()) {
+            if (&o0.rigid_body.get() == query.excluded0 ||
+                &o0.rigid_body.get() == query.excluded1)
+            {
+                continue;
+            }
+            for (const auto& msh0 : o0.meshes) {
+                if (!any(msh0.physics_material & query.collidable_mask)) {
+                    continue;
+                }
+                if (!msh0.mesh->intersects(bs)) {
+                    continue;
+                }
+                auto intersect_polygon = [&](const auto& polygon0){
+                    if (!polygon0.bounding_sphere.intersects(bs)) {
+                        return true;
+                    }
+                    return intersect(polygon0, [&](ScenePos t, const FixedArray<ScenePos, 3>& p){
+                        return record(t, p, &polygon0, &o0.rigid_body.get(), msh0.mesh.get());
+                    });
+                };
+                for (const auto& q0 : msh0.mesh->get_quads_sphere()) {
+                    if (!intersect_polygon(q0)) {
+                        return result;
+                    }
+                }
+                for (const auto& t0 : msh0.mesh->get_triangles_sphere()) {
+                    if (!intersect_polygon(t0)) {
+                        return result;
+                    }
+                }
+            }
+        }
+    }
+    if (!rigid_bodies.convex_mesh_bvh().root_bvh.visit(
+        ray,
+        [&](const RigidBodyAndIntersectableMesh& rm0){
+            if (!any(rm0.mesh.physics_material & query.collidable_mask)) {
+                return true;
+            }
+            for (const auto& t0 : rm0.mesh.mesh->get_triangles_sphere()) {
+                if (!bs.intersects(t0.bounding_sphere) ||
+                    !bs.intersects(t0.polygon.plane))
+                {
+                    continue;
+                }
+                if (!intersect(t0, [&](ScenePos t, const FixedArray<ScenePos, 3>& p){
+                    return record(t, p, &t0, &rm0.rb.get(), rm0.mesh.mesh.get());
+                }))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }))
+    {
+        return result;
+    }
+    if (!rigid_bodies.triangle_bvh().root_bvh.visit(
+        ray,
+        [&](const RigidBodyAndCollisionTriangleSphere<CompressedScenePos>& t0)
+        {
+            return std::visit(
+                [&](const auto& ctp)
+                {
+                    if (!any(ctp.physics_material & query.collidable_mask)) {
+                        return true;
+                    }
+                    return intersect(ctp, [&](ScenePos t, const FixedArray<ScenePos, 3>& p){
+                        return record(t, p, &ctp, &t0.rb, nullptr);
+                    });
+                }, t0.ctp);
+        }))
+    {
+        return result;
+    }
+    for (const auto& h : rigid_bodies.heightfields()) {
+        if (!any(h.heightfield.physics_material & query.collidable_mask)) {
+            continue;
+        }
+        HeightfieldHit hit{ NAN, uninitialized, uninitialized };
+        if (h.heightfield.mesh->intersect_ray(
+            h.world_to_local.transform(ray.start),
+            h.world_to_local.rotate(ray.direction).casted<SceneDir>(),
+            ray.length,
+            hit))
+        {
+            // Heightfield triangles are generated on demand.
+            if (!record(
+                hit.distance,
+                h.local_to_world.transform(hit.position),
+                (const CollisionPolygonSphere<CompressedScenePos, 3>*)nullptr,
+                &h.rb.get(),
+                nullptr))
+            {
+                return result;
+            }
+        }
+    }
+    return result;
+}
+
+// Inserts two zero bits between the lower 10 bits.
+static uint32_t spread_bits_10(uint32_t x) {
+    x &= 0x3ff;
+    x = (x | (x << 16)) & 0x030000ff;
+    x = (x | (x << 8)) & 0x0300f00f;
+    x = (x | (x << 4)) & 0x030c30c3;
+    x = (x | (x << 2)) & 0x09249249;
+    return x;
+}
+
+RayQueryBatch::RayQueryBatch(const PhysicsEngine& physics_engine)
+    : physics_engine_{ physics_engine }
+{}
+
+RayQueryBatch::~RayQueryBatch() = default;
+
+size_t RayQueryBatch::add(const RayQuery& query) {
+    if (sum(squared(funpack(query.stop - query.start))) < 0x1p-40) {
+        throw std::runtime_error("Could not calculate ray direction");
+    }
+    queries_.push_back(query);
+    return queries_.size() - 1;
+}
+
+void RayQueryBatch::run(RayQueryMode mode) {
+    size_t n = queries_.size();
+    results_.resize(n);
+    if (n == 0) {
+        return;
+    }
+    // Sort by direction octant first, then along a Morton curve of the
+    // origins, s.t. the rays of a packet visit similar BVH nodes.
+    auto bounds = AxisAlignedBoundingBox<ScenePos, 3>::empty();
+    for (const auto& q : queries_) {
+        bounds.extend(q.start);
+    }
+    auto extent = bounds.size();
+    std::vector<uint64_t> keys(n);
+    for (size_t i = 0; i < n; ++i) {
+        const auto& q = queries_[i];
+        uint64_t octant = 0;
+        uint64_t morton = 0;
+        for (size_t d = 0; d < 3; ++d) {
+            octant |= (uint64_t)(q.stop(d) < q.start(d)) << d;
+            auto x = (extent(d) == 0)
+                ? 0.
+                : (q.start(d) - bounds.min(d)) / extent(d);
+            morton |= (uint64_t)spread_bits_10((uint32_t)(x * 1023)) << d;
+        }
+        keys[i] = (octant << 30) | morton;
+    }
+    order_.resize(n);
+    std::iota(order_.begin(), order_.end(), 0);
+    std::sort(order_.begin(), order_.end(), [&keys](size_t a, size_t b){
+        return keys[a] < keys[b];
+    });
+    size_t npackets = (n + PACKET_SIZE - 1) / PACKET_SIZE;
+    std::vector<std::exception_ptr> exceptions(npackets);
+    #pragma omp parallel for schedule(dynamic) if (npackets > 1)
+    for (int p = 0; p < (int)npackets; ++p) {
+        try {
+            const RayQuery* q[PACKET_SIZE];
+            RayQueryHit* r[PACKET_SIZE];
+            size_t begin = (size_t)p * PACKET_SIZE;
+            size_t end = std::min(begin + PACKET_SIZE, n);
+            for (size_t i = begin; i < end; ++i) {
+                q[i - begin] = &queries_[order_[i]];
+                r[i - begin] = &results_[order_[i]];
+            }
+            cast_packet<PACKET_SIZE>(physics_engine_.rigid_bodies_, q, r, end - begin, mode);
+        } catch (...) {
+            exceptions[(size_t)p] = std::current_exception();
+        }
+    }
+    for (const auto& e : exceptions) {
+        if (e != nullptr) {
+            std::rethrow_exception(e);
+        }
+    }
+}
+
+void RayQueryBatch::clear() {
+    queries_.clear();
+    results_.clear();
+}
+
+RayQueryHit RayQueryBatch::cast(
+    const PhysicsEngine& physics_engine,
+    const RayQuery& query,
+    RayQueryMode mode)
+{
+    return cast_ray(physics_engine.rigid_bodies_, query, mode);
+}
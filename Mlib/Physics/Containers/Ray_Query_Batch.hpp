@@ -0,0 +1,87 @@
+#pragma once
+#include <Mlib/Array/Fixed_Array.hpp>
+#include <Mlib/Geometry/Physics_Material.hpp>
+#include <Mlib/Scene_Config/Scene_Precision.hpp>
+#include <cmath>
+#include <cstddef>
+#include <variant>
+#include <vector>
+
+namespace Mlib {
+
+class RigidBodyVehicle;
+class PhysicsEngine;
+class IIntersectableMesh;
+template <class TPosition, size_t tnvertices>
+struct CollisionPolygonSphere;
+
+struct RayQuery {
+    FixedArray<ScenePos, 3> start;
+    FixedArray<ScenePos, 3> stop;
+    // Only used for moving objects, like in "CollisionQuery::can_see".
+    const RigidBodyVehicle* excluded0 = nullptr;
+    const RigidBodyVehicle* excluded1 = nullptr;
+    bool only_terrain = false;
+    PhysicsMaterial collidable_mask = PhysicsMaterial::OBJ_BULLET_COLLIDABLE_MASK;
+};
+
+struct RayQueryHit {
+    // Infinity if the ray is not blocked.
+    ScenePos distance = INFINITY;
+    FixedArray<ScenePos, 3> intersection_point = uninitialized;
+    // Null for heightfields.
+    std::variant<const CollisionPolygonSphere<CompressedScenePos, 3>*, const CollisionPolygonSphere<CompressedScenePos, 4>*> polygon;
+    const RigidBodyVehicle* seen_object = nullptr;
+    // Null for static triangles and heightfields.
+    const IIntersectableMesh* seen_mesh = nullptr;
+    inline bool hit() const {
+        return distance != INFINITY;
+    }
+};
+
+enum class RayQueryMode {
+    // Stops at the first blocker, only "RayQueryHit::hit" is valid.
+    ANY_HIT,
+    CLOSEST_HIT
+};
+
+// Casts many rays at once.
+// The rays are sorted by direction octant and by the Morton code of
+// their origins, and coherent rays are grouped into packets. A packet
+// traverses the static BVHs once, testing all of its lanes against
+// each box. The packets are distributed over the OpenMP threads.
+class RayQueryBatch {
+public:
+    static const size_t PACKET_SIZE = 8;
+    explicit RayQueryBatch(const PhysicsEngine& physics_engine);
+    ~RayQueryBatch();
+    size_t add(const RayQuery& query);
+    void run(RayQueryMode mode);
+    inline const RayQuery& query(size_t i) const {
+        return queries_[i];
+    }
+    inline const RayQueryHit& result(size_t i) const {
+        return results_[i];
+    }
+    inline bool can_see(size_t i) const {
+        return !results_[i].hit();
+    }
+    inline size_t size() const {
+        return queries_.size();
+    }
+    void clear();
+    // Casts a single ray on the calling thread, without allocations.
+    // Uses the scalar BVH traversal, which is the reference for the
+    // packet traversal of "run".
+    static RayQueryHit cast(
+        const PhysicsEngine& physics_engine,
+        const RayQuery& query,
+        RayQueryMode mode);
+private:
+    const PhysicsEngine& physics_engine_;
+    std::vector<RayQuery> queries_;
+    std::vector<RayQueryHit> results_;
+    std::vector<size_t> order_;
+};
+
+}
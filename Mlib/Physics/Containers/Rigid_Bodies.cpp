@@ -7,6 +7,7 @@
 #include <Mlib/Geometry/Mesh/Lazy_Transformed_Mesh.hpp>
 #include <Mlib/Geometry/Mesh/Static_Transformed_Mesh.hpp>
 #include <Mlib/Geometry/Physics_Material.hpp>
+#include <Mlib/Geometry/Primitives/Heightfield.hpp>
 #include <Mlib/Geometry/Welzl.hpp>
 #include <Mlib/Images/Svg.hpp>
 #include <Mlib/Math/Power_Of_Two_Divider.hpp>
@@ -18,6 +19,7 @@
 #include <Mlib/Physics/Rigid_Body/Rigid_Body_Vehicle.hpp>
 #include <Mlib/Scene_Config/Physics_Engine_Config.hpp>
 #include <Mlib/Testing/Assert.hpp>
+#include <algorithm>
 #include <stdexcept>
 
 using namespace Mlib;
@@ -69,14 +71,19 @@ void RigidBodies::add_rigid_body(
     const std::list<std::shared_ptr<ColoredVertexArray<float>>>& s_hitboxes,
     const std::list<std::shared_ptr<ColoredVertexArray<CompressedScenePos>>>& d_hitboxes,
     const std::list<TypedMesh<std::shared_ptr<IIntersectable>>>& intersectables,
-    CollidableMode collidable_mode)
+    CollidableMode collidable_mode,
+    const std::list<TypedMesh<std::shared_ptr<const Heightfield>>>& heightfields)
 {
     MALLOC_GUARD(malloc_guard, "add_rigid_body");
     if (is_colliding_ && any(collidable_mode & CollidableMode::COLLIDE)) {
         throw std::runtime_error("Attempt to add rigid body during collision-phase (0)");
     }
     auto& rb = rigid_body;
-    bool has_meshes_or_intersectables = !s_hitboxes.empty() || !d_hitboxes.empty() || !intersectables.empty();
+    bool has_meshes_or_intersectables =
+        !s_hitboxes.empty() ||
+        !d_hitboxes.empty() ||
+        !intersectables.empty() ||
+        !heightfields.empty();
     if (!any(collidable_mode & CollidableMode::COLLIDE) && has_meshes_or_intersectables) {
         throw std::runtime_error("Non-collidable has meshes or intersectables: \"" + rb.name() + '"');
     }
@@ -101,6 +108,39 @@ void RigidBodies::add_rigid_body(
         if (!intersectables.empty()) {
             throw std::runtime_error("Intersectables only supported for moving objects");
         }
+        std::list<RigidBodyAndHeightfield> rb_heightfields;
+        for (const auto& h : heightfields) {
+            auto local_to_world = rb.get_new_absolute_model_matrix();
+            rb_heightfields.push_back(RigidBodyAndHeightfield{
+                .rb = { rb, CURRENT_SOURCE_LOCATION },
+                .heightfield = h,
+                .local_to_world = local_to_world,
+                .world_to_local = local_to_world.inverted(),
+                .aabb = h.mesh->aabb().transformed(local_to_world).casted<CompressedScenePos>()});
+        }
+        // Concave ground triangles lying on a heightfield with the same
+        // physics material are handled by the heightfield. Other triangles,
+        // e.g. streets and buildings, stay in the triangle BVH, even if
+        // they lie on the heightfield.
+        auto is_covered_by_heightfield = [&](
+            const FixedArray<CompressedScenePos, 3>& p,
+            PhysicsMaterial physics_material)
+        {
+            if (!any(physics_material & PhysicsMaterial::OBJ_GROUND)) {
+                return false;
+            }
+            for (const auto& h : rb_heightfields) {
+                if (((h.heightfield.physics_material & ~PhysicsMaterial::ATTR_VISIBLE) ==
+                     (physics_material & ~PhysicsMaterial::ATTR_VISIBLE)) &&
+                    h.heightfield.mesh->covers(
+                    h.world_to_local.transform(p.casted<ScenePos>()),
+                    cfg_.heightfield_cover_tolerance))
+                {
+                    return true;
+                }
+            }
+            return false;
+        };
         // if (!tirelines.empty()) {
         //     throw std::runtime_error("static rigid body has tirelines");
         // }
@@ -188,6 +228,16 @@ void RigidBodies::add_rigid_body(
                             auto transformed = m->template transformed_polygon_bbox<tnvertices>(
                                 rb.get_new_absolute_model_matrix());
                             for (const auto& t : transformed) {
+                                if (!rb_heightfields.empty() &&
+                                    std::all_of(
+                                        t.base.corners.row_begin(),
+                                        t.base.corners.row_end(),
+                                        [&](const auto& p){
+                                            return is_covered_by_heightfield(p, m->meta.morphology.physics_material);
+                                        }))
+                                {
+                                    continue;
+                                }
                                 triangle_bvh_.root_bvh.insert(t.aabb, RigidBodyAndCollisionTriangleSphere<CompressedScenePos>{ rb, t.base });
                             }
                         };
@@ -201,6 +251,7 @@ void RigidBodies::add_rigid_body(
         };
         add_hitboxes(s_hitboxes);
         add_hitboxes(d_hitboxes);
+        heightfields_.splice(heightfields_.end(), rb_heightfields);
     } else if ((collidable_mode == (CollidableMode::COLLIDE | CollidableMode::MOVE)) ||
                (collidable_mode == CollidableMode::MOVE) ||
                (collidable_mode == CollidableMode::NONE))
@@ -208,6 +259,9 @@ void RigidBodies::add_rigid_body(
         if (!std::isfinite(rb.mass())) {
             throw std::runtime_error("Moving object requires finite mass");
         }
+        if (!heightfields.empty()) {
+            throw std::runtime_error("Heightfields only supported for terrain");
+        }
         RigidBodyAndMeshes& rbm = objects_.emplace_back(RigidBodyAndMeshes{ .rigid_body = { rb, CURRENT_SOURCE_LOCATION } });
         auto add_hitboxes = [&]<typename TPos>(
             const std::list<std::shared_ptr<ColoredVertexArray<TPos>>>& hitboxes,
@@ -286,6 +340,7 @@ void RigidBodies::delete_rigid_body(const RigidBodyVehicle& rigid_body) {
             convex_mesh_bvh_.clear();
             triangle_bvh_.clear();
             line_bvh_.clear();
+            heightfields_.clear();
         } else {
             throw std::runtime_error("Could not delete rigid body (3)");
         }
@@ -306,6 +361,7 @@ void RigidBodies::delete_rigid_body(const RigidBodyVehicle& rigid_body) {
     } else {
         throw std::runtime_error("Could not delete rigid body (5)");
     }
+    contact_cache_.forget(rigid_body.rbp_);
     collidable_modes_.erase(it);
     rigid_bodies_.erase(&rigid_body);
 }
@@ -401,6 +457,10 @@ const RigidBodies::LineBvh& RigidBodies::line_bvh() const {
     return line_bvh_;
 }
 
+const std::list<RigidBodyAndHeightfield>& RigidBodies::heightfields() const {
+    return heightfields_;
+}
+
 bool RigidBodies::empty() const {
     return objects_.empty();
 }
@@ -415,7 +475,10 @@ std::vector<CollisionGroup> RigidBodies::collision_groups() {
     std::list<RigidBodyAndMesh> standard_movables;
     std::unordered_set<RigidBodyPulses*> bullet_line_segments;
     for (auto& m : objects_) {
-        if ((m.rigid_body->mass() != INFINITY) && !m.rigid_body->is_deactivated()) {
+        if ((m.rigid_body->mass() != INFINITY) &&
+            !m.rigid_body->is_deactivated() &&
+            !m.rigid_body->is_kinematic())
+        {
             for (auto& mesh : m.meshes) {
                 // Bullet line segments are artificially long,
                 // so they work without substepping.
@@ -451,7 +514,7 @@ std::vector<CollisionGroup> RigidBodies::collision_groups() {
         if (it == collidable_modes_.end()) {
             throw std::runtime_error("Could not determine collidable mode");
         }
-        if (it->second == CollidableMode::MOVE) {
+        if ((it->second == CollidableMode::MOVE) && !m.rigid_body->is_kinematic()) {
             non_colliders_group.rigid_bodies.insert(&m.rigid_body->rbp_);
         }
     }
@@ -6,9 +6,11 @@
 #include <Mlib/Geometry/Primitives/Collision_Ridge.hpp>
 #include <Mlib/Iterator/Iterable_Wrapper.hpp>
 #include <Mlib/Memory/Dangling_Base_Class.hpp>
+#include <Mlib/Physics/Collision/Resolve/Contact_Cache.hpp>
 #include <Mlib/Physics/Containers/Elements/Collision_Line_Sphere.hpp>
 #include <Mlib/Physics/Containers/Elements/Collision_Ridge_Sphere.hpp>
 #include <Mlib/Physics/Containers/Elements/Collision_Triangle_Sphere.hpp>
+#include <Mlib/Physics/Containers/Elements/Rigid_Body_And_Heightfield.hpp>
 #include <Mlib/Physics/Containers/Ridge_Map.hpp>
 #include <Mlib/Regex/Regex_Select.hpp>
 #include <Mlib/Scene_Config/Scene_Precision.hpp>
@@ -33,6 +35,7 @@ template <class T>
 class DestructionFunctionsTokensRef;
 class CollisionMesh;
 class IIntersectable;
+class Heightfield;
 struct CollisionGroup;
 
 struct RigidBodyAndMeshes {
@@ -93,7 +96,8 @@ public:
         const std::list<std::shared_ptr<ColoredVertexArray<float>>>& s_hitboxes,
         const std::list<std::shared_ptr<ColoredVertexArray<CompressedScenePos>>>& d_hitboxes,
         const std::list<TypedMesh<std::shared_ptr<IIntersectable>>>& intersectables,
-        CollidableMode collidable_mode);
+        CollidableMode collidable_mode,
+        const std::list<TypedMesh<std::shared_ptr<const Heightfield>>>& heightfields = {});
     void delete_rigid_body(const RigidBodyVehicle& rigid_body);
     void optimize_search_time(std::ostream& ostr) const;
     void print_search_time() const;
@@ -106,6 +110,10 @@ public:
     const ConvexMeshBvh& convex_mesh_bvh() const;
     const TriangleBvh& triangle_bvh() const;
     const LineBvh& line_bvh() const;
+    const std::list<RigidBodyAndHeightfield>& heightfields() const;
+    inline ContactCache& contact_cache() {
+        return contact_cache_;
+    }
     bool empty() const;
     std::vector<CollisionGroup> collision_groups();
     void notify_colliding_start();
@@ -123,6 +131,9 @@ private:
     ConvexMeshBvh convex_mesh_bvh_;
     TriangleBvh triangle_bvh_;
     LineBvh line_bvh_;
+    std::list<RigidBodyAndHeightfield> heightfields_;
+    // Entries of a body are removed in the "delete_rigid_body" method.
+    ContactCache contact_cache_;
 };
 
 }
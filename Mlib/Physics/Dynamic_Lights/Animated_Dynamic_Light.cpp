@@ -1,5 +1,7 @@
 #include "Animated_Dynamic_Light.hpp"
+#include <Mlib/Geometry/Primitives/Bounding_Sphere.hpp>
 #include <Mlib/Physics/Dynamic_Lights/Dynamic_Lights.hpp>
+#include <Mlib/Physics/Dynamic_Lights/Light_Radius.hpp>
 #include <Mlib/Physics/Units.hpp>
 
 using namespace Mlib;
@@ -43,6 +45,11 @@ bool AnimatedDynamicLight::animation_completed(std::chrono::steady_clock::time_p
     return elapsed(time) > config_.time_to_color.xmax();
 }
 
+BoundingSphere<ScenePos, 3> AnimatedDynamicLight::bounding_sphere() const
+{
+    return { position_, light_radius(config_.squared_distance_to_intensity) };
+}
+
 float AnimatedDynamicLight::elapsed(std::chrono::steady_clock::time_point time) const {
     return std::chrono::duration<float>(time - creation_time_).count() * seconds;
 }
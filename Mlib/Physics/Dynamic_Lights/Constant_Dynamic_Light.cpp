@@ -1,5 +1,7 @@
 #include "Constant_Dynamic_Light.hpp"
+#include <Mlib/Geometry/Primitives/Bounding_Sphere.hpp>
 #include <Mlib/Physics/Dynamic_Lights/Dynamic_Lights.hpp>
+#include <Mlib/Physics/Dynamic_Lights/Light_Radius.hpp>
 
 using namespace Mlib;
 
@@ -39,3 +41,8 @@ bool ConstantDynamicLight::animation_completed(std::chrono::steady_clock::time_p
 {
     return false;
 }
+
+BoundingSphere<ScenePos, 3> ConstantDynamicLight::bounding_sphere() const
+{
+    return { position_, light_radius(config_.squared_distance_to_intensity) };
+}
@@ -29,6 +29,7 @@ public:
     virtual void set_time(std::chrono::steady_clock::time_point time) override;
     virtual FixedArray<float, 3> get_color(const FixedArray<ScenePos, 3>& target_position) const override;
     virtual bool animation_completed(std::chrono::steady_clock::time_point time) const override;
+    virtual BoundingSphere<ScenePos, 3> bounding_sphere() const override;
 
 private:
     std::function<FixedArray<ScenePos, 3>()> get_position_;
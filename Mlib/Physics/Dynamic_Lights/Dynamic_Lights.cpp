@@ -1,4 +1,5 @@
 #include "Dynamic_Lights.hpp"
+#include <Mlib/Geometry/Primitives/Bounding_Sphere.hpp>
 #include <Mlib/Physics/Dynamic_Lights/Animated_Dynamic_Light.hpp>
 #include <Mlib/Physics/Dynamic_Lights/Constant_Dynamic_Light.hpp>
 #include <Mlib/Physics/Dynamic_Lights/Dynamic_Light_Db.hpp>
@@ -8,6 +9,7 @@ using namespace Mlib;
 
 DynamicLights::DynamicLights(const DynamicLightDb& db)
     : db_{ db }
+    , clusters_valid_{ false }
 {}
 
 DynamicLights::~DynamicLights() = default;
@@ -31,6 +33,7 @@ std::unique_ptr<IDynamicLight> DynamicLights::instantiate(
     if (!instances_.emplace(result.get(), loc).second) {
         verbose_abort("DynamicLights::instantiate internal error");
     }
+    clusters_valid_ = false;
     return result;
 }
 
@@ -41,6 +44,7 @@ void DynamicLights::erase(IDynamicLight& light) {
         verbose_abort("Could not delete dynamic light");
     }
     instances_.erase(it);
+    clusters_valid_ = false;
 }
 
 bool DynamicLights::empty() const {
@@ -66,13 +70,30 @@ void DynamicLights::set_time(std::chrono::steady_clock::time_point time) {
             ++it;
         }
     }
+    lights_.clear();
+    spheres_.clear();
+    for (const auto& l : instances_) {
+        lights_.push_back(l.get());
+        spheres_.push_back(l->bounding_sphere());
+    }
+    clusters_.build(spheres_);
+    clusters_valid_ = true;
 }
 
 FixedArray<float, 3> DynamicLights::get_color(const FixedArray<ScenePos, 3>& target_position) const {
     FixedArray<float, 3> result = fixed_zeros<float, 3>();
     std::scoped_lock lock{ mutex_ };
-    for (const auto& l : instances_) {
-        result += l->get_color(target_position);
+    if (!clusters_valid_) {
+        for (const auto& l : instances_) {
+            result += l->get_color(target_position);
+        }
+        return result;
+    }
+    for (auto i : clusters_.lights_at(target_position)) {
+        result += lights_[i]->get_color(target_position);
+    }
+    for (auto i : clusters_.unbounded_lights()) {
+        result += lights_[i]->get_color(target_position);
     }
     return result;
 }
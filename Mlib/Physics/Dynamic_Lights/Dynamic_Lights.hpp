@@ -1,11 +1,13 @@
 #pragma once
 #include <Mlib/Memory/Destruction_Functions_Removeal_Tokens_Ptr.hpp>
 #include <Mlib/Os/Threads/Fast_Mutex.hpp>
+#include <Mlib/Physics/Dynamic_Lights/Light_Clusters.hpp>
 #include <Mlib/Scene_Graph/Interfaces/IDynamic_Lights.hpp>
 #include <chrono>
 #include <cstddef>
 #include <functional>
 #include <unordered_set>
+#include <vector>
 
 namespace Mlib {
 
@@ -24,6 +26,14 @@ public:
         std::chrono::steady_clock::time_point time,
         SourceLocation loc);
     void erase(IDynamicLight& light);
+    // Light grid built in "set_time". The light indices refer to "clustered_lights".
+    // Both are only valid until the next call to "instantiate", "erase" or "set_time".
+    inline const LightClusters& light_clusters() const {
+        return clusters_;
+    }
+    inline const std::vector<IDynamicLight*>& clustered_lights() const {
+        return lights_;
+    }
 
     // IDynamicLights
     virtual bool empty() const override;
@@ -38,6 +48,11 @@ private:
         std::hash<DanglingBaseClassPtr<IDynamicLight>>,
         DestructionFunctionsTokensPtrComparator<IDynamicLight>> instances_;
     mutable FastMutex mutex_;
+    std::vector<IDynamicLight*> lights_;
+    std::vector<BoundingSphere<ScenePos, 3>> spheres_;
+    LightClusters clusters_;
+    // "get_color" evaluates all lights while the clusters are outdated.
+    bool clusters_valid_;
 };
 
 }
@@ -0,0 +1,151 @@
+#include "Light_Clusters.hpp"
+#include <Mlib/Geometry/Primitives/Axis_Aligned_Bounding_Box.hpp>
+#include <Mlib/Geometry/Primitives/Bounding_Sphere.hpp>
+#include <Mlib/Math/Fixed_Math.hpp>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+using namespace Mlib;
+
+LightClusters::LightClusters(const LightClustersConfig& cfg)
+    : cfg_{ cfg }
+    , origin_{ fixed_zeros<ScenePos, 3>() }
+    , cell_size_{ cfg.cell_size }
+    , shape_{ fixed_zeros<size_t, 3>() }
+    , offsets_(1, 0)
+{
+    if (!(cfg_.cell_size > 0) || (cfg_.max_cells_per_axis == 0)) {
+        throw std::runtime_error("Invalid light cluster configuration");
+    }
+}
+
+LightClusters::~LightClusters() = default;
+
+void LightClusters::build(std::span<const BoundingSphere<ScenePos, 3>> lights) {
+    if (lights.size() > UINT32_MAX) {
+        throw std::runtime_error("Too many lights");
+    }
+    unbounded_.clear();
+    bounded_.clear();
+    auto bounds = AxisAlignedBoundingBox<ScenePos, 3>::empty();
+    for (size_t i = 0; i < lights.size(); ++i) {
+        const auto& l = lights[i];
+        if (!std::isfinite(l.radius)) {
+            unbounded_.push_back((uint32_t)i);
+            continue;
+        }
+        bounded_.push_back((uint32_t)i);
+        bounds.extend(AxisAlignedBoundingBox<ScenePos, 3>::from_center_and_radius(l.center, l.radius));
+    }
+    if (bounded_.empty()) {
+        origin_ = fixed_zeros<ScenePos, 3>();
+        cell_size_ = cfg_.cell_size;
+        shape_ = fixed_zeros<size_t, 3>();
+        offsets_.assign(1, 0);
+        indices_.clear();
+        return;
+    }
+    // The factor keeps the number of cells per axis below the maximum
+    // despite rounding.
+    auto size = bounds.size();
+    origin_ = bounds.min;
+    cell_size_ = std::max(
+        cfg_.cell_size,
+        std::max({ size(0), size(1), size(2) }) / (ScenePos)cfg_.max_cells_per_axis * (1 + 1e-6));
+    for (size_t d = 0; d < 3; ++d) {
+        shape_(d) = std::max<size_t>(1, (size_t)std::ceil(size(d) / cell_size_));
+    }
+    auto ncells = shape_(0) * shape_(1) * shape_(2);
+    auto cell_range = [this](const BoundingSphere<ScenePos, 3>& l, size_t d, ScenePos radius) {
+        auto index = [&](ScenePos x) {
+            return (size_t)std::clamp(std::floor((x - origin_(d)) / cell_size_), 0., (ScenePos)(shape_(d) - 1));
+        };
+        return std::make_pair(index(l.center(d) - radius), index(l.center(d) + radius));
+    };
+    // Calls "op" for each cell overlapping the light.
+    auto visit_cells = [&](const BoundingSphere<ScenePos, 3>& l, const auto& op) {
+        auto [x0, x1] = cell_range(l, 0, l.radius);
+        auto [y0, y1] = cell_range(l, 1, l.radius);
+        auto distance2 = [&](size_t d, size_t i) {
+            auto c0 = origin_(d) + cell_size_ * (ScenePos)i;
+            auto c1 = c0 + cell_size_;
+            auto x = l.center(d);
+            return (x < c0) ? squared(c0 - x) : (x > c1) ? squared(x - c1) : 0.;
+        };
+        auto r2 = squared(l.radius);
+        for (size_t x = x0; x <= x1; ++x) {
+            auto dx2 = distance2(0, x);
+            for (size_t y = y0; y <= y1; ++y) {
+                auto dxy2 = dx2 + distance2(1, y);
+                if (dxy2 > r2) {
+                    continue;
+                }
+                // The overlapping cells in z are contiguous.
+                auto [z0, z1] = cell_range(l, 2, std::sqrt(r2 - dxy2));
+                auto c = (x * shape_(1) + y) * shape_(2);
+                for (size_t z = z0; z <= z1; ++z) {
+                    op((uint32_t)(c + z));
+                }
+            }
+        }
+    };
+    // Count the overlapping cells of each light, then write the
+    // (light, cell) pairs, both in parallel.
+    auto nbounded = (int)bounded_.size();
+    pair_offsets_.resize(bounded_.size() + 1);
+    pair_offsets_[0] = 0;
+    #pragma omp parallel for if (nbounded > 256)
+    for (int k = 0; k < nbounded; ++k) {
+        uint32_t n = 0;
+        visit_cells(lights[bounded_[(size_t)k]], [&n](uint32_t){ ++n; });
+        pair_offsets_[(size_t)k + 1] = n;
+    }
+    for (size_t k = 0; k < bounded_.size(); ++k) {
+        pair_offsets_[k + 1] += pair_offsets_[k];
+    }
+    pair_cells_.resize(pair_offsets_.back());
+    #pragma omp parallel for if (nbounded > 256)
+    for (int k = 0; k < nbounded; ++k) {
+        auto* cells = pair_cells_.data() + pair_offsets_[(size_t)k];
+        visit_cells(lights[bounded_[(size_t)k]], [&cells](uint32_t c){ *cells++ = c; });
+    }
+    // Counting sort of the pairs by cell. The lights of a cell stay sorted
+    // by index, because the pairs are sorted by light.
+    offsets_.assign(ncells + 1, 0);
+    for (auto c : pair_cells_) {
+        ++offsets_[c + 1];
+    }
+    for (size_t c = 0; c < ncells; ++c) {
+        offsets_[c + 1] += offsets_[c];
+    }
+    indices_.resize(pair_cells_.size());
+    for (size_t k = 0; k < bounded_.size(); ++k) {
+        for (auto j = pair_offsets_[k]; j < pair_offsets_[k + 1]; ++j) {
+            indices_[offsets_[pair_cells_[j]]++] = bounded_[k];
+        }
+    }
+    // The scatter advanced each offset to the start of the next cell.
+    std::copy_backward(offsets_.begin(), offsets_.end() - 1, offsets_.end());
+    offsets_[0] = 0;
+}
+
+size_t LightClusters::cell_index(const FixedArray<ScenePos, 3>& position) const {
+    size_t result = 0;
+    for (size_t d = 0; d < 3; ++d) {
+        auto x = std::floor((position(d) - origin_(d)) / cell_size_);
+        if (!(x >= 0) || !(x < (ScenePos)shape_(d))) {
+            return SIZE_MAX;
+        }
+        result = result * shape_(d) + (size_t)x;
+    }
+    return result;
+}
+
+std::span<const uint32_t> LightClusters::lights_at(const FixedArray<ScenePos, 3>& position) const {
+    auto c = cell_index(position);
+    if (c == SIZE_MAX) {
+        return {};
+    }
+    return { indices_.data() + offsets_[c], indices_.data() + offsets_[c + 1] };
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include <Mlib/Array/Fixed_Array.hpp>
+#include <Mlib/Physics/Units.hpp>
+#include <Mlib/Scene_Config/Scene_Precision.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace Mlib {
+
+template <class TPos, size_t tndim>
+class BoundingSphere;
+
+struct LightClustersConfig {
+    ScenePos cell_size = 16 * meters;
+    // The cells are enlarged if the lights are spread over a larger area.
+    size_t max_cells_per_axis = 64;
+};
+
+// World-space grid of cells with the indices of the lights reaching
+// into each cell, s.t. a shaded point only evaluates the lights of its cell.
+// The lists are stored in one compact buffer: the lights of cell "i" are
+// "light_indices()[cell_offsets()[i]]" to "light_indices()[cell_offsets()[i + 1]]".
+// Lights with an infinite radius are not binned, but listed separately.
+class LightClusters {
+public:
+    explicit LightClusters(const LightClustersConfig& cfg = LightClustersConfig{});
+    ~LightClusters();
+    // Rebuilds the grid, the light indices refer to "lights".
+    void build(std::span<const BoundingSphere<ScenePos, 3>> lights);
+    // Lights of the cell containing "position", without the unbounded lights.
+    std::span<const uint32_t> lights_at(const FixedArray<ScenePos, 3>& position) const;
+    // Index of the cell containing "position", or SIZE_MAX if it is outside of the grid.
+    size_t cell_index(const FixedArray<ScenePos, 3>& position) const;
+    inline const std::vector<uint32_t>& unbounded_lights() const {
+        return unbounded_;
+    }
+    inline const std::vector<uint32_t>& cell_offsets() const {
+        return offsets_;
+    }
+    inline const std::vector<uint32_t>& light_indices() const {
+        return indices_;
+    }
+    inline const FixedArray<ScenePos, 3>& origin() const {
+        return origin_;
+    }
+    inline ScenePos cell_size() const {
+        return cell_size_;
+    }
+    inline const FixedArray<size_t, 3>& shape() const {
+        return shape_;
+    }
+private:
+    LightClustersConfig cfg_;
+    FixedArray<ScenePos, 3> origin_;
+    ScenePos cell_size_;
+    FixedArray<size_t, 3> shape_;
+    std::vector<uint32_t> offsets_;
+    std::vector<uint32_t> indices_;
+    std::vector<uint32_t> unbounded_;
+    // Scratch buffers, kept to avoid allocations in every frame.
+    std::vector<uint32_t> bounded_;
+    std::vector<uint32_t> pair_offsets_;
+    std::vector<uint32_t> pair_cells_;
+};
+
+}
@@ -0,0 +1,19 @@
+#pragma once
+#include <Mlib/Math/Interp.hpp>
+#include <Mlib/Scene_Config/Scene_Precision.hpp>
+#include <cmath>
+
+namespace Mlib {
+
+// Distance beyond which the light has no intensity, or infinity
+// if the intensity does not drop to zero.
+inline ScenePos light_radius(const Interp<ScenePos, float>& squared_distance_to_intensity) {
+    if (squared_distance_to_intensity.empty() ||
+        (squared_distance_to_intensity(INFINITY) != 0.f))
+    {
+        return INFINITY;
+    }
+    return std::sqrt(squared_distance_to_intensity.xmax());
+}
+
+}
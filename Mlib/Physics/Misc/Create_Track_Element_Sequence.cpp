@@ -0,0 +1,13 @@
+#include "Create_Track_Element_Sequence.hpp"
+#include <Mlib/Os/Os.hpp>
+#include <Mlib/Physics/Misc/Track_Element_Binary_File.hpp>
+#include <Mlib/Physics/Misc/Track_Element_File.hpp>
+
+using namespace Mlib;
+
+std::unique_ptr<ITrackElementSequence> Mlib::create_track_element_sequence(const std::string& filename) {
+    if (filename.ends_with(".mtrk")) {
+        return std::make_unique<TrackElementBinaryFile>(filename);
+    }
+    return std::make_unique<TrackElementFile>(create_ifstream(filename), filename);
+}
@@ -0,0 +1,12 @@
+#pragma once
+#include <Mlib/Physics/Misc/ITrack_Element_Sequence.hpp>
+#include <memory>
+#include <string>
+
+namespace Mlib {
+
+// Opens a track recorded by "TrackWriter", selecting the
+// binary reader for ".mtrk" files and the text reader otherwise.
+std::unique_ptr<ITrackElementSequence> create_track_element_sequence(const std::string& filename);
+
+}
@@ -17,6 +17,11 @@ public:
         size_t ntransformations) = 0;
     virtual bool eof() const = 0;
     virtual void restart() = 0;
+    // Moves the cursor to the last element with
+    // "elapsed_seconds <= elapsed_seconds", or to the first element,
+    // and returns its index. Sequences that can only be read in order
+    // return "std::nullopt" and leave the cursor unchanged.
+    virtual std::optional<size_t> seek(double elapsed_seconds) = 0;
 };
 
 }
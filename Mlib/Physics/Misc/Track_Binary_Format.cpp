@@ -0,0 +1,197 @@
+#include "Track_Binary_Format.hpp"
+#include <Mlib/Math/Math.hpp>
+#include <Mlib/Math/Transformation/Transformation_Matrix.hpp>
+#include <Mlib/Os/Io/Binary.hpp>
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+using namespace Mlib;
+
+template <class T>
+static T load(std::span<const std::byte> data, size_t offset) {
+    if ((offset > data.size()) || (data.size() - offset < sizeof(T))) {
+        throw std::runtime_error("Binary track data truncated");
+    }
+    T result;
+    std::memcpy(&result, data.data() + offset, sizeof(T));
+    return result;
+}
+
+static uint64_t zigzag(int64_t v) {
+    return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+}
+
+static int64_t unzigzag(uint64_t v) {
+    return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+}
+
+static void write_varint(uint64_t v, std::vector<std::byte>& data) {
+    while (v >= 0x80) {
+        data.push_back((std::byte)(v | 0x80));
+        v >>= 7;
+    }
+    data.push_back((std::byte)v);
+}
+
+static uint64_t read_varint(std::span<const std::byte> data, size_t& offset) {
+    uint64_t result = 0;
+    for (unsigned int shift = 0; shift < 64; shift += 7) {
+        if (offset >= data.size()) {
+            throw std::runtime_error("Binary track varint truncated");
+        }
+        auto b = (uint64_t)data[offset++];
+        result |= (b & 0x7f) << shift;
+        if ((b & 0x80) == 0) {
+            return result;
+        }
+    }
+    throw std::runtime_error("Binary track varint too long");
+}
+
+static int64_t quantized(double v, double resolution) {
+    if (!std::isfinite(v)) {
+        throw std::runtime_error("Cannot quantize non-finite track value");
+    }
+    return std::llround(v / resolution);
+}
+
+TrackBinaryQuantization TrackBinaryQuantization::from_geographic_mapping(
+    const TransformationMatrix<double, double, 3>& geographic_mapping,
+    double meters_resolution,
+    double rotation_resolution)
+{
+    TrackBinaryQuantization result{
+        .position_resolution = uninitialized,
+        .rotation_resolution = rotation_resolution
+    };
+    for (size_t r = 0; r < 3; ++r) {
+        double m = 0.;
+        for (size_t c = 0; c < 3; ++c) {
+            m = std::max(m, std::abs(geographic_mapping.R(r, c)));
+        }
+        if (m == 0.) {
+            throw std::runtime_error("Geographic mapping is singular");
+        }
+        result.position_resolution(r) = m * meters_resolution;
+    }
+    return result;
+}
+
+void TrackBinaryHeader::write(std::ostream& ostr) const {
+    write_binary(ostr, TRACK_BINARY_MAGIC, "magic");
+    write_binary(ostr, TRACK_BINARY_VERSION, "version");
+    write_binary(ostr, ntransformations, "ntransformations");
+    write_binary(ostr, block_size, "block size");
+    write_binary<uint64_t, true>(ostr, nframes, "nframes");
+    write_binary<uint64_t, true>(ostr, nblocks, "nblocks");
+    write_binary<uint64_t, true>(ostr, index_offset, "index offset");
+    for (double r : quantization.position_resolution.flat_iterable()) {
+        write_binary(ostr, r, "position resolution");
+    }
+    write_binary(ostr, quantization.rotation_resolution, "rotation resolution");
+}
+
+TrackBinaryHeader TrackBinaryHeader::read(std::span<const std::byte> data) {
+    if (load<uint32_t>(data, 0) != TRACK_BINARY_MAGIC) {
+        throw std::runtime_error("Not a binary track file");
+    }
+    if (load<uint32_t>(data, 4) != TRACK_BINARY_VERSION) {
+        throw std::runtime_error("Unsupported binary track version");
+    }
+    TrackBinaryHeader result{
+        .ntransformations = load<uint32_t>(data, 8),
+        .block_size = load<uint32_t>(data, 12),
+        .nframes = load<uint64_t>(data, 16),
+        .nblocks = load<uint64_t>(data, 24),
+        .index_offset = load<uint64_t>(data, 32),
+        .quantization = {
+            .position_resolution = {
+                load<double>(data, 40),
+                load<double>(data, 48),
+                load<double>(data, 56)},
+            .rotation_resolution = load<double>(data, 64)
+        }
+    };
+    if ((result.index_offset > data.size()) ||
+        ((data.size() - result.index_offset) / TrackBinaryBlockInfo::nbytes < result.nblocks))
+    {
+        throw std::runtime_error("Binary track index truncated");
+    }
+    return result;
+}
+
+void TrackBinaryBlockInfo::write(std::ostream& ostr) const {
+    write_binary<uint64_t, true>(ostr, offset, "block offset");
+    write_binary<uint64_t, true>(ostr, first_frame, "block first frame");
+    write_binary(ostr, first_elapsed_seconds, "block first elapsed seconds");
+}
+
+TrackBinaryBlockInfo TrackBinaryBlockInfo::read(std::span<const std::byte> data, size_t offset) {
+    return {
+        .offset = load<uint64_t>(data, offset),
+        .first_frame = load<uint64_t>(data, offset + 8),
+        .first_elapsed_seconds = load<float>(data, offset + 16)
+    };
+}
+
+TrackBinaryRowEncoder::TrackBinaryRowEncoder(const TrackBinaryHeader& header)
+    : header_{ header }
+    , state_(header.row_length())
+{}
+
+void TrackBinaryRowEncoder::encode(
+    std::span<const double> row,
+    bool first_in_block,
+    std::vector<std::byte>& data)
+{
+    if (row.size() != header_.row_length()) {
+        throw std::runtime_error("Unexpected binary track row length");
+    }
+    if (first_in_block) {
+        std::fill(state_.begin(), state_.end(), 0);
+    }
+    {
+        auto bits = (int64_t)std::bit_cast<uint32_t>((float)row[0]);
+        write_varint((uint64_t)(bits ^ state_[0]), data);
+        state_[0] = bits;
+    }
+    const auto& q = header_.quantization;
+    for (size_t i = 1; i < row.size(); ++i) {
+        size_t c = (i - 1) % TRACK_BINARY_ROW_STRIDE;
+        auto v = (c < 3)
+            ? quantized(row[i], q.position_resolution(c))
+            : quantized(row[i], q.rotation_resolution);
+        write_varint(zigzag(v - state_[i]), data);
+        state_[i] = v;
+    }
+}
+
+TrackBinaryRowDecoder::TrackBinaryRowDecoder(const TrackBinaryHeader& header)
+    : header_{ header }
+    , state_(header.row_length())
+{}
+
+void TrackBinaryRowDecoder::decode(
+    std::span<const std::byte> data,
+    size_t& offset,
+    bool first_in_block,
+    std::span<double> row)
+{
+    if (row.size() != header_.row_length()) {
+        throw std::runtime_error("Unexpected binary track row length");
+    }
+    if (first_in_block) {
+        std::fill(state_.begin(), state_.end(), 0);
+    }
+    state_[0] ^= (int64_t)read_varint(data, offset);
+    row[0] = std::bit_cast<float>((uint32_t)state_[0]);
+    const auto& q = header_.quantization;
+    for (size_t i = 1; i < row.size(); ++i) {
+        size_t c = (i - 1) % TRACK_BINARY_ROW_STRIDE;
+        state_[i] += unzigzag(read_varint(data, offset));
+        row[i] = (double)state_[i] * ((c < 3) ? q.position_resolution(c) : q.rotation_resolution);
+    }
+}
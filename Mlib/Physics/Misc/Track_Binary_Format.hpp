@@ -0,0 +1,98 @@
+#pragma once
+#include <Mlib/Array/Fixed_Array.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <span>
+#include <vector>
+
+namespace Mlib {
+
+template <class TDir, class TPos, size_t n>
+class TransformationMatrix;
+
+// Binary track format (".mtrk")
+//
+// The file stores the same rows as the text format, i.e.
+// "[elapsed_seconds, (x, y, z, rx, ry, rz) * ntransformations]" with
+// geographic positions, see "TrackElement::to_vector".
+// Layout: header, blocks, block index.
+// Every block holds up to "block_size" frames. The first frame of a
+// block is stored absolutely, the others as the difference to their
+// predecessor, s.t. every block can be decoded independently.
+// Positions and rotations are quantized to the resolution given in the
+// header and stored as zigzag-encoded varints. The elapsed time is
+// stored as the XOR of its IEEE bits with those of its predecessor,
+// which keeps it lossless.
+
+static const uint32_t TRACK_BINARY_MAGIC = 0x4b52544d; // "MTRK"
+static const uint32_t TRACK_BINARY_VERSION = 1;
+static const uint32_t TRACK_BINARY_DEFAULT_BLOCK_SIZE = 64;
+static const size_t TRACK_BINARY_ROW_STRIDE = 6;
+
+struct TrackBinaryQuantization {
+    // Resolution of the stored (geographic) positions, per axis.
+    FixedArray<double, 3> position_resolution;
+    // Resolution of the Tait-Bryan angles [rad].
+    double rotation_resolution;
+    // Resolution s.t. a step of "meters_resolution" in scene coordinates
+    // changes every geographic coordinate by at most one quantum.
+    static TrackBinaryQuantization from_geographic_mapping(
+        const TransformationMatrix<double, double, 3>& geographic_mapping,
+        double meters_resolution,
+        double rotation_resolution);
+};
+
+struct TrackBinaryHeader {
+    uint32_t ntransformations;
+    uint32_t block_size;
+    uint64_t nframes;
+    uint64_t nblocks;
+    uint64_t index_offset;
+    TrackBinaryQuantization quantization;
+    inline size_t row_length() const {
+        return 1 + TRACK_BINARY_ROW_STRIDE * ntransformations;
+    }
+    void write(std::ostream& ostr) const;
+    static TrackBinaryHeader read(std::span<const std::byte> data);
+    static const size_t nbytes = 4 * 4 + 3 * 8 + 4 * 8;
+};
+
+struct TrackBinaryBlockInfo {
+    uint64_t offset;
+    uint64_t first_frame;
+    float first_elapsed_seconds;
+    void write(std::ostream& ostr) const;
+    static TrackBinaryBlockInfo read(std::span<const std::byte> data, size_t offset);
+    static const size_t nbytes = 8 + 8 + 4;
+};
+
+// Encodes one row into "data". "state" holds the quantized
+// values of the predecessor and is updated.
+class TrackBinaryRowEncoder {
+public:
+    explicit TrackBinaryRowEncoder(const TrackBinaryHeader& header);
+    void encode(
+        std::span<const double> row,
+        bool first_in_block,
+        std::vector<std::byte>& data);
+private:
+    const TrackBinaryHeader& header_;
+    std::vector<int64_t> state_;
+};
+
+class TrackBinaryRowDecoder {
+public:
+    explicit TrackBinaryRowDecoder(const TrackBinaryHeader& header);
+    // Decodes one row starting at "offset", and advances "offset".
+    void decode(
+        std::span<const std::byte> data,
+        size_t& offset,
+        bool first_in_block,
+        std::span<double> row);
+private:
+    const TrackBinaryHeader& header_;
+    std::vector<int64_t> state_;
+};
+
+}
@@ -0,0 +1,107 @@
+#include "Track_Element_Binary_File.hpp"
+#include <Mlib/Os/Io/Mapped_File.hpp>
+#include <Mlib/Physics/Misc/Track_Element_Extended.hpp>
+#include <algorithm>
+#include <stdexcept>
+
+using namespace Mlib;
+
+TrackElementBinaryFile::TrackElementBinaryFile(std::string filename)
+    : filename_{ std::move(filename) }
+    , file_{ std::make_unique<MappedFile>(filename_) }
+    , header_{ TrackBinaryHeader::read(file_->data()) }
+    , decoder_{ header_ }
+    , decoded_block_{ SIZE_MAX }
+    , cursor_{ 0 }
+{
+    blocks_.reserve(header_.nblocks);
+    for (size_t i = 0; i < header_.nblocks; ++i) {
+        blocks_.push_back(TrackBinaryBlockInfo::read(
+            file_->data(),
+            header_.index_offset + i * TrackBinaryBlockInfo::nbytes));
+    }
+    if (!blocks_.empty() && (blocks_.back().first_frame >= header_.nframes)) {
+        throw std::runtime_error("Inconsistent block index in file \"" + filename_ + '"');
+    }
+}
+
+TrackElementBinaryFile::~TrackElementBinaryFile() = default;
+
+void TrackElementBinaryFile::decode_block(size_t block) {
+    if (block == decoded_block_) {
+        return;
+    }
+    const auto& b = blocks_.at(block);
+    size_t end = (block + 1 == blocks_.size())
+        ? header_.nframes
+        : blocks_[block + 1].first_frame;
+    block_rows_.resize(end - b.first_frame);
+    size_t offset = b.offset;
+    for (size_t i = 0; i < block_rows_.size(); ++i) {
+        block_rows_[i].resize(header_.row_length());
+        decoder_.decode(file_->data(), offset, i == 0, block_rows_[i]);
+    }
+    decoded_block_ = block;
+}
+
+const std::vector<double>& TrackElementBinaryFile::row(size_t frame) {
+    if (frame >= header_.nframes) {
+        throw std::runtime_error("Frame index out of bounds in file \"" + filename_ + '"');
+    }
+    auto it = std::upper_bound(
+        blocks_.begin(),
+        blocks_.end(),
+        frame,
+        [](size_t f, const TrackBinaryBlockInfo& b){ return f < b.first_frame; });
+    auto block = (size_t)(it - blocks_.begin()) - 1;
+    decode_block(block);
+    return block_rows_[frame - blocks_[block].first_frame];
+}
+
+TrackElementExtended TrackElementBinaryFile::read(
+    const std::optional<TrackElementExtended>& predecessor,
+    const TransformationMatrix<double, double, 3>& inverse_geographic_mapping,
+    size_t ntransformations)
+{
+    if (ntransformations != header_.ntransformations) {
+        throw std::runtime_error("Unexpected number of transformations in file \"" + filename_ + '"');
+    }
+    if (cursor_ == header_.nframes) {
+        ++cursor_;
+        return TrackElementExtended{};
+    }
+    if (cursor_ > header_.nframes) {
+        throw std::runtime_error("Attempt to read past the end of the track");
+    }
+    return TrackElementExtended::create(
+        predecessor,
+        TrackElement::from_vector(row(cursor_++), inverse_geographic_mapping, ntransformations));
+}
+
+bool TrackElementBinaryFile::eof() const {
+    return cursor_ > header_.nframes;
+}
+
+void TrackElementBinaryFile::restart() {
+    cursor_ = 0;
+}
+
+std::optional<size_t> TrackElementBinaryFile::seek(double elapsed_seconds) {
+    auto it = std::upper_bound(
+        blocks_.begin(),
+        blocks_.end(),
+        elapsed_seconds,
+        [](double t, const TrackBinaryBlockInfo& b){ return t < b.first_elapsed_seconds; });
+    if (it == blocks_.begin()) {
+        cursor_ = 0;
+        return cursor_;
+    }
+    auto block = (size_t)(it - blocks_.begin()) - 1;
+    decode_block(block);
+    size_t i = 1;
+    while ((i < block_rows_.size()) && (block_rows_[i][0] <= elapsed_seconds)) {
+        ++i;
+    }
+    cursor_ = blocks_[block].first_frame + i - 1;
+    return cursor_;
+}
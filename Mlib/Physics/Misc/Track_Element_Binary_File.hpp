@@ -0,0 +1,47 @@
+#pragma once
+#include <Mlib/Physics/Misc/ITrack_Element_Sequence.hpp>
+#include <Mlib/Physics/Misc/Track_Binary_Format.hpp>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Mlib {
+
+class MappedFile;
+
+// Reader of the binary track format. The file is memory-mapped and
+// only the block index is parsed on construction. Blocks are decoded
+// on demand, s.t. "seek" is O(log(nblocks) + block_size).
+class TrackElementBinaryFile: public ITrackElementSequence {
+public:
+    explicit TrackElementBinaryFile(std::string filename);
+    ~TrackElementBinaryFile();
+    virtual TrackElementExtended read(
+        const std::optional<TrackElementExtended>& predecessor,
+        const TransformationMatrix<double, double, 3>& inverse_geographic_mapping,
+        size_t ntransformations) override;
+    virtual bool eof() const override;
+    virtual void restart() override;
+    virtual std::optional<size_t> seek(double elapsed_seconds) override;
+    // Row in the format of "TrackElement::to_vector".
+    const std::vector<double>& row(size_t frame);
+    inline const TrackBinaryHeader& header() const {
+        return header_;
+    }
+    inline size_t nframes() const {
+        return header_.nframes;
+    }
+private:
+    void decode_block(size_t block);
+    std::string filename_;
+    std::unique_ptr<MappedFile> file_;
+    TrackBinaryHeader header_;
+    TrackBinaryRowDecoder decoder_;
+    std::vector<TrackBinaryBlockInfo> blocks_;
+    std::vector<std::vector<double>> block_rows_;
+    size_t decoded_block_;
+    size_t cursor_;
+};
+
+}
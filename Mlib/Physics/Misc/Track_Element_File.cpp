@@ -47,3 +47,7 @@ void TrackElementFile::restart() {
     istr_->clear();
     istr_->seekg(0);
 }
+
+std::optional<size_t> TrackElementFile::seek(double elapsed_seconds) {
+    return std::nullopt;
+}
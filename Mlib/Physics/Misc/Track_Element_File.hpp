@@ -18,6 +18,7 @@ public:
         size_t ntransformations) override;
     virtual bool eof() const override;
     virtual void restart() override;
+    virtual std::optional<size_t> seek(double elapsed_seconds) override;
 private:
     std::unique_ptr<std::istream> istr_;
     std::string filename_;
@@ -1,5 +1,6 @@
 #include "Track_Element_Vector.hpp"
 #include <Mlib/Physics/Misc/Track_Element_Extended.hpp>
+#include <algorithm>
 
 using namespace Mlib;
 
@@ -34,3 +35,15 @@ bool TrackElementVector::eof() const {
 void TrackElementVector::restart() {
     i_ = 0;
 }
+
+std::optional<size_t> TrackElementVector::seek(double elapsed_seconds) {
+    auto it = std::upper_bound(
+        track_.begin(),
+        track_.end(),
+        elapsed_seconds,
+        [](double t, const std::vector<double>& row){ return t < row.at(0); });
+    i_ = (it == track_.begin())
+        ? 0
+        : (size_t)(it - track_.begin()) - 1;
+    return i_;
+}
@@ -15,6 +15,7 @@ public:
         size_t ntransformations) override;
     virtual bool eof() const override;
     virtual void restart() override;
+    virtual std::optional<size_t> seek(double elapsed_seconds) override;
 private:
     std::vector<std::vector<double>> track_;
     size_t i_;
@@ -34,11 +34,28 @@ TrackReader::TrackReader(
 
 TrackReader::~TrackReader() = default;
 
-bool TrackReader::read(double& progress) {
+bool TrackReader::read(
+    double& progress,
+    const std::function<void(const TrackElementExtended&)>& on_element)
+{
     if (inverse_geographic_mapping_ == nullptr) {
         throw std::runtime_error("TrackReader::read without geographic mapping");
     }
-    history_.clear();
+    // Frames are only counted after the last lap, so seeking
+    // is disabled there.
+    if (!finished() &&
+        (interpolation_key_ == TrackElementInterpolationKey::ELAPSED_SECONDS) &&
+        ((nframes_remaining_ == SIZE_MAX) || (nlaps_remaining_ != 0)) &&
+        (!track_element1_.has_value() ||
+         (progress < track_element0_->progress(interpolation_key_)) ||
+         (progress > track_element1_->progress(interpolation_key_))))
+    {
+        if (auto frame_id = sequence_->seek(progress); frame_id.has_value()) {
+            track_element0_ = std::nullopt;
+            track_element1_ = std::nullopt;
+            frame_id_ = *frame_id;
+        }
+    }
     if (!sequence_->eof()) {
         while (!finished() && (!track_element1_.has_value() || (track_element1_->progress(interpolation_key_) < progress)))
         {
@@ -76,8 +93,8 @@ bool TrackReader::read(double& progress) {
             } else {
                 ++frame_id_;
             }
-            if (track_element1_.has_value()) {
-                history_.push_back(*track_element1_);
+            if (track_element1_.has_value() && on_element) {
+                on_element(*track_element1_);
             }
             if (!track_element0_.has_value()) {
                 track_element0_ = track_element1_;
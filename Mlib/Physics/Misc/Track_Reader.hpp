@@ -2,6 +2,7 @@
 #include <Mlib/Array/Fixed_Array.hpp>
 #include <Mlib/Math/Transformation/Transformation_Matrix.hpp>
 #include <Mlib/Physics/Misc/Track_Element_Extended.hpp>
+#include <functional>
 #include <optional>
 
 namespace Mlib {
@@ -25,14 +26,18 @@ public:
         TrackReaderInterpolationMode interpolation_mode,
         size_t ntransformations);
     ~TrackReader();
-    bool read(double& progress);
+    // Elements are read in order while the interpolation key is
+    // "METERS_TO_START". With "ELAPSED_SECONDS", a "progress" outside of
+    // the current pair of elements seeks the sequence, s.t. jumps and
+    // rewinds do not read the elements in between.
+    // "on_element" is called for every element read from the sequence.
+    bool read(
+        double& progress,
+        const std::function<void(const TrackElementExtended&)>& on_element = {});
     bool finished() const;
     inline const TrackElementExtended& track_element() const {
         return track_element_;
     }
-    inline std::list<TrackElementExtended>& history() {
-        return history_;
-    }
     inline size_t frame_id() const {
         return frame_id_;
     }
@@ -51,7 +56,6 @@ public:
 private:
     std::unique_ptr<ITrackElementSequence> sequence_;
     TrackElementExtended track_element_;
-    std::list<TrackElementExtended> history_;
     size_t frame_id_;
     size_t lap_id_;
     size_t nframes_remaining_;
@@ -0,0 +1,62 @@
+#include "Track_Reader_Gpx.hpp"
+#include <Mlib/Os/Os.hpp>
+#include <Mlib/Strings/String_View_To_Number.hpp>
+#include <iterator>
+#include <stdexcept>
+#include <string_view>
+
+using namespace Mlib;
+
+static std::string_view attribute(
+    std::string_view element,
+    std::string_view name,
+    const std::string& filename)
+{
+    auto key = std::string{ name } + "=\"";
+    auto b = element.find(key);
+    if (b == std::string_view::npos) {
+        throw std::runtime_error("Track point without \"" + std::string{ name } + "\" in file \"" + filename + '"');
+    }
+    b += key.length();
+    auto e = element.find('"', b);
+    if (e == std::string_view::npos) {
+        throw std::runtime_error("Unterminated attribute in file \"" + filename + '"');
+    }
+    return element.substr(b, e - b);
+}
+
+std::vector<FixedArray<double, 3>> Mlib::read_gpx_track(const std::string& filename) {
+    auto istr = create_ifstream(filename);
+    if (istr->fail()) {
+        throw std::runtime_error("Could not open gpx file \"" + filename + '"');
+    }
+    std::string text{ std::istreambuf_iterator<char>{ *istr }, std::istreambuf_iterator<char>{} };
+    if (istr->bad()) {
+        throw std::runtime_error("Could not read gpx file \"" + filename + '"');
+    }
+    std::vector<FixedArray<double, 3>> result;
+    std::string_view s = text;
+    for (size_t b = s.find("<trkpt"); b != std::string_view::npos; b = s.find("<trkpt", b)) {
+        auto e = s.find("</trkpt>", b);
+        if (e == std::string_view::npos) {
+            throw std::runtime_error("Unterminated track point in file \"" + filename + '"');
+        }
+        auto element = s.substr(b, e - b);
+        auto tag = element.substr(0, element.find('>'));
+        double ele = 0.;
+        if (auto eb = element.find("<ele>"); eb != std::string_view::npos) {
+            eb += 5;
+            auto ee = element.find("</ele>", eb);
+            if (ee == std::string_view::npos) {
+                throw std::runtime_error("Unterminated elevation in file \"" + filename + '"');
+            }
+            ele = safe_stod(element.substr(eb, ee - eb));
+        }
+        result.push_back({
+            safe_stod(attribute(tag, "lat", filename)),
+            safe_stod(attribute(tag, "lon", filename)),
+            ele});
+        b = e;
+    }
+    return result;
+}
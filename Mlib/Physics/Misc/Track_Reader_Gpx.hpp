@@ -0,0 +1,12 @@
+#pragma once
+#include <Mlib/Array/Fixed_Array.hpp>
+#include <string>
+#include <vector>
+
+namespace Mlib {
+
+// Reads the "(lat, lon, ele)" track points written by "TrackWriterGpx".
+// Missing elevations are set to zero.
+std::vector<FixedArray<double, 3>> read_gpx_track(const std::string& filename);
+
+}
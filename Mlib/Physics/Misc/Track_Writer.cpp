@@ -1,6 +1,8 @@
 #include "Track_Writer.hpp"
 #include <Mlib/Os/Os.hpp>
 #include <Mlib/Physics/Misc/Track_Element.hpp>
+#include <Mlib/Physics/Misc/Track_Writer_Binary.hpp>
+#include <Mlib/Physics/Units.hpp>
 #include <stdexcept>
 
 using namespace Mlib;
@@ -10,25 +12,58 @@ TrackWriter::TrackWriter(
     const TransformationMatrix<double, double, 3>* geographic_mapping)
     : filename_{ filename }
     , geographic_mapping_{ geographic_mapping }
-    , ofstr_{ create_ofstream(filename) }
 {
+    if (filename.ends_with(".mtrk")) {
+        // The binary file is created on the first write,
+        // when the number of transformations is known.
+        return;
+    }
+    ofstr_ = create_ofstream(filename);
     if (ofstr_->fail()) {
         throw std::runtime_error("Could not open track file for write \"" + filename + '"');
     }
 }
 
-TrackWriter::~TrackWriter() = default;
+TrackWriter::~TrackWriter() {
+    // The binary index and header are only written by "flush".
+    if (binary_ != nullptr) {
+        try {
+            binary_->flush();
+        } catch (const std::runtime_error& e) {
+            lerr() << e.what();
+        }
+    }
+}
 
 void TrackWriter::write(const TrackElement& e)
 {
     if (geographic_mapping_ == nullptr) {
         throw std::runtime_error("TrackWriter::write without geographic mapping");
     }
+    if (ofstr_ == nullptr) {
+        if (binary_ == nullptr) {
+            binary_ = std::make_unique<TrackWriterBinary>(
+                filename_,
+                e.transformations.size(),
+                TrackBinaryQuantization::from_geographic_mapping(
+                    *geographic_mapping_,
+                    1 * mm,                 // meters_resolution
+                    1e-5));                 // rotation_resolution
+        }
+        binary_->write(e.to_vector(*geographic_mapping_));
+        return;
+    }
     e.write_to_stream(*ofstr_, *geographic_mapping_);
     *ofstr_ << '\n';
 }
 
 void TrackWriter::flush() {
+    if (ofstr_ == nullptr) {
+        if (binary_ != nullptr) {
+            binary_->flush();
+        }
+        return;
+    }
     ofstr_->flush();
     if (ofstr_->fail()) {
         throw std::runtime_error("Could not write to file " + filename_);
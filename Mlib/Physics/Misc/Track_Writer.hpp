@@ -7,9 +7,12 @@
 namespace Mlib {
 
 struct TrackElement;
+class TrackWriterBinary;
 template <class TDir, class TPos, size_t n>
 class TransformationMatrix;
 
+// Writes the binary format if the filename ends with ".mtrk",
+// and the text format otherwise.
 class TrackWriter {
 public:
     TrackWriter(
@@ -22,6 +25,7 @@ private:
     std::string filename_;
     const TransformationMatrix<double, double, 3>* geographic_mapping_;
     std::unique_ptr<std::ostream> ofstr_;
+    std::unique_ptr<TrackWriterBinary> binary_;
 };
 
 }
@@ -0,0 +1,77 @@
+#include "Track_Writer_Binary.hpp"
+#include <Mlib/Memory/Integral_Cast.hpp>
+#include <Mlib/Os/Os.hpp>
+#include <ostream>
+#include <stdexcept>
+
+using namespace Mlib;
+
+TrackWriterBinary::TrackWriterBinary(
+    const std::string& filename,
+    size_t ntransformations,
+    const TrackBinaryQuantization& quantization,
+    size_t block_size)
+    : filename_{ filename }
+    , ofstr_{ create_ofstream(filename, std::ios::binary) }
+    , header_{
+        .ntransformations = integral_cast<uint32_t>(ntransformations),
+        .block_size = integral_cast<uint32_t>(block_size),
+        .nframes = 0,
+        .nblocks = 0,
+        .index_offset = TrackBinaryHeader::nbytes,
+        .quantization = quantization }
+    , encoder_{ header_ }
+    , block_nframes_{ 0 }
+{
+    if (ofstr_->fail()) {
+        throw std::runtime_error("Could not open track file for write \"" + filename + '"');
+    }
+    if (block_size == 0) {
+        throw std::runtime_error("Binary track block size is zero");
+    }
+    header_.write(*ofstr_);
+}
+
+TrackWriterBinary::~TrackWriterBinary() = default;
+
+void TrackWriterBinary::write(std::span<const double> row) {
+    if (block_nframes_ == 0) {
+        blocks_.push_back(TrackBinaryBlockInfo{
+            .offset = header_.index_offset,
+            .first_frame = header_.nframes,
+            .first_elapsed_seconds = (float)row[0] });
+    }
+    encoder_.encode(row, block_nframes_ == 0, block_data_);
+    ++header_.nframes;
+    if (++block_nframes_ == header_.block_size) {
+        write_block();
+    }
+}
+
+void TrackWriterBinary::write_block() {
+    ofstr_->seekp(integral_cast<std::streamoff>(header_.index_offset));
+    ofstr_->write((const char*)block_data_.data(), integral_cast<std::streamsize>(block_data_.size()));
+    if (ofstr_->fail()) {
+        throw std::runtime_error("Could not write to file " + filename_);
+    }
+    header_.index_offset += block_data_.size();
+    block_data_.clear();
+    block_nframes_ = 0;
+}
+
+void TrackWriterBinary::flush() {
+    if (block_nframes_ != 0) {
+        write_block();
+    }
+    header_.nblocks = blocks_.size();
+    ofstr_->seekp(integral_cast<std::streamoff>(header_.index_offset));
+    for (const auto& b : blocks_) {
+        b.write(*ofstr_);
+    }
+    ofstr_->seekp(0);
+    header_.write(*ofstr_);
+    ofstr_->flush();
+    if (ofstr_->fail()) {
+        throw std::runtime_error("Could not write to file " + filename_);
+    }
+}
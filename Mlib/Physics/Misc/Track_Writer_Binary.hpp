@@ -0,0 +1,39 @@
+#pragma once
+#include <Mlib/Physics/Misc/Track_Binary_Format.hpp>
+#include <cstddef>
+#include <iosfwd>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace Mlib {
+
+class TrackWriterBinary {
+    TrackWriterBinary(const TrackWriterBinary&) = delete;
+    TrackWriterBinary& operator = (const TrackWriterBinary&) = delete;
+public:
+    TrackWriterBinary(
+        const std::string& filename,
+        size_t ntransformations,
+        const TrackBinaryQuantization& quantization,
+        size_t block_size = TRACK_BINARY_DEFAULT_BLOCK_SIZE);
+    ~TrackWriterBinary();
+    // Writes a row in the format of "TrackElement::to_vector".
+    void write(std::span<const double> row);
+    // Writes the pending block, the block index and the header.
+    // Rows written afterwards overwrite the index, which is
+    // rewritten by the next call to "flush".
+    void flush();
+private:
+    void write_block();
+    std::string filename_;
+    std::unique_ptr<std::ostream> ofstr_;
+    TrackBinaryHeader header_;
+    TrackBinaryRowEncoder encoder_;
+    std::vector<TrackBinaryBlockInfo> blocks_;
+    std::vector<std::byte> block_data_;
+    size_t block_nframes_;
+};
+
+}
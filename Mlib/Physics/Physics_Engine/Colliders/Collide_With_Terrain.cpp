@@ -64,49 +64,57 @@ void Mlib::collide_with_terrain(
                             return true;
                         });
                 }
+                auto collide_triangle = [&](RigidBodyVehicle& rb0, const auto& ctp){
+                    if (any(ctp.physics_material & PhysicsMaterial::ATTR_CONVEX) &&
+                        any(msh1.physics_material & PhysicsMaterial::ATTR_CONVEX))
+                    {
+                        return true;
+                    }
+                    if (any(msh1.physics_material & PhysicsMaterial::OBJ_BULLET_MESH) &&
+                        !any(msh1.physics_material & PhysicsMaterial::ATTR_CONVEX))
+                    {
+                        collide_triangle_and_triangles(
+                            rb0,
+                            o1.rigid_body.get(),
+                            nullptr,
+                            msh1,
+                            ctp,
+                            history);
+                    }
+                    collide_triangle_and_edges(
+                        rb0,
+                        o1.rigid_body.get(),
+                        msh1,
+                        ctp,
+                        history);
+                    collide_triangle_and_lines(
+                        rb0,
+                        o1.rigid_body.get(),
+                        msh1,
+                        ctp,
+                        history);
+                    collide_triangle_and_intersectables(
+                        rb0,
+                        o1.rigid_body.get(),
+                        msh1,
+                        ctp,
+                        history);
+                    return true;
+                };
                 rigid_bodies.triangle_bvh().grid().visit(
                     msh1.mesh->aabb(),
                     [&](const RigidBodyAndCollisionTriangleSphere<CompressedScenePos>& t0){
-                        return std::visit([&](const auto& ctp)
-                            {
-                                if (any(ctp.physics_material & PhysicsMaterial::ATTR_CONVEX) &&
-                                    any(msh1.physics_material & PhysicsMaterial::ATTR_CONVEX))
-                                {
-                                    return true;
-                                }
-                                if (any(msh1.physics_material & PhysicsMaterial::OBJ_BULLET_MESH) &&
-                                    !any(msh1.physics_material & PhysicsMaterial::ATTR_CONVEX))
-                                {
-                                    collide_triangle_and_triangles(
-                                        t0.rb,
-                                        o1.rigid_body.get(),
-                                        nullptr,
-                                        msh1,
-                                        ctp,
-                                        history);
-                                }
-                                collide_triangle_and_edges(
-                                    t0.rb,
-                                    o1.rigid_body.get(),
-                                    msh1,
-                                    ctp,
-                                    history);
-                                collide_triangle_and_lines(
-                                    t0.rb,
-                                    o1.rigid_body.get(),
-                                    msh1,
-                                    ctp,
-                                    history);
-                                collide_triangle_and_intersectables(
-                                    t0.rb,
-                                    o1.rigid_body.get(),
-                                    msh1,
-                                    ctp,
-                                    history);
-                                return true;
-                            },
+                        return std::visit(
+                            [&](const auto& ctp){ return collide_triangle(t0.rb, ctp); },
                             t0.ctp);
                     });
+                for (const auto& h : rigid_bodies.heightfields()) {
+                    h.visit(
+                        msh1.mesh->aabb(),
+                        [&](const CollisionPolygonSphere<CompressedScenePos, 3>& ctp){
+                            return collide_triangle(h.rb.get(), ctp);
+                        });
+                }
                 rigid_bodies.line_bvh().visit(
                     msh1.mesh->aabb(),
                     [&](const RigidBodyAndCollisionLineSphere<CompressedScenePos>& e0){
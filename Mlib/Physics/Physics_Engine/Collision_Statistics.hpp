@@ -0,0 +1,39 @@
+#pragma once
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace Mlib {
+
+// Accumulated over all calls to "PhysicsEngine::collide" while it is
+// registered with "PhysicsEngine::set_collision_statistics".
+struct CollisionStatistics {
+    using Duration = std::chrono::steady_clock::duration;
+    size_t ncollide_calls = 0;
+    size_t ncontact_infos = 0;
+    size_t nraycast_intersections = 0;
+    size_t nconcave_t0_intersections = 0;
+    size_t ngrind_infos = 0;
+    size_t nwarm_started_contacts = 0;
+    // Sum of the contact residuals after every solver iteration.
+    std::vector<double> contact_residuals;
+    Duration movables_time = Duration::zero();
+    Duration terrain_time = Duration::zero();
+    Duration contact_generation_time = Duration::zero();
+    Duration solve_time = Duration::zero();
+    inline void clear() {
+        *this = CollisionStatistics{};
+    }
+    // Average factor by which the residual shrinks per iteration.
+    inline double contact_convergence_rate() const {
+        if ((contact_residuals.size() < 2) || (contact_residuals.front() == 0.)) {
+            return NAN;
+        }
+        return std::pow(
+            contact_residuals.back() / contact_residuals.front(),
+            1. / (double)(contact_residuals.size() - 1));
+    }
+};
+
+}
@@ -15,6 +15,7 @@
 #include <Mlib/Physics/Physics_Engine/Colliders/Collide_Raycast_Intersections.hpp>
 #include <Mlib/Physics/Physics_Engine/Colliders/Collide_With_Movables.hpp>
 #include <Mlib/Physics/Physics_Engine/Colliders/Collide_With_Terrain.hpp>
+#include <Mlib/Physics/Physics_Engine/Collision_Statistics.hpp>
 #include <Mlib/Physics/Physics_Engine/Physics_Phase.hpp>
 #include <Mlib/Physics/Rigid_Body/Rigid_Body_Vehicle.hpp>
 #include <Mlib/Physics/Smoke_Generation/Contact_Smoke_Generator.hpp>
@@ -33,6 +34,7 @@ PhysicsEngine::PhysicsEngine(
     , surface_contact_db_{ nullptr }
     , contact_smoke_generator_{ nullptr }
     , trail_renderer_{ nullptr }
+    , collision_statistics_{ nullptr }
     , cfg_{ cfg }
 {}
 
@@ -45,6 +47,7 @@ void PhysicsEngine::compute_transformed_objects(const PhysicsPhase* phase) {
     for (auto& o : rigid_bodies_.objects_) {
         if ((o.rigid_body->mass() == INFINITY) ||
             o.rigid_body->is_deactivated() ||
+            o.rigid_body->is_kinematic() ||
             !o.has_meshes())
         {
             continue;
@@ -81,21 +84,16 @@ void PhysicsEngine::collide(
     if (surface_contact_db_ == nullptr) {
         throw std::runtime_error("surface_contact_db not set");
     }
-    if (contact_smoke_generator_ == nullptr) {
-        throw std::runtime_error("contact_smoke_generator not set");
-    }
-    if (trail_renderer_ == nullptr) {
-        throw std::runtime_error("trail_renderer not set");
-    }
     CollisionHistory history{
         .cfg = cfg_,
         .phase = phase,
         .world = world,
         .surface_contact_db = *surface_contact_db_,
-        .csg = *contact_smoke_generator_,
-        .tr = *trail_renderer_,
+        .csg = contact_smoke_generator_,
+        .tr = trail_renderer_,
         .beacons = beacons,
         .contact_infos = contact_infos,
+        .contact_cache = cfg_.contact_warm_start ? &rigid_bodies_.contact_cache() : nullptr,
         .raycast_intersections = raycast_intersections,
         .concave_t0_intersections = concave_t0_intersections,
         .grind_infos = grind_infos,
@@ -110,24 +108,66 @@ void PhysicsEngine::collide(
     collision_direction_ = (collision_direction_ == CollisionDirection::FORWARD)
         ? CollisionDirection::BACKWARD
         : CollisionDirection::FORWARD;
+    auto time = std::chrono::steady_clock::now();
+    auto add_elapsed = [this, &time](CollisionStatistics::Duration CollisionStatistics::* duration) {
+        if (collision_statistics_ == nullptr) {
+            return;
+        }
+        auto now = std::chrono::steady_clock::now();
+        collision_statistics_->*duration += now - time;
+        time = now;
+    };
     if (phase.group.penetration_class != PenetrationClass::NONE) {
         collide_with_movables(
             collision_direction_,
             rigid_bodies_,
             history);
+        add_elapsed(&CollisionStatistics::movables_time);
         collide_with_terrain(
             rigid_bodies_,
             history);
+        add_elapsed(&CollisionStatistics::terrain_time);
     }
     for (const auto& o : rigid_bodies_.objects()) {
         o.rigid_body->finalize_collisions(history);
     }
+    if (collision_statistics_ != nullptr) {
+        ++collision_statistics_->ncollide_calls;
+        collision_statistics_->nraycast_intersections += raycast_intersections.size();
+        collision_statistics_->nconcave_t0_intersections += concave_t0_intersections.size();
+        collision_statistics_->ngrind_infos += grind_infos.size();
+    }
     // Handling rays before grind_infos so new grind_infos can be created
     // by rays also.
     collide_raycast_intersections(raycast_intersections);
     collide_grind_infos(cfg_, phase, world, contact_infos, grind_infos);
     collide_concave_triangles(cfg_, concave_t0_intersections, ridge_intersection_points);
-    solve_contacts(contact_infos, cfg_.dt_substeps(phase));
+    add_elapsed(&CollisionStatistics::contact_generation_time);
+    if (collision_statistics_ != nullptr) {
+        collision_statistics_->ncontact_infos += contact_infos.size();
+    }
+    float dt = cfg_.dt_substeps(phase);
+    if (cfg_.contact_warm_start) {
+        size_t nwarm_started = rigid_bodies_.contact_cache().warm_start(dt, cfg_.contact_warm_start_factor);
+        if (collision_statistics_ != nullptr) {
+            collision_statistics_->nwarm_started_contacts += nwarm_started;
+        }
+    }
+    if (collision_statistics_ != nullptr) {
+        std::vector<float> residuals;
+        solve_contacts(contact_infos, dt, cfg_.ncontact_iterations, &residuals);
+        auto& acc = collision_statistics_->contact_residuals;
+        acc.resize(std::max(acc.size(), residuals.size()), 0.);
+        for (size_t i = 0; i < residuals.size(); ++i) {
+            acc[i] += residuals[i];
+        }
+    } else {
+        solve_contacts(contact_infos, dt, cfg_.ncontact_iterations);
+    }
+    if (cfg_.contact_warm_start) {
+        rigid_bodies_.contact_cache().store(dt, phase.group, cfg_.contact_cache_max_age);
+    }
+    add_elapsed(&CollisionStatistics::solve_time);
     rigid_bodies_.notify_colliding_end();
 }
 
@@ -138,6 +178,7 @@ void PhysicsEngine::move_rigid_bodies(
 {
     for (const auto& rbm : rigid_bodies_.objects_) {
         if (rbm.rigid_body->is_deactivated() ||
+            rbm.rigid_body->is_kinematic() ||
             rbm.rigid_body->is_in_collision_error_state())
         {
             continue;
@@ -145,10 +186,9 @@ void PhysicsEngine::move_rigid_bodies(
         auto& rb = rbm.rigid_body;
         assert_true(rb->mass() != INFINITY);
         rb->advance_time(cfg_, world, beacons, phase);
-        if (contact_smoke_generator_ == nullptr) {
-            throw std::runtime_error("contact_smoke_generator not set");
+        if (contact_smoke_generator_ != nullptr) {
+            contact_smoke_generator_->advance_time(rb.get(), cfg_, phase);
         }
-        contact_smoke_generator_->advance_time(rb.get(), cfg_, phase);
     }
 }
 
@@ -239,6 +279,10 @@ void PhysicsEngine::set_trail_renderer(ITrailRenderer& trail_renderer) {
     trail_renderer_ = &trail_renderer;
 }
 
+void PhysicsEngine::set_collision_statistics(CollisionStatistics* collision_statistics) {
+    collision_statistics_ = collision_statistics;
+}
+
 void PhysicsEngine::add_external_force_provider(IExternalForceProvider& efp)
 {
     external_force_providers_.push_back(&efp);
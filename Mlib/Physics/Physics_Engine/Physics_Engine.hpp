@@ -17,6 +17,7 @@ class BaseLog;
 enum class CollisionDirection;
 class SurfaceContactDb;
 class ContactSmokeGenerator;
+struct CollisionStatistics;
 class ITrailRenderer;
 struct StaticWorld;
 struct PhysicsPhase;
@@ -47,8 +48,11 @@ public:
         const StaticWorld& world,
         float duration);
     void set_surface_contact_db(SurfaceContactDb& surface_contact_db);
+    // The contact smoke generator and the trail renderer are optional,
+    // s.t. the engine can run headless, e.g. in benchmarks.
     void set_contact_smoke_generator(ContactSmokeGenerator& contact_smoke_generator);
     void set_trail_renderer(ITrailRenderer& trail_renderer);
+    void set_collision_statistics(CollisionStatistics* collision_statistics);
     inline const PhysicsEngineConfig& config() const { return cfg_; }
 
     RigidBodies rigid_bodies_;
@@ -60,6 +64,7 @@ private:
     SurfaceContactDb* surface_contact_db_;
     ContactSmokeGenerator* contact_smoke_generator_;
     ITrailRenderer* trail_renderer_;
+    CollisionStatistics* collision_statistics_;
     std::list<IExternalForceProvider*> external_force_providers_;
     std::set<IControllable*> controllables_;
     PhysicsEngineConfig cfg_;
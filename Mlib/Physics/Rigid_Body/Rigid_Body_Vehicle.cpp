@@ -1224,6 +1224,19 @@ bool RigidBodyVehicle::is_in_collision_error_state() const {
     return any(flags_local_ & RigidBodyVehicleFlagsLocal::IS_IN_COLLISION_ERROR_STATE);
 }
 
+bool RigidBodyVehicle::is_kinematic() const {
+    return any(flags_local_ & RigidBodyVehicleFlagsLocal::IS_KINEMATIC);
+}
+
+void RigidBodyVehicle::set_kinematic(bool value) {
+    std::scoped_lock lock{ flags_mutex_ };
+    if (value) {
+        flags_local_ |= RigidBodyVehicleFlagsLocal::IS_KINEMATIC;
+    } else {
+        flags_local_ &= ~RigidBodyVehicleFlagsLocal::IS_KINEMATIC;
+    }
+}
+
 void RigidBodyVehicle::calibrate_controllers() {
     if (avatar_controller_ != nullptr) {
         avatar_controller_->calibrate();
@@ -281,6 +281,10 @@ public:
     bool is_deactivated() const;
     bool is_waiting_for_initial_position_or_velocity() const;
     bool is_in_collision_error_state() const;
+    // Kinematic bodies are moved by the caller, e.g. by a path follower,
+    // and are ignored by the collision detection and integration.
+    bool is_kinematic() const;
+    void set_kinematic(bool value);
 
     void calibrate_controllers();
 
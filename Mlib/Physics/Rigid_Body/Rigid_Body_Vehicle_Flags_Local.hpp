@@ -9,6 +9,7 @@ enum class RigidBodyVehicleFlagsLocal: uint32_t {
     WAITING_FOR_INITIAL_POSITION = (1 << 0),
     WAITING_FOR_INITIAL_VELOCITY = (1 << 1),
     IS_IN_COLLISION_ERROR_STATE = (1 << 2),
+    IS_KINEMATIC = (1 << 3),
     WAITING_FOR_INITIAL_POSITION_OR_VELOCITY = WAITING_FOR_INITIAL_POSITION | WAITING_FOR_INITIAL_VELOCITY,
 };
 
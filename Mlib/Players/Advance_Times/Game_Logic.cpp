@@ -24,6 +24,7 @@ GameLogic::GameLogic(
     : spawner{ vehicle_spawners, players, cfg, scene }
     , supply_depots_waypoints_collection{ supply_depots, navigate }
     , bystanders{ vehicle_spawners, players, spawner, cfg }
+    , simulation_lod{ vehicle_spawners, bystanders, cfg }
     , team_deathmatch{ vehicle_spawners, players, spawner, std::move(setup_new_round) }
     , vehicle_changer{ vehicle_spawners, scene.delete_node_mutex }
     , vehicle_spawners_{ vehicle_spawners }
@@ -45,11 +46,13 @@ void GameLogic::advance_time(float dt, const StaticWorld& world) {
     vehicle_spawners_.advance_time(dt);
     team_deathmatch.handle_respawn();
     bystanders.handle_bystanders();
+    simulation_lod.handle_simulation_lod(dt);
     vehicle_changer.change_vehicles(physics_engine_config_, world.time);
     supply_depots_.handle_supply_depots(dt);
     if (getenv_default_bool("PRINT_PLAYERS_ACTIVE", false)) {
         linfo() << "Players active: " << players_.nactive();
         linfo() << "Spawners active: " << vehicle_spawners_.nactive();
+        linfo() << "Kinematic bystanders: " << simulation_lod.nkinematic();
         linfo() << "ntry_spawns " << spawner.ntry_spawns_ << " , ndelete " << spawner.ndelete_;
     }
     if (getenv_default_bool("PRINT_SPAWNER_STATUS", false)) {
@@ -4,6 +4,7 @@
 #include <Mlib/Physics/Interfaces/IAdvance_Time.hpp>
 #include <Mlib/Players/Game_Logic/Bystanders.hpp>
 #include <Mlib/Players/Game_Logic/Navigate.hpp>
+#include <Mlib/Players/Game_Logic/Simulation_Lod.hpp>
 #include <Mlib/Players/Game_Logic/Spawner.hpp>
 #include <Mlib/Players/Game_Logic/Team_Deathmatch.hpp>
 #include <Mlib/Players/Game_Logic/Vehicle_Changer.hpp>
@@ -37,6 +38,7 @@ public:
     Spawner spawner;
     SupplyDepotsWaypointsCollection supply_depots_waypoints_collection;
     Bystanders bystanders;
+    SimulationLod simulation_lod;
     TeamDeathmatch team_deathmatch;
     VehicleChanger vehicle_changer;
 private:
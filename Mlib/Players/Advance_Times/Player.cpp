@@ -1017,33 +1017,31 @@ void Player::select_opponent(OpponentSelectionStrategy strategy) {
         if (!p.has_scene_vehicle()) {
             return -(ScenePos)INFINITY;
         }
-        if (!can_see(p.rigid_body().get())) {
-            return -(ScenePos)INFINITY;
-        }
+        ScenePos score;
         switch (strategy) {
-        case OpponentSelectionStrategy::KEEP: {
-            if (i == current_opponent_index) {
-                return (ScenePos)INFINITY;
-            } else {
-                return -(ScenePos)INFINITY;
-            }
-        }
-        case OpponentSelectionStrategy::NEXT: {
-            if (i == current_opponent_index) {
-                return -(ScenePos)INFINITY;
-            } else {
-                return (ScenePos)INFINITY;
-            }
-        }
+        case OpponentSelectionStrategy::KEEP:
+            score = (i == current_opponent_index) ? (ScenePos)INFINITY : -(ScenePos)INFINITY;
+            break;
+        case OpponentSelectionStrategy::NEXT:
+            score = (i == current_opponent_index) ? -(ScenePos)INFINITY : (ScenePos)INFINITY;
+            break;
         case OpponentSelectionStrategy::BEST: {
-            auto dist_squared = sum(squared(players_vec[i]->rigid_body()->rbp_.abs_position() - this->rigid_body()->rbp_.abs_position()));
+            auto dist_squared = sum(squared(p.rigid_body()->rbp_.abs_position() - this->rigid_body()->rbp_.abs_position()));
             if (i == current_opponent_index) {
                 dist_squared *= squared(select_opponent_hysteresis_factor_);
             }
-            return -dist_squared;
+            score = -dist_squared;
+            break;
+        }
+        default:
+            throw std::runtime_error("Unknown opponent selection strategy");
         }
+        // The visibility is checked last, s.t. rays are only cast for
+        // the candidates that can be selected.
+        if ((score == -INFINITY) || !can_see(p.rigid_body().get())) {
+            return -(ScenePos)INFINITY;
         }
-        throw std::runtime_error("Unknown opponent selection strategy");
+        return score;
         };
     ScenePos best_score = -INFINITY;
     Player* best_opponent = nullptr;
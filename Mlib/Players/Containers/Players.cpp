@@ -53,7 +53,7 @@ void Players::add_player(const DanglingBaseClassRef<Player>& player) {
     if (!teams_.contains(player->team_id())) {
         throw std::runtime_error("Unknown team: " + std::to_string(to_underlying(player->team_id()) + 0));
     }
-    auto player_id = player->id();
+    auto player_id = StringAtom{ player->id() };
     {
         auto pit = players_.try_emplace(player_id, player, CURRENT_SOURCE_LOCATION);
         if (!pit.second) {
@@ -61,16 +61,36 @@ void Players::add_player(const DanglingBaseClassRef<Player>& player) {
         }
         pit.first->second.on_destroy([this, player_id]() { remove_player(player_id); }, CURRENT_SOURCE_LOCATION);
     }
-    teams_.get(player->team_id())->add_player(player_id);
+    teams_.get(player->team_id())->add_player(player->id());
 }
 
 void Players::remove_player(const VariableAndHash<std::string>& name) {
+    auto atom = StringAtom::try_find(name);
+    if (!atom.has_value()) {
+        verbose_abort("Could not remove player \"" + *name + '"');
+    }
+    remove_player(*atom);
+}
+
+void Players::remove_player(StringAtom name) {
     if (players_.erase(name) != 1) {
         verbose_abort("Could not remove player \"" + *name + '"');
     }
 }
 
 DanglingBaseClassRef<Player> Players::get_player(const VariableAndHash<std::string>& name, SourceLocation loc) {
+    auto atom = StringAtom::try_find(name);
+    if (!atom.has_value()) {
+        throw std::runtime_error("No player with name \"" + *name + "\" exists");
+    }
+    return get_player(*atom, loc);
+}
+
+DanglingBaseClassRef<const Player> Players::get_player(const VariableAndHash<std::string>& name, SourceLocation loc) const {
+    return const_cast<Players*>(this)->get_player(name, loc);
+}
+
+DanglingBaseClassRef<Player> Players::get_player(StringAtom name, SourceLocation loc) {
     auto it = players_.find(name);
     if (it == players_.end()) {
         throw std::runtime_error("No player with name \"" + *name + "\" exists");
@@ -78,7 +98,7 @@ DanglingBaseClassRef<Player> Players::get_player(const VariableAndHash<std::stri
     return it->second.object().set_loc(loc);
 }
 
-DanglingBaseClassRef<const Player> Players::get_player(const VariableAndHash<std::string>& name, SourceLocation loc) const {
+DanglingBaseClassRef<const Player> Players::get_player(StringAtom name, SourceLocation loc) const {
     return const_cast<Players*>(this)->get_player(name, loc);
 }
 
@@ -243,11 +263,11 @@ std::string Players::get_score_board(ScoreBoardConfiguration config) const {
     return sstr.str();
 }
 
-StringWithHashUnorderedMap<DestructionFunctionsTokensRef<Player>>& Players::players() {
+StringAtomUnorderedMap<DestructionFunctionsTokensRef<Player>>& Players::players() {
     return players_;
 }
 
-const StringWithHashUnorderedMap<DestructionFunctionsTokensRef<Player>>& Players::players() const {
+const StringAtomUnorderedMap<DestructionFunctionsTokensRef<Player>>& Players::players() const {
     return players_;
 }
 
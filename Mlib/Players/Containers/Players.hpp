@@ -2,6 +2,7 @@
 #include <Mlib/Array/Array_Forward.hpp>
 #include <Mlib/Geometry/Graph/Point_And_Flags.hpp>
 #include <Mlib/Initialization/Default_Uninitialized_Vector.hpp>
+#include <Mlib/Map/String_Atom_Unordered_Map.hpp>
 #include <Mlib/Map/String_With_Hash_Unordered_Map.hpp>
 #include <Mlib/Map/Verbose_Unordered_Map.hpp>
 #include <Mlib/Memory/Dangling_Base_Class.hpp>
@@ -54,8 +55,11 @@ public:
     ~Players();
     void add_player(const DanglingBaseClassRef<Player>& player);
     void remove_player(const VariableAndHash<std::string>& name);
+    void remove_player(StringAtom name);
     DanglingBaseClassRef<Player> get_player(const VariableAndHash<std::string>& name, SourceLocation loc);
     DanglingBaseClassRef<const Player> get_player(const VariableAndHash<std::string>& name, SourceLocation loc) const;
+    DanglingBaseClassRef<Player> get_player(StringAtom name, SourceLocation loc);
+    DanglingBaseClassRef<const Player> get_player(StringAtom name, SourceLocation loc) const;
     Team& add_team(NTeamCountType id, VariableAndHash<std::string> name);
     DanglingBaseClassRef<Team> get_team(NTeamCountType id);
     DanglingBaseClassRef<const Team> get_team(NTeamCountType id) const;
@@ -76,15 +80,15 @@ public:
     uint32_t rank(float race_time_seconds) const;
     std::optional<LapTimeEventAndIdAndMfilename> get_winner_track_filename(size_t rank) const;
     std::string get_score_board(ScoreBoardConfiguration config) const;
-    StringWithHashUnorderedMap<DestructionFunctionsTokensRef<Player>>& players();
-    const StringWithHashUnorderedMap<DestructionFunctionsTokensRef<Player>>& players() const;
+    StringAtomUnorderedMap<DestructionFunctionsTokensRef<Player>>& players();
+    const StringAtomUnorderedMap<DestructionFunctionsTokensRef<Player>>& players() const;
     VerboseUnorderedMap<NTeamCountType, DestructionFunctionsTokensRef<Team>>& teams();
     const VerboseUnorderedMap<NTeamCountType, DestructionFunctionsTokensRef<Team>>& teams() const;
     size_t nactive() const;
 
     GameStatistics statistics;
 private:
-    StringWithHashUnorderedMap<DestructionFunctionsTokensRef<Player>> players_;
+    StringAtomUnorderedMap<DestructionFunctionsTokensRef<Player>> players_;
     VerboseUnorderedMap<NTeamCountType, DestructionFunctionsTokensRef<Team>> teams_;
     StringWithHashUnorderedMap<NTeamCountType> team_ids_;
     std::unique_ptr<RaceHistory> race_history_;
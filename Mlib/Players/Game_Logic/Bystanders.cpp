@@ -230,7 +230,7 @@ void Bystanders::add_vip(const DanglingBaseClassRef<Player>& vip, SourceLocation
     vips_.emplace_back(vip, loc);
 }
 
-void Bystanders::handle_bystanders() {
+std::vector<VipAndPosition> Bystanders::vip_positions() {
     std::vector<VipAndPosition> vips;
     vips.reserve(vips_.size());
     for (const auto& vip : vips_) {
@@ -242,6 +242,11 @@ void Bystanders::handle_bystanders() {
         FixedArray<float, 3> vip_z = z3_from_3x3(vip_m.R);
         vips.emplace_back(vip.get(), vip_z, vip_pos);
     }
+    return vips;
+}
+
+void Bystanders::handle_bystanders() {
+    auto vips = vip_positions();
     if (vips.empty()) {
         return;
     }
@@ -3,6 +3,7 @@
 #include <Mlib/Memory/Dangling_List.hpp>
 #include <Mlib/Scene_Config/Scene_Precision.hpp>
 #include <random>
+#include <vector>
 
 namespace Mlib {
 
@@ -29,6 +30,8 @@ public:
         GameLogicConfig& cfg);
     ~Bystanders();
     void handle_bystanders();
+    // Positions of the VIPs that currently have a vehicle.
+    std::vector<VipAndPosition> vip_positions();
     void add_vip(const DanglingBaseClassRef<Player>& vip, SourceLocation loc);
 private:
     bool spawn_for_vip(
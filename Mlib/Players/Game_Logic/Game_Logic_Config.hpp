@@ -1,4 +1,5 @@
 #pragma once
+#include <Mlib/Physics/Ai/Kinematic_Traffic.hpp>
 #include <Mlib/Physics/Units.hpp>
 
 namespace Mlib {
@@ -25,6 +26,16 @@ struct GameLogicConfig {
     // The one spawner visits at most 10 spawn points.
     size_t spawn_points_visited_max = 10;
     CompressedScenePos r_occupied_spawn_point = (CompressedScenePos)(5 * meters);
+    // Bystanders further away than this from all VIPs follow the waypoints
+    // kinematically, without contacts.
+    // Must be below "r_delete_far", s.t. the vehicles that stay visible
+    // beyond "r_delete_far" are not simulated.
+    CompressedScenePos r_kinematic_far = (CompressedScenePos)(250 * meters);
+    // Kinematic bystanders closer than this to a VIP are simulated again.
+    CompressedScenePos r_kinematic_near = (CompressedScenePos)(200 * meters);
+    // Bystanders further away than this from the waypoints stay dynamic.
+    CompressedScenePos r_kinematic_snap = (CompressedScenePos)(20 * meters);
+    KinematicTrafficConfig kinematic_traffic;
 };
 
 }
@@ -0,0 +1,180 @@
+#include "Simulation_Lod.hpp"
+#include <Mlib/Geometry/Coordinates/Gl_Look_At.hpp>
+#include <Mlib/Iterator/Enumerate.hpp>
+#include <Mlib/Math/Fixed_Math.hpp>
+#include <Mlib/Physics/Actuators/Tire.hpp>
+#include <Mlib/Physics/Ai/Kinematic_Traffic.hpp>
+#include <Mlib/Physics/Rigid_Body/Rigid_Body_Vehicle.hpp>
+#include <Mlib/Players/Advance_Times/Player.hpp>
+#include <Mlib/Players/Containers/Vehicle_Spawners.hpp>
+#include <Mlib/Players/Game_Logic/Bystanders.hpp>
+#include <Mlib/Players/Game_Logic/Game_Logic_Config.hpp>
+#include <Mlib/Players/Player/Pathfinding_Waypoints.hpp>
+#include <Mlib/Players/Scene_Vehicle/Vehicle_Spawner.hpp>
+#include <Mlib/Scene_Graph/Interfaces/Way_Points.hpp>
+#include <stdexcept>
+
+using namespace Mlib;
+
+SimulationLodTransition Mlib::simulation_lod_transition(
+    bool is_kinematic,
+    ScenePos dist2_to_closest_vip,
+    const GameLogicConfig& cfg)
+{
+    if (is_kinematic) {
+        if (dist2_to_closest_vip < squared(cfg.r_kinematic_near)) {
+            return SimulationLodTransition::TO_DYNAMIC;
+        }
+    } else if (dist2_to_closest_vip > squared(cfg.r_kinematic_far)) {
+        return SimulationLodTransition::TO_KINEMATIC;
+    }
+    return SimulationLodTransition::NONE;
+}
+
+SimulationLod::SimulationLod(
+    VehicleSpawners& vehicle_spawners,
+    Bystanders& bystanders,
+    GameLogicConfig& cfg)
+    : vehicle_spawners_{ vehicle_spawners }
+    , bystanders_{ bystanders }
+    , cfg_{ cfg }
+{
+    if (cfg_.r_kinematic_near >= cfg_.r_kinematic_far) {
+        throw std::runtime_error("r_kinematic_near must be smaller than r_kinematic_far");
+    }
+    if (cfg_.r_kinematic_far >= cfg_.r_delete_far) {
+        throw std::runtime_error("r_kinematic_far must be smaller than r_delete_far");
+    }
+}
+
+SimulationLod::~SimulationLod() = default;
+
+SimulationLod::KinematicVehicle::KinematicVehicle(
+    const DanglingBaseClassRef<RigidBodyVehicle>& rb,
+    KinematicTraffic& traffic,
+    uint32_t id,
+    ScenePos dy)
+    : rb{ rb, CURRENT_SOURCE_LOCATION }
+    , traffic{ traffic }
+    , id{ id }
+    , dy{ dy }
+{}
+
+bool SimulationLod::try_make_kinematic(
+    Player& player,
+    const DanglingBaseClassRef<RigidBodyVehicle>& rb)
+{
+    const auto& waypoints = player.pathfinding_waypoints().waypoints();
+    if ((waypoints == nullptr) ||
+        !player.pathfinding_waypoints().has_waypoints() ||
+        rb->is_deactivated() ||
+        !rb->has_vehicle_controller())
+    {
+        return false;
+    }
+    // Tires with rigid bodies of their own would keep being simulated.
+    for (const auto& [_, otire] : cenumerate(rb->tires_)) {
+        if (otire.has_value() && (otire->rb != nullptr)) {
+            return false;
+        }
+    }
+    auto& traffic = traffic_[waypoints.get()];
+    if (traffic == nullptr) {
+        traffic = std::make_unique<KinematicTraffic>(waypoints, cfg_.kinematic_traffic);
+    }
+    auto position = rb->rbp_.abs_position();
+    FixedArray<float, 3> direction = -rb->rbp_.abs_z();
+    auto id = traffic->try_add(
+        position,
+        direction,
+        dot0d(rb->rbp_.v_com_, direction),
+        funpack(cfg_.r_kinematic_snap));
+    if (!id.has_value()) {
+        return false;
+    }
+    auto dy = position(1) - traffic->state(*id).position(1);
+    auto it = kinematic_vehicles_.try_emplace(
+        &rb.get(),
+        rb,
+        *traffic,
+        *id,
+        dy).first;
+    it->second.rb.on_destroy([this, prb=&rb.get(), &tr=*traffic, id=*id](){
+        remove_from_traffic(tr, id);
+        kinematic_vehicles_.erase(prb);
+    }, CURRENT_SOURCE_LOCATION);
+    rb->set_kinematic(true);
+    return true;
+}
+
+void SimulationLod::make_dynamic(Player& player, KinematicVehicle& v) {
+    auto& rb = v.rb.get();
+    auto state = remove_from_traffic(v.traffic, v.id);
+    rb.set_kinematic(false);
+    player.pathfinding_waypoints().set_waypoint(state.target_waypoint_id);
+    kinematic_vehicles_.erase(&rb);
+}
+
+KinematicVehicleState SimulationLod::remove_from_traffic(KinematicTraffic& traffic, uint32_t id) {
+    auto state = traffic.remove(id);
+    if (traffic.size() == 0) {
+        traffic_.erase(traffic.waypoints().get());
+    }
+    return state;
+}
+
+void SimulationLod::update_pose(KinematicVehicle& v, float dt) {
+    auto& rbp = v.rb->rbp_;
+    auto state = v.traffic.state(v.id);
+    // Keep the previous rotation on vertical edges.
+    auto R = gl_lookat_relative(state.direction).value_or(rbp.rotation_);
+    state.position(1) += v.dy;
+    rbp.set_pose(R, state.position, 1.f, CURRENT_SOURCE_LOCATION);
+    rbp.set_v_com(state.direction * state.speed, dt, 1.f, CURRENT_SOURCE_LOCATION);
+    rbp.set_w(fixed_zeros<float, 3>(), dt, 1.f, CURRENT_SOURCE_LOCATION);
+}
+
+void SimulationLod::handle_simulation_lod(float dt) {
+    for (auto& [_, traffic] : traffic_) {
+        traffic->advance_time(dt);
+    }
+    for (auto& [_, v] : kinematic_vehicles_) {
+        update_pose(v, dt);
+    }
+    auto vips = bystanders_.vip_positions();
+    if (vips.empty()) {
+        return;
+    }
+    for (auto& [_, spawner] : vehicle_spawners_.spawners()) {
+        if ((spawner->get_spawn_trigger() != SpawnTrigger::BYSTANDERS) ||
+            !spawner->has_player())
+        {
+            continue;
+        }
+        auto player = spawner->get_player();
+        if (!player->has_scene_vehicle()) {
+            continue;
+        }
+        auto rb = player->rigid_body();
+        auto position = rb->rbp_.abs_position();
+        ScenePos dist2 = INFINITY;
+        for (const auto& vip : vips) {
+            if (&vip.player == &player.get()) {
+                dist2 = 0;
+                break;
+            }
+            dist2 = std::min(dist2, sum(squared(position - vip.position)));
+        }
+        auto kit = kinematic_vehicles_.find(&rb.get());
+        switch (simulation_lod_transition(kit != kinematic_vehicles_.end(), dist2, cfg_)) {
+        case SimulationLodTransition::NONE:
+            break;
+        case SimulationLodTransition::TO_KINEMATIC:
+            try_make_kinematic(player.get(), rb);
+            break;
+        case SimulationLodTransition::TO_DYNAMIC:
+            make_dynamic(player.get(), kit->second);
+            break;
+        }
+    }
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <Mlib/Memory/Destruction_Functions_Removeal_Tokens_Ref.hpp>
+#include <Mlib/Scene_Config/Scene_Precision.hpp>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+
+namespace Mlib {
+
+class VehicleSpawners;
+class Bystanders;
+class Player;
+class RigidBodyVehicle;
+class KinematicTraffic;
+struct KinematicVehicleState;
+struct WayPointsAndBvh;
+struct GameLogicConfig;
+
+enum class SimulationLodTransition {
+    NONE,
+    TO_KINEMATIC,
+    TO_DYNAMIC
+};
+
+// Hysteresis between "r_kinematic_near" and "r_kinematic_far".
+SimulationLodTransition simulation_lod_transition(
+    bool is_kinematic,
+    ScenePos dist2_to_closest_vip,
+    const GameLogicConfig& cfg);
+
+// Simulation level of detail of the bystanders.
+// Bystanders far away from all VIPs are switched to kinematic mode and
+// follow their waypoint graph (see "KinematicTraffic"). They are switched
+// back to full dynamics, with their current velocity and heading, when
+// they come close to a VIP again.
+class SimulationLod {
+    SimulationLod(const SimulationLod&) = delete;
+    SimulationLod& operator = (const SimulationLod&) = delete;
+public:
+    SimulationLod(
+        VehicleSpawners& vehicle_spawners,
+        Bystanders& bystanders,
+        GameLogicConfig& cfg);
+    ~SimulationLod();
+    void handle_simulation_lod(float dt);
+    inline size_t nkinematic() const {
+        return kinematic_vehicles_.size();
+    }
+private:
+    struct KinematicVehicle {
+        KinematicVehicle(
+            const DanglingBaseClassRef<RigidBodyVehicle>& rb,
+            KinematicTraffic& traffic,
+            uint32_t id,
+            ScenePos dy);
+        DestructionFunctionsTokensRef<RigidBodyVehicle> rb;
+        KinematicTraffic& traffic;
+        uint32_t id;
+        // Height of the vehicle above the waypoints.
+        ScenePos dy;
+    };
+    bool try_make_kinematic(
+        Player& player,
+        const DanglingBaseClassRef<RigidBodyVehicle>& rb);
+    void make_dynamic(Player& player, KinematicVehicle& v);
+    void update_pose(KinematicVehicle& v, float dt);
+    // Removes the traffic of a waypoint graph once its last vehicle is gone.
+    KinematicVehicleState remove_from_traffic(KinematicTraffic& traffic, uint32_t id);
+    VehicleSpawners& vehicle_spawners_;
+    Bystanders& bystanders_;
+    GameLogicConfig& cfg_;
+    std::unordered_map<const WayPointsAndBvh*, std::unique_ptr<KinematicTraffic>> traffic_;
+    std::unordered_map<const RigidBodyVehicle*, KinematicVehicle> kinematic_vehicles_;
+};
+
+}
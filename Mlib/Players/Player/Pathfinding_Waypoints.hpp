@@ -17,8 +17,11 @@ public:
     bool has_waypoints() const;
     void select_next_waypoint();
     void set_waypoints(std::shared_ptr<const WayPointsAndBvh> waypoints);
-private:
     void set_waypoint(size_t waypoint_id);
+    inline const std::shared_ptr<const WayPointsAndBvh>& waypoints() const {
+        return waypoints_;
+    }
+private:
     Player& player_;
     std::shared_ptr<const WayPointsAndBvh> waypoints_;
 };
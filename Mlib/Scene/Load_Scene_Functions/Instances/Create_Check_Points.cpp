@@ -13,7 +13,7 @@
 #include <Mlib/Misc/Argument_List.hpp>
 #include <Mlib/Misc/FPath.hpp>
 #include <Mlib/Physics/Advance_Times/Check_Points.hpp>
-#include <Mlib/Physics/Misc/Track_Element_File.hpp>
+#include <Mlib/Physics/Misc/Create_Track_Element_Sequence.hpp>
 #include <Mlib/Physics/Misc/Track_Element_Vector.hpp>
 #include <Mlib/Physics/Physics_Engine/Physics_Engine.hpp>
 #include <Mlib/Players/Advance_Times/Player.hpp>
@@ -112,7 +112,7 @@ void CreateCheckPoints::execute(const LoadSceneJsonUserFunctionArgs& args)
     std::unique_ptr<ITrackElementSequence> sequence;
     if (args.arguments.contains_non_null(KnownArgs::track_filename)) {
         auto filename = args.arguments.path(KnownArgs::track_filename);
-        sequence = std::make_unique<TrackElementFile>(create_ifstream(filename), filename);
+        sequence = create_track_element_sequence(filename);
     } else {
         sequence = std::make_unique<TrackElementVector>(args.arguments.at<std::vector<std::vector<double>>>(KnownArgs::track));
     }
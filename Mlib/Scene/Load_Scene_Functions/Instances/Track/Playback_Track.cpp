@@ -7,7 +7,7 @@
 #include <Mlib/Macro_Executor/Replacement_Parameter.hpp>
 #include <Mlib/Misc/Argument_List.hpp>
 #include <Mlib/Physics/Advance_Times/Movables/Rigid_Body_Playback.hpp>
-#include <Mlib/Physics/Misc/Track_Element_File.hpp>
+#include <Mlib/Physics/Misc/Create_Track_Element_Sequence.hpp>
 #include <Mlib/Physics/Physics_Engine/Physics_Engine.hpp>
 #include <Mlib/Scene/Json_User_Function_Args.hpp>
 #include <Mlib/Scene/Load_Scene_Funcs.hpp>
@@ -43,7 +43,7 @@ void PlaybackTrack::execute(const LoadSceneJsonUserFunctionArgs& args) {
     auto node_prefixes = vars.database.at<std::vector<std::string>>("node_prefixes");
     auto filename = args.arguments.path(KnownArgs::filename);
     auto playback = std::make_shared<RigidBodyPlayback>(
-        std::make_unique<TrackElementFile>(create_ifstream(filename), filename),
+        create_track_element_sequence(filename),
         countdown_start,
         scene_node_resources.get_geographic_mapping(VariableAndHash<std::string>{"world.inverse"}),
         args.arguments.at<float>(KnownArgs::speed),
@@ -8,7 +8,7 @@
 #include <Mlib/Misc/Argument_List.hpp>
 #include <Mlib/Physics/Advance_Times/Movables/Rigid_Body_Playback.hpp>
 #include <Mlib/Physics/Containers/Race_History.hpp>
-#include <Mlib/Physics/Misc/Track_Element_File.hpp>
+#include <Mlib/Physics/Misc/Create_Track_Element_Sequence.hpp>
 #include <Mlib/Physics/Physics_Engine/Physics_Engine.hpp>
 #include <Mlib/Players/Containers/Players.hpp>
 #include <Mlib/Scene/Json_User_Function_Args.hpp>
@@ -52,7 +52,7 @@ void PlaybackWinnerTrack::execute(const LoadSceneJsonUserFunctionArgs& args) {
     auto node_prefixes = vars.database.at<std::vector<std::string>>("node_prefixes");
     auto filename = wt->m_filename;
     auto playback = std::make_shared<RigidBodyPlayback>(
-        std::make_unique<TrackElementFile>(create_ifstream(filename), filename),
+        create_track_element_sequence(filename),
         countdown_start,
         scene_node_resources.get_geographic_mapping(VariableAndHash<std::string>{"world.inverse"}),
         args.arguments.at<float>(KnownArgs::speed),
@@ -5,6 +5,9 @@
 #include <Mlib/Geometry/Mesh/Colored_Vertex_Array.hpp>
 #include <Mlib/Geometry/Mesh/Colored_Vertex_Array_Filter.hpp>
 #include <Mlib/Geometry/Mesh/Save_Polygon_To_Obj.hpp>
+#include <Mlib/Geometry/Physics_Material.hpp>
+#include <Mlib/Geometry/Primitives/Heightfield.hpp>
+#include <Mlib/Geography/Heightmaps/Load_Heightmap_From_File.hpp>
 #include <Mlib/Macro_Executor/Json_Macro_Arguments.hpp>
 #include <Mlib/Math/Transformation/Transformation_Matrix_Json.hpp>
 #include <Mlib/Misc/Argument_List.hpp>
@@ -35,6 +38,11 @@ DECLARE_ARGUMENT(asset_id);
 DECLARE_ARGUMENT(included_names);
 DECLARE_ARGUMENT(excluded_names);
 DECLARE_ARGUMENT(flags);
+DECLARE_ARGUMENT(heightmap);
+DECLARE_ARGUMENT(heightmap_origin);
+DECLARE_ARGUMENT(heightmap_cell_size);
+DECLARE_ARGUMENT(heightmap_z_scale);
+DECLARE_ARGUMENT(heightmap_physics_material);
 }
 
 CreateRigidStatics::CreateRigidStatics(PhysicsScene& physics_scene)
@@ -82,13 +90,27 @@ void CreateRigidStatics::execute(const LoadSceneJsonUserFunctionArgs& args)
         insert(s_hitboxes, acva->scvas);
         insert(d_hitboxes, acva->dcvas);
     }
+    std::list<TypedMesh<std::shared_ptr<const Heightfield>>> heightfields;
+    if (args.arguments.contains_non_null(KnownArgs::heightmap)) {
+        auto heights = load_heightmap_from_file<float>(args.arguments.path(KnownArgs::heightmap));
+        heights *= args.arguments.at<float>(KnownArgs::heightmap_z_scale, 1.f);
+        heightfields.push_back({
+            .physics_material = physics_material_from_string(args.arguments.at<std::string>(
+                KnownArgs::heightmap_physics_material,
+                "attr_collide|attr_concave|obj_ground")),
+            .mesh = std::make_shared<Heightfield>(
+                std::move(heights),
+                args.arguments.at<EFixedArray<ScenePos, 2>>(KnownArgs::heightmap_origin) * (ScenePos)meters,
+                args.arguments.at<EFixedArray<ScenePos, 2>>(KnownArgs::heightmap_cell_size) * (ScenePos)meters)});
+    }
     try {
         physics_engine.rigid_bodies_.add_rigid_body(
             *rb,
             s_hitboxes,
             d_hitboxes,
             {},
-            CollidableMode::COLLIDE);
+            CollidableMode::COLLIDE,
+            heightfields);
         object_pool.add(global_object_pool.extract(std::move(rb)), CURRENT_SOURCE_LOCATION);
     } catch (const TriangleException<double>& e) {
         if (auto filename = try_getenv("RIGID_BODY_TRIANGLE_FILENAME"); filename.has_value()) {
@@ -286,6 +286,7 @@ DECLARE_ARGUMENT(game_level);
 DECLARE_ARGUMENT(base_osm_map_resource);
 DECLARE_ARGUMENT(navmesh_resource);
 DECLARE_ARGUMENT(agent_radius);
+DECLARE_ARGUMENT(navmesh_tile_size);
 DECLARE_ARGUMENT(refine_explicit_waypoints);
 DECLARE_ARGUMENT(displacementmap);
 DECLARE_ARGUMENT(displacementmap_min);
@@ -1188,6 +1189,9 @@ static void load_osm_resource(const LoadSceneJsonUserFunctionArgs& args) {
         if (args.arguments.contains(KnownArgs::agent_radius)) {
             config.agent_radius = args.arguments.at<float>(KnownArgs::agent_radius) * meters;
         }
+        if (args.arguments.contains(KnownArgs::navmesh_tile_size)) {
+            config.navmesh_tile_size = args.arguments.at<float>(KnownArgs::navmesh_tile_size);
+        }
         if (args.arguments.contains(KnownArgs::refine_explicit_waypoints)) {
             config.refine_explicit_waypoints = args.arguments.at<bool>(KnownArgs::refine_explicit_waypoints);
         }
@@ -8,6 +8,7 @@
 #include <Mlib/Geometry/Mesh/Load/Load_Mesh_Config.hpp>
 #include <Mlib/Geometry/Mesh/Load/Load_Pssg.hpp>
 #include <Mlib/Geometry/Mesh/Load/Load_Pssg_Arrays.hpp>
+#include <Mlib/Geometry/Mesh/Load/Mesh_Cache.hpp>
 #include <Mlib/Geometry/Mesh/Load/Pssg_Elements.hpp>
 #include <Mlib/Geometry/Mesh/Load/Raster_Config.hpp>
 #include <Mlib/Io/Folder_IStream_Dictionary.hpp>
@@ -46,6 +47,7 @@ DECLARE_ARGUMENT(texture);
 template <class TPosition>
 static void add_rw_resource(
     const VariableAndHash<std::string>& name,
+    const Utf8Path& container,
     const std::shared_ptr<IIStreamDictionary>& img,
     const std::shared_ptr<LoadMeshConfig<TPosition>>& cfg,
     const std::shared_ptr<DrawDistanceDb>& dddb,
@@ -57,9 +59,9 @@ static void add_rw_resource(
     if (extension == ".dff") {
         added_scene_node_resources.push_back(name);
         auto& res = RenderingContextStack::primary_scene_node_resources();
-        res.add_resource_loader(name, [img, cfg, name, &res, dddb]() {
+        res.add_resource_loader(name, [img, container, cfg, name, &res, dddb]() {
             auto istr = img->read(name, std::ios::binary, CURRENT_SOURCE_LOCATION);
-            return load_renderable_dff(*istr.stream, *name, *cfg, res, *dddb);
+            return load_renderable_dff(*istr.stream, container, *name, *cfg, res, *dddb);
             });
     } else if (extension == ".txd") {
         #ifndef WITHOUT_GRAPHICS
@@ -116,12 +118,13 @@ static void add_rw_file_resource(
     if (extension == ".img") {
         auto img = ImgReader::load_from_file(path);
         for (const auto& name : img->names()) {
-            add_rw_resource(name, img, cfg, dddb, added_scene_node_resources);
+            add_rw_resource(name, path, img, cfg, dddb, added_scene_node_resources);
         }
     } else {
         auto dir = std::make_shared<FolderIStreamDictionary>(path.parent_path().string());
         add_rw_resource(
             VariableAndHash<std::string>{path.filename().string()},
+            path,
             dir,
             cfg,
             dddb,
@@ -155,16 +158,29 @@ static void exec(
         auto& rr = RenderingContextStack::primary_rendering_resources();
         #endif
         auto& sr = RenderingContextStack::primary_scene_node_resources();
-        auto model = load_pssg(s.local_path(), IoVerbosity::SILENT);
+        auto prefix = s.local_path().filename().string() + '#';
         try {
-            auto arrays = load_pssg_arrays<TPosition, ScenePos>(
-                model,
+            auto arrays = load_pssg_arrays_cached<TPosition, ScenePos>(
+                { s.local_path() },
+                "pssg:" + prefix,
                 *cfg,
+                [&](MeshSideEffects& side_effects){
+                    auto model = load_pssg(s.local_path(), IoVerbosity::SILENT);
+                    return load_pssg_arrays<TPosition, ScenePos>(
+                        model,
+                        *cfg,
+                        #ifndef WITHOUT_GRAPHICS
+                        &side_effects,
+                        #endif
+                        prefix,
+                        IoVerbosity::SILENT);
+                },
                 #ifndef WITHOUT_GRAPHICS
-                &rr,
+                &rr
+                #else
+                nullptr
                 #endif
-                s.local_path().filename().string() + '#',
-                IoVerbosity::SILENT);
+                );
             load_renderable_pssg(arrays, filters, sr, added_scene_node_resources, added_instantiables);
         } catch (const std::runtime_error& e) {
             throw std::runtime_error("Error interpreting file \"" + s.string() + "\": " + e.what());
@@ -35,6 +35,8 @@ DECLARE_ARGUMENT(trail);
 DECLARE_ARGUMENT(trace_storage);
 DECLARE_ARGUMENT(light_before_impact);
 DECLARE_ARGUMENT(light_after_impact);
+DECLARE_ARGUMENT(lightweight);
+DECLARE_ARGUMENT(drag);
 }
 
 namespace Mlib {
@@ -73,6 +75,8 @@ static void from_json(const nlohmann::json& j, BulletProperties& item) {
     item.trace_storage = jv.at<std::string>(KnownBulletArgs::trace_storage, "");
     item.dynamic_light_configuration_before_impact = jv.at<std::string>(KnownBulletArgs::light_before_impact, "");
     item.dynamic_light_configuration_after_impact = jv.at<std::string>(KnownBulletArgs::light_after_impact, "");
+    item.lightweight = jv.at<bool>(KnownBulletArgs::lightweight, false);
+    item.drag_coefficient = jv.at<float>(KnownBulletArgs::drag, 0.f) / meters;
 }
 
 }
@@ -204,6 +204,11 @@ PhysicsScene::PhysicsScene(
             #endif
         }
         }
+    , lightweight_bullets_{
+        CollisionQuery{ physics_engine_ },
+        physics_engine_.rigid_bodies_,
+        air_particles_.smoke_particle_generator,
+        bullet_generator_.generate_bullet_explosion_audio() }
     , physics_sleeper_{
           "Physics FPS: ",
           scene_config_.physics_engine_config.dt / seconds,
@@ -235,6 +240,7 @@ PhysicsScene::PhysicsScene(
             throw std::runtime_error("Physics scene translator is null");
         }
         air_particles_.smoke_particle_generator.set_bullet_generator(bullet_generator_);
+        bullet_generator_.set_lightweight_bullets(lightweight_bullets_);
         physics_engine_.set_surface_contact_db(surface_contact_db);
         physics_engine_.set_contact_smoke_generator(contact_smoke_generator_);
         physics_engine_.set_trail_renderer(*trail_renderer_);
@@ -242,6 +248,7 @@ PhysicsScene::PhysicsScene(
         physics_engine_.add_external_force_provider(gefp_);
         physics_engine_.advance_times_.add_advance_time({ *air_particles_.particle_renderer, CURRENT_SOURCE_LOCATION }, CURRENT_SOURCE_LOCATION);
         physics_engine_.advance_times_.add_advance_time({ *skidmark_particles_.particle_renderer, CURRENT_SOURCE_LOCATION }, CURRENT_SOURCE_LOCATION);
+        physics_engine_.advance_times_.add_advance_time({ lightweight_bullets_, CURRENT_SOURCE_LOCATION }, CURRENT_SOURCE_LOCATION);
         #ifndef WITHOUT_AUDIO
         physics_engine_.advance_times_.add_advance_time({ one_shot_audio_, CURRENT_SOURCE_LOCATION }, CURRENT_SOURCE_LOCATION);
         #endif
@@ -6,6 +6,7 @@
 #include <Mlib/Memory/Event_Emitter.hpp>
 #include <Mlib/Memory/Object_Pool.hpp>
 #include <Mlib/Memory/Usage_Counter.hpp>
+#include <Mlib/Physics/Advance_Times/Lightweight_Bullets.hpp>
 #include <Mlib/Physics/Bullets/Bullet_Generator.hpp>
 #include <Mlib/Physics/Misc/Gravity_Efp.hpp>
 #include <Mlib/Physics/Physics_Engine/Physics_Engine.hpp>
@@ -146,6 +147,7 @@ public:
     SceneParticles sea_spray_particles_;
     ContactSmokeGenerator contact_smoke_generator_;
     BulletGenerator bullet_generator_;
+    LightweightBullets lightweight_bullets_;
     RealtimeSleeper physics_sleeper_;
     FifoLog fifo_log_{10 * 1000};
     SetFps physics_set_fps_;
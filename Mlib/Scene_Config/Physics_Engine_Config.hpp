@@ -6,6 +6,7 @@
 #include <Mlib/Scene_Config/Scene_Precision.hpp>
 #include <cmath>
 #include <cstddef>
+#include <cstdint>
 
 namespace Mlib {
 
@@ -43,6 +44,11 @@ struct PhysicsEngineConfig {
     FixedArray<size_t, 3> ncells = { 400u, 5u, 400u };
     CompressedScenePos dilation_radius = (CompressedScenePos)(20.f * meters); // Maximum vehicle radius
 
+    // Heightfields
+    // Concave terrain triangles within this distance of a heightfield
+    // are replaced by the heightfield.
+    ScenePos heightfield_cover_tolerance = 0.05 * meters;
+
     // Collision/Friction misc.
     float max_extra_friction = 0;
     float max_extra_w = 0;
@@ -72,6 +78,23 @@ struct PhysicsEngineConfig {
     float plane_inequality_beta = 0.02f;
     size_t nsubsteps = 8;
 
+    // Contact solver
+    // Warm starting seeds the solver with the impulses of the previous
+    // substep. It is disabled by default, because in the vehicle
+    // scenarios of "physics_benchmark" only a minority of the contacts
+    // is matched in the cache, and 10 or 20 warm-started iterations
+    // converge no better than the same number of cold iterations, so
+    // the iteration count cannot be lowered.
+    size_t ncontact_iterations = 50;
+    bool contact_warm_start = false;
+    float contact_warm_start_factor = 0.8f;
+    // Contact points are matched between substeps if they fall into
+    // the same cell of this size in the body's coordinate system.
+    float contact_cache_resolution = 5.f * cm;
+    // Maximum number of "collide" calls that a cache entry survives
+    // without being refreshed.
+    uint64_t contact_cache_max_age = 64;
+
     // Grind
     float max_grind_cos = 0.5;
     size_t nframes_straight_grind = 30;
@@ -10,6 +10,12 @@ struct SceneGraphConfig {
     float max_distance_black = 200.f * meters;
     size_t small_aggregate_update_interval = 1 * 60;
     float large_max_offset_deviation = 200.f * meters;
+    // Edge length of the cells of the large aggregates, which are
+    // rebuilt only if their contents change.
+    float large_aggregate_cell_size = 500.f * meters;
+    // Number of threads that build the aggregate and instance queues,
+    // 0 = number of hardware threads.
+    size_t queue_nthreads = 0;
     #ifndef WITHOUT_GRAPHICS
     IRenderableHider* renderable_hider = nullptr;
     #endif
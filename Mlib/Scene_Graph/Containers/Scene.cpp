@@ -7,6 +7,7 @@
 #include <Mlib/Memory/Recursive_Deletion.hpp>
 #include <Mlib/Misc/Log.hpp>
 #include <Mlib/Os/Threads/Background_Loop.hpp>
+#include <Mlib/Os/Threads/Mutex_Contention.hpp>
 #include <Mlib/Os/Threads/Throwing_Lock_Guard.hpp>
 #include <Mlib/Os/Threads/Unlock_Guard.hpp>
 #include <Mlib/Scene_Config/Scene_Graph_Config.hpp>
@@ -30,8 +31,13 @@
 #include <Mlib/Scene_Graph/Resources/Scene_Node_Resources.hpp>
 #include <Mlib/Time/Fps/Lag_Finder.hpp>
 #include <Mlib/Time/Fps/Lag_Finder.hpp>
+#include <algorithm>
+#include <exception>
+#include <functional>
+#include <memory>
 #include <mutex>
 #include <stdexcept>
+#include <thread>
 
 using namespace Mlib;
 
@@ -40,6 +46,75 @@ using NodeDanglingPtrs = ChunkedArray<std::list<std::vector<DanglingBaseClassPtr
 using NodeItemPtrs = ChunkedArray<std::list<std::vector<const RootNodes::DefaultNodeMapValueType*>>>;
 static const size_t CHUNK_SIZE = 1000;
 
+// Traverses the nodes in parallel, filling one queue per block of
+// consecutive nodes. The blocks are merged in node order, s.t. the
+// result is identical to that of a serial traversal.
+// "RootNodes::visit" emits the nodes of the static BVH depth-first,
+// so a block of consecutive nodes covers a few neighboring BVH
+// subtrees.
+// The queue entries remain "shared_ptr"s rather than raw pointers
+// with frame lifetime, because the aggregate and instance renderers
+// keep the queues until the next background update, which outlives
+// the frame, and a node may be deleted in the meantime.
+// Concurrent-access assumptions of the "append" callbacks:
+// - "SceneNode::append_*_to_queue" throw unless the node is static,
+//   so poses do not change during the traversal. The node and its
+//   instance lists are read under shared locks.
+// - The bounding sphere cache of static nodes is guarded by
+//   "SceneNode::bounding_sphere_mutex_".
+// - The renderables only read their data, except for lazily built
+//   caches, which are guarded by mutexes (e.g. the BVHs of
+//   "RenderableTriangleSampler" and the maps of "TerrainStyle").
+// - Each block writes to its own queue only.
+// The light, skidmark and blended queues are still filled serially,
+// because "SceneNode::render" fills them while issuing OpenGL calls,
+// which must stay on the rendering thread.
+template <class TQueue>
+static void append_nodes_to_queue(
+    const NodeRawPtrs& nodes,
+    TQueue& queue,
+    size_t nthreads,
+    const std::function<std::unique_ptr<TQueue>()>& create_queue,
+    const std::function<void(const SceneNode& node, TQueue& queue)>& append,
+    const std::function<void(TQueue& dst, TQueue& src)>& merge)
+{
+    auto vnodes = nodes.to_vector();
+    if (nthreads == 0) {
+        nthreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    // More blocks than threads, because the node sizes vary.
+    size_t nblocks = std::min(vnodes.size(), 4 * nthreads);
+    if ((nthreads == 1) || (nblocks <= 1)) {
+        for (const auto* node : vnodes) {
+            append(*node, queue);
+        }
+        return;
+    }
+    std::vector<std::unique_ptr<TQueue>> queues(nblocks);
+    std::vector<std::exception_ptr> exceptions(nblocks);
+    #pragma omp parallel for num_threads((int)nthreads) schedule(dynamic)
+    for (int b = 0; b < (int)nblocks; ++b) {
+        try {
+            auto& q = *(queues[(size_t)b] = create_queue());
+            size_t begin = (size_t)b * vnodes.size() / nblocks;
+            size_t end = ((size_t)b + 1) * vnodes.size() / nblocks;
+            for (size_t i = begin; i < end; ++i) {
+                append(*vnodes[i], q);
+            }
+        } catch (...) {
+            exceptions[(size_t)b] = std::current_exception();
+        }
+    }
+    for (const auto& e : exceptions) {
+        if (e != nullptr) {
+            std::rethrow_exception(e);
+        }
+    }
+    for (auto& q : queues) {
+        merge(queue, *q);
+    }
+}
+
 Scene::Scene(
     std::string name,
     SceneNodeResources* scene_node_resources,
@@ -62,7 +137,11 @@ Scene::Scene(
     , trail_renderer_{ trail_renderer }
     , dynamic_lights_{ dynamic_lights }
     , ncleanups_required_{ 0 }
-{}
+{
+    delete_node_mutex.profile("Scene::delete_node_mutex");
+    render_mutex.profile("Scene::render_mutex");
+    mutex_.profile("Scene::mutex");
+}
 
 void Scene::add_moving_root_node(
     const VariableAndHash<std::string>& name,
@@ -310,6 +389,9 @@ void Scene::delete_nodes(const Mlib::re::cregex& regex) {
 
 Scene::~Scene() {
     shutdown();
+    if (mutex_profiling_enabled()) {
+        MutexContentionRegistry::instance().print(lraw().ref());
+    }
 }
 
 void Scene::shutdown() {
@@ -630,11 +712,18 @@ void Scene::render(
                                 std::shared_lock lock{ mutex_ };
                                 root_aggregate_once_nodes_.visit(iv.t, [&nodes](const auto& node) { nodes.emplace_back(&node.get()); return true; });
                             }
-                            std::list<std::shared_ptr<ColoredVertexArray<float>>> aggregate_queue;
-                            for (const auto& node : nodes) {
-                                node->append_large_aggregates_to_queue(TransformationMatrix<float, ScenePos, 3>::identity(), iv.t, aggregate_queue, scene_graph_config);
-                            }
-                            large_aggregate_renderer->update_aggregates(iv.t, aggregate_queue, external_render_pass, task_location);
+                            using AggregateQueue = std::list<std::pair<TransformationMatrix<float, ScenePos, 3>, std::shared_ptr<ColoredVertexArray<CompressedScenePos>>>>;
+                            AggregateQueue aggregate_queue;
+                            append_nodes_to_queue<AggregateQueue>(
+                                nodes,
+                                aggregate_queue,
+                                scene_graph_config.queue_nthreads,
+                                [](){ return std::make_unique<AggregateQueue>(); },
+                                [&](const SceneNode& node, AggregateQueue& q){
+                                    node.append_large_aggregates_to_queue(TransformationMatrix<float, ScenePos, 3>::identity(), q, scene_graph_config);
+                                },
+                                [](AggregateQueue& dst, AggregateQueue& src){ dst.splice(dst.end(), src); });
+                            large_aggregate_renderer->update_aggregates(iv.t, aggregate_queue, scene_graph_config, external_render_pass, task_location);
                         });
                     };
                     if (is_foreground_task) {
@@ -684,9 +773,15 @@ void Scene::render(
                                 root_instances_once_nodes_.visit(iv.t, [&nodes](const auto& node) { nodes.emplace_back(&node.get()); return true; });
                             }
                             LargeInstancesQueue instances_queue{external_render_pass_type};
-                            for (const auto& node : nodes) {
-                                node->append_large_instances_to_queue(vp, TransformationMatrix<float, ScenePos, 3>::identity(), iv.t, PositionAndYAngleAndBillboardId{fixed_zeros<CompressedScenePos, 3>(), BILLBOARD_ID_NONE, 0.f}, instances_queue, scene_graph_config);
-                            }
+                            append_nodes_to_queue<LargeInstancesQueue>(
+                                nodes,
+                                instances_queue,
+                                scene_graph_config.queue_nthreads,
+                                [&](){ return std::make_unique<LargeInstancesQueue>(external_render_pass_type); },
+                                [&](const SceneNode& node, LargeInstancesQueue& q){
+                                    node.append_large_instances_to_queue(vp, TransformationMatrix<float, ScenePos, 3>::identity(), iv.t, PositionAndYAngleAndBillboardId{fixed_zeros<CompressedScenePos, 3>(), BILLBOARD_ID_NONE, 0.f}, q, scene_graph_config);
+                                },
+                                [](LargeInstancesQueue& dst, LargeInstancesQueue& src){ dst.extend(std::move(src)); });
                             large_instances_renderer->update_instances(iv.t, instances_queue.queue(), task_location);
                         });
                     };
@@ -740,10 +835,17 @@ void Scene::render(
                                 std::shared_lock lock{ mutex_ };
                                 root_aggregate_always_nodes_.visit(iv.t, [&nodes](const auto& node) { nodes.emplace_back(&node.get()); return true; });
                             }
-                            std::list<std::pair<float, std::shared_ptr<ColoredVertexArray<float>>>> aggregate_queue;
-                            for (const auto& node : nodes) {
-                                node->append_sorted_aggregates_to_queue(vp, TransformationMatrix<float, ScenePos, 3>::identity(), iv.t, aggregate_queue, scene_graph_config, external_render_pass);
-                            }
+                            using AggregateQueue = std::list<std::pair<float, std::shared_ptr<ColoredVertexArray<float>>>>;
+                            AggregateQueue aggregate_queue;
+                            append_nodes_to_queue<AggregateQueue>(
+                                nodes,
+                                aggregate_queue,
+                                scene_graph_config.queue_nthreads,
+                                [](){ return std::make_unique<AggregateQueue>(); },
+                                [&](const SceneNode& node, AggregateQueue& q){
+                                    node.append_sorted_aggregates_to_queue(vp, TransformationMatrix<float, ScenePos, 3>::identity(), iv.t, q, scene_graph_config, external_render_pass);
+                                },
+                                [](AggregateQueue& dst, AggregateQueue& src){ dst.splice(dst.end(), src); });
                             aggregate_queue.sort([](auto& a, auto& b){ return a.first < b.first; });
                             std::list<std::shared_ptr<ColoredVertexArray<float>>> sorted_aggregate_queue;
                             for (auto& e : aggregate_queue) {
@@ -819,9 +921,15 @@ void Scene::render(
                                 SmallInstancesQueues instances_queues{
                                     main_render_pass,
                                     black_render_passes};
-                                for (const auto& node : nodes) {
-                                    node->append_small_instances_to_queue(vp, TransformationMatrix<float, ScenePos, 3>::identity(), iv, iv.t, PositionAndYAngleAndBillboardId{fixed_zeros<CompressedScenePos, 3>(), BILLBOARD_ID_NONE, 0.f}, instances_queues, scene_graph_config);
-                                }
+                                append_nodes_to_queue<SmallInstancesQueues>(
+                                    nodes,
+                                    instances_queues,
+                                    scene_graph_config.queue_nthreads,
+                                    [&](){ return std::make_unique<SmallInstancesQueues>(main_render_pass, black_render_passes); },
+                                    [&](const SceneNode& node, SmallInstancesQueues& q){
+                                        node.append_small_instances_to_queue(vp, TransformationMatrix<float, ScenePos, 3>::identity(), iv, iv.t, PositionAndYAngleAndBillboardId{fixed_zeros<CompressedScenePos, 3>(), BILLBOARD_ID_NONE, 0.f}, q, scene_graph_config);
+                                    },
+                                    [](SmallInstancesQueues& dst, SmallInstancesQueues& src){ dst.extend(std::move(src)); });
                                 auto sorted_instances = instances_queues.sorted_instances();
                                 small_sorted_instances_renderers->get_instances_renderer(external_render_pass_type)->update_instances(
                                     iv.t,
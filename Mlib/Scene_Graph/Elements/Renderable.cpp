@@ -34,9 +34,8 @@ void Renderable::append_sorted_aggregates_to_queue(
 
 void Renderable::append_large_aggregates_to_queue(
     const TransformationMatrix<float, ScenePos, 3>& m,
-    const FixedArray<ScenePos, 3>& offset,
     const SceneGraphConfig& scene_graph_config,
-    std::list<std::shared_ptr<ColoredVertexArray<float>>>& aggregate_queue) const
+    std::list<std::pair<TransformationMatrix<float, ScenePos, 3>, std::shared_ptr<ColoredVertexArray<CompressedScenePos>>>>& aggregate_queue) const
 {}
 
 void Renderable::append_physics_to_queue(
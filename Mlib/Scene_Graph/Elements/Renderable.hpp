@@ -68,9 +68,8 @@ public:
         std::list<std::pair<float, std::shared_ptr<ColoredVertexArray<float>>>>& aggregate_queue) const;
     virtual void append_large_aggregates_to_queue(
         const TransformationMatrix<SceneDir, ScenePos, 3>& m,
-        const FixedArray<ScenePos, 3>& offset,
         const SceneGraphConfig& scene_graph_config,
-        std::list<std::shared_ptr<ColoredVertexArray<float>>>& aggregate_queue) const;
+        std::list<std::pair<TransformationMatrix<SceneDir, ScenePos, 3>, std::shared_ptr<ColoredVertexArray<CompressedScenePos>>>>& aggregate_queue) const;
     virtual void append_physics_to_queue(
         std::list<std::shared_ptr<ColoredVertexArray<float>>>& float_queue,
         std::list<std::shared_ptr<ColoredVertexArray<CompressedScenePos>>>& double_queue) const;
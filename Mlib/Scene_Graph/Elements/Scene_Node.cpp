@@ -5,7 +5,9 @@
 #include <Mlib/Geometry/Material/Render_Pass.hpp>
 #include <Mlib/Geometry/Physics_Material.hpp>
 #include <Mlib/Geometry/Primitives/Axis_Aligned_Bounding_Box.hpp>
+#include <Mlib/Geometry/Primitives/Batch_Sphere_Culling.hpp>
 #include <Mlib/Geometry/Primitives/Bounding_Sphere.hpp>
+#include <Mlib/Geometry/Primitives/Extremal_Bounding_Sphere.hpp>
 #include <Mlib/Iterator/Un_Guarded_Iterator.hpp>
 #include <Mlib/Math/Fixed_Math.hpp>
 #include <Mlib/Math/Fixed_Rodrigues.hpp>
@@ -14,6 +16,7 @@
 #include <Mlib/Math/Transformation/Tait_Bryan_Angles.hpp>
 #include <Mlib/Memory/Recursive_Deletion.hpp>
 #include <Mlib/Os/Os.hpp>
+#include <Mlib/Os/Threads/Thread_Local.hpp>
 #include <Mlib/Os/Threads/Throwing_Defer_Lock_Guard.hpp>
 #include <Mlib/Os/Threads/Unlock_Guard.hpp>
 #include <Mlib/Physics/Units.hpp>
@@ -28,6 +31,7 @@
 #include <Mlib/Scene_Graph/Elements/Dynamic_Style.hpp>
 #include <Mlib/Scene_Graph/Elements/Light.hpp>
 #include <Mlib/Scene_Graph/Elements/Renderable.hpp>
+#include <Mlib/Scene_Graph/Elements/Renderable_Filter.hpp>
 #include <Mlib/Scene_Graph/Elements/Renderable_With_Style.hpp>
 #include <Mlib/Scene_Graph/Elements/Rendering_Strategies.hpp>
 #include <Mlib/Scene_Graph/Elements/Scene_Time.hpp>
@@ -42,6 +46,7 @@
 #include <Mlib/Scene_Graph/Interfaces/Scene_Node/IRelative_Movable.hpp>
 #include <Mlib/Scene_Graph/Render_Pass.hpp>
 #include <Mlib/Scene_Graph/Resources/Scene_Node_Resources.hpp>
+#include <deque>
 #include <mutex>
 #include <stdexcept>
 
@@ -49,6 +54,53 @@ using namespace Mlib;
 
 static const auto NO_ANIMATION = VariableAndHash<std::string>{ "<no_animation>" };
 
+namespace {
+
+// Buffers of "append_small_instances_to_queue", reused across nodes and
+// frames. The function recurses into the surviving instances, so every
+// recursion level has its own buffers.
+class SmallInstancesCullingScratch {
+public:
+    struct Buffers {
+        std::vector<PositionAndYAngleAndBillboardId<CompressedScenePos>> candidates;
+        SphereArrays<ScenePos> spheres;
+        std::vector<uint32_t> survivors;
+    };
+    class Level {
+    public:
+        Level()
+            : stack_{ stack() }
+        {
+            if (stack_.depth == stack_.levels.size()) {
+                stack_.levels.emplace_back();
+            }
+            buffers_ = &stack_.levels[stack_.depth++];
+            buffers_->candidates.clear();
+            buffers_->spheres.clear();
+            buffers_->survivors.clear();
+        }
+        ~Level() {
+            --stack_.depth;
+        }
+        Buffers* operator -> () {
+            return buffers_;
+        }
+    private:
+        SmallInstancesCullingScratch& stack_;
+        Buffers* buffers_;
+    };
+private:
+    static SmallInstancesCullingScratch& stack() {
+        static THREAD_LOCAL(SmallInstancesCullingScratch) result{ SmallInstancesCullingScratch{} };
+        return result;
+    }
+    // A deque does not move the buffers of the outer levels.
+    std::deque<Buffers> levels;
+    size_t depth = 0;
+};
+
+}
+
 SceneNode::SceneNode(
     const FixedArray<ScenePos, 3>& position,
     const FixedArray<float, 3>& rotation,
@@ -81,8 +133,11 @@ SceneNode::SceneNode(
     , interpolation_mode_{ interpolation_mode }
     , domain_{ domain }
     , state_{ SceneNodeState::DETACHED }
+    , bounding_sphere_generation_{ 0 }
+    , cached_bounding_sphere_generation_{ 0 }
     , shutdown_phase_{ ShutdownPhase::NONE }
 {
+    pose_mutex_.profile("SceneNode::pose_mutex");
     switch (interpolation_mode) {
     case PoseInterpolationMode::UNDEFINED:
         throw std::runtime_error("Scene node pose interpolation mode is undefined");
@@ -399,6 +454,7 @@ void SceneNode::add_renderable(
     if (!renderables_.try_emplace(name, std::make_shared<RenderableWithStyle>(renderable)).second) {
         throw std::runtime_error("Renderable with name " + *name + " already exists");
     }
+    invalidate_bounding_sphere();
 }
 
 void SceneNode::set_particle_renderer(
@@ -441,6 +497,7 @@ void SceneNode::clear_renderable_instance(const VariableAndHash<std::string>& na
         particle_renderer_ = nullptr;
     }
     renderables_.erase(it);
+    invalidate_bounding_sphere();
 }
 
 void SceneNode::clear_absolute_observer() {
@@ -501,6 +558,7 @@ void SceneNode::clear_unsafe() {
             }
         }
         renderables_.clear();
+        invalidate_bounding_sphere();
         auto add_child_to_trash = [this](const auto& child){
             if (child.mapped().scene_node->shutdown_phase() == ShutdownPhase::IN_PROGRESS) {
                 verbose_abort("Child node \"" + *child.key() + "\" already shutting down");
@@ -551,6 +609,7 @@ void SceneNode::add_child(
         throw std::runtime_error("Child node with name " + *name + " already exists");
     }
     setup_child_unsafe(name, nref, global_name, child_parent_state);
+    invalidate_bounding_sphere();
 }
 
 DanglingBaseClassRef<SceneNode> SceneNode::get_child(const VariableAndHash<std::string>& name) {
@@ -579,6 +638,7 @@ void SceneNode::remove_local_child(const VariableAndHash<std::string>& name) {
         verbose_abort("Child node \"" + *name + "\" shutting down (2)");
     }
     it->scene_node->shutdown();
+    invalidate_bounding_sphere();
     if (it->global_name.has_value()) {
         if (scene_ == nullptr) {
             verbose_abort("Can not deregister child \"" + *name + "\" because scene is not set");
@@ -1280,8 +1340,7 @@ void SceneNode::append_sorted_aggregates_to_queue(
 
 void SceneNode::append_large_aggregates_to_queue(
     const TransformationMatrix<float, ScenePos, 3>& parent_m,
-    const FixedArray<ScenePos, 3>& offset,
-    std::list<std::shared_ptr<ColoredVertexArray<float>>>& aggregate_queue,
+    std::list<std::pair<TransformationMatrix<float, ScenePos, 3>, std::shared_ptr<ColoredVertexArray<CompressedScenePos>>>>& aggregate_queue,
     const SceneGraphConfig& scene_graph_config) const
 {
     TransformationMatrix<float, ScenePos, 3> m = parent_m * relative_model_matrix();
@@ -1290,13 +1349,13 @@ void SceneNode::append_large_aggregates_to_queue(
         throw std::runtime_error("Cannot append large aggregates to queue for a non-static node");
     }
     for (const auto& [_, r] : un_guarded_iterator(renderables_, lock)) {
-        (*r)->append_large_aggregates_to_queue(m, offset, scene_graph_config, aggregate_queue);
+        (*r)->append_large_aggregates_to_queue(m, scene_graph_config, aggregate_queue);
     }
     for (const auto& [_, c] : un_guarded_iterator(children_, lock)) {
-        c.scene_node->append_large_aggregates_to_queue(m, offset, aggregate_queue, scene_graph_config);
+        c.scene_node->append_large_aggregates_to_queue(m, aggregate_queue, scene_graph_config);
     }
     for (const auto& [_, a] : un_guarded_iterator(aggregate_children_, lock)) {
-        a.scene_node->append_large_aggregates_to_queue(m, offset, aggregate_queue, scene_graph_config);
+        a.scene_node->append_large_aggregates_to_queue(m, aggregate_queue, scene_graph_config);
     }
 }
 
@@ -1335,18 +1394,46 @@ void SceneNode::append_small_instances_to_queue(
         }
         if (!i.small_instances.empty()) {
             auto camera_position = m.inverted_scaled().transform(iv.t);
+            // The instances are culled in batches, using conservative
+            // bounding spheres that are invariant to the y-rotation.
+            // The exact per-material checks happen in the queues.
+            auto rel_i = i.scene_node->relative_model_matrix();
+            auto culling_radius = (ScenePos)INFINITY;
+            if (auto bs = i.scene_node->relative_bounding_sphere(RenderableFilter::ALL); !bs.full() && !bs.empty()) {
+                culling_radius = (ScenePos)rel_i.get_scale() * (
+                    std::sqrt(sum(squared(bs.data().center.casted<ScenePos>()))) +
+                    (ScenePos)bs.data().radius);
+            }
+            SmallInstancesCullingScratch::Level scratch;
+            auto& candidates = scratch->candidates;
+            auto& spheres = scratch->spheres;
+            auto& survivors = scratch->survivors;
+            auto add_candidate = [&](const PositionAndYAngleAndBillboardId<CompressedScenePos>& j) {
+                candidates.push_back(j);
+                spheres.push_back(
+                    rel_i.t + j.position.casted<ScenePos>(),
+                    // Billboards are scaled by their atlas instance.
+                    (j.billboard_id == BILLBOARD_ID_NONE) ? culling_radius : (ScenePos)INFINITY);
+            };
             i.small_instances.visit(
                 AxisAlignedBoundingBox<CompressedScenePos, 3>::from_center_and_radius(camera_position.casted<CompressedScenePos>(), i.max_center_distance),
-                [&, &i = i](const PositionAndYAngleAndBillboardId<CompressedScenePos>& j) {
-                    UnlockGuard ulock{ ilock };
-                    i.scene_node->append_small_instances_to_queue(mvp, m, iv, offset, j, instances_queues, scene_graph_config);
+                [&](const PositionAndYAngleAndBillboardId<CompressedScenePos>& j) {
+                    add_candidate(j);
                     return true;
                 },
-                [&, &i = i](const PositionAndBillboardId<CompressedScenePos>& j) {
-                    UnlockGuard ulock{ ilock };
-                    i.scene_node->append_small_instances_to_queue(mvp, m, iv, offset, {j.position, j.billboard_id, 0.f}, instances_queues, scene_graph_config);
+                [&](const PositionAndBillboardId<CompressedScenePos>& j) {
+                    add_candidate({j.position, j.billboard_id, 0.f});
                     return true;
                 });
+            BatchSphereCulling<ScenePos>{ mvp }.cull(
+                spheres,
+                0.,
+                squared((ScenePos)(i.max_center_distance + CompressedScenePos::from_count(1))),
+                survivors);
+            UnlockGuard ulock{ ilock };
+            for (auto s : survivors) {
+                i.scene_node->append_small_instances_to_queue(mvp, m, iv, offset, candidates[s], instances_queues, scene_graph_config);
+            }
         }
     }
 }
@@ -1715,7 +1802,41 @@ ExtremalAxisAlignedBoundingBox<CompressedScenePos, 3> SceneNode::relative_aabb()
     return result;
 }
 
+void SceneNode::invalidate_bounding_sphere() const {
+    for (const SceneNode* node = this; node != nullptr;) {
+        ++node->bounding_sphere_generation_;
+        std::shared_lock lock{ node->parent_mutex_ };
+        node = node->parent_.get();
+    }
+}
+
 ExtremalBoundingSphere<CompressedScenePos, 3> SceneNode::relative_bounding_sphere(RenderableFilter filter) const {
+    // Only static nodes cache their sphere. Their subtrees are static,
+    // too, s.t. pose updates never have to invalidate a cache.
+    if ((filter != RenderableFilter::ALL) || (state_ != SceneNodeState::STATIC)) {
+        return compute_relative_bounding_sphere(filter);
+    }
+    // The generation is read first, s.t. an invalidation during the
+    // computation leaves the cache outdated.
+    auto generation = bounding_sphere_generation_.load();
+    {
+        std::scoped_lock lock{ bounding_sphere_mutex_ };
+        if ((cached_bounding_sphere_ != nullptr) && (cached_bounding_sphere_generation_ == generation)) {
+            return *cached_bounding_sphere_;
+        }
+    }
+    auto result = compute_relative_bounding_sphere(filter);
+    std::scoped_lock lock{ bounding_sphere_mutex_ };
+    if (cached_bounding_sphere_ == nullptr) {
+        cached_bounding_sphere_ = std::make_unique<ExtremalBoundingSphere<CompressedScenePos, 3>>(result);
+    } else {
+        *cached_bounding_sphere_ = result;
+    }
+    cached_bounding_sphere_generation_ = generation;
+    return result;
+}
+
+ExtremalBoundingSphere<CompressedScenePos, 3> SceneNode::compute_relative_bounding_sphere(RenderableFilter filter) const {
     std::shared_lock lock{ mutex_ };
     ExtremalBoundingSphere<CompressedScenePos, 3> result = ExtremalBoundingVolume::EMPTY;
     for (const auto& [_, r] : renderables_) {
@@ -11,6 +11,7 @@
 #include <Mlib/Memory/Memory.hpp>
 #include <Mlib/Memory/Shared_Ptrs.hpp>
 #include <Mlib/Misc/Object.hpp>
+#include <Mlib/Os/Threads/Fast_Mutex.hpp>
 #include <Mlib/Os/Threads/Recursive_Shared_Mutex.hpp>
 #include <Mlib/Scene_Config/Scene_Precision.hpp>
 #include <Mlib/Scene_Graph/Elements/Color_Style.hpp>
@@ -274,8 +275,7 @@ public:
         const ExternalRenderPass& external_render_pass) const;
     void append_large_aggregates_to_queue(
         const TransformationMatrix<float, ScenePos, 3>& parent_m,
-        const FixedArray<ScenePos, 3>& offset,
-        std::list<std::shared_ptr<ColoredVertexArray<float>>>& aggregate_queue,
+        std::list<std::pair<TransformationMatrix<float, ScenePos, 3>, std::shared_ptr<ColoredVertexArray<CompressedScenePos>>>>& aggregate_queue,
         const SceneGraphConfig& scene_graph_config) const;
     void append_small_instances_to_queue(
         const FixedArray<ScenePos, 4, 4>& parent_mvp,
@@ -380,6 +380,10 @@ private:
         const std::optional<VariableAndHash<std::string>>& global_name,
         ChildParentState child_parent_state);
     void clear_unsafe();
+    ExtremalBoundingSphere<CompressedScenePos, 3> compute_relative_bounding_sphere(RenderableFilter filter) const;
+    // Invalidates the cached bounding sphere of this node and its ancestors.
+    // Called when renderables or children change, not on pose updates.
+    void invalidate_bounding_sphere() const;
     ViewableRemoteObject remote_viewable_;
     DanglingBaseClassPtr<Scene> scene_;
     DanglingBaseClassPtr<SceneNode> parent_;
@@ -416,6 +420,12 @@ private:
     mutable SafeAtomicRecursiveSharedMutex mutex_;
     mutable SafeAtomicRecursiveSharedMutex pose_mutex_;
     mutable SafeAtomicRecursiveSharedMutex parent_mutex_;
+    // Cache of "relative_bounding_sphere(RenderableFilter::ALL)" of static
+    // nodes, valid if it was computed for the current generation.
+    mutable std::atomic_uint64_t bounding_sphere_generation_;
+    mutable uint64_t cached_bounding_sphere_generation_;
+    mutable std::unique_ptr<ExtremalBoundingSphere<CompressedScenePos, 3>> cached_bounding_sphere_;
+    mutable FastMutex bounding_sphere_mutex_;
     ShutdownPhase shutdown_phase_;
     std::string debug_message_;
 };
@@ -1,41 +1,48 @@
 #include "Fifo_Log.hpp"
-#include <Mlib/Os/Os.hpp>
 #include <mutex>
 #include <ostream>
 
 using namespace Mlib;
 
 FifoLog::FifoLog(size_t max_log_size)
-    : max_log_size_{max_log_size}
+    : entries_(max_log_size)
+    , begin_{0}
+    , size_{0}
 {}
 
 void FifoLog::log(const std::string& message, LogEntrySeverity severity) {
-    if (max_log_size_ == 0) {
+    if (entries_.empty()) {
         return;
     }
     std::scoped_lock lock{ mutex_ };
-    if (entries_.size() > max_log_size_) {
-        verbose_abort("Log race condition");
+    auto& entry = entries_[(begin_ + size_) % entries_.size()];
+    entry.first = severity;
+    entry.second.assign(message);
+    if (size_ == entries_.size()) {
+        begin_ = (begin_ + 1) % entries_.size();
+    } else {
+        ++size_;
     }
-    if (entries_.size() == max_log_size_) {
-        entries_.pop_front();
-    }
-    entries_.push_back({severity, message});
 }
 
 void FifoLog::get_messages(std::ostream& ostr, size_t nentries, LogEntrySeverity severity) const
 {
     std::scoped_lock lock{ mutex_ };
-    auto it = entries_.end();
-    for (size_t i = 0; (i < entries_.size()) && (nentries > 0); ++i) {
-        if (it->first >= severity) {
+    auto entry = [this](size_t i) -> const auto& {
+        return entries_[(begin_ + i) % entries_.size()];
+    };
+    // Find the oldest of the last "nentries" matching entries.
+    size_t first = size_;
+    while ((first > 0) && (nentries > 0)) {
+        --first;
+        if (entry(first).first >= severity) {
             --nentries;
         }
-        --it;
     }
-    for (; it != entries_.end(); ++it) {
-        if (it->first >= severity) {
-            ostr << it->second << std::endl;
+    for (size_t i = first; i < size_; ++i) {
+        const auto& e = entry(i);
+        if (e.first >= severity) {
+            ostr << e.second << std::endl;
         }
     }
 }
@@ -1,18 +1,22 @@
 #pragma once
 #include <Mlib/Os/Threads/Fast_Mutex.hpp>
 #include <Mlib/Scene_Graph/Base_Log.hpp>
-#include <list>
+#include <vector>
 
 namespace Mlib {
 
+// Ring buffer of the last "max_log_size" messages. The slots are
+// reused, s.t. logging does not allocate once the strings reached
+// their final capacity.
 class FifoLog: public BaseLog {
 public:
     explicit FifoLog(size_t max_log_size);
     virtual void log(const std::string& message, LogEntrySeverity severity) override;
     virtual void get_messages(std::ostream& ostr, size_t nentries, LogEntrySeverity severity) const override;
 private:
-    std::list<std::pair<LogEntrySeverity, std::string>> entries_;
-    size_t max_log_size_;
+    std::vector<std::pair<LogEntrySeverity, std::string>> entries_;
+    size_t begin_;
+    size_t size_;
     mutable FastMutex mutex_;
 };
 
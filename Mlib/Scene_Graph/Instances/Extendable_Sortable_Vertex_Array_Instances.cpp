@@ -36,6 +36,12 @@ void ExtendableSortableVertexArrayInstances::insert(
     throw std::runtime_error("Unexpected instance location type");
 }
 
+void ExtendableSortableVertexArrayInstances::extend(ExtendableSortableVertexArrayInstances&& other) {
+    transformed.extend(std::move(other.transformed));
+    yangle.extend(std::move(other.yangle));
+    lookat.extend(std::move(other.lookat));
+}
+
 SortedVertexArrayInstances ExtendableSortableVertexArrayInstances::sorted() const {
     SortedVertexArrayInstances result;
     const auto compare = [](const auto& a, const auto& b){ return a.distance < b.distance; };
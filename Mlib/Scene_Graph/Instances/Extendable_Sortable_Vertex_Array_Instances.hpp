@@ -33,6 +33,7 @@ struct ExtendableSortableVertexArrayInstances {
     ExtendableSortableYAngleInstances yangle{1000};
     ExtendableSortableLookatInstances lookat{1000};
     void insert(const InstanceLocation& i, float distance, BillboardId billboard_id);
+    void extend(ExtendableSortableVertexArrayInstances&& other);
     SortedVertexArrayInstances sorted() const;
 };
 
@@ -31,6 +31,12 @@ void ExtendableVertexArrayInstances::insert(
     throw std::runtime_error("Unexpected instance location type");
 }
 
+void ExtendableVertexArrayInstances::extend(ExtendableVertexArrayInstances&& other) {
+    transformed.extend(std::move(other.transformed));
+    yangle.extend(std::move(other.yangle));
+    lookat.extend(std::move(other.lookat));
+}
+
 SortedVertexArrayInstances ExtendableVertexArrayInstances::vectorized() const {
     return SortedVertexArrayInstances{
         .transformed = transformed.to_vector(),
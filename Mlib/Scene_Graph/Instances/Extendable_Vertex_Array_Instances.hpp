@@ -27,6 +27,7 @@ struct ExtendableVertexArrayInstances {
     ExtendableYAngleInstances yangle{1000};
     ExtendableLookatInstances lookat{1000};
     void insert(const InstanceLocation& i, BillboardId billboard_id);
+    void extend(ExtendableVertexArrayInstances&& other);
     SortedVertexArrayInstances vectorized() const;
 };
 
@@ -70,6 +70,15 @@ void LargeInstancesQueue::insert(
     }
 }
 
+void LargeInstancesQueue::extend(LargeInstancesQueue&& other) {
+    if (other.render_pass_ != render_pass_) {
+        throw std::runtime_error("LargeInstancesQueue::extend: render passes differ");
+    }
+    for (auto& [scva, instances] : other.queue_) {
+        queue_[scva].extend(std::move(instances));
+    }
+}
+
 VertexDatasAndSortedInstances LargeInstancesQueue::queue() const {
     VertexDatasAndSortedInstances result;
     for (const auto& [a, instances] : queue_) {
@@ -37,6 +37,9 @@ public:
         BillboardId billboard_id,
         const SceneGraphConfig& scene_graph_config,
         InvisibilityHandling invisibility_handling);
+    // Appends the instances of "other", which must have been
+    // created with the same render pass.
+    void extend(LargeInstancesQueue&& other);
     VertexDatasAndSortedInstances queue() const;
     ExternalRenderPassType render_pass() const;
 private:
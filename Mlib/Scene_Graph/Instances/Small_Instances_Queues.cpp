@@ -12,6 +12,7 @@
 #include <Mlib/Scene_Graph/Render/IGpu_Vertex_Data.hpp>
 #include <Mlib/Scene_Graph/Render/Sortable_Deferred_Gpu_Vertex_Data.hpp>
 #include <Mlib/Testing/Assert.hpp>
+#include <stdexcept>
 
 using namespace Mlib;
 
@@ -69,6 +70,26 @@ void SmallInstancesQueues::insert(
     }
 }
 
+void SmallInstancesQueues::extend(SmallInstancesQueues&& other) {
+    if ((other.main_render_pass_ != main_render_pass_) ||
+        (other.black_queues_.size() != black_queues_.size()))
+    {
+        throw std::runtime_error("SmallInstancesQueues::extend: render passes differ");
+    }
+    for (auto& [scva, instances] : other.invisible_queue_) {
+        invisible_queue_[scva].extend(std::move(instances));
+    }
+    for (auto& [key, instances] : other.standard_queue_) {
+        standard_queue_[key].extend(std::move(instances));
+    }
+    for (auto& [rp, other_instances] : other.black_queues_) {
+        auto& instances = black_queues_.at(rp);
+        for (auto& [scva, i] : other_instances) {
+            instances[scva].extend(std::move(i));
+        }
+    }
+}
+
 std::map<ExternalRenderPassType, VertexDatasAndSortedInstances> SmallInstancesQueues::sorted_instances() const
 {
     std::map<ExternalRenderPassType, VertexDatasAndSortedInstances> results;
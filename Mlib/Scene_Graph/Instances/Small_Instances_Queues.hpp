@@ -33,6 +33,9 @@ public:
         const FixedArray<ScenePos, 3>& offset,
         BillboardId billboard_id,
         const SceneGraphConfig& scene_graph_config);
+    // Appends the instances of "other", which must have been
+    // created with the same render passes.
+    void extend(SmallInstancesQueues&& other);
     std::map<ExternalRenderPassType, VertexDatasAndSortedInstances> sorted_instances() const;
 private:
     ExternalRenderPassType main_render_pass_;
@@ -8,6 +8,8 @@ namespace Mlib {
 
 template <typename TData, size_t... tshape>
 class FixedArray;
+template <class TPos, size_t tndim>
+class BoundingSphere;
 
 class IDynamicLight: public DanglingBaseClass {
 public:
@@ -16,6 +18,8 @@ public:
     virtual void set_time(std::chrono::steady_clock::time_point time) = 0;
     virtual FixedArray<float, 3> get_color(const FixedArray<ScenePos, 3>& target_position) const = 0;
     virtual bool animation_completed(std::chrono::steady_clock::time_point time) const = 0;
+    // Sphere outside of which "get_color" returns zero, valid after "set_time".
+    virtual BoundingSphere<ScenePos, 3> bounding_sphere() const = 0;
 };
 
 }
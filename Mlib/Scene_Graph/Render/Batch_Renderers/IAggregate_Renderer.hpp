@@ -56,6 +56,14 @@ public:
         const std::list<std::shared_ptr<ColoredVertexArray<float>>>& aggregate_queue,
         const ExternalRenderPass& external_render_pass,
         TaskLocation task_location) = 0;
+    // Same as above, for static arrays given by their model matrices.
+    // The offset is the camera position for the distance culling.
+    virtual void update_aggregates(
+        const FixedArray<ScenePos, 3>& offset,
+        const std::list<std::pair<TransformationMatrix<float, ScenePos, 3>, std::shared_ptr<ColoredVertexArray<CompressedScenePos>>>>& aggregate_queue,
+        const SceneGraphConfig& scene_graph_config,
+        const ExternalRenderPass& external_render_pass,
+        TaskLocation task_location) = 0;
     virtual void render_aggregates(
         const FixedArray<ScenePos, 4, 4>& vp,
         const TransformationMatrix<float, ScenePos, 3>& iv,
@@ -22,6 +22,7 @@
 #include <Mlib/Scene_Graph/Resources/Sampler/Triangle_Sampler/Terrain_Styles.hpp>
 #include <Mlib/Scene_Graph/Resources/Sampler/Triangle_Sampler/Terrain_Type.hpp>
 #include <Mlib/Scene_Graph/Resources/Scene_Node_Resources.hpp>
+#include <mutex>
 #include <stdexcept>
 
 using namespace Mlib;
@@ -167,44 +168,57 @@ void RenderableTriangleSampler::append_sorted_instances_to_queue(
             it->second.insert(aabb, TriangleAndSeed{.triangle = t, .seed = seed});
         }
     };
-    if (!grass_bvhs_.has_value()) {
-        grass_bvhs_.emplace();
-        if (const auto& style = terrain_styles_.near_grass_terrain_style; style.is_visible()) {
-            if (auto tris = terrain_triangles_.grass; tris != nullptr) {
-                add_triangles(*grass_bvhs_, style, *tris);
+    // The scene traverses the static root nodes in parallel, so the
+    // BVHs are built under a lock and are read-only afterwards.
+    {
+        std::scoped_lock lock{ bvhs_mutex_ };
+        if (!grass_bvhs_.has_value()) {
+            grass_bvhs_.emplace();
+            if (const auto& style = terrain_styles_.near_grass_terrain_style; style.is_visible()) {
+                if (auto tris = terrain_triangles_.grass; tris != nullptr) {
+                    add_triangles(*grass_bvhs_, style, *tris);
+                }
+                if (auto tris = terrain_triangles_.elevated_grass; tris != nullptr) {
+                    add_triangles(*grass_bvhs_, style, *tris);
+                }
             }
-            if (auto tris = terrain_triangles_.elevated_grass; tris != nullptr) {
-                add_triangles(*grass_bvhs_, style, *tris);
+            if (const auto& style = terrain_styles_.near_wayside1_grass_terrain_style; style.is_visible()) {
+                if (auto tris = terrain_triangles_.wayside1_grass; tris != nullptr) {
+                    add_triangles(*grass_bvhs_, style, *tris);
+                }
             }
-        }
-        if (const auto& style = terrain_styles_.near_wayside1_grass_terrain_style; style.is_visible()) {
-            if (auto tris = terrain_triangles_.wayside1_grass; tris != nullptr) {
-                add_triangles(*grass_bvhs_, style, *tris);
+            if (const auto& style = terrain_styles_.near_wayside2_grass_terrain_style; style.is_visible()) {
+                if (auto tris = terrain_triangles_.wayside2_grass; tris != nullptr) {
+                    add_triangles(*grass_bvhs_, style, *tris);
+                }
             }
-        }
-        if (const auto& style = terrain_styles_.near_wayside2_grass_terrain_style; style.is_visible()) {
-            if (auto tris = terrain_triangles_.wayside2_grass; tris != nullptr) {
-                add_triangles(*grass_bvhs_, style, *tris);
+            if (const auto& style = terrain_styles_.near_flowers_terrain_style; style.is_visible()) {
+                if (auto tris = terrain_triangles_.flowers; tris != nullptr) {
+                    add_triangles(*grass_bvhs_, style, *tris);
+                }
             }
-        }
-        if (const auto& style = terrain_styles_.near_flowers_terrain_style; style.is_visible()) {
-            if (auto tris = terrain_triangles_.flowers; tris != nullptr) {
-                add_triangles(*grass_bvhs_, style, *tris);
+            if (const auto& style = terrain_styles_.near_trees_terrain_style; style.is_visible()) {
+                if (auto tris = terrain_triangles_.trees; tris != nullptr) {
+                    add_triangles(*grass_bvhs_, style, *tris);
+                }
             }
-        }
-        if (const auto& style = terrain_styles_.near_trees_terrain_style; style.is_visible()) {
-            if (auto tris = terrain_triangles_.trees; tris != nullptr) {
-                add_triangles(*grass_bvhs_, style, *tris);
+            if (const auto& style = terrain_styles_.street_mud_terrain_style; style.is_visible()) {
+                if (auto tris = terrain_triangles_.street_mud_grass; tris != nullptr) {
+                    add_triangles(*grass_bvhs_, style, *tris);
+                }
             }
-        }
-        if (const auto& style = terrain_styles_.street_mud_terrain_style; style.is_visible()) {
-            if (auto tris = terrain_triangles_.street_mud_grass; tris != nullptr) {
-                add_triangles(*grass_bvhs_, style, *tris);
+            if (const auto& style = terrain_styles_.path_mud_terrain_style; style.is_visible()) {
+                if (auto tris = terrain_triangles_.path_mud_grass; tris != nullptr) {
+                    add_triangles(*grass_bvhs_, style, *tris);
+                }
             }
         }
-        if (const auto& style = terrain_styles_.path_mud_terrain_style; style.is_visible()) {
-            if (auto tris = terrain_triangles_.path_mud_grass; tris != nullptr) {
-                add_triangles(*grass_bvhs_, style, *tris);
+        if (!no_grass_bvhs_.has_value()) {
+            no_grass_bvhs_.emplace();
+            if (terrain_styles_.no_grass_decals_terrain_style.is_visible()) {
+                for (const auto& lst : no_grass_) {
+                    add_triangles(*no_grass_bvhs_, terrain_styles_.no_grass_decals_terrain_style, *lst);
+                }
             }
         }
     }
@@ -214,14 +228,6 @@ void RenderableTriangleSampler::append_sorted_instances_to_queue(
             *style,
             street_bvh_);
     }
-    if (!no_grass_bvhs_.has_value()) {
-        no_grass_bvhs_.emplace();
-        if (terrain_styles_.no_grass_decals_terrain_style.is_visible()) {
-            for (const auto& lst : no_grass_) {
-                add_triangles(*no_grass_bvhs_, terrain_styles_.no_grass_decals_terrain_style, *lst);
-            }
-        }
-    }
     for (const auto& [style, bvh] : no_grass_bvhs_.value()) {
         sample_triangles(
             bvh,
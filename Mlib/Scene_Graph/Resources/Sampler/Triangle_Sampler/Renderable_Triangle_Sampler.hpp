@@ -1,6 +1,7 @@
 #pragma once
 #include <Mlib/Array/Fixed_Array.hpp>
 #include <Mlib/Geometry/Primitives/Bvh_Fwd.hpp>
+#include <Mlib/Os/Threads/Fast_Mutex.hpp>
 #include <Mlib/Scene_Graph/Elements/Renderable.hpp>
 #include <Mlib/Scene_Graph/Resources/Sampler/Triangle_Sampler/Terrain_Triangles.hpp>
 #include <list>
@@ -58,6 +59,7 @@ private:
     const Bvh<CompressedScenePos, 3, FixedArray<CompressedScenePos, 3, 3>>* street_bvh_;
     ScenePos scale_;
     UpAxis up_axis_;
+    mutable FastMutex bvhs_mutex_;
     mutable std::optional<std::map<const TerrainStyle*, Bvh<CompressedScenePos, 3, TriangleAndSeed>>> grass_bvhs_;
     mutable std::optional<std::map<const TerrainStyle*, Bvh<CompressedScenePos, 3, TriangleAndSeed>>> no_grass_bvhs_;
 };
@@ -60,7 +60,7 @@ void SceneNodeResources::write_loaded_resources(const Utf8Path& filename) const
         throw std::runtime_error("Could not open file for write: \"" + filename.string() + '"');
     }
     std::list<std::string> descriptors;
-    for (const auto& [name, _] : resources_) {
+    for (const auto& name : resources_.keys()) {
         descriptors.push_back(*name);
     }
     descriptors.sort();
@@ -649,7 +649,7 @@ std::shared_ptr<ISceneNodeResource> SceneNodeResources::get_resource(
     if (!iit.second) {
         verbose_abort("Could not insert loaded resource with name \"" + *name + '"');
     }
-    return iit.first->second;
+    return *iit.first;
 }
 
 void SceneNodeResources::add_modifier(
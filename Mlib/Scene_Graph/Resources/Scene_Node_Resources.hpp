@@ -1,6 +1,6 @@
 #pragma once
+#include <Mlib/Map/Rcu_String_With_Hash_Unordered_Map.hpp>
 #include <Mlib/Map/String_With_Hash_Unordered_Map.hpp>
-#include <Mlib/Map/Threadsafe_String_With_Hash_Unordered_Map.hpp>
 #include <Mlib/Map/Verbose_Unordered_Map.hpp>
 #include <Mlib/Os/Threads/Recursive_Shared_Mutex.hpp>
 #include <Mlib/Os/Threads/Safe_Atomic_Shared_Mutex.hpp>
@@ -208,11 +208,11 @@ private:
         const VariableAndHash<std::string>& name,
         ResourceDoesNotExistBehavior not_exists_behavior = ResourceDoesNotExistBehavior::THROW) const;
     mutable std::unordered_set<VariableAndHash<std::string>> preloaded_or_warned_resources_;
-    mutable ThreadsafeStringWithHashUnorderedMap<std::shared_ptr<ISceneNodeResource>> resources_;
-    ThreadsafeStringWithHashUnorderedMap<InstanceInformation<ScenePos>> instantiables_;
-    ThreadsafeStringWithHashUnorderedMap<TransformationMatrix<double, double, 3>> geographic_mappings_;
-    ThreadsafeStringWithHashUnorderedMap<FixedScaledUnitVector<float, 3>> wind_;
-    ThreadsafeStringWithHashUnorderedMap<FixedScaledUnitVector<float, 3>> gravity_;
+    mutable RcuStringWithHashUnorderedMap<std::shared_ptr<ISceneNodeResource>> resources_;
+    RcuStringWithHashUnorderedMap<InstanceInformation<ScenePos>> instantiables_;
+    RcuStringWithHashUnorderedMap<TransformationMatrix<double, double, 3>> geographic_mappings_;
+    RcuStringWithHashUnorderedMap<FixedScaledUnitVector<float, 3>> wind_;
+    RcuStringWithHashUnorderedMap<FixedScaledUnitVector<float, 3>> gravity_;
     StringWithHashUnorderedMap<std::list<std::pair<VariableAndHash<std::string>, RenderableResourceFilter>>> companions_;
     StringWithHashUnorderedMap<std::function<std::shared_ptr<ISceneNodeResource>()>> resource_loaders_;
     mutable StringWithHashUnorderedMap<std::list<std::function<void(ISceneNodeResource&)>>> modifiers_;
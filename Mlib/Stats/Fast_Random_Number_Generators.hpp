@@ -1,6 +1,7 @@
 #pragma once
 #include <Mlib/Math/Float_Type.hpp>
 #include <Mlib/Memory/Integral_Cast.hpp>
+#include <cstdint>
 #include <random>
 #include <tuple>
 
@@ -116,4 +117,26 @@ private:
     std::gamma_distribution<typename FloatType<TData>::value_type> d_;
 };
 
+// SplitMix64 (Steele, Lea and Flood, 2014). Unlike "std::minstd_rand",
+// the streams of consecutive seeds are uncorrelated, and the output
+// does not depend on the compiler.
+class SplitMix64 {
+public:
+    explicit SplitMix64(uint64_t seed)
+        : state_{ seed }
+    {}
+    uint64_t operator () () {
+        uint64_t z = (state_ += 0x9e3779b97f4a7c15ull);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return z ^ (z >> 31);
+    }
+    // Uniformly distributed integer in [0, n).
+    uint64_t uniform(uint64_t n) {
+        return (uint64_t)((double)((*this)() >> 11) * 0x1.0p-53 * (double)n);
+    }
+private:
+    uint64_t state_;
+};
+
 }
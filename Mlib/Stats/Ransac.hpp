@@ -1,18 +1,141 @@
 #pragma once
 #include <Mlib/Math/Math.hpp>
+#include <Mlib/Stats/Fast_Random_Number_Generators.hpp>
 #include <Mlib/Stats/Mean.hpp>
 #include <Mlib/Stats/RansacOptions.hpp>
 #include <Mlib/Stats/Sort.hpp>
 #include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <exception>
 #include <limits>
+#include <optional>
 #include <random>
+#include <span>
 #include <stdexcept>
+#include <type_traits>
+#include <vector>
 
 namespace Mlib {
 
+// Draws the samples of the RANSAC iterations. The sampling pool is
+// computed sequentially, and every iteration seeds its own random number
+// generator, s.t. the samples of a batch can be drawn in parallel, and
+// the result does not depend on the number of threads.
+class RansacSampler {
+public:
+    struct Pool {
+        // The sample is drawn from the first "n" elements.
+        size_t n;
+        // PROSAC: Element "n - 1" is always part of the sample.
+        bool include_last;
+    };
+    RansacSampler(
+        size_t nelems_large,
+        size_t nelems_small,
+        RansacSampling sampling,
+        size_t max_ncalls)
+        : N_{ nelems_large }
+        , m_{ std::min(nelems_small, nelems_large) }
+        , sampling_{ sampling }
+        , n_{ m_ }
+        , t_{ 0 }
+        , Tn_{ (double)max_ncalls }
+        , Tn_prime_{ 1 }
+    {
+        for (size_t i = 0; i < m_; ++i) {
+            Tn_ *= double(m_ - i) / double(N_ - i);
+        }
+    }
+    Pool next_pool() {
+        ++t_;
+        if (sampling_ == RansacSampling::UNIFORM) {
+            return { N_, false };
+        }
+        // Growth function of the PROSAC paper.
+        while ((t_ == Tn_prime_) && (n_ < N_)) {
+            double Tn_next = Tn_ * double(n_ + 1) / double(n_ + 1 - m_);
+            Tn_prime_ += (size_t)std::ceil(Tn_next - Tn_);
+            Tn_ = Tn_next;
+            ++n_;
+        }
+        return { n_, Tn_prime_ >= t_ };
+    }
+    // Draws "sample.size()" distinct elements in ascending order.
+    static void draw(
+        const Pool& pool,
+        unsigned int seed,
+        size_t iteration,
+        std::span<size_t> sample)
+    {
+        // The first output hashes the seed and the iteration,
+        // s.t. the streams of the iterations do not overlap.
+        SplitMix64 e{ SplitMix64{ ((uint64_t)seed << 32) ^ (uint64_t)iteration }() };
+        size_t k = sample.size();
+        size_t n = pool.n;
+        if (pool.include_last && (k > 0)) {
+            --k;
+            --n;
+            sample[k] = n;
+        }
+        // Robert Floyd's algorithm, which avoids shuffling all elements.
+        for (size_t i = 0, j = n - k; j < n; ++i, ++j) {
+            auto r = (size_t)e.uniform(j + 1);
+            auto end = sample.begin() + (std::ptrdiff_t)i;
+            sample[i] = (std::find(sample.begin(), end, r) == end) ? r : j;
+        }
+        std::sort(sample.begin(), sample.end());
+    }
+private:
+    size_t N_;
+    size_t m_;
+    RansacSampling sampling_;
+    size_t n_;
+    size_t t_;
+    double Tn_;
+    size_t Tn_prime_;
+};
+
+/**
+ * Number of iterations required to draw a sample consisting of inliers
+ * only with probability "confidence", given the number of inliers.
+ */
+inline size_t ransac_required_ncalls(
+    size_t ninliers,
+    size_t nelems_large,
+    size_t nelems_small,
+    double confidence)
+{
+    if ((confidence <= 0.) || (confidence >= 1.) || (ninliers == 0)) {
+        return SIZE_MAX;
+    }
+    double wm = std::pow(double(ninliers) / double(nelems_large), double(nelems_small));
+    if (wm >= 1.) {
+        return 1;
+    }
+    if (wm <= 0.) {
+        return SIZE_MAX;
+    }
+    double k = std::ceil(std::log(1. - confidence) / std::log1p(-wm));
+    return (k < 1e18) ? std::max<size_t>(1, (size_t)k) : SIZE_MAX;
+}
+
+template <class TData>
+bool ransac_is_inlier(const TData& residual, const RansacOptions<TData>& ro) {
+    // NaN residuals are treated as infinite.
+    return std::isnan(residual)
+        ? (ro.inlier_distance_thresh == std::numeric_limits<TData>::infinity())
+        : (residual <= ro.inlier_distance_thresh);
+}
+
 /**
  * Random sampling consensus (RANSAC) algorithm
  *
+ * "callable" maps the sorted indices of a sample to the residuals
+ * of all "nelems_large" elements, and must be thread-safe.
+ * Hypotheses are scored in parallel batches of "ro.batch_size",
+ * and the iteration stops early, see "RansacOptions::confidence".
+ *
  * The algorithm can be disabled as follows.
  * - ro.inlier_distance_thresh = infinity
  * - ro.nelems_small >= nelems_large
@@ -28,40 +151,192 @@ Array<size_t> ransac(
     assert(
         (nelems_large >= ro.nelems_small) ||
         ro.inlier_distance_thresh == std::numeric_limits<TData>::infinity());
-    Array<size_t> ids_large = arange<size_t>(nelems_large);
-    std::mt19937 g(ro.seed);
+    size_t m = std::min(ro.nelems_small, nelems_large);
+    size_t batch_size = std::max<size_t>(1, ro.batch_size);
+    RansacSampler sampler{ nelems_large, m, ro.sampling, ro.ncalls };
+    std::vector<RansacSampler::Pool> pools(batch_size);
+    std::vector<Array<size_t>> samples(batch_size);
+    std::vector<Array<TData>> residuals(batch_size);
+    std::vector<size_t> ninliers(batch_size);
+    std::vector<std::exception_ptr> errors(batch_size);
+    for (auto& s : samples) {
+        s.move() = Array<size_t>(ArrayShape{ m });
+    }
     size_t best_nonzero = 0;
     Array<size_t> best_indices;
+    size_t ncalls = ro.ncalls;
 
-    for (size_t i = 0; i < ro.ncalls; ++i) {
-
-        std::shuffle(ids_large.flat_begin(), ids_large.flat_end(), g);
-        Array<size_t> perm(ids_large.flat_begin(), ids_large.flat_begin() + (std::ptrdiff_t)std::min(ro.nelems_small, nelems_large));
-        sort(perm);
-        Array<TData> positive_residual = substitute_nans(callable(perm), TData(INFINITY));
-        if (positive_residual.length() != nelems_large) {
-            throw std::runtime_error(
-                "Residual length (" +
-                std::to_string(positive_residual.length())  +
-                ")  does not match nelems_large (" +
-                std::to_string(nelems_large) + ")");
+    for (size_t t0 = 0; t0 < ncalls; t0 += batch_size) {
+        size_t nbatch = std::min(batch_size, ncalls - t0);
+        for (size_t b = 0; b < nbatch; ++b) {
+            pools[b] = sampler.next_pool();
         }
-        Array<bool> also_inliers = (positive_residual <= ro.inlier_distance_thresh);
-
-        if (count_nonzero(also_inliers) > ro.inlier_count_thresh) {
+        #pragma omp parallel for if (nbatch > 1)
+        for (int bi = 0; bi < (int)nbatch; ++bi) {
+            auto b = (size_t)bi;
+            try {
+                RansacSampler::draw(pools[b], ro.seed, t0 + b, { samples[b].flat_begin(), m });
+                residuals[b].ref() = callable(samples[b]);
+                size_t n = 0;
+                for (const auto& r : residuals[b].flat_iterable()) {
+                    n += ransac_is_inlier(r, ro);
+                }
+                ninliers[b] = n;
+            } catch (...) {
+                errors[b] = std::current_exception();
+            }
+        }
+        // Hypotheses are accepted in the order of their iteration,
+        // which makes the result deterministic.
+        for (size_t b = 0; b < nbatch; ++b) {
+            if (errors[b] != nullptr) {
+                std::rethrow_exception(errors[b]);
+            }
+            const Array<TData>& positive_residual = residuals[b];
+            if (positive_residual.length() != nelems_large) {
+                throw std::runtime_error(
+                    "Residual length (" +
+                    std::to_string(positive_residual.length())  +
+                    ")  does not match nelems_large (" +
+                    std::to_string(nelems_large) + ")");
+            }
+            // The refined hypothesis can have at most "ninliers[b]" inliers.
+            if ((ninliers[b] <= ro.inlier_count_thresh) || (ninliers[b] <= best_nonzero)) {
+                continue;
+            }
+            Array<bool> also_inliers = (substitute_nans(positive_residual, TData(INFINITY)) <= ro.inlier_distance_thresh);
             Array<size_t> better_indices = arange<size_t>(nelems_large)[also_inliers];
             Array<TData> better_positive_residual = substitute_nans(callable(better_indices)[also_inliers], TData(INFINITY));
             size_t better_nonzero = count_nonzero(better_positive_residual <= ro.inlier_distance_thresh);
 
-            // lerr() << "---- " << better_mean_residual << " " << best_mean_residual;
             if (better_nonzero > best_nonzero) {
                 best_indices.destroy();
                 best_indices = better_indices;
                 best_nonzero = better_nonzero;
             }
         }
+        ncalls = std::min(ro.ncalls, ransac_required_ncalls(best_nonzero, nelems_large, m, ro.confidence));
     }
     return best_indices;
 }
 
+template <class TModel>
+struct RansacModel {
+    TModel model;
+    Array<size_t> inliers;
+};
+
+/**
+ * RANSAC with separate model fitting and per-element residuals,
+ * which allows rejecting hypotheses early, see
+ * "RansacOptions::preemptive_block_size".
+ *
+ * "fit" maps sorted indices to "std::optional<TModel>", and "residual"
+ * maps a model and an index to the residual. Both must be thread-safe.
+ * The best model is refitted to its inliers.
+ */
+template <class TFit>
+using RansacFittedModel = typename std::invoke_result_t<const TFit&, std::span<const size_t>>::value_type;
+
+template <class TData, class TFit, class TResidual>
+std::optional<RansacModel<RansacFittedModel<TFit>>> ransac_models(
+    size_t nelems_large,
+    const RansacOptions<TData>& ro,
+    const TFit& fit,
+    const TResidual& residual)
+{
+    using TModel = RansacFittedModel<TFit>;
+    assert(ro.nelems_small > 0);
+    size_t m = std::min(ro.nelems_small, nelems_large);
+    size_t batch_size = std::max<size_t>(1, ro.batch_size);
+    size_t block_size = (ro.preemptive_block_size == 0)
+        ? nelems_large
+        : ro.preemptive_block_size;
+    // A random evaluation order, s.t. every block is a random subset.
+    std::vector<size_t> order(nelems_large);
+    for (size_t i = 0; i < nelems_large; ++i) {
+        order[i] = i;
+    }
+    if (ro.preemptive_block_size != 0) {
+        std::shuffle(order.begin(), order.end(), std::mt19937(ro.seed));
+    }
+    RansacSampler sampler{ nelems_large, m, ro.sampling, ro.ncalls };
+    std::vector<RansacSampler::Pool> pools(batch_size);
+    std::vector<size_t> samples(batch_size * m);
+    std::vector<std::optional<TModel>> models(batch_size);
+    std::vector<size_t> ninliers(batch_size);
+    std::vector<std::exception_ptr> errors(batch_size);
+    std::optional<TModel> best_model;
+    size_t best_ninliers = 0;
+    size_t ncalls = ro.ncalls;
+
+    for (size_t t0 = 0; t0 < ncalls; t0 += batch_size) {
+        size_t nbatch = std::min(batch_size, ncalls - t0);
+        for (size_t b = 0; b < nbatch; ++b) {
+            pools[b] = sampler.next_pool();
+        }
+        // A hypothesis must exceed this number of inliers.
+        size_t bound = std::max(best_ninliers, ro.inlier_count_thresh);
+        #pragma omp parallel for if (nbatch > 1)
+        for (int bi = 0; bi < (int)nbatch; ++bi) {
+            auto b = (size_t)bi;
+            try {
+                std::span<size_t> sample{ samples.data() + b * m, m };
+                RansacSampler::draw(pools[b], ro.seed, t0 + b, sample);
+                models[b] = fit(std::span<const size_t>{ sample });
+                size_t n = 0;
+                if (models[b].has_value()) {
+                    for (size_t i = 0; i < nelems_large; ) {
+                        size_t end = std::min(nelems_large, i + block_size);
+                        for (; i < end; ++i) {
+                            n += ransac_is_inlier<TData>(residual(*models[b], order[i]), ro);
+                        }
+                        if (n + (nelems_large - i) <= bound) {
+                            n = 0;
+                            break;
+                        }
+                    }
+                }
+                ninliers[b] = n;
+            } catch (...) {
+                errors[b] = std::current_exception();
+            }
+        }
+        for (size_t b = 0; b < nbatch; ++b) {
+            if (errors[b] != nullptr) {
+                std::rethrow_exception(errors[b]);
+            }
+            if (ninliers[b] > std::max(best_ninliers, ro.inlier_count_thresh)) {
+                best_model = std::move(models[b]);
+                best_ninliers = ninliers[b];
+            }
+        }
+        ncalls = std::min(ro.ncalls, ransac_required_ncalls(best_ninliers, nelems_large, m, ro.confidence));
+    }
+    if (!best_model.has_value()) {
+        return std::nullopt;
+    }
+    auto inliers_of = [&](const TModel& model) {
+        std::vector<size_t> result;
+        for (size_t i = 0; i < nelems_large; ++i) {
+            if (ransac_is_inlier<TData>(residual(model, i), ro)) {
+                result.push_back(i);
+            }
+        }
+        return result;
+    };
+    auto inliers = inliers_of(*best_model);
+    if (auto refined = fit(std::span<const size_t>{ inliers }); refined.has_value()) {
+        auto refined_inliers = inliers_of(*refined);
+        if (refined_inliers.size() >= inliers.size()) {
+            best_model = std::move(refined);
+            inliers = std::move(refined_inliers);
+        }
+    }
+    return RansacModel<TModel>{
+        .model = std::move(*best_model),
+        .inliers = Array<size_t>(inliers)
+    };
+}
+
 }
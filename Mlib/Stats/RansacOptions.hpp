@@ -3,13 +3,35 @@
 
 namespace Mlib {
 
+enum class RansacSampling {
+    UNIFORM,
+    // Progressive sampling (PROSAC, Chum and Matas, 2005).
+    // Requires the elements to be sorted by decreasing quality,
+    // e.g. by descriptor distance.
+    PROSAC
+};
+
 template <class TData>
 struct RansacOptions {
     size_t nelems_small;
+    // Maximum number of hypotheses.
     size_t ncalls;
     TData inlier_distance_thresh;
     size_t inlier_count_thresh;
     unsigned int seed;
+    // Stop early once a sample consisting of inliers only has been
+    // drawn with this probability, given the inlier ratio of the best
+    // hypothesis so far. "0" disables the early termination.
+    double confidence = 0.99;
+    RansacSampling sampling = RansacSampling::UNIFORM;
+    // Number of hypotheses scored in parallel between two updates of
+    // the termination criterion. The result does not depend on the
+    // number of threads.
+    size_t batch_size = 16;
+    // Preemptive scoring, only used by "ransac_models". Residuals are
+    // evaluated in blocks of this size, and a hypothesis is rejected
+    // as soon as it cannot beat the best one anymore. "0" disables it.
+    size_t preemptive_block_size = 0;
 };
 
 }
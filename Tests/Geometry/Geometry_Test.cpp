@@ -8,22 +8,29 @@
 #include <Mlib/Geometry/Graph/Points_And_Adjacency.hpp>
 #include <Mlib/Geometry/Graph/Points_And_Adjacency_Impl.hpp>
 #include <Mlib/Geometry/Graph/Shortest_Path_Multiple_Targets.hpp>
+#include <Mlib/Geometry/Interfaces/IRace_Logic.hpp>
 #include <Mlib/Geometry/Mesh/Contour.hpp>
 #include <Mlib/Geometry/Mesh/Contour_Detection_Strategy.hpp>
 #include <Mlib/Geometry/Mesh/Interpolated_Intermediate_Points_Creator.hpp>
 #include <Mlib/Geometry/Mesh/Load/Load_Mesh_Config.hpp>
+#include <Mlib/Geometry/Mesh/Animated_Colored_Vertex_Arrays.hpp>
+#include <Mlib/Geometry/Mesh/Colored_Vertex_Array.hpp>
 #include <Mlib/Geometry/Mesh/Load/Load_Obj.hpp>
+#include <Mlib/Geometry/Mesh/Load/Mesh_Cache.hpp>
 #include <Mlib/Geometry/Mesh/Modifiers/Height_Contours.hpp>
 #include <Mlib/Geometry/Mesh/Save_Obj.hpp>
 #include <Mlib/Geometry/Mesh/Triangle_Area.hpp>
 #include <Mlib/Geometry/Mesh/Triangle_Largest_Cosine.hpp>
 #include <Mlib/Geometry/Mesh/Triangle_List.hpp>
 #include <Mlib/Geometry/Physics_Material.hpp>
+#include <Mlib/Geometry/Primitives/Batch_Sphere_Culling.hpp>
 #include <Mlib/Geometry/Primitives/Bvh.hpp>
 #include <Mlib/Geometry/Primitives/Bvh_Grid.hpp>
 #include <Mlib/Geometry/Primitives/Distance/Distance_Polygon_Aabb.hpp>
 #include <Mlib/Geometry/Primitives/Frustum3.hpp>
+#include <Mlib/Geometry/Primitives/Heightfield.hpp>
 #include <Mlib/Geometry/Primitives/Intersect_Lines.hpp>
+#include <Mlib/Geometry/Primitives/Intersectors/Ray_Packet_3D_For_Aabb.hpp>
 #include <Mlib/Geometry/Primitives/Intersectors/Ray_Segment_3D_For_Aabb.hpp>
 #include <Mlib/Geometry/Primitives/Lines_To_Rectangles.hpp>
 #include <Mlib/Geometry/Primitives/Point_Triangle_Intersection.hpp>
@@ -42,6 +49,8 @@
 #include <Mlib/Stats/Random_Arrays.hpp>
 #include <Mlib/Testing/Assert.hpp>
 #include <poly2tri/poly2tri.h>
+#include <filesystem>
+#include <fstream>
 
 using namespace Mlib;
 
@@ -589,6 +598,38 @@ void test_frustum3() {
         {1.f, 1.f, -3.1f})), true);
 }
 
+void test_batch_sphere_culling() {
+    FrustumCameraConfig cfg{
+        .near_plane = 2.f,
+        .far_plane = 100.f,
+        .left = -2.f,
+        .right = 2.f,
+        .bottom = -2.f,
+        .top = 2.f};
+    FrustumCamera camera{cfg, FrustumCamera::Postprocessing::DISABLED};
+    auto mvp = camera.projection_matrix();
+    SphereArrays<float> spheres;
+    spheres.push_back({0.f, 0.f, -10.f}, 1.f);  // inside
+    spheres.push_back({0.f, 0.f, 10.f}, 1.f);   // behind the camera
+    spheres.push_back({0.f, 0.f, -1.f}, 0.5f);  // in front of the near plane
+    spheres.push_back({0.f, 0.f, -1.f}, 2.f);   // intersects the near plane
+    spheres.push_back({50.f, 0.f, -10.f}, 1.f); // right of the frustum
+    spheres.push_back({0.f, 0.f, -90.f}, 1.f);  // inside, far away
+    BatchSphereCulling<float> culling{ mvp };
+    {
+        std::vector<uint32_t> survivors;
+        culling.cull(spheres, 0.f, INFINITY, survivors);
+        assert_true((survivors == std::vector<uint32_t>{0, 3, 5}));
+    }
+    {
+        auto clip = dot1d(mvp, FixedArray<float, 4>{0.f, 0.f, -10.f, 1.f});
+        float dist2 = squared(clip(0)) + squared(clip(1)) + squared(clip(2));
+        std::vector<uint32_t> survivors{ 42 };
+        culling.cull(spheres, 0.f, 1.01f * dist2, survivors);
+        assert_true((survivors == std::vector<uint32_t>{42, 0, 3}));
+    }
+}
+
 void test_ray_sphere_intersection() {
     FixedArray<double, 3> R{ 15., 0., 0. };
     FixedArray<double, 3> v{ 1., 0., 0. };
@@ -599,6 +640,86 @@ void test_ray_sphere_intersection() {
     assert_isclose(lambda, 2.);
 }
 
+void test_ray_packet() {
+    RayPacket3DForAabb<double, 8> packet;
+    // Hits, misses, ends before the box, axis-aligned hit and miss.
+    packet.add({ { -2., 0.5, 0.5 }, { 2., 0.5, 0.5 } });
+    packet.add({ { -2., 2., 0.5 }, { 2., 2., 0.5 } });
+    packet.add({ { -2., 0.5, 0.5 }, { -1., 0.5, 0.5 } });
+    packet.add({ { 0.5, 0.5, -3. }, { 0.5, 0.5, 3. } });
+    packet.add({ { 0., 1., -3. }, { 0., 1., 3. } });
+    packet.add({ { 1.5, 0.5, -3. }, { 1.5, 0.5, 3. } });
+    auto aabb = AxisAlignedBoundingBox<double, 3>::from_min_max({ 0., 0., 0. }, { 1., 1., 1. });
+    assert_isequal(packet.mask(aabb), 0b011001u);
+    packet.deactivate(0);
+    assert_true(packet.intersects(aabb));
+    assert_isequal(packet.last_mask(), 0b011000u);
+    // Compare with the scalar test.
+    NormalRandomNumberGenerator<double> r{ 1, 0.5, 1. };
+    for (size_t j = 0; j < 100; ++j) {
+        RayPacket3DForAabb<double, 8> p;
+        std::vector<RaySegment3DForAabb<double, double>> rays;
+        for (size_t i = 0; i < 8; ++i) {
+            rays.emplace_back(RaySegment3D<double, double>{
+                FixedArray<double, 3>{ r(), r(), r() },
+                FixedArray<double, 3>{ r(), r(), r() } });
+            p.add(rays.back());
+        }
+        auto m = p.mask(aabb);
+        for (size_t i = 0; i < 8; ++i) {
+            assert_isequal(((m >> i) & 1) != 0, rays[i].intersects(aabb));
+        }
+    }
+}
+
+void test_heightfield() {
+    // Plane "z = 0.5 * x + 0.25 * y".
+    Array<float> heights(ArrayShape{ 3, 3 });
+    for (size_t r = 0; r < 3; ++r) {
+        for (size_t c = 0; c < 3; ++c) {
+            heights(r, c) = 0.5f * 2.f * (float)c + 0.25f * (float)r;
+        }
+    }
+    Heightfield hf{ heights.copy(), { 0., 0. }, { 2., 1. } };
+    ScenePos z;
+    assert_true(hf.height({ 1.5, 0.7 }, z));
+    assert_isclose<ScenePos>(z, 0.925);
+    assert_true(!hf.height({ -0.1, 0.7 }, z));
+    FixedArray<SceneDir, 3> n = uninitialized;
+    assert_true(hf.normal({ 3.5, 0.2 }, n));
+    auto n_expected = FixedArray<SceneDir, 3>{ -0.5f, -0.25f, 1.f } / std::sqrt(1.3125f);
+    assert_allclose(n, n_expected);
+    assert_true(hf.covers({ 1., 1., 0.76 }, 0.05));
+    assert_true(!hf.covers({ 1., 1., 0.9 }, 0.05));
+    HeightfieldHit hit{ NAN, uninitialized, uninitialized };
+    assert_true(hf.intersect_ray({ 1., 1., 10. }, { 0.f, 0.f, -1.f }, 100., hit));
+    assert_isclose<ScenePos>(hit.distance, 9.25);
+    assert_true(hf.intersect_ray({ -1., 0.5, 3. }, FixedArray<SceneDir, 3>{ 1.f, 0.f, -1.f } / std::sqrt(2.f), 100., hit));
+    assert_isclose<ScenePos>(hit.distance, 2.25 * std::sqrt(2.), 1e-6);
+    assert_isclose<ScenePos>(hit.position(0), 1.25, 1e-6);
+    assert_true(!hf.intersect_ray({ 1., 1., 10. }, { 0.f, 0.f, 1.f }, 100., hit));
+    assert_true(hf.intersect_ray({ 1., 1., -10. }, { 0.f, 0.f, 1.f }, 100., hit));
+    assert_isclose<ScenePos>(hit.distance, 10.75);
+    assert_true(!hf.intersect_ray({ 1., 1., 10. }, { 0.f, 0.f, -1.f }, 5., hit));
+    assert_true(hf.sweep_sphere({ 2., 1., 5. }, 0.5, { 0.f, 0.f, -1.f }, 100., hit));
+    assert_isclose<ScenePos>(hit.distance, 3.75 - 0.5 * std::sqrt(1.3125), 1e-6);
+    assert_allclose(hit.normal, n_expected);
+    // Sphere passing the corner of the grid.
+    assert_true(hf.sweep_sphere({ -1., 0., 0. }, 0.5, { 1.f, 0.f, 0.f }, 100., hit));
+    assert_isclose<ScenePos>(hit.distance, 0.5, 1e-6);
+    assert_allclose(hit.position, FixedArray<ScenePos, 3>{ 0., 0., 0. });
+    size_t ntriangles = 0;
+    hf.visit_triangles(hf.aabb(), [&](const FixedArray<ScenePos, 3, 3>& t){
+        ++ntriangles;
+        return true;
+    });
+    assert_isequal<size_t>(ntriangles, 8);
+    heights(0, 0) = NAN;
+    Heightfield hf2{ heights, { 0., 0. }, { 2., 1. } };
+    assert_true(!hf2.height({ 0.5, 0.2 }, z));
+    assert_true(hf2.height({ 2.5, 0.2 }, z));
+}
+
 void test_distance_polygon_aabb() {
     using P = CompressedScenePos;
     auto aabb = AxisAlignedBoundingBox<ScenePos, 3>::from_min_max(
@@ -701,6 +822,162 @@ void test_height_contours() {
     height_contours_by_vertex(triangles, (CompressedScenePos)0.1f);
 }
 
+void test_load_obj_chunks() {
+    LoadMeshConfig<float> cfg{
+        .blend_mode = BlendMode::OFF,
+        .cull_faces_default = true,
+        .cull_faces_alpha = true,
+        .occluded_pass = ExternalRenderPassType::NONE,
+        .occluder_pass = ExternalRenderPassType::NONE,
+        .aggregate_mode = AggregateMode::NONE,
+        .transformation_mode = TransformationMode::ALL,
+        .period_world = INFINITY,
+        .apply_static_lighting = false,
+        .laplace_ao_strength = 0.f,
+        .dynamically_lighted = false,
+        .physics_material = PhysicsMaterial::ATTR_VISIBLE,
+        .werror = true};
+    for (const auto* filename : { "Data/box.obj", "Data/slide2.obj" }) {
+        // A single chunk is tokenized sequentially, small chunks split
+        // the file at many line boundaries.
+        auto sequential = load_obj<float>(filename, cfg, SIZE_MAX);
+        auto parallel = load_obj<float>(filename, cfg, 16);
+        assert_isequal(parallel.size(), sequential.size());
+        for (auto s = sequential.begin(), p = parallel.begin(); s != sequential.end(); ++s, ++p) {
+            assert_true((*p)->meta.name.full_name() == (*s)->meta.name.full_name());
+            assert_isequal((*p)->triangles.size(), (*s)->triangles.size());
+            assert_isequal((*p)->quads.size(), (*s)->quads.size());
+            for (size_t i = 0; i < (*s)->triangles.size(); ++i) {
+                for (size_t j = 0; j < 3; ++j) {
+                    assert_allequal((*p)->triangles[i](j).position, (*s)->triangles[i](j).position);
+                    assert_allequal((*p)->triangles[i](j).normal, (*s)->triangles[i](j).normal);
+                    assert_allequal((*p)->triangles[i](j).uv, (*s)->triangles[i](j).uv);
+                }
+            }
+        }
+    }
+}
+
+void test_mesh_cache() {
+    LoadMeshConfig<float> cfg{
+        .blend_mode = BlendMode::OFF,
+        .cull_faces_default = true,
+        .cull_faces_alpha = true,
+        .occluded_pass = ExternalRenderPassType::NONE,
+        .occluder_pass = ExternalRenderPassType::NONE,
+        .aggregate_mode = AggregateMode::NONE,
+        .transformation_mode = TransformationMode::ALL,
+        .period_world = INFINITY,
+        .apply_static_lighting = false,
+        .laplace_ao_strength = 0.f,
+        .dynamically_lighted = false,
+        .physics_material = PhysicsMaterial::ATTR_VISIBLE,
+        .werror = true};
+    size_t nloads = 0;
+    auto load = [&](){
+        ++nloads;
+        auto acvas = std::make_shared<AnimatedColoredVertexArrays>();
+        acvas->scvas = load_obj<float>("Data/box.obj", cfg);
+        return acvas;
+    };
+    auto sources = obj_dependencies("Data/box.obj");
+    auto generated = load_mesh_cached(
+        "TestOut/MeshCache", sources, "obj", cfg, load, MeshCacheMode::OVERWRITE);
+    auto cached = load_mesh_cached(
+        "TestOut/MeshCache", sources, "obj", cfg, load, MeshCacheMode::READ_WRITE);
+    assert_true(nloads == 1);
+    assert_true(cached->scvas.size() == generated->scvas.size());
+    for (auto g = generated->scvas.begin(), c = cached->scvas.begin(); g != generated->scvas.end(); ++g, ++c) {
+        assert_true((*c)->meta.name.full_name() == (*g)->meta.name.full_name());
+        assert_true((*c)->triangles.size() == (*g)->triangles.size());
+        assert_true((*c)->quads.size() == (*g)->quads.size());
+        for (size_t i = 0; i < (*g)->triangles.size(); ++i) {
+            for (size_t j = 0; j < 3; ++j) {
+                assert_allequal((*c)->triangles[i](j).position, (*g)->triangles[i](j).position);
+                assert_allequal((*c)->triangles[i](j).normal, (*g)->triangles[i](j).normal);
+            }
+        }
+    }
+    cfg.scale = 2.f;
+    load_mesh_cached(
+        "TestOut/MeshCache", sources, "obj", cfg, load, MeshCacheMode::READ_WRITE);
+    assert_true(nloads == 2);
+
+    // A newer modification time invalidates the entry.
+    std::filesystem::copy_file("Data/box.obj", "TestOut/MeshCache/box_copy.obj", std::filesystem::copy_options::overwrite_existing);
+    auto copy_sources = obj_dependencies("TestOut/MeshCache/box_copy.obj");
+    load_mesh_cached(
+        "TestOut/MeshCache", copy_sources, "obj", cfg, load, MeshCacheMode::READ_WRITE);
+    assert_true(nloads == 3);
+    load_mesh_cached(
+        "TestOut/MeshCache", copy_sources, "obj", cfg, load, MeshCacheMode::READ_WRITE);
+    assert_true(nloads == 3);
+    std::filesystem::last_write_time(
+        "TestOut/MeshCache/box_copy.obj",
+        std::filesystem::last_write_time("TestOut/MeshCache/box_copy.obj") + std::chrono::seconds(2));
+    load_mesh_cached(
+        "TestOut/MeshCache", copy_sources, "obj", cfg, load, MeshCacheMode::READ_WRITE);
+    assert_true(nloads == 4);
+
+    // Side effects of the loader are replayed on a cache hit.
+    struct RaceLogic: public IRaceLogic {
+        virtual void set_start_pose(
+            const TransformationMatrix<float, ScenePos, 3>& pose,
+            const FixedArray<float, 3>& velocity,
+            const FixedArray<float, 3>& angular_velocity,
+            uint32_t rank) override
+        {
+            ranks.push_back(rank);
+        }
+        virtual void set_checkpoints(
+            const std::vector<TransformationMatrix<float, ScenePos, 3>>& checkpoints) override
+        {
+            ncheckpoints.push_back(checkpoints.size());
+        }
+        virtual void set_circularity(bool is_circular) override {
+            circularities.push_back(is_circular);
+        }
+        std::vector<uint32_t> ranks;
+        std::vector<size_t> ncheckpoints;
+        std::vector<bool> circularities;
+    };
+    auto load_with_side_effects = [&](MeshSideEffects& side_effects){
+        side_effects.set_start_pose(
+            TransformationMatrix<float, ScenePos, 3>::identity(),
+            fixed_zeros<float, 3>(),
+            fixed_zeros<float, 3>(),
+            3);
+        side_effects.set_checkpoints({
+            TransformationMatrix<float, ScenePos, 3>::identity(),
+            TransformationMatrix<float, ScenePos, 3>::identity() });
+        side_effects.set_circularity(true);
+        return load();
+    };
+    RaceLogic generated_logic;
+    RaceLogic cached_logic;
+    load_mesh_cached(
+        "TestOut/MeshCache", sources, "obj_race", cfg, load_with_side_effects, nullptr, &generated_logic, MeshCacheMode::OVERWRITE);
+    load_mesh_cached(
+        "TestOut/MeshCache", sources, "obj_race", cfg, load_with_side_effects, nullptr, &cached_logic, MeshCacheMode::READ_WRITE);
+    assert_true(nloads == 5);
+    for (const auto* logic : { &generated_logic, &cached_logic }) {
+        assert_true(logic->ranks == std::vector<uint32_t>{ 3 });
+        assert_true(logic->ncheckpoints == std::vector<size_t>{ 2 });
+        assert_true(logic->circularities == std::vector<bool>{ true });
+    }
+
+    // "mtllib" may list several files.
+    {
+        std::ofstream ofstr{ "TestOut/MeshCache/mtllibs.obj" };
+        ofstr << "mtllib a.mtl\tb.mtl  c.mtl\r\n";
+    }
+    auto mtllibs = obj_dependencies("TestOut/MeshCache/mtllibs.obj");
+    assert_isequal<size_t>(mtllibs.size(), 4);
+    assert_true(mtllibs[1].filename().string() == "a.mtl");
+    assert_true(mtllibs[2].filename().string() == "b.mtl");
+    assert_true(mtllibs[3].filename().string() == "c.mtl");
+}
+
 void test_flood_fill() {
     std::vector<int> points{ 0, 0, 5, 2, 2, 0, 5 };
     auto clusters = cluster_by_flood_fill(points, [](int a, int b){ return a == b; });
@@ -746,10 +1023,15 @@ int main(int argc, const char** argv) {
         test_welzl_tetrahedron();
         test_shortest_path();
         test_frustum3();
+        test_batch_sphere_culling();
         test_ray_sphere_intersection();
+        test_ray_packet();
+        test_heightfield();
         test_distance_polygon_aabb();
         test_plane_shift();
         test_height_contours();
+        test_load_obj_chunks();
+        test_mesh_cache();
         test_flood_fill();
     } catch (const std::runtime_error& e) {
         lerr() << e.what();
@@ -12,6 +12,10 @@
 #include <Mlib/Images/Normalize.hpp>
 #include <Mlib/Images/StbImage3.hpp>
 #include <Mlib/Images/Svg.hpp>
+#include <Mlib/Images/Tiles/Process_Tiles.hpp>
+#include <Mlib/Images/Tiles/Tile_Cache.hpp>
+#include <Mlib/Images/Tiles/Tiled_Image_File.hpp>
+#include <Mlib/Images/Tiles/Tiled_Operations.hpp>
 #include <Mlib/Images/Transform/Downsample.hpp>
 #include <Mlib/Misc/Floating_Point_Exceptions.hpp>
 #include <Mlib/Stats/Random_Arrays.hpp>
@@ -85,6 +89,74 @@ void test_median_filter_2d() {
         {NAN, NAN, NAN, NAN, NAN, NAN, NAN}});
 }
 
+template <class TData>
+Array<TData> sorting_percentile_filter_2d(
+    const Array<TData>& im,
+    size_t window_size,
+    double percentile,
+    size_t minelements,
+    TData boundary_value)
+{
+    Array<TData> result = full(im.shape(), boundary_value);
+    for (size_t r = window_size; r + window_size < im.shape(0); ++r) {
+        for (size_t c = window_size; c + window_size < im.shape(1); ++c) {
+            std::vector<TData> values;
+            for (size_t rr = r - window_size; rr <= r + window_size; ++rr) {
+                for (size_t cc = c - window_size; cc <= c + window_size; ++cc) {
+                    if (!scalar_isnan(im(rr, cc))) {
+                        values.push_back(im(rr, cc));
+                    }
+                }
+            }
+            if (!values.empty() && (values.size() >= minelements)) {
+                std::sort(values.begin(), values.end());
+                result(r, c) = values[percentile_rank(values.size(), percentile)];
+            }
+        }
+    }
+    return result;
+}
+
+void test_percentile_filter_2d() {
+    auto im = uniform_random_array<float>(ArrayShape{ 30, 90 }, 2);
+    for (size_t r = 0; r < 30; ++r) {
+        im(r, (r * 7) % 90) = NAN;
+        im(r, (r * 13) % 90) = NAN;
+    }
+    for (size_t w : { 0, 1, 3 }) {
+        for (double p : { 0., 0.2, 0.5, 1. }) {
+            assert_allclose(
+                percentile_filter_2d(im, w, p, 5),
+                sorting_percentile_filter_2d(im, w, p, 5, float{ NAN }));
+            // Fallback for images with too many distinct values.
+            auto sliding = full(im.shape(), float{ NAN });
+            sliding_percentile_filter_2d(im, sliding, w, p, 5, float{ NAN });
+            assert_allclose(sliding, sorting_percentile_filter_2d(im, w, p, 5, float{ NAN }));
+        }
+    }
+    auto im8 = (uniform_random_array<float>(ArrayShape{ 30, 90 }, 3) * 255.f).casted<uint8_t>();
+    auto im16 = (uniform_random_array<float>(ArrayShape{ 30, 90 }, 4) * 65535.f).casted<uint16_t>();
+    for (size_t w : { 0, 1, 3, 12 }) {
+        for (double p : { 0., 0.2, 0.5, 1. }) {
+            assert_true(all(
+                percentile_filter_2d<uint8_t>(im8, w, p, 1, 0) ==
+                sorting_percentile_filter_2d<uint8_t>(im8, w, p, 1, 0)));
+            assert_true(all(
+                percentile_filter_2d<uint16_t>(im16, w, p, 1, 0) ==
+                sorting_percentile_filter_2d<uint16_t>(im16, w, p, 1, 0)));
+        }
+    }
+    // The histograms are sized to the value range.
+    auto im12 = (uniform_random_array<float>(ArrayShape{ 30, 90 }, 5) * 4095.f).casted<uint16_t>();
+    assert_true(all(
+        percentile_filter_2d<uint16_t>(im12, 3, 0.5, 1, 0) ==
+        sorting_percentile_filter_2d<uint16_t>(im12, 3, 0.5, 1, 0)));
+    auto im0 = zeros<uint8_t>(ArrayShape{ 10, 10 });
+    assert_true(all(
+        percentile_filter_2d<uint8_t>(im0, 2, 0.5, 1, 7) ==
+        sorting_percentile_filter_2d<uint8_t>(im0, 2, 0.5, 1, 7)));
+}
+
 void test_lowpass() {
     Array<float> im{
         {0, 0, 1, 0, 0},
@@ -107,6 +179,74 @@ void test_lowpass() {
             {0, 0, 0, 0, 0}});
 }
 
+void test_recursive_gaussian() {
+    auto im = uniform_random_array<double>(ArrayShape{ 40, 50 }, 1);
+    im(3, 4) = NAN;
+    im(20, 30) = NAN;
+    for (size_t axis = 0; axis < 2; ++axis) {
+        Array<double> fir;
+        Array<double> rec;
+        separable_filter_1d_NWE(im, fir, gaussian_kernel(5., 6.), double{ NAN }, axis);
+        recursive_gaussian_filter_1d_NWE(im, rec, 5., double{ NAN }, axis);
+        assert_allclose(rec, fir, 4e-3);
+    }
+    assert_allclose(
+        gaussian_filter_NWE(im, 10., double{ NAN }, 6., FilterExtension::NWE, 0, GaussianFilterMethod::RECURSIVE),
+        gaussian_filter_NWE(im, 10., double{ NAN }, 6.),
+        2e-3);
+    // The recursive filter is opt-in.
+    assert_allclose(
+        gaussian_filter_NWE(im, 5., double{ NAN }),
+        gaussian_filter_NWE(im, 5., double{ NAN }, 8.),
+        1e-4);
+}
+
+void test_tiled_image() {
+    auto im = uniform_random_array<float>(ArrayShape{ 2, 70, 90 }, 5);
+    ArrayTiledImage<float> source{ im };
+    save_tiled_image_file(source, "TestOut/tiled.mtil", 32);
+    // The cache only holds a single tile.
+    TileCache cache{ 2 * 32 * 32 * sizeof(float) };
+    TiledImageFileReader reader{ "TestOut/tiled.mtil", cache };
+    assert_true(reader.height() == 70);
+    assert_true(reader.width() == 90);
+    assert_allclose(evaluate_tiled_image(reader, 17), im);
+    assert_allclose(
+        reader.read({ 20, 30, 40, 50 }),
+        im.cropped(ArrayShape{ 0, 20, 30 }, ArrayShape{ 2, 60, 80 }).copy());
+    assert_true(cache.nbytes() <= 2 * 32 * 32 * sizeof(float));
+    assert_allclose(evaluate_tiled_image(resized_tiled_image(reader, 70, 90), 16), im);
+    assert_allclose(
+        evaluate_tiled_image(GaussianFilteredTiledImage{ reader, { 1.5f, 1.5f } }, 16),
+        multichannel_gaussian_filter_NWE(im, 1.5f, float{ NAN }),
+        1e-5);
+    // The tiles of a destroyed reader are removed from the cache.
+    TileCache cache2{ 1024 * 1024 };
+    {
+        TiledImageFileReader reader2{ "TestOut/tiled.mtil", cache2 };
+        reader2.read({ 60, 80, 10, 10 });
+        // The border tiles are cropped to the image.
+        assert_true(cache2.nbytes() == 2 * (32 + 6) * 26 * sizeof(float));
+    }
+    assert_true(cache2.nbytes() == 0);
+    {
+        // 1-pixel stripes must not alias when downsampling by 8. Without
+        // the prefilter, the result varies between 0.125 and 0.875. The
+        // tolerance covers the truncated kernel at the border.
+        auto stripes = zeros<float>(ArrayShape{ 1, 64, 132 });
+        for (size_t r = 0; r < 64; ++r) {
+            for (size_t c = 1; c < 132; c += 2) {
+                stripes(0, r, c) = 1.f;
+            }
+        }
+        ArrayTiledImage<float> source{ stripes };
+        assert_allclose(
+            evaluate_tiled_image(resized_tiled_image(source, 8, 16), 16),
+            full(ArrayShape{ 1, 8, 16 }, 0.5f),
+            2e-2f);
+    }
+}
+
 void test_color_spaces() {
     Array<float> a = uniform_random_array<float>(ArrayShape{3, 4, 5}, 1);
     assert_allclose(yuv2rgb(rgb2yuv(a)), a, 1e-5f);
@@ -205,7 +345,10 @@ int main(int argc, char **argv) {
         test_differences();
         test_laplace();
         test_median_filter_2d();
+        test_percentile_filter_2d();
         test_lowpass();
+        test_recursive_gaussian();
+        test_tiled_image();
         test_color_spaces();
         test_central_differences();
         test_small_boxes();
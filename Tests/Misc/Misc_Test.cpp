@@ -1,25 +1,41 @@
 #include <Mlib/Array/Chunked_Array.hpp>
 #include <Mlib/List/Thread_Safe_List.hpp>
+#include <Mlib/Map/Rcu_String_With_Hash_Unordered_Map.hpp>
+#include <Mlib/Map/String_Atom_Unordered_Map.hpp>
 #include <Mlib/Map/Try_Find.hpp>
 #include <Mlib/Math/Math.hpp>
 #include <Mlib/Memory/Dangling_Base_Class.hpp>
+#include <Mlib/Memory/Dangling_Generation_Tracker.hpp>
 #include <Mlib/Memory/Dangling_Unique_Ptr.hpp>
 #include <Mlib/Memory/Dangling_Value_Unordered_Map.hpp>
 #include <Mlib/Memory/Destruction_Functions.hpp>
 #include <Mlib/Memory/Destruction_Notifier.hpp>
 #include <Mlib/Memory/Object_Pool.hpp>
 #include <Mlib/Memory/Resource_Ptr.hpp>
+#include <Mlib/Memory/Slab_Allocator.hpp>
 #include <Mlib/Misc/Floating_Point_Exceptions.hpp>
 #include <Mlib/Os/Io/Binary_Bitwise_Words_Reader.hpp>
 #include <Mlib/Os/Io/Binary_Bitwise_Words_Writer.hpp>
+#include <Mlib/Os/Log/Async_Log.hpp>
 #include <Mlib/Os/Os.hpp>
+#include <Mlib/Os/Threads/Atomic_Mutex.hpp>
 #include <Mlib/Os/Threads/Dispatcher.hpp>
+#include <Mlib/Os/Threads/Mutex_Contention.hpp>
 #include <Mlib/Os/Threads/Recursive_Shared_Mutex.hpp>
+#include <Mlib/Os/Threads/Safe_Atomic_Shared_Mutex.hpp>
 #include <Mlib/Regex/Misc.hpp>
 #include <Mlib/Regex/Template_Regex.hpp>
 #include <Mlib/Scene_Config/Physics_Precision.hpp>
 #include <Mlib/Testing/Assert.hpp>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <barrier>
 #include <iostream>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
 
 using namespace Mlib;
 
@@ -224,6 +240,93 @@ void test_dangling_base_class() {
     linfo() << V->a;
 }
 
+void test_dangling_references() {
+    DanglingGenerationTracker::Reference r;
+    {
+        DanglingGenerationTracker tracker;
+        tracker.add(r, CURRENT_SOURCE_LOCATION);
+        DanglingGenerationTracker::Reference r2;
+        tracker.copy(r2, r);
+        assert_isequal<size_t>(tracker.nreferences(), 2);
+        tracker.remove(r2);
+        tracker.remove(r);
+        DanglingGenerationTracker::check(r);
+    }
+    assert_true(DanglingSlotTable::instance().generation(r.slot) != r.generation);
+    {
+        DanglingGenerationTracker tracker;
+        DanglingGenerationTracker::Reference r3;
+        tracker.add(r3, CURRENT_SOURCE_LOCATION);
+        // The slot is reused with a new generation.
+        assert_isequal(r3.slot, r.slot);
+        assert_true(r3.generation != r.generation);
+        tracker.remove(r3);
+    }
+    {
+        // A reference that outlives its object is invalidated, and
+        // removing it does not affect the next owner of the slot.
+        DanglingGenerationTracker::Reference r4;
+        {
+            DanglingGenerationTracker tracker;
+            tracker.add(r4, CURRENT_SOURCE_LOCATION);
+        }
+        assert_true(DanglingSlotTable::instance().generation(r4.slot) != r4.generation);
+        DanglingGenerationTracker tracker;
+        DanglingGenerationTracker::Reference r5;
+        tracker.add(r5, CURRENT_SOURCE_LOCATION);
+        assert_isequal(r5.slot, r4.slot);
+        DanglingGenerationTracker::remove(r4);
+        assert_isequal<size_t>(tracker.nreferences(), 1);
+        tracker.remove(r5);
+        assert_isequal<size_t>(tracker.nreferences(), 0);
+    }
+    {
+        // Objects that are alive at the same time have distinct slots.
+        size_t nthreads = 8;
+        size_t nobjects = 1000;
+        std::vector<uint32_t> slots(nthreads * nobjects);
+        std::barrier sync{ (ptrdiff_t)nthreads };
+        {
+            std::vector<std::jthread> threads;
+            for (size_t t = 0; t < nthreads; ++t) {
+                threads.emplace_back([&, t](){
+                    for (size_t round = 0; round < 20; ++round) {
+                        std::list<DanglingGenerationTracker> trackers;
+                        for (size_t i = 0; i < nobjects; ++i) {
+                            trackers.emplace_back();
+                        }
+                        if (round == 19) {
+                            size_t i = t * nobjects;
+                            for (auto& tracker : trackers) {
+                                DanglingGenerationTracker::Reference r6;
+                                tracker.add(r6, CURRENT_SOURCE_LOCATION);
+                                slots[i++] = r6.slot;
+                                tracker.remove(r6);
+                            }
+                            sync.arrive_and_wait();
+                        }
+                    }
+                });
+            }
+        }
+        std::sort(slots.begin(), slots.end());
+        assert_true(std::adjacent_find(slots.begin(), slots.end()) == slots.end());
+    }
+    MyDerived a;
+    {
+        DanglingBaseClassPtr<MyClass> p{ a, CURRENT_SOURCE_LOCATION };
+        auto q = p;
+        auto m = std::move(q);
+        assert_true(q == nullptr);
+        DanglingBaseClassRef<MyClass> v = *m;
+        assert_isequal<size_t>(a.nreferences(), 3);
+        p = nullptr;
+        assert_isequal<size_t>(a.nreferences(), 2);
+        assert_isequal(v->a, 5);
+    }
+    assert_isequal<size_t>(a.nreferences(), 0);
+}
+
 void test_object_pool_std() {
     struct A: Object {
         int i = 5;
@@ -242,6 +345,112 @@ void test_object_pool_unique() {
     linfo() << a.i;
 }
 
+void test_object_pool_destruction_order() {
+    struct A: Object {
+        A(std::vector<const A*>& destroyed, ObjectPool& p)
+            : destroyed{ destroyed }
+            , p{ p }
+        {}
+        ~A() {
+            destroyed.push_back(this);
+            // Objects remove themselves from the pool in their destructor.
+            p.remove(this);
+        }
+        std::vector<const A*>& destroyed;
+        ObjectPool& p;
+        int i = 5;
+    };
+    std::vector<const A*> destroyed;
+    std::vector<const A*> created;
+    {
+        ObjectPool p{ InObjectPoolDestructor::CLEAR };
+        for (size_t i = 0; i < 1000; ++i) {
+            created.push_back(&p.create<A>(CURRENT_SOURCE_LOCATION, destroyed, p));
+        }
+        // Reuse some of the blocks.
+        for (size_t i = 0; i < 1000; i += 3) {
+            p.remove(const_cast<A*>(created[i]));
+            created[i] = &p.create<A>(CURRENT_SOURCE_LOCATION, destroyed, p);
+        }
+        destroyed.clear();
+    }
+    assert_isequal(destroyed.size(), created.size());
+    assert_true(std::is_sorted(destroyed.begin(), destroyed.end(), std::less<const A*>()));
+    std::sort(created.begin(), created.end());
+    assert_true(destroyed == created);
+}
+
+void test_object_pool_ownership_transfer() {
+    struct A: Object {
+        explicit A(size_t& ndestroyed)
+            : ndestroyed{ ndestroyed }
+        {}
+        ~A() {
+            ++ndestroyed;
+        }
+        size_t& ndestroyed;
+    };
+    struct Large: A {
+        using A::A;
+        std::array<std::byte, 100'000> data;
+    };
+    size_t ndestroyed = 0;
+    ObjectPool p0{ InObjectPoolDestructor::ASSERT_NO_LEAKS };
+    {
+        ObjectPool p1{ InObjectPoolDestructor::CLEAR };
+        // Slab, heap and too-large objects moved from one pool to the other.
+        auto& a = p1.add(p0.extract(p0.create_unique<A>(CURRENT_SOURCE_LOCATION, ndestroyed)), CURRENT_SOURCE_LOCATION);
+        auto& b = p1.add(p0.extract(p0.create_unique<Large>(CURRENT_SOURCE_LOCATION, ndestroyed)), CURRENT_SOURCE_LOCATION);
+        auto& c = p1.add(std::make_unique<A>(ndestroyed), CURRENT_SOURCE_LOCATION);
+        assert_true(p1.contains(a));
+        assert_true(p1.contains(b));
+        assert_true(p1.contains(c));
+        assert_true(!p0.contains(a));
+        p1.remove(c);
+        assert_isequal<size_t>(ndestroyed, 1);
+        // An extracted object is destroyed by its unique pointer.
+        p0.extract(p0.create_unique<A>(CURRENT_SOURCE_LOCATION, ndestroyed));
+        assert_isequal<size_t>(ndestroyed, 2);
+    }
+    assert_isequal<size_t>(ndestroyed, 4);
+}
+
+void test_slab_allocator() {
+    // The smallest size class that fits.
+    for (size_t n = 1; n <= SlabAllocator::block_size(SlabAllocator::NSIZE_CLASSES - 1); ++n) {
+        auto c = SlabAllocator::size_class(n);
+        assert_true(c < SlabAllocator::NSIZE_CLASSES);
+        assert_true(SlabAllocator::block_size(c) >= n);
+        assert_true((c == 0) || (SlabAllocator::block_size(c - 1) < n));
+        assert_isequal<size_t>(SlabAllocator::block_size(c) % SlabAllocator::ALIGNMENT, 0);
+    }
+    assert_isequal(SlabAllocator::size_class(16385), SlabAllocator::NSIZE_CLASSES);
+    // Blocks allocated on one thread and freed on another.
+    std::vector<std::array<int, 10>*> blocks(10'000);
+    std::jthread{ [&](){
+        for (auto& b : blocks) {
+            b = slab_allocate<std::array<int, 10>>();
+            b->fill(42);
+        }
+    } }.join();
+    std::jthread{ [&](){
+        for (auto* b : blocks) {
+            assert_isequal((*b)[9], 42);
+            slab_deallocate(b);
+        }
+    } }.join();
+    auto c = SlabAllocator::size_class(sizeof(std::array<int, 10>));
+    auto nslabs = SlabAllocator::instance().nslabs(c);
+    // The blocks returned by the exited threads are reused.
+    for (auto& b : blocks) {
+        b = slab_allocate<std::array<int, 10>>();
+    }
+    assert_isequal(SlabAllocator::instance().nslabs(c), nslabs);
+    for (auto* b : blocks) {
+        slab_deallocate(b);
+    }
+}
+
 void test_try_find() {
     std::map<int, std::string> m;
     if (try_find(m, 42) != nullptr) {
@@ -253,12 +462,362 @@ void test_log() {
     linfo() << "a\nbc\nd";
 }
 
+void test_async_log() {
+    assert_true(format_log_args("a{}b{}c", nullptr, nullptr, 0) == "a{}b{}c");
+    {
+        LogArgs args;
+        args.push_back(-3);
+        args.push_back(2.5);
+        args.push_back(true);
+        args.push_back('x');
+        assert_true(format_log_args("{} {} {} {} {}", args.types, args.values, args.nargs) == "-3 2.5 true x {}");
+    }
+    std::mutex mutex;
+    std::vector<std::pair<LogChannel, std::string>> lines;
+    auto sink = [&](LogChannel channel, std::string_view line){
+        std::scoped_lock lock{ mutex };
+        lines.emplace_back(channel, line);
+    };
+    auto long_line = std::string(3 * LOG_RECORD_TEXT_NBYTES, 'l');
+    {
+        AsyncLoggingGuard alg{ AsyncLogConfig{ .ring_capacity = 64, .sink = sink } };
+        assert_true(async_logging_enabled());
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < 4; ++t) {
+            threads.emplace_back([t](){
+                for (size_t i = 0; i < 3; ++i) {
+                    // Formatted on this thread, only written by the drain thread.
+                    linfo() << "Async thread " << t << ", message " << i;
+                    // Formatted by the drain thread.
+                    log_deferred(LogChannel::INFO, "Deferred thread {}, message {}", t, i);
+                }
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+        linfo() << long_line;
+        for (size_t i = 0; i < 3; ++i) {
+            LOG_RATE_LIMITED(1., linfo(), "Rate-limited message " << i);
+        }
+        flush_async_log();
+    }
+    assert_true(!async_logging_enabled());
+    assert_isequal<size_t>(lines.size(), 4 * 6 + 2);
+    // The messages of each thread keep their order.
+    for (size_t t = 0; t < 4; ++t) {
+        std::vector<std::string> expected;
+        for (size_t i = 0; i < 3; ++i) {
+            expected.push_back("Async thread " + std::to_string(t) + ", message " + std::to_string(i));
+            expected.push_back("Deferred thread " + std::to_string(t) + ", message " + std::to_string(i));
+        }
+        std::vector<std::string> actual;
+        for (const auto& [channel, line] : lines) {
+            if (line.find(" thread " + std::to_string(t) + ',') != std::string::npos) {
+                assert_true(channel == LogChannel::INFO);
+                actual.push_back(line);
+            }
+        }
+        assert_true(actual == expected);
+    }
+    assert_true(lines[4 * 6].second == long_line);
+    assert_true(lines[4 * 6 + 1].second == "Rate-limited message 0");
+
+    // Errors wait for the drain thread if the ring is full,
+    // while other messages are dropped and counted.
+    lines.clear();
+    auto ndropped = async_log_ndropped();
+    {
+        AsyncLoggingGuard alg{ AsyncLogConfig{
+            .ring_capacity = 64,
+            .drain_interval = std::chrono::milliseconds{ 1000 },
+            .sink = sink } };
+        for (size_t i = 0; i < 100; ++i) {
+            lerr() << "Error " << i;
+        }
+        for (size_t i = 0; i < 100; ++i) {
+            lwarn() << "Warning " << i;
+        }
+        flush_async_log();
+    }
+    assert_true(lines.size() > 100);
+    for (size_t i = 0; i < 100; ++i) {
+        assert_true(lines[i].first == LogChannel::ERROR);
+        assert_true(lines[i].second == "Error " + std::to_string(i));
+    }
+    auto nwarnings = lines.size() - 101;
+    assert_true(nwarnings < 100);
+    for (size_t i = 0; i < nwarnings; ++i) {
+        assert_true(lines[100 + i].second == "Warning " + std::to_string(i));
+    }
+    assert_isequal(async_log_ndropped() - ndropped, (uint64_t)(100 - nwarnings));
+    assert_true(lines.back().first == LogChannel::WARNING);
+    assert_true(lines.back().second == "Asynchronous logger dropped " + std::to_string(100 - nwarnings) + " message(s)");
+
+    LogRateLimiter limiter{ 1., 2. };
+    assert_true(limiter.allow());
+    assert_true(limiter.allow());
+    assert_true(!limiter.allow());
+    assert_true(limiter.take_nsuppressed() == 1);
+}
+
 void test_atomic_recursive_shared_mutex() {
     SafeAtomicRecursiveSharedMutex m;
     std::scoped_lock lock{ m };
     std::scoped_lock lock2{ m };
 }
 
+void test_atomic_mutex() {
+    AtomicMutex m;
+    size_t counter = 0;
+    {
+        std::vector<std::jthread> threads;
+        for (size_t t = 0; t < 4; ++t) {
+            threads.emplace_back([&](){
+                for (size_t i = 0; i < 10'000; ++i) {
+                    std::scoped_lock lock{ m };
+                    ++counter;
+                }
+            });
+        }
+    }
+    assert_isequal<size_t>(counter, 40'000);
+}
+
+void test_mutex_contention_counters() {
+    enable_mutex_profiling();
+    SafeAtomicSharedMutex m;
+    m.profile("test_mutex_contention_counters");
+    auto& s = *MutexContentionRegistry::instance().statistics("test_mutex_contention_counters");
+    s.reset();
+    {
+        std::scoped_lock lock{ m };
+    }
+    assert_isequal<uint64_t>(s.nacquisitions, 1);
+    assert_isequal<uint64_t>(s.ncontended, 0);
+    {
+        std::shared_lock lock{ m };
+        std::shared_lock lock2{ m };
+    }
+    assert_isequal<uint64_t>(s.nacquisitions, 3);
+    assert_isequal<uint64_t>(s.ncontended, 0);
+    // A writer that waits for a reader is counted as contended, and
+    // parks once its backoff is exhausted.
+    {
+        std::jthread writer;
+        {
+            std::shared_lock lock{ m };
+            writer = std::jthread{[&](){
+                std::scoped_lock lock{ m };
+            }};
+            // Release the reader only after the writer has parked.
+            while (s.nparked == 0) {
+                std::this_thread::yield();
+            }
+        }
+    }
+    assert_isequal<uint64_t>(s.nacquisitions, 5);
+    assert_isequal<uint64_t>(s.ncontended, 1);
+    assert_true(s.nparked >= 1);
+    assert_true(s.max_wait_time > 0);
+    assert_true(s.total_wait_time >= s.max_wait_time);
+    // Every acquisition is counted under contention.
+    s.reset();
+    size_t counter = 0;
+    {
+        std::vector<std::jthread> threads;
+        for (size_t t = 0; t < 4; ++t) {
+            threads.emplace_back([&](){
+                for (size_t i = 0; i < 10'000; ++i) {
+                    std::scoped_lock lock{ m };
+                    ++counter;
+                }
+            });
+        }
+    }
+    assert_isequal<size_t>(counter, 40'000);
+    assert_isequal<uint64_t>(s.nacquisitions, 40'000);
+    assert_true(s.ncontended <= s.nacquisitions);
+    assert_true(s.total_wait_time >= s.max_wait_time);
+}
+
+void test_shared_mutex_writer_starvation() {
+    enable_mutex_profiling();
+    SafeAtomicSharedMutex m;
+    m.profile("test_shared_mutex_writer_starvation");
+    auto& s = *MutexContentionRegistry::instance().statistics("test_shared_mutex_writer_starvation");
+    s.reset();
+    size_t a = 0;
+    size_t b = 0;
+    std::atomic_bool done = false;
+    std::atomic_bool inconsistent = false;
+    std::atomic<size_t> nreads = 0;
+    std::vector<std::jthread> readers;
+    for (size_t t = 0; t < 4; ++t) {
+        readers.emplace_back([&](){
+            while (!done) {
+                std::shared_lock lock{ m };
+                if (a != b) {
+                    inconsistent = true;
+                }
+                // The readers overlap, s.t. the reader count never
+                // drops to zero without the writer preference.
+                auto end = std::chrono::steady_clock::now() + std::chrono::microseconds(20);
+                while (std::chrono::steady_clock::now() < end);
+                ++nreads;
+            }
+        });
+    }
+    while (nreads < 100) {
+        std::this_thread::yield();
+    }
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < 1'000; ++i) {
+        std::scoped_lock lock{ m };
+        ++a;
+        ++b;
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    done = true;
+    readers.clear();
+    assert_true(!inconsistent);
+    assert_isequal<size_t>(a, 1'000);
+    // Every read and write is counted, readers that were interrupted
+    // by "done" might not have incremented "nreads".
+    assert_true(s.nacquisitions >= 1'000 + nreads);
+    assert_true(s.nacquisitions <= 1'000 + nreads + 4);
+    assert_true(s.ncontended > 0);
+    assert_true(s.total_wait_time >= s.max_wait_time);
+    // 16-110ms on a single core.
+    assert_true(elapsed < std::chrono::seconds(1));
+    assert_true(s.max_wait_time < 1'000'000'000);
+}
+
+void test_shared_mutex_recursive_reentry() {
+    enable_mutex_profiling();
+    SafeAtomicRecursiveSharedMutex m;
+    m.profile("test_shared_mutex_recursive_reentry");
+    auto& s = *MutexContentionRegistry::instance().statistics("test_shared_mutex_recursive_reentry");
+    s.reset();
+    // Exclusive owner re-enters exclusively and shared.
+    {
+        std::scoped_lock lock{ m };
+        std::scoped_lock lock2{ m };
+        std::shared_lock lock3{ m };
+        assert_true(m.is_owner());
+    }
+    assert_true(!m.is_owner());
+    // A reader re-enters while a writer is waiting.
+    std::atomic_bool written = false;
+    std::jthread writer;
+    {
+        std::shared_lock lock{ m };
+        writer = std::jthread{[&](){
+            std::scoped_lock lock{ m };
+            written = true;
+        }};
+        while (s.nparked == 0) {
+            std::this_thread::yield();
+        }
+        std::shared_lock lock2{ m };
+        assert_true(!written);
+    }
+    writer.join();
+    assert_true(written);
+    // The writer waited for the reader.
+    assert_true(s.ncontended >= 1);
+    assert_true(s.nparked >= 1);
+    assert_true(s.max_wait_time > 0);
+}
+
+void test_string_atom() {
+    StringAtom a{ "test_string_atom_a" };
+    StringAtom b{ VariableAndHash<std::string>{ "test_string_atom_b" } };
+    assert_true(a == StringAtom{ "test_string_atom_a" });
+    assert_true(a != b);
+    assert_true(a < b);
+    assert_true(*b == "test_string_atom_b");
+    assert_true(*StringAtom() == "");
+    assert_isequal(a.hash(), VariableAndHash<std::string>{ "test_string_atom_a" }.hash());
+    assert_true(a.variable_and_hash() == VariableAndHash<std::string>{ "test_string_atom_a" });
+    assert_true(StringAtom::try_find("test_string_atom_a") == a);
+    assert_true(!StringAtom::try_find("test_string_atom_c").has_value());
+    assert_true(StringAtom::try_find(VariableAndHash<std::string>{ "test_string_atom_b" }) == b);
+    StringAtomUnorderedMap<int> m{ "Value" };
+    m.add(a, 1);
+    m.add(b, 2);
+    assert_isequal(m.get(StringAtom{ "test_string_atom_b" }), 2);
+    std::vector<std::vector<uint32_t>> ids(4);
+    {
+        std::vector<std::jthread> threads;
+        for (auto& tids : ids) {
+            threads.emplace_back([&tids](){
+                for (size_t i = 0; i < 1'000; ++i) {
+                    tids.push_back(StringAtom{ "test_string_atom_" + std::to_string(i) }.id());
+                }
+            });
+        }
+    }
+    for (const auto& tids : ids) {
+        assert_true(tids == ids[0]);
+    }
+    // The lookup index has grown while interning.
+    for (size_t i = 0; i < 1'000; ++i) {
+        auto atom = StringAtom::try_find(VariableAndHash<std::string>{ "test_string_atom_" + std::to_string(i) });
+        assert_true(atom.has_value());
+        assert_isequal(atom->id(), ids[0][i]);
+    }
+}
+
+void test_rcu_map() {
+    RcuStringWithHashUnorderedMap<std::unique_ptr<int>> m{ "Value" };
+    std::vector<VariableAndHash<std::string>> keys;
+    for (int i = 0; i < 1'000; ++i) {
+        keys.emplace_back("test_rcu_map_" + std::to_string(i));
+    }
+    const auto& first = m.add(keys[0], std::make_unique<int>(0));
+    std::atomic_bool finished = false;
+    std::atomic_bool failed = false;
+    {
+        std::vector<std::jthread> readers;
+        for (size_t t = 0; t < 4; ++t) {
+            readers.emplace_back([&](){
+                while (!finished) {
+                    for (size_t i = 0; i < keys.size(); i += 97) {
+                        if (auto* v = m.try_get(keys[i]); (v != nullptr) && (**v != (int)i)) {
+                            failed = true;
+                        }
+                    }
+                }
+            });
+        }
+        for (int i = 1; i < (int)keys.size(); ++i) {
+            m.add(keys[(size_t)i], std::make_unique<int>(i));
+        }
+        finished = true;
+    }
+    assert_true(!failed);
+    assert_isequal(m.size(), keys.size());
+    assert_isequal(m.keys().size(), keys.size());
+    // References survive later writes.
+    assert_true(&first == &m.get(keys[0]));
+    assert_isequal(*first, 0);
+    assert_true(!m.try_emplace(keys[1], std::make_unique<int>(-1)).second);
+    assert_isequal(*m.get(keys[1]), 1);
+    bool thrown = false;
+    try {
+        m.add(keys[2], std::make_unique<int>(-1));
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert_true(thrown);
+    assert_isequal(m.erase(keys[3]), size_t{ 1 });
+    assert_isequal(m.erase(keys[3]), size_t{ 0 });
+    assert_true(!m.contains(keys[3]));
+    m.clear();
+    assert_true(m.empty());
+}
+
 void test_chunked_array() {
     ChunkedArray<std::list<std::vector<int>>> ar{ 3 };
     for (const auto& e : ar) { linfo() << e; }; linfo() << "-";
@@ -272,6 +831,25 @@ void test_chunked_array() {
     for (const auto& e : ar) { linfo() << e; }; linfo() << "-";
     ar.emplace_back(9);
     for (const auto& e : ar) { linfo() << e; }; linfo() << "-";
+    {
+        using Array = ChunkedArray<std::list<std::vector<std::unique_ptr<int>>>>;
+        Array a{ 3 };
+        Array b{ 3 };
+        Array c{ 3 };
+        for (int i = 0; i < 4; ++i) {
+            a.emplace_back(std::make_unique<int>(i));
+            b.emplace_back(std::make_unique<int>(4 + i));
+        }
+        c.extend(std::move(a));
+        c.extend(std::move(b));
+        assert_true(a.empty());
+        assert_true(b.empty());
+        assert_isequal(c.size(), size_t{ 8 });
+        int i = 0;
+        for (const auto& e : c) {
+            assert_isequal(*e, i++);
+        }
+    }
 }
 
 void test_thread_safe_list() {
@@ -333,12 +911,23 @@ int main(int argc, const char** argv) {
         test_parallel_block();
         test_destruction_functions();
         test_dangling_base_class();
+        test_dangling_references();
         test_object_pool_std();
         test_object_pool_unique();
+        test_object_pool_destruction_order();
+        test_object_pool_ownership_transfer();
+        test_slab_allocator();
         test_dangling_unique2();
         test_try_find();
         test_log();
+        test_async_log();
         test_atomic_recursive_shared_mutex();
+        test_atomic_mutex();
+        test_mutex_contention_counters();
+        test_shared_mutex_writer_starvation();
+        test_shared_mutex_recursive_reentry();
+        test_string_atom();
+        test_rcu_map();
     } catch (const std::exception& e) {
         lerr() << "Test failed: " << e.what();
         return 1;
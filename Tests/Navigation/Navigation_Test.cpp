@@ -0,0 +1,170 @@
+#include <Mlib/Geometry/Material.hpp>
+#include <Mlib/Geometry/Mesh/Colored_Vertex_Array.hpp>
+#include <Mlib/Geometry/Mesh/Indexed_Face_Set.hpp>
+#include <Mlib/Geometry/Mesh/Triangle_List.hpp>
+#include <Mlib/Geometry/Modifier_Backlog.hpp>
+#include <Mlib/Geometry/Morphology.hpp>
+#include <Mlib/Math/Fixed_Math.hpp>
+#include <Mlib/Math/Fixed_Test.hpp>
+#include <Mlib/Math/Math.hpp>
+#include <Mlib/Misc/Floating_Point_Exceptions.hpp>
+#include <Mlib/Navigation/InputGeom.hpp>
+#include <Mlib/Navigation/Navigation_Mesh_Builder.hpp>
+#include <Mlib/Navigation/Sample_TileMesh.hpp>
+#include <Mlib/Navigation/StderrContext.hpp>
+#include <Mlib/Os/Os.hpp>
+#include <chrono>
+#include <filesystem>
+
+using namespace Mlib;
+namespace fs = std::filesystem;
+
+// Square blocks with buildings, separated by streets, with the
+// y-axis pointing upwards.
+static IndexedFaceSet<float, float, size_t> grid_city(
+    size_t nblocks,
+    float block_size,
+    float street_width)
+{
+    TriangleList<float> tl{ "city", Material{}, Morphology{}, ModifierBacklog{} };
+    float extent = block_size * (float)nblocks;
+    size_t nground = 4 * nblocks;
+    float ground_size = extent / (float)nground;
+    for (size_t r = 0; r < nground; ++r) {
+        for (size_t c = 0; c < nground; ++c) {
+            float x0 = ground_size * (float)c;
+            float z0 = ground_size * (float)r;
+            float x1 = x0 + ground_size;
+            float z1 = z0 + ground_size;
+            tl.draw_rectangle_wo_normals({ x0, 0.f, z0 }, { x0, 0.f, z1 }, { x1, 0.f, z1 }, { x1, 0.f, z0 });
+        }
+    }
+    for (size_t r = 0; r < nblocks; ++r) {
+        for (size_t c = 0; c < nblocks; ++c) {
+            float x0 = block_size * (float)c + 0.5f * street_width;
+            float z0 = block_size * (float)r + 0.5f * street_width;
+            float x1 = x0 + block_size - street_width;
+            float z1 = z0 + block_size - street_width;
+            float h = 10.f;
+            tl.draw_rectangle_wo_normals({ x0, 0.f, z0 }, { x0, h, z0 }, { x0, h, z1 }, { x0, 0.f, z1 });
+            tl.draw_rectangle_wo_normals({ x1, 0.f, z1 }, { x1, h, z1 }, { x1, h, z0 }, { x1, 0.f, z0 });
+            tl.draw_rectangle_wo_normals({ x1, 0.f, z0 }, { x1, h, z0 }, { x0, h, z0 }, { x0, 0.f, z0 });
+            tl.draw_rectangle_wo_normals({ x0, 0.f, z1 }, { x0, h, z1 }, { x1, h, z1 }, { x1, 0.f, z1 });
+            tl.draw_rectangle_wo_normals({ x0, h, z0 }, { x0, h, z1 }, { x1, h, z1 }, { x1, h, z0 });
+        }
+    }
+    return IndexedFaceSet<float, float, size_t>{ tl.triangle_array()->triangles };
+}
+
+static float path_length(const std::list<FixedArray<float, 3>>& path) {
+    float result = 0.f;
+    for (auto it = path.begin(); std::next(it) != path.end(); ++it) {
+        result += std::sqrt(sum(squared(*std::next(it) - *it)));
+    }
+    return result;
+}
+
+// Shortest path between two street crossings, or an empty list.
+static std::list<FixedArray<float, 3>> crossing_path(
+    const NavigationMeshQuery& navmesh,
+    float block_size,
+    size_t r0,
+    size_t c0,
+    size_t r1,
+    size_t c1)
+{
+    auto localize = [&](size_t r, size_t c) {
+        auto p = navmesh.closest_point_on_navmesh({ block_size * (float)c, 0.f, block_size * (float)r });
+        if (!p.has_value()) {
+            throw std::runtime_error("Could not localize crossing");
+        }
+        return *p;
+    };
+    return navmesh.shortest_path(localize(r0, c0), localize(r1, c1), 2.f);
+}
+
+void test_tiled_navmesh() {
+    size_t nblocks = 6;
+    float block_size = 20.f;
+    auto city = grid_city(nblocks, block_size, 8.f);
+    NavigationMeshBuilder solo{ city, NavigationMeshConfig{
+        .cell_size = 0.5f,
+        .agent_radius = 0.6f } };
+    NavigationMeshBuilder tiled{ city, NavigationMeshConfig{
+        .cell_size = 0.5f,
+        .agent_radius = 0.6f,
+        .tile_size = 32.f } };
+    assert_true(tiled.tiled() != nullptr);
+    assert_true(tiled.tiled()->ntiles_x() > 1);
+    // Paths between inner crossings, the tiles must be connected.
+    for (size_t r0 = 1; r0 < nblocks; r0 += 2) {
+        for (size_t c0 = 1; c0 < nblocks; c0 += 2) {
+            size_t r1 = nblocks - r0;
+            size_t c1 = (c0 + 2) % nblocks;
+            if ((r0 == r1) && (c0 == c1)) {
+                continue;
+            }
+            auto ps = crossing_path(solo.query(), block_size, r0, c0, r1, c1);
+            auto pt = crossing_path(tiled.query(), block_size, r0, c0, r1, c1);
+            assert_true(ps.size() > 1);
+            assert_true(pt.size() > 1);
+            assert_allclose(pt.back(), ps.back(), 1e-3f);
+            // Manhattan distance, the streets are axis-aligned.
+            float expected = block_size * (float)(
+                (r0 > r1 ? r0 - r1 : r1 - r0) + (c0 > c1 ? c0 - c1 : c1 - c0));
+            assert_isclose(path_length(ps), expected, 0.1f * expected);
+            assert_isclose(path_length(pt), path_length(ps), 0.05f * expected);
+        }
+    }
+}
+
+void test_navmesh_tile_cache() {
+    auto city = grid_city(4, 20.f, 8.f);
+    StderrContext ctx;
+    InputGeom geom;
+    if (!geom.load(&ctx, city)) {
+        throw std::runtime_error("Could not load navmesh geometry");
+    }
+    Sample_TileMesh stm{ ctx, geom };
+    stm.m_cellSize = 0.5f;
+    stm.m_tileSize = 32.f;
+    // Entries of previous runs would turn the first build into hits.
+    fs::remove_all("TestOut/NavmeshCache");
+    stm.m_cacheDirectory = "TestOut/NavmeshCache";
+    assert_true(stm.build());
+    assert_isequal(stm.ncache_hits(), (size_t)0);
+    assert_true(stm.build());
+    assert_isequal(stm.ncache_hits(), (size_t)(stm.ntiles_x() * stm.ntiles_y()));
+    assert_true(stm.rebuild_tiles(geom, { 30.f, 0.f, 30.f }, { 31.f, 0.f, 31.f }));
+    assert_true(stm.ncache_hits() > 0);
+    auto p = stm.query().closest_point_on_navmesh({ 40.f, 0.f, 40.f });
+    assert_true(p.has_value());
+}
+
+void test_navmesh_build_time() {
+    auto city = grid_city(16, 20.f, 8.f);
+    for (int nthreads : { 1, 2, 4 }) {
+        auto start = std::chrono::steady_clock::now();
+        NavigationMeshBuilder nmb{ city, NavigationMeshConfig{
+            .cell_size = 0.5f,
+            .agent_radius = 0.6f,
+            .tile_size = 64.f,
+            .nthreads = nthreads } };
+        auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        linfo() << "Tiled navmesh, " << nthreads << " thread(s): " << elapsed << " ms";
+    }
+}
+
+int main(int argc, const char** argv) {
+    enable_floating_point_exceptions();
+
+    try {
+        test_tiled_navmesh();
+        test_navmesh_tile_cache();
+        test_navmesh_build_time();
+    } catch (const std::runtime_error& e) {
+        lerr() << e.what();
+        return 1;
+    }
+    return 0;
+}
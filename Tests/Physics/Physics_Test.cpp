@@ -1,21 +1,48 @@
+#include <Mlib/Geometry/Graph/Point_And_Flags.hpp>
+#include <Mlib/Geometry/Graph/Points_And_Adjacency_Impl.hpp>
+#include <Mlib/Geometry/Material.hpp>
+#include <Mlib/Geometry/Primitives/Bounding_Sphere.hpp>
+#include <Mlib/Geometry/Primitives/Heightfield.hpp>
+#include <Mlib/Geometry/Mesh/Colored_Vertex_Array.hpp>
+#include <Mlib/Geometry/Mesh/Triangle_List.hpp>
+#include <Mlib/Geometry/Modifier_Backlog.hpp>
+#include <Mlib/Geometry/Morphology.hpp>
 #include <Mlib/Math/Fixed_Rodrigues.hpp>
 #include <Mlib/Math/Fixed_Scaled_Unit_Vector.hpp>
 #include <Mlib/Math/Fixed_Test.hpp>
 #include <Mlib/Math/Pi.hpp>
 #include <Mlib/Memory/Object_Pool.hpp>
 #include <Mlib/Misc/Floating_Point_Exceptions.hpp>
+#include <Mlib/Physics/Ai/Kinematic_Traffic.hpp>
+#include <Mlib/Physics/Bullets/Projectile_Pool.hpp>
 #include <Mlib/Physics/Collision/Pacejkas_Magic_Formula.hpp>
 #include <Mlib/Physics/Collision/Power_To_Force.hpp>
+#include <Mlib/Physics/Collision/Resolve/Constraints.hpp>
+#include <Mlib/Physics/Collision/Resolve/Contact_Cache.hpp>
+#include <Mlib/Physics/Collision/Collidable_Mode.hpp>
+#include <Mlib/Physics/Containers/Collision_Query.hpp>
+#include <Mlib/Physics/Containers/Ray_Query_Batch.hpp>
+#include <Mlib/Physics/Dynamic_Lights/Light_Clusters.hpp>
 #include <Mlib/Physics/Misc/Aim.hpp>
 #include <Mlib/Physics/Misc/Beacon.hpp>
 #include <Mlib/Physics/Misc/Gravity_Efp.hpp>
 #include <Mlib/Physics/Misc/Track_Element.hpp>
+#include <Mlib/Physics/Misc/Track_Element_Binary_File.hpp>
+#include <Mlib/Physics/Misc/Track_Element_Extended.hpp>
+#include <Mlib/Physics/Misc/Track_Reader.hpp>
+#include <Mlib/Physics/Misc/Track_Writer.hpp>
 #include <Mlib/Physics/Physics_Engine/Physics_Engine.hpp>
 #include <Mlib/Physics/Physics_Engine/Physics_Phase.hpp>
+#include <Mlib/Physics/Rigid_Body/Rigid_Body_Pulses.hpp>
 #include <Mlib/Physics/Rigid_Body/Rigid_Body_Vehicle.hpp>
 #include <Mlib/Physics/Rigid_Body/Rigid_Primitives.hpp>
 #include <Mlib/Scene_Graph/Instances/Static_World.hpp>
+#include <Mlib/Scene_Graph/Interfaces/Way_Points.hpp>
+#include <Mlib/Scene_Graph/Way_Point_Location.hpp>
 #include <Mlib/Stats/Linspace.hpp>
+#include <Mlib/Stats/Random_Number_Generators.hpp>
+#include <algorithm>
+#include <map>
 
 using namespace Mlib;
 
@@ -206,6 +233,98 @@ void test_com() {
         r1->velocity_at_position(com1.casted<ScenePos>()));
 }
 
+// Box resting on a slightly tilted ground, s.t. both the normal- and
+// the friction-contacts are active. Returns the residuals of the
+// final substep for every iteration.
+static std::vector<float> contact_residuals(
+    bool warm_start,
+    size_t niterations,
+    float& final_height)
+{
+    float dt = 0.01667f * seconds / 8.f;
+    auto rbp = rigid_cuboid_pulses(100.f * kg, {2.f * meters, 1.f * meters, 2.f * meters});
+    rbp.set_pose(fixed_identity_array<float, 3>(), {0., 0.5 * meters, 0.}, 1.f, CURRENT_SOURCE_LOCATION);
+    CollisionGroup group{
+        .penetration_class = PenetrationClass::STANDARD,
+        .nsubsteps = 8,
+        .divider = 1,
+        .rigid_bodies = { &rbp }
+    };
+    FixedArray<float, 3> g{ 0.5f, -9.8f, 0.f };
+    g *= meters / (seconds * seconds);
+    ContactCache cache;
+    std::vector<float> residuals;
+    for (size_t step = 0; step < 200; ++step) {
+        rbp.integrate_delta_v(g * dt, dt, CURRENT_SOURCE_LOCATION);
+        std::list<std::unique_ptr<IContactInfo>> cis;
+        for (size_t i = 0; i < 4; ++i) {
+            auto p = rbp.transform_to_world_coordinates({
+                (i & 1) ? 1.f * meters : -1.f * meters,
+                -0.5f * meters,
+                (i & 2) ? 1.f * meters : -1.f * meters});
+            auto nci = std::make_unique<NormalContactInfo1>(
+                rbp,
+                BoundedPlaneInequalityConstraint{
+                    .constraint{
+                        .normal_impulse{.normal = {0.f, 1.f, 0.f}},
+                        .overlap = (float)-p(1),
+                        .slop = 0.001f,
+                    },
+                    .lambda_max = 0},
+                p);
+            auto fci = std::make_unique<FrictionContactInfo1>(
+                rbp,
+                nci->normal_impulse(),
+                p,
+                2.f,
+                1.6f,
+                fixed_zeros<float, 3>());
+            ContactCacheKey key{ .body0 = &rbp, .body1 = nullptr, .position{ (int32_t)i, 0, 0 } };
+            cache.bind(key, *nci);
+            cache.bind(key, *fci);
+            cis.push_back(std::move(nci));
+            cis.push_back(std::move(fci));
+        }
+        if (warm_start) {
+            cache.warm_start(dt, 1.f);
+        }
+        solve_contacts(cis, dt, niterations, &residuals);
+        cache.store(dt, group, 64);
+        rbp.advance_time(dt);
+    }
+    final_height = (float)rbp.abs_position(1);
+    return residuals;
+}
+
+static size_t iterations_to_converge(const std::vector<float>& residuals, float tolerance) {
+    for (size_t i = 0; i < residuals.size(); ++i) {
+        if (residuals[i] < tolerance) {
+            return i + 1;
+        }
+    }
+    return SIZE_MAX;
+}
+
+void test_contact_warm_start() {
+    float cold_height;
+    float warm_height;
+    auto cold = contact_residuals(false, 50, cold_height);
+    auto warm = contact_residuals(true, 50, warm_height);
+    // 1/1000 of the impulse required to hold the box.
+    float tolerance = 100.f * kg * 9.8f * meters / (seconds * seconds) * 0.01667f * seconds / 8.f * 1e-3f;
+    size_t ncold = iterations_to_converge(cold, tolerance);
+    size_t nwarm = iterations_to_converge(warm, tolerance);
+    assert_true(nwarm < ncold);
+    assert_true(3 * nwarm <= ncold);
+    assert_isclose<float>(warm_height, cold_height, 1e-3f);
+    {
+        // Stable with few iterations.
+        float height;
+        contact_residuals(true, nwarm, height);
+        assert_isclose<float>(height, cold_height, 1e-3f);
+    }
+}
+
 void test_magic_formula() {
     {
         PacejkasMagicFormulaArgmax<float> mf{PacejkasMagicFormula<float>{}};
@@ -243,6 +362,533 @@ void test_track_element() {
     assert_allequal(te.transformation().rotation, te2.transformation().rotation);
 }
 
+void test_track_binary() {
+    auto identity = TransformationMatrix<double, double, 3>::identity();
+    std::vector<TrackElement> track;
+    for (size_t i = 0; i < 200; ++i) {
+        auto t = (float)i / 60.f;
+        track.push_back(TrackElement{
+            .elapsed_seconds = t,
+            .transformations = {
+                UOffsetAndTaitBryanAngles<float, ScenePos, 3>{
+                    FixedArray<float, 3>{0.f, 0.1f * t, 0.f},
+                    FixedArray<ScenePos, 3>{100.f * std::cos(t), 2.f, 100.f * std::sin(t)}},
+                UOffsetAndTaitBryanAngles<float, ScenePos, 3>{
+                    FixedArray<float, 3>{0.f, 0.f, -0.2f * t},
+                    FixedArray<ScenePos, 3>{-5.f * t, 0.f, 3.f}}}});
+    }
+    {
+        TrackWriter writer{ "TestOut/track.mtrk", &identity };
+        for (const auto& e : track) {
+            writer.write(e);
+        }
+        writer.flush();
+    }
+    TrackElementBinaryFile file{ "TestOut/track.mtrk" };
+    assert_isequal<size_t>(file.nframes(), track.size());
+    std::optional<TrackElementExtended> predecessor;
+    for (const auto& e : track) {
+        predecessor = file.read(predecessor, identity, 2);
+        assert_isequal(predecessor->element.elapsed_seconds, e.elapsed_seconds);
+        for (size_t i = 0; i < 2; ++i) {
+            assert_allclose(predecessor->element.transformations[i].position, e.transformations[i].position, (ScenePos)1e-3);
+            assert_allclose(predecessor->element.transformations[i].rotation, e.transformations[i].rotation, 1e-4f);
+        }
+    }
+    file.read(predecessor, identity, 2);
+    assert_true(file.eof());
+    file.seek(track[150].elapsed_seconds + 1e-3f);
+    assert_isequal(file.read(std::nullopt, identity, 2).element.elapsed_seconds, track[150].elapsed_seconds);
+    file.seek(-1.f);
+    assert_isequal(file.read(std::nullopt, identity, 2).element.elapsed_seconds, track[0].elapsed_seconds);
+
+    // Playback jumps and rewinds by seeking, and only reads
+    // the two elements around the new time.
+    TrackReader reader{
+        std::make_unique<TrackElementBinaryFile>("TestOut/track.mtrk"),
+        0,  // nframes
+        1,  // nlaps
+        &identity,
+        TrackElementInterpolationKey::ELAPSED_SECONDS,
+        TrackReaderInterpolationMode::LINEAR,
+        2};
+    size_t nread = 0;
+    auto count = [&nread](const TrackElementExtended&){ ++nread; };
+    for (size_t i : {150, 10, 11, 180}) {
+        nread = 0;
+        double progress = 0.5 * (track[i].elapsed_seconds + track[i + 1].elapsed_seconds);
+        assert_true(reader.read(progress, count));
+        assert_isequal<size_t>(nread, 2);
+        assert_isequal<size_t>(reader.frame_id(), i + 2);
+        assert_isclose<double>(reader.track_element().element.elapsed_seconds, progress, 1e-6);
+    }
+}
+
+void test_projectile_pool() {
+    PhysicsEngineConfig cfg;
+    PhysicsEngine engine{ cfg, std::nullopt };
+    CollisionQuery collision_query{ engine };
+    ProjectilePool pool;
+    auto short_lived = pool.add_properties({ .max_lifetime = 0.1f * seconds });
+    auto long_lived = pool.add_properties({ .max_lifetime = 1.f * seconds, .drag_coefficient = 1e-3f / meters });
+    for (uint32_t i = 0; i < 10; ++i) {
+        pool.fire(
+            { 0., 100. * meters, 0. },
+            { 0.f, 0.f, 300.f * meters / seconds },
+            (i % 2 == 0) ? short_lived : long_lived,
+            nullptr,    // owner
+            i);         // tag
+    }
+    FixedArray<float, 3> g{ 0.f, -9.8f * meters / (seconds * seconds), 0.f };
+    std::vector<uint32_t> removed;
+    auto advance = [&](size_t nsteps) {
+        for (size_t i = 0; i < nsteps; ++i) {
+            pool.advance_time(
+                cfg.dt,
+                g,
+                fixed_zeros<float, 3>(),
+                collision_query,
+                [](const ProjectileHit&){ throw std::runtime_error("Unexpected projectile hit"); },
+                [&removed](uint32_t tag){ removed.push_back(tag); });
+        }
+    };
+    advance(10);
+    assert_isequal(pool.size(), (size_t)5);
+    std::sort(removed.begin(), removed.end());
+    assert_true((removed == std::vector<uint32_t>{ 0, 2, 4, 6, 8 }));
+    advance(60);
+    assert_isequal(pool.size(), (size_t)0);
+    assert_isequal(removed.size(), (size_t)10);
+}
+
+// Adds a dynamic cube with a convex hitbox to the engine.
+static std::unique_ptr<RigidBodyVehicle, DeleteFromPool<RigidBodyVehicle>> add_convex_cube(
+    PhysicsEngine& engine,
+    const std::string& name,
+    const FixedArray<ScenePos, 3>& position,
+    float half_width)
+{
+    TriangleList<float> tl{
+        name,
+        Material{},
+        Morphology{ .physics_material = PhysicsMaterial::OBJ_CHASSIS | PhysicsMaterial::ATTR_COLLIDE | PhysicsMaterial::ATTR_CONVEX },
+        ModifierBacklog{} };
+    for (size_t axis = 0; axis < 3; ++axis) {
+        for (float sign : { -1.f, 1.f }) {
+            auto n = fixed_zeros<float, 3>();
+            auto u = fixed_zeros<float, 3>();
+            auto v = fixed_zeros<float, 3>();
+            n(axis) = sign * half_width;
+            u((axis + 1) % 3) = half_width;
+            v((axis + 2) % 3) = half_width;
+            if (sign < 0.f) {
+                std::swap(u, v);
+            }
+            tl.draw_rectangle_wo_normals(n - u - v, n + u - v, n + u + v, n - u + v);
+        }
+    }
+    auto rb = rigid_cuboid(name, name, 100.f * kg, fixed_full<float, 3>(2.f * half_width));
+    rb->set_absolute_model_matrix(
+        TransformationMatrix<float, ScenePos, 3>{ fixed_identity_array<float, 3>(), position },
+        CURRENT_SOURCE_LOCATION);
+    engine.rigid_bodies_.add_rigid_body(
+        *rb,
+        { tl.triangle_array() },
+        {},
+        {},
+        CollidableMode::COLLIDE | CollidableMode::MOVE);
+    return rb;
+}
+
+void test_projectile_pool_hit() {
+    PhysicsEngineConfig cfg;
+    PhysicsEngine engine{ cfg, std::nullopt };
+    // The projectiles start behind the owner, s.t. they pass through
+    // it unless it is excluded.
+    auto owner = add_convex_cube(engine, "owner", { 0., 0., 0. }, 1.f * meters);
+    auto target = add_convex_cube(engine, "target", { 0., 0., 50. * meters }, 1.f * meters);
+    CollisionQuery collision_query{ engine };
+    ProjectilePool pool;
+    auto properties = pool.add_properties({ .max_lifetime = 1.f * seconds });
+    FixedArray<float, 3> v0{ 0.f, 0.f, 300.f * meters / seconds };
+    pool.fire({ 0., 0., -5. * meters }, v0, properties, owner.get(), 0);
+    pool.fire({ 0., 0., -5. * meters }, v0, properties, nullptr, 1);
+    std::map<uint32_t, ProjectileHit> hits;
+    std::vector<uint32_t> removed;
+    for (size_t i = 0; (i < 60) && (pool.size() != 0); ++i) {
+        pool.advance_time(
+            cfg.dt,
+            fixed_zeros<float, 3>(),
+            fixed_zeros<float, 3>(),
+            collision_query,
+            [&hits](const ProjectileHit& hit){
+                if (!hits.try_emplace(hit.tag, hit).second) {
+                    throw std::runtime_error("Duplicate projectile hit");
+                }
+            },
+            [&removed](uint32_t tag){ removed.push_back(tag); });
+    }
+    assert_isequal(pool.size(), (size_t)0);
+    assert_isequal(hits.size(), (size_t)2);
+    std::sort(removed.begin(), removed.end());
+    assert_true((removed == std::vector<uint32_t>{ 0, 1 }));
+    // The owner is excluded, so the first projectile hits the target.
+    const auto& h0 = hits.at(0);
+    assert_true(&h0.rigid_body == target.get());
+    assert_isclose<ScenePos>(h0.position(2), 49. * meters, 1e-3);
+    assert_allclose(h0.velocity, v0);
+    assert_true(any(h0.physics_material & PhysicsMaterial::ATTR_CONVEX));
+    assert_isequal(h0.properties, properties);
+    // Without owner, the second projectile hits the owner's back.
+    const auto& h1 = hits.at(1);
+    assert_true(&h1.rigid_body == owner.get());
+    assert_isclose<ScenePos>(h1.position(2), -1. * meters, 1e-3);
+}
+
+void test_projectile_pool_drag() {
+    PhysicsEngineConfig cfg;
+    PhysicsEngine engine{ cfg, std::nullopt };
+    auto target = add_convex_cube(engine, "target", { 0., 0., 200. * meters }, 1.f * meters);
+    CollisionQuery collision_query{ engine };
+    float k = 1e-3f / meters;
+    float v0 = 300.f * meters / seconds;
+    // Returns the speed on impact.
+    auto speed = [&](const FixedArray<float, 3>& wind) {
+        ProjectilePool pool;
+        auto properties = pool.add_properties({ .max_lifetime = 10.f * seconds, .drag_coefficient = k });
+        pool.fire(fixed_zeros<ScenePos, 3>(), { 0.f, 0.f, v0 }, properties, nullptr, 0);
+        float result = NAN;
+        for (size_t i = 0; (i < 1000) && (pool.size() != 0); ++i) {
+            pool.advance_time(
+                cfg.dt,
+                fixed_zeros<float, 3>(),
+                wind,
+                collision_query,
+                [&](const ProjectileHit& hit){
+                    assert_true(&hit.rigid_body == target.get());
+                    result = std::sqrt(sum(squared(hit.velocity)));
+                });
+        }
+        return result;
+    };
+    // dv/dx = -k v => v(x) = v0 exp(-k x), with the front face at 199 m.
+    float v1 = v0 * std::exp(-k * 199.f * meters);
+    assert_isclose(speed(fixed_zeros<float, 3>()), v1, 0.01f * v1);
+    // No drag when moving with the wind.
+    assert_isclose(speed({ 0.f, 0.f, v0 }), v0, 1e-3f);
+}
+
+void test_ray_query_batch() {
+    using RigidBodyPtr = std::unique_ptr<RigidBodyVehicle, DeleteFromPool<RigidBodyVehicle>>;
+    PhysicsEngineConfig cfg;
+    PhysicsEngine engine{ cfg, std::nullopt };
+    std::vector<RigidBodyPtr> bodies;
+    auto add = [&](float mass, const FixedArray<ScenePos, 3>& position, const auto& draw) {
+        auto name = "body" + std::to_string(bodies.size());
+        // Bodies with finite mass are added as moving objects,
+        // which must be convex.
+        bool is_static = (mass == INFINITY);
+        TriangleList<float> tl{
+            name,
+            Material{},
+            Morphology{ .physics_material = PhysicsMaterial::OBJ_CHASSIS | PhysicsMaterial::ATTR_COLLIDE | (is_static ? PhysicsMaterial::ATTR_CONCAVE : PhysicsMaterial::ATTR_CONVEX) },
+            ModifierBacklog{} };
+        draw(tl);
+        auto rb = rigid_cuboid(name, name, mass, fixed_ones<float, 3>());
+        rb->set_absolute_model_matrix(
+            TransformationMatrix<float, ScenePos, 3>{ fixed_identity_array<float, 3>(), position },
+            CURRENT_SOURCE_LOCATION);
+        engine.rigid_bodies_.add_rigid_body(
+            *rb,
+            { tl.triangle_array() },
+            {},
+            {},
+            is_static ? CollidableMode::COLLIDE : (CollidableMode::COLLIDE | CollidableMode::MOVE));
+        bodies.push_back(std::move(rb));
+    };
+    // Terrain with a ridge.
+    add(INFINITY, fixed_zeros<ScenePos, 3>(), [](TriangleList<float>& tl){
+        auto v = [](float x, float z) {
+            return FixedArray<float, 3>{ x, 5.f * std::abs(std::sin(0.1f * x)), z };
+        };
+        for (float x = -50.f; x < 50.f; x += 10.f) {
+            for (float z = -50.f; z < 50.f; z += 10.f) {
+                tl.draw_rectangle_wo_normals(v(x, z), v(x, z + 10.f), v(x + 10.f, z + 10.f), v(x + 10.f, z));
+            }
+        }
+    });
+    // Static and moving walls.
+    for (float mass : { INFINITY, 1000.f * kg }) {
+        for (ScenePos x : { -20., 20. }) {
+            add(mass, { x, 0., mass == INFINITY ? 0. : 20. }, [](TriangleList<float>& tl){
+                tl.draw_rectangle_wo_normals(
+                    { 0.f, 0.f, -10.f },
+                    { 0.f, 0.f, 10.f },
+                    { 0.f, 20.f, 10.f },
+                    { 0.f, 20.f, -10.f });
+            });
+        }
+    }
+    NormalRandomNumberGenerator<ScenePos> r{ 2, 0., 30. };
+    RayQueryBatch batch{ engine };
+    for (size_t i = 0; i < 200; ++i) {
+        batch.add(RayQuery{
+            .start = { r(), std::abs(r()) + 1., r() },
+            .stop = { r(), std::abs(r()) + 1., r() }});
+    }
+    batch.run(RayQueryMode::CLOSEST_HIT);
+    std::vector<RayQueryHit> closest(batch.size());
+    size_t nhits = 0;
+    for (size_t i = 0; i < batch.size(); ++i) {
+        closest[i] = batch.result(i);
+        nhits += closest[i].hit();
+    }
+    assert_true(nhits > 0);
+    assert_true(nhits < batch.size());
+    batch.run(RayQueryMode::ANY_HIT);
+    CollisionQuery collision_query{ engine };
+    // "RayQueryBatch::cast" uses the scalar BVH traversal.
+    for (size_t i = 0; i < batch.size(); ++i) {
+        const auto& q = batch.query(i);
+        auto expected = RayQueryBatch::cast(engine, q, RayQueryMode::CLOSEST_HIT);
+        assert_isequal(closest[i].hit(), expected.hit());
+        if (expected.hit()) {
+            assert_isclose(closest[i].distance, expected.distance, 1e-6);
+            assert_true(closest[i].seen_object == expected.seen_object);
+        }
+        assert_isequal(batch.can_see(i), !expected.hit());
+        assert_isequal(batch.can_see(i), collision_query.can_see(q.start, q.stop));
+    }
+    // Some rays are blocked by the moving walls.
+    assert_true(std::any_of(closest.begin(), closest.end(), [&](const RayQueryHit& h){
+        return (h.seen_object == bodies[3].get()) || (h.seen_object == bodies[4].get());
+    }));
+}
+
+void test_heightfield_terrain() {
+    using RigidBodyPtr = std::unique_ptr<RigidBodyVehicle, DeleteFromPool<RigidBodyVehicle>>;
+    auto ground_material = PhysicsMaterial::OBJ_CHASSIS | PhysicsMaterial::OBJ_GROUND | PhysicsMaterial::ATTR_COLLIDE | PhysicsMaterial::ATTR_CONCAVE;
+    auto street_material = PhysicsMaterial::OBJ_CHASSIS | PhysicsMaterial::ATTR_COLLIDE | PhysicsMaterial::ATTR_CONCAVE;
+    // Heights in the local frame of the terrain, with "z" pointing up.
+    size_t n = 21;
+    FixedArray<ScenePos, 2> origin{ -50., -50. };
+    FixedArray<ScenePos, 2> cell_size{ 5., 5. };
+    Array<float> heights{ ArrayShape{ n, n } };
+    for (size_t r = 0; r < n; ++r) {
+        for (size_t c = 0; c < n; ++c) {
+            auto x = origin(0) + (ScenePos)c * cell_size(0);
+            auto y = origin(1) + (ScenePos)r * cell_size(1);
+            heights(r, c) = (float)(3. * std::sin(0.2 * x) * std::cos(0.15 * y));
+        }
+    }
+    // The same triangles as the heightfield. The street lies on the
+    // heightfield, within the cover tolerance, but is not ground and
+    // must therefore not be replaced by the heightfield.
+    auto draw = [&](TriangleList<float>& tl, float dz, size_t c0, size_t c1) {
+        auto v = [&](size_t r, size_t c) {
+            return FixedArray<float, 3>{
+                (float)(origin(0) + (ScenePos)c * cell_size(0)),
+                (float)(origin(1) + (ScenePos)r * cell_size(1)),
+                heights(r, c) + dz };
+        };
+        for (size_t r = 0; r < n - 1; ++r) {
+            for (size_t c = c0; c < c1; ++c) {
+                tl.draw_triangle_wo_normals(v(r, c), v(r, c + 1), v(r + 1, c + 1));
+                tl.draw_triangle_wo_normals(v(r, c), v(r + 1, c + 1), v(r + 1, c));
+            }
+        }
+    };
+    TriangleList<float> ground{ "ground", Material{}, Morphology{ .physics_material = ground_material }, ModifierBacklog{} };
+    TriangleList<float> street{ "street", Material{}, Morphology{ .physics_material = street_material }, ModifierBacklog{} };
+    draw(ground, 0.f, 0, n - 1);
+    draw(street, 0.04f, 8, 12);
+    // Local "z" is world "y".
+    TransformationMatrix<float, ScenePos, 3> terrain_pose{
+        FixedArray<float, 3, 3>::init(
+            1.f, 0.f, 0.f,
+            0.f, 0.f, 1.f,
+            0.f, -1.f, 0.f),
+        FixedArray<ScenePos, 3>{ 3., -2., 7. }};
+    PhysicsEngineConfig cfg;
+    PhysicsEngine triangle_engine{ cfg, std::nullopt };
+    PhysicsEngine heightfield_engine{ cfg, std::nullopt };
+    std::list<RigidBodyPtr> bodies;
+    auto add = [&](PhysicsEngine& engine, const std::list<TypedMesh<std::shared_ptr<const Heightfield>>>& heightfields) {
+        auto rb = rigid_cuboid("terrain", "terrain", INFINITY, fixed_ones<float, 3>());
+        rb->set_absolute_model_matrix(terrain_pose, CURRENT_SOURCE_LOCATION);
+        engine.rigid_bodies_.add_rigid_body(
+            *rb,
+            { ground.triangle_array(), street.triangle_array() },
+            {},
+            {},
+            CollidableMode::COLLIDE,
+            heightfields);
+        bodies.push_back(std::move(rb));
+    };
+    add(triangle_engine, {});
+    add(heightfield_engine, { TypedMesh<std::shared_ptr<const Heightfield>>{
+        .physics_material = ground_material,
+        .mesh = std::make_shared<Heightfield>(heights, origin, cell_size) } });
+    assert_isequal(heightfield_engine.rigid_bodies_.heightfields().size(), (size_t)1);
+    CollisionQuery triangle_query{ triangle_engine };
+    CollisionQuery heightfield_query{ heightfield_engine };
+    UniformRandomNumberGenerator<ScenePos> r{ 3, -40., 40. };
+    size_t nground = 0;
+    size_t nstreet = 0;
+    for (size_t i = 0; i < 500; ++i) {
+        FixedArray<ScenePos, 3> start{ r() + 3., 10. + std::abs(r()), r() + 7. };
+        FixedArray<ScenePos, 3> stop{ r() + 3., -20. + 0.1 * r(), r() + 7. };
+        FixedArray<ScenePos, 3> triangle_point = uninitialized;
+        FixedArray<ScenePos, 3> heightfield_point = uninitialized;
+        bool triangle_seen = triangle_query.can_see(
+            start, stop, nullptr, nullptr, false,
+            PhysicsMaterial::OBJ_BULLET_COLLIDABLE_MASK, &triangle_point);
+        bool heightfield_seen = heightfield_query.can_see(
+            start, stop, nullptr, nullptr, false,
+            PhysicsMaterial::OBJ_BULLET_COLLIDABLE_MASK, &heightfield_point);
+        assert_isequal(triangle_seen, heightfield_seen);
+        if (!triangle_seen) {
+            assert_allclose(triangle_point, heightfield_point, 1e-2);
+            auto street_x = triangle_point(0) - 3.;
+            if ((street_x > origin(0) + 8. * cell_size(0)) && (street_x < origin(0) + 12. * cell_size(0))) {
+                ++nstreet;
+            } else {
+                ++nground;
+            }
+        }
+    }
+    assert_true(nground > 100);
+    assert_true(nstreet > 10);
+}
+
+void test_light_clusters() {
+    std::vector<BoundingSphere<ScenePos, 3>> lights;
+    UniformRandomNumberGenerator<ScenePos> r{ 1, -200., 200. };
+    UniformRandomNumberGenerator<ScenePos> rr{ 2, 0., 40. };
+    for (size_t i = 0; i < 500; ++i) {
+        lights.emplace_back(FixedArray<ScenePos, 3>{ r(), 0.1 * r(), r() }, rr());
+    }
+    lights.emplace_back(fixed_zeros<ScenePos, 3>(), (ScenePos)INFINITY);
+    LightClusters clusters{ LightClustersConfig{ .cell_size = 10., .max_cells_per_axis = 32 } };
+    clusters.build(lights);
+    assert_true(clusters.unbounded_lights() == std::vector<uint32_t>{ 500 });
+    for (size_t d = 0; d < 3; ++d) {
+        assert_true(clusters.shape()(d) <= 32);
+    }
+    assert_isequal(clusters.cell_offsets().size(), clusters.shape()(0) * clusters.shape()(1) * clusters.shape()(2) + 1);
+    for (size_t i = 0; i < 2000; ++i) {
+        FixedArray<ScenePos, 3> p{ r(), 0.2 * r(), r() };
+        auto cell = clusters.cell_index(p);
+        auto actual = clusters.lights_at(p);
+        if (cell == SIZE_MAX) {
+            assert_true(actual.empty());
+            continue;
+        }
+        // Brute force: all bounded lights overlapping the box of the cell.
+        FixedArray<ScenePos, 3> cell_min = uninitialized;
+        for (size_t d = 0, c = cell; d < 3; ++d) {
+            auto stride = (d == 0)
+                ? clusters.shape()(1) * clusters.shape()(2)
+                : (d == 1) ? clusters.shape()(2) : 1;
+            cell_min(d) = clusters.origin()(d) + clusters.cell_size() * (ScenePos)(c / stride);
+            c %= stride;
+        }
+        std::vector<uint32_t> expected;
+        for (size_t j = 0; j < 500; ++j) {
+            const auto& l = lights[j];
+            auto closest = minimum(maximum(l.center, cell_min), cell_min + clusters.cell_size());
+            if (sum(squared(closest - l.center)) <= squared(l.radius)) {
+                expected.push_back((uint32_t)j);
+            }
+            if (sum(squared(p - l.center)) <= squared(l.radius)) {
+                assert_true(std::find(actual.begin(), actual.end(), (uint32_t)j) != actual.end());
+            }
+        }
+        assert_true(std::vector<uint32_t>(actual.begin(), actual.end()) == expected);
+    }
+    clusters.build({});
+    assert_true(clusters.lights_at(fixed_zeros<ScenePos, 3>()).empty());
+}
+
+void test_kinematic_traffic() {
+    // Street 0 - 1 - 2 with the dead-end side street 1 - 3.
+    PointsAndAdjacencyResource wp{ 4 };
+    auto set_point = [&](uint32_t i, float x, float z) {
+        wp.points[i] = {
+            FixedArray<CompressedScenePos, 3>{
+                (CompressedScenePos)x,
+                (CompressedScenePos)0.f,
+                (CompressedScenePos)z },
+            WayPointLocation::STREET };
+    };
+    set_point(0, 0.f, 0.f);
+    set_point(1, 100.f, 0.f);
+    set_point(2, 200.f, 0.f);
+    set_point(3, 100.f, 100.f);
+    auto connect = [&](uint32_t a, uint32_t b) {
+        wp.adjacency(a, b) = (CompressedScenePos)100.f;
+        wp.adjacency(b, a) = (CompressedScenePos)100.f;
+    };
+    connect(0, 1);
+    connect(1, 2);
+    connect(1, 3);
+    wp.update_adjacency_diagonal();
+    KinematicTrafficConfig cfg;
+    KinematicTraffic traffic{ std::make_shared<WayPointsAndBvh>(std::move(wp)), cfg };
+    FixedArray<float, 3> east{ 1.f, 0.f, 0.f };
+
+    // Adding and removing
+    assert_true(!traffic.try_add(FixedArray<ScenePos, 3>{ 50., 30., 0. }, east, 0.f, 10.).has_value());
+    auto leader = traffic.try_add(FixedArray<ScenePos, 3>{ 50., 0., 1. }, east, 0.f, 10.);
+    auto follower = traffic.try_add(FixedArray<ScenePos, 3>{ 45., 0., -1. }, east, 0.f, 10.);
+    assert_true(leader.has_value());
+    assert_true(follower.has_value());
+    assert_isequal(traffic.size(), (size_t)2);
+    {
+        auto s = traffic.state(*leader);
+        assert_isclose(s.position(0), 50., 1e-6);
+        assert_isclose(s.position(2), 0., 1e-6);
+        assert_isequal(s.target_waypoint_id, (size_t)1);
+    }
+    auto oncoming = traffic.try_add(FixedArray<ScenePos, 3>{ 150., 0., 0. }, -east, 0.f, 10.);
+    assert_true(oncoming.has_value());
+    assert_isequal(traffic.remove(*oncoming).target_waypoint_id, (size_t)1);
+    assert_isequal(traffic.size(), (size_t)2);
+    assert_isclose(traffic.state(*follower).position(0), 45., 1e-6);
+    assert_isequal(traffic.try_add(FixedArray<ScenePos, 3>{ 150., 0., 0. }, -east, 0.f, 10.).value(), *oncoming);
+    traffic.remove(*oncoming);
+
+    // Spacing and successors
+    float dt = 1.f / 60.f * seconds;
+    traffic.advance_time(dt);
+    assert_true(traffic.state(*leader).speed > 0.f);
+    assert_isequal(traffic.state(*follower).speed, 0.f);
+    std::vector<size_t> leader_targets{ 1 };
+    std::vector<size_t> follower_targets{ 1 };
+    for (size_t i = 0; i < 30 * 60; ++i) {
+        traffic.advance_time(dt);
+        auto l = traffic.state(*leader);
+        auto f = traffic.state(*follower);
+        assert_true(l.speed <= cfg.max_speed);
+        if (l.target_waypoint_id != leader_targets.back()) {
+            leader_targets.push_back(l.target_waypoint_id);
+        }
+        if (f.target_waypoint_id != follower_targets.back()) {
+            follower_targets.push_back(f.target_waypoint_id);
+        }
+        // The follower neither closes up nor overtakes on the first edge.
+        if (leader_targets.size() == 1) {
+            assert_true(sum(squared(l.position - f.position)) > squared(5. - 1e-3));
+            assert_true(l.position(0) > f.position(0));
+        }
+    }
+    assert_true(follower_targets.size() >= 2);
+    // No U-turn at the junction, but at the dead end.
+    assert_true(leader_targets.size() >= 3);
+    assert_true((leader_targets[1] == 2) || (leader_targets[1] == 3));
+    assert_isequal(leader_targets[2], (size_t)1);
+}
+
 int main(int argc, char** argv) {
     enable_floating_point_exceptions();
 
@@ -253,8 +899,17 @@ int main(int argc, char** argv) {
         // test_power_to_force_P_normal();
         // test_power_to_force_stiction_tangential();
         test_com();
+        test_contact_warm_start();
+        test_projectile_pool();
+        test_projectile_pool_hit();
+        test_projectile_pool_drag();
+        test_ray_query_batch();
+        test_heightfield_terrain();
+        test_light_clusters();
+        test_kinematic_traffic();
         test_magic_formula();
         test_track_element();
+        test_track_binary();
     } catch (const std::runtime_error& e) {
         lerr() << e.what();
         return 1;
@@ -4,22 +4,32 @@
 #include <Mlib/Audio/One_Shot_Audio.hpp>
 #include <Mlib/Geometry/Cameras/Perspective_Camera.hpp>
 #include <Mlib/Geometry/Colored_Vertex.hpp>
+#include <Mlib/Geometry/Material/Blending_Pass_Type.hpp>
 #include <Mlib/Geometry/Material/Particle_Type.hpp>
+#include <Mlib/Geometry/Material/Transformation_Mode.hpp>
 #include <Mlib/Geometry/Mesh/Colored_Vertex_Array_Filter.hpp>
 #include <Mlib/Geometry/Mesh/Load/Load_Mesh_Config.hpp>
 #include <Mlib/Geometry/Mesh/Load/Load_Obj.hpp>
 #include <Mlib/Geometry/Physics_Material.hpp>
+#include <Mlib/Geometry/Primitives/Bounding_Sphere.hpp>
+#include <Mlib/Geometry/Primitives/Extremal_Bounding_Sphere.hpp>
 #include <Mlib/Images/Draw_Bmp.hpp>
+#include <Mlib/Iterator/Enumerate.hpp>
 #include <Mlib/Macro_Executor/Focus.hpp>
 #include <Mlib/Math/Fixed_Test.hpp>
+#include <Mlib/Math/Lerp.hpp>
 #include <Mlib/Math/Pi.hpp>
 #include <Mlib/Memory/Destruction_Guard.hpp>
 #include <Mlib/Memory/Object_Pool.hpp>
 #include <Mlib/Misc/Floating_Point_Exceptions.hpp>
+#include <Mlib/OpenGL/Batch_Renderers/Aggregate_Cell_Grid.hpp>
 #include <Mlib/OpenGL/Batch_Renderers/Particle_Renderer.hpp>
 #include <Mlib/OpenGL/Batch_Renderers/Trail_Renderer.hpp>
 #include <Mlib/OpenGL/Clear_Wrapper.hpp>
+#include <Mlib/OpenGL/Context_Query.hpp>
 #include <Mlib/OpenGL/Deallocate/Render_Allocator.hpp>
+#include <Mlib/OpenGL/Frame_Index_From_Animation_Time.hpp>
+#include <Mlib/OpenGL/IContext.hpp>
 #include <Mlib/OpenGL/Input_Config.hpp>
 #include <Mlib/OpenGL/Key_Bindings/Key_Configuration.hpp>
 #include <Mlib/OpenGL/Key_Bindings/Lockable_Key_Configurations.hpp>
@@ -40,6 +50,8 @@
 #include <Mlib/OpenGL/Resource_Managers/Rendering_Resources.hpp>
 #include <Mlib/OpenGL/Resource_Managers/Trail_Resources.hpp>
 #include <Mlib/OpenGL/Resources/Colored_Vertex_Array_Resource.hpp>
+#include <Mlib/OpenGL/Resources/Colored_Vertex_Array_Resource/Clear_On_Update.hpp>
+#include <Mlib/OpenGL/Resources/Colored_Vertex_Array_Resource/Dynamic_Instance_Buffers.hpp>
 #include <Mlib/OpenGL/Resources/Obj_File_Resource.hpp>
 #include <Mlib/OpenGL/Selected_Cameras/Selected_Cameras.hpp>
 #include <Mlib/OpenGL/Ui/Button_States.hpp>
@@ -60,14 +72,21 @@
 #include <Mlib/Physics/Smoke_Generation/Contact_Smoke_Generator.hpp>
 #include <Mlib/Physics/Smoke_Generation/Smoke_Particle_Generator.hpp>
 #include <Mlib/Physics/Smoke_Generation/Surface_Contact_Db.hpp>
+#include <Mlib/Players/Game_Logic/Game_Logic_Config.hpp>
+#include <Mlib/Players/Game_Logic/Simulation_Lod.hpp>
+#include <Mlib/Physics/Units.hpp>
 #include <Mlib/Resource_Context/Rendering_Context.hpp>
 #include <Mlib/Scene_Graph/Containers/Scene.hpp>
 #include <Mlib/Scene_Graph/Elements/Absolute_Movable_Setter.hpp>
 #include <Mlib/Scene_Graph/Elements/Light.hpp>
+#include <Mlib/Scene_Graph/Elements/Renderable.hpp>
+#include <Mlib/Scene_Graph/Elements/Renderable_Filter.hpp>
+#include <Mlib/Scene_Graph/Elements/Rendering_Strategies.hpp>
 #include <Mlib/Scene_Graph/Elements/Scene_Node.hpp>
 #include <Mlib/Scene_Graph/Instances/Dynamic_World.hpp>
 #include <Mlib/Scene_Graph/Instantiation/Child_Instantiation_Options.hpp>
 #include <Mlib/Scene_Graph/Render/Caching_Gpu_Object_Factory.hpp>
+#include <Mlib/Scene_Graph/Render_Passes.hpp>
 #include <Mlib/Scene_Graph/Resources/Renderable_Resource_Filter.hpp>
 #include <Mlib/Scene_Graph/Resources/Scene_Node_Resources.hpp>
 #include <Mlib/Time/Fps/Fixed_Time_Sleeper.hpp>
@@ -349,12 +368,297 @@ void test_physics_engine(unsigned int seed) {
     }
 }
 
+void test_simulation_lod_transitions() {
+    GameLogicConfig cfg;
+    assert_true(cfg.r_kinematic_near < cfg.r_kinematic_far);
+    assert_true(cfg.r_kinematic_far < cfg.r_delete_far);
+    auto transition = [&cfg](bool is_kinematic, ScenePos dist) {
+        return simulation_lod_transition(is_kinematic, squared(dist), cfg);
+    };
+    auto near = funpack(cfg.r_kinematic_near);
+    auto far = funpack(cfg.r_kinematic_far);
+    assert_true(transition(false, 0.) == SimulationLodTransition::NONE);
+    assert_true(transition(false, 0.5 * (near + far)) == SimulationLodTransition::NONE);
+    assert_true(transition(false, far + 1.) == SimulationLodTransition::TO_KINEMATIC);
+    assert_true(transition(true, far + 1.) == SimulationLodTransition::NONE);
+    assert_true(transition(true, 0.5 * (near + far)) == SimulationLodTransition::NONE);
+    assert_true(transition(true, near - 1.) == SimulationLodTransition::TO_DYNAMIC);
+    assert_true(transition(false, near - 1.) == SimulationLodTransition::NONE);
+}
+
+void test_scene_node_bounding_sphere_cache() {
+    struct UnitSphere: public Renderable {
+        virtual PhysicsMaterial physics_attributes() const override {
+            return PhysicsMaterial::NONE;
+        }
+        virtual RenderingStrategies rendering_strategies() const override {
+            return RenderingStrategies::NONE;
+        }
+        virtual bool requires_render_pass(ExternalRenderPassType render_pass) const override {
+            return false;
+        }
+        virtual BlendingPassType required_blending_passes(ExternalRenderPassType render_pass) const override {
+            return BlendingPassType::NONE;
+        }
+        virtual ExtremalBoundingSphere<CompressedScenePos, 3> bounding_sphere(RenderableFilter filter) const override {
+            return BoundingSphere<CompressedScenePos, 3>{ fixed_zeros<CompressedScenePos, 3>(), (CompressedScenePos)1.f };
+        }
+    };
+    auto center_x = [](const SceneNode& node) {
+        auto bs = node.relative_bounding_sphere(RenderableFilter::ALL);
+        assert_true(!bs.empty() && !bs.full());
+        return funpack(bs.data().center(0));
+    };
+    auto parent = std::make_unique<SceneNode>(PoseInterpolationMode::DISABLED);
+    auto child = std::make_unique<SceneNode>(PoseInterpolationMode::DISABLED);
+    auto& c = *child;
+    c.add_renderable(VariableAndHash<std::string>{ "sphere" }, std::make_shared<UnitSphere>());
+    parent->add_child(VariableAndHash<std::string>{ "child" }, std::move(child));
+    assert_isclose(center_x(*parent), 0., 1e-3);
+    // The sphere of a dynamic node follows the pose of the child.
+    c.set_position({ 10., 0., 0. }, SceneTime::initial());
+    assert_isclose(center_x(*parent), 10., 1e-3);
+    assert_isclose(center_x(*parent), 10., 1e-3);
+    // ... and its renderables.
+    c.clear_renderable_instance(VariableAndHash<std::string>{ "sphere" });
+    assert_true(parent->relative_bounding_sphere(RenderableFilter::ALL).empty());
+    parent->shutdown();
+    // Static nodes cache their sphere.
+    Scene scene{ "bounding_sphere_scene" };
+    DestructionGuard scene_destruction_guard{[&](){
+        scene.shutdown();
+    }};
+    auto static_parent = std::make_unique<SceneNode>(PoseInterpolationMode::DISABLED);
+    auto static_child = std::make_unique<SceneNode>(PoseInterpolationMode::DISABLED);
+    static_child->set_position({ 5., 0., 0. }, SceneTime::initial());
+    static_child->add_renderable(VariableAndHash<std::string>{ "sphere" }, std::make_shared<UnitSphere>());
+    static_parent->add_child(VariableAndHash<std::string>{ "child" }, std::move(static_child));
+    auto& sp = *static_parent;
+    scene.add_static_root_node(VariableAndHash<std::string>{ "static_parent" }, std::move(static_parent));
+    assert_isclose(center_x(sp), 5., 1e-3);
+    assert_isclose(center_x(sp), 5., 1e-3);
+}
+
+void test_dynamic_instance_buffers() {
+    // Reference: The per-particle update that preceded the
+    // structure-of-arrays kernel, with a stable removal.
+    struct ReferenceParticle {
+        std::chrono::steady_clock::time_point time;
+        FixedArray<float, 3> position;
+        FixedArray<float, 3> velocity;
+        float air_resistance_halflife;
+        float animation_time;
+        const BillboardSequence* sequence;
+        BillboardId billboard_id;
+    };
+    FixedArray<float, 3> wind{ 2e-3f, 0.f, -1e-3f };
+    auto reference_step = [&wind](std::vector<ReferenceParticle>& particles, std::chrono::steady_clock::time_point time) {
+        std::erase_if(particles, [&](ReferenceParticle& p) {
+            float dt = std::chrono::duration<float>(time - p.time).count() * seconds;
+            if (dt <= 0) {
+                return false;
+            }
+            p.time = time;
+            p.position += p.velocity * dt;
+            if (p.air_resistance_halflife != INFINITY) {
+                auto alpha = std::pow(0.5f, dt / p.air_resistance_halflife);
+                p.velocity = lerp(p.velocity, wind, 1.f - alpha);
+            }
+            if (p.sequence->duration == INFINITY) {
+                return false;
+            }
+            p.animation_time += dt;
+            if (p.animation_time >= p.sequence->duration) {
+                return true;
+            }
+            auto frame_index = (size_t)frame_index_from_animation_state(
+                p.animation_time,
+                p.sequence->duration,
+                (uint32_t)p.sequence->billboard_ids.size());
+            p.billboard_id = p.sequence->billboard_ids.at(frame_index);
+            return false;
+        });
+    };
+    BillboardSequence short_sequence{ .billboard_ids = { 0, 1, 2, 3 }, .duration = 0.25f * seconds, .final_texture_w = 1.f };
+    BillboardSequence long_sequence{ .billboard_ids = { 0, 1, 2, 3 }, .duration = 0.55f * seconds, .final_texture_w = 1.f };
+    BillboardSequence infinite_sequence{ .billboard_ids = { 2 }, .duration = INFINITY, .final_texture_w = 1.f };
+    struct Spawn {
+        float time;
+        const BillboardSequence* sequence;
+        float air_resistance_halflife;
+    };
+    // The particle at "0.2 s" is spawned at the time of an update,
+    // i.e. with "dt = 0" and a half-life of zero.
+    std::vector<Spawn> spawns{
+        { 0.f, &short_sequence, 0.1f * seconds },
+        { 0.f, &infinite_sequence, INFINITY },
+        { 0.f, &long_sequence, 0.f },
+        { 0.f, &short_sequence, 0.5f * seconds },
+        { 0.f, &long_sequence, 0.2f * seconds },
+        { 0.2f, &infinite_sequence, 0.f },
+        { 0.2f, &short_sequence, INFINITY }};
+    // The buffers are not allocated on the GPU without an initialized context.
+    struct UninitializedContext: public IContext {
+        virtual bool is_initialized() const override {
+            return false;
+        }
+    };
+    UninitializedContext context;
+    ContextQueryGuard context_query_guard{ context };
+    auto t0 = std::chrono::steady_clock::time_point() + std::chrono::seconds(1);
+    auto at = [t0](float t) {
+        return t0 + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<float>(t));
+    };
+    DynamicInstanceBuffers buffers{
+        TransformationMode::POSITION,
+        spawns.size(),
+        4,              // num_billboard_atlas_components
+        false,          // has_per_instance_continuous_texture_layer
+        ClearOnUpdate::NO };
+    buffers.set_wind_vector(wind);
+    std::vector<ReferenceParticle> reference;
+    for (size_t step = 0; step < 10; ++step) {
+        auto time = at(0.1f * (float)step);
+        for (const auto& [i, s] : enumerate(spawns)) {
+            if (at(s.time) != time) {
+                continue;
+            }
+            FixedArray<float, 3> position{ (float)i, 0.f, 0.f };
+            FixedArray<float, 3> velocity{ 1e-3f, 2e-3f * (float)i, 0.f };
+            buffers.append(
+                time,
+                TransformationMatrix<float, float, 3>{ fixed_identity_array<float, 3>(), position },
+                *s.sequence,
+                velocity,
+                s.air_resistance_halflife,
+                0.f);
+            reference.push_back(ReferenceParticle{
+                .time = time,
+                .position = position,
+                .velocity = velocity,
+                .air_resistance_halflife = s.air_resistance_halflife,
+                .animation_time = 0.f,
+                .sequence = s.sequence,
+                .billboard_id = s.sequence->billboard_ids[0]});
+        }
+        buffers.move_renderables(time);
+        reference_step(reference, time);
+        assert_isequal(buffers.tmp_length(), reference.size());
+        for (const auto& [i, r] : enumerate(reference)) {
+            assert_allclose(buffers.tmp_position(i), r.position, 1e-4f);
+            assert_isequal(buffers.tmp_billboard_id(i), r.billboard_id);
+        }
+    }
+    // Only the particles with an infinite animation duration remain.
+    assert_isequal(buffers.tmp_length(), size_t{ 2 });
+    assert_isclose(buffers.tmp_position(0)(0), 1.9f, 1e-4f);
+    assert_isclose(buffers.tmp_position(1)(0), 5.1f + 0.6f * wind(0) * seconds, 1e-4f);
+}
+
+void test_aggregate_cell_grid() {
+    using P = CompressedScenePos;
+    // One triangle per "x", with an alpha value of "x".
+    auto create_array = [](const std::string& name, const std::vector<float>& xs, float max_triangle_distance) {
+        UUVector<FixedArray<ColoredVertex<P>, 3>> triangles;
+        UUVector<FixedArray<float, 3>> alpha;
+        for (float x : xs) {
+            auto v = [x](float dx, float dy) {
+                return ColoredVertex<P>{
+                    { (P)(x + dx), (P)dy, (P)0.f },
+                    fixed_full<uint8_t, 4>(255),
+                    fixed_zeros<float, 2>(),
+                    { 0.f, 0.f, 1.f } };
+            };
+            triangles.emplace_back(v(0.f, 0.f), v(1.f, 0.f), v(0.f, 1.f));
+            alpha.emplace_back(x, x, x);
+        }
+        return std::make_shared<ColoredVertexArray<P>>(
+            name,
+            Material{},
+            Morphology{
+                .physics_material = PhysicsMaterial::ATTR_VISIBLE,
+                .max_triangle_distance = max_triangle_distance },
+            ModifierBacklog{},
+            UUVector<FixedArray<ColoredVertex<P>, 4>>(),
+            std::move(triangles),
+            UUVector<FixedArray<ColoredVertex<P>, 2>>(),
+            UUVector<FixedArray<std::vector<BoneWeight>, 3>>(),
+            UUVector<FixedArray<float, 3>>(),
+            UUVector<FixedArray<uint8_t, 3>>(),
+            std::vector<UUVector<FixedArray<float, 3, 2>>>(),
+            std::vector<UUVector<FixedArray<float, 3>>>(),
+            std::move(alpha),
+            UUVector<FixedArray<float, 4>>());
+    };
+    auto m = TransformationMatrix<float, ScenePos, 3>::identity();
+    auto a = create_array("a", { 2.f, 15.f }, INFINITY);
+    auto b = create_array("b", { 16.f }, 20.f);
+    ExternalRenderPass pass{ .pass = ExternalRenderPassType::STANDARD };
+    AggregateCellGrid grid{ 10. };
+    AggregateCellIndex i0{ 0, 0, 0 };
+    AggregateCellIndex i1{ 1, 0, 0 };
+
+    auto u = grid.update({ 0., 0., 0. }, { { m, a } }, pass);
+    assert_isequal(u.changed.size(), size_t{ 2 });
+    assert_true(u.removed.empty());
+    assert_true(u.sorted.arrays.empty());
+    {
+        // Positions are relative to the cell, the other attributes are kept.
+        const auto& c = u.changed.at(i1);
+        assert_allclose(c.offset, FixedArray<ScenePos, 3>{ 10., 0., 0. });
+        assert_isequal(c.arrays.size(), size_t{ 1 });
+        const auto& cva = *c.arrays.front();
+        assert_isequal(cva.triangles.size(), size_t{ 1 });
+        assert_allclose(cva.triangles[0](1).position, FixedArray<float, 3>{ 6.f, 0.f, 0.f });
+        assert_allclose(cva.triangles[0](1).normal, FixedArray<float, 3>{ 0.f, 0.f, 1.f });
+        assert_isequal(cva.alpha.size(), size_t{ 1 });
+        assert_isclose(cva.alpha[0](0), 15.f);
+    }
+
+    // Nothing changed, and "a" is visible from everywhere.
+    u = grid.update({ 1000., 0., 0. }, { { m, a } }, pass);
+    assert_true(u.changed.empty());
+    assert_true(u.removed.empty());
+
+    // Adding "b" only rebuilds its cell.
+    u = grid.update({ 0., 0., 0. }, { { m, a }, { m, b } }, pass);
+    assert_isequal(u.changed.size(), size_t{ 1 });
+    assert_isequal(u.changed.at(i1).arrays.front()->triangles.size(), size_t{ 2 });
+    u = grid.update({ 0., 0., 0. }, { { m, a }, { m, b } }, pass);
+    assert_true(u.changed.empty());
+
+    // "b" is out of range.
+    u = grid.update({ -100., 0., 0. }, { { m, a }, { m, b } }, pass);
+    assert_isequal(u.changed.size(), size_t{ 1 });
+    assert_isequal(u.changed.at(i1).arrays.front()->triangles.size(), size_t{ 1 });
+
+    // "b" is partially in range, which depends on the camera position.
+    u = grid.update({ -3., 0., 0. }, { { m, a }, { m, b } }, pass);
+    assert_isequal(u.changed.size(), size_t{ 1 });
+    assert_isequal(u.changed.at(i1).arrays.front()->triangles.size(), size_t{ 2 });
+    u = grid.update({ -3., 0., 0. }, { { m, a }, { m, b } }, pass);
+    assert_isequal(u.changed.size(), size_t{ 1 });
+
+    // The same array at another position is another source.
+    auto m2 = TransformationMatrix<float, ScenePos, 3>{ fixed_identity_array<float, 3>(), { 100., 0., 0. } };
+    u = grid.update({ 0., 0., 0. }, { { m2, a } }, pass);
+    assert_isequal(u.changed.size(), size_t{ 2 });
+    assert_isequal(u.removed.size(), size_t{ 2 });
+    assert_true(u.changed.contains(AggregateCellIndex{ 10, 0, 0 }));
+    assert_true(u.changed.contains(AggregateCellIndex{ 11, 0, 0 }));
+    assert_true(!u.changed.contains(i0));
+}
 
 int main(int argc, char** argv) {
     reserve_realtime_threads(0);
     enable_floating_point_exceptions();
 
     try {
+        test_simulation_lod_transitions();
+        test_scene_node_bounding_sphere_cache();
+        test_dynamic_instance_buffers();
+        test_aggregate_cell_grid();
         auto seed_min = getenv_default_uint("SEED_MIN", 0);
         auto seed_count = getenv_default_uint("SEED_COUNT", 1);
         for (auto seed = seed_min; seed < seed_min + seed_count; ++seed) {
@@ -16,6 +16,8 @@
 #include <Mlib/Stats/Sort.hpp>
 #include <Mlib/Stats/T_Distribution.hpp>
 #include <map>
+#include <optional>
+#include <span>
 
 using namespace Mlib;
 
@@ -57,6 +59,57 @@ void test_ransac() {
     assert_allequal(best_ids, Array<size_t>{ 1, 3, 5, 6, 7 });
 }
 
+void test_ransac_models() {
+    // Points on "y = 2 x + 1", sorted by decreasing quality, where every
+    // third point is an outlier.
+    size_t n = 90;
+    Array<float> x = arange<float>(n);
+    Array<float> y = 2.f * x + 1.f;
+    for (size_t i = 0; i < n; i += 3) {
+        y(i) += 50.f + (float)i;
+    }
+    auto fit = [&](std::span<const size_t> ids) -> std::optional<FixedArray<float, 2>> {
+        float sx = 0, sy = 0, sxx = 0, sxy = 0;
+        for (size_t i : ids) {
+            sx += x(i);
+            sy += y(i);
+            sxx += squared(x(i));
+            sxy += x(i) * y(i);
+        }
+        auto nf = (float)ids.size();
+        float det = nf * sxx - squared(sx);
+        if (std::abs(det) < 1e-6f) {
+            return std::nullopt;
+        }
+        float a = (nf * sxy - sx * sy) / det;
+        return FixedArray<float, 2>{ a, (sy - a * sx) / nf };
+    };
+    auto residual = [&](const FixedArray<float, 2>& model, size_t i) {
+        return std::abs(y(i) - (model(0) * x(i) + model(1)));
+    };
+    for (auto sampling : { RansacSampling::UNIFORM, RansacSampling::PROSAC }) {
+        for (size_t preemptive_block_size : { 0, 10 }) {
+            RansacOptions<float> ro{
+                .nelems_small = 2,
+                .ncalls = 1000,
+                .inlier_distance_thresh = 0.1f,
+                .inlier_count_thresh = 10,
+                .seed = 1,
+                .sampling = sampling,
+                .preemptive_block_size = preemptive_block_size
+            };
+            auto res = ransac_models(n, ro, fit, residual);
+            assert_true(res.has_value());
+            assert_isclose(res->model(0), 2.f, 1e-3f);
+            assert_isclose(res->model(1), 1.f, 1e-3f);
+            assert_isequal(res->inliers.length(), n - n / 3);
+        }
+    }
+    assert_isequal(ransac_required_ncalls(50, 100, 2, 0.99), (size_t)17);
+    assert_isequal(ransac_required_ncalls(0, 100, 2, 0.99), SIZE_MAX);
+    assert_isequal(ransac_required_ncalls(100, 100, 2, 0.99), (size_t)1);
+}
+
 void test_sort() {
     {
         Array<float> x{ 9, 8, 7, 6, 5 };
@@ -312,6 +365,7 @@ int main(int argc, char** argv) {
         test_mad();
         test_robust_deviation();
         test_ransac();
+        test_ransac_models();
         test_sort();
         test_quantiles();
         test_argmin();